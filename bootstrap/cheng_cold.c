@@ -25,6 +25,7 @@
 #endif
 
 #include <ctype.h>
+#include <errno.h>
 #include <fcntl.h>
 #include <limits.h>
 #include <stdbool.h>
@@ -32,9 +33,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <poll.h>
 #include <sys/mman.h>
 #include <sys/resource.h>
+#include <sys/socket.h>
 #include <sys/stat.h>
+#include <sys/un.h>
 #include <sys/wait.h>
 #include <time.h>
 #include <unistd.h>
@@ -53,10 +57,17 @@ static bool cold_diag_dump_slots = false;
 static int32_t cold_egraph_rewrite_count = 0;
 static int32_t cold_egraph_dedup_count = 0;
 static int32_t cold_egraph_licm_hoisted = 0;
+static int32_t cold_bce_checks_removed = 0;
+static int32_t cold_gvn_values_reused = 0;
+static int32_t cold_iv_muls_reduced = 0;
+static int32_t cold_iv_muls_skipped_capacity = 0;
 static int32_t cold_egraph_fixed_point_iterations = 0;
 static int32_t cold_cross_block_analysis_ran = 0;
 static int32_t cold_cross_block_safe_slots = 0;
 static int32_t cold_cross_block_unsafe_slots = 0;
+static int32_t cold_lowering_parallel_functions = 0;
+static int32_t cold_lowering_serial_fallbacks = 0;
+static int32_t cold_lowering_active_workers = 0;
 
 #include "macho_direct.h"
 #include "elf64_direct.h"
@@ -79,11 +90,14 @@ __attribute__((used)) static char ColdEmbeddedSourcePath[COLD_EMBEDDED_SOURCE_PA
     "CHENG_COLD_EMBEDDED_SOURCE_PATH_V1\n";
 
 static uint64_t cold_now_us(void);
+static int32_t cold_jobs_from_env(void);
 
 /* ================================================================
  * Arena
  * ================================================================ */
 #define ARENA_PAGE 65536
+#define ARENA_MIN_CLASS 6          /* 64-byte blocks */
+#define ARENA_SIZE_CLASSES 32
 
 typedef struct ArenaPage {
     struct ArenaPage *next;
@@ -102,8 +116,29 @@ typedef struct Arena {
     uint64_t phase_start_us[8];
     const char *phase_name[8];
     int32_t phase_page_count[8];   /* pages at phase start */
+    bool frozen;                   /* shared by parallel lowering workers */
+    /* Outgrown arrays parked by arena_grow, by power-of-two size class.
+       Every block in free_list[c] is at least (1 << c) bytes. */
+    void *free_list[ARENA_SIZE_CLASSES];
 } Arena;
 
+/* Parallel lowering (cold_parse_module_decls): a worker thread installs its
+   private arena and bail point here.  Allocations against a frozen shared
+   arena are redirected to the worker arena; symbol mutations and die() on a
+   worker jump back to the bail point so the function is re-lowered serially.
+   A SEGV on a worker is a compiler bug, not a bail: it is reported and the
+   process exits. */
+static _Thread_local Arena *cold_lower_thread_arena = 0;
+static _Thread_local sigjmp_buf *cold_lower_bail = 0;
+
+static void cold_lower_bail_if_active(void) {
+    if (cold_lower_bail) siglongjmp(*cold_lower_bail, 1);
+}
+
+/* Bumped by everything a lowering does besides building its own BodyIR: a
+   Symbols mutation, a body stored for another function, an input read.
+   The compile server only reuses a body whose lowering left it unchanged. */
+static _Thread_local uint32_t cold_lower_effects = 0;
 
 
 static char ColdDieError[512] = {0};
@@ -130,6 +165,7 @@ static jmp_buf ColdErrorJumpBuf;
 static bool ColdErrorRecoveryEnabled = false;
 
 static void die(const char *msg) {
+    cold_lower_bail_if_active();
     snprintf(ColdDieError, sizeof(ColdDieError), "%s", msg);
     fprintf(stderr, "cheng_cold: %s (recovery=%d)\n", msg, ColdErrorRecoveryEnabled);
     cold_die_report_flush();
@@ -144,6 +180,11 @@ static int ColdImportSegvSaw = 0;
 static bool ColdImportBodyCompilationActive = false; /* set during import body compilation */
 static void cold_sigsegv_die_handler(int sig) {
     (void)sig;
+    if (cold_lower_thread_arena) {
+        const char msg[] = "cheng_cold: SEGV in lowering worker\n";
+        write(2, msg, sizeof(msg) - 1);
+        _exit(2);
+    }
     if (ColdErrorRecoveryEnabled) {
         longjmp(ColdErrorJumpBuf, 1);
     }
@@ -160,29 +201,174 @@ static int32_t align_i32(int32_t v, int32_t a) {
     return (v + a - 1) & ~(a - 1);
 }
 
-static void *arena_alloc(Arena *a, size_t size) {
+/* Arena reuse accounting for cold_print_resource_report.  Counters are
+   per thread; lowering workers fold theirs into the totals on exit. */
+typedef struct ColdArenaStats {
+    uint64_t zero_fill_skipped_bytes;
+    uint64_t grow_in_place_bytes;
+    uint64_t free_list_parked_bytes;
+    uint64_t free_list_reused_bytes;
+} ColdArenaStats;
+
+static _Thread_local ColdArenaStats cold_arena_thread_stats;
+static ColdArenaStats cold_arena_folded_stats;
+
+static void cold_arena_stats_fold(void) {
+    ColdArenaStats *t = &cold_arena_thread_stats;
+    __atomic_fetch_add(&cold_arena_folded_stats.zero_fill_skipped_bytes,
+                       t->zero_fill_skipped_bytes, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&cold_arena_folded_stats.grow_in_place_bytes,
+                       t->grow_in_place_bytes, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&cold_arena_folded_stats.free_list_parked_bytes,
+                       t->free_list_parked_bytes, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&cold_arena_folded_stats.free_list_reused_bytes,
+                       t->free_list_reused_bytes, __ATOMIC_RELAXED);
+    memset(t, 0, sizeof(*t));
+}
+
+static int32_t arena_class_floor(size_t size) {
+    int32_t c = 0;
+    while (c + 1 < ARENA_SIZE_CLASSES && ((size_t)1 << (c + 1)) <= size) c++;
+    return c;
+}
+
+static int32_t arena_class_ceil(size_t size) {
+    int32_t c = ARENA_MIN_CLASS;
+    while (c < ARENA_SIZE_CLASSES && ((size_t)1 << c) < size) c++;
+    return c;
+}
+
+static void *arena_bump(Arena *a, size_t size) {
+    if (a->frozen && cold_lower_thread_arena) a = cold_lower_thread_arena;
     size = (size + 7u) & ~7u;
     if (!a->current || a->current->ptr + size > a->current->end) {
-        size_t payload = size > ARENA_PAGE ? size + ARENA_PAGE : ARENA_PAGE;
-        ArenaPage *page = mmap(0, sizeof(ArenaPage) + payload,
-                               PROT_READ | PROT_WRITE,
-                               MAP_PRIVATE | MAP_ANON, -1, 0);
-        if (page == MAP_FAILED) die("arena mmap failed");
-        page->next = 0;
-        page->base = (uint8_t *)(page + 1);
-        page->ptr = page->base;
-        page->end = page->base + payload;
-        if (a->current) a->current->next = page;
-        else a->head = page;
+        /* Pages after current are only present in a rewound arena. */
+        ArenaPage *page = a->current ? a->current->next : 0;
+        while (page && page->ptr + size > page->end) page = page->next;
+        if (!page) {
+            size_t payload = size > ARENA_PAGE ? size + ARENA_PAGE : ARENA_PAGE;
+            page = mmap(0, sizeof(ArenaPage) + payload,
+                        PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANON, -1, 0);
+            if (page == MAP_FAILED) die("arena mmap failed");
+            page->base = (uint8_t *)(page + 1);
+            page->ptr = page->base;
+            page->end = page->base + payload;
+            if (a->current) {
+                page->next = a->current->next;
+                a->current->next = page;
+            } else {
+                page->next = 0;
+                a->head = page;
+            }
+        }
         a->current = page;
     }
     void *result = a->current->ptr;
     a->current->ptr += size;
     a->used += size;
-    memset(result, 0, size);
     return result;
 }
 
+/* Forget every allocation but keep the pages for the next user.  Blocks
+   handed out before the rewind must no longer be referenced. */
+static void arena_rewind(Arena *a) {
+    for (ArenaPage *page = a->head; page; page = page->next) page->ptr = page->base;
+    a->current = a->head;
+    a->used = 0;
+    a->phase_count = 0;
+    memset(a->free_list, 0, sizeof(a->free_list));
+}
+
+/* Private arenas of lowering and codegen worker threads, kept across uses
+   to avoid mmap churn.  Lowered bodies live in the lowering arenas until
+   the compile ends, so those are rewound once per compile by
+   cold_worker_arenas_reset; codegen arenas are rewound on every use. */
+#define COLD_WORKER_ARENA_CAP 16
+static Arena *cold_lower_arena_cache[COLD_WORKER_ARENA_CAP];
+static Arena *cold_codegen_arena_cache[COLD_WORKER_ARENA_CAP];
+
+static Arena *cold_worker_arena(Arena **cache, int32_t worker) {
+    if (!cache[worker]) {
+        Arena *a = mmap(0, sizeof(Arena), PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANON, -1, 0);
+        if (a == MAP_FAILED) die("worker arena mmap failed");
+        cache[worker] = a;
+    }
+    return cache[worker];
+}
+
+static void cold_worker_arenas_reset(void) {
+    for (int32_t w = 0; w < COLD_WORKER_ARENA_CAP; w++) {
+        if (cold_lower_arena_cache[w]) arena_rewind(cold_lower_arena_cache[w]);
+        if (cold_codegen_arena_cache[w]) arena_rewind(cold_codegen_arena_cache[w]);
+    }
+    cold_lowering_parallel_functions = 0;
+    cold_lowering_serial_fallbacks = 0;
+    cold_lowering_active_workers = 0;
+}
+
+/* Zeroed allocation. */
+static void *arena_alloc(Arena *a, size_t size) {
+    void *result = arena_bump(a, size);
+    memset(result, 0, (size + 7u) & ~7u);
+    return result;
+}
+
+/* Allocation without clearing.  The contents are unspecified, so only call
+   sites that write every byte they later read may use it. */
+static void *arena_alloc_uninit(Arena *a, size_t size) {
+    cold_arena_thread_stats.zero_fill_skipped_bytes += (size + 7u) & ~7u;
+    return arena_bump(a, size);
+}
+
+/* Park a block that is no longer referenced.  Blocks below the smallest
+   class are simply left behind, as before. */
+static void arena_release(Arena *a, void *ptr, size_t size) {
+    if (!ptr) return;
+    if (a->frozen && cold_lower_thread_arena) a = cold_lower_thread_arena;
+    size = (size + 7u) & ~7u;
+    if (size < ((size_t)1 << ARENA_MIN_CLASS)) return;
+    int32_t c = arena_class_floor(size);
+    *(void **)ptr = a->free_list[c];
+    a->free_list[c] = ptr;
+    cold_arena_thread_stats.free_list_parked_bytes += size;
+}
+
+/* Grow an array from old_size to new_size bytes, keeping the first
+   keep_size bytes and zeroing the rest.  The last allocation of the current
+   page is extended in place; otherwise a parked block of the right class is
+   reused before falling back to the bump pointer, and the old block is
+   parked for the next grower. */
+static void *arena_grow(Arena *a, void *old, size_t old_size, size_t keep_size,
+                        size_t new_size) {
+    if (a->frozen && cold_lower_thread_arena) a = cold_lower_thread_arena;
+    old_size = old ? (old_size + 7u) & ~7u : 0;
+    new_size = (new_size + 7u) & ~7u;
+    if (keep_size > old_size) keep_size = old_size;
+    if (old_size > 0 && new_size > old_size && a->current &&
+        (uint8_t *)old + old_size == a->current->ptr &&
+        a->current->ptr + (new_size - old_size) <= a->current->end) {
+        a->current->ptr += new_size - old_size;
+        a->used += new_size - old_size;
+        cold_arena_thread_stats.grow_in_place_bytes += old_size;
+        return old;
+    }
+    uint8_t *fresh = 0;
+    int32_t c = arena_class_ceil(new_size);
+    if (c < ARENA_SIZE_CLASSES && a->free_list[c]) {
+        fresh = a->free_list[c];
+        a->free_list[c] = *(void **)fresh;
+        cold_arena_thread_stats.free_list_reused_bytes += new_size;
+    } else {
+        fresh = arena_bump(a, new_size);
+    }
+    memset(fresh + keep_size, 0, new_size - keep_size);
+    if (keep_size > 0) memcpy(fresh, old, keep_size);
+    arena_release(a, old, old_size);
+    return fresh;
+}
+
 /* ================================================================
  * Source spans
  * ================================================================ */
@@ -194,7 +380,23 @@ typedef struct Span {
 #define COLD_MAX_VARIANT_FIELDS 8
 #define COLD_MAX_OBJECT_FIELDS 64
 
-static Span source_open(const char *path) {
+/* Set in a `serve` worker child: every source_open is reported on this fd
+   so the server can validate a cached result against the files the build
+   read.  Inputs read any other way go through cold_serve_record_dep too,
+   or through cold_serve_record_untracked, which keeps the result out of
+   the cache. */
+static int cold_serve_dep_fd = -1;
+static void cold_serve_record_dep(const char *path, Span source);
+static void cold_serve_record_untracked(const char *path);
+
+/* Also set in a `serve` worker child: the request key that seeds the keys of
+   the server's function body cache (see parse_fn_body), or 0 outside the
+   server. */
+static uint64_t cold_serve_body_context = 0;
+static struct BodyIR *cold_serve_body_lookup(uint64_t key, Arena *arena, int32_t *consumed);
+static void cold_serve_body_offer(uint64_t key, const struct BodyIR *body, int32_t consumed);
+
+static Span source_map_file(const char *path) {
     Span source = {0};
     int fd = open(path, O_RDONLY);
     if (fd < 0) return source;
@@ -219,6 +421,12 @@ static Span source_open(const char *path) {
     return source;
 }
 
+static Span source_open(const char *path) {
+    Span source = source_map_file(path);
+    if (cold_serve_dep_fd >= 0) cold_serve_record_dep(path, source);
+    return source;
+}
+
 static Span span_sub(Span s, int32_t start, int32_t end) {
     if (start < 0) start = 0;
     if (end > s.len) end = s.len;
@@ -501,6 +709,18 @@ static int32_t cold_flag_values(int argc,
     return count;
 }
 
+/* Number of times flag occurs, for sizing the cold_flag_values array. */
+static int32_t cold_flag_count(int argc, char **argv, const char *flag) {
+    size_t flag_len = strlen(flag);
+    int32_t count = 0;
+    for (int i = 2; i < argc; i++) {
+        const char *arg = argv[i];
+        if (strncmp(arg, flag, flag_len) != 0) continue;
+        if (arg[flag_len] == ':' || arg[flag_len] == '=' || arg[flag_len] == '\0') count++;
+    }
+    return count;
+}
+
 static bool cold_span_eq_cstr(Span span, const char *text) {
     return span_eq(span, text);
 }
@@ -1357,6 +1577,40 @@ static uint64_t cold_fnv1a64_update_bytes(uint64_t hash, const uint8_t *ptr, siz
     return hash;
 }
 
+static void cold_serve_write_dep_line(const char *line, int n) {
+    for (int off = 0; off < n;) {
+        ssize_t w = write(cold_serve_dep_fd, line + off, (size_t)(n - off));
+        if (w <= 0) return;
+        off += (int)w;
+    }
+}
+
+static void cold_serve_record_dep(const char *path, Span source) {
+    cold_lower_effects++;
+    char line[PATH_MAX + 32];
+    int n = source.len > 0
+        ? snprintf(line, sizeof(line), "%016llx %s\n",
+                   (unsigned long long)cold_fnv1a64_update_bytes(1469598103934665603ULL,
+                                                                 source.ptr, (size_t)source.len),
+                   path)
+        : snprintf(line, sizeof(line), "- %s\n", path);
+    if (n <= 0 || (size_t)n >= sizeof(line)) {
+        cold_serve_record_untracked("<long path>");
+        return;
+    }
+    cold_serve_write_dep_line(line, n);
+}
+
+/* An input whose effect cannot be checked by content hash (a directory
+   listing, a stat).  The server does not cache a result that has one. */
+static void cold_serve_record_untracked(const char *path) {
+    cold_lower_effects++;
+    char line[PATH_MAX + 32];
+    int n = snprintf(line, sizeof(line), "! %s\n", path);
+    if (n <= 0 || (size_t)n >= sizeof(line)) n = snprintf(line, sizeof(line), "! <long path>\n");
+    cold_serve_write_dep_line(line, n);
+}
+
 static Span cold_cstr_span(const char *text) {
     return (Span){(const uint8_t *)text, (int32_t)strlen(text)};
 }
@@ -1879,6 +2133,11 @@ static bool cold_manifest_stats(ColdContract *contract, ColdManifestStats *stats
         }
 
         struct stat st;
+        if (cold_serve_dep_fd >= 0) {
+            /* The sizes feed the report: key a served result on the bytes. */
+            Span data = source_open(path);
+            if (data.len > 0) munmap((void *)data.ptr, (size_t)data.len);
+        }
         if (stat(path, &st) != 0 || !S_ISREG(st.st_mode)) {
             stats->missing_count++;
             if (stats->first_missing[0] == '\0') snprintf(stats->first_missing, sizeof(stats->first_missing), "%s", path);
@@ -2216,6 +2475,134 @@ static void cold_print_elapsed_ms(FILE *file, const char *key, uint64_t elapsed_
             (unsigned long long)(elapsed_us % 1000ULL));
 }
 
+/* ================================================================
+ * Chrome trace-event spans (--trace-out:<file>)
+ *   Per-function "X" events for parse / optimize / licm / codegen and
+ *   one event per patch-resolution pass.  Disabled tracing costs one
+ *   branch per span; events are buffered and written once at exit.
+ * ================================================================ */
+#define COLD_TRACE_NAME_CAP 96
+
+typedef struct ColdTraceEvent {
+    const char *phase;
+    char fn[COLD_TRACE_NAME_CAP];
+    uint64_t start_us;
+    uint64_t dur_us;
+    int32_t tid;
+    int32_t items;
+} ColdTraceEvent;
+
+static bool cold_trace_enabled = false;
+static uint64_t cold_trace_origin_us = 0;
+static ColdTraceEvent *cold_trace_events = 0;
+static int32_t cold_trace_count = 0;
+static int32_t cold_trace_cap = 0;
+static int32_t cold_trace_next_tid = 0;
+static pthread_mutex_t cold_trace_lock = PTHREAD_MUTEX_INITIALIZER;
+static _Thread_local int32_t cold_trace_tid = 0;
+
+static uint64_t cold_trace_begin(void) {
+    return cold_trace_enabled ? cold_now_us() : 0;
+}
+
+static int32_t cold_trace_thread_id(void) {
+    if (cold_trace_tid == 0)
+        cold_trace_tid = __atomic_add_fetch(&cold_trace_next_tid, 1, __ATOMIC_RELAXED);
+    return cold_trace_tid;
+}
+
+static void cold_trace_end_items(const char *phase, Span fn, uint64_t start_us, int32_t items) {
+    if (!cold_trace_enabled) return;
+    uint64_t end_us = cold_now_us();
+    ColdTraceEvent ev;
+    int32_t n = fn.ptr && fn.len > 0 ? fn.len : 0;
+    if (n > COLD_TRACE_NAME_CAP - 1) n = COLD_TRACE_NAME_CAP - 1;
+    if (n > 0) memcpy(ev.fn, fn.ptr, (size_t)n);
+    ev.fn[n] = '\0';
+    ev.phase = phase;
+    ev.start_us = start_us >= cold_trace_origin_us ? start_us - cold_trace_origin_us : 0;
+    ev.dur_us = end_us >= start_us ? end_us - start_us : 0;
+    ev.tid = cold_trace_thread_id();
+    ev.items = items;
+    pthread_mutex_lock(&cold_trace_lock);
+    if (cold_trace_count >= cold_trace_cap) {
+        int32_t next = cold_trace_cap ? cold_trace_cap * 2 : 1024;
+        ColdTraceEvent *grown = realloc(cold_trace_events, (size_t)next * sizeof(ColdTraceEvent));
+        if (!grown) {
+            pthread_mutex_unlock(&cold_trace_lock);
+            return;
+        }
+        cold_trace_events = grown;
+        cold_trace_cap = next;
+    }
+    cold_trace_events[cold_trace_count++] = ev;
+    pthread_mutex_unlock(&cold_trace_lock);
+}
+
+static void cold_trace_end(const char *phase, Span fn, uint64_t start_us) {
+    cold_trace_end_items(phase, fn, start_us, -1);
+}
+
+static void cold_trace_start(const char *path) {
+    if (!path || !path[0]) return;
+    cold_trace_origin_us = cold_now_us();
+    cold_trace_count = 0;
+    cold_trace_tid = 0;
+    cold_trace_next_tid = 0;
+    (void)cold_trace_thread_id();   /* main thread is tid 1 */
+    cold_trace_enabled = true;
+}
+
+static void cold_trace_write_json_string(FILE *file, const char *text) {
+    fputc('"', file);
+    for (const unsigned char *p = (const unsigned char *)text; *p; p++) {
+        if (*p == '"' || *p == '\\') fprintf(file, "\\%c", *p);
+        else if (*p < 0x20) fprintf(file, "\\u%04x", *p);
+        else fputc(*p, file);
+    }
+    fputc('"', file);
+}
+
+static bool cold_trace_finish(const char *path) {
+    if (!cold_trace_enabled) return true;
+    cold_trace_enabled = false;
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "[cheng_cold] cannot write trace: %s\n", path);
+        return false;
+    }
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", file);
+    int32_t max_tid = 0;
+    for (int32_t i = 0; i < cold_trace_count; i++)
+        if (cold_trace_events[i].tid > max_tid) max_tid = cold_trace_events[i].tid;
+    for (int32_t t = 1; t <= max_tid; t++) {
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                      "\"args\":{\"name\":\"%s%d\"}}",
+                t == 1 ? "" : ",\n", t, t == 1 ? "main-" : "worker-", t);
+    }
+    for (int32_t i = 0; i < cold_trace_count; i++) {
+        const ColdTraceEvent *ev = &cold_trace_events[i];
+        fputs(max_tid > 0 || i > 0 ? ",\n{\"name\":" : "{\"name\":", file);
+        cold_trace_write_json_string(file, ev->fn[0] ? ev->fn : ev->phase);
+        fprintf(file, ",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%llu,\"dur\":%llu,\"pid\":1,\"tid\":%d,"
+                      "\"args\":{\"phase\":\"%s\"",
+                ev->phase,
+                (unsigned long long)ev->start_us,
+                (unsigned long long)ev->dur_us,
+                ev->tid,
+                ev->phase);
+        if (ev->items >= 0) fprintf(file, ",\"items\":%d", ev->items);
+        fputs("}}", file);
+    }
+    fputs("\n]}\n", file);
+    bool ok = fclose(file) == 0;
+    free(cold_trace_events);
+    cold_trace_events = 0;
+    cold_trace_count = 0;
+    cold_trace_cap = 0;
+    return ok;
+}
+
 static bool cold_file_contains_text(const char *path, const char *needle) {
     Span haystack = source_open(path);
     int32_t n = (int32_t)strlen(needle);
@@ -2463,6 +2850,224 @@ static bool cold_bridge_command(char *out, size_t cap, const char *exe,
     return true;
 }
 
+static bool cold_path_with_suffix(char *out, size_t cap, const char *base, const char *suffix) {
+    size_t base_len = strlen(base);
+    size_t suffix_len = strlen(suffix);
+    if (base_len + suffix_len + 1u > cap) return false;
+    memcpy(out, base, base_len);
+    memcpy(out + base_len, suffix, suffix_len);
+    out[base_len + suffix_len] = '\0';
+    return true;
+}
+
+static bool cold_write_normalized_contract_file(const char *path, ColdContract *contract);
+
+/* Bootstrap bridge pipeline.  Each compile-bootstrap / self-check step is
+   keyed by the bytes of the compiler that runs it plus the bridge inputs
+   (the --in contract and its bootstrap manifest).  A step whose stamp
+   matches the key and whose artifact still hashes to the recorded value is
+   skipped.  Steps of one wave only depend on earlier waves and run as
+   concurrent child processes, at most `jobs` at a time. */
+typedef struct ColdBridgeStep {
+    const char *label;
+    const char *exe;
+    const char *subcommand;
+    const char *in_path;
+    const char *out_path;
+    const char *report_path;
+    const char *log_path;
+    char stamp_path[PATH_MAX];
+    uint64_t key;
+    bool cached;
+    pid_t pid;
+} ColdBridgeStep;
+
+static uint64_t cold_bridge_hash_file(uint64_t hash, const char *path) {
+    Span data = source_open(path);
+    if (data.len <= 0) return cold_fnv1a64_update(hash, (Span){(const uint8_t *)"<missing>", 9});
+    hash = cold_fnv1a64_update_bytes(hash, data.ptr, (size_t)data.len);
+    munmap((void *)data.ptr, (size_t)data.len);
+    return hash;
+}
+
+static const char *cold_bridge_step_artifact(const ColdBridgeStep *step) {
+    return step->out_path ? step->out_path : step->log_path;
+}
+
+static bool cold_bridge_step_cached(ColdBridgeStep *step) {
+    Span stamp = source_open(step->stamp_path);
+    if (stamp.len <= 0) return false;
+    unsigned long long key = 0;
+    unsigned long long artifact = 0;
+    char text[128];
+    int32_t n = stamp.len < (int32_t)sizeof(text) - 1 ? stamp.len : (int32_t)sizeof(text) - 1;
+    memcpy(text, stamp.ptr, (size_t)n);
+    text[n] = '\0';
+    munmap((void *)stamp.ptr, (size_t)stamp.len);
+    if (sscanf(text, "key=%llx\nartifact=%llx", &key, &artifact) != 2) return false;
+    if ((uint64_t)key != step->key) return false;
+    if (step->report_path && access(step->report_path, F_OK) != 0) return false;
+    const char *path = cold_bridge_step_artifact(step);
+    if (access(path, F_OK) != 0) return false;
+    return cold_bridge_hash_file(1469598103934665603ULL, path) == (uint64_t)artifact;
+}
+
+static bool cold_bridge_write_stamp(const ColdBridgeStep *step) {
+    char text[128];
+    uint64_t artifact = cold_bridge_hash_file(1469598103934665603ULL,
+                                              cold_bridge_step_artifact(step));
+    snprintf(text, sizeof(text), "key=%016llx\nartifact=%016llx\n",
+             (unsigned long long)step->key, (unsigned long long)artifact);
+    return cold_write_text_file(step->stamp_path, text);
+}
+
+static bool cold_bridge_run_wave(ColdBridgeStep *steps, int32_t count, int32_t jobs,
+                                 uint64_t inputs_hash, bool use_cache,
+                                 int32_t *cached_steps) {
+    char *cmd = malloc(PATH_MAX * 36);
+    if (!cmd) die("out of memory building bootstrap bridge command");
+    bool ok = true;
+    int32_t next = 0;
+    int32_t running = 0;
+    for (int32_t i = 0; i < count; i++) {
+        ColdBridgeStep *step = &steps[i];
+        step->pid = 0;
+        step->cached = false;
+        if (!use_cache) continue;
+        uint64_t key = cold_fnv1a64_update(inputs_hash,
+                                           (Span){(const uint8_t *)step->subcommand,
+                                                  (int32_t)strlen(step->subcommand)});
+        step->key = cold_bridge_hash_file(key, step->exe);
+        step->cached = cold_bridge_step_cached(step);
+        if (step->cached) {
+            (*cached_steps)++;
+            printf("bootstrap_bridge_cached=%s\n", step->label);
+        } else {
+            unlink(step->stamp_path);
+        }
+    }
+    for (;;) {
+        while (ok && running < jobs && next < count) {
+            ColdBridgeStep *step = &steps[next++];
+            if (step->cached) continue;
+            if (!cold_bridge_command(cmd, PATH_MAX * 36, step->exe, step->subcommand,
+                                     step->in_path, step->out_path, step->report_path,
+                                     step->log_path)) {
+                fprintf(stderr, "[cheng_cold] %s command too long\n", step->label);
+                ok = false;
+                break;
+            }
+            fflush(stdout);
+            fflush(stderr);
+            pid_t pid = fork();
+            if (pid < 0) {
+                fprintf(stderr, "[cheng_cold] %s fork failed\n", step->label);
+                ok = false;
+                break;
+            }
+            if (pid == 0) {
+                execl("/bin/sh", "sh", "-c", cmd, (char *)0);
+                _exit(127);
+            }
+            step->pid = pid;
+            running++;
+        }
+        if (running == 0) break;
+        int status = 0;
+        pid_t done = waitpid(-1, &status, 0);
+        if (done < 0) {
+            if (errno == EINTR) continue;
+            /* Never return with children still running: stop and reap
+               the steps this wave started. */
+            fprintf(stderr, "[cheng_cold] bootstrap bridge waitpid failed\n");
+            for (int32_t i = 0; i < count; i++) {
+                ColdBridgeStep *step = &steps[i];
+                if (step->pid <= 0) continue;
+                kill(step->pid, SIGKILL);
+                for (;;) {
+                    if (waitpid(step->pid, &status, 0) >= 0 || errno != EINTR) break;
+                }
+                step->pid = 0;
+            }
+            ok = false;
+            break;
+        }
+        for (int32_t i = 0; i < count; i++) {
+            ColdBridgeStep *step = &steps[i];
+            if (step->pid != done) continue;
+            step->pid = 0;
+            running--;
+            if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+                if (use_cache) cold_bridge_write_stamp(step);
+            } else {
+                if (WIFEXITED(status)) {
+                    fprintf(stderr, "[cheng_cold] %s failed rc=%d\n", step->label, WEXITSTATUS(status));
+                } else {
+                    fprintf(stderr, "[cheng_cold] %s failed\n", step->label);
+                }
+                ok = false;
+            }
+            break;
+        }
+    }
+    free(cmd);
+    return ok;
+}
+
+/* In-process replacement for `<stage> print-contract`: read the contract
+   compile-bootstrap patched into the stage image and write it normalized. */
+static bool cold_bridge_write_stage_contract(const char *stage_path, const char *out_path) {
+    const char *contract_magic = "CHENG_COLD_EMBEDDED_CONTRACT_V1\n";
+    const char *path_magic = "CHENG_COLD_EMBEDDED_SOURCE_PATH_V1\n";
+    Span image = source_open(stage_path);
+    if (image.len <= 0) {
+        fprintf(stderr, "[cheng_cold] cannot read stage image: %s\n", stage_path);
+        return false;
+    }
+    int64_t contract_slot = cold_find_patch_slot((uint8_t *)image.ptr, (size_t)image.len,
+                                                 contract_magic, COLD_EMBEDDED_CONTRACT_CAP);
+    int64_t path_slot = cold_find_patch_slot((uint8_t *)image.ptr, (size_t)image.len,
+                                             path_magic, COLD_EMBEDDED_SOURCE_PATH_CAP);
+    bool ok = false;
+    if (contract_slot >= 0 && path_slot >= 0) {
+        size_t contract_magic_len = strlen(contract_magic);
+        size_t path_magic_len = strlen(path_magic);
+        const char *text = (const char *)image.ptr + contract_slot + contract_magic_len;
+        char source_path[COLD_EMBEDDED_SOURCE_PATH_CAP];
+        size_t path_len = strnlen((const char *)image.ptr + path_slot + path_magic_len,
+                                  COLD_EMBEDDED_SOURCE_PATH_CAP - path_magic_len);
+        memcpy(source_path, image.ptr + path_slot + path_magic_len, path_len);
+        source_path[path_len] = '\0';
+        Span contract_text = {(const uint8_t *)text,
+                              (int32_t)strnlen(text, COLD_EMBEDDED_CONTRACT_CAP - contract_magic_len)};
+        ColdContract contract;
+        ok = contract_text.len > 0 &&
+             cold_contract_parse_span(&contract, path_len > 0 ? source_path : "<embedded>",
+                                      contract_text) &&
+             cold_contract_validate(&contract) &&
+             cold_write_normalized_contract_file(out_path, &contract);
+    }
+    if (!ok) fprintf(stderr, "[cheng_cold] %s embedded contract unreadable\n", stage_path);
+    munmap((void *)image.ptr, (size_t)image.len);
+    return ok;
+}
+
+static int32_t cold_bridge_jobs(int argc, char **argv) {
+    const char *flag = cold_flag_value(argc, argv, "--jobs");
+    int32_t jobs = 0;
+    if (flag && flag[0] != '\0') {
+        jobs = atoi(flag);
+    } else if (getenv("BACKEND_JOBS")) {
+        jobs = cold_jobs_from_env();
+    } else {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        jobs = online > 0 ? (int32_t)online : 1;
+    }
+    if (jobs < 1) jobs = 1;
+    if (jobs > 16) jobs = 16;
+    return jobs;
+}
+
 int cold_cmd_bootstrap_bridge(int argc, char **argv, const char *self_path) {
     uint64_t start_us = cold_now_us();
     const char *cli_in = cold_flag_value(argc, argv, "--in");
@@ -2530,37 +3135,54 @@ int cold_cmd_bootstrap_bridge(int argc, char **argv, const char *self_path) {
     char abs_self[PATH_MAX];
     cold_absolute_path(self_path, abs_self, sizeof(abs_self));
 
-    char cmd[PATH_MAX * 36];
-    if (!cold_bridge_command(cmd, sizeof(cmd), abs_self, "compile-bootstrap",
-                             stage0_in_arg, stage0, stage0_report, stage0_compile_log) ||
-        !cold_run_shell(cmd, "stage0 compile-bootstrap")) return 1;
-    if (!cold_bridge_command(cmd, sizeof(cmd), stage0, "self-check",
-                             0, 0, 0, stage0_self_log) ||
-        !cold_run_shell(cmd, "stage0 self-check")) return 1;
-    if (!cold_bridge_command(cmd, sizeof(cmd), stage0, "compile-bootstrap",
-                             0, stage1, stage1_report, stage1_compile_log) ||
-        !cold_run_shell(cmd, "stage1 compile-bootstrap")) return 1;
-    if (!cold_bridge_command(cmd, sizeof(cmd), stage1, "self-check",
-                             0, 0, 0, stage1_self_log) ||
-        !cold_run_shell(cmd, "stage1 self-check")) return 1;
-    if (!cold_bridge_command(cmd, sizeof(cmd), stage1, "compile-bootstrap",
-                             0, stage2, stage2_report, stage2_compile_log) ||
-        !cold_run_shell(cmd, "stage2 compile-bootstrap")) return 1;
-    if (!cold_bridge_command(cmd, sizeof(cmd), stage2, "self-check",
-                             0, 0, 0, stage2_self_log) ||
-        !cold_run_shell(cmd, "stage2 self-check")) return 1;
-    if (!cold_bridge_command(cmd, sizeof(cmd), stage2, "compile-bootstrap",
-                             0, stage3, stage3_report, stage3_compile_log) ||
-        !cold_run_shell(cmd, "stage3 compile-bootstrap")) return 1;
-    if (!cold_bridge_command(cmd, sizeof(cmd), stage3, "self-check",
-                             0, 0, 0, stage3_self_log) ||
-        !cold_run_shell(cmd, "stage3 self-check")) return 1;
-    if (!cold_bridge_command(cmd, sizeof(cmd), stage2, "print-contract",
-                             0, 0, 0, stage2_contract) ||
-        !cold_run_shell(cmd, "stage2 print-contract")) return 1;
-    if (!cold_bridge_command(cmd, sizeof(cmd), stage3, "print-contract",
-                             0, 0, 0, stage3_contract) ||
-        !cold_run_shell(cmd, "stage3 print-contract")) return 1;
+    int32_t jobs = cold_bridge_jobs(argc, argv);
+    const char *stage_cache_flag = cold_flag_value(argc, argv, "--stage-cache");
+    bool use_cache = !stage_cache_flag || strcmp(stage_cache_flag, "0") != 0;
+    uint64_t inputs_hash = 1469598103934665603ULL;
+    if (stage0_in_arg) inputs_hash = cold_bridge_hash_file(inputs_hash, stage0_in_arg);
+    char manifest_path[PATH_MAX];
+    if (cold_contract_manifest_path(&contract, manifest_path, sizeof(manifest_path))) {
+        inputs_hash = cold_bridge_hash_file(inputs_hash, manifest_path);
+    }
+
+    /* stageN self-check and stageN+1 compile-bootstrap both only need stageN. */
+    ColdBridgeStep steps[8] = {
+        {"stage0 compile-bootstrap", abs_self, "compile-bootstrap", stage0_in_arg,
+         stage0, stage0_report, stage0_compile_log, "", 0, false, 0},
+        {"stage0 self-check", stage0, "self-check", 0, 0, 0, stage0_self_log,
+         "", 0, false, 0},
+        {"stage1 compile-bootstrap", stage0, "compile-bootstrap", 0,
+         stage1, stage1_report, stage1_compile_log, "", 0, false, 0},
+        {"stage1 self-check", stage1, "self-check", 0, 0, 0, stage1_self_log,
+         "", 0, false, 0},
+        {"stage2 compile-bootstrap", stage1, "compile-bootstrap", 0,
+         stage2, stage2_report, stage2_compile_log, "", 0, false, 0},
+        {"stage2 self-check", stage2, "self-check", 0, 0, 0, stage2_self_log,
+         "", 0, false, 0},
+        {"stage3 compile-bootstrap", stage2, "compile-bootstrap", 0,
+         stage3, stage3_report, stage3_compile_log, "", 0, false, 0},
+        {"stage3 self-check", stage3, "self-check", 0, 0, 0, stage3_self_log,
+         "", 0, false, 0},
+    };
+    for (int32_t i = 0; i < 8; i++) {
+        const char *artifact = cold_bridge_step_artifact(&steps[i]);
+        if (!cold_path_with_suffix(steps[i].stamp_path, sizeof(steps[i].stamp_path),
+                                   artifact, ".stamp")) {
+            fprintf(stderr, "[cheng_cold] stamp path too long: %s\n", artifact);
+            return 1;
+        }
+    }
+    /* Waves: {stage0 compile} {stage0 check, stage1 compile} ...
+       {stage3 check}. */
+    int32_t cached_steps = 0;
+    if (!cold_bridge_run_wave(&steps[0], 1, jobs, inputs_hash, use_cache, &cached_steps)) return 1;
+    for (int32_t i = 1; i < 8; i += 2) {
+        int32_t wave = i + 1 < 8 ? 2 : 1;
+        if (!cold_bridge_run_wave(&steps[i], wave, jobs, inputs_hash, use_cache, &cached_steps))
+            return 1;
+    }
+    if (!cold_bridge_write_stage_contract(stage2, stage2_contract) ||
+        !cold_bridge_write_stage_contract(stage3, stage3_contract)) return 1;
 
     if (!cold_files_equal(stage2_contract, stage3_contract)) {
         fprintf(stderr, "[cheng_cold] stage2/stage3 contract fixed point mismatch\n");
@@ -2590,20 +3212,12 @@ int cold_cmd_bootstrap_bridge(int argc, char **argv, const char *self_path) {
     printf("stage2=%s\n", stage2);
     printf("stage3=%s\n", stage3);
     printf("fixed_point=stage2_stage3_contract_match\n");
+    printf("bootstrap_bridge_jobs=%d\n", jobs);
+    printf("bootstrap_bridge_cached_steps=%d\n", cached_steps);
     cold_print_elapsed_ms(stdout, "cold_bootstrap_bridge_elapsed_ms", elapsed_us);
     return 0;
 }
 
-static bool cold_path_with_suffix(char *out, size_t cap, const char *base, const char *suffix) {
-    size_t base_len = strlen(base);
-    size_t suffix_len = strlen(suffix);
-    if (base_len + suffix_len + 1u > cap) return false;
-    memcpy(out, base, base_len);
-    memcpy(out + base_len, suffix, suffix_len);
-    out[base_len + suffix_len] = '\0';
-    return true;
-}
-
 static bool cold_write_normalized_contract_file(const char *path, ColdContract *contract) {
     char parent[PATH_MAX];
     if (cold_parent_dir(path, parent, sizeof(parent)) && !cold_mkdir_p(parent)) return false;
@@ -3205,8 +3819,6 @@ int cold_cmd_build_backend_driver(int argc, char **argv, const char *self_path)
     return 0;
 }
 
-static int32_t cold_jobs_from_env(void);
-
 static void cold_usage(void) {
     puts("cheng_cold");
     puts("usage:");
@@ -3214,12 +3826,16 @@ static void cold_usage(void) {
     puts("  cheng_cold print-contract --in:<path>");
     puts("  cheng_cold self-check --in:<path>");
     puts("  cheng_cold compile-bootstrap --in:<path> --out:<path> [--report-out:<path>]");
-    puts("  cheng_cold bootstrap-bridge [--in:<path>] [--out-dir:<path>]");
+    puts("  cheng_cold bootstrap-bridge [--in:<path>] [--out-dir:<path>] [--jobs:<n>] [--stage-cache:0|1]");
     puts("  cheng_cold build-backend-driver [--in:<contract>] [--out:<path>] [--out-dir:<dir>] [--report-out:<path>] [--map-out:<path>] [--index-out:<path>]");
-    puts("  cheng_cold system-link-exec --in:<source> [--csg-in:<facts>|--csg-out:<facts>] --out:<path> [--emit:exe|obj|csg] [--target:arm64-apple-darwin] [--report-out:<path>]");
+    puts("  cheng_cold system-link-exec --in:<source> [--csg-in:<facts>|--csg-out:<facts>] --out:<path> [--emit:exe|obj|csg] [--target:arm64-apple-darwin] [--report-out:<path>] [--trace-out:<path>]");
     puts("    --emit:exe   produce standalone executable (default)");
     puts("    --emit:obj   emit CSG facts as intermediate object representation");
     puts("    --emit:csg   same as --emit:obj");
+    puts("    --wasm-features:all|mvp|bulk,simd  wasm32 target features (default all; mvp = scalar loops)");
+    puts("    --trace-out:<path>  write Chrome trace-event JSON (per-function parse/optimize/licm/codegen/patch spans)");
+    puts("  cheng_cold serve --socket:<path>   (replays unchanged builds; misses reuse unchanged function bodies)");
+    puts("  cheng_cold serve-client --socket:<path> <command> [args...]   (serve-stop stops the server)");
     puts("  reserved backend commands hard-fail until their real paths exist");
     puts("  cheng_cold <out> [source]");
 }
@@ -3511,6 +4127,7 @@ typedef struct BodyIR {
     int32_t *op_c;
     int32_t op_count;
     int32_t op_cap;
+    bool *op_bounds_proven;   /* per op while a backend emits the body, or NULL */
 
     int32_t *term_kind;
     int32_t *term_value;
@@ -3561,11 +4178,22 @@ typedef struct BodyIR {
     Span debug_name;
     int32_t sret_slot;
     bool has_fallback;
+    int32_t profile_counters;  /* data offset of the block counters while instrumenting, -1 = none */
+    uint64_t *block_profile;   /* entries per block from --profile-use, or NULL */
 
     Arena *arena;
 } BodyIR;
 
-static BodyIR *cold_current_parsing_body = 0;
+static _Thread_local BodyIR *cold_current_parsing_body = 0;
+
+static void cold_eliminate_bounds_checks(BodyIR *body);
+static void cold_release_bounds_checks(BodyIR *body);
+static void cold_profile_layout_blocks(BodyIR *body);
+
+/* Bounds-check elimination proved 0 <= index < len for this index op. */
+static bool cold_op_bounds_proven(BodyIR *body, int32_t op) {
+    return body->op_bounds_proven && body->op_bounds_proven[op];
+}
 
 static BodyIR *body_new(Arena *arena) {
     BodyIR *body = arena_alloc(arena, sizeof(BodyIR));
@@ -3574,141 +4202,97 @@ static BodyIR *body_new(Arena *arena) {
     body->return_size = 4;
     body->sret_slot = -1;
     body->has_fallback = false;
+    body->profile_counters = -1;
     return body;
 }
 
+/* Outgrown BodyIR arrays go back to the arena through arena_grow, so a
+   large body does not leave every intermediate capacity behind. */
+static void *body_grow_array(BodyIR *body, void *old, int32_t old_cap,
+                             int32_t count, int32_t next, size_t elem) {
+    return arena_grow(body->arena, old, (size_t)old_cap * elem,
+                      (size_t)count * elem, (size_t)next * elem);
+}
+
 static void body_ensure_slots(BodyIR *body) {
     if (body->slot_count < body->slot_cap) return;
-    int32_t next = body->slot_cap ? body->slot_cap * 2 : 32;
-    int32_t *kind = arena_alloc(body->arena, (size_t)next * sizeof(int32_t));
-    int32_t *offset = arena_alloc(body->arena, (size_t)next * sizeof(int32_t));
-    int32_t *size = arena_alloc(body->arena, (size_t)next * sizeof(int32_t));
-    int32_t *aux = arena_alloc(body->arena, (size_t)next * sizeof(int32_t));
-    Span *type = arena_alloc(body->arena, (size_t)next * sizeof(Span));
-    int32_t *no_alias = arena_alloc(body->arena, (size_t)next * sizeof(int32_t));
-    if (body->slot_count > 0) {
-        memcpy(kind, body->slot_kind, (size_t)body->slot_count * sizeof(int32_t));
-        memcpy(offset, body->slot_offset, (size_t)body->slot_count * sizeof(int32_t));
-        memcpy(size, body->slot_size, (size_t)body->slot_count * sizeof(int32_t));
-        memcpy(aux, body->slot_aux, (size_t)body->slot_count * sizeof(int32_t));
-        memcpy(type, body->slot_type, (size_t)body->slot_count * sizeof(Span));
-        if (body->slot_no_alias)
-            memcpy(no_alias, body->slot_no_alias, (size_t)body->slot_count * sizeof(int32_t));
-    }
-    body->slot_kind = kind;
-    body->slot_offset = offset;
-    body->slot_size = size;
-    body->slot_aux = aux;
-    body->slot_type = type;
-    body->slot_no_alias = no_alias;
+    int32_t cap = body->slot_cap;
+    int32_t count = body->slot_count;
+    int32_t next = cap ? cap * 2 : 32;
+    body->slot_kind = body_grow_array(body, body->slot_kind, cap, count, next, sizeof(int32_t));
+    body->slot_offset = body_grow_array(body, body->slot_offset, cap, count, next, sizeof(int32_t));
+    body->slot_size = body_grow_array(body, body->slot_size, cap, count, next, sizeof(int32_t));
+    body->slot_aux = body_grow_array(body, body->slot_aux, cap, count, next, sizeof(int32_t));
+    body->slot_type = body_grow_array(body, body->slot_type, cap, count, next, sizeof(Span));
+    body->slot_no_alias = body_grow_array(body, body->slot_no_alias, cap, count, next, sizeof(int32_t));
     body->slot_cap = next;
 }
 
 static void body_ensure_ops(BodyIR *body) {
     if (body->op_count < body->op_cap) return;
-    int32_t next = body->op_cap ? body->op_cap * 2 : 64;
-    int32_t *kind = arena_alloc(body->arena, (size_t)next * sizeof(int32_t));
-    int32_t *dst = arena_alloc(body->arena, (size_t)next * sizeof(int32_t));
-    int32_t *a = arena_alloc(body->arena, (size_t)next * sizeof(int32_t));
-    int32_t *b = arena_alloc(body->arena, (size_t)next * sizeof(int32_t));
-    int32_t *c = arena_alloc(body->arena, (size_t)next * sizeof(int32_t));
-    if (body->op_count > 0) {
-        memcpy(kind, body->op_kind, (size_t)body->op_count * sizeof(int32_t));
-        memcpy(dst, body->op_dst, (size_t)body->op_count * sizeof(int32_t));
-        memcpy(a, body->op_a, (size_t)body->op_count * sizeof(int32_t));
-        memcpy(b, body->op_b, (size_t)body->op_count * sizeof(int32_t));
-        memcpy(c, body->op_c, (size_t)body->op_count * sizeof(int32_t));
-    }
-    body->op_kind = kind;
-    body->op_dst = dst;
-    body->op_a = a;
-    body->op_b = b;
-    body->op_c = c;
+    int32_t cap = body->op_cap;
+    int32_t count = body->op_count;
+    int32_t next = cap ? cap * 2 : 64;
+    body->op_kind = body_grow_array(body, body->op_kind, cap, count, next, sizeof(int32_t));
+    body->op_dst = body_grow_array(body, body->op_dst, cap, count, next, sizeof(int32_t));
+    body->op_a = body_grow_array(body, body->op_a, cap, count, next, sizeof(int32_t));
+    body->op_b = body_grow_array(body, body->op_b, cap, count, next, sizeof(int32_t));
+    body->op_c = body_grow_array(body, body->op_c, cap, count, next, sizeof(int32_t));
     body->op_cap = next;
 }
 
 static void body_ensure_terms(BodyIR *body) {
     if (body->term_count < body->term_cap) return;
-    int32_t next = body->term_cap ? body->term_cap * 2 : 16;
-    int32_t *kind = arena_alloc(body->arena, (size_t)next * sizeof(int32_t));
-    int32_t *value = arena_alloc(body->arena, (size_t)next * sizeof(int32_t));
-    int32_t *case_start = arena_alloc(body->arena, (size_t)next * sizeof(int32_t));
-    int32_t *case_count = arena_alloc(body->arena, (size_t)next * sizeof(int32_t));
-    int32_t *true_block = arena_alloc(body->arena, (size_t)next * sizeof(int32_t));
-    int32_t *false_block = arena_alloc(body->arena, (size_t)next * sizeof(int32_t));
-    if (body->term_count > 0) {
-        memcpy(kind, body->term_kind, (size_t)body->term_count * sizeof(int32_t));
-        memcpy(value, body->term_value, (size_t)body->term_count * sizeof(int32_t));
-        memcpy(case_start, body->term_case_start, (size_t)body->term_count * sizeof(int32_t));
-        memcpy(case_count, body->term_case_count, (size_t)body->term_count * sizeof(int32_t));
-        memcpy(true_block, body->term_true_block, (size_t)body->term_count * sizeof(int32_t));
-        memcpy(false_block, body->term_false_block, (size_t)body->term_count * sizeof(int32_t));
-    }
-    body->term_kind = kind;
-    body->term_value = value;
-    body->term_case_start = case_start;
-    body->term_case_count = case_count;
-    body->term_true_block = true_block;
-    body->term_false_block = false_block;
+    int32_t cap = body->term_cap;
+    int32_t count = body->term_count;
+    int32_t next = cap ? cap * 2 : 16;
+    body->term_kind = body_grow_array(body, body->term_kind, cap, count, next, sizeof(int32_t));
+    body->term_value = body_grow_array(body, body->term_value, cap, count, next, sizeof(int32_t));
+    body->term_case_start = body_grow_array(body, body->term_case_start, cap, count, next, sizeof(int32_t));
+    body->term_case_count = body_grow_array(body, body->term_case_count, cap, count, next, sizeof(int32_t));
+    body->term_true_block = body_grow_array(body, body->term_true_block, cap, count, next, sizeof(int32_t));
+    body->term_false_block = body_grow_array(body, body->term_false_block, cap, count, next, sizeof(int32_t));
     body->term_cap = next;
 }
 
 static void body_ensure_blocks(BodyIR *body) {
     if (body->block_count < body->block_cap) return;
-    int32_t next = body->block_cap ? body->block_cap * 2 : 16;
-    int32_t *op_start = arena_alloc(body->arena, (size_t)next * sizeof(int32_t));
-    int32_t *op_count = arena_alloc(body->arena, (size_t)next * sizeof(int32_t));
-    int32_t *term = arena_alloc(body->arena, (size_t)next * sizeof(int32_t));
-    if (body->block_count > 0) {
-        memcpy(op_start, body->block_op_start, (size_t)body->block_count * sizeof(int32_t));
-        memcpy(op_count, body->block_op_count, (size_t)body->block_count * sizeof(int32_t));
-        memcpy(term, body->block_term, (size_t)body->block_count * sizeof(int32_t));
-    }
-    body->block_op_start = op_start;
-    body->block_op_count = op_count;
-    body->block_term = term;
+    int32_t cap = body->block_cap;
+    int32_t count = body->block_count;
+    int32_t next = cap ? cap * 2 : 16;
+    body->block_op_start = body_grow_array(body, body->block_op_start, cap, count, next, sizeof(int32_t));
+    body->block_op_count = body_grow_array(body, body->block_op_count, cap, count, next, sizeof(int32_t));
+    body->block_term = body_grow_array(body, body->block_term, cap, count, next, sizeof(int32_t));
     body->block_cap = next;
 }
 
 static void body_ensure_switches(BodyIR *body) {
     if (body->switch_count < body->switch_cap) return;
-    int32_t next = body->switch_cap ? body->switch_cap * 2 : 16;
-    int32_t *tag = arena_alloc(body->arena, (size_t)next * sizeof(int32_t));
-    int32_t *block = arena_alloc(body->arena, (size_t)next * sizeof(int32_t));
-    int32_t *term = arena_alloc(body->arena, (size_t)next * sizeof(int32_t));
-    if (body->switch_count > 0) {
-        memcpy(tag, body->switch_tag, (size_t)body->switch_count * sizeof(int32_t));
-        memcpy(block, body->switch_block, (size_t)body->switch_count * sizeof(int32_t));
-        memcpy(term, body->switch_term, (size_t)body->switch_count * sizeof(int32_t));
-    }
-    body->switch_tag = tag;
-    body->switch_block = block;
-    body->switch_term = term;
+    int32_t cap = body->switch_cap;
+    int32_t count = body->switch_count;
+    int32_t next = cap ? cap * 2 : 16;
+    body->switch_tag = body_grow_array(body, body->switch_tag, cap, count, next, sizeof(int32_t));
+    body->switch_block = body_grow_array(body, body->switch_block, cap, count, next, sizeof(int32_t));
+    body->switch_term = body_grow_array(body, body->switch_term, cap, count, next, sizeof(int32_t));
     body->switch_cap = next;
 }
 
 static void body_ensure_call_args(BodyIR *body) {
     if (body->call_arg_count < body->call_arg_cap) return;
-    int32_t next = body->call_arg_cap ? body->call_arg_cap * 2 : 32;
-    int32_t *slot = arena_alloc(body->arena, (size_t)next * sizeof(int32_t));
-    int32_t *offset = arena_alloc(body->arena, (size_t)next * sizeof(int32_t));
-    if (body->call_arg_count > 0) {
-        memcpy(slot, body->call_arg_slot, (size_t)body->call_arg_count * sizeof(int32_t));
-        memcpy(offset, body->call_arg_offset, (size_t)body->call_arg_count * sizeof(int32_t));
-    }
-    body->call_arg_slot = slot;
-    body->call_arg_offset = offset;
+    int32_t cap = body->call_arg_cap;
+    int32_t count = body->call_arg_count;
+    int32_t next = cap ? cap * 2 : 32;
+    body->call_arg_slot = body_grow_array(body, body->call_arg_slot, cap, count, next, sizeof(int32_t));
+    body->call_arg_offset = body_grow_array(body, body->call_arg_offset, cap, count, next, sizeof(int32_t));
     body->call_arg_cap = next;
 }
 
 static void body_ensure_string_literals(BodyIR *body) {
     if (body->string_literal_count < body->string_literal_cap) return;
-    int32_t next = body->string_literal_cap ? body->string_literal_cap * 2 : 16;
-    Span *fresh = arena_alloc(body->arena, (size_t)next * sizeof(Span));
-    if (body->string_literal_count > 0) {
-        memcpy(fresh, body->string_literal, (size_t)body->string_literal_count * sizeof(Span));
-    }
-    body->string_literal = fresh;
+    int32_t cap = body->string_literal_cap;
+    int32_t next = cap ? cap * 2 : 16;
+    body->string_literal = body_grow_array(body, body->string_literal, cap,
+                                           body->string_literal_count, next, sizeof(Span));
     body->string_literal_cap = next;
 }
 
@@ -3878,7 +4462,8 @@ static uint64_t cold_body_ir_canonical_hash_normalized(BodyIR *body) {
             continue;
         }
 
-        /* Associative flattening for ADD and MUL */
+        /* Associative flattening for ADD and MUL. An accumulator such as
+           j = j + k is its own def, so the stack bound ends the walk. */
         if ((kind == BODY_OP_I32_ADD || kind == BODY_OP_I32_MUL) && slot_def) {
             int32_t flat[64];
             int32_t fc = 0;
@@ -3892,7 +4477,7 @@ static uint64_t cold_body_ir_canonical_hash_normalized(BodyIR *body) {
                 } else {
                     int32_t def = slot_def[s];
                     if (def >= 0 && def < body->op_count &&
-                        body->op_kind[def] == kind) {
+                        body->op_kind[def] == kind && sc + 2 <= 64) {
                         stk[sc++] = body->op_b[def];
                         stk[sc++] = body->op_a[def];
                     } else {
@@ -3932,7 +4517,7 @@ static uint64_t cold_body_ir_canonical_hash_normalized(BodyIR *body) {
                 } else {
                     int32_t def = slot_def[s];
                     if (def >= 0 && def < body->op_count &&
-                        body->op_kind[def] == kind) {
+                        body->op_kind[def] == kind && sc + 2 <= 64) {
                         stk[sc++] = body->op_b[def];
                         stk[sc++] = body->op_a[def];
                     } else {
@@ -4149,6 +4734,12 @@ typedef struct Symbols {
     int32_t global_count;
     int32_t global_cap;
     Arena *arena;
+    bool frozen;  /* set while function bodies are lowered in parallel */
+    uint32_t mutation_epoch;
+    bool fingerprint_ready;       /* symbols_fingerprint memo, valid for one epoch */
+    uint32_t fingerprint_epoch;
+    uint32_t fingerprint_retypes;
+    uint64_t fingerprint;
 } Symbols;
 
 typedef struct Local {
@@ -4166,7 +4757,7 @@ typedef struct Locals {
 
 #ifdef COLD_BACKEND_ONLY
 static Span cold_arena_span_copy(Arena *arena, Span text) {
-    uint8_t *ptr = arena_alloc(arena, (size_t)(text.len + 1));
+    uint8_t *ptr = arena_alloc_uninit(arena, (size_t)(text.len + 1));
     if (text.len > 0) memcpy(ptr, text.ptr, (size_t)text.len);
     ptr[text.len] = 0;
     return (Span){ptr, text.len};
@@ -4191,6 +4782,131 @@ static Symbols *symbols_new(Arena *arena) {
     return symbols;
 }
 
+/* Every semantic change to Symbols goes through this guard.  While the table
+   is frozen for parallel lowering the caller bails out to be re-run serially,
+   so frozen Symbols are never observed half-updated. */
+/* Object field stores retype a field in place (cold_store_object_field_slot)
+   without a Symbols pointer at hand; the count stands in for the epoch. */
+static uint32_t cold_object_field_retypes = 0;
+
+static void symbols_guard_mutation(Symbols *symbols) {
+    if (!symbols) return;
+    if (symbols->frozen) {
+        cold_lower_bail_if_active();
+        die("frozen symbols mutated outside a lowering worker");
+    }
+    symbols->mutation_epoch++;
+    cold_lower_effects++;
+}
+
+static uint64_t cold_hash_i32(uint64_t hash, int32_t value) {
+    return cold_fnv1a64_update_bytes(hash, (const uint8_t *)&value, sizeof(value));
+}
+
+/* Length-prefixed, so adjacent spans cannot run together. */
+static uint64_t cold_hash_span(uint64_t hash, Span span) {
+    return cold_fnv1a64_update(cold_hash_i32(hash, span.len), span);
+}
+
+static uint64_t cold_hash_spans(uint64_t hash, const Span *spans, int32_t count) {
+    for (int32_t i = 0; i < count; i++) hash = cold_hash_span(hash, spans[i]);
+    return hash;
+}
+
+/* Content hash of everything in Symbols that lowering a body can read.
+   is_external is left out: only codegen and linking look at it, and it is
+   set after lowering without going through symbols_guard_mutation.  The
+   result is kept until the next mutation; a flush computes it before the
+   table is frozen, so lowering workers only read the memo. */
+static uint64_t symbols_fingerprint(Symbols *symbols) {
+    if (symbols->fingerprint_ready && symbols->fingerprint_epoch == symbols->mutation_epoch &&
+        symbols->fingerprint_retypes == cold_object_field_retypes)
+        return symbols->fingerprint;
+    uint64_t h = 1469598103934665603ULL;
+    h = cold_hash_i32(h, symbols->function_count);
+    for (int32_t i = 0; i < symbols->function_count; i++) {
+        FnDef *fn = &symbols->functions[i];
+        h = cold_hash_span(h, fn->name);
+        h = cold_hash_span(h, fn->link_name);
+        h = cold_hash_i32(h, fn->arity);
+        for (int32_t p = 0; p < fn->arity && p < COLD_MAX_I32_PARAMS; p++) {
+            h = cold_hash_i32(h, fn->param_kind[p]);
+            h = cold_hash_i32(h, fn->param_size[p]);
+            h = cold_hash_span(h, fn->param_type[p]);
+            h = cold_hash_i32(h, fn->param_has_default[p] ? fn->param_default_value[p] : INT32_MIN);
+        }
+        h = cold_hash_span(h, fn->ret);
+        h = cold_hash_i32(h, fn->template_index);
+        h = cold_hash_i32(h, fn->generic_count);
+        h = cold_hash_spans(h, fn->generic_names, fn->generic_count);
+    }
+    h = cold_hash_i32(h, symbols->type_count);
+    for (int32_t i = 0; i < symbols->type_count; i++) {
+        TypeDef *type = &symbols->types[i];
+        h = cold_hash_span(h, type->name);
+        h = cold_hash_i32(h, type->variant_count);
+        for (int32_t v = 0; v < type->variant_count; v++) {
+            Variant *variant = &type->variants[v];
+            h = cold_hash_span(h, variant->name);
+            h = cold_hash_i32(h, variant->tag);
+            h = cold_hash_i32(h, variant->field_count);
+            for (int32_t f = 0; f < variant->field_count && f < COLD_MAX_VARIANT_FIELDS; f++) {
+                h = cold_hash_i32(h, variant->field_kind[f]);
+                h = cold_hash_i32(h, variant->field_size[f]);
+                h = cold_hash_i32(h, variant->field_offset[f]);
+                h = cold_hash_span(h, variant->field_type[f]);
+            }
+        }
+        h = cold_hash_i32(h, type->generic_count);
+        h = cold_hash_spans(h, type->generic_names, type->generic_count);
+        h = cold_hash_i32(h, type->max_field_count);
+        h = cold_hash_i32(h, type->max_slot_size);
+        h = cold_hash_i32(h, type->is_enum);
+        h = cold_hash_span(h, type->alias_type);
+    }
+    h = cold_hash_i32(h, symbols->object_count);
+    for (int32_t i = 0; i < symbols->object_count; i++) {
+        ObjectDef *object = &symbols->objects[i];
+        h = cold_hash_span(h, object->name);
+        h = cold_hash_i32(h, object->field_count);
+        for (int32_t f = 0; f < object->field_count; f++) {
+            ObjectField *field = &object->fields[f];
+            h = cold_hash_span(h, field->name);
+            h = cold_hash_i32(h, field->kind);
+            h = cold_hash_i32(h, field->offset);
+            h = cold_hash_i32(h, field->size);
+            h = cold_hash_i32(h, field->array_len);
+            h = cold_hash_span(h, field->type_name);
+        }
+        h = cold_hash_i32(h, object->slot_size);
+        h = cold_hash_i32(h, object->generic_count);
+        h = cold_hash_spans(h, object->generic_names, object->generic_count);
+        h = cold_hash_i32(h, object->is_ref);
+    }
+    h = cold_hash_i32(h, symbols->const_count);
+    for (int32_t i = 0; i < symbols->const_count; i++) {
+        ConstDef *constant = &symbols->consts[i];
+        h = cold_hash_span(h, constant->name);
+        h = cold_hash_i32(h, constant->value);
+        h = cold_hash_i32(h, constant->is_str);
+        h = cold_hash_span(h, constant->str_val);
+    }
+    h = cold_hash_i32(h, symbols->global_count);
+    for (int32_t i = 0; i < symbols->global_count; i++) {
+        GlobalDef *global = &symbols->globals[i];
+        h = cold_hash_span(h, global->name);
+        h = cold_hash_i32(h, global->kind);
+        h = cold_hash_i32(h, global->size);
+        h = cold_hash_span(h, global->type_name);
+        h = cold_hash_i32(h, global->init_value);
+    }
+    symbols->fingerprint = h;
+    symbols->fingerprint_epoch = symbols->mutation_epoch;
+    symbols->fingerprint_retypes = cold_object_field_retypes;
+    symbols->fingerprint_ready = true;
+    return h;
+}
+
 static ConstDef *symbols_find_const(Symbols *symbols, Span name) {
     for (int32_t i = 0; i < symbols->const_count; i++) {
         if (span_same(symbols->consts[i].name, name)) return &symbols->consts[i];
@@ -4200,6 +4916,7 @@ static ConstDef *symbols_find_const(Symbols *symbols, Span name) {
 
 static void symbols_add_const(Symbols *symbols, Span name, int32_t value) {
     if (symbols_find_const(symbols, name)) return; /* skip duplicate */
+    symbols_guard_mutation(symbols);
     if (symbols->const_count >= symbols->const_cap) {
         int32_t next = symbols->const_cap * 2;
         ConstDef *fresh = arena_alloc(symbols->arena, (size_t)next * sizeof(ConstDef));
@@ -4216,6 +4933,7 @@ static void symbols_add_const(Symbols *symbols, Span name, int32_t value) {
 
 void symbols_add_str_const(Symbols *symbols, Span name, Span str_val) {
     if (symbols_find_const(symbols, name)) return;
+    symbols_guard_mutation(symbols);
     if (symbols->const_count >= symbols->const_cap) {
         int32_t next = symbols->const_cap * 2;
         ConstDef *fresh = arena_alloc(symbols->arena, (size_t)next * sizeof(ConstDef));
@@ -4247,6 +4965,7 @@ void symbols_add_global(Symbols *symbols, Span name, int32_t kind,
         }
         return;
     }
+    symbols_guard_mutation(symbols);
     if (symbols->global_count >= symbols->global_cap) {
         int32_t next = symbols->global_cap * 2;
         GlobalDef *fresh = arena_alloc(symbols->arena, (size_t)next * sizeof(GlobalDef));
@@ -4324,6 +5043,10 @@ int32_t symbols_add_fn(Symbols *symbols, Span name, int32_t arity,
         for (int32_t i = 0; i < arity; i++) {
             int32_t new_kind = param_kinds ? param_kinds[i] : SLOT_I32;
             int32_t new_size = param_sizes ? param_sizes[i] : cold_slot_size_for_kind(new_kind);
+            if ((needs_refine && fn->param_kind[i] != new_kind) ||
+                (param_sizes && param_sizes[i] > 0 && fn->param_size[i] == 0)) {
+                symbols_guard_mutation(symbols);
+            }
             if (needs_refine && fn->param_kind[i] != new_kind) {
                 fn->param_kind[i] = new_kind;
                 fn->param_size[i] = new_size;
@@ -4333,6 +5056,7 @@ int32_t symbols_add_fn(Symbols *symbols, Span name, int32_t arity,
         }
         return existing;
     }
+    symbols_guard_mutation(symbols);
     if (symbols->function_count >= symbols->function_cap) {
         int32_t next = symbols->function_cap * 2;
         FnDef *fresh = arena_alloc(symbols->arena, (size_t)next * sizeof(FnDef));
@@ -4360,7 +5084,10 @@ static void symbols_set_fn_param_types(Symbols *symbols, int32_t fn_index,
     int32_t n = count < fn->arity ? count : fn->arity;
     for (int32_t i = 0; i < n; i++) {
         if (param_types && param_types[i].len > 0) {
-            fn->param_type[i] = cold_arena_span_copy(symbols->arena, span_trim(param_types[i]));
+            Span trimmed = span_trim(param_types[i]);
+            if (symbols->frozen && span_same(fn->param_type[i], trimmed)) continue;
+            symbols_guard_mutation(symbols);
+            fn->param_type[i] = cold_arena_span_copy(symbols->arena, trimmed);
         }
     }
 }
@@ -4368,6 +5095,8 @@ static void symbols_set_fn_param_types(Symbols *symbols, int32_t fn_index,
 static void symbols_set_fn_link_name(Symbols *symbols, int32_t fn_index, Span link_name) {
     if (!symbols || fn_index < 0 || fn_index >= symbols->function_count) return;
     if (link_name.len <= 0) return;
+    if (symbols->frozen && span_same(symbols->functions[fn_index].link_name, link_name)) return;
+    symbols_guard_mutation(symbols);
     symbols->functions[fn_index].link_name = cold_arena_span_copy(symbols->arena, link_name);
 }
 
@@ -4377,6 +5106,14 @@ static void symbols_set_fn_generics(Symbols *symbols, int32_t fn_index,
     if (!generic_names || generic_count <= 0) return;
     FnDef *fn = &symbols->functions[fn_index];
     int32_t n = generic_count < 4 ? generic_count : 4;
+    if (symbols->frozen) {
+        bool same = fn->generic_count == n;
+        for (int32_t i = 0; same && i < n; i++) {
+            if (!span_same(fn->generic_names[i], generic_names[i])) same = false;
+        }
+        if (same) return;
+        symbols_guard_mutation(symbols);
+    }
     for (int32_t i = 0; i < n; i++) {
         fn->generic_names[i] = generic_names[i];
     }
@@ -4413,7 +5150,7 @@ static Span cold_generic_join_type(Arena *arena, Span base, Span *args, int32_t
         len += args[i].len;
         if (i + 1 < arg_count) len++;
     }
-    uint8_t *ptr = arena_alloc(arena, (size_t)len + 1);
+    uint8_t *ptr = arena_alloc_uninit(arena, (size_t)len + 1);
     int32_t pos = 0;
     memcpy(ptr + pos, base.ptr, (size_t)base.len);
     pos += base.len;
@@ -4481,7 +5218,7 @@ static Span cold_specialize_fn_type(Symbols *symbols, FnDef *tmpl, Span type,
             Span inner = cold_specialize_fn_type(symbols, tmpl, stripped, body,
                                                   arg_start, arg_count);
             if (inner.len > 0 && !span_same(inner, stripped)) {
-                uint8_t *buf = arena_alloc(symbols->arena, (size_t)(4 + inner.len));
+                uint8_t *buf = arena_alloc_uninit(symbols->arena, (size_t)(4 + inner.len));
                 memcpy(buf, "var ", 4);
                 memcpy(buf + 4, inner.ptr, (size_t)inner.len);
                 return (Span){buf, 4 + inner.len};
@@ -4578,6 +5315,7 @@ static TypeDef *symbols_find_type(Symbols *symbols, Span name);
 static TypeDef *symbols_add_type(Symbols *symbols, Span name, int32_t variant_count) {
     TypeDef *existing = symbols_find_type(symbols, name);
     if (existing) return existing;
+    symbols_guard_mutation(symbols);
     if (symbols->type_count >= symbols->type_cap) {
         int32_t next = symbols->type_cap * 2;
         TypeDef *fresh = arena_alloc(symbols->arena, (size_t)next * sizeof(TypeDef));
@@ -4816,6 +5554,7 @@ static bool cold_unresolved_single_letter_generic_arg(Symbols *symbols, Span typ
 static ObjectDef *symbols_add_object(Symbols *symbols, Span name, int32_t field_count) {
     ObjectDef *existing = symbols_find_object(symbols, name);
     if (existing) return existing; /* skip duplicate (imported type already defined) */
+    symbols_guard_mutation(symbols);
     if (symbols->object_count >= symbols->object_cap) {
         int32_t next = symbols->object_cap * 2;
         ObjectDef *fresh = arena_alloc(symbols->arena, (size_t)next * sizeof(ObjectDef));
@@ -4952,6 +5691,7 @@ static void symbols_configure_std_result_object(Symbols *symbols,
                                                 ObjectDef *object,
                                                 Span value_type) {
     if (!object) die("Result object missing");
+    symbols_guard_mutation(symbols);
     if (!object->fields || object->field_count < 3) {
         object->fields = arena_alloc(symbols->arena, 3 * sizeof(ObjectField));
     }
@@ -6929,7 +7669,10 @@ typedef struct FunctionPatch {
 
 enum {
     FUNCTION_PATCH_CALL = 1,
-    FUNCTION_PATCH_ADDR = 2
+    FUNCTION_PATCH_ADDR = 2,
+    FUNCTION_PATCH_RODATA = 3, /* target_function is a cold_rodata literal id */
+    FUNCTION_PATCH_PROFILE = 4, /* target_function is a cold_profile data offset */
+    FUNCTION_PATCH_PROFILE_FLUSH = 5 /* call of the profile flush routine */
 };
 
 typedef struct FunctionPatchList {
@@ -6942,6 +7685,8 @@ typedef struct FunctionPatchList {
 static void code_emit(Code *code, uint32_t word);
 static void codegen_func(Code *code, BodyIR *body, Symbols *symbols,
                          FunctionPatchList *function_patches);
+static void rv64_codegen_func(Code *code, BodyIR *body, Symbols *symbols,
+                              FunctionPatchList *patches);
 
 #define COLD_WSDEQUE_CAP 256
 typedef struct ColdWSDeque {
@@ -7003,6 +7748,7 @@ typedef struct CodegenWorker {
     FunctionPatchList local_patches;
     int32_t *local_function_pos;
     int32_t *local_function_end;
+    bool use_rv64;
 } CodegenWorker;
 
 /* Lock-free Work-Stealing Deque (Chase-Lev style).
@@ -7035,9 +7781,13 @@ static void *codegen_worker_run(void *arg) {
             (body->block_count > 0 && body->block_term[0] < 0)) {
             die("cold worker function body is not codegen-ready");
         }
-        codegen_func(w->local_code, body, w->symbols, &w->local_patches);
+        if (w->use_rv64)
+            rv64_codegen_func(w->local_code, body, w->symbols, &w->local_patches);
+        else
+            codegen_func(w->local_code, body, w->symbols, &w->local_patches);
         w->local_function_end[i] = w->local_code->count;
     }
+    cold_arena_stats_fold();
     return NULL;
 }
 
@@ -7067,7 +7817,7 @@ static Code *code_new(Arena *arena, int32_t cap) {
 static void code_emit(Code *code, uint32_t word) {
     if (code->count >= code->cap) {
         int32_t next = code->cap * 2;
-        uint32_t *fresh = arena_alloc(code->arena, (size_t)next * sizeof(uint32_t));
+        uint32_t *fresh = arena_alloc_uninit(code->arena, (size_t)next * sizeof(uint32_t));
         memcpy(fresh, code->words, (size_t)code->count * sizeof(uint32_t));
         code->words = fresh;
         code->cap = next;
@@ -7129,6 +7879,436 @@ static void function_patches_add_addr(FunctionPatchList *patches, int32_t pos, i
     function_patches_add_kind(patches, pos, target_function, FUNCTION_PATCH_ADDR);
 }
 
+/* ---- ELF executable rodata pool ----
+   While enabled, string literals and codegen's own C-string constants
+   (codegen_cstring_literal) are not emitted inline behind a branch:
+   codegen registers the literal (cold_rodata_literal_id) and records a
+   FUNCTION_PATCH_RODATA patch on a PC-relative address placeholder.  The
+   program patch pass interns each literal into the pool in final patch
+   order (so layout is deterministic even with parallel codegen, and equal
+   literals share bytes), and the executable writer applies the fixups once
+   the text size, and with it the rodata address, is known. */
+typedef struct ColdRodataFixup {
+    int32_t pos;                 /* word index (a64/rv64) or byte offset (x64) */
+    int32_t off;                 /* pool offset in bytes */
+} ColdRodataFixup;
+
+typedef struct ColdRodata {
+    bool enabled;
+    pthread_mutex_t mutex;
+    Span *literals;
+    int32_t literal_count;
+    int32_t literal_cap;
+    uint8_t *bytes;
+    int32_t len;
+    int32_t cap;
+    ColdRodataFixup *fixups;
+    int32_t fixup_count;
+    int32_t fixup_cap;
+    int32_t *intern_off;         /* open-addressed: offset + 1, 0 = empty */
+    int32_t *intern_len;
+    int32_t intern_cap;
+    int32_t intern_count;
+} ColdRodata;
+
+static ColdRodata cold_rodata = {.mutex = PTHREAD_MUTEX_INITIALIZER};
+
+static void cold_rodata_end(void) {
+    free(cold_rodata.literals);
+    free(cold_rodata.bytes);
+    free(cold_rodata.fixups);
+    free(cold_rodata.intern_off);
+    free(cold_rodata.intern_len);
+    pthread_mutex_t mutex = cold_rodata.mutex;
+    memset(&cold_rodata, 0, sizeof(cold_rodata));
+    cold_rodata.mutex = mutex;
+}
+
+static void cold_rodata_begin(void) {
+    cold_rodata_end();
+    cold_rodata.enabled = true;
+}
+
+static void *cold_rodata_grow(void *items, int32_t *cap, int32_t need, size_t elem) {
+    if (need <= *cap) return items;
+    int32_t next = *cap ? *cap * 2 : 64;
+    while (next < need) next *= 2;
+    void *fresh = realloc(items, (size_t)next * elem);
+    if (!fresh) die("cold rodata allocation failed");
+    *cap = next;
+    return fresh;
+}
+
+static int32_t cold_rodata_literal_id(Span literal) {
+    pthread_mutex_lock(&cold_rodata.mutex);
+    cold_rodata.literals = cold_rodata_grow(cold_rodata.literals, &cold_rodata.literal_cap,
+                                            cold_rodata.literal_count + 1, sizeof(Span));
+    int32_t id = cold_rodata.literal_count++;
+    cold_rodata.literals[id] = literal;
+    pthread_mutex_unlock(&cold_rodata.mutex);
+    return id;
+}
+
+static uint32_t cold_rodata_hash(const uint8_t *p, int32_t len) {
+    uint32_t h = 2166136261u;
+    for (int32_t i = 0; i < len; i++) h = (h ^ p[i]) * 16777619u;
+    return h;
+}
+
+/* Pool offset of a NUL-terminated copy of literal, shared with any equal
+   literal already placed. */
+static int32_t cold_rodata_intern(Span literal) {
+    if (cold_rodata.intern_count * 2 >= cold_rodata.intern_cap) {
+        int32_t old_cap = cold_rodata.intern_cap;
+        int32_t *old_off = cold_rodata.intern_off;
+        int32_t *old_len = cold_rodata.intern_len;
+        int32_t cap = old_cap ? old_cap * 2 : 256;
+        cold_rodata.intern_off = calloc((size_t)cap, sizeof(int32_t));
+        cold_rodata.intern_len = calloc((size_t)cap, sizeof(int32_t));
+        if (!cold_rodata.intern_off || !cold_rodata.intern_len)
+            die("cold rodata allocation failed");
+        cold_rodata.intern_cap = cap;
+        for (int32_t i = 0; i < old_cap; i++) {
+            if (!old_off[i]) continue;
+            uint32_t h = cold_rodata_hash(cold_rodata.bytes + old_off[i] - 1, old_len[i]);
+            int32_t j = (int32_t)(h & (uint32_t)(cap - 1));
+            while (cold_rodata.intern_off[j]) j = (j + 1) & (cap - 1);
+            cold_rodata.intern_off[j] = old_off[i];
+            cold_rodata.intern_len[j] = old_len[i];
+        }
+        free(old_off);
+        free(old_len);
+    }
+    const uint8_t *ptr = (const uint8_t *)literal.ptr;
+    uint32_t h = cold_rodata_hash(ptr, literal.len);
+    int32_t mask = cold_rodata.intern_cap - 1;
+    int32_t j = (int32_t)(h & (uint32_t)mask);
+    while (cold_rodata.intern_off[j]) {
+        int32_t off = cold_rodata.intern_off[j] - 1;
+        if (cold_rodata.intern_len[j] == literal.len &&
+            (literal.len == 0 || memcmp(cold_rodata.bytes + off, ptr, (size_t)literal.len) == 0))
+            return off;
+        j = (j + 1) & mask;
+    }
+    int32_t off = cold_rodata.len;
+    cold_rodata.bytes = cold_rodata_grow(cold_rodata.bytes, &cold_rodata.cap,
+                                         off + literal.len + 1, 1);
+    if (literal.len > 0) memcpy(cold_rodata.bytes + off, ptr, (size_t)literal.len);
+    cold_rodata.bytes[off + literal.len] = 0;
+    cold_rodata.len = off + literal.len + 1;
+    cold_rodata.intern_off[j] = off + 1;
+    cold_rodata.intern_len[j] = literal.len;
+    cold_rodata.intern_count++;
+    return off;
+}
+
+/* Called from the program patch pass for a FUNCTION_PATCH_RODATA patch at
+   its final position. */
+static void cold_rodata_place(int32_t pos, int32_t literal_id) {
+    if (literal_id < 0 || literal_id >= cold_rodata.literal_count)
+        die("cold rodata literal id out of range");
+    int32_t off = cold_rodata_intern(cold_rodata.literals[literal_id]);
+    cold_rodata.fixups = cold_rodata_grow(cold_rodata.fixups, &cold_rodata.fixup_cap,
+                                          cold_rodata.fixup_count + 1, sizeof(ColdRodataFixup));
+    cold_rodata.fixups[cold_rodata.fixup_count++] = (ColdRodataFixup){pos, off};
+}
+
+/* adrp rd / add rd, rd, #lo12 pairs (word index of the adrp). */
+static void cold_rodata_apply_a64(uint32_t *words, uint64_t text_vaddr, uint64_t rodata_vaddr) {
+    for (int32_t i = 0; i < cold_rodata.fixup_count; i++) {
+        int32_t pos = cold_rodata.fixups[i].pos;
+        uint64_t target = rodata_vaddr + (uint64_t)cold_rodata.fixups[i].off;
+        uint64_t pc = text_vaddr + (uint64_t)pos * 4;
+        int64_t pages = (int64_t)(target >> 12) - (int64_t)(pc >> 12);
+        uint32_t rd = words[pos] & 0x1Fu;
+        uint32_t imm = (uint32_t)pages & 0x1FFFFFu;
+        words[pos] = 0x90000000u | ((imm & 0x3u) << 29) | (((imm >> 2) & 0x7FFFFu) << 5) | rd;
+        words[pos + 1] = a64_add_imm((int)rd, (int)rd, (uint16_t)(target & 0xFFFu), true);
+    }
+}
+
+/* auipc rd / addi rd, rd pairs (word index of the auipc). */
+static void cold_fixups_apply_rv64(const ColdRodataFixup *fixups, int32_t count, uint32_t *words,
+                                   uint64_t text_vaddr, uint64_t base_vaddr) {
+    for (int32_t i = 0; i < count; i++) {
+        int32_t pos = fixups[i].pos;
+        int32_t off = (int32_t)(base_vaddr + (uint64_t)fixups[i].off -
+                                (text_vaddr + (uint64_t)pos * 4));
+        int32_t upper = (off + 0x800) & (int32_t)0xFFFFF000;
+        int32_t lower = off - upper;
+        words[pos] = (words[pos] & 0xFFFu) | ((uint32_t)upper & 0xFFFFF000u);
+        words[pos + 1] = (words[pos + 1] & 0x000FFFFFu) | ((uint32_t)(lower & 0xFFF) << 20);
+    }
+}
+
+/* [rip + disp32] operands (byte offset of the disp32). */
+static void cold_fixups_apply_x64(const ColdRodataFixup *fixups, int32_t count, uint8_t *buf,
+                                  uint64_t text_vaddr, uint64_t base_vaddr) {
+    for (int32_t i = 0; i < count; i++) {
+        int32_t pos = fixups[i].pos;
+        int32_t disp = (int32_t)(base_vaddr + (uint64_t)fixups[i].off -
+                                 (text_vaddr + (uint64_t)pos + 4));
+        for (int32_t b = 0; b < 4; b++) buf[pos + b] = (uint8_t)((uint32_t)disp >> (b * 8));
+    }
+}
+
+static void cold_rodata_apply_rv64(uint32_t *words, uint64_t text_vaddr, uint64_t rodata_vaddr) {
+    cold_fixups_apply_rv64(cold_rodata.fixups, cold_rodata.fixup_count, words, text_vaddr, rodata_vaddr);
+}
+
+static void cold_rodata_apply_x64(uint8_t *buf, uint64_t text_vaddr, uint64_t rodata_vaddr) {
+    cold_fixups_apply_x64(cold_rodata.fixups, cold_rodata.fixup_count, buf, text_vaddr, rodata_vaddr);
+}
+
+/* ---- Block profiles (--instrument, --profile-use:) ----
+   An instrumented ELF executable counts block entries in its data segment
+   and writes the profile image to the profile path when main returns or
+   the program calls exit. The image describes itself: the magic, a u32
+   version and function count, then per function its
+   cold_body_ir_canonical_hash, u32 block count, u32 zero and one u64
+   counter per block. The profile path follows the image in the data
+   segment and is not written out.
+   --profile-use: reads an image back. A body takes the counts of the entry
+   with its hash and block count; equal hashes pair up in function order.
+   The counts drive block layout and register-allocation weights. */
+#define COLD_PROFILE_MAGIC "CHPROF01"
+#define COLD_PROFILE_VERSION 1
+
+typedef struct ColdProfileEntry {
+    uint64_t hash;
+    int32_t block_count;
+    bool taken;
+    const uint64_t *counts;
+} ColdProfileEntry;
+
+typedef struct ColdProfile {
+    bool instrument;
+    char path[PATH_MAX];          /* file the instrumented program writes */
+    uint8_t *data;                /* image, then the NUL-terminated path */
+    int32_t image_len;
+    int32_t data_len;
+    ColdRodataFixup *fixups;      /* PC-relative references into data */
+    int32_t fixup_count;
+    int32_t fixup_cap;
+    int32_t flush_pos;            /* flush routine in the entry stub, -1 if none */
+    uint8_t *use_bytes;           /* --profile-use: file contents */
+    ColdProfileEntry *entries;
+    int32_t entry_count;
+    int32_t instrumented_blocks;
+    int32_t matched_functions;
+    int32_t blocks_moved;
+} ColdProfile;
+
+static ColdProfile cold_profile = {.flush_pos = -1};
+
+/* Reads an image written by an instrumented program; false with a message
+   in err when the file is missing or malformed. */
+static bool cold_profile_load(const char *path, char *err, size_t err_cap) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        if (cold_serve_dep_fd >= 0) cold_serve_record_dep(path, (Span){0});
+        snprintf(err, err_cap, "cannot read profile %s", path);
+        return false;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *bytes = size > 0 ? malloc((size_t)size) : NULL;
+    bool ok = bytes && fread(bytes, 1, (size_t)size, f) == (size_t)size;
+    fclose(f);
+    if (cold_serve_dep_fd >= 0) {
+        if (ok && size <= (long)INT32_MAX) {
+            cold_serve_record_dep(path, (Span){bytes, (int32_t)size});
+        } else {
+            cold_serve_record_untracked(path);
+        }
+    }
+    uint32_t version = 0, count = 0;
+    if (ok) ok = size >= 16 && memcmp(bytes, COLD_PROFILE_MAGIC, 8) == 0;
+    if (ok) {
+        memcpy(&version, bytes + 8, 4);
+        memcpy(&count, bytes + 12, 4);
+        ok = version == COLD_PROFILE_VERSION && count <= (uint32_t)(size / 16);
+    }
+    ColdProfileEntry *entries = ok ? calloc(count > 0 ? count : 1, sizeof(ColdProfileEntry)) : NULL;
+    if (ok && !entries) die("out of memory");
+    long pos = 16;
+    for (uint32_t i = 0; ok && i < count; i++) {
+        uint32_t blocks = 0;
+        ok = pos + 16 <= size;
+        if (!ok) break;
+        memcpy(&entries[i].hash, bytes + pos, 8);
+        memcpy(&blocks, bytes + pos + 8, 4);
+        ok = blocks <= (uint32_t)((size - pos - 16) / 8);
+        if (!ok) break;
+        entries[i].block_count = (int32_t)blocks;
+        entries[i].counts = (const uint64_t *)(bytes + pos + 16);
+        pos += 16 + (long)blocks * 8;
+    }
+    if (!ok) {
+        free(bytes);
+        free(entries);
+        snprintf(err, err_cap, "malformed profile %s", path);
+        return false;
+    }
+    cold_profile.use_bytes = bytes;
+    cold_profile.entries = entries;
+    cold_profile.entry_count = (int32_t)count;
+    return true;
+}
+
+static void cold_profile_image_put(int32_t *len, int32_t *cap, const void *bytes, int32_t n) {
+    if (*len + n > *cap) {
+        while (*len + n > *cap) *cap = *cap ? *cap * 2 : 256;
+        cold_profile.data = realloc(cold_profile.data, (size_t)*cap);
+        if (!cold_profile.data) die("out of memory");
+    }
+    if (bytes) memcpy(cold_profile.data + *len, bytes, (size_t)n);
+    else memset(cold_profile.data + *len, 0, (size_t)n);
+    *len += n;
+}
+
+/* Lays out the counters of every body codegen will emit (entry first, then
+   function order) and hands --profile-use counts to the bodies they match.
+   Runs on the main thread before any body is emitted. */
+static void cold_profile_prepare(BodyIR **function_bodies, int32_t function_count,
+                                 int32_t entry_function, const bool *reachable) {
+    free(cold_profile.data);
+    free(cold_profile.fixups);
+    cold_profile.data = NULL;
+    cold_profile.image_len = cold_profile.data_len = 0;
+    cold_profile.fixups = NULL;
+    cold_profile.fixup_count = cold_profile.fixup_cap = 0;
+    cold_profile.flush_pos = -1;
+    cold_profile.instrumented_blocks = 0;
+    cold_profile.matched_functions = 0;
+    cold_profile.blocks_moved = 0;
+    for (int32_t i = 0; i < cold_profile.entry_count; i++) cold_profile.entries[i].taken = false;
+    if (!cold_profile.instrument && cold_profile.entry_count == 0) return;
+
+    int32_t len = 0, cap = 0;
+    uint32_t header[2] = {COLD_PROFILE_VERSION, 0};
+    if (cold_profile.instrument) {
+        cold_profile_image_put(&len, &cap, COLD_PROFILE_MAGIC, 8);
+        cold_profile_image_put(&len, &cap, header, 8);
+    }
+    for (int32_t k = -1; k < function_count; k++) {
+        int32_t i = k < 0 ? entry_function : k;
+        if (k >= 0 && i == entry_function) continue;
+        BodyIR *body = function_bodies[i];
+        if (!reachable[i] || !body || body->has_fallback || body->block_count <= 0) continue;
+        uint64_t hash = cold_body_ir_canonical_hash(body);
+        if (cold_profile.instrument) {
+            uint32_t blocks[2] = {(uint32_t)body->block_count, 0};
+            cold_profile_image_put(&len, &cap, &hash, 8);
+            cold_profile_image_put(&len, &cap, blocks, 8);
+            body->profile_counters = len;
+            cold_profile_image_put(&len, &cap, NULL, body->block_count * 8);
+            cold_profile.instrumented_blocks += body->block_count;
+            header[1]++;
+            continue;
+        }
+        for (int32_t e = 0; e < cold_profile.entry_count; e++) {
+            ColdProfileEntry *entry = &cold_profile.entries[e];
+            if (entry->taken || entry->hash != hash || entry->block_count != body->block_count) continue;
+            entry->taken = true;
+            body->block_profile = arena_alloc_uninit(body->arena, (size_t)body->block_count * sizeof(uint64_t));
+            memcpy(body->block_profile, entry->counts, (size_t)body->block_count * sizeof(uint64_t));
+            cold_profile.matched_functions++;
+            break;
+        }
+    }
+    if (!cold_profile.instrument) return;
+    memcpy(cold_profile.data + 12, &header[1], 4);
+    cold_profile.image_len = len;
+    cold_profile_image_put(&len, &cap, cold_profile.path, (int32_t)strlen(cold_profile.path) + 1);
+    cold_profile.data_len = len;
+}
+
+/* Called from the program patch pass for a FUNCTION_PATCH_PROFILE patch. */
+static void cold_profile_place(int32_t pos, int32_t off) {
+    cold_profile.fixups = cold_rodata_grow(cold_profile.fixups, &cold_profile.fixup_cap,
+                                           cold_profile.fixup_count + 1, sizeof(ColdRodataFixup));
+    cold_profile.fixups[cold_profile.fixup_count++] = (ColdRodataFixup){pos, off};
+}
+
+/* The flush routine the entry stub and BODY_OP_EXIT call before sys_exit:
+   openat(AT_FDCWD, path, O_WRONLY|O_CREAT|O_TRUNC, 0644), write the image,
+   close. The exit code in a0 survives the call. */
+static void cold_profile_emit_flush_rv64(Code *code) {
+    cold_profile.flush_pos = code->count;
+    code_emit(code, rv_addi(RV_T6, RV_A0, 0));
+    code_emit(code, rv_addi(RV_A0, RV_ZERO, -100));
+    cold_profile_place(code->count, cold_profile.image_len);
+    code_emit(code, rv_auipc(RV_A1, 0));
+    code_emit(code, rv_addi(RV_A1, RV_A1, 0));
+    rv_li(code->words, &code->count, RV_A2, 0x241);
+    rv_li(code->words, &code->count, RV_A3, 0644);
+    rv_li(code->words, &code->count, RV_A7, 56); /* sys_openat */
+    code_emit(code, rv_ecall());
+    int32_t skip = code->count;
+    code_emit(code, rv_blt(RV_A0, RV_ZERO, 0));
+    code_emit(code, rv_addi(RV_A5, RV_A0, 0));
+    cold_profile_place(code->count, 0);
+    code_emit(code, rv_auipc(RV_A1, 0));
+    code_emit(code, rv_addi(RV_A1, RV_A1, 0));
+    rv_li(code->words, &code->count, RV_A2, cold_profile.image_len);
+    rv_li(code->words, &code->count, RV_A7, 64); /* sys_write */
+    code_emit(code, rv_ecall());
+    code_emit(code, rv_addi(RV_A0, RV_A5, 0));
+    rv_li(code->words, &code->count, RV_A7, 57); /* sys_close */
+    code_emit(code, rv_ecall());
+    code->words[skip] = rv_blt(RV_A0, RV_ZERO, (int16_t)((code->count - skip) * 4));
+    code_emit(code, rv_addi(RV_A0, RV_T6, 0));
+    code_emit(code, rv_jalr(RV_ZERO, RV_RA, 0));
+}
+
+/* Same routine for x86_64 Linux; edi carries the exit code. */
+static void cold_profile_emit_flush_x64(X64Code *x) {
+    cold_profile.flush_pos = x->len;
+    x64_push_r64(x, 7);
+    x64_mov_r32_imm32(x, 0, 2);              /* sys_open */
+    x64_emit1(x, REX_W); x64_emit1(x, 0x8D); x64_emit1(x, MODRM(0, 7, 5));
+    cold_profile_place(x->len, cold_profile.image_len);
+    x64_emit4(x, 0);                         /* lea rdi, [rip + path] */
+    x64_mov_r32_imm32(x, 6, 0x241);
+    x64_mov_r32_imm32(x, 2, 0644);
+    x64_syscall(x);
+    x64_test_r32_r32(x, 0, 0);
+    x64_jcc_rel8(x, CC_S, 0);
+    int32_t skip = x->len;
+    x64_mov_r32_r32(x, 7, 0);
+    x64_mov_r32_imm32(x, 0, 1);              /* sys_write */
+    x64_emit1(x, REX_W); x64_emit1(x, 0x8D); x64_emit1(x, MODRM(0, 6, 5));
+    cold_profile_place(x->len, 0);
+    x64_emit4(x, 0);                         /* lea rsi, [rip + image] */
+    x64_mov_r32_imm32(x, 2, cold_profile.image_len);
+    x64_syscall(x);
+    x64_mov_r32_imm32(x, 0, 3);              /* sys_close */
+    x64_syscall(x);
+    x->buf[skip - 1] = (uint8_t)(x->len - skip);
+    x64_pop_r64(x, 7);
+    x64_ret(x);
+}
+
+/* Counter bump at the top of block bi of an instrumented body. */
+static void cold_profile_emit_count_rv64(Code *code, BodyIR *body, FunctionPatchList *patches, int32_t bi) {
+    function_patches_add_kind(patches, code->count, body->profile_counters + bi * 8,
+                              FUNCTION_PATCH_PROFILE);
+    code_emit(code, rv_auipc(RV_T0, 0));
+    code_emit(code, rv_addi(RV_T0, RV_T0, 0));
+    code_emit(code, rv_ld(RV_T1, RV_T0, 0));
+    code_emit(code, rv_addi(RV_T1, RV_T1, 1));
+    code_emit(code, rv_sd(RV_T1, RV_T0, 0));
+}
+
+static void cold_profile_emit_count_x64(X64Code *x, BodyIR *body, FunctionPatchList *patches, int32_t bi) {
+    x64_emit1(x, REX_W); x64_emit1(x, 0xFF); x64_emit1(x, MODRM(0, 0, 5));
+    function_patches_add_kind(patches, x->len, body->profile_counters + bi * 8,
+                              FUNCTION_PATCH_PROFILE);
+    x64_emit4(x, 0);                         /* inc qword [rip + counter] */
+}
+
 /* ---- large immediate / large offset helpers ---- */
 
 static uint32_t a64_add_imm_shifted(int rd, int rn, uint16_t imm12, bool x64) {
@@ -8104,7 +9284,19 @@ static void codegen_cstring_from_slot(Code *code, BodyIR *body, int32_t slot,
     code_emit(code, a64_strb_imm(5, 6, 0));
 }
 
-static void codegen_cstring_literal(Code *code, int dst_reg, const char *text) {
+/* Address of a NUL-terminated constant in dst_reg.  ELF executables keep it
+   in the read-only segment next to the string literals; elsewhere it is
+   inlined behind a branch. */
+static void codegen_cstring_literal(Code *code, FunctionPatchList *patches,
+                                    int dst_reg, const char *text) {
+    if (cold_rodata.enabled) {
+        Span literal = {(const uint8_t *)text, (int32_t)strlen(text)};
+        function_patches_add_kind(patches, code->count, cold_rodata_literal_id(literal),
+                                  FUNCTION_PATCH_RODATA);
+        code_emit(code, 0x90000000u | (uint32_t)dst_reg);  /* adrp dst, text */
+        code_emit(code, a64_add_imm(dst_reg, dst_reg, 0, true));
+        return;
+    }
     int32_t adr_pos = code->count;
     code_emit(code, a64_adr(dst_reg, 0));
     int32_t skip_pos = code->count;
@@ -8123,7 +9315,7 @@ static bool cold_fn_is_puts(FnDef *fn) {
     return false;
 }
 
-static void codegen_puts_cstring_intrinsic(Code *code, BodyIR *body,
+static void codegen_puts_cstring_intrinsic(Code *code, BodyIR *body, FunctionPatchList *patches,
                                            int32_t dst, int32_t arg_slot) {
     int32_t arg_kind = body->slot_kind[arg_slot];
     if (arg_kind == SLOT_STR || arg_kind == SLOT_STR_REF) {
@@ -8158,14 +9350,7 @@ static void codegen_puts_cstring_intrinsic(Code *code, BodyIR *body,
     code_emit(code, a64_svc(0x80));
     a64_patch_bcond(code, skip_text, code->count);
 
-    int32_t newline_adr = code->count;
-    code_emit(code, a64_adr(R1, 0));
-    int32_t newline_skip = code->count;
-    code_emit(code, a64_b(0));
-    int32_t newline_data = code_append_bytes(code, "\n", 1);
-    int32_t after_newline = code->count;
-    code->words[newline_adr] = a64_adr(R1, newline_data - newline_adr * 4);
-    a64_patch_b(code, newline_skip, after_newline);
+    codegen_cstring_literal(code, patches, R1, "\n");
     code_emit(code, a64_movz_x(R0, 1, 0));
     code_emit(code, a64_movz_x(R2, 1, 0));
     code_emit(code, a64_movz_x(16, 4, 0));
@@ -8211,8 +9396,8 @@ static void codegen_restore_exec_spills(Code *code, BodyIR *body, int32_t spill_
     }
 }
 
-static void codegen_exec_shell(Code *code, BodyIR *body, int32_t dst,
-                               int32_t arg_start, int32_t output_offset,
+static void codegen_exec_shell(Code *code, BodyIR *body, FunctionPatchList *patches,
+                               int32_t dst, int32_t arg_start, int32_t output_offset,
                                int32_t exit_offset) {
     if (arg_start < 0 || arg_start + 10 >= body->call_arg_count) {
         codegen_store_exec_failure(code, body, dst, output_offset, exit_offset);
@@ -8238,8 +9423,8 @@ static void codegen_exec_shell(Code *code, BodyIR *body, int32_t dst,
     }
     code_emit(code, a64_movz(5, 1, 0));
     code_emit(code, a64_and_reg(13, 4, 5));            /* merge stderr bit */
-    codegen_cstring_literal(code, 24, "/bin/sh");
-    codegen_cstring_literal(code, 25, "-c");
+    codegen_cstring_literal(code, patches, 24, "/bin/sh");
+    codegen_cstring_literal(code, patches, 25, "-c");
     codegen_mmap_const(code, 1024 * 1024 + 1, 26, 119); /* captured output */
     code_emit(code, a64_movz_x(27, 0, 0));             /* used */
     codegen_mov_i64_const(code, 28, 1024 * 1024);      /* cap */
@@ -9046,21 +10231,10 @@ static void codegen_text_set_insert(Code *code, BodyIR *body, Symbols *symbols,
     a64_patch_b(code, all_done_from_empty, code->count);
 }
 
-static void codegen_adr_cstr(Code *code, int reg, const char *text) {
-    int32_t len = (int32_t)strlen(text) + 1;
-    int32_t adr_pos = code->count;
-    code_emit(code, a64_adr(reg, 0));
-    int32_t skip_pos = code->count;
-    code_emit(code, a64_b(0));
-    int32_t data_offset = code_append_bytes(code, text, len);
-    int32_t after_data = code->count;
-    code->words[adr_pos] = a64_adr(reg, data_offset - adr_pos * 4);
-    code->words[skip_pos] = a64_b(after_data - skip_pos);
-}
-
-static void codegen_current_dir_to_regs(Code *code, int ptr_reg, int len_reg) {
+static void codegen_current_dir_to_regs(Code *code, FunctionPatchList *patches,
+                                        int ptr_reg, int len_reg) {
     codegen_mmap_const(code, 4096, ptr_reg, 41);
-    codegen_adr_cstr(code, R0, ".");
+    codegen_cstring_literal(code, patches, R0, ".");
     code_emit(code, a64_movz_x(R1, 0, 0));
     code_emit(code, a64_movz_x(R2, 0, 0));
     code_emit(code, a64_movz_x(16, 5, 0));
@@ -9357,7 +10531,7 @@ static void codegen_i64_to_str(Code *code, BodyIR *body, int32_t dst, int32_t sr
 }
 
 static void codegen_str_index(Code *code, BodyIR *body, int32_t dst,
-                              int32_t str_slot, int32_t index_slot) {
+                              int32_t str_slot, int32_t index_slot, bool checked) {
     int32_t str_kind = body->slot_kind[str_slot];
     if (str_kind != SLOT_STR && str_kind != SLOT_STR_REF) die("str index slot kind mismatch");
     if (body->slot_kind[index_slot] != SLOT_I32) die("str index requires int32 index");
@@ -9370,23 +10544,25 @@ static void codegen_str_index(Code *code, BodyIR *body, int32_t dst,
         a64_emit_ldr_sp_off(code, 4, body->slot_offset[str_slot] + 8, true);
     }
     a64_emit_ldr_sp_off(code, R1, body->slot_offset[index_slot], false);
-    code_emit(code, a64_cmp_imm(R1, 0));
-    int32_t non_negative = code->count;
-    code_emit(code, a64_bcond(0, COND_GE));
-    code_emit(code, a64_brk(7));
-    a64_patch_bcond(code, non_negative, code->count);
-    code_emit(code, a64_cmp_reg(R1, 4));
-    int32_t in_bounds = code->count;
-    code_emit(code, a64_bcond(0, COND_LT));
-    code_emit(code, a64_brk(8));
-    a64_patch_bcond(code, in_bounds, code->count);
+    if (checked) {
+        code_emit(code, a64_cmp_imm(R1, 0));
+        int32_t non_negative = code->count;
+        code_emit(code, a64_bcond(0, COND_GE));
+        code_emit(code, a64_brk(7));
+        a64_patch_bcond(code, non_negative, code->count);
+        code_emit(code, a64_cmp_reg(R1, 4));
+        int32_t in_bounds = code->count;
+        code_emit(code, a64_bcond(0, COND_LT));
+        code_emit(code, a64_brk(8));
+        a64_patch_bcond(code, in_bounds, code->count);
+    }
     code_emit(code, a64_add_reg_x(R3, R3, R1));
     code_emit(code, a64_ldrb_imm(R0, R3, 0));
     a64_emit_str_sp_off(code, R0, body->slot_offset[dst], false);
 }
 
 static void codegen_seq_str_index(Code *code, BodyIR *body, int32_t dst,
-                                  int32_t seq_slot, int32_t index_slot) {
+                                  int32_t seq_slot, int32_t index_slot, bool checked) {
     int32_t seq_kind = body->slot_kind[seq_slot];
     if (seq_kind != SLOT_SEQ_STR && seq_kind != SLOT_SEQ_STR_REF) die("str sequence index slot kind mismatch");
     if (body->slot_kind[index_slot] != SLOT_I32) die("str sequence index requires int32 index");
@@ -9397,17 +10573,19 @@ static void codegen_seq_str_index(Code *code, BodyIR *body, int32_t dst,
         a64_emit_add_large(code, header_reg, SP, body->slot_offset[seq_slot], true);
     }
     a64_emit_ldr_sp_off(code, R1, body->slot_offset[index_slot], false);
-    code_emit(code, a64_cmp_imm(R1, 0));
-    int32_t non_negative = code->count;
-    code_emit(code, a64_bcond(0, COND_GE));
-    code_emit(code, a64_brk(9));
-    a64_patch_bcond(code, non_negative, code->count);
-    code_emit(code, a64_ldr_imm(R3, header_reg, 0, false));
-    code_emit(code, a64_cmp_reg(R1, R3));
-    int32_t in_bounds = code->count;
-    code_emit(code, a64_bcond(0, COND_LT));
-    code_emit(code, a64_brk(10));
-    a64_patch_bcond(code, in_bounds, code->count);
+    if (checked) {
+        code_emit(code, a64_cmp_imm(R1, 0));
+        int32_t non_negative = code->count;
+        code_emit(code, a64_bcond(0, COND_GE));
+        code_emit(code, a64_brk(9));
+        a64_patch_bcond(code, non_negative, code->count);
+        code_emit(code, a64_ldr_imm(R3, header_reg, 0, false));
+        code_emit(code, a64_cmp_reg(R1, R3));
+        int32_t in_bounds = code->count;
+        code_emit(code, a64_bcond(0, COND_LT));
+        code_emit(code, a64_brk(10));
+        a64_patch_bcond(code, in_bounds, code->count);
+    }
     code_emit(code, a64_ldr_imm(4, header_reg, 8, true));
     codegen_mul_u64_by_24(code, 5, R1);
     code_emit(code, a64_add_reg_x(4, 4, 5));
@@ -9632,18 +10810,20 @@ static void codegen_slot_data_addr(Code *code, BodyIR *body, int32_t slot, int r
 
 static void codegen_seq_opaque_index(Code *code, BodyIR *body, int32_t dst,
                                      int32_t seq_slot, int32_t index_slot,
-                                     int32_t element_size) {
+                                     int32_t element_size, bool checked) {
     element_size = codegen_seq_opaque_element_size(body, seq_slot, element_size);
     if (body->slot_size[dst] > element_size) die("opaque sequence index destination too large");
     codegen_seq_opaque_header_addr(code, body, seq_slot, R2);
     a64_emit_ldr_sp_off(code, R1, body->slot_offset[index_slot], false);
-    code_emit(code, a64_cmp_imm(R1, 0));
-    code_emit(code, a64_bcond(2, COND_GE));
-    code_emit(code, a64_brk(120));
-    code_emit(code, a64_ldr_imm(R0, R2, 0, false));
-    code_emit(code, a64_cmp_reg(R1, R0));
-    code_emit(code, a64_bcond(2, COND_LT));
-    code_emit(code, a64_brk(120));
+    if (checked) {
+        code_emit(code, a64_cmp_imm(R1, 0));
+        code_emit(code, a64_bcond(2, COND_GE));
+        code_emit(code, a64_brk(120));
+        code_emit(code, a64_ldr_imm(R0, R2, 0, false));
+        code_emit(code, a64_cmp_reg(R1, R0));
+        code_emit(code, a64_bcond(2, COND_LT));
+        code_emit(code, a64_brk(120));
+    }
     code_emit(code, a64_ldr_imm(R3, R2, 8, true));
     codegen_mov_i32_const(code, 6, element_size);
     code_emit(code, a64_mul_reg_x(6, R1, 6));
@@ -9655,18 +10835,20 @@ static void codegen_seq_opaque_index(Code *code, BodyIR *body, int32_t dst,
 
 static void codegen_seq_opaque_index_store(Code *code, BodyIR *body, int32_t value_slot,
                                            int32_t seq_slot, int32_t index_slot,
-                                           int32_t element_size) {
+                                           int32_t element_size, bool checked) {
     element_size = codegen_seq_opaque_element_size(body, seq_slot, element_size);
     if (body->slot_size[value_slot] > element_size) die("opaque sequence store value too large");
     codegen_seq_opaque_header_addr(code, body, seq_slot, R2);
     a64_emit_ldr_sp_off(code, R1, body->slot_offset[index_slot], false);
-    code_emit(code, a64_cmp_imm(R1, 0));
-    code_emit(code, a64_bcond(2, COND_GE));
-    code_emit(code, a64_brk(122));
-    code_emit(code, a64_ldr_imm(R0, R2, 0, false));
-    code_emit(code, a64_cmp_reg(R1, R0));
-    code_emit(code, a64_bcond(2, COND_LT));
-    code_emit(code, a64_brk(122));
+    if (checked) {
+        code_emit(code, a64_cmp_imm(R1, 0));
+        code_emit(code, a64_bcond(2, COND_GE));
+        code_emit(code, a64_brk(122));
+        code_emit(code, a64_ldr_imm(R0, R2, 0, false));
+        code_emit(code, a64_cmp_reg(R1, R0));
+        code_emit(code, a64_bcond(2, COND_LT));
+        code_emit(code, a64_brk(122));
+    }
     code_emit(code, a64_ldr_imm(R3, R2, 8, true));
     codegen_mov_i32_const(code, 6, element_size);
     code_emit(code, a64_mul_reg_x(6, R1, 6));
@@ -10203,7 +11385,7 @@ static void codegen_op(Code *code, BodyIR *body, Symbols *symbols,
     } else if (kind == BODY_OP_SHELL_QUOTE) {
         codegen_shell_quote(code, body, dst, a);
     } else if (kind == BODY_OP_EXEC_SHELL) {
-        codegen_exec_shell(code, body, dst, a, b, c);
+        codegen_exec_shell(code, body, function_patches, dst, a, b, c);
     } else if (kind == BODY_OP_STR_SLICE) {
         codegen_str_slice(code, body, dst, a, b, c);
     } else if (kind == BODY_OP_TEXT_SET_INIT) {
@@ -10211,7 +11393,7 @@ static void codegen_op(Code *code, BodyIR *body, Symbols *symbols,
     } else if (kind == BODY_OP_TEXT_SET_INSERT) {
         codegen_text_set_insert(code, body, symbols, dst, a, b);
     } else if (kind == BODY_OP_CWD_STR) {
-        codegen_current_dir_to_regs(code, R2, R3);
+        codegen_current_dir_to_regs(code, function_patches, R2, R3);
         codegen_store_str_pair(code, body, dst, R2, R3);
     } else if (kind == BODY_OP_PATH_JOIN) {
         codegen_path_join_slots(code, body, dst, a, b);
@@ -10780,7 +11962,8 @@ static void codegen_op(Code *code, BodyIR *body, Symbols *symbols,
         } else {
             FnDef *fn = &symbols->functions[a];
             if (cold_fn_is_puts(fn) && fn->arity == 1) {
-                codegen_puts_cstring_intrinsic(code, body, dst, body->call_arg_slot[b]);
+                codegen_puts_cstring_intrinsic(code, body, function_patches, dst,
+                                               body->call_arg_slot[b]);
                 return;
             }
             int32_t stack_bytes = codegen_load_call_args(code, body, fn, b);
@@ -10809,14 +11992,21 @@ static void codegen_op(Code *code, BodyIR *body, Symbols *symbols,
     } else if (kind == BODY_OP_STR_LITERAL) {
         if (a < 0 || a >= body->string_literal_count) die("invalid string literal index");
         Span literal = body->string_literal[a];
-        int32_t adr_pos = code->count;
-        code_emit(code, a64_adr(R0, 0));
-        int32_t skip_pos = code->count;
-        code_emit(code, a64_b(0));
-        int32_t data_offset = code_append_bytes(code, (const char *)literal.ptr, literal.len + 1);
-        int32_t after_data = code->count;
-        code->words[adr_pos] = a64_adr(R0, data_offset - adr_pos * 4);
-        code->words[skip_pos] = a64_b(after_data - skip_pos);
+        if (cold_rodata.enabled) {
+            function_patches_add_kind(function_patches, code->count,
+                                      cold_rodata_literal_id(literal), FUNCTION_PATCH_RODATA);
+            code_emit(code, 0x90000000u | R0);          /* adrp x0, literal */
+            code_emit(code, a64_add_imm(R0, R0, 0, true));
+        } else {
+            int32_t adr_pos = code->count;
+            code_emit(code, a64_adr(R0, 0));
+            int32_t skip_pos = code->count;
+            code_emit(code, a64_b(0));
+            int32_t data_offset = code_append_bytes(code, (const char *)literal.ptr, literal.len + 1);
+            int32_t after_data = code->count;
+            code->words[adr_pos] = a64_adr(R0, data_offset - adr_pos * 4);
+            code->words[skip_pos] = a64_b(after_data - skip_pos);
+        }
         if (literal.len <= 0xFFFF) {
             code_emit(code, a64_movz_x(R1, (uint16_t)literal.len, 0));
         } else {
@@ -10841,9 +12031,9 @@ static void codegen_op(Code *code, BodyIR *body, Symbols *symbols,
     } else if (kind == BODY_OP_I64_TO_STR) {
         codegen_i64_to_str(code, body, dst, a);
     } else if (kind == BODY_OP_STR_INDEX) {
-        codegen_str_index(code, body, dst, a, b);
+        codegen_str_index(code, body, dst, a, b, !cold_op_bounds_proven(body, op));
     } else if (kind == BODY_OP_SEQ_STR_INDEX_DYNAMIC) {
-        codegen_seq_str_index(code, body, dst, a, b);
+        codegen_seq_str_index(code, body, dst, a, b, !cold_op_bounds_proven(body, op));
     } else if (kind == BODY_OP_FIELD_REF) {
         int32_t base_kind = body->slot_kind[a];
         if (base_kind == SLOT_OBJECT) {
@@ -10917,10 +12107,13 @@ static void codegen_op(Code *code, BodyIR *body, Symbols *symbols,
         a64_emit_str_sp_off(code, R0, body->slot_offset[dst], false);
     } else if (kind == BODY_OP_SEQ_I32_INDEX_DYNAMIC) {
         int32_t arr_kind = body->slot_kind[a];
+        bool checked = !cold_op_bounds_proven(body, op);
         a64_emit_ldr_sp_off(code, R1, body->slot_offset[b], false);
-        code_emit(code, a64_cmp_imm(R1, 0));
-        code_emit(code, a64_bcond(2, COND_GE));
-        code_emit(code, a64_brk(2));
+        if (checked) {
+            code_emit(code, a64_cmp_imm(R1, 0));
+            code_emit(code, a64_bcond(2, COND_GE));
+            code_emit(code, a64_brk(2));
+        }
         if (arr_kind == SLOT_ARRAY_I32) {
             /* Inline array: data at SP + slot_offset, length from slot_size */
             int32_t arr_len = body->slot_size[a] / 4;
@@ -10933,10 +12126,12 @@ static void codegen_op(Code *code, BodyIR *body, Symbols *symbols,
             code_emit(code, a64_ldr_w_reg_uxtw2(R0, R2, R1));
         } else {
             codegen_seq_header_addr(code, body, a, R2);
-            code_emit(code, a64_ldr_imm(R3, R2, 0, false));
-            code_emit(code, a64_cmp_reg(R1, R3));
-            code_emit(code, a64_bcond(2, COND_LT));
-            code_emit(code, a64_brk(2));
+            if (checked) {
+                code_emit(code, a64_ldr_imm(R3, R2, 0, false));
+                code_emit(code, a64_cmp_reg(R1, R3));
+                code_emit(code, a64_bcond(2, COND_LT));
+                code_emit(code, a64_brk(2));
+            }
             code_emit(code, a64_ldr_imm(R0, R2, 8, true));
             code_emit(code, a64_ldr_w_reg_uxtw2(R0, R0, R1));
         }
@@ -10991,13 +12186,15 @@ static void codegen_op(Code *code, BodyIR *body, Symbols *symbols,
         } else if (base_kind == SLOT_SEQ_I32 || base_kind == SLOT_SEQ_I32_REF) {
             codegen_seq_header_addr(code, body, a, R2);
             a64_emit_ldr_sp_off(code, R1, body->slot_offset[b], false);
-            code_emit(code, a64_cmp_imm(R1, 0));
-            code_emit(code, a64_bcond(2, COND_GE));
-            code_emit(code, a64_brk(2));
-            code_emit(code, a64_ldr_imm(R3, R2, 0, false));
-            code_emit(code, a64_cmp_reg(R1, R3));
-            code_emit(code, a64_bcond(2, COND_LT));
-            code_emit(code, a64_brk(2));
+            if (!cold_op_bounds_proven(body, op)) {
+                code_emit(code, a64_cmp_imm(R1, 0));
+                code_emit(code, a64_bcond(2, COND_GE));
+                code_emit(code, a64_brk(2));
+                code_emit(code, a64_ldr_imm(R3, R2, 0, false));
+                code_emit(code, a64_cmp_reg(R1, R3));
+                code_emit(code, a64_bcond(2, COND_LT));
+                code_emit(code, a64_brk(2));
+            }
             code_emit(code, a64_ldr_imm(R0, R2, 8, true));
             a64_emit_ldr_sp_off(code, R2, body->slot_offset[dst], false);
             code_emit(code, a64_str_w_reg_uxtw2(R2, R0, R1));
@@ -11007,9 +12204,9 @@ static void codegen_op(Code *code, BodyIR *body, Symbols *symbols,
     } else if (kind == BODY_OP_SEQ_STR_ADD) {
         codegen_seq_str_add(code, body, dst, a);
     } else if (kind == BODY_OP_SEQ_OPAQUE_INDEX_DYNAMIC) {
-        codegen_seq_opaque_index(code, body, dst, a, b, c);
+        codegen_seq_opaque_index(code, body, dst, a, b, c, !cold_op_bounds_proven(body, op));
     } else if (kind == BODY_OP_SEQ_OPAQUE_INDEX_STORE) {
-        codegen_seq_opaque_index_store(code, body, dst, a, b, c);
+        codegen_seq_opaque_index_store(code, body, dst, a, b, c, !cold_op_bounds_proven(body, op));
     } else if (kind == BODY_OP_SEQ_OPAQUE_ADD) {
         codegen_seq_opaque_add(code, body, dst, a, b);
     } else if (kind == BODY_OP_SEQ_OPAQUE_REMOVE) {
@@ -11589,13 +12786,15 @@ static void codegen_op(Code *code, BodyIR *body, Symbols *symbols,
         int32_t es = codegen_seq_opaque_element_size(body, a, c);
         codegen_seq_opaque_header_addr(code, body, a, R2);
         a64_emit_ldr_sp_off(code, R1, body->slot_offset[b], false);
-        code_emit(code, a64_cmp_imm(R1, 0));
-        code_emit(code, a64_bcond(2, COND_GE));
-        code_emit(code, a64_brk(145));
-        code_emit(code, a64_ldr_imm(R0, R2, 0, false));
-        code_emit(code, a64_cmp_reg(R1, R0));
-        code_emit(code, a64_bcond(2, COND_LT));
-        code_emit(code, a64_brk(145));
+        if (!cold_op_bounds_proven(body, op)) {
+            code_emit(code, a64_cmp_imm(R1, 0));
+            code_emit(code, a64_bcond(2, COND_GE));
+            code_emit(code, a64_brk(145));
+            code_emit(code, a64_ldr_imm(R0, R2, 0, false));
+            code_emit(code, a64_cmp_reg(R1, R0));
+            code_emit(code, a64_bcond(2, COND_LT));
+            code_emit(code, a64_brk(145));
+        }
         code_emit(code, a64_ldr_imm(R3, R2, 8, true));
         codegen_mov_i32_const(code, 6, es);
         code_emit(code, a64_mul_reg_x(6, R1, 6));
@@ -11631,203 +12830,1271 @@ static void codegen_op(Code *code, BodyIR *body, Symbols *symbols,
 
 /* ---- x86_64 codegen (byte-level, packs into uint32_t words) ---- */
 
-static void x64_codegen_op(X64Code *x, BodyIR *body, Symbols *symbols,
-                           FunctionPatchList *patches, int32_t op) {
+/* ---- register allocation (x86_64, riscv64) ----
+   Scalar slots (I32/I64/PTR) that are only touched by ops a backend's
+   lower_op handles get one live interval over the linear block order; an
+   interval that overlaps a loop (a back edge in that order) is widened to
+   the whole loop, so no value needs to be live across an edge the scan
+   cannot see. Linear scan then hands out the target's pool: intervals that
+   span no call and no complex op (those clobber scratch registers freely)
+   may take any register, the others only the callee-saved tail of the
+   pool, which the prologue saves once. When the pool is exhausted the
+   interval with the lowest loop-weighted use count stays on the stack.
+   Single-def constants never get storage: every read becomes an immediate.
+   Everything else keeps its frame slot. */
+
+/* Register file a backend hands to cold_regalloc. pool[first_safe..] survive
+   calls and complex ops; callee_saved lists the ones the prologue saves. */
+typedef struct ColdRaTarget {
+    const int32_t *pool;
+    int32_t pool_count;
+    int32_t first_safe;
+    const int32_t *callee_saved;
+    int32_t callee_saved_count;
+    int32_t arg_regs;     /* integer argument registers of the call ABI */
+    bool aggregates;      /* composite parameters are passed in argument words */
+} ColdRaTarget;
+
+typedef struct ColdRegAlloc {
+    int8_t *reg;          /* slot -> GPR, -1 = frame slot */
+    bool *is_const;       /* single-def constant, read as an immediate */
+    bool *dead;           /* written but never read */
+    int64_t *imm;
+    int32_t *uses;        /* reads per slot, for compare/branch fusion */
+    int32_t *param_place; /* cold_place_params of the body's own signature */
+    bool params_in_regs;  /* params arrive per the call ABI, not through the frame */
+    int32_t sp_bias;      /* bytes pushed below the frame while a call is set up */
+    int32_t sret_off;     /* frame offset of the hidden return pointer, -1 if none */
+    int32_t saved[12];    /* callee-saved registers saved by the prologue */
+    int32_t saved_count;
+    int32_t frame;        /* end of the slots and the sret spill; backends pad it */
+    int32_t acc_slot;     /* frame slot the accumulator (rax, t0) mirrors */
+    int32_t acc_bytes;
+} ColdRegAlloc;
+
+typedef struct ColdInterval {
+    int32_t slot;
+    int32_t start;
+    int32_t end;
+    int64_t weight;
+    bool crosses_clobber;
+} ColdInterval;
+
+/* Register width of a scalar slot kind, 0 if it is not passed in a GPR. */
+static int32_t cold_scalar_bytes(int32_t kind) {
+    if (kind == SLOT_I32) return 4;
+    if (kind == SLOT_I64 || kind == SLOT_PTR || kind == SLOT_OPAQUE) return 8;
+    return 0;
+}
+
+static bool cold_kind_is_ref(int32_t kind) {
+    return kind == SLOT_I32_REF || kind == SLOT_I64_REF || kind == SLOT_STR_REF ||
+           kind == SLOT_OBJECT_REF || kind == SLOT_OPAQUE_REF || kind == SLOT_SEQ_I32_REF ||
+           kind == SLOT_SEQ_STR_REF || kind == SLOT_SEQ_OPAQUE_REF;
+}
+
+/* Argument registers a parameter occupies: one for scalars and refs, two
+   for a str (data, len); 0 for kinds that are not passed this way. With
+   aggregates, other composites follow the aarch64 rule: two words up to 16
+   bytes, else one word holding the caller's address. */
+static int32_t cold_param_words(int32_t kind, int32_t size, bool aggregates) {
+    if (cold_scalar_bytes(kind) > 0 || cold_kind_is_ref(kind)) return 1;
+    if (kind == SLOT_STR) return 2;
+    if (aggregates && cold_kind_is_composite(kind)) return cold_arg_reg_count(kind, size);
+    return 0;
+}
+
+enum { X64_ARG_STACK = 6, RV64_ARG_STACK = 8 };
+
+/* Integer-register placement (SysV INTEGER class, RISC-V LP64). place[i] is
+   the first argument register of parameter i, or regs + its first stack
+   word once the registers run out (a str is never split); a composite
+   result takes the first register as the hidden return pointer. Returns the
+   stack words, -1 when some parameter kind cannot be placed. sizes and
+   place may be NULL. */
+static int32_t cold_place_params(const int32_t *kinds, const int32_t *sizes, int32_t count,
+                                 bool sret, int32_t regs, bool aggregates, int32_t *place) {
+    int32_t next = sret ? 1 : 0;
+    int32_t stack = 0;
+    for (int32_t i = 0; i < count; i++) {
+        int32_t words = cold_param_words(kinds[i], sizes ? sizes[i] : 0, aggregates);
+        if (words == 0) return -1;
+        if (next + words <= regs) {
+            if (place) place[i] = next;
+            next += words;
+        } else {
+            if (place) place[i] = regs + stack;
+            stack += words;
+        }
+    }
+    return stack;
+}
+
+/* Width an argument slot is loaded at, 0 when it cannot go in a GPR. As on
+   aarch64 the slot's own width wins: an int32 passed to an int64 parameter
+   arrives zero-extended. */
+static int32_t cold_arg_bytes(int32_t param_kind, int32_t arg_kind) {
+    int32_t bytes = cold_scalar_bytes(arg_kind);
+    if (cold_scalar_bytes(param_kind) == 0 || bytes == 0) return 0;
+    if (param_kind == SLOT_PTR && bytes != 8) return 0;
+    return bytes;
+}
+
+/* Byte size of each parameter as the caller sees it: the signature's, else
+   the argument slot's (as codegen_load_call_args does). */
+static void cold_call_param_sizes(BodyIR *body, FnDef *fn, int32_t arg_start, int32_t *sizes) {
+    for (int32_t i = 0; i < fn->arity; i++) {
+        int32_t arg = body->call_arg_slot[arg_start + i];
+        sizes[i] = fn->param_size[i] > 0 ? fn->param_size[i]
+                 : arg >= 0 && arg < body->slot_count ? body->slot_size[arg] : 0;
+    }
+}
+
+/* CALL_I32 / CALL_COMPOSITE lowered with register arguments, or -1 when
+   the callee signature needs the generic path. Returns 1 when the first
+   argument register carries the hidden return pointer, else 0. */
+static int32_t cold_call_arg_base(BodyIR *body, Symbols *symbols, int32_t regs, bool aggregates,
+                                  int32_t op) {
     int32_t kind = body->op_kind[op];
-    if (kind == BODY_OP_NOP) return;
+    int32_t fn_index = body->op_a[op];
+    if (kind != BODY_OP_CALL_I32 && kind != BODY_OP_CALL_COMPOSITE) return -1;
+    if (fn_index < 0 || fn_index >= symbols->function_count) return -1;
     int32_t dst = body->op_dst[op];
-    int32_t a = body->op_a[op];
-    int32_t b = body->op_b[op];
-    int32_t c = body->op_c[op];
-    int32_t off_dst = body->slot_offset[dst];
-    /* I32 arithmetic */
-    if (kind == BODY_OP_I32_CONST) {
-        x64_mov_r32_imm32(x, 0, (int32_t)a);
-        x64_mov_mr32_r32(x, 4, off_dst, 0);
-    } else if (kind == BODY_OP_COPY_I32) {
-        x64_mov_r32_mr32(x, 0, 4, body->slot_offset[a]);
-        x64_mov_mr32_r32(x, 4, off_dst, 0);
-    } else if (kind == BODY_OP_I32_ADD || kind == BODY_OP_I32_SUB) {
-        int32_t oa = body->slot_offset[a], ob = body->slot_offset[b];
-        x64_mov_r32_mr32(x, 0, 4, oa);
-        x64_mov_r32_mr32(x, 1, 4, ob);
-        if (kind == BODY_OP_I32_ADD) x64_add_r32_r32(x, 0, 1);
-        else x64_sub_r32_r32(x, 0, 1);
-        x64_mov_mr32_r32(x, 4, off_dst, 0);
-    } else if (kind == BODY_OP_I32_MUL) {
-        x64_mov_r32_mr32(x, 0, 4, body->slot_offset[a]);
-        x64_mov_r32_mr32(x, 1, 4, body->slot_offset[b]);
-        x64_imul_r32_r32(x, 0, 1);
-        x64_mov_mr32_r32(x, 4, off_dst, 0);
-    } else if (kind == BODY_OP_I32_DIV) {
-        x64_mov_r32_mr32(x, 0, 4, body->slot_offset[a]);
-        x64_mov_r32_mr32(x, 1, 4, body->slot_offset[b]);
-        x64_cdq(x); x64_idiv_r32(x, 1);
-        x64_mov_mr32_r32(x, 4, off_dst, 0);
-    } else if (kind == BODY_OP_I32_MOD) {
-        x64_mov_r32_mr32(x, 0, 4, body->slot_offset[a]);
-        x64_mov_r32_mr32(x, 1, 4, body->slot_offset[b]);
-        x64_cdq(x); x64_idiv_r32(x, 1);
-        x64_mov_r32_r32(x, 0, 2); /* remainder in EDX */
-        x64_mov_mr32_r32(x, 4, off_dst, 0);
-    } else if (kind == BODY_OP_I32_AND) {
-        x64_mov_r32_mr32(x, 0, 4, body->slot_offset[a]);
-        x64_mov_r32_mr32(x, 1, 4, body->slot_offset[b]);
-        x64_emit1(x, 0x21); x64_emit1(x, MODRM(3, 1, 0)); /* AND %ecx,%eax */
-        x64_mov_mr32_r32(x, 4, off_dst, 0);
-    } else if (kind == BODY_OP_I32_OR) {
-        x64_mov_r32_mr32(x, 0, 4, body->slot_offset[a]);
-        x64_mov_r32_mr32(x, 1, 4, body->slot_offset[b]);
-        x64_emit1(x, 0x09); x64_emit1(x, MODRM(3, 1, 0)); /* OR %ecx,%eax */
-        x64_mov_mr32_r32(x, 4, off_dst, 0);
-    } else if (kind == BODY_OP_I32_XOR) {
-        x64_mov_r32_mr32(x, 0, 4, body->slot_offset[a]);
-        x64_mov_r32_mr32(x, 1, 4, body->slot_offset[b]);
-        x64_xor_r32_r32(x, 0, 1);
-        x64_mov_mr32_r32(x, 4, off_dst, 0);
-    } else if (kind == BODY_OP_I32_SHL) {
-        x64_mov_r32_mr32(x, 1, 4, body->slot_offset[b]);
-        x64_mov_r32_r32(x, 1, 1); /* shift count to ECX */
-        x64_mov_r32_mr32(x, 0, 4, body->slot_offset[a]);
-        x64_shl_r32_cl(x, 0);
-        x64_mov_mr32_r32(x, 4, off_dst, 0);
-    } else if (kind == BODY_OP_I32_ASR) {
-        x64_mov_r32_mr32(x, 1, 4, body->slot_offset[b]);
-        x64_mov_r32_r32(x, 1, 1);
-        x64_mov_r32_mr32(x, 0, 4, body->slot_offset[a]);
-        x64_sar_r32_cl(x, 0);
-        x64_mov_mr32_r32(x, 4, off_dst, 0);
-    } else if (kind == BODY_OP_I32_CMP) {
-        x64_mov_r32_mr32(x, 0, 4, body->slot_offset[a]);
-        x64_mov_r32_mr32(x, 1, 4, body->slot_offset[b]);
-        x64_cmp_r32_r32(x, 0, 1);
-        x64_setcc_r8(x, c, 0);
-        x64_movzb_r8_r32(x, 0, 0);
-        x64_mov_mr32_r32(x, 4, off_dst, 0);
-    /* I64 arithmetic */
-    } else if (kind == BODY_OP_I64_CONST) {
-        uint64_t bits = (uint32_t)a | ((uint64_t)(uint32_t)b << 32);
-        x64_mov_r64_imm64(x, 0, bits);
-        x64_mov_mr64_r64(x, 4, off_dst, 0);
-    } else if (kind == BODY_OP_COPY_I64) {
-        x64_mov_r64_mr64(x, 0, 4, body->slot_offset[a]);
-        x64_mov_mr64_r64(x, 4, off_dst, 0);
-    } else if (kind == BODY_OP_I64_FROM_I32) {
-        x64_movsxd_r64_r32(x, 0, 0);
-        x64_mov_mr64_r64(x, 4, off_dst, 0);
-    } else if (kind == BODY_OP_I32_FROM_I64) {
-        x64_mov_r32_mr32(x, 0, 4, body->slot_offset[a]);
-        x64_mov_mr32_r32(x, 4, off_dst, 0);
-    } else if (kind == BODY_OP_I64_ADD || kind == BODY_OP_I64_SUB ||
-               kind == BODY_OP_I64_MUL) {
-        x64_mov_r64_mr64(x, 0, 4, body->slot_offset[a]);
-        x64_mov_r64_mr64(x, 1, 4, body->slot_offset[b]);
-        if (kind == BODY_OP_I64_ADD) x64_add_r64_r64(x, 0, 1);
-        else if (kind == BODY_OP_I64_SUB) x64_sub_r64_r64(x, 0, 1);
-        else x64_imul_r64_r64(x, 0, 1);
-        x64_mov_mr64_r64(x, 4, off_dst, 0);
-    } else if (kind == BODY_OP_I64_DIV) {
-        x64_mov_r64_mr64(x, 0, 4, body->slot_offset[a]);
-        x64_mov_r64_mr64(x, 1, 4, body->slot_offset[b]);
-        x64_cqo(x); x64_idiv_r64(x, 1);
-        x64_mov_mr64_r64(x, 4, off_dst, 0);
-    } else if (kind == BODY_OP_I64_AND || kind == BODY_OP_I64_OR ||
-               kind == BODY_OP_I64_XOR) {
-        x64_mov_r64_mr64(x, 0, 4, body->slot_offset[a]);
-        x64_mov_r64_mr64(x, 1, 4, body->slot_offset[b]);
-        if (kind == BODY_OP_I64_AND) x64_and_r64_r64(x, 0, 1);
-        else if (kind == BODY_OP_I64_OR) x64_or_r64_r64(x, 0, 1);
-        else x64_xor_r64_r64(x, 0, 1);
-        x64_mov_mr64_r64(x, 4, off_dst, 0);
-    } else if (kind == BODY_OP_I64_SHL || kind == BODY_OP_I64_ASR) {
-        x64_mov_r32_mr32(x, 1, 4, body->slot_offset[b]);
-        x64_mov_r32_r32(x, 1, 1);
-        x64_mov_r64_mr64(x, 0, 4, body->slot_offset[a]);
-        if (kind == BODY_OP_I64_SHL) x64_shl_r64_cl(x, 0);
-        else x64_sar_r64_cl(x, 0);
-        x64_mov_mr64_r64(x, 4, off_dst, 0);
-    } else if (kind == BODY_OP_I64_CMP) {
-        x64_mov_r64_mr64(x, 0, 4, body->slot_offset[a]);
-        x64_mov_r64_mr64(x, 1, 4, body->slot_offset[b]);
-        x64_cmp_r64_r64(x, 0, 1);
-        x64_setcc_r8(x, c, 0);
-        x64_movzb_r8_r32(x, 0, 0);
-        x64_mov_mr32_r32(x, 4, off_dst, 0);
-    /* Float: F32 */
-    } else if (kind == BODY_OP_F32_CONST) {
-        float val; memcpy(&val, &a, 4);
-        int32_t bits; memcpy(&bits, &val, 4);
-        x64_mov_r32_imm32(x, 0, bits);
-        x64_movd_xmm_r32(x, 0, 0);
-        x64_movss_mr_xmm(x, 4, off_dst, 0);
-    } else if (kind == BODY_OP_F32_ADD || kind == BODY_OP_F32_SUB ||
-               kind == BODY_OP_F32_MUL || kind == BODY_OP_F32_DIV) {
-        x64_movss_xmm_mr(x, 0, 4, body->slot_offset[a]);
-        x64_movss_xmm_mr(x, 1, 4, body->slot_offset[b]);
-        if (kind == BODY_OP_F32_ADD) x64_addss(x, 0, 1);
-        else if (kind == BODY_OP_F32_SUB) x64_subss(x, 0, 1);
-        else if (kind == BODY_OP_F32_MUL) x64_mulss(x, 0, 1);
-        else x64_divss(x, 0, 1);
-        x64_movss_mr_xmm(x, 4, off_dst, 0);
-    } else if (kind == BODY_OP_F32_NEG) {
-        x64_movss_xmm_mr(x, 0, 4, body->slot_offset[a]);
-        /* XOR sign bit: xmm1 = -0.0f, xorpd xmm0, xmm1 */
-        x64_mov_r32_imm32(x, 0, 0x80000000);
-        x64_movd_xmm_r32(x, 1, 0);
-        x64_xorps(x, 0, 1);
-        x64_movss_mr_xmm(x, 4, off_dst, 0);
-    } else if (kind == BODY_OP_F32_CMP) {
-        x64_movss_xmm_mr(x, 0, 4, body->slot_offset[a]);
-        x64_movss_xmm_mr(x, 1, 4, body->slot_offset[b]);
-        x64_ucomiss(x, 0, 1);
-        x64_setcc_r8(x, c, 0);
-        x64_movzb_r8_r32(x, 0, 0);
-        x64_mov_mr32_r32(x, 4, off_dst, 0);
-    } else if (kind == BODY_OP_F32_FROM_I32) {
-        x64_mov_r32_mr32(x, 0, 4, body->slot_offset[a]);
-        x64_cvtsi2ss(x, 0, 0);
-        x64_movss_mr_xmm(x, 4, off_dst, 0);
-    } else if (kind == BODY_OP_I32_FROM_F32) {
-        x64_movss_xmm_mr(x, 0, 4, body->slot_offset[a]);
-        x64_cvttss2si(x, 0, 0);
-        x64_mov_mr32_r32(x, 4, off_dst, 0);
-    /* Float: F64 */
-    } else if (kind == BODY_OP_F64_CONST) {
-        uint64_t bits = (uint32_t)a | ((uint64_t)(uint32_t)b << 32);
-        x64_mov_r64_imm64(x, 0, bits);
-        x64_movd_xmm_r32(x, 0, 0);
-        x64_movsd_mr_xmm(x, 4, off_dst, 0);
-    } else if (kind == BODY_OP_F64_ADD || kind == BODY_OP_F64_SUB ||
-               kind == BODY_OP_F64_MUL || kind == BODY_OP_F64_DIV) {
-        x64_movsd_xmm_mr(x, 0, 4, body->slot_offset[a]);
-        x64_movsd_xmm_mr(x, 1, 4, body->slot_offset[b]);
-        if (kind == BODY_OP_F64_ADD) x64_addsd(x, 0, 1);
-        else if (kind == BODY_OP_F64_SUB) x64_subsd(x, 0, 1);
-        else if (kind == BODY_OP_F64_MUL) x64_mulsd(x, 0, 1);
-        else x64_divsd(x, 0, 1);
-        x64_movsd_mr_xmm(x, 4, off_dst, 0);
-    } else if (kind == BODY_OP_F64_NEG) {
-        x64_movsd_xmm_mr(x, 0, 4, body->slot_offset[a]);
-        x64_mov_r64_imm64(x, 0, 0x8000000000000000ULL);
-        x64_movd_xmm_r32(x, 1, 0);
-        x64_xorps(x, 0, 1);
-        x64_movsd_mr_xmm(x, 4, off_dst, 0);
-    } else if (kind == BODY_OP_F64_CMP) {
-        x64_movsd_xmm_mr(x, 0, 4, body->slot_offset[a]);
-        x64_movsd_xmm_mr(x, 1, 4, body->slot_offset[b]);
-        x64_ucomisd(x, 0, 1);
-        x64_setcc_r8(x, c, 0);
-        x64_movzb_r8_r32(x, 0, 0);
-        x64_mov_mr32_r32(x, 4, off_dst, 0);
-    } else if (kind == BODY_OP_F64_FROM_I32) {
-        x64_mov_r32_mr32(x, 0, 4, body->slot_offset[a]);
-        x64_cvtsi2sd(x, 0, 0);
-        x64_movsd_mr_xmm(x, 4, off_dst, 0);
-    } else if (kind == BODY_OP_I32_FROM_F64) {
-        x64_movsd_xmm_mr(x, 0, 4, body->slot_offset[a]);
-        x64_cvttsd2si(x, 0, 0);
-        x64_mov_mr32_r32(x, 4, off_dst, 0);
-    /* String ops */
+    bool sret = kind == BODY_OP_CALL_COMPOSITE && dst >= 0 && dst < body->slot_count &&
+                cold_kind_is_composite(body->slot_kind[dst]);
+    FnDef *fn = &symbols->functions[fn_index];
+    if (body->op_b[op] < 0 || body->op_b[op] + fn->arity > body->call_arg_count) return -1;
+    int32_t sizes[COLD_MAX_I32_PARAMS];
+    cold_call_param_sizes(body, fn, body->op_b[op], sizes);
+    if (cold_place_params(fn->param_kind, sizes, fn->arity, sret, regs, aggregates, NULL) < 0)
+        return -1;
+    return sret ? 1 : 0;
+}
+
+/* Slot operands of the scalar ops the lower_op passes handle, with access
+   widths. Returns false for every op left to the backend's codegen_op. */
+typedef struct ColdOpShape {
+    int32_t def;
+    int32_t def_bytes;
+    int32_t use[2];
+    int32_t use_bytes[2];
+    int32_t use_count;
+    bool pure;
+} ColdOpShape;
+
+static bool cold_op_shape(BodyIR *body, int32_t op, ColdOpShape *s) {
+    int32_t kind = body->op_kind[op];
+    int32_t dst = body->op_dst[op], a = body->op_a[op], b = body->op_b[op];
+    s->def = -1; s->def_bytes = 0; s->use_count = 0; s->pure = true;
+#define COLD_USE(slot, bytes) do { s->use[s->use_count] = (slot); \
+        s->use_bytes[s->use_count++] = (bytes); } while (0)
+    switch (kind) {
+    case BODY_OP_I32_CONST:
+        s->def = dst; s->def_bytes = 4; break;
+    case BODY_OP_I64_CONST: case BODY_OP_PTR_CONST:
+        s->def = dst; s->def_bytes = 8; break;
+    case BODY_OP_COPY_I32:
+        s->def = dst; s->def_bytes = 4; COLD_USE(a, 4); break;
+    case BODY_OP_COPY_I64:
+        s->def = dst; s->def_bytes = 8; COLD_USE(a, 8); break;
+    case BODY_OP_I32_ADD: case BODY_OP_I32_SUB: case BODY_OP_I32_MUL:
+    case BODY_OP_I32_AND: case BODY_OP_I32_OR: case BODY_OP_I32_XOR:
+    case BODY_OP_I32_SHL: case BODY_OP_I32_ASR: case BODY_OP_I32_CMP:
+        s->def = dst; s->def_bytes = 4; COLD_USE(a, 4); COLD_USE(b, 4); break;
+    case BODY_OP_I32_DIV: case BODY_OP_I32_MOD:
+        s->def = dst; s->def_bytes = 4; COLD_USE(a, 4); COLD_USE(b, 4); s->pure = false; break;
+    case BODY_OP_I64_ADD: case BODY_OP_I64_SUB: case BODY_OP_I64_MUL:
+    case BODY_OP_I64_AND: case BODY_OP_I64_OR: case BODY_OP_I64_XOR:
+        s->def = dst; s->def_bytes = 8; COLD_USE(a, 8); COLD_USE(b, 8); break;
+    case BODY_OP_I64_SHL: case BODY_OP_I64_ASR:
+        s->def = dst; s->def_bytes = 8; COLD_USE(a, 8); COLD_USE(b, 4); break;
+    case BODY_OP_I64_DIV:
+        s->def = dst; s->def_bytes = 8; COLD_USE(a, 8); COLD_USE(b, 8); s->pure = false; break;
+    case BODY_OP_I64_CMP:
+        s->def = dst; s->def_bytes = 4; COLD_USE(a, 8); COLD_USE(b, 8); break;
+    case BODY_OP_I64_FROM_I32:
+        s->def = dst; s->def_bytes = 8; COLD_USE(a, 4); break;
+    case BODY_OP_I32_FROM_I64:
+        s->def = dst; s->def_bytes = 4; COLD_USE(a, 4); break;
+    case BODY_OP_PTR_ADD:
+        s->def = dst; s->def_bytes = 8; COLD_USE(a, 8);
+        COLD_USE(b, b >= 0 && b < body->slot_count && body->slot_kind[b] == SLOT_I32 ? 4 : 8);
+        break;
+    case BODY_OP_PTR_LOAD_I32: case BODY_OP_PTR_LOAD_U8: case BODY_OP_PTR_LOAD_U16:
+        s->def = dst; s->def_bytes = 4; COLD_USE(a, 8); s->pure = false; break;
+    case BODY_OP_PTR_LOAD_I64:
+        s->def = dst; s->def_bytes = 8; COLD_USE(a, 8); s->pure = false; break;
+    case BODY_OP_PTR_STORE_I32: case BODY_OP_PTR_STORE_U8: case BODY_OP_PTR_STORE_U16:
+        COLD_USE(dst, 8); COLD_USE(a, 4); s->pure = false; break;
+    case BODY_OP_PTR_STORE_I64:
+        COLD_USE(dst, 8); COLD_USE(a, 8); s->pure = false; break;
+    default:
+        return false;
+    }
+#undef COLD_USE
+    for (int32_t i = 0; i < s->use_count; i++)
+        if (s->use[i] < 0 || s->use[i] >= body->slot_count) die("BodyIR op operand slot out of range");
+    if (s->def >= body->slot_count || (s->def < 0 && kind != BODY_OP_PTR_STORE_I32 &&
+        kind != BODY_OP_PTR_STORE_U8 && kind != BODY_OP_PTR_STORE_U16 &&
+        kind != BODY_OP_PTR_STORE_I64)) die("BodyIR op destination slot out of range");
+    return true;
+}
+
+typedef struct ColdRaScan {
+    int32_t *width;        /* register width of an eligible slot, 0 = frame only */
+    int32_t *first;
+    int32_t *last;
+    int32_t *defs;
+    int32_t *uses;
+    int32_t *const_op;
+    int64_t *weight;
+    int32_t *depth;
+    int64_t *freq;         /* profiled entries + 1 per position, or NULL */
+} ColdRaScan;
+
+static void cold_ra_note(ColdRaScan *scan, int32_t slot, int32_t pos, int32_t bytes, bool is_def) {
+    if (scan->width[slot] == 0) return;
+    if (is_def ? bytes != scan->width[slot] : bytes > scan->width[slot]) {
+        scan->width[slot] = 0;
+        return;
+    }
+    if (scan->first[slot] < 0 || pos < scan->first[slot]) scan->first[slot] = pos;
+    if (pos > scan->last[slot]) scan->last[slot] = pos;
+    if (is_def) scan->defs[slot]++;
+    else scan->uses[slot]++;
+    if (scan->freq) {
+        scan->weight[slot] += scan->freq[pos];
+        return;
+    }
+    int32_t shift = scan->depth[pos] * 3;
+    scan->weight[slot] += (int64_t)1 << (shift > 30 ? 30 : shift);
+}
+
+static void cold_ra_exclude(ColdRaScan *scan, BodyIR *body, int32_t slot) {
+    if (slot >= 0 && slot < body->slot_count) scan->width[slot] = 0;
+}
+
+static int cold_interval_cmp(const void *pa, const void *pb) {
+    const ColdInterval *a = pa, *b = pb;
+    if (a->start != b->start) return a->start < b->start ? -1 : 1;
+    return a->slot < b->slot ? -1 : (a->slot > b->slot);
+}
+
+/* Linear position of every op and terminator: params first, then blocks in
+   emission order. */
+static int32_t cold_ra_positions(BodyIR *body, int32_t *block_start) {
+    int32_t pos = body->param_count;
+    for (int32_t bi = 0; bi < body->block_count; bi++) {
+        block_start[bi] = pos;
+        pos += body->block_op_count[bi] + 1;
+    }
+    return pos;
+}
+
+static void cold_regalloc(BodyIR *body, Symbols *symbols, const ColdRaTarget *target,
+                          ColdRegAlloc *ra) {
+    int32_t n = body->slot_count;
+    size_t ns = (size_t)(n > 0 ? n : 1);
+    ra->reg = malloc(ns);
+    ra->is_const = calloc(ns, sizeof(bool));
+    ra->dead = calloc(ns, sizeof(bool));
+    ra->imm = calloc(ns, sizeof(int64_t));
+    ra->param_place = malloc((size_t)(body->param_count > 0 ? body->param_count : 1) * sizeof(int32_t));
+    int32_t *param_kinds = malloc((size_t)(body->param_count > 0 ? body->param_count : 1) * sizeof(int32_t));
+    int32_t *param_sizes = malloc((size_t)(body->param_count > 0 ? body->param_count : 1) * sizeof(int32_t));
+    ra->saved_count = 0;
+    ra->acc_slot = -1;
+    ra->sp_bias = 0;
+    if (!ra->reg || !ra->is_const || !ra->dead || !ra->imm || !ra->param_place || !param_kinds ||
+        !param_sizes) die("out of memory");
+    ra->params_in_regs = true;
+    for (int32_t i = 0; i < body->param_count; i++) {
+        int32_t slot = body->param_slot[i];
+        if (slot < 0 || slot >= n) ra->params_in_regs = false;
+        else {
+            param_kinds[i] = body->slot_kind[slot];
+            param_sizes[i] = body->slot_size[slot];
+        }
+    }
+    if (ra->params_in_regs)
+        ra->params_in_regs = cold_place_params(param_kinds, param_sizes, body->param_count,
+                                               cold_kind_is_composite(body->return_kind),
+                                               target->arg_regs, target->aggregates,
+                                               ra->param_place) >= 0;
+    free(param_kinds);
+    free(param_sizes);
+    memset(ra->reg, -1, ns);
+
+    int32_t *block_start = calloc((size_t)(body->block_count > 0 ? body->block_count : 1), sizeof(int32_t));
+    if (!block_start) die("out of memory");
+    int32_t pos_count = cold_ra_positions(body, block_start);
+    size_t np = (size_t)pos_count + 2;
+    ColdRaScan scan;
+    scan.width = calloc(ns, sizeof(int32_t));
+    scan.first = malloc(ns * sizeof(int32_t));
+    scan.last = calloc(ns, sizeof(int32_t));
+    scan.defs = calloc(ns, sizeof(int32_t));
+    scan.uses = calloc(ns, sizeof(int32_t));
+    scan.const_op = malloc(ns * sizeof(int32_t));
+    scan.weight = calloc(ns, sizeof(int64_t));
+    scan.depth = calloc(np, sizeof(int32_t));
+    int32_t *loop_head = malloc((size_t)(body->term_count + body->switch_count + 1) * sizeof(int32_t));
+    int32_t *loop_tail = malloc((size_t)(body->term_count + body->switch_count + 1) * sizeof(int32_t));
+    int32_t *calls_before = calloc(np, sizeof(int32_t));
+    bool *arg_covered = calloc((size_t)(body->call_arg_count > 0 ? body->call_arg_count : 1), sizeof(bool));
+    if (!scan.width || !scan.first || !scan.last || !scan.defs || !scan.uses ||
+        !scan.const_op || !scan.weight || !scan.depth || !loop_head || !loop_tail ||
+        !calls_before || !arg_covered) die("out of memory");
+    for (int32_t s = 0; s < n; s++) {
+        int32_t kind = body->slot_kind[s];
+        scan.width[s] = kind == SLOT_I32 ? 4 : (kind == SLOT_I64 || kind == SLOT_PTR) ? 8 : 0;
+        scan.first[s] = -1;
+        scan.const_op[s] = -1;
+    }
+
+    /* Back edges in linear order and the loop depth of every position. */
+    int32_t loop_count = 0;
+    for (int32_t bi = 0; bi < body->block_count; bi++) {
+        int32_t term = body->block_term[bi];
+        if (term < 0 || term >= body->term_count) continue;
+        int32_t tkind = body->term_kind[term];
+        int32_t tail = block_start[bi] + body->block_op_count[bi];
+        int32_t head = -1;
+        if (tkind == BODY_TERM_BR || tkind == BODY_TERM_CBR) {
+            int32_t targets[2] = {body->term_true_block[term],
+                                  tkind == BODY_TERM_CBR ? body->term_false_block[term] : -1};
+            for (int32_t ti = 0; ti < 2; ti++) {
+                int32_t t = targets[ti];
+                if (t >= 0 && t <= bi && (head < 0 || block_start[t] < head)) head = block_start[t];
+            }
+        } else if (tkind == BODY_TERM_SWITCH) {
+            for (int32_t si = 0; si < body->switch_count; si++) {
+                if (body->switch_term[si] != term) continue;
+                int32_t t = body->switch_block[si];
+                if (t >= 0 && t <= bi && (head < 0 || block_start[t] < head)) head = block_start[t];
+            }
+        }
+        if (head < 0) continue;
+        loop_head[loop_count] = head;
+        loop_tail[loop_count++] = tail;
+        scan.depth[head]++;
+        scan.depth[tail + 1]--;
+    }
+    for (int32_t p = 1; p < pos_count; p++) scan.depth[p] += scan.depth[p - 1];
+
+    /* A profile replaces the loop-depth guess: a reference weighs as often
+       as its block ran, so hot loops keep their registers. */
+    scan.freq = NULL;
+    if (body->block_profile) {
+        scan.freq = malloc(np * sizeof(int64_t));
+        if (!scan.freq) die("out of memory");
+        for (int32_t p = 0; p < (int32_t)np; p++) scan.freq[p] = 1;
+        for (int32_t bi = 0; bi < body->block_count; bi++) {
+            uint64_t hits = body->block_profile[bi];
+            if (hits > ((uint64_t)1 << 40)) hits = (uint64_t)1 << 40;
+            for (int32_t p = block_start[bi]; p <= block_start[bi] + body->block_op_count[bi]; p++)
+                scan.freq[p] = (int64_t)hits + 1;
+        }
+    }
+
+    /* References. Complex ops pin every slot they name to the frame and act
+       as clobber points, like calls. */
+    if (ra->params_in_regs) {
+        for (int32_t i = 0; i < body->param_count; i++) {
+            int32_t slot = body->param_slot[i];
+            int32_t bytes = cold_scalar_bytes(body->slot_kind[slot]);
+            if (bytes > 0) cold_ra_note(&scan, slot, i, bytes, true);
+        }
+    } else {
+        for (int32_t i = 0; i < body->param_count; i++) cold_ra_exclude(&scan, body, body->param_slot[i]);
+    }
+    cold_ra_exclude(&scan, body, body->sret_slot);
+    for (int32_t bi = 0; bi < body->block_count; bi++) {
+        int32_t bs = body->block_op_start[bi];
+        for (int32_t i = 0; i < body->block_op_count[bi]; i++) {
+            int32_t op = bs + i;
+            int32_t pos = block_start[bi] + i;
+            int32_t kind = body->op_kind[op];
+            ColdOpShape shape;
+            if (kind == BODY_OP_NOP || kind == BODY_OP_LOAD_I32) continue;
+            int32_t arg_base = cold_call_arg_base(body, symbols, target->arg_regs, target->aggregates, op);
+            if (arg_base >= 0) {
+                FnDef *fn = &symbols->functions[body->op_a[op]];
+                int32_t dst = body->op_dst[op];
+                for (int32_t ai = 0; ai < fn->arity; ai++) {
+                    int32_t ci = body->op_b[op] + ai;
+                    int32_t arg = body->call_arg_slot[ci];
+                    int32_t bytes = arg >= 0 && arg < body->slot_count &&
+                                    !cold_kind_is_ref(fn->param_kind[ai])
+                        ? cold_arg_bytes(fn->param_kind[ai], body->slot_kind[arg]) : 0;
+                    if (bytes == 0) continue;
+                    arg_covered[ci] = true;
+                    cold_ra_note(&scan, arg, pos, bytes, false);
+                }
+                if (kind == BODY_OP_CALL_I32 && dst >= 0 && dst < body->slot_count)
+                    cold_ra_note(&scan, dst, pos, cold_scalar_bytes(body->slot_kind[dst]), true);
+                else
+                    cold_ra_exclude(&scan, body, dst);
+                calls_before[pos + 1]++;
+            } else if (cold_op_shape(body, op, &shape)) {
+                for (int32_t u = 0; u < shape.use_count; u++)
+                    cold_ra_note(&scan, shape.use[u], pos, shape.use_bytes[u], false);
+                if (shape.def >= 0) {
+                    cold_ra_note(&scan, shape.def, pos, shape.def_bytes, true);
+                    if (kind == BODY_OP_I32_CONST || kind == BODY_OP_I64_CONST ||
+                        kind == BODY_OP_PTR_CONST) scan.const_op[shape.def] = op;
+                }
+            } else {
+                cold_ra_exclude(&scan, body, body->op_dst[op]);
+                cold_ra_exclude(&scan, body, body->op_a[op]);
+                cold_ra_exclude(&scan, body, body->op_b[op]);
+                cold_ra_exclude(&scan, body, body->op_c[op]);
+                calls_before[pos + 1]++;
+            }
+        }
+        int32_t term = body->block_term[bi];
+        if (term < 0 || term >= body->term_count) continue;
+        int32_t tpos = block_start[bi] + body->block_op_count[bi];
+        int32_t tkind = body->term_kind[term];
+        int32_t value = body->term_value[term];
+        if (tkind == BODY_TERM_RET && value >= 0 && value < n) {
+            int32_t bytes = cold_scalar_bytes(body->slot_kind[value]);
+            if (bytes > 0) cold_ra_note(&scan, value, tpos, bytes, false);
+        } else if (tkind == BODY_TERM_CBR) {
+            int32_t right = body->term_case_count[term];
+            if (value >= 0 && value < n) cold_ra_note(&scan, value, tpos, 4, false);
+            if (right >= 0 && right < n) cold_ra_note(&scan, right, tpos, 4, false);
+        } else if (tkind == BODY_TERM_SWITCH && value >= 0 && value < n) {
+            cold_ra_note(&scan, value, tpos, 4, false);
+        }
+    }
+    for (int32_t ci = 0; ci < body->call_arg_count; ci++)
+        if (!arg_covered[ci]) cold_ra_exclude(&scan, body, body->call_arg_slot[ci]);
+    for (int32_t p = 1; p < pos_count + 1; p++) calls_before[p] += calls_before[p - 1];
+
+    /* Constants and dead values need no storage at all. Copies and
+       widenings of a constant are constants too. */
+    for (int32_t s = 0; s < n; s++) {
+        int32_t cop = scan.const_op[s];
+        if (scan.width[s] == 0 || cop < 0 || scan.defs[s] != 1) continue;
+        int64_t value = body->op_kind[cop] == BODY_OP_I64_CONST
+            ? (int64_t)((uint32_t)body->op_a[cop] | ((uint64_t)(uint32_t)body->op_b[cop] << 32))
+            : (int64_t)body->op_a[cop];
+        if (value < INT32_MIN || value > INT32_MAX) continue;
+        ra->is_const[s] = true;
+        ra->imm[s] = value;
+    }
+    bool folded = true;
+    while (folded) {
+        folded = false;
+        for (int32_t op = 0; op < body->op_count; op++) {
+            int32_t kind = body->op_kind[op];
+            int32_t dst = body->op_dst[op], src = body->op_a[op];
+            if (kind != BODY_OP_COPY_I32 && kind != BODY_OP_COPY_I64 &&
+                kind != BODY_OP_I64_FROM_I32 && kind != BODY_OP_I32_FROM_I64) continue;
+            if (dst < 0 || dst >= n || src < 0 || src >= n || scan.width[dst] == 0 ||
+                ra->is_const[dst] || !ra->is_const[src] || scan.defs[dst] != 1) continue;
+            ra->is_const[dst] = true;
+            ra->imm[dst] = kind == BODY_OP_I32_FROM_I64 ? (int64_t)(int32_t)ra->imm[src] : ra->imm[src];
+            folded = true;
+        }
+    }
+    ColdInterval *iv = malloc(ns * sizeof(ColdInterval));
+    if (!iv) die("out of memory");
+    int32_t iv_count = 0;
+    for (int32_t s = 0; s < n; s++) {
+        if (scan.width[s] == 0 || ra->is_const[s]) continue;
+        if (scan.uses[s] == 0) {
+            ra->dead[s] = true;
+            continue;
+        }
+        iv[iv_count].slot = s;
+        iv[iv_count].start = scan.first[s];
+        iv[iv_count].end = scan.last[s];
+        iv[iv_count].weight = scan.weight[s];
+        iv_count++;
+    }
+
+    /* Widen intervals over every loop they overlap, to a fixed point. */
+    for (int32_t i = 0; i < iv_count; i++) {
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (int32_t l = 0; l < loop_count; l++) {
+                if (iv[i].start > loop_tail[l] || iv[i].end < loop_head[l]) continue;
+                if (loop_head[l] < iv[i].start) { iv[i].start = loop_head[l]; changed = true; }
+                if (loop_tail[l] > iv[i].end) { iv[i].end = loop_tail[l]; changed = true; }
+            }
+        }
+        iv[i].crosses_clobber = iv[i].end > iv[i].start + 1 &&
+                                calls_before[iv[i].end] - calls_before[iv[i].start + 1] > 0;
+    }
+    qsort(iv, (size_t)iv_count, sizeof(ColdInterval), cold_interval_cmp);
+
+    const int32_t *pool = target->pool;
+    int32_t pool_count = target->pool_count;
+    int32_t owner[32];
+    for (int32_t r = 0; r < 32; r++) owner[r] = -1;
+    for (int32_t i = 0; i < iv_count; i++) {
+        for (int32_t r = 0; r < pool_count; r++) {
+            int32_t o = owner[pool[r]];
+            if (o >= 0 && iv[o].end <= iv[i].start) owner[pool[r]] = -1;
+        }
+        int32_t first_reg = iv[i].crosses_clobber ? target->first_safe : 0;
+        int32_t pick = -1;
+        for (int32_t r = first_reg; r < pool_count && pick < 0; r++)
+            if (owner[pool[r]] < 0) pick = pool[r];
+        if (pick < 0) {
+            int32_t victim_reg = -1;
+            for (int32_t r = first_reg; r < pool_count; r++) {
+                int32_t o = owner[pool[r]];
+                if (victim_reg < 0 || iv[o].weight < iv[owner[victim_reg]].weight) victim_reg = pool[r];
+            }
+            if (victim_reg < 0 || iv[owner[victim_reg]].weight >= iv[i].weight) continue;
+            ra->reg[iv[owner[victim_reg]].slot] = -1;
+            pick = victim_reg;
+        }
+        owner[pick] = i;
+        ra->reg[iv[i].slot] = (int8_t)pick;
+    }
+    for (int32_t r = 0; r < target->callee_saved_count; r++) {
+        bool used = false;
+        for (int32_t s = 0; s < n && !used; s++) used = ra->reg[s] == target->callee_saved[r];
+        if (used) ra->saved[ra->saved_count++] = target->callee_saved[r];
+    }
+
+    /* Frame: slots, then the hidden return pointer when the body has no
+       slot for it. The backend pads it for its own saves and alignment. */
+    int32_t frame = body->frame_size;
+    ra->sret_off = -1;
+    if (cold_kind_is_composite(body->return_kind) && ra->params_in_regs) {
+        if (body->sret_slot >= 0) {
+            ra->sret_off = body->slot_offset[body->sret_slot];
+        } else {
+            ra->sret_off = align_i32(frame, 8);
+            frame = ra->sret_off + 8;
+        }
+    }
+    ra->frame = frame;
+
+    ra->uses = scan.uses;
+    free(iv);
+    free(block_start);
+    free(scan.width); free(scan.first); free(scan.last); free(scan.defs);
+    free(scan.const_op); free(scan.weight); free(scan.depth); free(scan.freq);
+    free(loop_head); free(loop_tail); free(calls_before); free(arg_covered);
+}
+
+static void cold_regalloc_free(ColdRegAlloc *ra) {
+    free(ra->reg);
+    free(ra->is_const);
+    free(ra->dead);
+    free(ra->imm);
+    free(ra->uses);
+    free(ra->param_place);
+}
+
+/* ---- x86_64 lowering through the allocation ---- */
+
+typedef struct X64Operand {
+    int32_t kind;
+    int32_t reg;
+    int32_t disp;
+    int64_t imm;
+} X64Operand;
+
+enum { X64_OPND_REG, X64_OPND_MEM, X64_OPND_IMM };
+
+static const int32_t x64_arg_regs[6] = {X64_RDI, X64_RSI, X64_RDX, X64_RCX, X64_R8, X64_R9};
+
+/* BodyIR conditions use the aarch64 numbering; ucomis* sets flags like an
+   unsigned compare. */
+static int x64_cc_from_cond(int32_t cond, bool is_float) {
+    switch (cond) {
+    case COND_EQ: return CC_E;
+    case COND_NE: return CC_NE;
+    case COND_GE: return is_float ? CC_AE : CC_GE;
+    case COND_LT: return is_float ? CC_B : CC_L;
+    case COND_GT: return is_float ? CC_A : CC_G;
+    case COND_LE: return is_float ? CC_BE : CC_LE;
+    case 2: return CC_AE;  /* HS */
+    case 3: return CC_B;   /* LO */
+    case 4: return CC_S;   /* MI */
+    case 5: return CC_NS;  /* PL */
+    case 8: return CC_A;   /* HI */
+    case 9: return CC_BE;  /* LS */
+    default: return CC_E;
+    }
+}
+
+/* Condition after exchanging the compare operands. */
+static int x64_cc_swap(int cc) {
+    switch (cc) {
+    case CC_L: return CC_G;
+    case CC_G: return CC_L;
+    case CC_LE: return CC_GE;
+    case CC_GE: return CC_LE;
+    case CC_B: return CC_A;
+    case CC_A: return CC_B;
+    case CC_BE: return CC_AE;
+    case CC_AE: return CC_BE;
+    default: return cc;
+    }
+}
+
+/* Where a slot's current value can be read at the given width. */
+static X64Operand x64_ra_operand(ColdRegAlloc *ra, BodyIR *body, int32_t slot, int32_t bytes) {
+    X64Operand o = {X64_OPND_MEM, -1, body->slot_offset[slot] + ra->sp_bias, 0};
+    if (ra->is_const[slot]) {
+        o.kind = X64_OPND_IMM;
+        o.imm = bytes == 8 ? ra->imm[slot] : (int64_t)(int32_t)ra->imm[slot];
+    } else if (ra->reg[slot] >= 0) {
+        o.kind = X64_OPND_REG;
+        o.reg = ra->reg[slot];
+    } else if (ra->acc_slot == slot && ra->acc_bytes >= bytes) {
+        o.kind = X64_OPND_REG;
+        o.reg = X64_RAX;
+    }
+    return o;
+}
+
+/* rax no longer mirrors a frame slot after it is written by anything other
+   than a load or store of that slot. */
+static void x64_ra_clobber(ColdRegAlloc *ra, int32_t reg) {
+    if (reg == X64_RAX) ra->acc_slot = -1;
+}
+
+static void x64_ra_load(X64Code *x, ColdRegAlloc *ra, BodyIR *body, int32_t reg,
+                        int32_t slot, int32_t bytes) {
+    X64Operand o = x64_ra_operand(ra, body, slot, bytes);
+    bool wide = bytes == 8;
+    if (o.kind == X64_OPND_IMM) {
+        x64_mov_ri(x, reg, o.imm, wide);
+        x64_ra_clobber(ra, reg);
+    } else if (o.kind == X64_OPND_REG) {
+        if (o.reg != reg) x64_mov_rr(x, reg, o.reg, wide);
+        x64_ra_clobber(ra, reg);
+    } else {
+        x64_mov_rm(x, reg, X64_RSP, o.disp, wide);
+        if (reg == X64_RAX) { ra->acc_slot = slot; ra->acc_bytes = bytes; }
+    }
+    if (reg == X64_RAX && o.kind == X64_OPND_REG && o.reg == X64_RAX) {
+        ra->acc_slot = slot;
+        ra->acc_bytes = bytes;
+    }
+}
+
+static void x64_ra_store(X64Code *x, ColdRegAlloc *ra, BodyIR *body, int32_t slot,
+                         int32_t reg, int32_t bytes) {
+    if (ra->reg[slot] >= 0) {
+        if (ra->reg[slot] != reg) x64_mov_rr(x, ra->reg[slot], reg, bytes == 8);
+        return;
+    }
+    if (ra->is_const[slot] || ra->dead[slot]) return;
+    x64_mov_mr(x, X64_RSP, body->slot_offset[slot], reg, bytes == 8);
+    if (reg == X64_RAX) {
+        ra->acc_slot = slot;
+        ra->acc_bytes = bytes;
+    } else if (ra->acc_slot == slot) {
+        ra->acc_slot = -1;
+    }
+}
+
+/* Register an op computes its result in: the destination's own register,
+   rax for frame slots. */
+static int32_t x64_ra_result_reg(ColdRegAlloc *ra, int32_t slot) {
+    return ra->reg[slot] >= 0 ? ra->reg[slot] : X64_RAX;
+}
+
+static void x64_ra_move(X64Code *x, ColdRegAlloc *ra, BodyIR *body, int32_t dst,
+                        int32_t src, int32_t bytes) {
+    if (ra->reg[dst] >= 0) {
+        x64_ra_load(x, ra, body, ra->reg[dst], src, bytes);
+        return;
+    }
+    if (ra->is_const[dst] || ra->dead[dst]) return;
+    X64Operand o = x64_ra_operand(ra, body, src, bytes);
+    if (o.kind == X64_OPND_IMM) {
+        x64_mov_mi(x, X64_RSP, body->slot_offset[dst], (int32_t)o.imm, bytes == 8);
+        if (ra->acc_slot == dst) ra->acc_slot = -1;
+    } else if (o.kind == X64_OPND_REG) {
+        x64_ra_store(x, ra, body, dst, o.reg, bytes);
+    } else {
+        x64_ra_load(x, ra, body, X64_RAX, src, bytes);
+        x64_ra_store(x, ra, body, dst, X64_RAX, bytes);
+    }
+}
+
+static void x64_ra_const(X64Code *x, ColdRegAlloc *ra, BodyIR *body, int32_t dst,
+                         int64_t value, int32_t bytes) {
+    if (ra->is_const[dst] || ra->dead[dst]) return;
+    if (ra->reg[dst] >= 0) {
+        x64_mov_ri(x, ra->reg[dst], value, bytes == 8);
+    } else if (value >= INT32_MIN && value <= INT32_MAX) {
+        x64_mov_mi(x, X64_RSP, body->slot_offset[dst], (int32_t)value, bytes == 8);
+        if (ra->acc_slot == dst) ra->acc_slot = -1;
+    } else {
+        x64_mov_ri(x, X64_RAX, value, true);
+        ra->acc_slot = -1;
+        x64_ra_store(x, ra, body, dst, X64_RAX, bytes);
+    }
+}
+
+/* cmp a, b with the cheapest operand forms; returns the condition to test,
+   adjusted when the operands had to be exchanged. */
+static int x64_ra_compare(X64Code *x, ColdRegAlloc *ra, BodyIR *body, int32_t a,
+                          int32_t b, int32_t bytes, int cc) {
+    bool wide = bytes == 8;
+    X64Operand oa = x64_ra_operand(ra, body, a, bytes);
+    X64Operand ob = x64_ra_operand(ra, body, b, bytes);
+    if (oa.kind == X64_OPND_IMM && ob.kind != X64_OPND_IMM) {
+        X64Operand t = oa; oa = ob; ob = t;
+        cc = x64_cc_swap(cc);
+    }
+    if (oa.kind == X64_OPND_IMM || (oa.kind == X64_OPND_MEM && ob.kind == X64_OPND_MEM)) {
+        x64_ra_load(x, ra, body, X64_RAX, a, bytes);
+        oa.kind = X64_OPND_REG;
+        oa.reg = X64_RAX;
+    }
+    if (oa.kind == X64_OPND_MEM) {
+        if (ob.kind == X64_OPND_IMM) x64_alu_mi(x, X64_ALU_CMP, X64_RSP, oa.disp, (int32_t)ob.imm, wide);
+        else x64_alu_mr(x, X64_ALU_CMP, X64_RSP, oa.disp, ob.reg, wide);
+    } else if (ob.kind == X64_OPND_IMM) {
+        if (ob.imm == 0) x64_test_rr(x, oa.reg, oa.reg, wide);
+        else x64_alu_ri(x, X64_ALU_CMP, oa.reg, (int32_t)ob.imm, wide);
+    } else if (ob.kind == X64_OPND_REG) {
+        x64_alu_rr(x, X64_ALU_CMP, oa.reg, ob.reg, wide);
+    } else {
+        x64_alu_rm(x, X64_ALU_CMP, oa.reg, X64_RSP, ob.disp, wide);
+    }
+    return cc;
+}
+
+/* dst = a <op> b for ADD/SUB/AND/OR/XOR (ALU ext) and MUL (ext < 0). */
+static void x64_ra_binary(X64Code *x, ColdRegAlloc *ra, BodyIR *body, int32_t ext,
+                          int32_t dst, int32_t a, int32_t b, int32_t bytes) {
+    bool wide = bytes == 8;
+    bool commutative = ext != X64_ALU_SUB;
+    int32_t rd = x64_ra_result_reg(ra, dst);
+    X64Operand ob = x64_ra_operand(ra, body, b, bytes);
+    if (ob.kind == X64_OPND_REG && ob.reg == rd && rd != X64_RAX &&
+        x64_ra_operand(ra, body, a, bytes).reg != rd) {
+        if (commutative) { int32_t t = a; a = b; b = t; }
+        else rd = X64_RAX;
+    }
+    ob = x64_ra_operand(ra, body, b, bytes);
+    if (ext < 0 && ob.kind == X64_OPND_IMM) {
+        X64Operand oa = x64_ra_operand(ra, body, a, bytes);
+        if (oa.kind == X64_OPND_REG) {
+            x64_imul_rri(x, rd, oa.reg, (int32_t)ob.imm, wide);
+        } else if (oa.kind == X64_OPND_MEM) {
+            x64_imul_rmi(x, rd, X64_RSP, oa.disp, (int32_t)ob.imm, wide);
+        } else {
+            x64_mov_ri(x, rd, oa.imm, wide);
+            x64_imul_rri(x, rd, rd, (int32_t)ob.imm, wide);
+        }
+        x64_ra_clobber(ra, rd);
+        x64_ra_store(x, ra, body, dst, rd, bytes);
+        return;
+    }
+    x64_ra_load(x, ra, body, rd, a, bytes);
+    ob = x64_ra_operand(ra, body, b, bytes);
+    if (ext < 0) {
+        if (ob.kind == X64_OPND_REG) x64_imul_rr(x, rd, ob.reg, wide);
+        else x64_imul_rm(x, rd, X64_RSP, ob.disp, wide);
+    } else if (ob.kind == X64_OPND_IMM) {
+        x64_alu_ri(x, ext, rd, (int32_t)ob.imm, wide);
+    } else if (ob.kind == X64_OPND_REG) {
+        x64_alu_rr(x, ext, rd, ob.reg, wide);
+    } else {
+        x64_alu_rm(x, ext, rd, X64_RSP, ob.disp, wide);
+    }
+    x64_ra_clobber(ra, rd);
+    x64_ra_store(x, ra, body, dst, rd, bytes);
+}
+
+static void x64_ra_shift(X64Code *x, ColdRegAlloc *ra, BodyIR *body, int32_t ext,
+                         int32_t dst, int32_t a, int32_t b, int32_t bytes) {
+    bool wide = bytes == 8;
+    int32_t rd = x64_ra_result_reg(ra, dst);
+    X64Operand ob = x64_ra_operand(ra, body, b, 4);
+    if (ob.kind == X64_OPND_IMM) {
+        x64_ra_load(x, ra, body, rd, a, bytes);
+        int32_t count = (int32_t)ob.imm & (wide ? 63 : 31);
+        if (count != 0) x64_shift_ri(x, ext, rd, count, wide);
+    } else {
+        x64_ra_load(x, ra, body, X64_RCX, b, 4);
+        x64_ra_load(x, ra, body, rd, a, bytes);
+        x64_shift_rcl(x, ext, rd, wide);
+    }
+    x64_ra_clobber(ra, rd);
+    x64_ra_store(x, ra, body, dst, rd, bytes);
+}
+
+static void x64_ra_divide(X64Code *x, ColdRegAlloc *ra, BodyIR *body, bool rem,
+                          int32_t dst, int32_t a, int32_t b, int32_t bytes) {
+    bool wide = bytes == 8;
+    X64Operand ob = x64_ra_operand(ra, body, b, bytes);
+    int32_t divisor = X64_RCX;
+    if (ob.kind == X64_OPND_REG && ob.reg != X64_RAX) divisor = ob.reg;
+    else x64_ra_load(x, ra, body, X64_RCX, b, bytes);
+    x64_ra_load(x, ra, body, X64_RAX, a, bytes);
+    if (wide) { x64_cqo(x); x64_idiv_r64(x, divisor); }
+    else { x64_cdq(x); x64_idiv_r32(x, divisor); }
+    x64_ra_clobber(ra, X64_RAX);
+    x64_ra_store(x, ra, body, dst, rem ? X64_RDX : X64_RAX, bytes);
+}
+
+/* Pointer operand as a base register: its own register or rax. */
+static int32_t x64_ra_base(X64Code *x, ColdRegAlloc *ra, BodyIR *body, int32_t slot) {
+    X64Operand o = x64_ra_operand(ra, body, slot, 8);
+    if (o.kind == X64_OPND_REG) return o.reg;
+    x64_ra_load(x, ra, body, X64_RAX, slot, 8);
+    return X64_RAX;
+}
+
+/* One-word argument into reg. A ref parameter takes a ref argument as is
+   and anything else by address, like the aarch64 lowering. */
+static void x64_ra_word_arg(X64Code *x, ColdRegAlloc *ra, BodyIR *body, int32_t reg,
+                            int32_t param_kind, int32_t arg) {
+    if (arg < 0 || arg >= body->slot_count) return;
+    int32_t arg_kind = body->slot_kind[arg];
+    int32_t disp = body->slot_offset[arg] + ra->sp_bias;
+    if (cold_kind_is_ref(param_kind)) {
+        if (cold_kind_is_ref(arg_kind)) x64_mov_rm(x, reg, X64_RSP, disp, true);
+        else x64_lea_r64_mr(x, reg, X64_RSP, disp);
+        if (reg == X64_RAX) ra->acc_slot = -1;
+        return;
+    }
+    int32_t bytes = cold_arg_bytes(param_kind, arg_kind);
+    if (bytes > 0) x64_ra_load(x, ra, body, reg, arg, bytes);
+}
+
+static void x64_ra_call(X64Code *x, ColdRegAlloc *ra, BodyIR *body, Symbols *symbols,
+                        FunctionPatchList *patches, int32_t op, int32_t arg_base) {
+    int32_t dst = body->op_dst[op];
+    int32_t fn_index = body->op_a[op];
+    FnDef *fn = &symbols->functions[fn_index];
+    int32_t *place = malloc((size_t)(fn->arity > 0 ? fn->arity : 1) * sizeof(int32_t));
+    if (!place) die("out of memory");
+    int32_t words = cold_place_params(fn->param_kind, NULL, fn->arity, arg_base > 0, X64_ARG_STACK,
+                                      false, place);
+    int32_t pad = (words & 1) ? 8 : 0;
+    if (pad > 0) x64_alu_ri(x, X64_ALU_SUB, X64_RSP, pad, true);
+    ra->sp_bias = pad;
+    /* stack words highest first, so the first one ends up at [rsp] */
+    for (int32_t i = fn->arity - 1; i >= 0; i--) {
+        if (place[i] < X64_ARG_STACK) continue;
+        int32_t arg = body->call_arg_slot[body->op_b[op] + i];
+        bool valid = arg >= 0 && arg < body->slot_count;
+        if (fn->param_kind[i] == SLOT_STR) {
+            for (int32_t word = 1; word >= 0; word--) {
+                if (valid && body->slot_kind[arg] == SLOT_STR)
+                    x64_mov_rm(x, X64_RAX, X64_RSP, body->slot_offset[arg] + ra->sp_bias + 8 * word, true);
+                x64_push_r64(x, X64_RAX);
+                ra->sp_bias += 8;
+            }
+        } else {
+            x64_ra_word_arg(x, ra, body, X64_RAX, fn->param_kind[i], arg);
+            x64_push_r64(x, X64_RAX);
+            ra->sp_bias += 8;
+        }
+    }
+    if (arg_base > 0) x64_lea_r64_mr(x, X64_RDI, X64_RSP, body->slot_offset[dst] + ra->sp_bias);
+    for (int32_t i = 0; i < fn->arity; i++) {
+        if (place[i] >= X64_ARG_STACK) continue;
+        int32_t arg = body->call_arg_slot[body->op_b[op] + i];
+        if (arg < 0 || arg >= body->slot_count) continue;
+        int32_t reg = x64_arg_regs[place[i]];
+        if (fn->param_kind[i] == SLOT_STR) {
+            if (body->slot_kind[arg] != SLOT_STR) continue;
+            x64_mov_rm(x, reg, X64_RSP, body->slot_offset[arg] + ra->sp_bias, true);
+            x64_mov_rm(x, x64_arg_regs[place[i] + 1], X64_RSP,
+                       body->slot_offset[arg] + ra->sp_bias + 8, true);
+            continue;
+        }
+        x64_ra_word_arg(x, ra, body, reg, fn->param_kind[i], arg);
+    }
+    int32_t call_pos = x->len + 1;
+    x64_call_rel32(x, 0);
+    function_patches_add(patches, call_pos, fn_index);
+    if (ra->sp_bias > 0) x64_alu_ri(x, X64_ALU_ADD, X64_RSP, ra->sp_bias, true);
+    ra->sp_bias = 0;
+    ra->acc_slot = -1;
+    free(place);
+    if (arg_base == 0 && dst >= 0 && dst < body->slot_count) {
+        int32_t bytes = cold_scalar_bytes(body->slot_kind[dst]) == 8 ? 8 : 4;
+        x64_ra_store(x, ra, body, dst, X64_RAX, bytes);
+    }
+}
+
+/* Lowers the scalar ops through the allocation; false for ops left to
+   x64_codegen_op. */
+static bool x64_lower_op(X64Code *x, ColdRegAlloc *ra, BodyIR *body, Symbols *symbols,
+                         FunctionPatchList *patches, int32_t op) {
+    int32_t kind = body->op_kind[op];
+    /* LOAD_I32 only materializes a slot in the aarch64 result register;
+       every x86_64 consumer reads its operands from their homes. */
+    if (kind == BODY_OP_LOAD_I32) return true;
+    int32_t arg_base = cold_call_arg_base(body, symbols, X64_ARG_STACK, false, op);
+    if (arg_base >= 0) {
+        x64_ra_call(x, ra, body, symbols, patches, op, arg_base);
+        return true;
+    }
+    ColdOpShape shape;
+    if (!cold_op_shape(body, op, &shape)) return false;
+    int32_t dst = body->op_dst[op];
+    int32_t a = body->op_a[op], b = body->op_b[op], c = body->op_c[op];
+    if (shape.pure && (ra->is_const[dst] || ra->dead[dst])) return true;
+    switch (kind) {
+    case BODY_OP_I32_CONST:
+        x64_ra_const(x, ra, body, dst, a, 4);
+        break;
+    case BODY_OP_I64_CONST:
+        x64_ra_const(x, ra, body, dst,
+                     (int64_t)((uint32_t)a | ((uint64_t)(uint32_t)b << 32)), 8);
+        break;
+    case BODY_OP_PTR_CONST:
+        x64_ra_const(x, ra, body, dst, (int64_t)(int32_t)a, 8);
+        break;
+    case BODY_OP_COPY_I32: case BODY_OP_I32_FROM_I64:
+        x64_ra_move(x, ra, body, dst, a, 4);
+        break;
+    case BODY_OP_COPY_I64:
+        x64_ra_move(x, ra, body, dst, a, 8);
+        break;
+    case BODY_OP_I32_ADD: case BODY_OP_I64_ADD:
+        x64_ra_binary(x, ra, body, X64_ALU_ADD, dst, a, b, shape.def_bytes);
+        break;
+    case BODY_OP_I32_SUB: case BODY_OP_I64_SUB:
+        x64_ra_binary(x, ra, body, X64_ALU_SUB, dst, a, b, shape.def_bytes);
+        break;
+    case BODY_OP_I32_AND: case BODY_OP_I64_AND:
+        x64_ra_binary(x, ra, body, X64_ALU_AND, dst, a, b, shape.def_bytes);
+        break;
+    case BODY_OP_I32_OR: case BODY_OP_I64_OR:
+        x64_ra_binary(x, ra, body, X64_ALU_OR, dst, a, b, shape.def_bytes);
+        break;
+    case BODY_OP_I32_XOR: case BODY_OP_I64_XOR:
+        x64_ra_binary(x, ra, body, X64_ALU_XOR, dst, a, b, shape.def_bytes);
+        break;
+    case BODY_OP_I32_MUL: case BODY_OP_I64_MUL:
+        x64_ra_binary(x, ra, body, -1, dst, a, b, shape.def_bytes);
+        break;
+    case BODY_OP_I32_SHL: case BODY_OP_I64_SHL:
+        x64_ra_shift(x, ra, body, X64_SHIFT_SHL, dst, a, b, shape.def_bytes);
+        break;
+    case BODY_OP_I32_ASR: case BODY_OP_I64_ASR:
+        x64_ra_shift(x, ra, body, X64_SHIFT_SAR, dst, a, b, shape.def_bytes);
+        break;
+    case BODY_OP_I32_DIV: case BODY_OP_I64_DIV:
+        x64_ra_divide(x, ra, body, false, dst, a, b, shape.def_bytes);
+        break;
+    case BODY_OP_I32_MOD:
+        x64_ra_divide(x, ra, body, true, dst, a, b, 4);
+        break;
+    case BODY_OP_I32_CMP: case BODY_OP_I64_CMP: {
+        int cc = x64_ra_compare(x, ra, body, a, b, shape.use_bytes[0],
+                                x64_cc_from_cond(c, false));
+        int32_t rd = x64_ra_result_reg(ra, dst);
+        x64_setcc_r8(x, cc, X64_RAX);
+        x64_movzb_r8_r32(x, rd, X64_RAX);
+        x64_ra_clobber(ra, X64_RAX);
+        x64_ra_store(x, ra, body, dst, rd, 4);
+        break;
+    }
+    case BODY_OP_I64_FROM_I32: {
+        int32_t rd = x64_ra_result_reg(ra, dst);
+        X64Operand oa = x64_ra_operand(ra, body, a, 4);
+        if (oa.kind == X64_OPND_IMM) x64_mov_ri(x, rd, oa.imm, true);
+        else if (oa.kind == X64_OPND_REG) x64_movsxd_r64_r32(x, rd, oa.reg);
+        else x64_movsxd_rm(x, rd, X64_RSP, oa.disp);
+        x64_ra_clobber(ra, rd);
+        x64_ra_store(x, ra, body, dst, rd, 8);
+        break;
+    }
+    case BODY_OP_PTR_ADD:
+        if (shape.use_bytes[1] == 4 &&
+            x64_ra_operand(ra, body, b, 4).kind != X64_OPND_IMM) {
+            int32_t rd = x64_ra_result_reg(ra, dst);
+            X64Operand ob = x64_ra_operand(ra, body, b, 4);
+            if (ob.kind == X64_OPND_REG) x64_movsxd_r64_r32(x, X64_RCX, ob.reg);
+            else x64_movsxd_rm(x, X64_RCX, X64_RSP, ob.disp);
+            x64_ra_load(x, ra, body, rd, a, 8);
+            x64_alu_rr(x, X64_ALU_ADD, rd, X64_RCX, true);
+            x64_ra_clobber(ra, rd);
+            x64_ra_store(x, ra, body, dst, rd, 8);
+        } else {
+            x64_ra_binary(x, ra, body, X64_ALU_ADD, dst, a, b, 8);
+        }
+        break;
+    case BODY_OP_PTR_LOAD_I32: case BODY_OP_PTR_LOAD_U8:
+    case BODY_OP_PTR_LOAD_U16: case BODY_OP_PTR_LOAD_I64: {
+        int32_t base = x64_ra_base(x, ra, body, a);
+        int32_t rd = x64_ra_result_reg(ra, dst);
+        if (kind == BODY_OP_PTR_LOAD_U8) x64_movzx_rm(x, rd, base, 0, 1);
+        else if (kind == BODY_OP_PTR_LOAD_U16) x64_movzx_rm(x, rd, base, 0, 2);
+        else x64_mov_rm(x, rd, base, 0, kind == BODY_OP_PTR_LOAD_I64);
+        x64_ra_clobber(ra, rd);
+        x64_ra_store(x, ra, body, dst, rd, shape.def_bytes);
+        break;
+    }
+    case BODY_OP_PTR_STORE_I32: case BODY_OP_PTR_STORE_U8:
+    case BODY_OP_PTR_STORE_U16: case BODY_OP_PTR_STORE_I64: {
+        int32_t bytes = kind == BODY_OP_PTR_STORE_I64 ? 8 :
+                        kind == BODY_OP_PTR_STORE_I32 ? 4 :
+                        kind == BODY_OP_PTR_STORE_U16 ? 2 : 1;
+        X64Operand ov = x64_ra_operand(ra, body, a, shape.use_bytes[1]);
+        int32_t value = -1;
+        if (ov.kind == X64_OPND_REG && ov.reg != X64_RAX) {
+            value = ov.reg;
+        } else if (ov.kind != X64_OPND_IMM || bytes < 4) {
+            x64_ra_load(x, ra, body, X64_RCX, a, shape.use_bytes[1]);
+            value = X64_RCX;
+        }
+        int32_t base = x64_ra_base(x, ra, body, dst);
+        if (value < 0) x64_mov_mi(x, base, 0, (int32_t)ov.imm, bytes == 8);
+        else if (bytes >= 4) x64_mov_mr(x, base, 0, value, bytes == 8);
+        else x64_mov_mr_narrow(x, base, 0, value, bytes);
+        /* the store may alias a frame slot rax mirrors */
+        ra->acc_slot = -1;
+        break;
+    }
+    default:
+        return false;
+    }
+    return true;
+}
+
+/* push rbp; mov rsp, rbp; push saved; sub $frame, rsp; then the hidden
+   return pointer and register params go to their homes. */
+static void x64_codegen_prologue(X64Code *x, BodyIR *body, ColdRegAlloc *ra) {
+    x64_push_r64(x, X64_RBP);
+    x64_mov_r64_r64(x, X64_RBP, X64_RSP);
+    for (int32_t i = 0; i < ra->saved_count; i++) x64_push_r64(x, ra->saved[i]);
+    if (ra->frame > 0) x64_alu_ri(x, X64_ALU_SUB, X64_RSP, ra->frame, true);
+    if (!ra->params_in_regs) return;
+    if (ra->sret_off >= 0) x64_mov_mr(x, X64_RSP, ra->sret_off, X64_RDI, true);
+    for (int32_t i = 0; i < body->param_count; i++) {
+        int32_t slot = body->param_slot[i];
+        int32_t place = ra->param_place[i];
+        int32_t off = body->slot_offset[slot];
+        /* stack words sit above the saved rbp and the return address */
+        int32_t in_disp = 16 + 8 * (place - X64_ARG_STACK);
+        if (body->slot_kind[slot] == SLOT_STR) {
+            for (int32_t word = 0; word < 2; word++) {
+                int32_t reg = X64_RAX;
+                if (place < X64_ARG_STACK) reg = x64_arg_regs[place + word];
+                else x64_mov_rm(x, X64_RAX, X64_RBP, in_disp + 8 * word, true);
+                x64_mov_mr(x, X64_RSP, off + 8 * word, reg, true);
+            }
+            continue;
+        }
+        bool wide = cold_scalar_bytes(body->slot_kind[slot]) != 4;
+        int32_t reg = ra->reg[slot] >= 0 ? ra->reg[slot] : X64_RAX;
+        if (place < X64_ARG_STACK) {
+            if (ra->reg[slot] >= 0) x64_mov_rr(x, reg, x64_arg_regs[place], wide);
+            else if (!ra->dead[slot]) x64_mov_mr(x, X64_RSP, off, x64_arg_regs[place], wide);
+        } else if (ra->reg[slot] >= 0 || !ra->dead[slot]) {
+            x64_mov_rm(x, reg, X64_RBP, in_disp, wide);
+            if (ra->reg[slot] < 0) x64_mov_mr(x, X64_RSP, off, X64_RAX, wide);
+        }
+    }
+}
+
+/* lea -saved(rbp), rsp; pop saved; pop rbp; ret */
+static void x64_codegen_epilogue(X64Code *x, ColdRegAlloc *ra) {
+    if (ra->saved_count > 0) x64_lea_r64_mr(x, X64_RSP, X64_RBP, -8 * ra->saved_count);
+    else x64_mov_r64_r64(x, X64_RSP, X64_RBP);
+    for (int32_t i = ra->saved_count - 1; i >= 0; i--) x64_pop_r64(x, ra->saved[i]);
+    x64_pop_r64(x, X64_RBP);
+    x64_ret(x);
+}
+
+static void x64_codegen_return(X64Code *x, ColdRegAlloc *ra, BodyIR *body, int32_t term) {
+    int32_t value = body->term_value[term];
+    int32_t kind = value >= 0 && value < body->slot_count ? body->slot_kind[value] : 0;
+    int32_t bytes = cold_scalar_bytes(kind);
+    if (bytes > 0) {
+        x64_ra_load(x, ra, body, X64_RAX, value, bytes);
+    } else if (cold_kind_is_composite(kind) && ra->sret_off >= 0) {
+        int32_t copy_bytes = kind == SLOT_STR ? 16 : body->slot_size[value];
+        int32_t total = kind == SLOT_STR ? 16 : body->return_size;
+        if (copy_bytes > total) copy_bytes = total;
+        x64_mov_rm(x, X64_RCX, X64_RSP, ra->sret_off, true);
+        for (int32_t off = 0; off < copy_bytes; off += 8) {
+            x64_mov_rm(x, X64_RAX, X64_RSP, body->slot_offset[value] + off, true);
+            x64_mov_mr(x, X64_RCX, off, X64_RAX, true);
+        }
+        for (int32_t off = copy_bytes; off < total; off += 8)
+            x64_mov_mi(x, X64_RCX, off, 0, true);
+        x64_mov_rr(x, X64_RAX, X64_RCX, true);
+    } else {
+        x64_mov_ri(x, X64_RAX, 0, false);
+    }
+    x64_codegen_epilogue(x, ra);
+}
+
+/* The block's last real op (constants emit nothing) when it is an integer
+   compare whose only reader is the block's CBR against zero: the branch then
+   tests the compare's own flags instead of a materialized 0/1. Returns -1
+   otherwise. */
+static int32_t cold_fused_compare(ColdRegAlloc *ra, BodyIR *body, int32_t block) {
+    int32_t term = body->block_term[block];
+    int32_t count = body->block_op_count[block];
+    if (term < 0 || term >= body->term_count || count == 0 ||
+        body->term_kind[term] != BODY_TERM_CBR) return -1;
+    int32_t op = body->block_op_start[block] + count - 1;
+    while (op > body->block_op_start[block] &&
+           (body->op_kind[op] == BODY_OP_I32_CONST || body->op_kind[op] == BODY_OP_I64_CONST ||
+            body->op_kind[op] == BODY_OP_PTR_CONST) && ra->is_const[body->op_dst[op]]) op--;
+    int32_t kind = body->op_kind[op];
+    int32_t flag = body->op_dst[op];
+    int32_t cond = body->term_case_start[term];
+    int32_t zero = body->term_case_count[term];
+    if (kind != BODY_OP_I32_CMP && kind != BODY_OP_I64_CMP) return -1;
+    if (body->term_value[term] != flag || ra->uses[flag] != 1) return -1;
+    if (zero < 0 || zero >= body->slot_count || !ra->is_const[zero] || ra->imm[zero] != 0) return -1;
+    if (cond != COND_NE && cond != COND_EQ) return -1;
+    return op;
+}
+
+typedef struct X64BlockPatch {
+    int32_t pos;
+    int32_t block;
+} X64BlockPatch;
+
+typedef struct X64BlockPatches {
+    X64BlockPatch *items;
+    int32_t count;
+    int32_t cap;
+} X64BlockPatches;
+
+/* jmp/jcc to a block: short form for known targets in range, rel32 patched
+   after layout otherwise. cc < 0 is an unconditional jump. */
+static void x64_jump_block(X64Code *x, X64BlockPatches *patches, int32_t *block_pos,
+                           int32_t block_count, int32_t target, int cc) {
+    if (target >= 0 && target < block_count && block_pos[target] >= 0) {
+        int32_t rel = block_pos[target] - (x->len + 2);
+        if (rel >= -128) {
+            if (cc < 0) x64_jmp_rel8(x, (int8_t)rel);
+            else x64_jcc_rel8(x, cc, (int8_t)rel);
+            return;
+        }
+        if (cc < 0) x64_jmp_rel32(x, block_pos[target] - (x->len + 5));
+        else x64_jcc_rel32(x, cc, block_pos[target] - (x->len + 6));
+        return;
+    }
+    if (cc < 0) x64_jmp_rel32(x, 0);
+    else x64_jcc_rel32(x, cc, 0);
+    if (patches->count == patches->cap) {
+        patches->cap = patches->cap ? patches->cap * 2 : 16;
+        patches->items = realloc(patches->items, (size_t)patches->cap * sizeof(X64BlockPatch));
+        if (!patches->items) die("out of memory");
+    }
+    patches->items[patches->count].pos = x->len - 4;
+    patches->items[patches->count++].block = target;
+}
+
+static void x64_codegen_switch(X64Code *x, ColdRegAlloc *ra, BodyIR *body,
+                               X64BlockPatches *patches, int32_t *block_pos, int32_t term) {
+    int32_t tag = body->term_value[term];
+    X64Operand o = x64_ra_operand(ra, body, tag, 4);
+    int32_t reg = o.kind == X64_OPND_REG ? o.reg : X64_RAX;
+    if (o.kind != X64_OPND_REG) x64_ra_load(x, ra, body, X64_RAX, tag, 4);
+    for (int32_t i = 0; i < body->switch_count; i++) {
+        if (body->switch_term[i] != term) continue;
+        if (body->switch_tag[i] == 0) x64_test_rr(x, reg, reg, false);
+        else x64_alu_ri(x, X64_ALU_CMP, reg, body->switch_tag[i], false);
+        x64_jump_block(x, patches, block_pos, body->block_count, body->switch_block[i], CC_E);
+    }
+}
+
+static void x64_codegen_op(X64Code *x, BodyIR *body, Symbols *symbols,
+                           FunctionPatchList *patches, int32_t op) {
+    int32_t kind = body->op_kind[op];
+    if (kind == BODY_OP_NOP) return;
+    int32_t dst = body->op_dst[op];
+    int32_t a = body->op_a[op];
+    int32_t b = body->op_b[op];
+    int32_t c = body->op_c[op];
+    int32_t off_dst = body->slot_offset[dst];
+    /* Scalar integer and pointer ops are lowered by x64_lower_op. */
+    /* Float: F32 */
+    if (kind == BODY_OP_F32_CONST) {
+        float val; memcpy(&val, &a, 4);
+        int32_t bits; memcpy(&bits, &val, 4);
+        x64_mov_r32_imm32(x, 0, bits);
+        x64_movd_xmm_r32(x, 0, 0);
+        x64_movss_mr_xmm(x, 4, off_dst, 0);
+    } else if (kind == BODY_OP_F32_ADD || kind == BODY_OP_F32_SUB ||
+               kind == BODY_OP_F32_MUL || kind == BODY_OP_F32_DIV) {
+        x64_movss_xmm_mr(x, 0, 4, body->slot_offset[a]);
+        x64_movss_xmm_mr(x, 1, 4, body->slot_offset[b]);
+        if (kind == BODY_OP_F32_ADD) x64_addss(x, 0, 1);
+        else if (kind == BODY_OP_F32_SUB) x64_subss(x, 0, 1);
+        else if (kind == BODY_OP_F32_MUL) x64_mulss(x, 0, 1);
+        else x64_divss(x, 0, 1);
+        x64_movss_mr_xmm(x, 4, off_dst, 0);
+    } else if (kind == BODY_OP_F32_NEG) {
+        x64_movss_xmm_mr(x, 0, 4, body->slot_offset[a]);
+        /* XOR sign bit: xmm1 = -0.0f, xorpd xmm0, xmm1 */
+        x64_mov_r32_imm32(x, 0, 0x80000000);
+        x64_movd_xmm_r32(x, 1, 0);
+        x64_xorps(x, 0, 1);
+        x64_movss_mr_xmm(x, 4, off_dst, 0);
+    } else if (kind == BODY_OP_F32_CMP) {
+        x64_movss_xmm_mr(x, 0, 4, body->slot_offset[a]);
+        x64_movss_xmm_mr(x, 1, 4, body->slot_offset[b]);
+        x64_ucomiss(x, 0, 1);
+        x64_setcc_r8(x, x64_cc_from_cond(c, true), 0);
+        x64_movzb_r8_r32(x, 0, 0);
+        x64_mov_mr32_r32(x, 4, off_dst, 0);
+    } else if (kind == BODY_OP_F32_FROM_I32) {
+        x64_mov_r32_mr32(x, 0, 4, body->slot_offset[a]);
+        x64_cvtsi2ss(x, 0, 0);
+        x64_movss_mr_xmm(x, 4, off_dst, 0);
+    } else if (kind == BODY_OP_I32_FROM_F32) {
+        x64_movss_xmm_mr(x, 0, 4, body->slot_offset[a]);
+        x64_cvttss2si(x, 0, 0);
+        x64_mov_mr32_r32(x, 4, off_dst, 0);
+    /* Float: F64 */
+    } else if (kind == BODY_OP_F64_CONST) {
+        uint64_t bits = (uint32_t)a | ((uint64_t)(uint32_t)b << 32);
+        x64_mov_r64_imm64(x, 0, bits);
+        x64_movd_xmm_r32(x, 0, 0);
+        x64_movsd_mr_xmm(x, 4, off_dst, 0);
+    } else if (kind == BODY_OP_F64_ADD || kind == BODY_OP_F64_SUB ||
+               kind == BODY_OP_F64_MUL || kind == BODY_OP_F64_DIV) {
+        x64_movsd_xmm_mr(x, 0, 4, body->slot_offset[a]);
+        x64_movsd_xmm_mr(x, 1, 4, body->slot_offset[b]);
+        if (kind == BODY_OP_F64_ADD) x64_addsd(x, 0, 1);
+        else if (kind == BODY_OP_F64_SUB) x64_subsd(x, 0, 1);
+        else if (kind == BODY_OP_F64_MUL) x64_mulsd(x, 0, 1);
+        else x64_divsd(x, 0, 1);
+        x64_movsd_mr_xmm(x, 4, off_dst, 0);
+    } else if (kind == BODY_OP_F64_NEG) {
+        x64_movsd_xmm_mr(x, 0, 4, body->slot_offset[a]);
+        x64_mov_r64_imm64(x, 0, 0x8000000000000000ULL);
+        x64_movd_xmm_r32(x, 1, 0);
+        x64_xorps(x, 0, 1);
+        x64_movsd_mr_xmm(x, 4, off_dst, 0);
+    } else if (kind == BODY_OP_F64_CMP) {
+        x64_movsd_xmm_mr(x, 0, 4, body->slot_offset[a]);
+        x64_movsd_xmm_mr(x, 1, 4, body->slot_offset[b]);
+        x64_ucomisd(x, 0, 1);
+        x64_setcc_r8(x, x64_cc_from_cond(c, true), 0);
+        x64_movzb_r8_r32(x, 0, 0);
+        x64_mov_mr32_r32(x, 4, off_dst, 0);
+    } else if (kind == BODY_OP_F64_FROM_I32) {
+        x64_mov_r32_mr32(x, 0, 4, body->slot_offset[a]);
+        x64_cvtsi2sd(x, 0, 0);
+        x64_movsd_mr_xmm(x, 4, off_dst, 0);
+    } else if (kind == BODY_OP_I32_FROM_F64) {
+        x64_movsd_xmm_mr(x, 0, 4, body->slot_offset[a]);
+        x64_cvttsd2si(x, 0, 0);
+        x64_mov_mr32_r32(x, 4, off_dst, 0);
+    /* String ops */
     } else if (kind == BODY_OP_STR_LITERAL) {
         if (a < 0 || a >= body->string_literal_count) die("invalid string literal index");
         Span literal = body->string_literal[a];
@@ -11835,14 +14102,19 @@ static void x64_codegen_op(X64Code *x, BodyIR *body, Symbols *symbols,
         x64_emit1(x, REX_W); x64_emit1(x, 0x8D); x64_emit1(x, MODRM(0, 0, 5));
         int32_t disp_pos = x->len;
         x64_emit4(x, 0);
-        int32_t data_pos = x->len;
-        for (int32_t sli = 0; sli <= literal.len; sli++)
-            x64_emit1(x, ((const uint8_t *)literal.ptr)[sli]);
-        int32_t disp = data_pos - (lea_pos + 7);
-        int32_t saved_len = x->len;
-        x->len = disp_pos;
-        x64_emit4(x, (uint32_t)disp);
-        x->len = saved_len;
+        if (cold_rodata.enabled) {
+            function_patches_add_kind(patches, disp_pos, cold_rodata_literal_id(literal),
+                                      FUNCTION_PATCH_RODATA);
+        } else {
+            int32_t data_pos = x->len;
+            for (int32_t sli = 0; sli <= literal.len; sli++)
+                x64_emit1(x, ((const uint8_t *)literal.ptr)[sli]);
+            int32_t disp = data_pos - (lea_pos + 7);
+            int32_t saved_len = x->len;
+            x->len = disp_pos;
+            x64_emit4(x, (uint32_t)disp);
+            x->len = saved_len;
+        }
         x64_mov_mr64_r64(x, 4, off_dst + COLD_STR_DATA_OFFSET, 0);
         x64_mov_r32_imm32(x, 1, (int32_t)literal.len);
         x64_mov_mr32_r32(x, 4, off_dst + COLD_STR_LEN_OFFSET, 1);
@@ -11867,16 +14139,18 @@ static void x64_codegen_op(X64Code *x, BodyIR *body, Symbols *symbols,
             x64_mov_r32_mr32(x, 2, 4, body->slot_offset[a] + 8);/* edx = len */
         }
         x64_mov_r32_mr32(x, 3, 4, body->slot_offset[b]);        /* ebx = index */
-        x64_test_r32_r32(x, 3, 3);
-        int32_t si_ge = x->len;
-        x64_jcc_rel8(x, CC_GE, 0);                               /* if index >= 0, ok */
-        x64_int3(x);                                              /* trap on negative index */
-        x->buf[si_ge + 1] = (uint8_t)(x->len - (si_ge + 2));
-        x64_cmp_r32_r32(x, 3, 2);                                 /* compare index vs len => len - index */
-        int32_t si_lt = x->len;
-        x64_jcc_rel8(x, CC_A, 0);                                 /* if len > index (index < len), ok */
-        x64_int3(x);                                              /* trap on out of bounds */
-        x->buf[si_lt + 1] = (uint8_t)(x->len - (si_lt + 2));
+        if (!cold_op_bounds_proven(body, op)) {
+            x64_test_r32_r32(x, 3, 3);
+            int32_t si_ge = x->len;
+            x64_jcc_rel8(x, CC_GE, 0);                           /* if index >= 0, ok */
+            x64_int3(x);                                          /* trap on negative index */
+            x->buf[si_ge + 1] = (uint8_t)(x->len - (si_ge + 2));
+            x64_cmp_r32_r32(x, 3, 2);                             /* compare index vs len => len - index */
+            int32_t si_lt = x->len;
+            x64_jcc_rel8(x, CC_A, 0);                             /* if len > index (index < len), ok */
+            x64_int3(x);                                          /* trap on out of bounds */
+            x->buf[si_lt + 1] = (uint8_t)(x->len - (si_lt + 2));
+        }
         x64_movsxd_r64_r32(x, 3, 3);                              /* sign-extend index to 64-bit */
         x64_add_r64_r64(x, 1, 3);                                  /* rcx = ptr + index */
         x64_movzb_r32_mr8(x, 0, 1);                                /* eax = byte from [rcx] */
@@ -12202,9 +14476,6 @@ static void x64_codegen_op(X64Code *x, BodyIR *body, Symbols *symbols,
             x64_mov_mr32_r32(x, 4, off_dst + 8, 2);
         }
     /* Load/Store */
-    } else if (kind == BODY_OP_LOAD_I32) {
-        x64_mov_r32_imm32(x, 0, 0);
-        x64_mov_mr32_r32(x, 4, off_dst, 0);
     } else if (kind == BODY_OP_PAYLOAD_LOAD) {
         x64_mov_r64_mr64(x, 0, 4, body->slot_offset[a] + b);
         x64_mov_mr64_r64(x, 4, off_dst, 0);
@@ -12267,42 +14538,6 @@ static void x64_codegen_op(X64Code *x, BodyIR *body, Symbols *symbols,
         x64_mov_mr64_r64(x, 4, off_dst, 0);
         if (fn_idx >= 0 && fn_idx < symbols->function_count)
             function_patches_add_addr(patches, imm_pos, fn_idx);
-    /* Pointer ops */
-    } else if (kind == BODY_OP_PTR_CONST) {
-        x64_mov_r64_imm64(x, 0, (uint64_t)(int32_t)a);
-        x64_mov_mr64_r64(x, 4, off_dst, 0);
-    } else if (kind == BODY_OP_PTR_LOAD_I32) {
-        x64_mov_r64_mr64(x, 0, 4, body->slot_offset[a]);
-        x64_mov_r32_mr32_base(x, 0, 0);
-        x64_mov_mr32_r32(x, 4, off_dst, 0);
-    } else if (kind == BODY_OP_PTR_LOAD_U8) {
-        x64_mov_r64_mr64(x, 0, 4, body->slot_offset[a]);
-        x64_movzb_r32_mr8(x, 0, 0);
-        x64_mov_mr32_r32(x, 4, off_dst, 0);
-    } else if (kind == BODY_OP_PTR_LOAD_U16) {
-        x64_mov_r64_mr64(x, 0, 4, body->slot_offset[a]);
-        x64_movzw_r32_mr16(x, 0, 0);
-        x64_mov_mr32_r32(x, 4, off_dst, 0);
-    } else if (kind == BODY_OP_PTR_STORE_I32) {
-        x64_mov_r64_mr64(x, 0, 4, body->slot_offset[dst]);
-        x64_mov_r32_mr32(x, 1, 4, body->slot_offset[a]);
-        x64_mov_mr32_base_r32(x, 0, 1);
-    } else if (kind == BODY_OP_PTR_STORE_U8) {
-        x64_mov_r64_mr64(x, 0, 4, body->slot_offset[dst]);
-        x64_mov_r32_mr32(x, 1, 4, body->slot_offset[a]);
-        x64_mov_mr8_r8(x, 0, 1);
-    } else if (kind == BODY_OP_PTR_STORE_U16) {
-        x64_mov_r64_mr64(x, 0, 4, body->slot_offset[dst]);
-        x64_mov_r32_mr32(x, 1, 4, body->slot_offset[a]);
-        x64_mov_mr16_r16(x, 0, 1);
-    } else if (kind == BODY_OP_PTR_LOAD_I64) {
-        x64_mov_r64_mr64(x, 0, 4, body->slot_offset[a]);
-        x64_mov_r64_mr64_base(x, 0, 0);
-        x64_mov_mr64_r64(x, 4, off_dst, 0);
-    } else if (kind == BODY_OP_PTR_STORE_I64) {
-        x64_mov_r64_mr64(x, 0, 4, body->slot_offset[dst]);
-        x64_mov_r64_mr64(x, 1, 4, body->slot_offset[a]);
-        x64_mov_mr64_base_r64(x, 0, 1);
     /* Slot store */
     } else if (kind == BODY_OP_SLOT_STORE_I32) {
         x64_mov_r32_mr32(x, 0, 4, body->slot_offset[a]);
@@ -12427,6 +14662,11 @@ static void x64_codegen_op(X64Code *x, BodyIR *body, Symbols *symbols,
         x64_mov_mr32_r32(x, 4, off_dst, 1);                 /* store new value */
     /* Syscall-based ops (macOS x86_64: syscall in RAX, args RDI/RSI/RDX/R10/R8/R9) */
     } else if (kind == BODY_OP_EXIT) {
+        if (cold_profile.flush_pos >= 0) {
+            x64_emit1(x, 0xE8);
+            function_patches_add_kind(patches, x->len, -1, FUNCTION_PATCH_PROFILE_FLUSH);
+            x64_emit4(x, 0);
+        }
         x64_mov_r32_mr32(x, 0, 4, body->slot_offset[a]);
         x64_mov_r32_r32(x, 0, 0); /* ARG1 = exit code */
         x64_mov_r32_imm32(x, 0, 0x2000001); /* RAX = sys_exit */
@@ -12514,16 +14754,6 @@ static void x64_codegen_op(X64Code *x, BodyIR *body, Symbols *symbols,
         x64_syscall(x);
         x64_mov_mr32_r32(x, 4, off_dst, 0);
     /* Pointer add: ptr + offset (sign-extend i32 offset to 64-bit) */
-    } else if (kind == BODY_OP_PTR_ADD) {
-        x64_mov_r64_mr64(x, 0, 4, body->slot_offset[a]);
-        if (body->slot_kind[b] == SLOT_I32) {
-            x64_mov_r32_mr32(x, 1, 4, body->slot_offset[b]);
-            x64_movsxd_r64_r32(x, 1, 1);
-        } else {
-            x64_mov_r64_mr64(x, 1, 4, body->slot_offset[b]);
-        }
-        x64_add_r64_r64(x, 0, 1);
-        x64_mov_mr64_r64(x, 4, off_dst, 0);
     /* Seq i32 index: load element at byte offset b from seq data ptr */
     } else if (kind == BODY_OP_SEQ_I32_INDEX) {
         x64_mov_r64_mr64(x, 0, 4, body->slot_offset[a] + 8); /* rax = data ptr from seq+8 */
@@ -12771,18 +15001,20 @@ static void x64_codegen_op(X64Code *x, BodyIR *body, Symbols *symbols,
         /* Get pointer to element in opaque seq: a=seq, b=index, c=element_size */
         x64_mov_r64_mr64(x, 0, 4, body->slot_offset[a] + 8);   /* rax = data ptr from seq+8 */
         x64_mov_r32_mr32(x, 1, 4, body->slot_offset[b]);       /* ecx = index */
-        x64_test_r32_r32(x, 1, 1);
-        int32_t soi_ge = x->len;
-        x64_jcc_rel8(x, CC_GE, 0);                               /* if index >= 0, ok */
-        x64_int3(x);                                              /* trap neg index */
-        x->buf[soi_ge + 1] = (uint8_t)(x->len - (soi_ge + 2));
-        /* Compare index against seq cap (stored at seq+0 as I32) */
-        x64_mov_r32_mr32(x, 2, 4, body->slot_offset[a]);       /* edx = seq cap */
-        x64_cmp_r32_r32(x, 1, 2);                                 /* index vs cap => cap - index */
-        int32_t soi_lt = x->len;
-        x64_jcc_rel8(x, CC_A, 0);                                 /* if cap > index (index < cap), ok */
-        x64_int3(x);                                              /* trap OOB */
-        x->buf[soi_lt + 1] = (uint8_t)(x->len - (soi_lt + 2));
+        if (!cold_op_bounds_proven(body, op)) {
+            x64_test_r32_r32(x, 1, 1);
+            int32_t soi_ge = x->len;
+            x64_jcc_rel8(x, CC_GE, 0);                           /* if index >= 0, ok */
+            x64_int3(x);                                          /* trap neg index */
+            x->buf[soi_ge + 1] = (uint8_t)(x->len - (soi_ge + 2));
+            /* Compare index against seq cap (stored at seq+0 as I32) */
+            x64_mov_r32_mr32(x, 2, 4, body->slot_offset[a]);   /* edx = seq cap */
+            x64_cmp_r32_r32(x, 1, 2);                             /* index vs cap => cap - index */
+            int32_t soi_lt = x->len;
+            x64_jcc_rel8(x, CC_A, 0);                             /* if cap > index (index < cap), ok */
+            x64_int3(x);                                          /* trap OOB */
+            x->buf[soi_lt + 1] = (uint8_t)(x->len - (soi_lt + 2));
+        }
         /* element_ptr = data + index * element_size */
         int32_t es = c > 0 ? c : 1;
         x64_movsxd_r64_r32(x, 1, 1);                              /* sign-extend index to 64-bit */
@@ -13140,78 +15372,1140 @@ static void x64_codegen_op(X64Code *x, BodyIR *body, Symbols *symbols,
             x64_mov_mr64_r64(x, 4, off_dst, 1);
             x64_mov_mr32_r32(x, 4, off_dst + 8, 2);
         } else {
-            x64_mov_r64_mr64(x, 1, 4, body->slot_offset[b]);
-            x64_mov_r32_mr32(x, 2, 4, body->slot_offset[b] + 8);
-            x64_mov_mr64_r64(x, 4, off_dst, 1);
-            x64_mov_mr32_r32(x, 4, off_dst + 8, 2);
+            x64_mov_r64_mr64(x, 1, 4, body->slot_offset[b]);
+            x64_mov_r32_mr32(x, 2, 4, body->slot_offset[b] + 8);
+            x64_mov_mr64_r64(x, 4, off_dst, 1);
+            x64_mov_mr32_r32(x, 4, off_dst + 8, 2);
+        }
+    } else if (kind == BODY_OP_PATH_READ_TEXT) {
+        /* Stub: return empty string */
+        x64_xor_r64_r64(x, 0, 0);
+        x64_mov_mr64_r64(x, 4, off_dst, 0);
+        x64_mov_mr32_imm32(x, 4, off_dst + 8, 0);
+    } else if (kind == BODY_OP_PATH_WRITE_TEXT) {
+        /* Stub: return 0 (failure) */
+        x64_xor_r32_r32(x, 0, 0);
+        x64_mov_mr32_r32(x, 4, off_dst, 0);
+    } else if (kind == BODY_OP_COLD_SELF_EXEC) {
+        /* Stub: return -1 (exec failure) */
+        x64_mov_r32_imm32(x, 0, -1);
+        x64_mov_mr32_r32(x, 4, off_dst, 0);
+    } else if (kind == BODY_OP_EXEC_SHELL) {
+        /* Stub: return -1 (exec failure) */
+        x64_mov_r32_imm32(x, 0, -1);
+        x64_mov_mr32_r32(x, 4, off_dst, 0);
+    } else if (kind == BODY_OP_PATH_WRITE_BYTES) {
+        /* Stub: return 0 (failure) */
+        x64_xor_r32_r32(x, 0, 0);
+        x64_mov_mr32_r32(x, 4, off_dst, 0);
+    } else {
+        fprintf(stderr, "cheng_cold: unknown x86_64 BodyIR op kind=%d\n", kind);
+        die("unknown x86_64 BodyIR op");
+    }
+}
+
+/* Pack X64Code bytes into uint32_t words. Returns word count. */
+static int32_t x64_pack_words(X64Code *x, uint32_t *words, int32_t max_words) {
+    int32_t wc = 0;
+    for (int32_t i = 0; i < x->len && wc < max_words; i += 4) {
+        uint32_t w = 0;
+        for (int32_t j = 0; j < 4 && i + j < x->len; j++)
+            w |= ((uint32_t)x->buf[i + j]) << (j * 8);
+        words[wc++] = w;
+    }
+    return wc;
+}
+
+/* x86_64 function compilation wrapper */
+static void x64_codegen_func_emit(X64Code *x, BodyIR *body, Symbols *symbols,
+                                   FunctionPatchList *patches);
+
+/* Traced entry point: one "codegen" span per function body. */
+static void x64_codegen_func(X64Code *x, BodyIR *body, Symbols *symbols,
+                              FunctionPatchList *patches) {
+    uint64_t trace_start = cold_trace_begin();
+    x64_codegen_func_emit(x, body, symbols, patches);
+    cold_trace_end("codegen", body->debug_name, trace_start);
+}
+
+static void x64_codegen_func_emit(X64Code *x, BodyIR *body, Symbols *symbols,
+                                   FunctionPatchList *patches) {
+    static const int32_t pool[5] = {X64_R10, X64_R11, X64_RBX, X64_R14, X64_R15};
+    static const int32_t callee_saved[3] = {X64_RBX, X64_R14, X64_R15};
+    static const ColdRaTarget target = {pool, 5, 3, callee_saved, 3, X64_ARG_STACK, false};
+    cold_profile_layout_blocks(body);
+    cold_eliminate_bounds_checks(body);
+    ColdRegAlloc ra;
+    cold_regalloc(body, symbols, &target, &ra);
+    /* rsp stays 16-byte aligned at calls */
+    ra.frame = align_i32(ra.frame, 16) + ((ra.saved_count & 1) ? 8 : 0);
+    int32_t block_count = body->block_count;
+    int32_t *block_pos = malloc((size_t)(block_count > 0 ? block_count : 1) * sizeof(int32_t));
+    if (!block_pos) die("out of memory");
+    for (int32_t bi = 0; bi < block_count; bi++) block_pos[bi] = -1;
+    X64BlockPatches jumps = {0};
+    bool falls_off_end = true;
+
+    x64_codegen_prologue(x, body, &ra);
+    for (int32_t bi = 0; bi < block_count; bi++) {
+        block_pos[bi] = x->len;
+        ra.acc_slot = -1;
+        if (body->profile_counters >= 0) cold_profile_emit_count_x64(x, body, patches, bi);
+        int32_t bs = body->block_op_start[bi];
+        int32_t be = bs + body->block_op_count[bi];
+        int32_t fused = cold_fused_compare(&ra, body, bi);
+        for (int32_t oi = bs; oi < be; oi++) {
+            if (oi == fused || x64_lower_op(x, &ra, body, symbols, patches, oi)) continue;
+            x64_codegen_op(x, body, symbols, patches, oi);
+            ra.acc_slot = -1;
+        }
+
+        int32_t next = bi + 1 < block_count ? bi + 1 : -1;
+        int32_t term = body->block_term[bi];
+        falls_off_end = true;
+        if (term < 0 || term >= body->term_count) continue;
+        int32_t kind = body->term_kind[term];
+        falls_off_end = false;
+        if (kind == BODY_TERM_RET) {
+            x64_codegen_return(x, &ra, body, term);
+        } else if (kind == BODY_TERM_BR) {
+            int32_t target = body->term_true_block[term];
+            if (target != next || next < 0)
+                x64_jump_block(x, &jumps, block_pos, block_count, target, -1);
+        } else if (kind == BODY_TERM_CBR) {
+            int32_t on_true = body->term_true_block[term];
+            int32_t on_false = body->term_false_block[term];
+            int cc;
+            if (fused >= 0) {
+                cc = x64_ra_compare(x, &ra, body, body->op_a[fused], body->op_b[fused],
+                                    body->op_kind[fused] == BODY_OP_I64_CMP ? 8 : 4,
+                                    x64_cc_from_cond(body->op_c[fused], false));
+                if (body->term_case_start[term] == COND_EQ) cc ^= 1;
+            } else {
+                cc = x64_ra_compare(x, &ra, body, body->term_value[term],
+                                    body->term_case_count[term], 4,
+                                    x64_cc_from_cond(body->term_case_start[term], false));
+            }
+            if (on_true == next && next >= 0) {
+                x64_jump_block(x, &jumps, block_pos, block_count, on_false, cc ^ 1);
+            } else {
+                x64_jump_block(x, &jumps, block_pos, block_count, on_true, cc);
+                if (on_false != next || next < 0)
+                    x64_jump_block(x, &jumps, block_pos, block_count, on_false, -1);
+            }
+        } else if (kind == BODY_TERM_SWITCH) {
+            x64_codegen_switch(x, &ra, body, &jumps, block_pos, term);
+            falls_off_end = true;
+        } else {
+            /* Unknown terminator: return 0 */
+            x64_mov_ri(x, X64_RAX, 0, false);
+            x64_codegen_epilogue(x, &ra);
+        }
+    }
+    /* Jumps past the last block and a last block without a return leave
+       through one shared epilogue. */
+    int32_t end_pos = x->len;
+    bool needs_exit = falls_off_end;
+    for (int32_t i = 0; i < jumps.count; i++)
+        if (jumps.items[i].block < 0 || jumps.items[i].block >= block_count) needs_exit = true;
+    if (needs_exit) x64_codegen_epilogue(x, &ra);
+
+    uint64_t patch_start = cold_trace_begin();
+    for (int32_t i = 0; i < jumps.count; i++) {
+        int32_t target = jumps.items[i].block;
+        x64_patch_jmp_rel32(x, jumps.items[i].pos,
+                            target >= 0 && target < block_count ? block_pos[target] : end_pos);
+    }
+    cold_trace_end_items("patch", body->debug_name, patch_start, jumps.count);
+    free(jumps.items);
+    free(block_pos);
+    cold_regalloc_free(&ra);
+    cold_release_bounds_checks(body);
+}
+
+/* ---- RISC-V 64 codegen (fixed 32-bit words, reuses Code struct) ----
+   Frame slots are addressed off sp; t0-t2 are the working registers of the
+   op handlers, t6 reaches frame slots past the 12-bit displacement. Handlers
+   may clobber t0-t6, a0-a7 and f0-f1; s0/s1 keep argc/argv from the entry
+   trampoline. */
+
+/* Zba (sh*add) and Zbb (orc.b, ctz, orn) forms and the RVC re-layout of the
+   linked text, chosen by --riscv-features:. */
+static bool rv64_use_zba = false;
+static bool rv64_use_zbb = false;
+static bool rv64_use_rvc = true;
+
+/* rv64gc (default), rv64g (no compressed forms), zba, zbb, all, or a comma list */
+static bool rv64_parse_features(const char *spec) {
+    if (!spec || !spec[0]) return true;
+    bool zba = false, zbb = false, rvc = true;
+    const char *p = spec;
+    while (*p) {
+        const char *e = strchr(p, ',');
+        size_t n = e ? (size_t)(e - p) : strlen(p);
+        if (n == 3 && memcmp(p, "all", 3) == 0) { zba = true; zbb = true; }
+        else if (n == 3 && memcmp(p, "zba", 3) == 0) zba = true;
+        else if (n == 3 && memcmp(p, "zbb", 3) == 0) zbb = true;
+        else if (n == 5 && memcmp(p, "rv64g", 5) == 0) rvc = false;
+        else if (!(n == 6 && memcmp(p, "rv64gc", 6) == 0)) return false;
+        p += n;
+        if (*p == ',') p++;
+    }
+    rv64_use_zba = zba;
+    rv64_use_zbb = zbb;
+    rv64_use_rvc = rvc;
+    return true;
+}
+
+static void rv64_li(Code *code, int rd, int64_t value) {
+    uint32_t words[16];
+    int count = 0;
+    rv_li64(words, &count, rd, (uint64_t)value);
+    for (int i = 0; i < count; i++) code_emit(code, words[i]);
+}
+
+typedef uint32_t (*Rv64MemOp)(int reg, int base, int16_t off);
+
+/* Load or store reg at sp + off; far offsets go through t6. */
+static void rv64_sp_mem(Code *code, Rv64MemOp op, int reg, int32_t off) {
+    if (off >= -2048 && off <= 2047) {
+        code_emit(code, op(reg, RV_SP, (int16_t)off));
+        return;
+    }
+    int32_t upper = (int32_t)(((uint32_t)off + 0x800u) & 0xFFFFF000u);
+    code_emit(code, rv_lui(RV_T6, upper));
+    code_emit(code, rv_add(RV_T6, RV_T6, RV_SP));
+    code_emit(code, op(reg, RV_T6, (int16_t)(off - upper)));
+}
+
+/* rd = rs + off */
+static void rv64_addi_large(Code *code, int rd, int rs, int32_t off) {
+    if (off == 0 && rd == rs) return;
+    if (off >= -2048 && off <= 2047) {
+        code_emit(code, rv_addi(rd, rs, (int16_t)off));
+        return;
+    }
+    rv64_li(code, RV_T6, off);
+    code_emit(code, rv_add(rd, rs, RV_T6));
+}
+
+/* Points the branch or jal at pos to the word at target. */
+static void rv64_patch(Code *code, int32_t pos, int32_t target) {
+    int32_t off = (target - pos) * 4;
+    uint32_t ins = code->words[pos];
+    if (rv_is_jal(ins) ? (off < -(1 << 20) || off >= (1 << 20)) : (off < -4096 || off > 4094))
+        die("RV64 branch target out of range");
+    code->words[pos] = rv_with_offset(ins, off);
+}
+
+/* ebreak unless idx < len (unsigned, so negative indexes trap too) */
+static void rv64_bounds_trap(Code *code, int idx, int len) {
+    code_emit(code, rv_bltu(idx, len, 8));
+    code_emit(code, rv_ebreak());
+}
+
+/* a0 = mmap(0, a1, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0) */
+static void rv64_mmap_a1(Code *code) {
+    code_emit(code, rv_addi(RV_A0, RV_ZERO, 0));
+    code_emit(code, rv_addi(RV_A2, RV_ZERO, 3));
+    code_emit(code, rv_addi(RV_A3, RV_ZERO, 0x22));
+    code_emit(code, rv_addi(RV_A4, RV_ZERO, -1));
+    code_emit(code, rv_addi(RV_A5, RV_ZERO, 0));
+    code_emit(code, rv_addi(RV_A7, RV_ZERO, 222));
+    code_emit(code, rv_ecall());
+}
+
+/* rp, rl = data pointer and length of a str slot, through a STR_REF */
+static void rv64_load_str(Code *code, BodyIR *body, int32_t slot, int rp, int rl) {
+    if (body->slot_kind[slot] == SLOT_STR_REF) {
+        rv64_sp_mem(code, rv_ld, rl, body->slot_offset[slot]);
+        code_emit(code, rv_ld(rp, rl, COLD_STR_DATA_OFFSET));
+        code_emit(code, rv_lw(rl, rl, COLD_STR_LEN_OFFSET));
+        return;
+    }
+    rv64_sp_mem(code, rv_ld, rp, body->slot_offset[slot] + COLD_STR_DATA_OFFSET);
+    rv64_sp_mem(code, rv_lw, rl, body->slot_offset[slot] + COLD_STR_LEN_OFFSET);
+}
+
+/* Fresh str at sp + off: no store id, no flags. */
+static void rv64_store_str(Code *code, int32_t off, int rp, int rl) {
+    rv64_sp_mem(code, rv_sd, rp, off + COLD_STR_DATA_OFFSET);
+    rv64_sp_mem(code, rv_sw, rl, off + COLD_STR_LEN_OFFSET);
+    rv64_sp_mem(code, rv_sw, RV_ZERO, off + COLD_STR_STORE_ID_OFFSET);
+    rv64_sp_mem(code, rv_sd, RV_ZERO, off + COLD_STR_FLAGS_OFFSET);
+}
+
+static void rv64_copy_stack_slot(Code *code, BodyIR *body, int32_t dst, int32_t src) {
+    int32_t size = body->slot_size[dst] < body->slot_size[src] ? body->slot_size[dst]
+                                                                 : body->slot_size[src];
+    int32_t off = 0;
+    for (; off + 8 <= size; off += 8) {
+        rv64_sp_mem(code, rv_ld, RV_T0, body->slot_offset[src] + off);
+        rv64_sp_mem(code, rv_sd, RV_T0, body->slot_offset[dst] + off);
+    }
+    if (off + 4 <= size) {
+        rv64_sp_mem(code, rv_lw, RV_T0, body->slot_offset[src] + off);
+        rv64_sp_mem(code, rv_sw, RV_T0, body->slot_offset[dst] + off);
+    }
+}
+
+static void rv64_zero_slot(Code *code, BodyIR *body, int32_t slot) {
+    for (int32_t off = 0; off < body->slot_size[slot]; off += 8)
+        rv64_sp_mem(code, rv_sd, RV_ZERO, body->slot_offset[slot] + off);
+}
+
+static bool rv64_slot_is_pointer(int32_t kind) {
+    return kind == SLOT_OBJECT_REF || kind == SLOT_SEQ_I32_REF ||
+           kind == SLOT_SEQ_STR_REF || kind == SLOT_SEQ_OPAQUE_REF ||
+           kind == SLOT_STR_REF || kind == SLOT_PTR ||
+           kind == SLOT_I32_REF || kind == SLOT_I64_REF || kind == SLOT_OPAQUE_REF;
+}
+
+/* dst = field at src_offset of src, read through src when it is a pointer
+   (a null pointer yields a zeroed dst). */
+static void rv64_copy_slot_from_offset(Code *code, BodyIR *body, int32_t dst,
+                                       int32_t src, int32_t src_offset) {
+    bool wide = body->slot_kind[dst] != SLOT_I32;
+    int32_t total = wide ? body->slot_size[dst] : 4;
+    if (!rv64_slot_is_pointer(body->slot_kind[src])) {
+        for (int32_t off = 0; off < total; off += 8) {
+            rv64_sp_mem(code, wide ? rv_ld : rv_lw, RV_T0, body->slot_offset[src] + src_offset + off);
+            rv64_sp_mem(code, wide ? rv_sd : rv_sw, RV_T0, body->slot_offset[dst] + off);
+        }
+        return;
+    }
+    rv64_sp_mem(code, rv_ld, RV_T2, body->slot_offset[src]);
+    int32_t null_jump = code->count;
+    code_emit(code, rv_beq(RV_T2, RV_ZERO, 0));
+    rv64_addi_large(code, RV_T2, RV_T2, src_offset);
+    for (int32_t off = 0; off < total; off += 8) {
+        code_emit(code, wide ? rv_ld(RV_T0, RV_T2, (int16_t)off) : rv_lw(RV_T0, RV_T2, 0));
+        rv64_sp_mem(code, wide ? rv_sd : rv_sw, RV_T0, body->slot_offset[dst] + off);
+    }
+    int32_t done_jump = code->count;
+    code_emit(code, rv_jal(RV_ZERO, 0));
+    rv64_patch(code, null_jump, code->count);
+    rv64_zero_slot(code, body, dst);
+    if (!wide) rv64_sp_mem(code, rv_sw, RV_ZERO, body->slot_offset[dst]);
+    rv64_patch(code, done_jump, code->count);
+}
+
+/* Field at dst_offset of dst = src; pointer destinations are written through. */
+static void rv64_store_slot_to_payload(Code *code, BodyIR *body, int32_t dst,
+                                       int32_t dst_offset, int32_t src) {
+    int32_t src_kind = body->slot_kind[src];
+    bool wide = src_kind != SLOT_I32;
+    int32_t total = src_kind == SLOT_I32 ? 4 : src_kind == SLOT_I64 ? 8 : body->slot_size[src];
+    bool through = body->slot_kind[dst] != SLOT_OBJECT && rv64_slot_is_pointer(body->slot_kind[dst]);
+    if (through) {
+        rv64_sp_mem(code, rv_ld, RV_T2, body->slot_offset[dst]);
+        rv64_addi_large(code, RV_T2, RV_T2, dst_offset);
+    }
+    for (int32_t off = 0; off < total; off += 8) {
+        rv64_sp_mem(code, wide ? rv_ld : rv_lw, RV_T1, body->slot_offset[src] + off);
+        if (through)
+            code_emit(code, wide ? rv_sd(RV_T1, RV_T2, (int16_t)off) : rv_sw(RV_T1, RV_T2, 0));
+        else
+            rv64_sp_mem(code, wide ? rv_sd : rv_sw, RV_T1, body->slot_offset[dst] + dst_offset + off);
+    }
+}
+
+/* Spills a0 after a call whose callee returned a scalar. */
+static void rv64_store_call_result(Code *code, BodyIR *body, int32_t dst) {
+    if (dst < 0 || dst >= body->slot_count) return;
+    rv64_sp_mem(code, cold_scalar_bytes(body->slot_kind[dst]) == 8 ? rv_sd : rv_sw,
+                RV_A0, body->slot_offset[dst]);
+}
+
+/* rd = base + idx * size; t6 is scratch. */
+static void rv64_scaled_add(Code *code, int rd, int base, int idx, int32_t size) {
+    if (rv64_use_zba) {
+        if (size == 2) { code_emit(code, rv_sh1add(rd, idx, base)); return; }
+        if (size == 4) { code_emit(code, rv_sh2add(rd, idx, base)); return; }
+        if (size == 8) { code_emit(code, rv_sh3add(rd, idx, base)); return; }
+        if (size == 12 || size == 24) {
+            code_emit(code, rv_sh1add(RV_T6, idx, idx));
+            code_emit(code, size == 24 ? rv_sh3add(rd, RV_T6, base) : rv_sh2add(rd, RV_T6, base));
+            return;
+        }
+    }
+    if (size == 1) {
+        code_emit(code, rv_add(rd, base, idx));
+        return;
+    }
+    if (size > 0 && (size & (size - 1)) == 0) {
+        int shift = 0;
+        while ((1 << shift) < size) shift++;
+        code_emit(code, rv_slli(RV_T6, idx, shift));
+    } else {
+        rv64_li(code, RV_T6, size);
+        code_emit(code, rv_mul(RV_T6, idx, RV_T6));
+    }
+    code_emit(code, rv_add(rd, base, RV_T6));
+}
+
+/* reg = address of the seq header a slot holds inline or points to */
+static void rv64_seq_header_addr(Code *code, BodyIR *body, int32_t slot, int reg) {
+    int32_t kind = body->slot_kind[slot];
+    if (kind == SLOT_SEQ_I32_REF || kind == SLOT_SEQ_STR_REF || kind == SLOT_SEQ_OPAQUE_REF ||
+        kind == SLOT_OBJECT_REF || kind == SLOT_PTR)
+        rv64_sp_mem(code, rv_ld, reg, body->slot_offset[slot]);
+    else
+        rv64_addi_large(code, reg, RV_SP, body->slot_offset[slot]);
+}
+
+/* rl = strlen(rp); clobbers t2-t6, rl may be t2. With Zbb the scan reads
+   aligned doublewords (never crossing a page past the terminator) and finds
+   the zero byte with orc.b/ctz; the bytes before rp are forced non-zero. */
+static void rv64_strlen(Code *code, int rp, int rl) {
+    if (rv64_use_zbb) {
+        code_emit(code, rv_andi(RV_T2, rp, -8));
+        code_emit(code, rv_ld(RV_T3, RV_T2, 0));
+        code_emit(code, rv_andi(RV_T4, rp, 7));
+        code_emit(code, rv_slli(RV_T4, RV_T4, 3));
+        code_emit(code, rv_addi(RV_T5, RV_ZERO, -1));
+        code_emit(code, rv_sll(RV_T5, RV_T5, RV_T4));
+        code_emit(code, rv_orn(RV_T3, RV_T3, RV_T5));
+        int32_t loop = code->count;
+        code_emit(code, rv_orc_b(RV_T4, RV_T3));
+        code_emit(code, rv_xori(RV_T4, RV_T4, -1));
+        code_emit(code, rv_bne(RV_T4, RV_ZERO, 16));
+        code_emit(code, rv_addi(RV_T2, RV_T2, 8));
+        code_emit(code, rv_ld(RV_T3, RV_T2, 0));
+        code_emit(code, rv_jal(RV_ZERO, (loop - code->count) * 4));
+        code_emit(code, rv_ctz(RV_T4, RV_T4));
+        code_emit(code, rv_srli(RV_T4, RV_T4, 3));
+        code_emit(code, rv_add(RV_T2, RV_T2, RV_T4));
+        code_emit(code, rv_sub(rl, RV_T2, rp));
+        return;
+    }
+    code_emit(code, rv_addi(RV_T3, rp, 0));
+    int32_t loop = code->count;
+    code_emit(code, rv_lbu(RV_T4, RV_T3, 0));
+    code_emit(code, rv_beq(RV_T4, RV_ZERO, 12));
+    code_emit(code, rv_addi(RV_T3, RV_T3, 1));
+    code_emit(code, rv_jal(RV_ZERO, (loop - code->count) * 4));
+    code_emit(code, rv_sub(rl, RV_T3, rp));
+}
+
+/* memcpy(dst, src, len) a byte at a time; advances dst and src, clobbers t6. */
+static void rv64_copy_bytes(Code *code, int dst, int src, int len) {
+    int32_t loop = code->count;
+    code_emit(code, rv_bge(RV_ZERO, len, 28));
+    code_emit(code, rv_lbu(RV_T6, src, 0));
+    code_emit(code, rv_sb(RV_T6, dst, 0));
+    code_emit(code, rv_addi(src, src, 1));
+    code_emit(code, rv_addi(dst, dst, 1));
+    code_emit(code, rv_addi(len, len, -1));
+    code_emit(code, rv_jal(RV_ZERO, (loop - code->count) * 4));
+}
+
+/* Moves the seq whose header is at t0 into a fresh zeroed mapping of t2
+   elements, copying the t1 live ones; keeps t0 and t1. */
+static void rv64_seq_grow(Code *code, int32_t size) {
+    code_emit(code, rv_sw(RV_T2, RV_T0, 4));
+    rv64_li(code, RV_T6, size);
+    code_emit(code, rv_mul(RV_A1, RV_T2, RV_T6));
+    rv64_mmap_a1(code);
+    code_emit(code, rv_bge(RV_A0, RV_ZERO, 8));
+    code_emit(code, rv_ebreak());
+    code_emit(code, rv_mul(RV_T4, RV_T1, RV_T6));
+    code_emit(code, rv_ld(RV_T3, RV_T0, 8));
+    code_emit(code, rv_addi(RV_T5, RV_A0, 0));
+    code_emit(code, rv_beq(RV_T3, RV_ZERO, 32));
+    rv64_copy_bytes(code, RV_T5, RV_T3, RV_T4);
+    code_emit(code, rv_sd(RV_A0, RV_T0, 8));
+}
+
+/* t3 = address of a new last element of seq (t0 = header, t1 = old len);
+   the caller fills it in and calls rv64_seq_append_done. */
+static void rv64_seq_append(Code *code, BodyIR *body, int32_t seq, int32_t size) {
+    rv64_seq_header_addr(code, body, seq, RV_T0);
+    code_emit(code, rv_lw(RV_T1, RV_T0, 0));
+    code_emit(code, rv_lw(RV_T2, RV_T0, 4));
+    int32_t has_room = code->count;
+    code_emit(code, rv_blt(RV_T1, RV_T2, 0));
+    /* capacity doubles from 4 */
+    code_emit(code, rv_slliw(RV_T2, RV_T2, 1));
+    code_emit(code, rv_bne(RV_T2, RV_ZERO, 8));
+    code_emit(code, rv_addi(RV_T2, RV_ZERO, 4));
+    rv64_seq_grow(code, size);
+    rv64_patch(code, has_room, code->count);
+    code_emit(code, rv_ld(RV_T3, RV_T0, 8));
+    rv64_scaled_add(code, RV_T3, RV_T3, RV_T1, size);
+}
+
+static void rv64_seq_append_done(Code *code) {
+    code_emit(code, rv_addiw(RV_T1, RV_T1, 1));
+    code_emit(code, rv_sw(RV_T1, RV_T0, 0));
+}
+
+/* t3 = address of element index_slot of seq, bounds-checked; t0 = header,
+   t1 = index, t2 = len. */
+static void rv64_seq_elem_addr(Code *code, BodyIR *body, int32_t seq, int32_t index_slot,
+                               int32_t size, bool checked) {
+    rv64_seq_header_addr(code, body, seq, RV_T0);
+    rv64_sp_mem(code, rv_lw, RV_T1, body->slot_offset[index_slot]);
+    if (checked) {
+        code_emit(code, rv_lw(RV_T2, RV_T0, 0));
+        rv64_bounds_trap(code, RV_T1, RV_T2);
+    }
+    code_emit(code, rv_ld(RV_T3, RV_T0, 8));
+    rv64_scaled_add(code, RV_T3, RV_T3, RV_T1, size);
+}
+
+/* reg = where the bytes of slot live (the pointer a ref slot holds) */
+static void rv64_slot_data_addr(Code *code, BodyIR *body, int32_t slot, int reg) {
+    if (rv64_slot_is_pointer(body->slot_kind[slot]))
+        rv64_sp_mem(code, rv_ld, reg, body->slot_offset[slot]);
+    else
+        rv64_addi_large(code, reg, RV_SP, body->slot_offset[slot]);
+}
+
+/* setLen: grows to max(len, 4) elements when len exceeds the capacity (or
+   the buffer is missing), zeroes elements a longer length exposes. */
+static void rv64_seq_set_len(Code *code, BodyIR *body, int32_t seq, int32_t len_slot,
+                             int32_t size) {
+    if (size <= 0) die("seq setLen element size must be positive");
+    rv64_seq_header_addr(code, body, seq, RV_T0);
+    rv64_sp_mem(code, rv_lw, RV_T2, body->slot_offset[len_slot]);
+    code_emit(code, rv_bge(RV_T2, RV_ZERO, 8));
+    code_emit(code, rv_addi(RV_T2, RV_ZERO, 0));
+    code_emit(code, rv_lw(RV_T1, RV_T0, 0));
+    code_emit(code, rv_lw(RV_T3, RV_T0, 4));
+    int32_t over_cap = code->count;
+    code_emit(code, rv_blt(RV_T3, RV_T2, 0));
+    int32_t zero_len = code->count;
+    code_emit(code, rv_beq(RV_T2, RV_ZERO, 0));
+    code_emit(code, rv_ld(RV_T3, RV_T0, 8));
+    int32_t has_buffer = code->count;
+    code_emit(code, rv_bne(RV_T3, RV_ZERO, 0));
+    rv64_patch(code, over_cap, code->count);
+    code_emit(code, rv_addi(RV_T6, RV_ZERO, 4));
+    code_emit(code, rv_bge(RV_T2, RV_T6, 8));
+    code_emit(code, rv_addi(RV_T2, RV_ZERO, 4));
+    rv64_seq_grow(code, size);
+    rv64_patch(code, zero_len, code->count);
+    rv64_patch(code, has_buffer, code->count);
+    rv64_sp_mem(code, rv_lw, RV_T2, body->slot_offset[len_slot]);
+    code_emit(code, rv_bge(RV_T2, RV_ZERO, 8));
+    code_emit(code, rv_addi(RV_T2, RV_ZERO, 0));
+    code_emit(code, rv_sw(RV_T2, RV_T0, 0));
+    /* zero [old len, len) */
+    int32_t shrink = code->count;
+    code_emit(code, rv_bge(RV_T1, RV_T2, 0));
+    code_emit(code, rv_ld(RV_T3, RV_T0, 8));
+    rv64_li(code, RV_T6, size);
+    code_emit(code, rv_mul(RV_T4, RV_T1, RV_T6));
+    code_emit(code, rv_mul(RV_T5, RV_T2, RV_T6));
+    code_emit(code, rv_add(RV_T4, RV_T3, RV_T4));
+    code_emit(code, rv_add(RV_T5, RV_T3, RV_T5));
+    code_emit(code, rv_bgeu(RV_T4, RV_T5, 16));
+    code_emit(code, rv_sb(RV_ZERO, RV_T4, 0));
+    code_emit(code, rv_addi(RV_T4, RV_T4, 1));
+    code_emit(code, rv_jal(RV_ZERO, -12));
+    rv64_patch(code, shrink, code->count);
+}
+
+/* t0 = (f0 cond f1) */
+static void rv64_float_cmp(Code *code, int32_t cond, bool dbl) {
+    uint32_t (*feq)(int, int, int) = dbl ? rv_feq_d : rv_feq_s;
+    uint32_t (*flt)(int, int, int) = dbl ? rv_flt_d : rv_flt_s;
+    uint32_t (*fle)(int, int, int) = dbl ? rv_fle_d : rv_fle_s;
+    switch (cond) {
+    case COND_NE:
+        code_emit(code, feq(RV_T0, 0, 1));
+        code_emit(code, rv_xori(RV_T0, RV_T0, 1));
+        break;
+    case COND_LT: case 3: case 4: code_emit(code, flt(RV_T0, 0, 1)); break;   /* LO, MI */
+    case COND_LE: case 9: code_emit(code, fle(RV_T0, 0, 1)); break;           /* LS */
+    case COND_GT: case 8: code_emit(code, flt(RV_T0, 1, 0)); break;           /* HI */
+    case COND_GE: case 2: case 5: code_emit(code, fle(RV_T0, 1, 0)); break;   /* HS, PL */
+    default: code_emit(code, feq(RV_T0, 0, 1)); break;
+    }
+}
+
+/* Decimal text of t0 into a fresh 32-byte mapping, stored as a str at sp + off. */
+static void rv64_int_to_str(Code *code, int32_t off) {
+    code_emit(code, rv_addi(RV_T1, RV_T0, 0));
+    code_emit(code, rv_addi(RV_A1, RV_ZERO, 32));
+    rv64_mmap_a1(code);
+    code_emit(code, rv_addi(RV_T2, RV_A0, 32));
+    code_emit(code, rv_slt(RV_T5, RV_T1, RV_ZERO));
+    code_emit(code, rv_bge(RV_T1, RV_ZERO, 8));
+    code_emit(code, rv_sub(RV_T1, RV_ZERO, RV_T1));
+    code_emit(code, rv_addi(RV_T3, RV_ZERO, 10));
+    int32_t loop = code->count;
+    code_emit(code, rv_remu(RV_T4, RV_T1, RV_T3));
+    code_emit(code, rv_divu(RV_T1, RV_T1, RV_T3));
+    code_emit(code, rv_addi(RV_T4, RV_T4, '0'));
+    code_emit(code, rv_addi(RV_T2, RV_T2, -1));
+    code_emit(code, rv_sb(RV_T4, RV_T2, 0));
+    code_emit(code, rv_bne(RV_T1, RV_ZERO, (int16_t)((loop - code->count) * 4)));
+    code_emit(code, rv_beq(RV_T5, RV_ZERO, 16));
+    code_emit(code, rv_addi(RV_T4, RV_ZERO, '-'));
+    code_emit(code, rv_addi(RV_T2, RV_T2, -1));
+    code_emit(code, rv_sb(RV_T4, RV_T2, 0));
+    code_emit(code, rv_addi(RV_T1, RV_A0, 32));
+    code_emit(code, rv_sub(RV_T1, RV_T1, RV_T2));
+    rv64_store_str(code, off, RV_T2, RV_T1);
+}
+
+
+/* ---- riscv64 lowering through the register allocation ----
+   Pool: t3-t5 (free across lowered ops only), s2-s11 (saved by the
+   prologue). t0 doubles as an accumulator that remembers which frame slot it
+   last loaded or stored; t1/t2 hold the other operands. I32 values are kept
+   sign-extended in registers and computed with the *w forms. */
+
+static int rv64_ra_dst(ColdRegAlloc *ra, int32_t slot) {
+    return ra->reg[slot] >= 0 ? ra->reg[slot] : RV_T0;
+}
+
+/* Register holding slot's value at the given width: zero for a 0 constant,
+   the slot's own register, t0 when the accumulator mirrors it, else scratch
+   loaded from the frame. */
+static int rv64_ra_use(Code *code, ColdRegAlloc *ra, BodyIR *body, int32_t slot,
+                       int32_t bytes, int scratch) {
+    if (ra->is_const[slot]) {
+        int64_t v = bytes == 8 ? ra->imm[slot] : (int64_t)(int32_t)ra->imm[slot];
+        if (v == 0) return RV_ZERO;
+        rv64_li(code, scratch, v);
+        if (scratch == RV_T0) ra->acc_slot = -1;
+        return scratch;
+    }
+    bool narrows = bytes == 4 && cold_scalar_bytes(body->slot_kind[slot]) == 8;
+    int reg = ra->reg[slot];
+    if (reg < 0 && ra->acc_slot == slot && ra->acc_bytes >= bytes) reg = RV_T0;
+    if (reg >= 0) {
+        if (!narrows) return reg;
+        code_emit(code, rv_addiw(scratch, reg, 0));
+        if (scratch == RV_T0) ra->acc_slot = -1;
+        return scratch;
+    }
+    rv64_sp_mem(code, bytes == 8 ? rv_ld : rv_lw, scratch, body->slot_offset[slot] + ra->sp_bias);
+    if (scratch == RV_T0) {
+        ra->acc_slot = slot;
+        ra->acc_bytes = bytes;
+    }
+    return scratch;
+}
+
+/* slot = reg; frame slots are stored, consts and dead slots skipped. */
+static void rv64_ra_def(Code *code, ColdRegAlloc *ra, BodyIR *body, int32_t slot, int reg,
+                        int32_t bytes) {
+    if (reg == RV_T0 || ra->acc_slot == slot) ra->acc_slot = -1;
+    if (ra->reg[slot] >= 0) {
+        if (ra->reg[slot] != reg) code_emit(code, rv_addi(ra->reg[slot], reg, 0));
+        return;
+    }
+    if (ra->is_const[slot] || ra->dead[slot]) return;
+    rv64_sp_mem(code, bytes == 8 ? rv_sd : rv_sw, reg, body->slot_offset[slot]);
+    if (reg == RV_T0) {
+        ra->acc_slot = slot;
+        ra->acc_bytes = bytes;
+    }
+}
+
+static void rv64_ra_move(Code *code, ColdRegAlloc *ra, BodyIR *body, int32_t dst, int32_t src,
+                         int32_t use_bytes, int32_t def_bytes) {
+    int reg = rv64_ra_use(code, ra, body, src, use_bytes, rv64_ra_dst(ra, dst));
+    rv64_ra_def(code, ra, body, dst, reg, def_bytes);
+}
+
+static void rv64_ra_const(Code *code, ColdRegAlloc *ra, BodyIR *body, int32_t dst, int64_t value,
+                          int32_t bytes) {
+    if (ra->is_const[dst] || ra->dead[dst]) return;
+    int rd = value == 0 ? RV_ZERO : rv64_ra_dst(ra, dst);
+    if (value != 0) rv64_li(code, rd, value);
+    rv64_ra_def(code, ra, body, dst, rd, bytes);
+}
+
+enum { RV64_ALU_ADD, RV64_ALU_SUB, RV64_ALU_AND, RV64_ALU_OR, RV64_ALU_XOR, RV64_ALU_MUL,
+       RV64_ALU_DIV, RV64_ALU_REM, RV64_ALU_SLL, RV64_ALU_SRA };
+
+static uint32_t rv64_alu_rr(int alu, int rd, int rs1, int rs2, bool wide) {
+    switch (alu) {
+    case RV64_ALU_ADD: return wide ? rv_add(rd, rs1, rs2) : rv_addw(rd, rs1, rs2);
+    case RV64_ALU_SUB: return wide ? rv_sub(rd, rs1, rs2) : rv_subw(rd, rs1, rs2);
+    case RV64_ALU_AND: return rv_and(rd, rs1, rs2);
+    case RV64_ALU_OR: return rv_or(rd, rs1, rs2);
+    case RV64_ALU_XOR: return rv_xor(rd, rs1, rs2);
+    case RV64_ALU_MUL: return wide ? rv_mul(rd, rs1, rs2) : rv_mulw(rd, rs1, rs2);
+    case RV64_ALU_DIV: return wide ? rv_div(rd, rs1, rs2) : rv_divw(rd, rs1, rs2);
+    case RV64_ALU_REM: return wide ? rv_rem(rd, rs1, rs2) : rv_remw(rd, rs1, rs2);
+    case RV64_ALU_SLL: return wide ? rv_sll(rd, rs1, rs2) : rv_sllw(rd, rs1, rs2);
+    default: return wide ? rv_sra(rd, rs1, rs2) : rv_sraw(rd, rs1, rs2);
+    }
+}
+
+/* Immediate form of an ALU op (SUB arrives negated), or 0 when none. */
+static uint32_t rv64_alu_ri(int alu, int rd, int rs1, int16_t imm, bool wide) {
+    switch (alu) {
+    case RV64_ALU_ADD: case RV64_ALU_SUB:
+        return wide ? rv_addi(rd, rs1, imm) : rv_addiw(rd, rs1, imm);
+    case RV64_ALU_AND: return rv_andi(rd, rs1, imm);
+    case RV64_ALU_OR: return rv_ori(rd, rs1, imm);
+    case RV64_ALU_XOR: return rv_xori(rd, rs1, imm);
+    case RV64_ALU_SLL: return wide ? rv_slli(rd, rs1, imm) : rv_slliw(rd, rs1, imm);
+    case RV64_ALU_SRA: return wide ? rv_srai(rd, rs1, imm) : rv_sraiw(rd, rs1, imm);
+    default: return 0;
+    }
+}
+
+/* dst = a op b; a 12-bit constant b folds into the I-form. */
+static void rv64_ra_binary(Code *code, ColdRegAlloc *ra, BodyIR *body, int alu, int32_t dst,
+                           int32_t a, int32_t b, int32_t bytes) {
+    bool wide = bytes == 8;
+    bool commutes = alu == RV64_ALU_ADD || alu == RV64_ALU_AND || alu == RV64_ALU_OR ||
+                    alu == RV64_ALU_XOR || alu == RV64_ALU_MUL;
+    if (commutes && ra->is_const[a] && !ra->is_const[b]) {
+        int32_t t = a; a = b; b = t;
+    }
+    int rd = rv64_ra_dst(ra, dst);
+    if (ra->is_const[b] && alu != RV64_ALU_MUL && alu != RV64_ALU_DIV && alu != RV64_ALU_REM) {
+        int64_t imm = wide ? ra->imm[b] : (int64_t)(int32_t)ra->imm[b];
+        if (alu == RV64_ALU_SLL || alu == RV64_ALU_SRA) imm &= wide ? 63 : 31;
+        if (alu == RV64_ALU_SUB) imm = imm > -2048 && imm <= 2048 ? -imm : INT64_MAX;
+        if (imm >= -2048 && imm <= 2047) {
+            int rs = rv64_ra_use(code, ra, body, a, bytes, RV_T1);
+            code_emit(code, rv64_alu_ri(alu, rd, rs, (int16_t)imm, wide));
+            rv64_ra_def(code, ra, body, dst, rd, bytes);
+            return;
+        }
+    }
+    int rs1 = rv64_ra_use(code, ra, body, a, bytes, RV_T1);
+    int rs2 = rv64_ra_use(code, ra, body, b, alu == RV64_ALU_SLL || alu == RV64_ALU_SRA ? 4 : bytes,
+                          RV_T2);
+    code_emit(code, rv64_alu_rr(alu, rd, rs1, rs2, wide));
+    rv64_ra_def(code, ra, body, dst, rd, bytes);
+}
+
+/* rd = (x cond y) as 0/1; the unsigned forms hold for sign-extended I32 too. */
+static void rv64_setcc(Code *code, int rd, int x, int y, int32_t cond, bool wide) {
+    switch (cond) {
+    case COND_NE:
+        code_emit(code, rv_xor(rd, x, y));
+        code_emit(code, rv_sltu(rd, RV_ZERO, rd));
+        return;
+    case COND_LT: code_emit(code, rv_slt(rd, x, y)); return;
+    case COND_GT: code_emit(code, rv_slt(rd, y, x)); return;
+    case 3: code_emit(code, rv_sltu(rd, x, y)); return;    /* LO */
+    case 8: code_emit(code, rv_sltu(rd, y, x)); return;    /* HI */
+    case COND_GE: code_emit(code, rv_slt(rd, x, y)); break;
+    case COND_LE: code_emit(code, rv_slt(rd, y, x)); break;
+    case 2: code_emit(code, rv_sltu(rd, x, y)); break;     /* HS */
+    case 9: code_emit(code, rv_sltu(rd, y, x)); break;     /* LS */
+    case 4: case 5:                                         /* MI, PL */
+        code_emit(code, wide ? rv_sub(rd, x, y) : rv_subw(rd, x, y));
+        code_emit(code, rv_slt(rd, rd, RV_ZERO));
+        if (cond == 4) return;
+        break;
+    default:
+        code_emit(code, rv_xor(rd, x, y));
+        code_emit(code, rv_sltiu(rd, rd, 1));
+        return;
+    }
+    code_emit(code, rv_xori(rd, rd, 1));
+}
+
+static void rv64_ra_compare(Code *code, ColdRegAlloc *ra, BodyIR *body, int rd, int32_t a,
+                            int32_t b, int32_t bytes, int32_t cond) {
+    int x = rv64_ra_use(code, ra, body, a, bytes, RV_T1);
+    if (ra->is_const[b] && (cond == COND_LT || cond == COND_GE || cond == 3 || cond == 2)) {
+        int64_t imm = bytes == 8 ? ra->imm[b] : (int64_t)(int32_t)ra->imm[b];
+        if (imm >= -2048 && imm <= 2047) {
+            bool is_signed = cond == COND_LT || cond == COND_GE;
+            code_emit(code, is_signed ? rv_slti(rd, x, (int16_t)imm) : rv_sltiu(rd, x, (int16_t)imm));
+            if (cond == COND_GE || cond == 2) code_emit(code, rv_xori(rd, rd, 1));
+            return;
+        }
+    }
+    int y = rv64_ra_use(code, ra, body, b, bytes, RV_T2);
+    rv64_setcc(code, rd, x, y, cond, bytes == 8);
+}
+
+/* Branch word (offset 0) taken when x cond y, or 0 for MI/PL. */
+static uint32_t rv64_branch(int32_t cond, int x, int y) {
+    switch (cond) {
+    case COND_EQ: return rv_beq(x, y, 0);
+    case COND_NE: return rv_bne(x, y, 0);
+    case COND_LT: return rv_blt(x, y, 0);
+    case COND_GE: return rv_bge(x, y, 0);
+    case COND_GT: return rv_blt(y, x, 0);
+    case COND_LE: return rv_bge(y, x, 0);
+    case 2: return rv_bgeu(x, y, 0);    /* HS */
+    case 3: return rv_bltu(x, y, 0);    /* LO */
+    case 8: return rv_bltu(y, x, 0);    /* HI */
+    case 9: return rv_bgeu(y, x, 0);    /* LS */
+    default: return 0;
+    }
+}
+
+static int32_t rv64_cond_invert(int32_t cond) {
+    switch (cond) {
+    case COND_EQ: return COND_NE;
+    case COND_NE: return COND_EQ;
+    case COND_LT: return COND_GE;
+    case COND_GE: return COND_LT;
+    case COND_GT: return COND_LE;
+    case COND_LE: return COND_GT;
+    case 2: return 3;   /* HS -> LO */
+    case 3: return 2;
+    case 8: return 9;   /* HI -> LS */
+    case 9: return 8;
+    case 4: return 5;   /* MI -> PL */
+    default: return 4;
+    }
+}
+
+/* a ref param takes the address of (or the pointer in) its argument slot */
+static void rv64_ra_word_arg(Code *code, ColdRegAlloc *ra, BodyIR *body, int reg,
+                             int32_t param_kind, int32_t arg) {
+    if (arg < 0 || arg >= body->slot_count) return;
+    int32_t arg_kind = body->slot_kind[arg];
+    int32_t off = body->slot_offset[arg] + ra->sp_bias;
+    if (cold_kind_is_ref(param_kind)) {
+        if (cold_kind_is_ref(arg_kind)) rv64_sp_mem(code, rv_ld, reg, off);
+        else rv64_addi_large(code, reg, RV_SP, off);
+        if (reg == RV_T0) ra->acc_slot = -1;
+        return;
+    }
+    int32_t bytes = cold_arg_bytes(param_kind, arg_kind);
+    if (bytes == 0) return;
+    int src = rv64_ra_use(code, ra, body, arg, bytes, reg);
+    if (src != reg) {
+        code_emit(code, rv_addi(reg, src, 0));
+        if (reg == RV_T0) ra->acc_slot = -1;
+    }
+}
+
+/* Word w of a composite argument: the slot's bytes (through the pointer a
+   ref argument holds), or its address when the parameter is passed by
+   reference. Arguments of another shape are left out, like x86_64. */
+static void rv64_ra_composite_arg(Code *code, ColdRegAlloc *ra, BodyIR *body, int reg,
+                                  int32_t param_kind, int32_t words, int32_t arg, int32_t w) {
+    if (arg < 0 || arg >= body->slot_count) return;
+    int32_t arg_kind = body->slot_kind[arg];
+    bool ref = cold_kind_is_ref(arg_kind);
+    if (param_kind == SLOT_STR ? arg_kind != SLOT_STR && arg_kind != SLOT_STR_REF
+                               : !ref && !cold_kind_is_composite(arg_kind)) return;
+    int32_t off = body->slot_offset[arg] + ra->sp_bias;
+    if (words == 1) {
+        if (ref) rv64_sp_mem(code, rv_ld, reg, off);
+        else rv64_addi_large(code, reg, RV_SP, off);
+    } else if (ref) {
+        rv64_sp_mem(code, rv_ld, reg, off);
+        code_emit(code, rv_ld(reg, reg, (int16_t)(8 * w)));
+    } else {
+        rv64_sp_mem(code, rv_ld, reg, off + 8 * w);
+    }
+    if (reg == RV_T0) ra->acc_slot = -1;
+}
+
+/* Direct call: stack words below sp, the hidden return pointer in a0 for a
+   composite result, register words in a0-a7, then jal ra. */
+static void rv64_ra_call(Code *code, ColdRegAlloc *ra, BodyIR *body, Symbols *symbols,
+                         FunctionPatchList *patches, int32_t op, int32_t arg_base) {
+    int32_t dst = body->op_dst[op];
+    int32_t fn_index = body->op_a[op];
+    FnDef *fn = &symbols->functions[fn_index];
+    int32_t arg_start = body->op_b[op];
+    int32_t place[COLD_MAX_I32_PARAMS], sizes[COLD_MAX_I32_PARAMS];
+    cold_call_param_sizes(body, fn, arg_start, sizes);
+    int32_t words = cold_place_params(fn->param_kind, sizes, fn->arity, arg_base > 0,
+                                      RV64_ARG_STACK, true, place);
+    int32_t reserve = align_i32(words * 8, 16);
+    rv64_addi_large(code, RV_SP, RV_SP, -reserve);
+    ra->sp_bias = reserve;
+    /* stack words first: they go through t0, which register words may not survive */
+    for (int pass = 0; pass < 2; pass++) {
+        if (pass == 1 && arg_base > 0)
+            rv64_addi_large(code, RV_A0, RV_SP, body->slot_offset[dst] + ra->sp_bias);
+        for (int32_t i = 0; i < fn->arity; i++) {
+            bool on_stack = place[i] >= RV64_ARG_STACK;
+            if (on_stack != (pass == 0)) continue;
+            int32_t arg = body->call_arg_slot[arg_start + i];
+            int32_t kind = fn->param_kind[i];
+            int32_t n = cold_param_words(kind, sizes[i], true);
+            for (int32_t w = 0; w < n; w++) {
+                int reg = on_stack ? RV_T0 : RV_A0 + place[i] + w;
+                if (cold_kind_is_composite(kind))
+                    rv64_ra_composite_arg(code, ra, body, reg, kind, n, arg, w);
+                else
+                    rv64_ra_word_arg(code, ra, body, reg, kind, arg);
+                if (on_stack) rv64_sp_mem(code, rv_sd, RV_T0, 8 * (place[i] - RV64_ARG_STACK + w));
+            }
+        }
+    }
+    function_patches_add(patches, code->count, fn_index);
+    code_emit(code, rv_jal(RV_RA, 0));
+    rv64_addi_large(code, RV_SP, RV_SP, reserve);
+    ra->sp_bias = 0;
+    ra->acc_slot = -1;
+    if (arg_base == 0 && dst >= 0 && dst < body->slot_count)
+        rv64_ra_def(code, ra, body, dst, RV_A0, cold_scalar_bytes(body->slot_kind[dst]) == 8 ? 8 : 4);
+}
+
+/* Lowers ops the allocation covers (scalar arithmetic, compares, moves,
+   pointer access) and direct calls; false sends the op to rv64_codegen_op. */
+static bool rv64_lower_op(Code *code, ColdRegAlloc *ra, BodyIR *body, Symbols *symbols,
+                          FunctionPatchList *patches, int32_t op) {
+    int32_t kind = body->op_kind[op];
+    /* LOAD_I32 only materializes a slot in the aarch64 result register. */
+    if (kind == BODY_OP_LOAD_I32) return true;
+    int32_t arg_base = cold_call_arg_base(body, symbols, RV64_ARG_STACK, true, op);
+    if (arg_base >= 0) {
+        rv64_ra_call(code, ra, body, symbols, patches, op, arg_base);
+        return true;
+    }
+    ColdOpShape shape;
+    if (!cold_op_shape(body, op, &shape)) return false;
+    int32_t dst = body->op_dst[op], a = body->op_a[op], b = body->op_b[op];
+    if (shape.pure && (ra->is_const[dst] || ra->dead[dst])) return true;
+    switch (kind) {
+    case BODY_OP_I32_CONST: rv64_ra_const(code, ra, body, dst, a, 4); break;
+    case BODY_OP_I64_CONST:
+        rv64_ra_const(code, ra, body, dst, (int64_t)((uint64_t)(uint32_t)a | ((uint64_t)(uint32_t)b << 32)), 8);
+        break;
+    case BODY_OP_PTR_CONST: rv64_ra_const(code, ra, body, dst, a, 8); break;
+    case BODY_OP_COPY_I32: case BODY_OP_I32_FROM_I64: rv64_ra_move(code, ra, body, dst, a, 4, 4); break;
+    case BODY_OP_COPY_I64: rv64_ra_move(code, ra, body, dst, a, 8, 8); break;
+    /* I32 registers are already sign-extended */
+    case BODY_OP_I64_FROM_I32: rv64_ra_move(code, ra, body, dst, a, 4, 8); break;
+    case BODY_OP_I32_ADD: rv64_ra_binary(code, ra, body, RV64_ALU_ADD, dst, a, b, 4); break;
+    case BODY_OP_I32_SUB: rv64_ra_binary(code, ra, body, RV64_ALU_SUB, dst, a, b, 4); break;
+    case BODY_OP_I32_MUL: rv64_ra_binary(code, ra, body, RV64_ALU_MUL, dst, a, b, 4); break;
+    case BODY_OP_I32_AND: rv64_ra_binary(code, ra, body, RV64_ALU_AND, dst, a, b, 4); break;
+    case BODY_OP_I32_OR: rv64_ra_binary(code, ra, body, RV64_ALU_OR, dst, a, b, 4); break;
+    case BODY_OP_I32_XOR: rv64_ra_binary(code, ra, body, RV64_ALU_XOR, dst, a, b, 4); break;
+    case BODY_OP_I32_SHL: rv64_ra_binary(code, ra, body, RV64_ALU_SLL, dst, a, b, 4); break;
+    case BODY_OP_I32_ASR: rv64_ra_binary(code, ra, body, RV64_ALU_SRA, dst, a, b, 4); break;
+    case BODY_OP_I32_DIV: rv64_ra_binary(code, ra, body, RV64_ALU_DIV, dst, a, b, 4); break;
+    case BODY_OP_I32_MOD: rv64_ra_binary(code, ra, body, RV64_ALU_REM, dst, a, b, 4); break;
+    case BODY_OP_I64_ADD: rv64_ra_binary(code, ra, body, RV64_ALU_ADD, dst, a, b, 8); break;
+    case BODY_OP_I64_SUB: rv64_ra_binary(code, ra, body, RV64_ALU_SUB, dst, a, b, 8); break;
+    case BODY_OP_I64_MUL: rv64_ra_binary(code, ra, body, RV64_ALU_MUL, dst, a, b, 8); break;
+    case BODY_OP_I64_AND: rv64_ra_binary(code, ra, body, RV64_ALU_AND, dst, a, b, 8); break;
+    case BODY_OP_I64_OR: rv64_ra_binary(code, ra, body, RV64_ALU_OR, dst, a, b, 8); break;
+    case BODY_OP_I64_XOR: rv64_ra_binary(code, ra, body, RV64_ALU_XOR, dst, a, b, 8); break;
+    case BODY_OP_I64_SHL: rv64_ra_binary(code, ra, body, RV64_ALU_SLL, dst, a, b, 8); break;
+    case BODY_OP_I64_ASR: rv64_ra_binary(code, ra, body, RV64_ALU_SRA, dst, a, b, 8); break;
+    case BODY_OP_I64_DIV: rv64_ra_binary(code, ra, body, RV64_ALU_DIV, dst, a, b, 8); break;
+    case BODY_OP_I32_CMP: case BODY_OP_I64_CMP: {
+        int rd = rv64_ra_dst(ra, dst);
+        rv64_ra_compare(code, ra, body, rd, a, b, shape.use_bytes[0], body->op_c[op]);
+        rv64_ra_def(code, ra, body, dst, rd, 4);
+        break;
+    }
+    case BODY_OP_PTR_ADD: {
+        int rd = rv64_ra_dst(ra, dst);
+        int base = rv64_ra_use(code, ra, body, a, 8, RV_T1);
+        int64_t imm = shape.use_bytes[1] == 8 ? ra->imm[b] : (int64_t)(int32_t)ra->imm[b];
+        if (ra->is_const[b] && imm >= -2048 && imm <= 2047) {
+            code_emit(code, rv_addi(rd, base, (int16_t)imm));
+        } else {
+            int idx = rv64_ra_use(code, ra, body, b, shape.use_bytes[1], RV_T2);
+            code_emit(code, rv_add(rd, base, idx));
         }
-    } else if (kind == BODY_OP_PATH_READ_TEXT) {
-        /* Stub: return empty string */
-        x64_xor_r64_r64(x, 0, 0);
-        x64_mov_mr64_r64(x, 4, off_dst, 0);
-        x64_mov_mr32_imm32(x, 4, off_dst + 8, 0);
-    } else if (kind == BODY_OP_PATH_WRITE_TEXT) {
-        /* Stub: return 0 (failure) */
-        x64_xor_r32_r32(x, 0, 0);
-        x64_mov_mr32_r32(x, 4, off_dst, 0);
-    } else if (kind == BODY_OP_COLD_SELF_EXEC) {
-        /* Stub: return -1 (exec failure) */
-        x64_mov_r32_imm32(x, 0, -1);
-        x64_mov_mr32_r32(x, 4, off_dst, 0);
-    } else if (kind == BODY_OP_EXEC_SHELL) {
-        /* Stub: return -1 (exec failure) */
-        x64_mov_r32_imm32(x, 0, -1);
-        x64_mov_mr32_r32(x, 4, off_dst, 0);
-    } else if (kind == BODY_OP_PATH_WRITE_BYTES) {
-        /* Stub: return 0 (failure) */
-        x64_xor_r32_r32(x, 0, 0);
-        x64_mov_mr32_r32(x, 4, off_dst, 0);
-    } else {
-        fprintf(stderr, "cheng_cold: unknown x86_64 BodyIR op kind=%d\n", kind);
-        die("unknown x86_64 BodyIR op");
+        rv64_ra_def(code, ra, body, dst, rd, 8);
+        break;
+    }
+    case BODY_OP_PTR_LOAD_I32: case BODY_OP_PTR_LOAD_U8:
+    case BODY_OP_PTR_LOAD_U16: case BODY_OP_PTR_LOAD_I64: {
+        int rd = rv64_ra_dst(ra, dst);
+        int base = rv64_ra_use(code, ra, body, a, 8, RV_T1);
+        if (kind == BODY_OP_PTR_LOAD_I32) code_emit(code, rv_lw(rd, base, 0));
+        else if (kind == BODY_OP_PTR_LOAD_U8) code_emit(code, rv_lbu(rd, base, 0));
+        else if (kind == BODY_OP_PTR_LOAD_U16) code_emit(code, rv_lhu(rd, base, 0));
+        else code_emit(code, rv_ld(rd, base, 0));
+        rv64_ra_def(code, ra, body, dst, rd, shape.def_bytes);
+        break;
     }
+    case BODY_OP_PTR_STORE_I32: case BODY_OP_PTR_STORE_U8:
+    case BODY_OP_PTR_STORE_U16: case BODY_OP_PTR_STORE_I64: {
+        int value = rv64_ra_use(code, ra, body, a, shape.use_bytes[1], RV_T2);
+        int base = rv64_ra_use(code, ra, body, dst, 8, RV_T1);
+        if (kind == BODY_OP_PTR_STORE_I32) code_emit(code, rv_sw(value, base, 0));
+        else if (kind == BODY_OP_PTR_STORE_U8) code_emit(code, rv_sb(value, base, 0));
+        else if (kind == BODY_OP_PTR_STORE_U16) code_emit(code, rv_sh(value, base, 0));
+        else code_emit(code, rv_sd(value, base, 0));
+        /* the store may alias the slot t0 mirrors */
+        ra->acc_slot = -1;
+        break;
+    }
+    default:
+        return false;
+    }
+    return true;
 }
 
-/* x86_64 function prologue: push rbp; mov rsp, rbp; sub $frame, rsp */
-static void x64_codegen_prologue(X64Code *x, int32_t frame_size) {
-    x64_push_r64(x, 5); /* push %rbp */
-    x64_mov_r64_r64(x, 5, 4); /* mov %rsp, %rbp */
-    if (frame_size > 0) x64_sub_rsp_imm8(x, (int8_t)frame_size);
+/* addi sp, -frame; ra and the saved registers at the top of the frame, then
+   the hidden return pointer and the params to their allocated homes. */
+static void rv64_codegen_prologue(Code *code, BodyIR *body, ColdRegAlloc *ra) {
+    rv64_addi_large(code, RV_SP, RV_SP, -ra->frame);
+    rv64_sp_mem(code, rv_sd, RV_RA, ra->frame - 8);
+    for (int32_t i = 0; i < ra->saved_count; i++)
+        rv64_sp_mem(code, rv_sd, ra->saved[i], ra->frame - 16 - 8 * i);
+    if (!ra->params_in_regs) return;
+    if (ra->sret_off >= 0) rv64_sp_mem(code, rv_sd, RV_A0, ra->sret_off);
+    for (int32_t i = 0; i < body->param_count; i++) {
+        int32_t slot = body->param_slot[i];
+        int32_t place = ra->param_place[i];
+        int32_t off = body->slot_offset[slot];
+        /* stack words sit in the caller's outgoing area just above the frame */
+        int32_t in_off = ra->frame + 8 * (place - RV64_ARG_STACK);
+        if (body->slot_kind[slot] == SLOT_STR) {
+            for (int32_t w = 0; w < 2; w++) {
+                int reg = RV_A0 + place + w;
+                if (place >= RV64_ARG_STACK) {
+                    reg = RV_T0;
+                    rv64_sp_mem(code, rv_ld, reg, in_off + 8 * w);
+                }
+                rv64_sp_mem(code, rv_sd, reg, off + 8 * w);
+            }
+            continue;
+        }
+        if (cold_kind_is_composite(body->slot_kind[slot])) {
+            int32_t size = body->slot_size[slot];
+            int32_t words = cold_param_words(body->slot_kind[slot], size, true);
+            for (int32_t w = 0; w < words; w++) {
+                int reg = RV_A0 + place + w;
+                if (place >= RV64_ARG_STACK) {
+                    reg = RV_T0;
+                    rv64_sp_mem(code, rv_ld, reg, in_off + 8 * w);
+                }
+                if (words == 2) {
+                    if (8 * w < size) rv64_sp_mem(code, rv_sd, reg, off + 8 * w);
+                    continue;
+                }
+                /* passed by reference: copy the caller's bytes into the frame */
+                for (int32_t b = 0; b + 8 <= size; b += 8) {
+                    code_emit(code, rv_ld(RV_T1, reg, (int16_t)b));
+                    rv64_sp_mem(code, rv_sd, RV_T1, off + b);
+                }
+                if (size % 8 >= 4) {
+                    code_emit(code, rv_lw(RV_T1, reg, (int16_t)(size & ~7)));
+                    rv64_sp_mem(code, rv_sw, RV_T1, off + (size & ~7));
+                }
+            }
+            continue;
+        }
+        bool wide = cold_scalar_bytes(body->slot_kind[slot]) != 4;
+        int reg = ra->reg[slot];
+        if (place < RV64_ARG_STACK) {
+            if (reg >= 0) code_emit(code, rv_addi(reg, RV_A0 + place, 0));
+            else if (!ra->dead[slot]) rv64_sp_mem(code, wide ? rv_sd : rv_sw, RV_A0 + place, off);
+        } else if (reg >= 0 || !ra->dead[slot]) {
+            rv64_sp_mem(code, wide ? rv_ld : rv_lw, reg >= 0 ? reg : RV_T0, in_off);
+            if (reg < 0) rv64_sp_mem(code, wide ? rv_sd : rv_sw, RV_T0, off);
+        }
+    }
 }
 
-/* x86_64 function epilogue: mov rbp, rsp; pop rbp; ret */
-static void x64_codegen_epilogue(X64Code *x) {
-    x64_mov_r64_r64(x, 4, 5); /* mov %rbp, %rsp */
-    x64_pop_r64(x, 5); /* pop %rbp */
-    x64_ret(x);
+static void rv64_codegen_epilogue(Code *code, ColdRegAlloc *ra) {
+    rv64_sp_mem(code, rv_ld, RV_RA, ra->frame - 8);
+    for (int32_t i = 0; i < ra->saved_count; i++)
+        rv64_sp_mem(code, rv_ld, ra->saved[i], ra->frame - 16 - 8 * i);
+    rv64_addi_large(code, RV_SP, RV_SP, ra->frame);
+    code_emit(code, rv_jalr(RV_ZERO, RV_RA, 0));
 }
 
-/* Pack X64Code bytes into uint32_t words. Returns word count. */
-static int32_t x64_pack_words(X64Code *x, uint32_t *words, int32_t max_words) {
-    int32_t wc = 0;
-    for (int32_t i = 0; i < x->len && wc < max_words; i += 4) {
-        uint32_t w = 0;
-        for (int32_t j = 0; j < 4 && i + j < x->len; j++)
-            w |= ((uint32_t)x->buf[i + j]) << (j * 8);
-        words[wc++] = w;
+static void rv64_codegen_return(Code *code, ColdRegAlloc *ra, BodyIR *body, int32_t term) {
+    int32_t value = body->term_value[term];
+    int32_t kind = value >= 0 && value < body->slot_count ? body->slot_kind[value] : 0;
+    int32_t bytes = cold_scalar_bytes(kind);
+    if (bytes > 0) {
+        int reg = rv64_ra_use(code, ra, body, value, bytes, RV_A0);
+        if (reg != RV_A0) code_emit(code, rv_addi(RV_A0, reg, 0));
+    } else if (cold_kind_is_composite(kind) && ra->sret_off >= 0) {
+        int32_t copy_bytes = kind == SLOT_STR ? 16 : body->slot_size[value];
+        int32_t total = kind == SLOT_STR ? 16 : body->return_size;
+        /* a CSG body records only the return kind; an object or array
+           result is as large as its own slot */
+        if ((kind == SLOT_OBJECT || kind == SLOT_ARRAY_I32) && copy_bytes > total) total = copy_bytes;
+        if (copy_bytes > total) copy_bytes = total;
+        rv64_sp_mem(code, rv_ld, RV_A0, ra->sret_off);
+        int32_t base = 0;
+        for (int32_t off = 0; off < total; off += 8) {
+            if (off - base > 2040) {
+                code_emit(code, rv_addi(RV_A0, RV_A0, 2040));
+                base += 2040;
+            }
+            int reg = RV_ZERO;
+            if (off < copy_bytes) {
+                reg = RV_T0;
+                rv64_sp_mem(code, rv_ld, RV_T0, body->slot_offset[value] + off);
+            }
+            code_emit(code, rv_sd(reg, RV_A0, (int16_t)(off - base)));
+        }
+    } else {
+        code_emit(code, rv_addi(RV_A0, RV_ZERO, 0));
     }
-    return wc;
+    rv64_codegen_epilogue(code, ra);
 }
 
-/* x86_64 function compilation wrapper */
-static void x64_codegen_func(X64Code *x, BodyIR *body, Symbols *symbols,
-                              FunctionPatchList *patches) {
-    x64_codegen_prologue(x, body->frame_size);
-    for (int32_t bi = 0; bi < body->block_count; bi++) {
-        int32_t bs = body->block_op_start[bi];
-        int32_t be = bs + body->block_op_count[bi];
-        for (int32_t oi = bs; oi < be; oi++)
-            x64_codegen_op(x, body, symbols, patches, oi);
+typedef struct Rv64BlockPatch {
+    int32_t pos;
+    int32_t block;
+} Rv64BlockPatch;
+
+typedef struct Rv64BlockPatches {
+    Rv64BlockPatch *items;
+    int32_t count;
+    int32_t cap;
+} Rv64BlockPatches;
+
+/* Branch (a B-type word with offset 0) or, for branch == 0, jal to a block.
+   Known targets are resolved on the spot; a far branch becomes the inverted
+   branch over a jal. */
+static void rv64_jump_block(Code *code, Rv64BlockPatches *patches, int32_t *block_pos,
+                            int32_t block_count, int32_t target, uint32_t branch, bool far) {
+    if (target >= 0 && target < block_count && block_pos[target] >= 0) {
+        int32_t off = (block_pos[target] - code->count) * 4;
+        if (branch != 0 && off >= -4096) {
+            code_emit(code, rv_with_offset(branch, off));
+            return;
+        }
+        if (branch != 0) {
+            code_emit(code, rv_with_offset(branch ^ (1u << 12), 8));
+            off -= 4;
+        }
+        if (off < -(1 << 20)) die("RV64 branch target out of range");
+        code_emit(code, rv_jal(RV_ZERO, off));
+        return;
+    }
+    if (branch != 0 && far) {
+        code_emit(code, rv_with_offset(branch ^ (1u << 12), 8));
+        branch = 0;
+    }
+    if (patches->count == patches->cap) {
+        patches->cap = patches->cap ? patches->cap * 2 : 16;
+        patches->items = realloc(patches->items, (size_t)patches->cap * sizeof(Rv64BlockPatch));
+        if (!patches->items) die("out of memory");
     }
-    x64_codegen_epilogue(x);
+    patches->items[patches->count].pos = code->count;
+    patches->items[patches->count].block = target;
+    patches->count++;
+    code_emit(code, branch != 0 ? branch : rv_jal(RV_ZERO, 0));
 }
 
-/* ---- RISC-V 64 codegen (fixed 32-bit words, reuses Code struct) ---- */
+/* Compare chain over the switch cases; the default falls through. */
+static void rv64_codegen_switch(Code *code, ColdRegAlloc *ra, BodyIR *body,
+                                Rv64BlockPatches *patches, int32_t *block_pos, int32_t term,
+                                bool far) {
+    int tag = rv64_ra_use(code, ra, body, body->term_value[term], 4, RV_T0);
+    for (int32_t i = 0; i < body->switch_count; i++) {
+        if (body->switch_term[i] != term) continue;
+        int value = RV_ZERO;
+        if (body->switch_tag[i] != 0) {
+            rv64_li(code, RV_T1, body->switch_tag[i]);
+            value = RV_T1;
+        }
+        rv64_jump_block(code, patches, block_pos, body->block_count, body->switch_block[i],
+                        rv_beq(tag, value, 0), far);
+    }
+}
 
 static void rv64_codegen_op(Code *code, BodyIR *body, Symbols *symbols,
                             FunctionPatchList *patches, int32_t op) {
@@ -13220,209 +16514,72 @@ static void rv64_codegen_op(Code *code, BodyIR *body, Symbols *symbols,
     int32_t dst = body->op_dst[op];
     int32_t a = body->op_a[op], b = body->op_b[op], c = body->op_c[op];
     int32_t off_dst = body->slot_offset[dst];
-    /* I32 ops */
-    if (kind == BODY_OP_I32_CONST) {
-        rv_li(code->words, &code->count, RV_T0, a);
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
-    } else if (kind == BODY_OP_COPY_I32) {
-        code_emit(code, rv_lw(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
-    } else if (kind == BODY_OP_I32_ADD || kind == BODY_OP_I32_SUB) {
-        code_emit(code, rv_lw(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_lw(RV_T1, RV_SP, (int16_t)body->slot_offset[b]));
-        code_emit(code, kind == BODY_OP_I32_ADD ? rv_addw(RV_T0, RV_T0, RV_T1) : rv_subw(RV_T0, RV_T0, RV_T1));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
-    } else if (kind == BODY_OP_I32_MUL) {
-        code_emit(code, rv_lw(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_lw(RV_T1, RV_SP, (int16_t)body->slot_offset[b]));
-        code_emit(code, rv_mulw(RV_T0, RV_T0, RV_T1));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
-    } else if (kind == BODY_OP_I32_DIV) {
-        code_emit(code, rv_lw(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_lw(RV_T1, RV_SP, (int16_t)body->slot_offset[b]));
-        code_emit(code, rv_divw(RV_T0, RV_T0, RV_T1));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
-    } else if (kind == BODY_OP_I32_MOD) {
-        code_emit(code, rv_lw(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_lw(RV_T1, RV_SP, (int16_t)body->slot_offset[b]));
-        code_emit(code, rv_remw(RV_T0, RV_T0, RV_T1));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
-    } else if (kind == BODY_OP_I32_AND) {
-        code_emit(code, rv_lw(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_lw(RV_T1, RV_SP, (int16_t)body->slot_offset[b]));
-        code_emit(code, rv_and(RV_T0, RV_T0, RV_T1));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
-    } else if (kind == BODY_OP_I32_OR) {
-        code_emit(code, rv_lw(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_lw(RV_T1, RV_SP, (int16_t)body->slot_offset[b]));
-        code_emit(code, rv_or(RV_T0, RV_T0, RV_T1));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
-    } else if (kind == BODY_OP_I32_XOR) {
-        code_emit(code, rv_lw(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_lw(RV_T1, RV_SP, (int16_t)body->slot_offset[b]));
-        code_emit(code, rv_xor(RV_T0, RV_T0, RV_T1));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
-    } else if (kind == BODY_OP_I32_SHL) {
-        code_emit(code, rv_lw(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_lw(RV_T1, RV_SP, (int16_t)body->slot_offset[b]));
-        code_emit(code, rv_sllw(RV_T0, RV_T0, RV_T1));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
-    } else if (kind == BODY_OP_I32_ASR) {
-        code_emit(code, rv_lw(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_lw(RV_T1, RV_SP, (int16_t)body->slot_offset[b]));
-        code_emit(code, rv_sraw(RV_T0, RV_T0, RV_T1));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
-    } else if (kind == BODY_OP_I32_CMP) {
-        code_emit(code, rv_lw(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_lw(RV_T1, RV_SP, (int16_t)body->slot_offset[b]));
-        /* Use SLT/SLTU/EQ based on condition code c */
-        if (c == COND_EQ) {
-            code_emit(code, rv_subw(RV_T0, RV_T0, RV_T1));
-            code_emit(code, rv_sltiu(RV_T0, RV_T0, 1)); /* T0==0 ? 1 : 0 */
-        } else if (c == COND_NE) {
-            code_emit(code, rv_subw(RV_T0, RV_T0, RV_T1));
-            code_emit(code, rv_sltu(RV_T0, RV_ZERO, RV_T0)); /* T0!=0 ? 1 : 0 */
-        } else if (c == COND_LT) {
-            code_emit(code, rv_slt(RV_T0, RV_T0, RV_T1));
-        } else if (c == COND_GE) {
-            code_emit(code, rv_slt(RV_T0, RV_T0, RV_T1));
-            code_emit(code, rv_xori(RV_T0, RV_T0, 1));
-        } else {
-            code_emit(code, rv_slt(RV_T0, RV_T1, RV_T0)); /* default: a < b */
-        }
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
-    /* I64 ops */
-    } else if (kind == BODY_OP_I64_CONST) {
-        uint64_t bits = (uint32_t)a | ((uint64_t)(uint32_t)b << 32);
-        rv_li(code->words, &code->count, RV_T0, (int32_t)bits);
-        if ((bits >> 32) != 0) {
-            rv_li(code->words, &code->count, RV_T1, (int32_t)(bits >> 32));
-            code_emit(code, rv_slli(RV_T1, RV_T1, 32));
-            code_emit(code, rv_or(RV_T0, RV_T0, RV_T1));
-        }
-        code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)off_dst));
-    } else if (kind == BODY_OP_COPY_I64) {
-        code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)off_dst));
-    } else if (kind == BODY_OP_I64_FROM_I32) {
-        code_emit(code, rv_lw(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)off_dst));
-    } else if (kind == BODY_OP_I32_FROM_I64) {
-        code_emit(code, rv_lw(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
-    } else if (kind == BODY_OP_I64_ADD || kind == BODY_OP_I64_SUB) {
-        code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_ld(RV_T1, RV_SP, (int16_t)body->slot_offset[b]));
-        code_emit(code, kind == BODY_OP_I64_ADD ? rv_add(RV_T0, RV_T0, RV_T1) : rv_sub(RV_T0, RV_T0, RV_T1));
-        code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)off_dst));
-    } else if (kind == BODY_OP_I64_MUL) {
-        code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_ld(RV_T1, RV_SP, (int16_t)body->slot_offset[b]));
-        code_emit(code, rv_mul(RV_T0, RV_T0, RV_T1));
-        code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)off_dst));
-    } else if (kind == BODY_OP_I64_DIV) {
-        code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_ld(RV_T1, RV_SP, (int16_t)body->slot_offset[b]));
-        code_emit(code, rv_div(RV_T0, RV_T0, RV_T1));
-        code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)off_dst));
-    } else if (kind == BODY_OP_I64_AND || kind == BODY_OP_I64_OR || kind == BODY_OP_I64_XOR) {
-        code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_ld(RV_T1, RV_SP, (int16_t)body->slot_offset[b]));
-        if (kind == BODY_OP_I64_AND) code_emit(code, rv_and(RV_T0, RV_T0, RV_T1));
-        else if (kind == BODY_OP_I64_OR) code_emit(code, rv_or(RV_T0, RV_T0, RV_T1));
-        else code_emit(code, rv_xor(RV_T0, RV_T0, RV_T1));
-        code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)off_dst));
-    } else if (kind == BODY_OP_I64_SHL || kind == BODY_OP_I64_ASR) {
-        code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_ld(RV_T1, RV_SP, (int16_t)body->slot_offset[b]));
-        if (kind == BODY_OP_I64_SHL) code_emit(code, rv_sll(RV_T0, RV_T0, RV_T1));
-        else code_emit(code, rv_sra(RV_T0, RV_T0, RV_T1));
-        code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)off_dst));
-    } else if (kind == BODY_OP_I64_CMP) {
-        code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_ld(RV_T1, RV_SP, (int16_t)body->slot_offset[b]));
-        if (c == COND_EQ) {
-            code_emit(code, rv_sub(RV_T0, RV_T0, RV_T1));
-            code_emit(code, rv_sltiu(RV_T0, RV_T0, 1));
-        } else if (c == COND_NE) {
-            code_emit(code, rv_sub(RV_T0, RV_T0, RV_T1));
-            code_emit(code, rv_sltu(RV_T0, RV_ZERO, RV_T0));
-        } else if (c == COND_LT) {
-            code_emit(code, rv_slt(RV_T0, RV_T0, RV_T1));
-        } else {
-            code_emit(code, rv_slt(RV_T0, RV_T1, RV_T0));
-        }
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
-    /* Float F32 */
-    } else if (kind == BODY_OP_F32_CONST) {
+    bool checked = !cold_op_bounds_proven(body, op);
+    /* Scalar integer and pointer ops are lowered by rv64_lower_op. */
+    /* Float: F32 */
+    if (kind == BODY_OP_F32_CONST) {
         float val; memcpy(&val, &a, 4);
         int32_t bits; memcpy(&bits, &val, 4);
-        rv_li(code->words, &code->count, RV_T0, bits);
+        rv64_li(code, RV_T0, bits);
         code_emit(code, rv_fmv_w_x(0, RV_T0));
-        code_emit(code, rv_fsw(0, RV_SP, (int16_t)off_dst));
+        rv64_sp_mem(code, rv_fsw, 0, off_dst);
     } else if (kind == BODY_OP_F32_ADD || kind == BODY_OP_F32_SUB ||
                kind == BODY_OP_F32_MUL || kind == BODY_OP_F32_DIV) {
-        code_emit(code, rv_flw(0, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_flw(1, RV_SP, (int16_t)body->slot_offset[b]));
+        rv64_sp_mem(code, rv_flw, 0, body->slot_offset[a]);
+        rv64_sp_mem(code, rv_flw, 1, body->slot_offset[b]);
         if (kind == BODY_OP_F32_ADD) code_emit(code, rv_fadd_s(0, 0, 1));
         else if (kind == BODY_OP_F32_SUB) code_emit(code, rv_fsub_s(0, 0, 1));
         else if (kind == BODY_OP_F32_MUL) code_emit(code, rv_fmul_s(0, 0, 1));
         else code_emit(code, rv_fdiv_s(0, 0, 1));
-        code_emit(code, rv_fsw(0, RV_SP, (int16_t)off_dst));
+        rv64_sp_mem(code, rv_fsw, 0, off_dst);
     } else if (kind == BODY_OP_F32_NEG) {
-        code_emit(code, rv_flw(0, RV_SP, (int16_t)body->slot_offset[a]));
+        rv64_sp_mem(code, rv_flw, 0, body->slot_offset[a]);
         code_emit(code, rv_fsgnjn_s(0, 0, 0));
-        code_emit(code, rv_fsw(0, RV_SP, (int16_t)off_dst));
+        rv64_sp_mem(code, rv_fsw, 0, off_dst);
     } else if (kind == BODY_OP_F32_CMP) {
-        code_emit(code, rv_flw(0, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_flw(1, RV_SP, (int16_t)body->slot_offset[b]));
-        code_emit(code, c == COND_EQ ? rv_feq_s(RV_T0, 0, 1) : rv_flt_s(RV_T0, 0, 1));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
+        rv64_sp_mem(code, rv_flw, 0, body->slot_offset[a]);
+        rv64_sp_mem(code, rv_flw, 1, body->slot_offset[b]);
+        rv64_float_cmp(code, c, false);
+        rv64_sp_mem(code, rv_sw, RV_T0, off_dst);
     } else if (kind == BODY_OP_F32_FROM_I32) {
-        code_emit(code, rv_lw(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
+        rv64_sp_mem(code, rv_lw, RV_T0, body->slot_offset[a]);
         code_emit(code, rv_fcvt_s_w(0, RV_T0));
-        code_emit(code, rv_fsw(0, RV_SP, (int16_t)off_dst));
+        rv64_sp_mem(code, rv_fsw, 0, off_dst);
     } else if (kind == BODY_OP_I32_FROM_F32) {
-        code_emit(code, rv_flw(0, RV_SP, (int16_t)body->slot_offset[a]));
+        rv64_sp_mem(code, rv_flw, 0, body->slot_offset[a]);
         code_emit(code, rv_fcvt_w_s(RV_T0, 0));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
-    /* Float F64 */
+        rv64_sp_mem(code, rv_sw, RV_T0, off_dst);
+    /* Float: F64 */
     } else if (kind == BODY_OP_F64_CONST) {
-        uint64_t bits = (uint32_t)a | ((uint64_t)(uint32_t)b << 32);
-        rv_li(code->words, &code->count, RV_T0, (int32_t)bits);
-        if ((bits >> 32) != 0) {
-            rv_li(code->words, &code->count, RV_T1, (int32_t)(bits >> 32));
-            code_emit(code, rv_slli(RV_T1, RV_T1, 32));
-            code_emit(code, rv_or(RV_T0, RV_T0, RV_T1));
-        }
+        rv64_li(code, RV_T0, (int64_t)((uint32_t)a | ((uint64_t)(uint32_t)b << 32)));
         code_emit(code, rv_fmv_d_x(0, RV_T0));
-        code_emit(code, rv_fsd(0, RV_SP, (int16_t)off_dst));
+        rv64_sp_mem(code, rv_fsd, 0, off_dst);
     } else if (kind == BODY_OP_F64_ADD || kind == BODY_OP_F64_SUB ||
                kind == BODY_OP_F64_MUL || kind == BODY_OP_F64_DIV) {
-        code_emit(code, rv_fld(0, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_fld(1, RV_SP, (int16_t)body->slot_offset[b]));
+        rv64_sp_mem(code, rv_fld, 0, body->slot_offset[a]);
+        rv64_sp_mem(code, rv_fld, 1, body->slot_offset[b]);
         if (kind == BODY_OP_F64_ADD) code_emit(code, rv_fadd_d(0, 0, 1));
         else if (kind == BODY_OP_F64_SUB) code_emit(code, rv_fsub_d(0, 0, 1));
         else if (kind == BODY_OP_F64_MUL) code_emit(code, rv_fmul_d(0, 0, 1));
         else code_emit(code, rv_fdiv_d(0, 0, 1));
-        code_emit(code, rv_fsd(0, RV_SP, (int16_t)off_dst));
+        rv64_sp_mem(code, rv_fsd, 0, off_dst);
     } else if (kind == BODY_OP_F64_NEG) {
-        code_emit(code, rv_fld(0, RV_SP, (int16_t)body->slot_offset[a]));
+        rv64_sp_mem(code, rv_fld, 0, body->slot_offset[a]);
         code_emit(code, rv_fsgnjn_d(0, 0, 0));
-        code_emit(code, rv_fsd(0, RV_SP, (int16_t)off_dst));
+        rv64_sp_mem(code, rv_fsd, 0, off_dst);
     } else if (kind == BODY_OP_F64_CMP) {
-        code_emit(code, rv_fld(0, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_fld(1, RV_SP, (int16_t)body->slot_offset[b]));
-        code_emit(code, c == COND_EQ ? rv_feq_d(RV_T0, 0, 1) : rv_flt_d(RV_T0, 0, 1));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
+        rv64_sp_mem(code, rv_fld, 0, body->slot_offset[a]);
+        rv64_sp_mem(code, rv_fld, 1, body->slot_offset[b]);
+        rv64_float_cmp(code, c, true);
+        rv64_sp_mem(code, rv_sw, RV_T0, off_dst);
     } else if (kind == BODY_OP_F64_FROM_I32) {
-        code_emit(code, rv_lw(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
+        rv64_sp_mem(code, rv_lw, RV_T0, body->slot_offset[a]);
         code_emit(code, rv_fcvt_d_w(0, RV_T0));
-        code_emit(code, rv_fsd(0, RV_SP, (int16_t)off_dst));
+        rv64_sp_mem(code, rv_fsd, 0, off_dst);
     } else if (kind == BODY_OP_I32_FROM_F64) {
-        code_emit(code, rv_fld(0, RV_SP, (int16_t)body->slot_offset[a]));
+        rv64_sp_mem(code, rv_fld, 0, body->slot_offset[a]);
         code_emit(code, rv_fcvt_w_d(RV_T0, 0));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
+        rv64_sp_mem(code, rv_sw, RV_T0, off_dst);
     /* String / Load / Store */
     } else if (kind == BODY_OP_STR_LITERAL) {
         if (a < 0 || a >= body->string_literal_count) die("invalid string literal index");
@@ -13431,387 +16588,375 @@ static void rv64_codegen_op(Code *code, BodyIR *body, Symbols *symbols,
         code_emit(code, rv_auipc(RV_T0, 0));
         int32_t sl_addi = code->count;
         code_emit(code, rv_addi(RV_T0, RV_T0, 0));
-        int32_t sl_skip = code->count;
-        code_emit(code, rv_jal(RV_ZERO, 0));
-        int32_t sl_data = code->count;
-        code_append_bytes(code, (const char *)literal.ptr, literal.len + 1);
-        int32_t sl_after = code->count;
-        int32_t sl_off = (sl_data - sl_auipc) * 4;
-        int32_t sl_upper = (sl_off + 0x800) & 0xFFFFF000;
-        int16_t sl_lower = (int16_t)(sl_off - sl_upper);
-        code->words[sl_auipc] = rv_auipc(RV_T0, sl_upper);
-        code->words[sl_addi] = rv_addi(RV_T0, RV_T0, sl_lower);
-        code->words[sl_skip] = rv_jal(RV_ZERO, (int32_t)((sl_after - sl_skip) * 4));
-        code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)off_dst));
-        rv_li(code->words, &code->count, RV_T1, literal.len);
-        code_emit(code, rv_sw(RV_T1, RV_SP, (int16_t)(off_dst + 8)));
+        if (cold_rodata.enabled) {
+            function_patches_add_kind(patches, sl_auipc, cold_rodata_literal_id(literal),
+                                      FUNCTION_PATCH_RODATA);
+        } else {
+            int32_t sl_skip = code->count;
+            code_emit(code, rv_jal(RV_ZERO, 0));
+            int32_t sl_data = code->count;
+            code_append_bytes(code, (const char *)literal.ptr, literal.len + 1);
+            int32_t sl_after = code->count;
+            int32_t sl_off = (sl_data - sl_auipc) * 4;
+            int32_t sl_upper = (sl_off + 0x800) & 0xFFFFF000;
+            int16_t sl_lower = (int16_t)(sl_off - sl_upper);
+            code->words[sl_auipc] = rv_auipc(RV_T0, sl_upper);
+            code->words[sl_addi] = rv_addi(RV_T0, RV_T0, sl_lower);
+            code->words[sl_skip] = rv_jal(RV_ZERO, (int32_t)((sl_after - sl_skip) * 4));
+        }
+        rv64_li(code, RV_T1, literal.len);
+        rv64_store_str(code, off_dst, RV_T0, RV_T1);
     } else if (kind == BODY_OP_STR_LEN) {
         if (body->slot_kind[a] == SLOT_STR_REF) {
-            code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
+            rv64_sp_mem(code, rv_ld, RV_T0, body->slot_offset[a]);
             code_emit(code, rv_lw(RV_T0, RV_T0, 8));
         } else {
-            code_emit(code, rv_lw(RV_T0, RV_SP, (int16_t)(body->slot_offset[a] + 8)));
+            rv64_sp_mem(code, rv_lw, RV_T0, body->slot_offset[a] + 8);
         }
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
+        rv64_sp_mem(code, rv_sw, RV_T0, off_dst);
     } else if (kind == BODY_OP_STR_INDEX) {
         /* str[index]: bounds-checked byte load, result is I32 */
-        if (body->slot_kind[a] == SLOT_STR_REF) {
-            code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-            code_emit(code, rv_ld(RV_T1, RV_T0, 0));
-            code_emit(code, rv_lw(RV_T2, RV_T0, 8));
-        } else {
-            code_emit(code, rv_ld(RV_T1, RV_SP, (int16_t)body->slot_offset[a]));
-            code_emit(code, rv_lw(RV_T2, RV_SP, (int16_t)(body->slot_offset[a] + 8)));
-        }
-        code_emit(code, rv_lw(RV_T3, RV_SP, (int16_t)body->slot_offset[b]));
-        int32_t rsi_neg = code->count;
-        code_emit(code, rv_bge(RV_T3, RV_ZERO, 0));
-        code_emit(code, rv_ebreak());
-        int32_t rsi_neg_done = code->count;
-        code->words[rsi_neg] = rv_bge(RV_T3, RV_ZERO, (int16_t)((rsi_neg_done - rsi_neg) * 4));
-        code_emit(code, rv_blt(RV_T3, RV_T2, 0));
-        code_emit(code, rv_ebreak());
-        int32_t rsi_high_done = code->count;
-        code->words[rsi_neg_done] = rv_blt(RV_T3, RV_T2, (int16_t)((rsi_high_done - rsi_neg_done) * 4));
+        rv64_load_str(code, body, a, RV_T1, RV_T2);
+        rv64_sp_mem(code, rv_lw, RV_T3, body->slot_offset[b]);
+        if (checked) rv64_bounds_trap(code, RV_T3, RV_T2);
         code_emit(code, rv_add(RV_T1, RV_T1, RV_T3));
         code_emit(code, rv_lbu(RV_T0, RV_T1, 0));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
+        rv64_sp_mem(code, rv_sw, RV_T0, off_dst);
     } else if (kind == BODY_OP_PAYLOAD_LOAD) {
-        code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)(body->slot_offset[a] + b)));
-        code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)off_dst));
+        rv64_copy_slot_from_offset(code, body, dst, a, b);
     } else if (kind == BODY_OP_PAYLOAD_STORE) {
-        code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)(body->slot_offset[dst] + b)));
+        rv64_store_slot_to_payload(code, body, dst, b, a);
     } else if (kind == BODY_OP_TAG_LOAD) {
-        code_emit(code, rv_lw(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
+        rv64_sp_mem(code, rv_lw, RV_T0, body->slot_offset[a]);
+        rv64_sp_mem(code, rv_sw, RV_T0, off_dst);
     } else if (kind == BODY_OP_I32_REF_LOAD) {
-        code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
+        rv64_sp_mem(code, rv_ld, RV_T0, body->slot_offset[a]);
         code_emit(code, rv_lw(RV_T0, RV_T0, 0));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
+        rv64_sp_mem(code, rv_sw, RV_T0, off_dst);
     } else if (kind == BODY_OP_I32_REF_STORE) {
-        code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[dst]));
-        code_emit(code, rv_lw(RV_T1, RV_SP, (int16_t)body->slot_offset[a]));
+        rv64_sp_mem(code, rv_ld, RV_T0, body->slot_offset[dst]);
+        rv64_sp_mem(code, rv_lw, RV_T1, body->slot_offset[a]);
         code_emit(code, rv_sw(RV_T1, RV_T0, 0));
     } else if (kind == BODY_OP_FIELD_REF) {
-        code_emit(code, rv_addi(RV_T0, RV_SP, (int16_t)(body->slot_offset[a] + b)));
-        code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)off_dst));
+        rv64_addi_large(code, RV_T0, RV_SP, body->slot_offset[a] + b);
+        rv64_sp_mem(code, rv_sd, RV_T0, off_dst);
     } else if (kind == BODY_OP_STR_REF_STORE) {
         if (body->slot_kind[dst] != SLOT_STR_REF || body->slot_kind[a] != SLOT_STR)
             die("str ref store kind mismatch");
-        code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[dst]));
-        code_emit(code, rv_ld(RV_T1, RV_SP, (int16_t)body->slot_offset[a]));
+        rv64_sp_mem(code, rv_ld, RV_T0, body->slot_offset[dst]);
+        rv64_sp_mem(code, rv_ld, RV_T1, body->slot_offset[a]);
         code_emit(code, rv_sd(RV_T1, RV_T0, 0));
-        code_emit(code, rv_ld(RV_T1, RV_SP, (int16_t)(body->slot_offset[a] + 8)));
+        rv64_sp_mem(code, rv_ld, RV_T1, body->slot_offset[a] + 8);
         code_emit(code, rv_sd(RV_T1, RV_T0, 8));
-        code_emit(code, rv_ld(RV_T1, RV_SP, (int16_t)(body->slot_offset[a] + 16)));
+        rv64_sp_mem(code, rv_ld, RV_T1, body->slot_offset[a] + 16);
         code_emit(code, rv_sd(RV_T1, RV_T0, 16));
     } else if (kind == BODY_OP_COPY_COMPOSITE) {
         int32_t sz = body->slot_size[dst], os = body->slot_offset[a];
         for (int32_t off = 0; off < sz; off += 8) {
-            code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)(os + off)));
-            code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)(off_dst + off)));
+            rv64_sp_mem(code, rv_ld, RV_T0, os + off);
+            rv64_sp_mem(code, rv_sd, RV_T0, off_dst + off);
         }
-    /* Calls */
-    } else if (kind == BODY_OP_CALL_I32) {
-        int32_t call_pos = code->count;
-        code_emit(code, rv_jal(RV_RA, 0));
-        function_patches_add(patches, call_pos, a);
-        code_emit(code, rv_sw(RV_A0, RV_SP, (int16_t)off_dst));
-    } else if (kind == BODY_OP_CALL_COMPOSITE) {
-        int32_t call_pos = code->count;
-        code_emit(code, rv_jal(RV_RA, 0));
-        function_patches_add(patches, call_pos, a);
+    /* Calls the lowering could not place get no arguments, like x86_64. */
+    } else if (kind == BODY_OP_CALL_I32 || kind == BODY_OP_CALL_COMPOSITE) {
+        if (a >= 0 && a < symbols->function_count) {
+            function_patches_add(patches, code->count, a);
+            code_emit(code, rv_jal(RV_RA, 0));
+        }
+        if (kind == BODY_OP_CALL_I32) rv64_store_call_result(code, body, dst);
     } else if (kind == BODY_OP_CALL_PTR) {
-        code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
+        rv64_sp_mem(code, rv_ld, RV_T0, body->slot_offset[a]);
         code_emit(code, rv_jalr(RV_RA, RV_T0, 0));
-        code_emit(code, rv_sw(RV_A0, RV_SP, (int16_t)off_dst));
+        rv64_store_call_result(code, body, dst);
     } else if (kind == BODY_OP_FN_ADDR) {
-        int32_t fn_idx = a;
+        /* auipc + addi pair, resolved with the callee's final address */
         int32_t auipc_pos = code->count;
         code_emit(code, rv_auipc(RV_T0, 0));
-        function_patches_add_addr(patches, auipc_pos, fn_idx);
-        code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)off_dst));
-    /* Pointer ops */
-    } else if (kind == BODY_OP_PTR_CONST) {
-        rv_li(code->words, &code->count, RV_T0, (int32_t)a);
-        code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)off_dst));
-    } else if (kind == BODY_OP_PTR_LOAD_I32) {
-        code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_lw(RV_T0, RV_T0, 0));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
-    } else if (kind == BODY_OP_PTR_LOAD_U8) {
-        code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_lbu(RV_T0, RV_T0, 0));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
-    } else if (kind == BODY_OP_PTR_LOAD_U16) {
-        code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_lhu(RV_T0, RV_T0, 0));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
-    } else if (kind == BODY_OP_PTR_STORE_I32) {
-        code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[dst]));
-        code_emit(code, rv_lw(RV_T1, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_sw(RV_T1, RV_T0, 0));
-    } else if (kind == BODY_OP_PTR_STORE_U8) {
-        code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[dst]));
-        code_emit(code, rv_lw(RV_T1, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_sb(RV_T1, RV_T0, 0));
-    } else if (kind == BODY_OP_PTR_STORE_U16) {
-        code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[dst]));
-        code_emit(code, rv_lw(RV_T1, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_sh(RV_T1, RV_T0, 0));
-    } else if (kind == BODY_OP_PTR_LOAD_I64) {
-        code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_ld(RV_T0, RV_T0, 0));
-        code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)off_dst));
-    } else if (kind == BODY_OP_PTR_STORE_I64) {
-        code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[dst]));
-        code_emit(code, rv_ld(RV_T1, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_sd(RV_T1, RV_T0, 0));
+        code_emit(code, rv_addi(RV_T0, RV_T0, 0));
+        if (a >= 0 && a < symbols->function_count)
+            function_patches_add_addr(patches, auipc_pos, a);
+        rv64_sp_mem(code, rv_sd, RV_T0, off_dst);
+    /* Slot store */
     } else if (kind == BODY_OP_SLOT_STORE_I32) {
-        code_emit(code, rv_lw(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)(off_dst + c)));
+        rv64_sp_mem(code, rv_lw, RV_T0, body->slot_offset[a]);
+        rv64_sp_mem(code, rv_sw, RV_T0, off_dst + c);
     } else if (kind == BODY_OP_SLOT_STORE_I64) {
-        code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)(off_dst + c)));
+        rv64_sp_mem(code, rv_ld, RV_T0, body->slot_offset[a]);
+        rv64_sp_mem(code, rv_sd, RV_T0, off_dst + c);
     /* Variant / Composite */
     } else if (kind == BODY_OP_MAKE_VARIANT) {
         for (int32_t i = 0; i < body->slot_size[dst]; i += 8) {
-            code_emit(code, rv_sd(RV_ZERO, RV_SP, (int16_t)(off_dst + i)));
+            rv64_sp_mem(code, rv_sd, RV_ZERO, off_dst + i);
         }
-        rv_li(code->words, &code->count, RV_T0, (int32_t)a);
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
+        rv64_li(code, RV_T0, (int32_t)a);
+        rv64_sp_mem(code, rv_sw, RV_T0, off_dst);
         for (int32_t fi = 0; fi < c; fi++) {
             int32_t arg_slot = body->call_arg_slot[b + fi];
             int32_t poff = body->call_arg_offset[b + fi];
-            code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[arg_slot]));
-            code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)(off_dst + poff)));
+            if (body->slot_kind[arg_slot] != SLOT_STR) {
+                rv64_store_slot_to_payload(code, body, dst, poff, arg_slot);
+                continue;
+            }
+            /* a str payload carries data and len */
+            for (int32_t w = 0; w < 16; w += 8) {
+                rv64_sp_mem(code, rv_ld, RV_T0, body->slot_offset[arg_slot] + w);
+                rv64_sp_mem(code, rv_sd, RV_T0, off_dst + poff + w);
+            }
         }
     } else if (kind == BODY_OP_MAKE_COMPOSITE) {
         for (int32_t i = 0; i < body->slot_size[dst]; i += 8) {
-            code_emit(code, rv_sd(RV_ZERO, RV_SP, (int16_t)(off_dst + i)));
+            rv64_sp_mem(code, rv_sd, RV_ZERO, off_dst + i);
         }
-        for (int32_t fi = 0; fi < c; fi++) {
-            int32_t src = body->call_arg_slot[b + fi];
-            int32_t poff = body->call_arg_offset[b + fi];
-            code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[src]));
-            code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)(off_dst + poff)));
-        }
-    /* Seq / Array */
-    } else if (kind == BODY_OP_SEQ_I32_INDEX_DYNAMIC ||
-               kind == BODY_OP_ARRAY_I32_INDEX_DYNAMIC) {
-        code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)(body->slot_offset[a] + 8)));
-        code_emit(code, rv_lw(RV_T1, RV_SP, (int16_t)body->slot_offset[b]));
-        code_emit(code, rv_slliw(RV_T1, RV_T1, 2));
-        code_emit(code, rv_add(RV_T0, RV_T0, RV_T1));
+        for (int32_t fi = 0; fi < c; fi++)
+            rv64_store_slot_to_payload(code, body, dst, body->call_arg_offset[b + fi],
+                                       body->call_arg_slot[b + fi]);
+    /* Seq / Array: an index traps unless 0 <= index < length */
+    } else if (kind == BODY_OP_ARRAY_I32_INDEX_DYNAMIC) {
+        bool byte_elems = codegen_slot_is_uint8_fixed_array(body, a);
+        if (body->slot_aux[a] <= 0) {
+            rv64_sp_mem(code, rv_sw, RV_ZERO, off_dst);
+            return;
+        }
+        rv64_sp_mem(code, rv_lw, RV_T1, body->slot_offset[b]);
+        rv64_li(code, RV_T2, body->slot_aux[a]);
+        rv64_bounds_trap(code, RV_T1, RV_T2);
+        rv64_addi_large(code, RV_T0, RV_SP, body->slot_offset[a]);
+        rv64_scaled_add(code, RV_T0, RV_T0, RV_T1, byte_elems ? 1 : 4);
+        code_emit(code, byte_elems ? rv_lbu(RV_T0, RV_T0, 0) : rv_lw(RV_T0, RV_T0, 0));
+        rv64_sp_mem(code, rv_sw, RV_T0, off_dst);
+    } else if (kind == BODY_OP_SEQ_I32_INDEX_DYNAMIC) {
+        rv64_sp_mem(code, rv_lw, RV_T1, body->slot_offset[b]);
+        if (body->slot_kind[a] == SLOT_ARRAY_I32) {
+            /* inline array: data at sp + offset, length from slot_aux or its size */
+            int32_t len = body->slot_aux[a] > 0 ? body->slot_aux[a] : body->slot_size[a] / 4;
+            rv64_li(code, RV_T2, len);
+            rv64_bounds_trap(code, RV_T1, RV_T2);
+            rv64_addi_large(code, RV_T0, RV_SP, body->slot_offset[a]);
+        } else {
+            rv64_seq_header_addr(code, body, a, RV_T0);
+            if (checked) {
+                code_emit(code, rv_lw(RV_T2, RV_T0, 0));
+                rv64_bounds_trap(code, RV_T1, RV_T2);
+            }
+            code_emit(code, rv_ld(RV_T0, RV_T0, 8));
+        }
+        rv64_scaled_add(code, RV_T0, RV_T0, RV_T1, 4);
         code_emit(code, rv_lw(RV_T0, RV_T0, 0));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
+        rv64_sp_mem(code, rv_sw, RV_T0, off_dst);
     } else if (kind == BODY_OP_ARRAY_I32_INDEX_STORE) {
-        code_emit(code, rv_lw(RV_T1, RV_SP, (int16_t)body->slot_offset[b]));
-        code_emit(code, rv_slliw(RV_T1, RV_T1, 2));
-        code_emit(code, rv_lw(RV_T2, RV_SP, (int16_t)body->slot_offset[dst]));
-        code_emit(code, rv_addi(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_add(RV_T0, RV_T0, RV_T1));
-        code_emit(code, rv_sw(RV_T2, RV_T0, 0));
+        int32_t base_kind = body->slot_kind[a];
+        bool byte_elems = codegen_slot_is_uint8_fixed_array(body, a);
+        rv64_sp_mem(code, rv_lw, RV_T1, body->slot_offset[b]);
+        if (base_kind == SLOT_OBJECT_REF && body->slot_aux[a] <= 0) {
+            /* a field array behind a ref with no recorded length: sign check only */
+            code_emit(code, rv_bge(RV_T1, RV_ZERO, 8));
+            code_emit(code, rv_ebreak());
+        } else {
+            /* other base kinds come from the CSG lowerer and always trap */
+            int32_t len = base_kind == SLOT_OBJECT_REF || base_kind == SLOT_ARRAY_I32 ? body->slot_aux[a] : 0;
+            rv64_li(code, RV_T2, len);
+            rv64_bounds_trap(code, RV_T1, RV_T2);
+        }
+        if (base_kind == SLOT_OBJECT_REF) rv64_sp_mem(code, rv_ld, RV_T0, body->slot_offset[a]);
+        else rv64_addi_large(code, RV_T0, RV_SP, body->slot_offset[a]);
+        rv64_scaled_add(code, RV_T0, RV_T0, RV_T1, byte_elems ? 1 : 4);
+        rv64_sp_mem(code, rv_lw, RV_T2, body->slot_offset[dst]);
+        code_emit(code, byte_elems ? rv_sb(RV_T2, RV_T0, 0) : rv_sw(RV_T2, RV_T0, 0));
     } else if (kind == BODY_OP_SEQ_I32_INDEX_STORE) {
-        code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)(body->slot_offset[a] + 8)));
-        code_emit(code, rv_lw(RV_T1, RV_SP, (int16_t)body->slot_offset[b]));
-        code_emit(code, rv_slliw(RV_T1, RV_T1, 2));
-        code_emit(code, rv_add(RV_T0, RV_T0, RV_T1));
-        code_emit(code, rv_lw(RV_T1, RV_SP, (int16_t)body->slot_offset[dst]));
-        code_emit(code, rv_sw(RV_T1, RV_T0, 0));
+        int32_t base_kind = body->slot_kind[a];
+        if (base_kind != SLOT_OBJECT_REF && base_kind != SLOT_SEQ_I32 && base_kind != SLOT_SEQ_I32_REF)
+            die("int32[] index store target kind mismatch");
+        rv64_seq_header_addr(code, body, a, RV_T0);
+        rv64_sp_mem(code, rv_lw, RV_T1, body->slot_offset[b]);
+        if (checked) {
+            code_emit(code, rv_lw(RV_T2, RV_T0, 0));
+            rv64_bounds_trap(code, RV_T1, RV_T2);
+        }
+        code_emit(code, rv_ld(RV_T0, RV_T0, 8));
+        rv64_scaled_add(code, RV_T0, RV_T0, RV_T1, 4);
+        rv64_sp_mem(code, rv_lw, RV_T2, body->slot_offset[dst]);
+        code_emit(code, rv_sw(RV_T2, RV_T0, 0));
     /* Closure */
     } else if (kind == BODY_OP_CLOSURE_NEW) {
-        code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)off_dst));
-        code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[b]));
-        code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)(off_dst + 8)));
+        rv64_sp_mem(code, rv_ld, RV_T0, body->slot_offset[a]);
+        rv64_sp_mem(code, rv_sd, RV_T0, off_dst);
+        rv64_sp_mem(code, rv_ld, RV_T0, body->slot_offset[b]);
+        rv64_sp_mem(code, rv_sd, RV_T0, off_dst + 8);
     } else if (kind == BODY_OP_CLOSURE_CALL) {
-        code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
+        rv64_sp_mem(code, rv_ld, RV_T0, body->slot_offset[a]);
         code_emit(code, rv_jalr(RV_RA, RV_T0, 0));
-        code_emit(code, rv_sw(RV_A0, RV_SP, (int16_t)off_dst));
+        rv64_store_call_result(code, body, dst);
     /* Atomic */
     } else if (kind == BODY_OP_ATOMIC_LOAD_I32) {
-        code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_lr_w(RV_T0, RV_T0));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
+        rv64_sp_mem(code, rv_ld, RV_T0, body->slot_offset[a]);
+        code_emit(code, rv_lw(RV_T0, RV_T0, 0));
+        code_emit(code, rv_fence());
+        rv64_sp_mem(code, rv_sw, RV_T0, off_dst);
     } else if (kind == BODY_OP_ATOMIC_STORE_I32) {
-        code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[dst]));
-        code_emit(code, rv_lw(RV_T1, RV_SP, (int16_t)body->slot_offset[a]));
-        /* amoswap.w for atomic store */
+        rv64_sp_mem(code, rv_ld, RV_T0, body->slot_offset[dst]);
+        rv64_sp_mem(code, rv_lw, RV_T1, body->slot_offset[a]);
         code_emit(code, rv_amoswap_w(RV_ZERO, RV_T0, RV_T1));
     } else if (kind == BODY_OP_ATOMIC_CAS_I32) {
-        code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_lw(RV_T1, RV_SP, (int16_t)body->slot_offset[c])); /* expected */
-        code_emit(code, rv_lw(RV_T2, RV_SP, (int16_t)body->slot_offset[b])); /* desired */
+        /* lr/sc loop; dst = 1 when *ptr held the expected value */
+        rv64_sp_mem(code, rv_ld, RV_T0, body->slot_offset[a]);  /* ptr */
+        rv64_sp_mem(code, rv_lw, RV_T1, body->slot_offset[c]);  /* expected */
+        rv64_sp_mem(code, rv_lw, RV_T2, body->slot_offset[b]);  /* desired */
         int32_t retry = code->count;
         code_emit(code, rv_lr_w(RV_T3, RV_T0));
-        code_emit(code, rv_bne(RV_T3, RV_T1, 8)); /* skip if not equal */
-        code_emit(code, rv_sc_w(RV_T3, RV_T0, RV_T2));
-        code_emit(code, rv_bne(RV_T3, RV_ZERO, (int16_t)(retry - code->count)));
-        code_emit(code, rv_sltiu(RV_T0, RV_T3, 1)); /* success=1 if SC succeeded */
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
+        int32_t mismatch = code->count;
+        code_emit(code, rv_bne(RV_T3, RV_T1, 0));
+        code_emit(code, rv_sc_w(RV_T4, RV_T0, RV_T2));
+        code_emit(code, rv_bne(RV_T4, RV_ZERO, (int16_t)((retry - code->count) * 4)));
+        rv64_patch(code, mismatch, code->count);
+        code_emit(code, rv_xor(RV_T3, RV_T3, RV_T1));
+        code_emit(code, rv_sltiu(RV_T0, RV_T3, 1));
+        rv64_sp_mem(code, rv_sw, RV_T0, off_dst);
     } else if (kind == BODY_OP_ATOMIC_ADD_I32) {
-        /* LR/SC loop: atomic add */
-        code_emit(code, rv_lw(RV_T0, RV_SP, (int16_t)body->slot_offset[a])); /* ptr */
-        code_emit(code, rv_lw(RV_T1, RV_SP, (int16_t)body->slot_offset[b])); /* delta */
-        int32_t rv_add_loop = code->count;
-        code_emit(code, rv_lr_w(RV_T2, RV_T0));                /* t2 = *ptr */
-        code_emit(code, rv_add(RV_T3, RV_T2, RV_T1));          /* t3 = t2 + delta */
-        code_emit(code, rv_sc_w(RV_T4, RV_T0, RV_T3));         /* try SC */
-        code_emit(code, rv_bne(RV_T4, RV_ZERO, (int16_t)(rv_add_loop - code->count)));
-        code_emit(code, rv_sw(RV_T3, RV_SP, (int16_t)off_dst)); /* store new value */
+        /* lr/sc loop; dst = the new value */
+        rv64_sp_mem(code, rv_ld, RV_T0, body->slot_offset[a]);  /* ptr */
+        rv64_sp_mem(code, rv_lw, RV_T1, body->slot_offset[b]);  /* delta */
+        int32_t retry = code->count;
+        code_emit(code, rv_lr_w(RV_T2, RV_T0));
+        code_emit(code, rv_addw(RV_T3, RV_T2, RV_T1));
+        code_emit(code, rv_sc_w(RV_T4, RV_T0, RV_T3));
+        code_emit(code, rv_bne(RV_T4, RV_ZERO, (int16_t)((retry - code->count) * 4)));
+        rv64_sp_mem(code, rv_sw, RV_T3, off_dst);
     /* Syscall / OS */
     } else if (kind == BODY_OP_EXIT) {
-        code_emit(code, rv_lw(RV_A0, RV_SP, (int16_t)body->slot_offset[a]));
-        rv_li(code->words, &code->count, RV_A7, 93); /* sys_exit */
+        rv64_sp_mem(code, rv_lw, RV_A0, body->slot_offset[a]);
+        if (cold_profile.flush_pos >= 0) {
+            function_patches_add_kind(patches, code->count, -1, FUNCTION_PATCH_PROFILE_FLUSH);
+            code_emit(code, rv_jal(RV_RA, 0));
+        }
+        rv64_li(code, RV_A7, 93); /* sys_exit */
         code_emit(code, rv_ecall());
+        code_emit(code, rv_ebreak());
     } else if (kind == BODY_OP_WRITE_LINE) {
-        code_emit(code, rv_lw(RV_A0, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_ld(RV_A1, RV_SP, (int16_t)body->slot_offset[b]));
-        code_emit(code, rv_lw(RV_A2, RV_SP, (int16_t)(body->slot_offset[b] + 8)));
-        rv_li(code->words, &code->count, RV_A7, 64); /* sys_write */
+        /* write(fd, str), then the newline through the dst slot */
+        int32_t fd_kind = body->slot_kind[a], str_kind = body->slot_kind[b];
+        if ((fd_kind != SLOT_I32 && fd_kind != SLOT_OPAQUE) ||
+            (str_kind != SLOT_STR && str_kind != SLOT_STR_REF)) return;
+        rv64_sp_mem(code, fd_kind == SLOT_OPAQUE ? rv_ld : rv_lw, RV_T2, body->slot_offset[a]);
+        rv64_load_str(code, body, b, RV_A1, RV_A2);
+        code_emit(code, rv_addi(RV_A0, RV_T2, 0));
+        rv64_li(code, RV_A7, 64); /* sys_write */
+        code_emit(code, rv_ecall());
+        code_emit(code, rv_addi(RV_T0, RV_ZERO, '\n'));
+        rv64_sp_mem(code, rv_sb, RV_T0, off_dst);
+        code_emit(code, rv_addi(RV_A0, RV_T2, 0));
+        rv64_addi_large(code, RV_A1, RV_SP, off_dst);
+        code_emit(code, rv_addi(RV_A2, RV_ZERO, 1));
         code_emit(code, rv_ecall());
+        rv64_sp_mem(code, rv_sw, RV_ZERO, off_dst);
     } else if (kind == BODY_OP_BRK) {
         code_emit(code, rv_ebreak());
     } else if (kind == BODY_OP_ARGC_LOAD) {
-        code_emit(code, rv_addi(RV_T0, RV_S0, 0));                /* t0 = s0 = argc (trampoline) */
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
-    } else if (kind == BODY_OP_LOAD_I32) {
-        code_emit(code, rv_sw(RV_ZERO, RV_SP, (int16_t)off_dst));
+        rv64_sp_mem(code, rv_sw, RV_S0, off_dst); /* s0 = argc (entry trampoline) */
     } else if (kind == BODY_OP_UNWRAP_OR_RETURN) {
-        code_emit(code, rv_lw(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-        rv_li(code->words, &code->count, RV_T1, (int32_t)b);
-        code_emit(code, rv_bne(RV_T0, RV_T1, 0)); /* patched to after ebreak */
+        /* trap unless the tag matches */
+        rv64_sp_mem(code, rv_lw, RV_T0, body->slot_offset[a]);
+        rv64_li(code, RV_T1, b);
+        code_emit(code, rv_beq(RV_T0, RV_T1, 8));
         code_emit(code, rv_ebreak());
     } else if (kind == BODY_OP_TEXT_SET_INIT) {
-        code_emit(code, rv_sub(RV_T0, RV_T0, RV_T0)); /* t0 = 0 */
-        int32_t rv_tsz = body->slot_size[dst];
-        for (int32_t rv_toff = 0; rv_toff < rv_tsz; rv_toff += 8)
-            code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)(off_dst + rv_toff)));
+        rv64_zero_slot(code, body, dst);
     } else if (kind == BODY_OP_MMAP) {
-        code_emit(code, rv_add(RV_A0, RV_ZERO, RV_ZERO)); /* a0 = addr = 0 */
-        code_emit(code, rv_lw(RV_A1, RV_SP, (int16_t)body->slot_offset[a])); /* a1 = len */
-        rv_li(code->words, &code->count, RV_A2, 3);       /* a2 = PROT_READ|PROT_WRITE */
-        rv_li(code->words, &code->count, RV_A3, 0x1002);  /* a3 = flags */
-        rv_li(code->words, &code->count, RV_A4, -1);      /* a4 = fd = -1 */
-        code_emit(code, rv_add(RV_A5, RV_ZERO, RV_ZERO)); /* a5 = offset = 0 */
-        rv_li(code->words, &code->count, RV_A7, 222);     /* a7 = mmap syscall */
-        code_emit(code, rv_ecall());
-        code_emit(code, rv_sd(RV_A0, RV_SP, (int16_t)off_dst)); /* store result ptr */
+        rv64_sp_mem(code, rv_lw, RV_A1, body->slot_offset[a]);
+        rv64_mmap_a1(code);
+        rv64_sp_mem(code, rv_sd, RV_A0, off_dst);
     } else if (kind == BODY_OP_STR_SELECT_NONEMPTY) {
-        int32_t rv_bne_pos;
-        code_emit(code, rv_lw(RV_T1, RV_SP, (int16_t)(body->slot_offset[a] + 8))); /* t1 = pref len */
-        code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));       /* t0 = pref ptr */
-        rv_bne_pos = code->count;
-        code_emit(code, rv_bne(RV_T1, RV_ZERO, 0));  /* if len != 0, skip alt */
-        code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[b]));       /* t0 = alt ptr */
-        code_emit(code, rv_lw(RV_T1, RV_SP, (int16_t)(body->slot_offset[b] + 8))); /* t1 = alt len */
-        code->words[rv_bne_pos] = rv_bne(RV_T1, RV_ZERO, (int16_t)((code->count - rv_bne_pos) * 4));
-        code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)off_dst));                    /* store ptr */
-        code_emit(code, rv_sw(RV_T1, RV_SP, (int16_t)(off_dst + 8)));              /* store len */
-    /* PTR_ADD: pointer + offset (i32 or i64) */
-    } else if (kind == BODY_OP_PTR_ADD) {
-        code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-        if (body->slot_kind[b] == SLOT_I32) {
-            code_emit(code, rv_lw(RV_T1, RV_SP, (int16_t)body->slot_offset[b]));
-        } else {
-            code_emit(code, rv_ld(RV_T1, RV_SP, (int16_t)body->slot_offset[b]));
-        }
-        code_emit(code, rv_add(RV_T0, RV_T0, RV_T1));
-        code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)off_dst));
+        rv64_load_str(code, body, a, RV_T0, RV_T1);
+        int32_t keep = code->count;
+        code_emit(code, rv_bne(RV_T1, RV_ZERO, 0));
+        rv64_load_str(code, body, b, RV_T0, RV_T1);
+        rv64_patch(code, keep, code->count);
+        rv64_store_str(code, off_dst, RV_T0, RV_T1);
     } else if (kind == BODY_OP_THREAD_YIELD) {
-        rv_li(code->words, &code->count, RV_A7, 331); /* sched_yield */
+        rv64_li(code, RV_A7, 124); /* sched_yield */
         code_emit(code, rv_ecall());
-        code_emit(code, rv_sw(RV_ZERO, RV_SP, (int16_t)off_dst));
+        rv64_sp_mem(code, rv_sw, RV_ZERO, off_dst);
     } else if (kind == BODY_OP_SEQ_I32_INDEX) {
-        code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)(body->slot_offset[a] + 8)));
-        code_emit(code, rv_lw(RV_T0, RV_T0, (int16_t)(b * 4)));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
+        rv64_sp_mem(code, rv_ld, RV_T0, body->slot_offset[a] + 8);
+        rv64_addi_large(code, RV_T0, RV_T0, b * 4);
+        code_emit(code, rv_lw(RV_T0, RV_T0, 0));
+        rv64_sp_mem(code, rv_sw, RV_T0, off_dst);
     } else if (kind == BODY_OP_PATH_IS_ABSOLUTE) {
-        code_emit(code, rv_lw(RV_T1, RV_SP, (int16_t)(body->slot_offset[a] + 8)));
-        code_emit(code, rv_sw(RV_ZERO, RV_SP, (int16_t)off_dst));
+        rv64_sp_mem(code, rv_lw, RV_T1, body->slot_offset[a] + 8);
+        rv64_sp_mem(code, rv_sw, RV_ZERO, off_dst);
         int32_t rv_abs_empty = code->count;
         code_emit(code, rv_beq(RV_T1, RV_ZERO, 0));
-        code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
+        rv64_sp_mem(code, rv_ld, RV_T0, body->slot_offset[a]);
         code_emit(code, rv_lbu(RV_T0, RV_T0, 0));
-        rv_li(code->words, &code->count, RV_T2, '/');
+        rv64_li(code, RV_T2, '/');
         int32_t rv_abs_not = code->count;
         code_emit(code, rv_bne(RV_T0, RV_T2, 0));
         code_emit(code, rv_addi(RV_T0, RV_ZERO, 1));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
+        rv64_sp_mem(code, rv_sw, RV_T0, off_dst);
         int32_t rv_abs_done = code->count;
         code->words[rv_abs_empty] = rv_beq(RV_T1, RV_ZERO, (int16_t)((rv_abs_done - rv_abs_empty) * 4));
         code->words[rv_abs_not] = rv_bne(RV_T0, RV_T2, (int16_t)((rv_abs_done - rv_abs_not) * 4));
     } else if (kind == BODY_OP_SELECT) {
-        code_emit(code, rv_lw(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-        int32_t rv_sel_else = code->count;
+        rv64_sp_mem(code, rv_lw, RV_T0, body->slot_offset[a]);
+        int32_t on_false = code->count;
         code_emit(code, rv_beq(RV_T0, RV_ZERO, 0));
-        { int32_t rv_sel_sz = body->slot_size[dst], rv_sel_so = body->slot_offset[b];
-          for (int32_t rv_off = 0; rv_off < rv_sel_sz; rv_off += 8) {
-              code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)(rv_sel_so + rv_off)));
-              code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)(off_dst + rv_off))); } }
-        int32_t rv_sel_end = code->count;
+        rv64_copy_stack_slot(code, body, dst, b);
+        int32_t done = code->count;
         code_emit(code, rv_jal(RV_ZERO, 0));
-        { int32_t rv_sel_sz = body->slot_size[dst], rv_sel_eo = body->slot_offset[c];
-          for (int32_t rv_off = 0; rv_off < rv_sel_sz; rv_off += 8) {
-              code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)(rv_sel_eo + rv_off)));
-              code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)(off_dst + rv_off))); } }
-        code->words[rv_sel_else] = rv_beq(RV_T0, RV_ZERO, (int16_t)((rv_sel_end + 1 - rv_sel_else) * 4));
-        code->words[rv_sel_end] = rv_jal(RV_ZERO, (int32_t)((code->count - rv_sel_end) * 4));
+        rv64_patch(code, on_false, code->count);
+        rv64_copy_stack_slot(code, body, dst, c);
+        rv64_patch(code, done, code->count);
     } else if (kind == BODY_OP_WRITE_RAW) {
-        code_emit(code, rv_lw(RV_A0, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_ld(RV_A1, RV_SP, (int16_t)body->slot_offset[b]));
-        code_emit(code, rv_lw(RV_A2, RV_SP, (int16_t)body->slot_offset[c]));
-        rv_li(code->words, &code->count, RV_A7, 64); /* sys_write */
+        rv64_sp_mem(code, rv_lw, RV_A0, body->slot_offset[a]);
+        rv64_sp_mem(code, rv_ld, RV_A1, body->slot_offset[b]);
+        rv64_sp_mem(code, rv_lw, RV_A2, body->slot_offset[c]);
+        rv64_li(code, RV_A7, 64); /* sys_write */
         code_emit(code, rv_ecall());
-        code_emit(code, rv_sw(RV_A0, RV_SP, (int16_t)off_dst));
+        rv64_sp_mem(code, rv_sw, RV_A0, off_dst);
     } else if (kind == BODY_OP_WRITE_BYTES) {
-        code_emit(code, rv_lw(RV_A0, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_addi(RV_A1, RV_SP, (int16_t)body->slot_offset[b]));
-        code_emit(code, rv_lw(RV_A2, RV_SP, (int16_t)body->slot_offset[c]));
-        rv_li(code->words, &code->count, RV_A7, 64); /* sys_write */
+        rv64_sp_mem(code, rv_lw, RV_A0, body->slot_offset[a]);
+        rv64_addi_large(code, RV_A1, RV_SP, body->slot_offset[b]);
+        rv64_sp_mem(code, rv_lw, RV_A2, body->slot_offset[c]);
+        rv64_li(code, RV_A7, 64); /* sys_write */
         code_emit(code, rv_ecall());
-        code_emit(code, rv_sw(RV_A0, RV_SP, (int16_t)off_dst));
+        rv64_sp_mem(code, rv_sw, RV_A0, off_dst);
     } else if (kind == BODY_OP_ASSERT) {
         if (body->slot_kind[a] == SLOT_I32_REF) {
-            code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
+            rv64_sp_mem(code, rv_ld, RV_T0, body->slot_offset[a]);
             code_emit(code, rv_lw(RV_T0, RV_T0, 0));
         } else {
-            code_emit(code, rv_lw(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
+            rv64_sp_mem(code, rv_lw, RV_T0, body->slot_offset[a]);
         }
         int32_t rv_as_ok = code->count;
         code_emit(code, rv_bne(RV_T0, RV_ZERO, 0));
         if (body->slot_kind[b] == SLOT_STR_REF) {
-            code_emit(code, rv_ld(RV_T1, RV_SP, (int16_t)body->slot_offset[b]));
+            rv64_sp_mem(code, rv_ld, RV_T1, body->slot_offset[b]);
             code_emit(code, rv_ld(RV_A1, RV_T1, 0));
             code_emit(code, rv_lw(RV_A2, RV_T1, 8));
         } else {
-            code_emit(code, rv_ld(RV_A1, RV_SP, (int16_t)body->slot_offset[b]));
-            code_emit(code, rv_lw(RV_A2, RV_SP, (int16_t)(body->slot_offset[b] + 8)));
+            rv64_sp_mem(code, rv_ld, RV_A1, body->slot_offset[b]);
+            rv64_sp_mem(code, rv_lw, RV_A2, body->slot_offset[b] + 8);
         }
-        rv_li(code->words, &code->count, RV_A0, 2);
-        rv_li(code->words, &code->count, RV_A7, 64);
+        rv64_li(code, RV_A0, 2);
+        rv64_li(code, RV_A7, 64);
         code_emit(code, rv_ecall());
-        rv_li(code->words, &code->count, RV_A0, 2);
+        rv64_li(code, RV_A0, 2);
         code_emit(code, rv_addi(RV_T0, RV_ZERO, '\n'));
-        code_emit(code, rv_sb(RV_T0, RV_SP, (int16_t)off_dst));
-        code_emit(code, rv_addi(RV_A1, RV_SP, (int16_t)off_dst));
-        rv_li(code->words, &code->count, RV_A2, 1);
-        rv_li(code->words, &code->count, RV_A7, 64);
+        rv64_sp_mem(code, rv_sb, RV_T0, off_dst);
+        rv64_addi_large(code, RV_A1, RV_SP, off_dst);
+        rv64_li(code, RV_A2, 1);
+        rv64_li(code, RV_A7, 64);
         code_emit(code, rv_ecall());
-        rv_li(code->words, &code->count, RV_A0, 1);
-        rv_li(code->words, &code->count, RV_A7, 93); /* sys_exit */
+        rv64_li(code, RV_A0, 1);
+        rv64_li(code, RV_A7, 93); /* sys_exit */
         code_emit(code, rv_ecall());
         code->words[rv_as_ok] = rv_bne(RV_T0, RV_ZERO, (int16_t)((code->count - rv_as_ok) * 4));
-        code_emit(code, rv_sw(RV_ZERO, RV_SP, (int16_t)off_dst));
+        rv64_sp_mem(code, rv_sw, RV_ZERO, off_dst);
     } else if (kind == BODY_OP_COPY_RAW) {
-        code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_ld(RV_T1, RV_SP, (int16_t)body->slot_offset[b]));
+        rv64_sp_mem(code, rv_ld, RV_T0, body->slot_offset[a]);
+        rv64_sp_mem(code, rv_ld, RV_T1, body->slot_offset[b]);
         if (body->slot_kind[c] == SLOT_I32) {
-            code_emit(code, rv_lw(RV_T2, RV_SP, (int16_t)body->slot_offset[c]));
+            rv64_sp_mem(code, rv_lw, RV_T2, body->slot_offset[c]);
         } else {
-            code_emit(code, rv_ld(RV_T2, RV_SP, (int16_t)body->slot_offset[c]));
+            rv64_sp_mem(code, rv_ld, RV_T2, body->slot_offset[c]);
         }
         int32_t rv_cp_loop = code->count;
         code_emit(code, rv_beq(RV_T2, RV_ZERO, 0));
@@ -13822,18 +16967,18 @@ static void rv64_codegen_op(Code *code, BodyIR *body, Symbols *symbols,
         code_emit(code, rv_addi(RV_T2, RV_T2, -1));
         code_emit(code, rv_jal(RV_ZERO, (int32_t)((rv_cp_loop - code->count) * 4)));
         code->words[rv_cp_loop] = rv_beq(RV_T2, RV_ZERO, (int16_t)((code->count - rv_cp_loop) * 4));
-        code_emit(code, rv_sw(RV_ZERO, RV_SP, (int16_t)off_dst));
+        rv64_sp_mem(code, rv_sw, RV_ZERO, off_dst);
     } else if (kind == BODY_OP_SET_RAW) {
-        code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
+        rv64_sp_mem(code, rv_ld, RV_T0, body->slot_offset[a]);
         if (body->slot_kind[b] == SLOT_I32) {
-            code_emit(code, rv_lw(RV_T1, RV_SP, (int16_t)body->slot_offset[b]));
+            rv64_sp_mem(code, rv_lw, RV_T1, body->slot_offset[b]);
         } else {
-            code_emit(code, rv_ld(RV_T1, RV_SP, (int16_t)body->slot_offset[b]));
+            rv64_sp_mem(code, rv_ld, RV_T1, body->slot_offset[b]);
         }
         if (body->slot_kind[c] == SLOT_I32) {
-            code_emit(code, rv_lw(RV_T2, RV_SP, (int16_t)body->slot_offset[c]));
+            rv64_sp_mem(code, rv_lw, RV_T2, body->slot_offset[c]);
         } else {
-            code_emit(code, rv_ld(RV_T2, RV_SP, (int16_t)body->slot_offset[c]));
+            rv64_sp_mem(code, rv_ld, RV_T2, body->slot_offset[c]);
         }
         int32_t rv_st_loop = code->count;
         code_emit(code, rv_beq(RV_T2, RV_ZERO, 0));
@@ -13842,137 +16987,106 @@ static void rv64_codegen_op(Code *code, BodyIR *body, Symbols *symbols,
         code_emit(code, rv_addi(RV_T2, RV_T2, -1));
         code_emit(code, rv_jal(RV_ZERO, (int32_t)((rv_st_loop - code->count) * 4)));
         code->words[rv_st_loop] = rv_beq(RV_T2, RV_ZERO, (int16_t)((code->count - rv_st_loop) * 4));
-        code_emit(code, rv_sw(RV_ZERO, RV_SP, (int16_t)off_dst));
+        rv64_sp_mem(code, rv_sw, RV_ZERO, off_dst);
     } else if (kind == BODY_OP_HEAP_ALLOC) {
-        code_emit(code, rv_add(RV_A0, RV_ZERO, RV_ZERO));
-        if (body->slot_kind[a] == SLOT_I32) {
-            code_emit(code, rv_lw(RV_A1, RV_SP, (int16_t)body->slot_offset[a]));
-        } else {
-            code_emit(code, rv_ld(RV_A1, RV_SP, (int16_t)body->slot_offset[a]));
-        }
-        rv_li(code->words, &code->count, RV_A2, 3);
-        rv_li(code->words, &code->count, RV_A3, 0x1002);
-        rv_li(code->words, &code->count, RV_A4, -1);
-        code_emit(code, rv_add(RV_A5, RV_ZERO, RV_ZERO));
-        rv_li(code->words, &code->count, RV_A7, 222); /* mmap */
-        code_emit(code, rv_ecall());
-        code_emit(code, rv_sd(RV_A0, RV_SP, (int16_t)off_dst));
+        rv64_sp_mem(code, body->slot_kind[a] == SLOT_I32 ? rv_lw : rv_ld, RV_A1, body->slot_offset[a]);
+        rv64_mmap_a1(code);
+        rv64_sp_mem(code, rv_sd, RV_A0, off_dst);
     } else if (kind == BODY_OP_HEAP_FREE) {
-        code_emit(code, rv_ld(RV_A0, RV_SP, (int16_t)body->slot_offset[a]));
+        rv64_sp_mem(code, rv_ld, RV_A0, body->slot_offset[a]);
         if (body->slot_kind[b] == SLOT_I32) {
-            code_emit(code, rv_lw(RV_A1, RV_SP, (int16_t)body->slot_offset[b]));
+            rv64_sp_mem(code, rv_lw, RV_A1, body->slot_offset[b]);
         } else {
-            code_emit(code, rv_ld(RV_A1, RV_SP, (int16_t)body->slot_offset[b]));
+            rv64_sp_mem(code, rv_ld, RV_A1, body->slot_offset[b]);
         }
-        rv_li(code->words, &code->count, RV_A7, 215); /* munmap */
+        rv64_li(code, RV_A7, 215); /* munmap */
         code_emit(code, rv_ecall());
-        code_emit(code, rv_sw(RV_A0, RV_SP, (int16_t)off_dst));
-    } else if (kind == BODY_OP_MAKE_SEQ_I32) {
-        for (int32_t rv_i = 0; rv_i < body->slot_size[dst]; rv_i += 8)
-            code_emit(code, rv_sd(RV_ZERO, RV_SP, (int16_t)(off_dst + rv_i)));
-    } else if (kind == BODY_OP_MAKE_SEQ_OPAQUE) {
-        for (int32_t rv_i = 0; rv_i < body->slot_size[dst]; rv_i += 8)
-            code_emit(code, rv_sd(RV_ZERO, RV_SP, (int16_t)(off_dst + rv_i)));
+        rv64_sp_mem(code, rv_sw, RV_A0, off_dst);
+    } else if (kind == BODY_OP_MAKE_SEQ_I32 || kind == BODY_OP_MAKE_SEQ_OPAQUE) {
+        rv64_zero_slot(code, body, dst);
     } else if (kind == BODY_OP_BYTES_ALLOC) {
-        for (int32_t rv_i = 0; rv_i < body->slot_size[dst]; rv_i += 8)
-            code_emit(code, rv_sd(RV_ZERO, RV_SP, (int16_t)(off_dst + rv_i)));
-        code_emit(code, rv_lw(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-        int32_t rv_ba_done = code->count;
-        code_emit(code, rv_beq(RV_T0, RV_ZERO, 0));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)(off_dst + 8)));
-        code_emit(code, rv_add(RV_A0, RV_ZERO, RV_ZERO));
-        code_emit(code, rv_add(RV_A1, RV_T0, RV_ZERO));
-        rv_li(code->words, &code->count, RV_A2, 3);
-        rv_li(code->words, &code->count, RV_A3, 0x1002);
-        rv_li(code->words, &code->count, RV_A4, -1);
-        code_emit(code, rv_add(RV_A5, RV_ZERO, RV_ZERO));
-        rv_li(code->words, &code->count, RV_A7, 222);
-        code_emit(code, rv_ecall());
-        code_emit(code, rv_sd(RV_A0, RV_SP, (int16_t)off_dst));
-        { code_emit(code, rv_lw(RV_T1, RV_SP, (int16_t)(off_dst + 8)));
-          code_emit(code, rv_add(RV_T2, RV_A0, RV_ZERO));
-          int32_t rv_ba_zero = code->count;
-          code_emit(code, rv_beq(RV_T1, RV_ZERO, 0));
-          code_emit(code, rv_sb(RV_ZERO, RV_T2, 0));
-          code_emit(code, rv_addi(RV_T2, RV_T2, 1));
-          code_emit(code, rv_addi(RV_T1, RV_T1, -1));
-          code_emit(code, rv_jal(RV_ZERO, (int32_t)((rv_ba_zero - code->count) * 4)));
-          code->words[rv_ba_zero] = rv_beq(RV_T1, RV_ZERO, (int16_t)((code->count - rv_ba_zero) * 4)); }
-        code->words[rv_ba_done] = rv_beq(RV_T0, RV_ZERO, (int16_t)((code->count - rv_ba_done) * 4));
+        /* {ptr, len}; fresh anonymous pages are already zero */
+        rv64_zero_slot(code, body, dst);
+        rv64_sp_mem(code, rv_lw, RV_A1, body->slot_offset[a]);
+        int32_t empty = code->count;
+        code_emit(code, rv_bge(RV_ZERO, RV_A1, 0));
+        rv64_sp_mem(code, rv_sw, RV_A1, off_dst + 8);
+        rv64_mmap_a1(code);
+        rv64_sp_mem(code, rv_sd, RV_A0, off_dst);
+        rv64_patch(code, empty, code->count);
     /* Close: sys_close(fd) */
     } else if (kind == BODY_OP_CLOSE) {
-        code_emit(code, rv_lw(RV_A0, RV_SP, (int16_t)body->slot_offset[a]));
-        rv_li(code->words, &code->count, RV_A7, 57); /* SYS_close */
+        rv64_sp_mem(code, rv_lw, RV_A0, body->slot_offset[a]);
+        rv64_li(code, RV_A7, 57); /* SYS_close */
         code_emit(code, rv_ecall());
-        code_emit(code, rv_sw(RV_A0, RV_SP, (int16_t)off_dst));
+        rv64_sp_mem(code, rv_sw, RV_A0, off_dst);
     /* Set seq length: store to slot+0 */
     } else if (kind == BODY_OP_SEQ_SET_LEN) {
-        code_emit(code, rv_lw(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)(off_dst)));
+        rv64_seq_set_len(code, body, dst, a, c);
     /* Open: openat(AT_FDCWD=-100, pathname, flags, mode=0644) */
     } else if (kind == BODY_OP_OPEN) {
         code_emit(code, rv_addi(RV_A0, RV_ZERO, -100));                /* AT_FDCWD */
-        code_emit(code, rv_ld(RV_A1, RV_SP, (int16_t)body->slot_offset[a]));  /* path ptr */
-        code_emit(code, rv_lw(RV_A2, RV_SP, (int16_t)body->slot_offset[b]));  /* flags */
-        rv_li(code->words, &code->count, RV_A3, 0644);                        /* mode */
-        rv_li(code->words, &code->count, RV_A7, 56);                          /* SYS_openat */
+        rv64_sp_mem(code, rv_ld, RV_A1, body->slot_offset[a]);  /* path ptr */
+        rv64_sp_mem(code, rv_lw, RV_A2, body->slot_offset[b]);  /* flags */
+        rv64_li(code, RV_A3, 0644);                        /* mode */
+        rv64_li(code, RV_A7, 56);                          /* SYS_openat */
         code_emit(code, rv_ecall());
-        code_emit(code, rv_sw(RV_A0, RV_SP, (int16_t)off_dst));               /* result */
+        rv64_sp_mem(code, rv_sw, RV_A0, off_dst);               /* result */
     /* Read: read(fd, buf, count) */
     } else if (kind == BODY_OP_READ) {
-        code_emit(code, rv_lw(RV_A0, RV_SP, (int16_t)body->slot_offset[a]));  /* fd */
-        code_emit(code, rv_ld(RV_A1, RV_SP, (int16_t)body->slot_offset[b]));  /* buf ptr */
-        code_emit(code, rv_lw(RV_A2, RV_SP, (int16_t)body->slot_offset[c]));  /* count */
-        rv_li(code->words, &code->count, RV_A7, 63);                          /* SYS_read */
+        rv64_sp_mem(code, rv_lw, RV_A0, body->slot_offset[a]);  /* fd */
+        rv64_sp_mem(code, rv_ld, RV_A1, body->slot_offset[b]);  /* buf ptr */
+        rv64_sp_mem(code, rv_lw, RV_A2, body->slot_offset[c]);  /* count */
+        rv64_li(code, RV_A7, 63);                          /* SYS_read */
         code_emit(code, rv_ecall());
-        code_emit(code, rv_sw(RV_A0, RV_SP, (int16_t)off_dst));               /* result */
+        rv64_sp_mem(code, rv_sw, RV_A0, off_dst);               /* result */
     } else if (kind == BODY_OP_REMOVE_FILE) {
         /* unlinkat(AT_FDCWD=-100, path, flags=0) -> bool */
         code_emit(code, rv_addi(RV_A0, RV_ZERO, -100));                /* AT_FDCWD */
-        code_emit(code, rv_ld(RV_A1, RV_SP, (int16_t)body->slot_offset[a]));  /* path ptr */
+        rv64_sp_mem(code, rv_ld, RV_A1, body->slot_offset[a]);  /* path ptr */
         code_emit(code, rv_addi(RV_A2, RV_ZERO, 0));                   /* flags = 0 */
-        rv_li(code->words, &code->count, RV_A7, 263);                  /* SYS_unlinkat */
+        rv64_li(code, RV_A7, 35);                   /* SYS_unlinkat */
         code_emit(code, rv_ecall());
         code_emit(code, rv_sltiu(RV_T0, RV_A0, 1));                   /* T0 = (A0==0) ? 1:0 */
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
+        rv64_sp_mem(code, rv_sw, RV_T0, off_dst);
     } else if (kind == BODY_OP_MKDIR_ONE) {
         /* mkdirat(AT_FDCWD=-100, path, mode=0755) -> bool */
         code_emit(code, rv_addi(RV_A0, RV_ZERO, -100));                /* AT_FDCWD */
-        code_emit(code, rv_ld(RV_A1, RV_SP, (int16_t)body->slot_offset[a]));  /* path ptr */
-        rv_li(code->words, &code->count, RV_A2, 0755);                /* mode */
-        rv_li(code->words, &code->count, RV_A7, 264);                  /* SYS_mkdirat */
+        rv64_sp_mem(code, rv_ld, RV_A1, body->slot_offset[a]);  /* path ptr */
+        rv64_li(code, RV_A2, 0755);                /* mode */
+        rv64_li(code, RV_A7, 34);                   /* SYS_mkdirat */
         code_emit(code, rv_ecall());
         code_emit(code, rv_sltiu(RV_T0, RV_A0, 1));                   /* T0 = (A0==0) ? 1:0 */
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
+        rv64_sp_mem(code, rv_sw, RV_T0, off_dst);
     } else if (kind == BODY_OP_CHMOD_X) {
         /* fchmodat(AT_FDCWD=-100, path, mode=0755) -> bool */
         code_emit(code, rv_addi(RV_A0, RV_ZERO, -100));                /* AT_FDCWD */
-        code_emit(code, rv_ld(RV_A1, RV_SP, (int16_t)body->slot_offset[a]));  /* path ptr */
-        rv_li(code->words, &code->count, RV_A2, 0755);                /* mode */
-        rv_li(code->words, &code->count, RV_A7, 268);                  /* SYS_fchmodat */
+        rv64_sp_mem(code, rv_ld, RV_A1, body->slot_offset[a]);  /* path ptr */
+        rv64_li(code, RV_A2, 0755);                /* mode */
+        rv64_li(code, RV_A7, 53);                   /* SYS_fchmodat */
         code_emit(code, rv_ecall());
         code_emit(code, rv_sltiu(RV_T0, RV_A0, 1));                   /* T0 = (A0==0) ? 1:0 */
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
+        rv64_sp_mem(code, rv_sw, RV_T0, off_dst);
     } else if (kind == BODY_OP_GETRUSAGE) {
         if (body->slot_kind[a] != SLOT_I32) return;
-        code_emit(code, rv_lw(RV_A0, RV_SP, (int16_t)body->slot_offset[a]));  /* who */
+        rv64_sp_mem(code, rv_lw, RV_A0, body->slot_offset[a]);  /* who */
         if (body->slot_kind[b] == SLOT_OBJECT_REF || body->slot_kind[b] == SLOT_OPAQUE_REF) {
-            code_emit(code, rv_ld(RV_A1, RV_SP, (int16_t)body->slot_offset[b]));  /* ptr from ref */
+            rv64_sp_mem(code, rv_ld, RV_A1, body->slot_offset[b]);  /* ptr from ref */
         } else if (body->slot_kind[b] == SLOT_OBJECT || body->slot_kind[b] == SLOT_OPAQUE) {
-            code_emit(code, rv_addi(RV_A1, RV_SP, (int16_t)body->slot_offset[b])); /* &object */
+            rv64_addi_large(code, RV_A1, RV_SP, body->slot_offset[b]); /* &object */
         } else {
             return;
         }
-        rv_li(code->words, &code->count, RV_A7, 165);                  /* SYS_getrusage */
+        rv64_li(code, RV_A7, 165);                  /* SYS_getrusage */
         code_emit(code, rv_ecall());
-        code_emit(code, rv_sw(RV_A0, RV_SP, (int16_t)off_dst));
+        rv64_sp_mem(code, rv_sw, RV_A0, off_dst);
     } else if (kind == BODY_OP_BYTES_GET) {
         code_emit(code, rv_addi(RV_T3, RV_ZERO, 0));                   /* default result = 0 */
-        code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));  /* ptr */
+        rv64_sp_mem(code, rv_ld, RV_T0, body->slot_offset[a]);  /* ptr */
         code_emit(code, rv_beq(RV_T0, RV_ZERO, 0));                    /* null -> done */
         int32_t bg_null = code->count - 1;
-        code_emit(code, rv_lw(RV_T1, RV_SP, (int16_t)(body->slot_offset[a] + 8)));  /* len */
-        code_emit(code, rv_lw(RV_T2, RV_SP, (int16_t)body->slot_offset[b]));        /* index */
+        rv64_sp_mem(code, rv_lw, RV_T1, body->slot_offset[a] + 8);  /* len */
+        rv64_sp_mem(code, rv_lw, RV_T2, body->slot_offset[b]);        /* index */
         code_emit(code, rv_blt(RV_T2, RV_ZERO, 0));                   /* index<0 -> done */
         int32_t bg_neg = code->count - 1;
         code_emit(code, rv_bge(RV_T2, RV_T1, 0));                     /* index>=len -> done */
@@ -13983,19 +17097,19 @@ static void rv64_codegen_op(Code *code, BodyIR *body, Symbols *symbols,
         code->words[bg_null] = rv_beq(RV_T0, RV_ZERO, (int16_t)((bg_done - bg_null) * 4));
         code->words[bg_neg] = rv_blt(RV_T2, RV_ZERO, (int16_t)((bg_done - bg_neg) * 4));
         code->words[bg_high] = rv_bge(RV_T2, RV_T1, (int16_t)((bg_done - bg_high) * 4));
-        code_emit(code, rv_sw(RV_T3, RV_SP, (int16_t)off_dst));
+        rv64_sp_mem(code, rv_sw, RV_T3, off_dst);
     } else if (kind == BODY_OP_BYTES_SET) {
         code_emit(code, rv_addi(RV_T3, RV_ZERO, 0));                   /* default result = 0 */
-        code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));  /* ptr */
+        rv64_sp_mem(code, rv_ld, RV_T0, body->slot_offset[a]);  /* ptr */
         code_emit(code, rv_beq(RV_T0, RV_ZERO, 0));                    /* null -> done */
         int32_t bs_null = code->count - 1;
-        code_emit(code, rv_lw(RV_T1, RV_SP, (int16_t)(body->slot_offset[a] + 8)));  /* len */
-        code_emit(code, rv_lw(RV_T2, RV_SP, (int16_t)body->slot_offset[b]));        /* index */
+        rv64_sp_mem(code, rv_lw, RV_T1, body->slot_offset[a] + 8);  /* len */
+        rv64_sp_mem(code, rv_lw, RV_T2, body->slot_offset[b]);        /* index */
         code_emit(code, rv_blt(RV_T2, RV_ZERO, 0));                   /* index<0 -> done */
         int32_t bs_neg = code->count - 1;
         code_emit(code, rv_bge(RV_T2, RV_T1, 0));                     /* index>=len -> done */
         int32_t bs_high = code->count - 1;
-        code_emit(code, rv_lw(RV_T4, RV_SP, (int16_t)body->slot_offset[c]));        /* value */
+        rv64_sp_mem(code, rv_lw, RV_T4, body->slot_offset[c]);        /* value */
         code_emit(code, rv_add(RV_T5, RV_T0, RV_T2));                 /* addr = ptr + index */
         code_emit(code, rv_sb(RV_T4, RV_T5, 0));                       /* store byte */
         code_emit(code, rv_addi(RV_T3, RV_ZERO, 1));                  /* result = 1 (success) */
@@ -14003,179 +17117,36 @@ static void rv64_codegen_op(Code *code, BodyIR *body, Symbols *symbols,
         code->words[bs_null] = rv_beq(RV_T0, RV_ZERO, (int16_t)((bs_done - bs_null) * 4));
         code->words[bs_neg] = rv_blt(RV_T2, RV_ZERO, (int16_t)((bs_done - bs_neg) * 4));
         code->words[bs_high] = rv_bge(RV_T2, RV_T1, (int16_t)((bs_done - bs_high) * 4));
-        code_emit(code, rv_sw(RV_T3, RV_SP, (int16_t)off_dst));
-    } else if (kind == BODY_OP_STR_INDEX) {
-        /* STR_INDEX: str[index] -> byte (i32) */
-        if (body->slot_kind[a] == SLOT_STR_REF) {
-            code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-            code_emit(code, rv_ld(RV_T1, RV_T0, 0));
-            code_emit(code, rv_lw(RV_T2, RV_T0, 8));
-        } else {
-            code_emit(code, rv_ld(RV_T1, RV_SP, (int16_t)body->slot_offset[a]));
-            code_emit(code, rv_lw(RV_T2, RV_SP, (int16_t)(body->slot_offset[a] + 8)));
-        }
-        code_emit(code, rv_lw(RV_T3, RV_SP, (int16_t)body->slot_offset[b]));
-        /* index < 0 -> trap */
-        code_emit(code, rv_bge(RV_T3, RV_ZERO, 0));
-        int32_t rv_si_neg = code->count - 1;
-        code_emit(code, rv_ebreak());
-        int32_t rv_si_neg_done = code->count;
-        /* index >= len -> trap */
-        code_emit(code, rv_blt(RV_T3, RV_T2, 0));
-        int32_t rv_si_high = code->count - 1;
-        code_emit(code, rv_ebreak());
-        int32_t rv_si_high_done = code->count;
-        code_emit(code, rv_add(RV_T0, RV_T1, RV_T3));
-        code_emit(code, rv_lbu(RV_T0, RV_T0, 0));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
-        code->words[rv_si_neg] = rv_bge(RV_T3, RV_ZERO, (int16_t)((rv_si_neg_done - rv_si_neg) * 4));
-        code->words[rv_si_high] = rv_blt(RV_T3, RV_T2, (int16_t)((rv_si_high_done - rv_si_high) * 4));
-    } else if (kind == BODY_OP_I64_TO_STR) {
-        /* I64_TO_STR: i64 -> COLD_STR decimal */
-        if (body->slot_kind[a] == SLOT_I64) {
-            code_emit(code, rv_add(RV_A0, RV_ZERO, RV_ZERO));
-            rv_li(code->words, &code->count, RV_A1, 32);
-            rv_li(code->words, &code->count, RV_A2, 3);
-            rv_li(code->words, &code->count, RV_A3, 0x1002);
-            rv_li(code->words, &code->count, RV_A4, -1);
-            code_emit(code, rv_add(RV_A5, RV_ZERO, RV_ZERO));
-            rv_li(code->words, &code->count, RV_A7, 222);
-            code_emit(code, rv_ecall());
-            code_emit(code, rv_sd(RV_A0, RV_SP, (int16_t)body->slot_offset[dst]));
-            code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-            /* zero case */
-            code_emit(code, rv_bne(RV_T0, RV_ZERO, 0));
-            int32_t rv_i64_nz = code->count - 1;
-            rv_li(code->words, &code->count, RV_T1, '0');
-            code_emit(code, rv_sb(RV_T1, RV_A0, 0));
-            rv_li(code->words, &code->count, RV_T1, 1);
-            code_emit(code, rv_sw(RV_T1, RV_SP, (int16_t)(body->slot_offset[dst] + 8)));
-            code_emit(code, rv_jal(RV_ZERO, 0));
-            int32_t rv_i64_zdone = code->count - 1;
-            int32_t rv_i64_nz_target = code->count;
-            code->words[rv_i64_nz] = rv_bne(RV_T0, RV_ZERO, (int16_t)((rv_i64_nz_target - rv_i64_nz) * 4));
-            code_emit(code, rv_addi(RV_T2, RV_A0, 31));
-            code_emit(code, rv_add(RV_T3, RV_ZERO, RV_ZERO));
-            code_emit(code, rv_add(RV_T5, RV_ZERO, RV_ZERO));
-            /* sign check */
-            code_emit(code, rv_bge(RV_T0, RV_ZERO, 0));
-            int32_t rv_i64_pos = code->count - 1;
-            rv_li(code->words, &code->count, RV_T5, 1);
-            code_emit(code, rv_sub(RV_T0, RV_ZERO, RV_T0));
-            int32_t rv_i64_pos_target = code->count;
-            code->words[rv_i64_pos] = rv_bge(RV_T0, RV_ZERO, (int16_t)((rv_i64_pos_target - rv_i64_pos) * 4));
-            /* digit loop */
-            rv_li(code->words, &code->count, RV_T4, 10);
-            int32_t rv_i64_dloop = code->count;
-            code_emit(code, rv_div(RV_T1, RV_T0, RV_T4));
-            code_emit(code, rv_rem(RV_T6, RV_T0, RV_T4));
-            code_emit(code, rv_addi(RV_T6, RV_T6, 48));
-            code_emit(code, rv_sb(RV_T6, RV_T2, 0));
-            code_emit(code, rv_addi(RV_T2, RV_T2, -1));
-            code_emit(code, rv_addi(RV_T3, RV_T3, 1));
-            code_emit(code, rv_addi(RV_T0, RV_T1, 0));
-            code_emit(code, rv_bne(RV_T0, RV_ZERO, 0));
-            int32_t rv_i64_dloop_end = code->count - 1;
-            code->words[rv_i64_dloop_end] = rv_bne(RV_T0, RV_ZERO, (int16_t)((rv_i64_dloop - rv_i64_dloop_end) * 4));
-            /* sign */
-            code_emit(code, rv_beq(RV_T5, RV_ZERO, 0));
-            int32_t rv_i64_nosign = code->count - 1;
-            rv_li(code->words, &code->count, RV_T6, '-');
-            code_emit(code, rv_sb(RV_T6, RV_T2, 0));
-            code_emit(code, rv_addi(RV_T2, RV_T2, -1));
-            code_emit(code, rv_addi(RV_T3, RV_T3, 1));
-            int32_t rv_i64_nosign_target = code->count;
-            code->words[rv_i64_nosign] = rv_beq(RV_T5, RV_ZERO, (int16_t)((rv_i64_nosign_target - rv_i64_nosign) * 4));
-            /* store final ptr and len */
-            code_emit(code, rv_addi(RV_T2, RV_T2, 1));
-            code_emit(code, rv_sd(RV_T2, RV_SP, (int16_t)body->slot_offset[dst]));
-            code_emit(code, rv_sw(RV_T3, RV_SP, (int16_t)(body->slot_offset[dst] + 8)));
-            int32_t rv_i64_done = code->count;
-            code->words[rv_i64_zdone] = rv_jal(RV_ZERO, (int32_t)((rv_i64_done - rv_i64_zdone) * 4));
-        } else {
-            code_emit(code, rv_sub(RV_T0, RV_T0, RV_T0));
-            code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)body->slot_offset[dst]));
-            code_emit(code, rv_sw(RV_ZERO, RV_SP, (int16_t)(body->slot_offset[dst] + 8)));
-        }
+        rv64_sp_mem(code, rv_sw, RV_T3, off_dst);
+    } else if (kind == BODY_OP_I32_TO_STR || kind == BODY_OP_I64_TO_STR) {
+        rv64_sp_mem(code, cold_scalar_bytes(body->slot_kind[a]) == 8 ? rv_ld : rv_lw,
+                    RV_T0, body->slot_offset[a]);
+        rv64_int_to_str(code, off_dst);
     } else if (kind == BODY_OP_SEQ_STR_INDEX_DYNAMIC) {
-        /* SEQ_STR_INDEX_DYNAMIC: seq[index] -> COLD_STR */
-        if (body->slot_kind[a] == SLOT_SEQ_STR_REF) {
-            code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-        } else {
-            code_emit(code, rv_addi(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
+        /* seq[index] -> str, bounds-checked against the seq length */
+        rv64_seq_header_addr(code, body, a, RV_T0);
+        rv64_sp_mem(code, rv_lw, RV_T1, body->slot_offset[b]);
+        if (checked) {
+            code_emit(code, rv_lw(RV_T2, RV_T0, 0));
+            rv64_bounds_trap(code, RV_T1, RV_T2);
+        }
+        code_emit(code, rv_ld(RV_T0, RV_T0, 8));
+        rv64_scaled_add(code, RV_T0, RV_T0, RV_T1, COLD_STR_SLOT_SIZE);
+        for (int32_t off = 0; off < COLD_STR_SLOT_SIZE; off += 8) {
+            code_emit(code, rv_ld(RV_T1, RV_T0, (int16_t)off));
+            rv64_sp_mem(code, rv_sd, RV_T1, off_dst + off);
         }
-        code_emit(code, rv_lw(RV_T1, RV_SP, (int16_t)body->slot_offset[b]));
-        code_emit(code, rv_bge(RV_T1, RV_ZERO, 0));
-        int32_t rv_ss_neg = code->count - 1;
-        code_emit(code, rv_ebreak());
-        int32_t rv_ss_neg_done = code->count;
-        code_emit(code, rv_lw(RV_T2, RV_T0, 0));
-        code_emit(code, rv_blt(RV_T1, RV_T2, 0));
-        int32_t rv_ss_high = code->count - 1;
-        code_emit(code, rv_ebreak());
-        int32_t rv_ss_high_done = code->count;
-        code_emit(code, rv_ld(RV_T3, RV_T0, 8));
-        rv_li(code->words, &code->count, RV_T4, 24);
-        code_emit(code, rv_mul(RV_T4, RV_T1, RV_T4));
-        code_emit(code, rv_add(RV_T3, RV_T3, RV_T4));
-        code_emit(code, rv_ld(RV_T5, RV_T3, COLD_STR_DATA_OFFSET));
-        code_emit(code, rv_sd(RV_T5, RV_SP, (int16_t)(body->slot_offset[dst] + COLD_STR_DATA_OFFSET)));
-        code_emit(code, rv_lw(RV_T5, RV_T3, COLD_STR_LEN_OFFSET));
-        code_emit(code, rv_sw(RV_T5, RV_SP, (int16_t)(body->slot_offset[dst] + COLD_STR_LEN_OFFSET)));
-        code_emit(code, rv_lw(RV_T5, RV_T3, COLD_STR_STORE_ID_OFFSET));
-        code_emit(code, rv_sw(RV_T5, RV_SP, (int16_t)(body->slot_offset[dst] + COLD_STR_STORE_ID_OFFSET)));
-        code_emit(code, rv_ld(RV_T5, RV_T3, COLD_STR_FLAGS_OFFSET));
-        code_emit(code, rv_sd(RV_T5, RV_SP, (int16_t)(body->slot_offset[dst] + COLD_STR_FLAGS_OFFSET)));
-        code->words[rv_ss_neg] = rv_bge(RV_T1, RV_ZERO, (int16_t)((rv_ss_neg_done - rv_ss_neg) * 4));
-        code->words[rv_ss_high] = rv_blt(RV_T1, RV_T2, (int16_t)((rv_ss_high_done - rv_ss_high) * 4));
-    } else if (kind == BODY_OP_BYTES_GET) {
-        code_emit(code, rv_add(RV_T0, RV_ZERO, RV_ZERO));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
-        code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));        /* t0 = bytes ptr */
-        code_emit(code, rv_lw(RV_T1, RV_SP, (int16_t)(body->slot_offset[a] + 8)));  /* t1 = len */
-        code_emit(code, rv_lw(RV_T2, RV_SP, (int16_t)body->slot_offset[b]));        /* t2 = index */
-        int32_t rbg_neg = code->count;
-        code_emit(code, rv_bge(RV_T2, RV_ZERO, 0));
-        code_emit(code, rv_ebreak());
-        int32_t rbg_neg_done = code->count;
-        code->words[rbg_neg] = rv_bge(RV_T2, RV_ZERO, (int16_t)((rbg_neg_done - rbg_neg) * 4));
-        code_emit(code, rv_blt(RV_T2, RV_T1, 0));
-        code_emit(code, rv_ebreak());
-        int32_t rbg_high_done = code->count;
-        code->words[rbg_neg_done] = rv_blt(RV_T2, RV_T1, (int16_t)((rbg_high_done - rbg_neg_done) * 4));
-        code_emit(code, rv_add(RV_T0, RV_T0, RV_T2));
-        code_emit(code, rv_lbu(RV_T0, RV_T0, 0));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
-    } else if (kind == BODY_OP_BYTES_SET) {
-        code_emit(code, rv_add(RV_T0, RV_ZERO, RV_ZERO));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
-        code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));        /* t0 = bytes ptr */
-        code_emit(code, rv_lw(RV_T1, RV_SP, (int16_t)(body->slot_offset[a] + 8)));  /* t1 = len */
-        code_emit(code, rv_lw(RV_T2, RV_SP, (int16_t)body->slot_offset[b]));        /* t2 = index */
-        int32_t rbs_neg = code->count;
-        code_emit(code, rv_bge(RV_T2, RV_ZERO, 0));
-        code_emit(code, rv_ebreak());
-        int32_t rbs_neg_done = code->count;
-        code->words[rbs_neg] = rv_bge(RV_T2, RV_ZERO, (int16_t)((rbs_neg_done - rbs_neg) * 4));
-        code_emit(code, rv_blt(RV_T2, RV_T1, 0));
-        code_emit(code, rv_ebreak());
-        int32_t rbs_high_done = code->count;
-        code->words[rbs_neg_done] = rv_blt(RV_T2, RV_T1, (int16_t)((rbs_high_done - rbs_neg_done) * 4));
-        code_emit(code, rv_add(RV_T0, RV_T0, RV_T2));
-        code_emit(code, rv_lw(RV_T1, RV_SP, (int16_t)body->slot_offset[c]));
-        code_emit(code, rv_sb(RV_T1, RV_T0, 0));
-        code_emit(code, rv_sw(RV_ZERO, RV_SP, (int16_t)off_dst));
     } else if (kind == BODY_OP_TEXT_CONTAINS) {
         /* substring search: needle (slot b) in haystack (slot a) -> I32 0/1 */
-        code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-        code_emit(code, rv_lw(RV_T1, RV_SP, (int16_t)(body->slot_offset[a] + 8)));
-        code_emit(code, rv_ld(RV_T2, RV_SP, (int16_t)body->slot_offset[b]));
-        code_emit(code, rv_lw(RV_T3, RV_SP, (int16_t)(body->slot_offset[b] + 8)));
+        rv64_sp_mem(code, rv_ld, RV_T0, body->slot_offset[a]);
+        rv64_sp_mem(code, rv_lw, RV_T1, body->slot_offset[a] + 8);
+        rv64_sp_mem(code, rv_ld, RV_T2, body->slot_offset[b]);
+        rv64_sp_mem(code, rv_lw, RV_T3, body->slot_offset[b] + 8);
         /* Empty needle -> store 1 */
         int32_t tc_nempty = code->count;
         code_emit(code, rv_bne(RV_T3, RV_ZERO, 0));
-        rv_li(code->words, &code->count, RV_T0, 1);
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
+        rv64_li(code, RV_T0, 1);
+        rv64_sp_mem(code, rv_sw, RV_T0, off_dst);
         int32_t tc_done = code->count;
         code_emit(code, rv_jal(RV_ZERO, 0));
         /* Check hay_len < needle_len -> store 0 */
@@ -14218,217 +17189,623 @@ static void rv64_codegen_op(Code *code, BodyIR *body, Symbols *symbols,
         /* Match: store 1 */
         int32_t tc_match_label = code->count;
         code->words[tc_inner_match] = rv_bgeu(RV_T5, RV_T3, (int16_t)((tc_match_label - tc_inner_match) * 4));
-        rv_li(code->words, &code->count, RV_T0, 1);
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
+        rv64_li(code, RV_T0, 1);
+        rv64_sp_mem(code, rv_sw, RV_T0, off_dst);
         int32_t tc_done_jmp = code->count;
         code_emit(code, rv_jal(RV_ZERO, 0));
         /* No match: store 0 */
         int32_t tc_nomatch_label = code->count;
         code->words[tc_nomatch] = rv_bltu(RV_T1, RV_T3, (int16_t)((tc_nomatch_label - tc_nomatch) * 4));
         code->words[tc_outer_nomatch] = rv_beq(RV_T4, RV_ZERO, (int16_t)((tc_nomatch_label - tc_outer_nomatch) * 4));
-        code_emit(code, rv_sw(RV_ZERO, RV_SP, (int16_t)off_dst));
+        rv64_sp_mem(code, rv_sw, RV_ZERO, off_dst);
         int32_t tc_done_label = code->count;
         code->words[tc_done] = rv_jal(RV_ZERO, (int32_t)((tc_done_label - tc_done) * 4));
         code->words[tc_done_jmp] = rv_jal(RV_ZERO, (int32_t)((tc_done_label - tc_done_jmp) * 4));
     } else if (kind == BODY_OP_STR_EQ) {
-        /* Stub: return 0 (not equal) */
-        code_emit(code, rv_sw(RV_ZERO, RV_SP, (int16_t)off_dst));
+        /* lengths first, then a byte loop */
+        rv64_load_str(code, body, a, RV_T0, RV_T1);
+        rv64_load_str(code, body, b, RV_T2, RV_T3);
+        code_emit(code, rv_addi(RV_T4, RV_ZERO, 0));
+        int32_t differ = code->count;
+        code_emit(code, rv_bne(RV_T1, RV_T3, 0));
+        int32_t loop = code->count;
+        code_emit(code, rv_beq(RV_T1, RV_ZERO, 0));
+        code_emit(code, rv_lbu(RV_T5, RV_T0, 0));
+        code_emit(code, rv_lbu(RV_T6, RV_T2, 0));
+        int32_t mismatch = code->count;
+        code_emit(code, rv_bne(RV_T5, RV_T6, 0));
+        code_emit(code, rv_addi(RV_T0, RV_T0, 1));
+        code_emit(code, rv_addi(RV_T2, RV_T2, 1));
+        code_emit(code, rv_addi(RV_T1, RV_T1, -1));
+        code_emit(code, rv_jal(RV_ZERO, (loop - code->count) * 4));
+        rv64_patch(code, loop, code->count);
+        code_emit(code, rv_addi(RV_T4, RV_ZERO, 1));
+        rv64_patch(code, differ, code->count);
+        rv64_patch(code, mismatch, code->count);
+        rv64_sp_mem(code, rv_sw, RV_T4, off_dst);
     } else if (kind == BODY_OP_STR_CONCAT) {
-        /* Stub: return empty string */
-        code_emit(code, rv_addi(RV_T0, RV_ZERO, 0));
-        code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)off_dst));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)(off_dst + 8)));
-    } else if (kind == BODY_OP_I32_TO_STR) {
-        /* Stub: return empty string */
-        code_emit(code, rv_addi(RV_T0, RV_ZERO, 0));
-        code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)off_dst));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)(off_dst + 8)));
+        /* both parts copied into one fresh mapping; an empty result stays null */
+        rv64_load_str(code, body, a, RV_T0, RV_T1);
+        rv64_load_str(code, body, b, RV_T2, RV_T3);
+        code_emit(code, rv_addw(RV_T4, RV_T1, RV_T3));
+        code_emit(code, rv_addi(RV_T5, RV_ZERO, 0));
+        int32_t empty = code->count;
+        code_emit(code, rv_beq(RV_T4, RV_ZERO, 0));
+        code_emit(code, rv_addi(RV_A1, RV_T4, 0));
+        rv64_mmap_a1(code);
+        code_emit(code, rv_addi(RV_T5, RV_A0, 0));
+        rv64_copy_bytes(code, RV_A0, RV_T0, RV_T1);
+        rv64_copy_bytes(code, RV_A0, RV_T2, RV_T3);
+        rv64_patch(code, empty, code->count);
+        rv64_store_str(code, off_dst, RV_T5, RV_T4);
     } else if (kind == BODY_OP_STR_JOIN) {
         /* Stub: return empty string */
         code_emit(code, rv_addi(RV_T0, RV_ZERO, 0));
-        code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)off_dst));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)(off_dst + 8)));
+        rv64_sp_mem(code, rv_sd, RV_T0, off_dst);
+        rv64_sp_mem(code, rv_sw, RV_T0, off_dst + 8);
     } else if (kind == BODY_OP_STR_SPLIT_CHAR) {
         /* Stub: return empty string */
         code_emit(code, rv_addi(RV_T0, RV_ZERO, 0));
-        code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)off_dst));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)(off_dst + 8)));
+        rv64_sp_mem(code, rv_sd, RV_T0, off_dst);
+        rv64_sp_mem(code, rv_sw, RV_T0, off_dst + 8);
     } else if (kind == BODY_OP_STR_STRIP) {
         /* Copy input a to dst (passthrough) */
         if (body->slot_kind[a] == SLOT_STR_REF) {
-            code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
+            rv64_sp_mem(code, rv_ld, RV_T0, body->slot_offset[a]);
             code_emit(code, rv_ld(RV_T1, RV_T0, 0));
             code_emit(code, rv_lw(RV_T2, RV_T0, 8));
-            code_emit(code, rv_sd(RV_T1, RV_SP, (int16_t)off_dst));
-            code_emit(code, rv_sw(RV_T2, RV_SP, (int16_t)(off_dst + 8)));
+            rv64_sp_mem(code, rv_sd, RV_T1, off_dst);
+            rv64_sp_mem(code, rv_sw, RV_T2, off_dst + 8);
         } else {
-            code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-            code_emit(code, rv_lw(RV_T1, RV_SP, (int16_t)(body->slot_offset[a] + 8)));
-            code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)off_dst));
-            code_emit(code, rv_sw(RV_T1, RV_SP, (int16_t)(off_dst + 8)));
+            rv64_sp_mem(code, rv_ld, RV_T0, body->slot_offset[a]);
+            rv64_sp_mem(code, rv_lw, RV_T1, body->slot_offset[a] + 8);
+            rv64_sp_mem(code, rv_sd, RV_T0, off_dst);
+            rv64_sp_mem(code, rv_sw, RV_T1, off_dst + 8);
         }
     } else if (kind == BODY_OP_STR_SLICE) {
-        /* String slice: ptr[a]+b, len=c */
-        if (body->slot_kind[a] == SLOT_STR_REF) {
-            code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-            code_emit(code, rv_ld(RV_T1, RV_T0, 0));
-            code_emit(code, rv_lw(RV_T2, RV_T0, 8));
-        } else {
-            code_emit(code, rv_ld(RV_T1, RV_SP, (int16_t)body->slot_offset[a]));
-            code_emit(code, rv_lw(RV_T2, RV_SP, (int16_t)(body->slot_offset[a] + 8)));
-        }
-        code_emit(code, rv_lw(RV_T3, RV_SP, (int16_t)body->slot_offset[b]));
-        code_emit(code, rv_add(RV_T1, RV_T1, RV_T3));
-        code_emit(code, rv_sd(RV_T1, RV_SP, (int16_t)off_dst));
-        code_emit(code, rv_sw(RV_T2, RV_SP, (int16_t)(off_dst + 8)));
+        /* traps unless 0 <= start <= len and 0 <= n <= len - start */
+        rv64_load_str(code, body, a, RV_T0, RV_T1);
+        rv64_sp_mem(code, rv_lw, RV_T2, body->slot_offset[b]);
+        rv64_sp_mem(code, rv_lw, RV_T3, body->slot_offset[c]);
+        code_emit(code, rv_bgeu(RV_T1, RV_T2, 8));
+        code_emit(code, rv_ebreak());
+        code_emit(code, rv_sub(RV_T4, RV_T1, RV_T2));
+        code_emit(code, rv_bgeu(RV_T4, RV_T3, 8));
+        code_emit(code, rv_ebreak());
+        code_emit(code, rv_add(RV_T0, RV_T0, RV_T2));
+        rv64_store_str(code, off_dst, RV_T0, RV_T3);
     } else if (kind == BODY_OP_SHELL_QUOTE) {
         /* Copy input a to dst (passthrough) */
         if (body->slot_kind[a] == SLOT_STR_REF) {
-            code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
+            rv64_sp_mem(code, rv_ld, RV_T0, body->slot_offset[a]);
             code_emit(code, rv_ld(RV_T1, RV_T0, 0));
             code_emit(code, rv_lw(RV_T2, RV_T0, 8));
-            code_emit(code, rv_sd(RV_T1, RV_SP, (int16_t)off_dst));
-            code_emit(code, rv_sw(RV_T2, RV_SP, (int16_t)(off_dst + 8)));
+            rv64_sp_mem(code, rv_sd, RV_T1, off_dst);
+            rv64_sp_mem(code, rv_sw, RV_T2, off_dst + 8);
         } else {
-            code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[a]));
-            code_emit(code, rv_lw(RV_T1, RV_SP, (int16_t)(body->slot_offset[a] + 8)));
-            code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)off_dst));
-            code_emit(code, rv_sw(RV_T1, RV_SP, (int16_t)(off_dst + 8)));
+            rv64_sp_mem(code, rv_ld, RV_T0, body->slot_offset[a]);
+            rv64_sp_mem(code, rv_lw, RV_T1, body->slot_offset[a] + 8);
+            rv64_sp_mem(code, rv_sd, RV_T0, off_dst);
+            rv64_sp_mem(code, rv_sw, RV_T1, off_dst + 8);
         }
     } else if (kind == BODY_OP_READ_FLAG) {
         /* Return default value from slot b */
-        code_emit(code, rv_lw(RV_T0, RV_SP, (int16_t)body->slot_offset[b]));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
+        rv64_sp_mem(code, rv_lw, RV_T0, body->slot_offset[b]);
+        rv64_sp_mem(code, rv_sw, RV_T0, off_dst);
     } else if (kind == BODY_OP_PARSE_INT) {
-        /* Stub: return 0 */
-        code_emit(code, rv_sw(RV_ZERO, RV_SP, (int16_t)off_dst));
+        /* optional '-', then decimal digits up to the first non-digit */
+        rv64_load_str(code, body, a, RV_T0, RV_T1);
+        code_emit(code, rv_addi(RV_T2, RV_ZERO, 0));
+        code_emit(code, rv_addi(RV_T3, RV_ZERO, 0));
+        int32_t empty = code->count;
+        code_emit(code, rv_beq(RV_T1, RV_ZERO, 0));
+        code_emit(code, rv_lbu(RV_T4, RV_T0, 0));
+        code_emit(code, rv_addi(RV_T4, RV_T4, -'-'));
+        int32_t no_sign = code->count;
+        code_emit(code, rv_bne(RV_T4, RV_ZERO, 0));
+        code_emit(code, rv_addi(RV_T3, RV_ZERO, 1));
+        code_emit(code, rv_addi(RV_T0, RV_T0, 1));
+        code_emit(code, rv_addi(RV_T1, RV_T1, -1));
+        rv64_patch(code, no_sign, code->count);
+        code_emit(code, rv_addi(RV_T5, RV_ZERO, 10));
+        int32_t loop = code->count;
+        code_emit(code, rv_beq(RV_T1, RV_ZERO, 0));
+        code_emit(code, rv_lbu(RV_T4, RV_T0, 0));
+        code_emit(code, rv_addi(RV_T4, RV_T4, -'0'));
+        int32_t non_digit = code->count;
+        code_emit(code, rv_bgeu(RV_T4, RV_T5, 0));
+        code_emit(code, rv_mulw(RV_T2, RV_T2, RV_T5));
+        code_emit(code, rv_addw(RV_T2, RV_T2, RV_T4));
+        code_emit(code, rv_addi(RV_T0, RV_T0, 1));
+        code_emit(code, rv_addi(RV_T1, RV_T1, -1));
+        code_emit(code, rv_jal(RV_ZERO, (loop - code->count) * 4));
+        rv64_patch(code, loop, code->count);
+        rv64_patch(code, non_digit, code->count);
+        code_emit(code, rv_beq(RV_T3, RV_ZERO, 8));
+        code_emit(code, rv_subw(RV_T2, RV_ZERO, RV_T2));
+        rv64_patch(code, empty, code->count);
+        rv64_sp_mem(code, rv_sw, RV_T2, off_dst);
     } else if (kind == BODY_OP_TEXT_SET_INSERT) {
         /* Nop: side-effect only */
     } else if (kind == BODY_OP_CWD_STR) {
-        /* Stub: return empty string */
+        /* getcwd into a fresh page; the syscall counts the trailing NUL */
+        rv64_li(code, RV_A1, 4096);
+        rv64_mmap_a1(code);
+        code_emit(code, rv_addi(RV_T0, RV_A0, 0));
+        rv64_li(code, RV_A7, 17); /* getcwd */
+        code_emit(code, rv_ecall());
+        code_emit(code, rv_addi(RV_T1, RV_A0, -1));
+        int32_t ok = code->count;
+        code_emit(code, rv_blt(RV_ZERO, RV_A0, 0));
         code_emit(code, rv_addi(RV_T0, RV_ZERO, 0));
-        code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)off_dst));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)(off_dst + 8)));
+        code_emit(code, rv_addi(RV_T1, RV_ZERO, 0));
+        rv64_patch(code, ok, code->count);
+        rv64_store_str(code, off_dst, RV_T0, RV_T1);
     } else if (kind == BODY_OP_PATH_JOIN) {
         /* Stub: return empty string */
         code_emit(code, rv_addi(RV_T0, RV_ZERO, 0));
-        code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)off_dst));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)(off_dst + 8)));
+        rv64_sp_mem(code, rv_sd, RV_T0, off_dst);
+        rv64_sp_mem(code, rv_sw, RV_T0, off_dst + 8);
     } else if (kind == BODY_OP_PATH_ABSOLUTE) {
         /* Copy input path b to dst (passthrough) */
         if (body->slot_kind[b] == SLOT_STR_REF) {
-            code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[b]));
+            rv64_sp_mem(code, rv_ld, RV_T0, body->slot_offset[b]);
             code_emit(code, rv_ld(RV_T1, RV_T0, 0));
             code_emit(code, rv_lw(RV_T2, RV_T0, 8));
-            code_emit(code, rv_sd(RV_T1, RV_SP, (int16_t)off_dst));
-            code_emit(code, rv_sw(RV_T2, RV_SP, (int16_t)(off_dst + 8)));
+            rv64_sp_mem(code, rv_sd, RV_T1, off_dst);
+            rv64_sp_mem(code, rv_sw, RV_T2, off_dst + 8);
         } else {
-            code_emit(code, rv_ld(RV_T0, RV_SP, (int16_t)body->slot_offset[b]));
-            code_emit(code, rv_lw(RV_T1, RV_SP, (int16_t)(body->slot_offset[b] + 8)));
-            code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)off_dst));
-            code_emit(code, rv_sw(RV_T1, RV_SP, (int16_t)(off_dst + 8)));
+            rv64_sp_mem(code, rv_ld, RV_T0, body->slot_offset[b]);
+            rv64_sp_mem(code, rv_lw, RV_T1, body->slot_offset[b] + 8);
+            rv64_sp_mem(code, rv_sd, RV_T0, off_dst);
+            rv64_sp_mem(code, rv_sw, RV_T1, off_dst + 8);
         }
     } else if (kind == BODY_OP_PATH_PARENT) {
-        /* Stub: return empty string */
+        /* text before the last '/' or '\\'; empty when there is none or it leads */
+        rv64_load_str(code, body, a, RV_T0, RV_T1);
+        code_emit(code, rv_addi(RV_T2, RV_ZERO, 0));
+        code_emit(code, rv_addi(RV_T3, RV_ZERO, -1));
+        code_emit(code, rv_addi(RV_A2, RV_ZERO, '/'));
+        code_emit(code, rv_addi(RV_A3, RV_ZERO, '\\'));
+        int32_t loop = code->count;
+        code_emit(code, rv_bge(RV_T2, RV_T1, 0));
+        code_emit(code, rv_add(RV_T4, RV_T0, RV_T2));
+        code_emit(code, rv_lbu(RV_T4, RV_T4, 0));
+        code_emit(code, rv_beq(RV_T4, RV_A2, 8));
+        code_emit(code, rv_bne(RV_T4, RV_A3, 8));
+        code_emit(code, rv_addi(RV_T3, RV_T2, 0));
+        code_emit(code, rv_addi(RV_T2, RV_T2, 1));
+        code_emit(code, rv_jal(RV_ZERO, (loop - code->count) * 4));
+        rv64_patch(code, loop, code->count);
+        int32_t has_parent = code->count;
+        code_emit(code, rv_blt(RV_ZERO, RV_T3, 0));
         code_emit(code, rv_addi(RV_T0, RV_ZERO, 0));
-        code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)off_dst));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)(off_dst + 8)));
+        code_emit(code, rv_addi(RV_T3, RV_ZERO, 0));
+        rv64_patch(code, has_parent, code->count);
+        rv64_store_str(code, off_dst, RV_T0, RV_T3);
     } else if (kind == BODY_OP_PATH_EXISTS) {
-        /* Stub: return 0 (does not exist) */
-        code_emit(code, rv_sw(RV_ZERO, RV_SP, (int16_t)off_dst));
+        /* faccessat(AT_FDCWD, path, F_OK, 0) == 0 */
+        rv64_load_str(code, body, a, RV_A1, RV_T1);
+        code_emit(code, rv_addi(RV_A0, RV_ZERO, -100));
+        code_emit(code, rv_addi(RV_A2, RV_ZERO, 0));
+        code_emit(code, rv_addi(RV_A3, RV_ZERO, 0));
+        rv64_li(code, RV_A7, 48);
+        code_emit(code, rv_ecall());
+        code_emit(code, rv_sltiu(RV_T0, RV_A0, 1));
+        rv64_sp_mem(code, rv_sw, RV_T0, off_dst);
     } else if (kind == BODY_OP_PATH_FILE_SIZE) {
-        /* Stub: return 0 */
-        code_emit(code, rv_sw(RV_ZERO, RV_SP, (int16_t)off_dst));
+        /* fstatat into a struct stat below sp; st_size is at +48, 0 on failure */
+        rv64_load_str(code, body, a, RV_A1, RV_T1);
+        code_emit(code, rv_addi(RV_SP, RV_SP, -128));
+        code_emit(code, rv_addi(RV_A0, RV_ZERO, -100));
+        code_emit(code, rv_addi(RV_A2, RV_SP, 0));
+        code_emit(code, rv_addi(RV_A3, RV_ZERO, 0));
+        rv64_li(code, RV_A7, 79);
+        code_emit(code, rv_ecall());
+        code_emit(code, rv_addi(RV_T0, RV_ZERO, 0));
+        code_emit(code, rv_bne(RV_A0, RV_ZERO, 8));
+        code_emit(code, rv_ld(RV_T0, RV_SP, 48));
+        code_emit(code, rv_addi(RV_SP, RV_SP, 128));
+        rv64_sp_mem(code, cold_scalar_bytes(body->slot_kind[dst]) == 8 ? rv_sd : rv_sw,
+                    RV_T0, off_dst);
     } else if (kind == BODY_OP_PATH_READ_TEXT) {
         /* Stub: return empty string */
         code_emit(code, rv_addi(RV_T0, RV_ZERO, 0));
-        code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)off_dst));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)(off_dst + 8)));
+        rv64_sp_mem(code, rv_sd, RV_T0, off_dst);
+        rv64_sp_mem(code, rv_sw, RV_T0, off_dst + 8);
     } else if (kind == BODY_OP_PATH_WRITE_TEXT) {
         /* Stub: return 0 (failure) */
-        code_emit(code, rv_sw(RV_ZERO, RV_SP, (int16_t)off_dst));
+        rv64_sp_mem(code, rv_sw, RV_ZERO, off_dst);
     } else if (kind == BODY_OP_COLD_SELF_EXEC) {
         /* Stub: return -1 (exec failure) */
-        rv_li(code->words, &code->count, RV_T0, -1);
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
+        rv64_li(code, RV_T0, -1);
+        rv64_sp_mem(code, rv_sw, RV_T0, off_dst);
     } else if (kind == BODY_OP_EXEC_SHELL) {
         /* Stub: return -1 (exec failure) */
-        rv_li(code->words, &code->count, RV_T0, -1);
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)off_dst));
+        rv64_li(code, RV_T0, -1);
+        rv64_sp_mem(code, rv_sw, RV_T0, off_dst);
     } else if (kind == BODY_OP_ARGV_STR) {
-        /* Stub: return empty string */
+        /* argv[index] with argc in s0 and argv in s1 (entry trampoline);
+           empty when out of range or null */
+        rv64_sp_mem(code, rv_lw, RV_T1, body->slot_offset[a]);
         code_emit(code, rv_addi(RV_T0, RV_ZERO, 0));
-        code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)off_dst));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)(off_dst + 8)));
+        code_emit(code, rv_addi(RV_T2, RV_ZERO, 0));
+        int32_t out_of_range = code->count;
+        code_emit(code, rv_bgeu(RV_T1, RV_S0, 0));
+        rv64_scaled_add(code, RV_T0, RV_S1, RV_T1, 8);
+        code_emit(code, rv_ld(RV_T0, RV_T0, 0));
+        int32_t null_arg = code->count;
+        code_emit(code, rv_beq(RV_T0, RV_ZERO, 0));
+        rv64_strlen(code, RV_T0, RV_T2);
+        rv64_patch(code, out_of_range, code->count);
+        rv64_patch(code, null_arg, code->count);
+        rv64_store_str(code, off_dst, RV_T0, RV_T2);
     } else if (kind == BODY_OP_TIME_NS) {
-        /* Stub: return 0 (uint64) */
-        code_emit(code, rv_addi(RV_T0, RV_ZERO, 0));
-        code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)off_dst));
+        /* clock_gettime(CLOCK_REALTIME) into a timespec below sp */
+        code_emit(code, rv_addi(RV_SP, RV_SP, -16));
+        code_emit(code, rv_addi(RV_A0, RV_ZERO, 0));
+        code_emit(code, rv_addi(RV_A1, RV_SP, 0));
+        rv64_li(code, RV_A7, 113);
+        code_emit(code, rv_ecall());
+        code_emit(code, rv_ld(RV_T0, RV_SP, 0));
+        code_emit(code, rv_ld(RV_T1, RV_SP, 8));
+        code_emit(code, rv_addi(RV_SP, RV_SP, 16));
+        rv64_li(code, RV_T2, 1000000000);
+        code_emit(code, rv_mul(RV_T0, RV_T0, RV_T2));
+        code_emit(code, rv_add(RV_T0, RV_T0, RV_T1));
+        rv64_sp_mem(code, rv_sd, RV_T0, off_dst);
     } else if (kind == BODY_OP_GETENV_STR) {
         /* Stub: return empty string */
         code_emit(code, rv_addi(RV_T0, RV_ZERO, 0));
-        code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)off_dst));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)(off_dst + 8)));
+        rv64_sp_mem(code, rv_sd, RV_T0, off_dst);
+        rv64_sp_mem(code, rv_sw, RV_T0, off_dst + 8);
     } else if (kind == BODY_OP_SEQ_I32_ADD) {
-        /* Nop: sequence append stub */
+        rv64_seq_append(code, body, dst, 4);
+        rv64_sp_mem(code, rv_lw, RV_T2, body->slot_offset[a]);
+        code_emit(code, rv_sw(RV_T2, RV_T3, 0));
+        rv64_seq_append_done(code);
     } else if (kind == BODY_OP_SEQ_STR_ADD) {
-        /* Nop: sequence append stub */
+        if (body->slot_kind[a] != SLOT_STR && body->slot_kind[a] != SLOT_STR_REF)
+            die("str[] add value kind mismatch");
+        rv64_seq_append(code, body, dst, COLD_STR_SLOT_SIZE);
+        rv64_load_str(code, body, a, RV_T2, RV_T4);
+        code_emit(code, rv_sd(RV_T2, RV_T3, COLD_STR_DATA_OFFSET));
+        code_emit(code, rv_sw(RV_T4, RV_T3, COLD_STR_LEN_OFFSET));
+        code_emit(code, rv_sw(RV_ZERO, RV_T3, COLD_STR_STORE_ID_OFFSET));
+        code_emit(code, rv_sd(RV_ZERO, RV_T3, COLD_STR_FLAGS_OFFSET));
+        rv64_seq_append_done(code);
     } else if (kind == BODY_OP_SEQ_OPAQUE_INDEX_DYNAMIC) {
-        /* Stub: return 0 (null ptr) */
-        code_emit(code, rv_addi(RV_T0, RV_ZERO, 0));
-        code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)off_dst));
+        int32_t size = codegen_seq_opaque_element_size(body, a, c);
+        if (body->slot_size[dst] > size) die("opaque sequence index destination too large");
+        rv64_seq_elem_addr(code, body, a, b, size, checked);
+        rv64_addi_large(code, RV_T5, RV_SP, off_dst);
+        rv64_li(code, RV_T4, body->slot_size[dst]);
+        rv64_copy_bytes(code, RV_T5, RV_T3, RV_T4);
     } else if (kind == BODY_OP_SEQ_OPAQUE_ADD) {
-        /* Nop: sequence append stub */
+        int32_t size = codegen_seq_opaque_element_size(body, dst, b);
+        if (body->slot_size[a] > size) die("opaque sequence add value too large");
+        rv64_seq_append(code, body, dst, size);
+        rv64_slot_data_addr(code, body, a, RV_T2);
+        rv64_li(code, RV_T4, size);
+        code_emit(code, rv_addi(RV_T5, RV_T3, 0));
+        rv64_copy_bytes(code, RV_T5, RV_T2, RV_T4);
+        rv64_seq_append_done(code);
     } else if (kind == BODY_OP_SEQ_OPAQUE_INDEX_STORE) {
-        /* Nop: sequence store stub */
+        /* dst is the value, a[b] = dst */
+        int32_t size = codegen_seq_opaque_element_size(body, a, c);
+        if (body->slot_size[dst] > size) die("opaque sequence store value too large");
+        rv64_seq_elem_addr(code, body, a, b, size, checked);
+        rv64_slot_data_addr(code, body, dst, RV_T2);
+        rv64_li(code, RV_T4, size);
+        rv64_copy_bytes(code, RV_T3, RV_T2, RV_T4);
     } else if (kind == BODY_OP_SEQ_OPAQUE_REMOVE) {
-        /* Nop: sequence remove stub */
+        /* remove dst[a], shifting the tail down */
+        int32_t size = codegen_seq_opaque_element_size(body, dst, b);
+        rv64_seq_elem_addr(code, body, dst, a, size, true);
+        code_emit(code, rv_addiw(RV_T2, RV_T2, -1));
+        code_emit(code, rv_sw(RV_T2, RV_T0, 0));
+        code_emit(code, rv_subw(RV_T4, RV_T2, RV_T1));
+        rv64_li(code, RV_T6, size);
+        code_emit(code, rv_mul(RV_T4, RV_T4, RV_T6));
+        rv64_addi_large(code, RV_T2, RV_T3, size);
+        rv64_copy_bytes(code, RV_T3, RV_T2, RV_T4);
     } else if (kind == BODY_OP_SEQ_OPAQUE_INDEX_REF_DYNAMIC) {
-        /* Stub: return 0 (null ptr) */
-        code_emit(code, rv_addi(RV_T0, RV_ZERO, 0));
-        code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)off_dst));
+        /* address of element b, c bytes each */
+        rv64_seq_header_addr(code, body, a, RV_T0);
+        rv64_sp_mem(code, rv_lw, RV_T1, body->slot_offset[b]);
+        if (checked) {
+            code_emit(code, rv_lw(RV_T2, RV_T0, 0));
+            rv64_bounds_trap(code, RV_T1, RV_T2);
+        }
+        code_emit(code, rv_ld(RV_T0, RV_T0, 8));
+        rv64_scaled_add(code, RV_T0, RV_T0, RV_T1, c > 0 ? c : 1);
+        rv64_sp_mem(code, rv_sd, RV_T0, off_dst);
     } else if (kind == BODY_OP_BYTES_TO_HEX) {
-        /* Stub: return empty string */
-        code_emit(code, rv_addi(RV_T0, RV_ZERO, 0));
-        code_emit(code, rv_sd(RV_T0, RV_SP, (int16_t)off_dst));
-        code_emit(code, rv_sw(RV_T0, RV_SP, (int16_t)(off_dst + 8)));
+        /* two lowercase hex digits per byte into a fresh mapping */
+        rv64_sp_mem(code, rv_ld, RV_T0, body->slot_offset[a]);
+        rv64_sp_mem(code, rv_lw, RV_T1, body->slot_offset[a] + 8);
+        code_emit(code, rv_addi(RV_T2, RV_ZERO, 0));
+        code_emit(code, rv_addi(RV_T3, RV_ZERO, 0));
+        int32_t null_in = code->count;
+        code_emit(code, rv_beq(RV_T0, RV_ZERO, 0));
+        int32_t empty = code->count;
+        code_emit(code, rv_bge(RV_ZERO, RV_T1, 0));
+        code_emit(code, rv_slliw(RV_T3, RV_T1, 1));
+        code_emit(code, rv_addi(RV_A1, RV_T3, 0));
+        rv64_mmap_a1(code);
+        code_emit(code, rv_addi(RV_T2, RV_A0, 0));
+        code_emit(code, rv_addi(RV_A2, RV_ZERO, 10));
+        int32_t loop = code->count;
+        code_emit(code, rv_lbu(RV_T4, RV_T0, 0));
+        for (int16_t nibble = 0; nibble < 2; nibble++) {
+            code_emit(code, nibble == 0 ? rv_srli(RV_T5, RV_T4, 4) : rv_andi(RV_T5, RV_T4, 15));
+            code_emit(code, rv_addi(RV_T6, RV_T5, '0'));
+            code_emit(code, rv_blt(RV_T5, RV_A2, 8));
+            code_emit(code, rv_addi(RV_T6, RV_T5, 'a' - 10));
+            code_emit(code, rv_sb(RV_T6, RV_A0, nibble));
+        }
+        code_emit(code, rv_addi(RV_T0, RV_T0, 1));
+        code_emit(code, rv_addi(RV_A0, RV_A0, 2));
+        code_emit(code, rv_addi(RV_T1, RV_T1, -1));
+        code_emit(code, rv_bne(RV_T1, RV_ZERO, (int16_t)((loop - code->count) * 4)));
+        rv64_patch(code, null_in, code->count);
+        rv64_patch(code, empty, code->count);
+        rv64_store_str(code, off_dst, RV_T2, RV_T3);
     } else if (kind == BODY_OP_PATH_WRITE_BYTES) {
         /* Stub: return 0 (failure) */
-        code_emit(code, rv_sw(RV_ZERO, RV_SP, (int16_t)off_dst));
+        rv64_sp_mem(code, rv_sw, RV_ZERO, off_dst);
     } else {
         fprintf(stderr, "cheng_cold: unknown RV64 BodyIR op kind=%d\n", kind);
         die("unknown RV64 BodyIR op");
     }
 }
 
-static void rv64_codegen_prologue(Code *code, int32_t frame_size) {
-    code_emit(code, rv_addi(RV_SP, RV_SP, -16));
-    code_emit(code, rv_sd(RV_RA, RV_SP, 0));
-    code_emit(code, rv_sd(RV_S0, RV_SP, 8));
-    code_emit(code, rv_addi(RV_S0, RV_SP, 0));
-    if (frame_size > 0)
-        code_emit(code, rv_addi(RV_SP, RV_SP, (int16_t)(-frame_size & 0xFFF)));
-}
 
-static void rv64_codegen_epilogue(Code *code, int32_t frame_size) {
-    if (frame_size > 0)
-        code_emit(code, rv_addi(RV_SP, RV_SP, (int16_t)(frame_size & 0xFFF)));
-    code_emit(code, rv_ld(RV_RA, RV_SP, 0));
-    code_emit(code, rv_ld(RV_S0, RV_SP, 8));
-    code_emit(code, rv_addi(RV_SP, RV_SP, 16));
-    code_emit(code, rv_jalr(RV_ZERO, RV_RA, 0));
-}
+/* riscv64 function compilation wrapper */
+static void rv64_codegen_func_emit(Code *code, BodyIR *body, Symbols *symbols,
+                                   FunctionPatchList *patches);
 
+/* Traced entry point: one "codegen" span per function body. */
 static void rv64_codegen_func(Code *code, BodyIR *body, Symbols *symbols,
                               FunctionPatchList *patches) {
-    rv64_codegen_prologue(code, body->frame_size);
-    for (int32_t bi = 0; bi < body->block_count; bi++) {
-        int32_t bs = body->block_op_start[bi];
-        int32_t be = bs + body->block_op_count[bi];
-        for (int32_t oi = bs; oi < be; oi++)
-            rv64_codegen_op(code, body, symbols, patches, oi);
+    uint64_t trace_start = cold_trace_begin();
+    rv64_codegen_func_emit(code, body, symbols, patches);
+    cold_trace_end("codegen", body->debug_name, trace_start);
+}
+
+/* Blocks are laid out with short conditional branches first; when one of
+   them cannot reach its target (+-4KiB) the body is emitted again with every
+   forward branch as an inverted branch over a jal. */
+static void rv64_codegen_func_emit(Code *code, BodyIR *body, Symbols *symbols,
+                                   FunctionPatchList *patches) {
+    static const int32_t pool[13] = {RV_T3, RV_T4, RV_T5, RV_S2, RV_S3, RV_S4, RV_S5,
+                                     RV_S6, RV_S7, RV_S8, RV_S9, RV_S10, RV_S11};
+    static const int32_t callee_saved[10] = {RV_S2, RV_S3, RV_S4, RV_S5, RV_S6,
+                                             RV_S7, RV_S8, RV_S9, RV_S10, RV_S11};
+    static const ColdRaTarget target = {pool, 13, 3, callee_saved, 10, RV64_ARG_STACK, true};
+    cold_profile_layout_blocks(body);
+    cold_eliminate_bounds_checks(body);
+    ColdRegAlloc ra;
+    cold_regalloc(body, symbols, &target, &ra);
+    /* ra and the saved registers sit on top of the slots; sp stays 16-byte aligned */
+    ra.frame = align_i32(ra.frame + 8 * (1 + ra.saved_count), 16);
+    int32_t block_count = body->block_count;
+    int32_t *block_pos = malloc((size_t)(block_count > 0 ? block_count : 1) * sizeof(int32_t));
+    if (!block_pos) die("out of memory");
+    Rv64BlockPatches jumps = {0};
+    int32_t code_start = code->count;
+    int32_t patch_start_count = patches->count;
+    int32_t end_pos = 0;
+
+    for (bool far = false;; far = true) {
+        code->count = code_start;
+        patches->count = patch_start_count;
+        jumps.count = 0;
+        for (int32_t bi = 0; bi < block_count; bi++) block_pos[bi] = -1;
+        bool falls_off_end = true;
+
+        rv64_codegen_prologue(code, body, &ra);
+        for (int32_t bi = 0; bi < block_count; bi++) {
+            block_pos[bi] = code->count;
+            ra.acc_slot = -1;
+            if (body->profile_counters >= 0) cold_profile_emit_count_rv64(code, body, patches, bi);
+            int32_t bs = body->block_op_start[bi];
+            int32_t be = bs + body->block_op_count[bi];
+            int32_t fused = cold_fused_compare(&ra, body, bi);
+            /* MI/PL have no branch form */
+            if (fused >= 0 && (body->op_c[fused] == 4 || body->op_c[fused] == 5)) fused = -1;
+            for (int32_t oi = bs; oi < be; oi++) {
+                if (oi == fused || rv64_lower_op(code, &ra, body, symbols, patches, oi)) continue;
+                rv64_codegen_op(code, body, symbols, patches, oi);
+                ra.acc_slot = -1;
+            }
+
+            int32_t next = bi + 1 < block_count ? bi + 1 : -1;
+            int32_t term = body->block_term[bi];
+            falls_off_end = true;
+            if (term < 0 || term >= body->term_count) continue;
+            int32_t kind = body->term_kind[term];
+            falls_off_end = false;
+            if (kind == BODY_TERM_RET) {
+                rv64_codegen_return(code, &ra, body, term);
+            } else if (kind == BODY_TERM_BR) {
+                int32_t target_block = body->term_true_block[term];
+                if (target_block != next || next < 0)
+                    rv64_jump_block(code, &jumps, block_pos, block_count, target_block, 0, far);
+            } else if (kind == BODY_TERM_CBR) {
+                int32_t on_true = body->term_true_block[term];
+                int32_t on_false = body->term_false_block[term];
+                int32_t cond, bytes = 4;
+                int x, y;
+                if (fused >= 0) {
+                    bytes = body->op_kind[fused] == BODY_OP_I64_CMP ? 8 : 4;
+                    x = rv64_ra_use(code, &ra, body, body->op_a[fused], bytes, RV_T1);
+                    y = rv64_ra_use(code, &ra, body, body->op_b[fused], bytes, RV_T2);
+                    cond = body->op_c[fused];
+                    if (body->term_case_start[term] == COND_EQ) cond = rv64_cond_invert(cond);
+                } else {
+                    x = rv64_ra_use(code, &ra, body, body->term_value[term], 4, RV_T1);
+                    y = rv64_ra_use(code, &ra, body, body->term_case_count[term], 4, RV_T2);
+                    cond = body->term_case_start[term];
+                }
+                uint32_t branch = rv64_branch(cond, x, y);
+                if (branch == 0) {
+                    rv64_setcc(code, RV_T0, x, y, cond, bytes == 8);
+                    ra.acc_slot = -1;
+                    branch = rv_bne(RV_T0, RV_ZERO, 0);
+                }
+                /* flipping funct3 bit 0 inverts every B-type condition */
+                if (on_true == next && next >= 0) {
+                    rv64_jump_block(code, &jumps, block_pos, block_count, on_false,
+                                    branch ^ (1u << 12), far);
+                } else {
+                    rv64_jump_block(code, &jumps, block_pos, block_count, on_true, branch, far);
+                    if (on_false != next || next < 0)
+                        rv64_jump_block(code, &jumps, block_pos, block_count, on_false, 0, far);
+                }
+            } else if (kind == BODY_TERM_SWITCH) {
+                rv64_codegen_switch(code, &ra, body, &jumps, block_pos, term, far);
+                falls_off_end = true;
+            } else {
+                /* Unknown terminator: return 0 */
+                code_emit(code, rv_addi(RV_A0, RV_ZERO, 0));
+                rv64_codegen_epilogue(code, &ra);
+            }
+        }
+        /* Jumps past the last block and a last block without a return leave
+           through one shared epilogue. */
+        end_pos = code->count;
+        bool needs_exit = falls_off_end;
+        for (int32_t i = 0; i < jumps.count; i++)
+            if (jumps.items[i].block < 0 || jumps.items[i].block >= block_count) needs_exit = true;
+        if (needs_exit) rv64_codegen_epilogue(code, &ra);
+        if (far) break;
+        bool fits = true;
+        for (int32_t i = 0; i < jumps.count && fits; i++) {
+            int32_t target_block = jumps.items[i].block;
+            int32_t dest = target_block >= 0 && target_block < block_count ? block_pos[target_block] : end_pos;
+            if (rv_is_branch(code->words[jumps.items[i].pos]) && (dest - jumps.items[i].pos) * 4 > 4094)
+                fits = false;
+        }
+        if (fits) break;
+    }
+
+    uint64_t patch_start = cold_trace_begin();
+    for (int32_t i = 0; i < jumps.count; i++) {
+        int32_t target_block = jumps.items[i].block;
+        rv64_patch(code, jumps.items[i].pos,
+                   target_block >= 0 && target_block < block_count ? block_pos[target_block] : end_pos);
+    }
+    cold_trace_end_items("patch", body->debug_name, patch_start, jumps.count);
+    free(jumps.items);
+    free(block_pos);
+    cold_regalloc_free(&ra);
+    cold_release_bounds_checks(body);
+}
+
+/* ---- RVC: compressed re-layout of a linked riscv64 text ----
+   Runs once calls, block jumps and rodata addresses are final. Each word
+   takes its 16-bit form when one exists; branch and jal offsets are derived
+   again from the new layout until it stops shrinking (distances only get
+   shorter, so a form chosen once stays valid). auipc pairs keep 8 bytes and
+   are pointed at their text or rodata target anew. Returns the bytes saved;
+   0 leaves the text alone, as does any word this backend does not emit. */
+static int32_t rv64_compress_text(Code *code, uint64_t text_vaddr, uint64_t rodata_vaddr) {
+    int32_t count = code->count;
+    if (count <= 0) return 0;
+    int32_t *target = malloc((size_t)count * sizeof(int32_t));
+    int32_t *pos = malloc((size_t)(count + 1) * sizeof(int32_t));
+    uint16_t *half = malloc((size_t)count * sizeof(uint16_t));
+    uint8_t *bytes = malloc((size_t)count * 4 + 2);
+    if (!target || !pos || !half || !bytes) die("out of memory");
+    bool ok = true;
+    for (int32_t i = 0; i < count && ok; i++) {
+        uint32_t w = code->words[i];
+        target[i] = -1;
+        half[i] = 0;
+        if ((w & 3) != 3) {
+            ok = false;
+        } else if (rv_is_branch(w) || rv_is_jal(w)) {
+            int32_t off = rv_is_jal(w) ? rv_imm_j(w) : rv_imm_b(w);
+            int32_t t = i + off / 4;
+            if ((off & 3) != 0 || t < 0 || t > count) ok = false;
+            target[i] = t;
+        } else if (rv_is_auipc(w)) {
+            /* the pair's low half is an addi, load or jalr off the auipc result */
+            uint32_t lo = i + 1 < count ? code->words[i + 1] : 0;
+            uint32_t op = lo & 0x7F;
+            if ((op != RV_OP_IMM && op != RV_LOAD && op != RV_JALR) ||
+                ((lo >> 15) & 0x1F) != ((w >> 7) & 0x1F)) {
+                ok = false;
+            } else {
+                target[++i] = -1;
+                half[i] = 0;
+            }
+        } else {
+            half[i] = rv_compress(w);
+        }
+    }
+    int32_t saved = 0;
+    if (ok) {
+        for (bool changed = true; changed;) {
+            changed = false;
+            pos[0] = 0;
+            for (int32_t i = 0; i < count; i++) pos[i + 1] = pos[i] + (half[i] != 0 ? 2 : 4);
+            for (int32_t i = 0; i < count; i++) {
+                if (target[i] < 0 || half[i] != 0) continue;
+                half[i] = rv_compress_jump(code->words[i], pos[target[i]] - pos[i]);
+                if (half[i] != 0) changed = true;
+            }
+        }
+        int32_t total = pos[count];
+        int32_t padded = (total + 3) & ~3;
+        uint64_t new_rodata = elf_exec_rodata_vaddr(padded);
+        for (int32_t i = 0; i < count; i++) {
+            uint32_t w = code->words[i];
+            uint8_t *p = bytes + pos[i];
+            if (target[i] >= 0) {
+                int32_t off = pos[target[i]] - pos[i];
+                if (half[i] != 0) half[i] = rv_compress_jump(w, off);
+                else w = rv_with_offset(w, off);
+            } else if (rv_is_auipc(w)) {
+                uint32_t lo = code->words[i + 1];
+                uint64_t addr = text_vaddr + (uint64_t)i * 4 + (uint64_t)(int64_t)(int32_t)(w & 0xFFFFF000u) +
+                                (uint64_t)(int64_t)rv_imm_i(lo);
+                uint64_t dest;
+                if (addr >= rodata_vaddr) {
+                    dest = addr - rodata_vaddr + new_rodata;
+                } else {
+                    uint64_t word = (addr - text_vaddr) / 4;
+                    if ((addr - text_vaddr) % 4 != 0 || word > (uint64_t)count) { ok = false; break; }
+                    dest = text_vaddr + (uint64_t)pos[word];
+                }
+                int32_t off = (int32_t)(dest - (text_vaddr + (uint64_t)pos[i]));
+                int32_t upper = (off + 0x800) & (int32_t)0xFFFFF000;
+                w = (w & 0xFFFu) | ((uint32_t)upper & 0xFFFFF000u);
+                lo = (lo & 0x000FFFFFu) | ((uint32_t)((off - upper) & 0xFFF) << 20);
+                memcpy(p, &w, 4);
+                memcpy(p + 4, &lo, 4);
+                i++;
+                continue;
+            }
+            if (half[i] != 0) memcpy(p, &half[i], 2);
+            else memcpy(p, &w, 4);
+        }
+        if (ok) {
+            if (padded != total) {
+                uint16_t nop = rv_c_nop();
+                memcpy(bytes + total, &nop, 2);
+            }
+            memcpy(code->words, bytes, (size_t)padded);
+            saved = count * 4 - padded;
+            code->count = padded / 4;
+        }
     }
-    rv64_codegen_epilogue(code, body->frame_size);
+    free(target);
+    free(pos);
+    free(half);
+    free(bytes);
+    return saved;
 }
 
 static void codegen_switch(Code *code, BodyIR *body, PatchList *patches, int32_t term) {
@@ -14596,6 +17973,146 @@ static int32_t cold_block_index_for_op(BodyIR *body, int32_t op_index) {
     return -1;
 }
 
+/* Successors of block in the order codegen lays them out; switches and
+   blocks without a terminator fall through to the next block. */
+static int32_t cold_block_successors(BodyIR *body, int32_t block, int32_t *succ, int32_t cap) {
+    int32_t n = 0;
+    int32_t term = body->block_term[block];
+    int32_t next = block + 1 < body->block_count ? block + 1 : -1;
+    if (term < 0 || term >= body->term_count) {
+        if (next >= 0) succ[n++] = next;
+        return n;
+    }
+    int32_t kind = body->term_kind[term];
+    if (kind == BODY_TERM_BR || kind == BODY_TERM_CBR) {
+        int32_t t = body->term_true_block[term];
+        if (t >= 0 && t < body->block_count) succ[n++] = t;
+        int32_t f = kind == BODY_TERM_CBR ? body->term_false_block[term] : -1;
+        if (f >= 0 && f < body->block_count) succ[n++] = f;
+    } else if (kind == BODY_TERM_SWITCH) {
+        for (int32_t i = 0; i < body->switch_count && n < cap - 1; i++) {
+            int32_t t = body->switch_block[i];
+            if (body->switch_term[i] == term && t >= 0 && t < body->block_count) succ[n++] = t;
+        }
+        if (next >= 0) succ[n++] = next;
+    }
+    return n;
+}
+
+/* ---- Profile-guided block layout ----
+   Blocks entered at least once are chained hottest successor first from
+   the entry; blocks the profile never saw move behind them in source
+   order, out of the hot path. A block without a terminator, or ending in
+   a switch whose default falls through, stays glued to the block after it,
+   and such a chain ending in the last block stays last. */
+static void cold_profile_layout_blocks(BodyIR *body) {
+    int32_t n = body->block_count;
+    const uint64_t *count = body->block_profile;
+    if (!count || n <= 2) return;
+    int32_t *unit_first = malloc((size_t)n * sizeof(int32_t));
+    int32_t *unit_last = malloc((size_t)n * sizeof(int32_t));
+    int32_t *unit_of = malloc((size_t)n * sizeof(int32_t));
+    int32_t *order = malloc((size_t)n * sizeof(int32_t));
+    int32_t *new_index = malloc((size_t)n * sizeof(int32_t));
+    bool *placed = calloc((size_t)n, sizeof(bool));
+    int32_t succ_cap = body->switch_count + 3;
+    int32_t *succ = malloc((size_t)succ_cap * sizeof(int32_t));
+    if (!unit_first || !unit_last || !unit_of || !order || !new_index || !placed || !succ)
+        die("out of memory");
+
+    int32_t units = 0;
+    for (int32_t bi = 0; bi < n; bi++) {
+        bool glued = false;
+        if (bi > 0) {
+            int32_t term = body->block_term[bi - 1];
+            glued = term < 0 || term >= body->term_count || body->term_kind[term] == BODY_TERM_SWITCH;
+        }
+        if (!glued) unit_first[units++] = bi;
+        unit_of[bi] = units - 1;
+        unit_last[units - 1] = bi;
+    }
+    int32_t last_term = body->block_term[n - 1];
+    int32_t pinned = last_term < 0 || last_term >= body->term_count ||
+                     body->term_kind[last_term] == BODY_TERM_SWITCH ? unit_of[n - 1] : -1;
+    if (pinned == 0) pinned = -1;
+
+    int32_t placed_units = 0, order_count = 0;
+    for (int32_t u = 0; u >= 0;) {
+        placed[u] = true;
+        placed_units++;
+        for (int32_t bi = unit_first[u]; bi <= unit_last[u]; bi++) order[order_count++] = bi;
+        int32_t best = -1;
+        int32_t sn = cold_block_successors(body, unit_last[u], succ, succ_cap);
+        for (int32_t i = 0; i < sn; i++) {
+            int32_t v = unit_of[succ[i]];
+            if (placed[v] || v == pinned || count[unit_first[v]] == 0) continue;
+            if (best < 0 || count[unit_first[v]] > count[unit_first[best]]) best = v;
+        }
+        for (int32_t v = 0; v < units && best < 0; v++) {
+            if (placed[v] || v == pinned || count[unit_first[v]] == 0) continue;
+            int32_t hottest = v;
+            for (int32_t w = v + 1; w < units; w++)
+                if (!placed[w] && w != pinned && count[unit_first[w]] > count[unit_first[hottest]])
+                    hottest = w;
+            best = hottest;
+        }
+        u = best;
+    }
+    for (int32_t u = 0; u < units; u++) {
+        if (placed[u] || u == pinned) continue;
+        for (int32_t bi = unit_first[u]; bi <= unit_last[u]; bi++) order[order_count++] = bi;
+    }
+    if (pinned >= 0)
+        for (int32_t bi = unit_first[pinned]; bi <= unit_last[pinned]; bi++) order[order_count++] = bi;
+
+    int32_t moved = 0;
+    for (int32_t i = 0; i < n; i++) {
+        new_index[order[i]] = i;
+        if (order[i] != i) moved++;
+    }
+    if (moved > 0) {
+        int32_t *start = malloc((size_t)n * sizeof(int32_t));
+        int32_t *ops = malloc((size_t)n * sizeof(int32_t));
+        int32_t *term = malloc((size_t)n * sizeof(int32_t));
+        uint64_t *hits = malloc((size_t)n * sizeof(uint64_t));
+        if (!start || !ops || !term || !hits) die("out of memory");
+        for (int32_t i = 0; i < n; i++) {
+            start[i] = body->block_op_start[order[i]];
+            ops[i] = body->block_op_count[order[i]];
+            term[i] = body->block_term[order[i]];
+            hits[i] = count[order[i]];
+        }
+        memcpy(body->block_op_start, start, (size_t)n * sizeof(int32_t));
+        memcpy(body->block_op_count, ops, (size_t)n * sizeof(int32_t));
+        memcpy(body->block_term, term, (size_t)n * sizeof(int32_t));
+        memcpy(body->block_profile, hits, (size_t)n * sizeof(uint64_t));
+        for (int32_t t = 0; t < body->term_count; t++) {
+            int32_t kind = body->term_kind[t];
+            if (kind != BODY_TERM_BR && kind != BODY_TERM_CBR) continue;
+            int32_t *targets[2] = {&body->term_true_block[t], &body->term_false_block[t]};
+            for (int32_t k = 0; k < (kind == BODY_TERM_CBR ? 2 : 1); k++)
+                if (*targets[k] >= 0 && *targets[k] < n) *targets[k] = new_index[*targets[k]];
+        }
+        for (int32_t si = 0; si < body->switch_count; si++) {
+            int32_t target = body->switch_block[si];
+            if (target >= 0 && target < n) body->switch_block[si] = new_index[target];
+        }
+        free(start);
+        free(ops);
+        free(term);
+        free(hits);
+        __atomic_add_fetch(&cold_profile.blocks_moved, moved, __ATOMIC_RELAXED);
+    }
+    free(unit_first);
+    free(unit_last);
+    free(unit_of);
+    free(order);
+    free(new_index);
+    free(placed);
+    free(succ);
+}
+
+
 static bool *cold_build_block_dominators(BodyIR *body) {
     if (!body || body->block_count <= 0) return NULL;
     int32_t n = body->block_count;
@@ -14607,17 +18124,18 @@ static bool *cold_build_block_dominators(BodyIR *body) {
         return NULL;
     }
 
+    int32_t succ_cap = body->switch_count + 3;
+    int32_t *succ = malloc((size_t)succ_cap * sizeof(int32_t));
+    if (!succ) {
+        free(pred);
+        free(dom);
+        return NULL;
+    }
     for (int32_t b = 0; b < n; b++) {
-        int32_t term = body->block_term[b];
-        if (term < 0 || term >= body->term_count) continue;
-        int32_t tk = body->term_kind[term];
-        int32_t tb = body->term_true_block[term];
-        int32_t fb = body->term_false_block[term];
-        if ((tk == BODY_TERM_BR || tk == BODY_TERM_CBR) && tb >= 0 && tb < n)
-            pred[tb * n + b] = true;
-        if (tk == BODY_TERM_CBR && fb >= 0 && fb < n)
-            pred[fb * n + b] = true;
+        int32_t count = cold_block_successors(body, b, succ, succ_cap);
+        for (int32_t i = 0; i < count; i++) pred[succ[i] * n + b] = true;
     }
+    free(succ);
 
     for (int32_t b = 0; b < n; b++) {
         for (int32_t d = 0; d < n; d++) {
@@ -14672,6 +18190,20 @@ static bool cold_op_dominates_op(BodyIR *body, const bool *dom,
     return dom[use_block * body->block_count + def_block];
 }
 
+/* Slots whose address leaves the op stream: field refs into them and call
+   arguments, which var parameters receive by reference. */
+static void cold_mark_escaped_slots(BodyIR *body, bool *escaped) {
+    int32_t slot_count = body->slot_count;
+    for (int32_t op = 0; op < body->op_count; op++) {
+        int32_t a = body->op_a[op];
+        if (body->op_kind[op] == BODY_OP_FIELD_REF && a >= 0 && a < slot_count) escaped[a] = true;
+    }
+    for (int32_t i = 0; i < body->call_arg_count; i++) {
+        int32_t slot = body->call_arg_slot[i];
+        if (slot >= 0 && slot < slot_count) escaped[slot] = true;
+    }
+}
+
 /* Cross-block slot liveness analysis.
    For each slot, track which basic blocks write it and which read it.
    A no_alias slot written in exactly one block and read in at least one
@@ -15134,6 +18666,8 @@ static void cold_apply_identity_rewrites(BodyIR *body) {
 }
 
 static void cold_apply_licm(BodyIR *body);
+static int32_t cold_apply_gvn(BodyIR *body);
+static bool cold_reduce_iv_multiply(BodyIR *body);
 static void cold_opt_pass(BodyIR *body) {
     /* One pass of DSE + identity rewrites.
        Separated so cold_optimize_body can iterate to convergence. */
@@ -15214,15 +18748,21 @@ static void cold_opt_pass(BodyIR *body) {
     /* Algebraic identity rewrites (provably-correct constant folding).
        Runs after DSE so slot writer counts reflect only live ops. */
     cold_apply_identity_rewrites(body);
+
+    /* Redundant pure values become copies; the next DSE drops them. */
+    int32_t reused = cold_apply_gvn(body);
+    if (reused > 0) __atomic_add_fetch(&cold_egraph_rewrite_count, reused, __ATOMIC_RELAXED);
 }
 
 /* Optimize a BodyIR function with dead store elimination and identity rewrites.
    Iterates to fixed point so cascading patterns (e.g. double-NEG feeding
-   ADD(x,0)) are fully resolved.
-   BodyIR slots are mutable, so CSE belongs after SSA/equivalence proof. */
+   ADD(x,0)) are fully resolved. Value numbering only merges slots whose
+   single writer dominates the read, so mutable slots stay exact.
+   Induction multiplies are reduced after convergence, then DSE runs again. */
 static void cold_optimize_body(BodyIR *body, bool enable_licm) {
     if (!body || body->slot_count <= 0 || body->op_count <= 0) return;
 
+    uint64_t trace_start = cold_trace_begin();
     int32_t prev = 0;
     int32_t pass_count = 0;
     #define COLD_EGRAPH_CONVERGE_MAX_ITER 16
@@ -15235,7 +18775,22 @@ static void cold_optimize_body(BodyIR *body, bool enable_licm) {
 
     cold_egraph_fixed_point_iterations = pass_count;
 
-    if (enable_licm) cold_apply_licm(body);
+    int32_t reductions = 0;
+    while (reductions < 64 && cold_reduce_iv_multiply(body)) reductions++;
+    if (reductions > 0) {
+        pass_count = 0;
+        do {
+            prev = cold_egraph_rewrite_count;
+            pass_count++;
+            cold_opt_pass(body);
+        } while (cold_egraph_rewrite_count != prev && pass_count < COLD_EGRAPH_CONVERGE_MAX_ITER);
+    }
+
+    if (enable_licm) {
+        uint64_t licm_start = cold_trace_begin();
+        cold_apply_licm(body);
+        cold_trace_end("licm", body->debug_name, licm_start);
+    }
 
     /* Run cross-block no-alias liveness analysis on the optimized IR */
     {
@@ -15245,6 +18800,7 @@ static void cold_optimize_body(BodyIR *body, bool enable_licm) {
         cold_cross_block_safe_slots   = safe;
         cold_cross_block_unsafe_slots = unsafe;
     }
+    cold_trace_end("optimize", body->debug_name, trace_start);
 }
 
 /* LICM: Loop Invariant Code Motion for CONST hoisting. */
@@ -15343,10 +18899,1180 @@ static void cold_apply_licm(BodyIR *body) {
     free(writer_count);
 }
 
+/* ---- Bounds-check elimination ----
+   Every seq/str index traps unless 0 <= index < len, where len is the word
+   the index op reads from the indexed slot. A forward must-availability
+   dataflow over three fact families proves some of those checks redundant:
+     LEN(n, s)   slot n holds the current length of s
+     NONNEG(i)   slot i >= 0
+     IDX(i, s)   0 <= i < len(s)
+   LEN comes from STR_LEN and the length load of a seq header; IDX from a
+   compare "i < n" on the edge where it holds (n with LEN(n, s), i with
+   NONNEG) and from an executed check. Writes to a slot kill its facts; an op
+   that may write memory kills every fact on a pointer or address-taken slot.
+   Proven ops are flagged in body->op_bounds_proven for the backends. */
+enum { COLD_BCE_LEN = 0, COLD_BCE_IDX = 1, COLD_BCE_NONNEG = 2 };
+
+typedef struct ColdBce {
+    BodyIR *body;
+    int32_t fact_count;
+    int32_t fact_cap;
+    int32_t *fact_kind;
+    int32_t *fact_x;          /* length or index slot */
+    int32_t *fact_s;          /* indexed slot, -1 for NONNEG */
+    int32_t *slot_head;       /* per slot, first fact naming it */
+    int32_t *fact_next_x;
+    int32_t *fact_next_s;
+    bool *slot_volatile;      /* pointer kind or address taken */
+    int32_t *const_op;        /* last I32_CONST writing the slot, this block */
+    int32_t words;
+} ColdBce;
+
+static bool cold_bce_seq_kind(int32_t kind) {
+    return kind == SLOT_SEQ_I32 || kind == SLOT_SEQ_I32_REF ||
+           kind == SLOT_SEQ_STR || kind == SLOT_SEQ_STR_REF ||
+           kind == SLOT_SEQ_OPAQUE || kind == SLOT_SEQ_OPAQUE_REF;
+}
+
+/* Index ops whose check compares against the length word of slot a. */
+static bool cold_bce_checked_index(BodyIR *body, int32_t op, int32_t *seq, int32_t *index) {
+    int32_t s = body->op_a[op], i = body->op_b[op];
+    if (s < 0 || s >= body->slot_count || i < 0 || i >= body->slot_count) return false;
+    if (body->slot_kind[i] != SLOT_I32) return false;
+    int32_t sk = body->slot_kind[s];
+    bool ok = false;
+    switch (body->op_kind[op]) {
+        case BODY_OP_STR_INDEX:
+            ok = sk == SLOT_STR || sk == SLOT_STR_REF;
+            break;
+        case BODY_OP_SEQ_I32_INDEX_DYNAMIC:
+        case BODY_OP_SEQ_I32_INDEX_STORE:
+            ok = sk == SLOT_SEQ_I32 || sk == SLOT_SEQ_I32_REF;
+            break;
+        case BODY_OP_SEQ_STR_INDEX_DYNAMIC:
+            ok = sk == SLOT_SEQ_STR || sk == SLOT_SEQ_STR_REF;
+            break;
+        case BODY_OP_SEQ_OPAQUE_INDEX_DYNAMIC:
+        case BODY_OP_SEQ_OPAQUE_INDEX_STORE:
+        case BODY_OP_SEQ_OPAQUE_INDEX_REF_DYNAMIC:
+            ok = cold_bce_seq_kind(sk);
+            break;
+        default:
+            break;
+    }
+    if (!ok) return false;
+    *seq = s;
+    *index = i;
+    return true;
+}
+
+/* The slot whose length op writes dst, or -1. */
+static int32_t cold_bce_length_source(BodyIR *body, int32_t op) {
+    int32_t kind = body->op_kind[op];
+    int32_t dst = body->op_dst[op], s = body->op_a[op];
+    if (dst < 0 || dst >= body->slot_count || body->slot_kind[dst] != SLOT_I32) return -1;
+    if (s < 0 || s >= body->slot_count || s == dst) return -1;
+    int32_t sk = body->slot_kind[s];
+    if (kind == BODY_OP_STR_LEN && (sk == SLOT_STR || sk == SLOT_STR_REF)) return s;
+    if (kind == BODY_OP_PAYLOAD_LOAD && body->op_b[op] == 0 && cold_bce_seq_kind(sk)) return s;
+    return -1;
+}
+
+/* Ops that write nothing but their dst slot. */
+static bool cold_bce_op_is_pure(int32_t kind) {
+    switch (kind) {
+        case BODY_OP_I32_CONST: case BODY_OP_I64_CONST: case BODY_OP_PTR_CONST:
+        case BODY_OP_F32_CONST: case BODY_OP_F64_CONST:
+        case BODY_OP_COPY_I32: case BODY_OP_COPY_I64: case BODY_OP_COPY_COMPOSITE:
+        case BODY_OP_I32_ADD: case BODY_OP_I32_SUB: case BODY_OP_I32_MUL:
+        case BODY_OP_I32_DIV: case BODY_OP_I32_MOD: case BODY_OP_I32_AND:
+        case BODY_OP_I32_OR: case BODY_OP_I32_XOR: case BODY_OP_I32_SHL:
+        case BODY_OP_I32_ASR: case BODY_OP_I32_CMP:
+        case BODY_OP_I64_ADD: case BODY_OP_I64_SUB: case BODY_OP_I64_MUL:
+        case BODY_OP_I64_DIV: case BODY_OP_I64_AND: case BODY_OP_I64_OR:
+        case BODY_OP_I64_XOR: case BODY_OP_I64_SHL: case BODY_OP_I64_ASR:
+        case BODY_OP_I64_CMP: case BODY_OP_I64_FROM_I32: case BODY_OP_I32_FROM_I64:
+        case BODY_OP_F32_ADD: case BODY_OP_F64_ADD: case BODY_OP_F32_SUB:
+        case BODY_OP_F64_SUB: case BODY_OP_F32_MUL: case BODY_OP_F64_MUL:
+        case BODY_OP_F32_DIV: case BODY_OP_F64_DIV: case BODY_OP_F32_CMP:
+        case BODY_OP_F64_CMP: case BODY_OP_F32_NEG: case BODY_OP_F64_NEG:
+        case BODY_OP_F32_FROM_I32: case BODY_OP_I32_FROM_F32:
+        case BODY_OP_F64_FROM_I32: case BODY_OP_I32_FROM_F64:
+        case BODY_OP_STR_LITERAL: case BODY_OP_STR_LEN: case BODY_OP_STR_EQ:
+        case BODY_OP_TAG_LOAD: case BODY_OP_PAYLOAD_LOAD: case BODY_OP_FIELD_REF:
+        case BODY_OP_MAKE_VARIANT: case BODY_OP_MAKE_COMPOSITE: case BODY_OP_SELECT:
+        case BODY_OP_STR_INDEX: case BODY_OP_SEQ_I32_INDEX:
+        case BODY_OP_SEQ_I32_INDEX_DYNAMIC: case BODY_OP_ARRAY_I32_INDEX_DYNAMIC:
+        case BODY_OP_SEQ_STR_INDEX_DYNAMIC: case BODY_OP_SEQ_OPAQUE_INDEX_DYNAMIC:
+        case BODY_OP_SEQ_OPAQUE_INDEX_REF_DYNAMIC:
+        case BODY_OP_I32_REF_LOAD: case BODY_OP_PTR_LOAD_I32: case BODY_OP_PTR_LOAD_I64:
+        case BODY_OP_PTR_LOAD_U8: case BODY_OP_PTR_LOAD_U16: case BODY_OP_PTR_ADD:
+        case BODY_OP_ARGC_LOAD: case BODY_OP_FN_ADDR:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static int32_t cold_bce_find(ColdBce *bce, int32_t kind, int32_t x, int32_t s) {
+    for (int32_t f = bce->slot_head[x]; f >= 0;
+         f = bce->fact_x[f] == x ? bce->fact_next_x[f] : bce->fact_next_s[f]) {
+        if (bce->fact_kind[f] == kind && bce->fact_x[f] == x && bce->fact_s[f] == s) return f;
+    }
+    return -1;
+}
+
+static int32_t cold_bce_add(ColdBce *bce, int32_t kind, int32_t x, int32_t s) {
+    int32_t f = cold_bce_find(bce, kind, x, s);
+    if (f >= 0) return f;
+    if (bce->fact_count >= bce->fact_cap) {
+        int32_t cap = bce->fact_cap ? bce->fact_cap * 2 : 64;
+        bce->fact_kind = realloc(bce->fact_kind, (size_t)cap * sizeof(int32_t));
+        bce->fact_x = realloc(bce->fact_x, (size_t)cap * sizeof(int32_t));
+        bce->fact_s = realloc(bce->fact_s, (size_t)cap * sizeof(int32_t));
+        bce->fact_next_x = realloc(bce->fact_next_x, (size_t)cap * sizeof(int32_t));
+        bce->fact_next_s = realloc(bce->fact_next_s, (size_t)cap * sizeof(int32_t));
+        if (!bce->fact_kind || !bce->fact_x || !bce->fact_s ||
+            !bce->fact_next_x || !bce->fact_next_s) die("out of memory");
+        bce->fact_cap = cap;
+    }
+    f = bce->fact_count++;
+    bce->fact_kind[f] = kind;
+    bce->fact_x[f] = x;
+    bce->fact_s[f] = s;
+    bce->fact_next_x[f] = bce->slot_head[x];
+    bce->slot_head[x] = f;
+    bce->fact_next_s[f] = -1;
+    if (s >= 0 && s != x) {
+        bce->fact_next_s[f] = bce->slot_head[s];
+        bce->slot_head[s] = f;
+    }
+    return f;
+}
+
+#define COLD_BCE_HAS(bits, f) (((bits)[(f) >> 6] >> ((f) & 63)) & 1)
+#define COLD_BCE_SET(bits, f) ((bits)[(f) >> 6] |= (uint64_t)1 << ((f) & 63))
+#define COLD_BCE_CLEAR(bits, f) ((bits)[(f) >> 6] &= ~((uint64_t)1 << ((f) & 63)))
+
+static bool cold_bce_has(ColdBce *bce, const uint64_t *bits, int32_t kind, int32_t x, int32_t s) {
+    int32_t f = cold_bce_find(bce, kind, x, s);
+    return f >= 0 && COLD_BCE_HAS(bits, f);
+}
+
+static void cold_bce_gen(ColdBce *bce, uint64_t *bits, int32_t kind, int32_t x, int32_t s) {
+    int32_t f = cold_bce_find(bce, kind, x, s);
+    if (f >= 0) COLD_BCE_SET(bits, f);
+}
+
+static void cold_bce_kill_slot(ColdBce *bce, uint64_t *bits, int32_t slot) {
+    for (int32_t f = bce->slot_head[slot]; f >= 0;
+         f = bce->fact_x[f] == slot ? bce->fact_next_x[f] : bce->fact_next_s[f]) {
+        COLD_BCE_CLEAR(bits, f);
+    }
+}
+
+static void cold_bce_kill_volatile(ColdBce *bce, uint64_t *bits) {
+    for (int32_t f = 0; f < bce->fact_count; f++) {
+        int32_t s = bce->fact_s[f];
+        if (bce->slot_volatile[bce->fact_x[f]] || (s >= 0 && bce->slot_volatile[s]))
+            COLD_BCE_CLEAR(bits, f);
+    }
+}
+
+/* x < y holds: every s whose length y holds bounds a non-negative x. */
+static void cold_bce_gen_less(ColdBce *bce, uint64_t *bits, const uint64_t *at, int32_t x, int32_t y) {
+    if (x < 0 || y < 0 || x >= bce->body->slot_count || y >= bce->body->slot_count) return;
+    if (!cold_bce_has(bce, at, COLD_BCE_NONNEG, x, -1)) return;
+    for (int32_t f = bce->slot_head[y]; f >= 0;
+         f = bce->fact_x[f] == y ? bce->fact_next_x[f] : bce->fact_next_s[f]) {
+        if (bce->fact_kind[f] == COLD_BCE_LEN && bce->fact_x[f] == y && COLD_BCE_HAS(at, f))
+            cold_bce_gen(bce, bits, COLD_BCE_IDX, x, bce->fact_s[f]);
+    }
+}
+
+/* Runs the ops of block over bits; with proven set, records the checks the
+   facts already imply. Returns the last I32_CMP whose result and operands
+   are still live at the end of the block, or -1. */
+static int32_t cold_bce_transfer(ColdBce *bce, int32_t block, uint64_t *bits, bool *proven) {
+    BodyIR *body = bce->body;
+    int32_t slot_count = body->slot_count;
+    int32_t bs = body->block_op_start[block];
+    int32_t be = bs + body->block_op_count[block];
+    int32_t last_cmp = -1;
+    for (int32_t op = bs; op < be; op++) {
+        int32_t kind = body->op_kind[op];
+        if (kind <= 0) continue;
+        int32_t dst = body->op_dst[op], a = body->op_a[op], b = body->op_b[op];
+        bool has_dst = dst >= 0 && dst < slot_count;
+        /* facts about operands hold after the op unless it overwrites them;
+           facts about the result are recorded after the kill of dst */
+        int32_t gen_kind[2], gen_x[2], gen_s[2], gen_count = 0;
+        int32_t seq, index;
+        if (cold_bce_checked_index(body, op, &seq, &index)) {
+            if (proven && cold_bce_has(bce, bits, COLD_BCE_IDX, index, seq)) proven[op] = true;
+            gen_kind[gen_count] = COLD_BCE_IDX; gen_x[gen_count] = index; gen_s[gen_count++] = seq;
+            gen_kind[gen_count] = COLD_BCE_NONNEG; gen_x[gen_count] = index; gen_s[gen_count++] = -1;
+        }
+        int32_t len_of = cold_bce_length_source(body, op);
+        bool result_nonneg = len_of >= 0 || (kind == BODY_OP_I32_CONST && a >= 0);
+        if (kind == BODY_OP_COPY_I32 && has_dst && a >= 0 && a < slot_count && a != dst)
+            result_nonneg = cold_bce_has(bce, bits, COLD_BCE_NONNEG, a, -1);
+        if (kind == BODY_OP_I32_ADD && has_dst) {
+            /* x + 0 keeps x >= 0; x + 1 cannot overflow while x < len */
+            for (int32_t side = 0; side < 2 && !result_nonneg; side++) {
+                int32_t x = side ? b : a, k = side ? a : b;
+                if (x < 0 || x >= slot_count || k < 0 || k >= slot_count) continue;
+                int32_t kop = bce->const_op[k];
+                if (kop < bs || kop >= op) continue;
+                int32_t v = body->op_a[kop];
+                if (v == 0) result_nonneg = cold_bce_has(bce, bits, COLD_BCE_NONNEG, x, -1);
+                for (int32_t f = bce->slot_head[x]; v == 1 && f >= 0 && !result_nonneg;
+                     f = bce->fact_x[f] == x ? bce->fact_next_x[f] : bce->fact_next_s[f]) {
+                    result_nonneg = bce->fact_kind[f] == COLD_BCE_IDX && bce->fact_x[f] == x &&
+                                    COLD_BCE_HAS(bits, f);
+                }
+            }
+        }
+        /* LEN(a, s) carries over a copy */
+        int32_t copy_s[8], copy_count = 0;
+        if (kind == BODY_OP_COPY_I32 && has_dst && a >= 0 && a < slot_count && a != dst) {
+            for (int32_t f = bce->slot_head[a]; f >= 0 && copy_count < 8;
+                 f = bce->fact_x[f] == a ? bce->fact_next_x[f] : bce->fact_next_s[f]) {
+                if (bce->fact_kind[f] == COLD_BCE_LEN && bce->fact_x[f] == a && COLD_BCE_HAS(bits, f))
+                    copy_s[copy_count++] = bce->fact_s[f];
+            }
+        }
+
+        if (has_dst) {
+            cold_bce_kill_slot(bce, bits, dst);
+            bce->const_op[dst] = kind == BODY_OP_I32_CONST ? op : -1;
+            if (last_cmp >= 0 && (dst == body->op_dst[last_cmp] || dst == body->op_a[last_cmp] ||
+                                  dst == body->op_b[last_cmp])) last_cmp = -1;
+        }
+        if (!cold_bce_op_is_pure(kind) || (has_dst && bce->slot_volatile[dst])) {
+            /* it may also write through or into its operands */
+            cold_bce_kill_volatile(bce, bits);
+            if (a >= 0 && a < slot_count) cold_bce_kill_slot(bce, bits, a);
+            if (b >= 0 && b < slot_count) cold_bce_kill_slot(bce, bits, b);
+            int32_t c = body->op_c[op];
+            if (cold_op_reads_c_slot(kind) && c >= 0 && c < slot_count) cold_bce_kill_slot(bce, bits, c);
+        }
+        if (kind == BODY_OP_I32_CMP && has_dst && a != dst && b != dst) last_cmp = op;
+
+        for (int32_t g = 0; g < gen_count; g++) {
+            if (has_dst && (gen_x[g] == dst || gen_s[g] == dst)) continue;
+            cold_bce_gen(bce, bits, gen_kind[g], gen_x[g], gen_s[g]);
+        }
+        if (!has_dst) continue;
+        if (result_nonneg) cold_bce_gen(bce, bits, COLD_BCE_NONNEG, dst, -1);
+        if (len_of >= 0) cold_bce_gen(bce, bits, COLD_BCE_LEN, dst, len_of);
+        for (int32_t ci = 0; ci < copy_count; ci++)
+            if (copy_s[ci] != dst) cold_bce_gen(bce, bits, COLD_BCE_LEN, dst, copy_s[ci]);
+    }
+    return last_cmp;
+}
+
+/* Applies to bits the facts a CBR establishes on its true (or false) edge. */
+static void cold_bce_edge(ColdBce *bce, int32_t block, int32_t last_cmp, bool taken,
+                          const uint64_t *out, uint64_t *bits) {
+    BodyIR *body = bce->body;
+    int32_t term = body->block_term[block];
+    int32_t x = body->term_value[term];
+    int32_t cond = body->term_case_start[term];
+    int32_t y = body->term_case_count[term];
+    if ((cond == COND_NE || cond == COND_EQ) && last_cmp >= 0 && body->op_dst[last_cmp] == x &&
+        y >= 0 && y < body->slot_count) {
+        /* flag != 0 where flag = cmp(a, b) */
+        int32_t zop = bce->const_op[y];
+        int32_t bs = body->block_op_start[block];
+        if (zop < bs || zop >= bs + body->block_op_count[block] || body->op_a[zop] != 0) return;
+        if (cond == COND_EQ) taken = !taken;
+        x = body->op_a[last_cmp];
+        y = body->op_b[last_cmp];
+        cond = body->op_c[last_cmp];
+    }
+    if (!taken) {
+        if (cond == COND_LT) cond = COND_GE;
+        else if (cond == COND_GE) cond = COND_LT;
+        else if (cond == COND_GT) cond = COND_LE;
+        else if (cond == COND_LE) cond = COND_GT;
+        else return;
+    }
+    if (cond == COND_LT) cold_bce_gen_less(bce, bits, out, x, y);
+    else if (cond == COND_GT) cold_bce_gen_less(bce, bits, out, y, x);
+}
+
+static void cold_eliminate_bounds_checks(BodyIR *body) {
+    if (!body || body->op_count <= 0 || body->block_count <= 0 || body->slot_count <= 0) return;
+    int32_t slot_count = body->slot_count;
+    int32_t block_count = body->block_count;
+    ColdBce bce = {0};
+    bce.body = body;
+    bce.slot_head = malloc((size_t)slot_count * sizeof(int32_t));
+    bce.slot_volatile = calloc((size_t)slot_count, sizeof(bool));
+    bce.const_op = malloc((size_t)slot_count * sizeof(int32_t));
+    if (!bce.slot_head || !bce.slot_volatile || !bce.const_op) die("out of memory");
+    for (int32_t s = 0; s < slot_count; s++) bce.slot_head[s] = bce.const_op[s] = -1;
+
+    /* Fact universe: IDX per index op, LEN per length op (and its copies),
+       NONNEG for index slots and what flows into them. */
+    int32_t index_ops = 0;
+    bool *relevant = calloc((size_t)slot_count, sizeof(bool));
+    if (!relevant) die("out of memory");
+    for (int32_t op = 0; op < body->op_count; op++) {
+        int32_t seq, index;
+        if (body->op_kind[op] <= 0 || !cold_bce_checked_index(body, op, &seq, &index)) continue;
+        cold_bce_add(&bce, COLD_BCE_IDX, index, seq);
+        relevant[index] = true;
+        index_ops++;
+    }
+    if (index_ops == 0) {
+        free(relevant);
+        free(bce.slot_head);
+        free(bce.slot_volatile);
+        free(bce.const_op);
+        return;
+    }
+    for (bool grew = true; grew;) {
+        grew = false;
+        for (int32_t op = 0; op < body->op_count; op++) {
+            int32_t kind = body->op_kind[op], dst = body->op_dst[op];
+            int32_t a = body->op_a[op], b = body->op_b[op];
+            if (kind <= 0 || dst < 0 || dst >= slot_count) continue;
+            int32_t len_of = cold_bce_length_source(body, op);
+            if (len_of >= 0) {
+                int32_t before = bce.fact_count;
+                cold_bce_add(&bce, COLD_BCE_LEN, dst, len_of);
+                grew |= bce.fact_count != before;
+            }
+            if (kind == BODY_OP_COPY_I32 && a >= 0 && a < slot_count && a != dst) {
+                for (int32_t f = bce.slot_head[a]; f >= 0;
+                     f = bce.fact_x[f] == a ? bce.fact_next_x[f] : bce.fact_next_s[f]) {
+                    if (bce.fact_kind[f] != COLD_BCE_LEN || bce.fact_x[f] != a || bce.fact_s[f] == dst) continue;
+                    int32_t before = bce.fact_count;
+                    cold_bce_add(&bce, COLD_BCE_LEN, dst, bce.fact_s[f]);
+                    grew |= bce.fact_count != before;
+                }
+            }
+            if (!relevant[dst]) continue;
+            if (kind == BODY_OP_COPY_I32 && a >= 0 && a < slot_count && !relevant[a]) {
+                relevant[a] = true;
+                grew = true;
+            }
+            if (kind == BODY_OP_I32_ADD) {
+                if (a >= 0 && a < slot_count && !relevant[a]) { relevant[a] = true; grew = true; }
+                if (b >= 0 && b < slot_count && !relevant[b]) { relevant[b] = true; grew = true; }
+            }
+        }
+    }
+    for (int32_t s = 0; s < slot_count; s++) {
+        if (relevant[s]) cold_bce_add(&bce, COLD_BCE_NONNEG, s, -1);
+        int32_t kind = body->slot_kind[s];
+        bce.slot_volatile[s] = kind == SLOT_PTR || kind == SLOT_OBJECT_REF || kind == SLOT_STR_REF ||
+                               kind == SLOT_SEQ_I32_REF || kind == SLOT_SEQ_STR_REF ||
+                               kind == SLOT_SEQ_OPAQUE_REF || kind == SLOT_OPAQUE_REF ||
+                               kind == SLOT_I32_REF || kind == SLOT_I64_REF;
+    }
+    free(relevant);
+    cold_mark_escaped_slots(body, bce.slot_volatile);
+
+    int32_t words = (bce.fact_count + 63) / 64;
+    bce.words = words;
+    uint64_t *in = malloc((size_t)block_count * (size_t)words * sizeof(uint64_t));
+    uint64_t *out = malloc((size_t)words * sizeof(uint64_t));
+    uint64_t *edge = malloc((size_t)words * sizeof(uint64_t));
+    bool *reached = calloc((size_t)block_count, sizeof(bool));
+    int32_t *stack = malloc((size_t)block_count * sizeof(int32_t));
+    int32_t succ_cap = body->switch_count + 3;
+    int32_t *succ = malloc((size_t)succ_cap * sizeof(int32_t));
+    if (!in || !out || !edge || !reached || !stack || !succ) die("out of memory");
+
+    /* Unreached blocks keep no facts; reached ones start from "everything"
+       except the entry, and only lose facts until the fixed point. */
+    int32_t depth = 0;
+    reached[0] = true;
+    stack[depth++] = 0;
+    while (depth > 0) {
+        int32_t n = cold_block_successors(body, stack[--depth], succ, succ_cap);
+        for (int32_t i = 0; i < n; i++)
+            if (!reached[succ[i]]) { reached[succ[i]] = true; stack[depth++] = succ[i]; }
+    }
+    for (int32_t bi = 0; bi < block_count; bi++)
+        memset(in + (size_t)bi * words, bi > 0 && reached[bi] ? 0xFF : 0, (size_t)words * sizeof(uint64_t));
+
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (int32_t bi = 0; bi < block_count; bi++) {
+            if (!reached[bi]) continue;
+            memcpy(out, in + (size_t)bi * words, (size_t)words * sizeof(uint64_t));
+            int32_t last_cmp = cold_bce_transfer(&bce, bi, out, NULL);
+            int32_t term = body->block_term[bi];
+            bool cbr = term >= 0 && term < body->term_count && body->term_kind[term] == BODY_TERM_CBR &&
+                       body->term_true_block[term] != body->term_false_block[term];
+            int32_t n = cold_block_successors(body, bi, succ, succ_cap);
+            for (int32_t i = 0; i < n; i++) {
+                memcpy(edge, out, (size_t)words * sizeof(uint64_t));
+                if (cbr) cold_bce_edge(&bce, bi, last_cmp, succ[i] == body->term_true_block[term], out, edge);
+                uint64_t *target = in + (size_t)succ[i] * words;
+                for (int32_t w = 0; w < words; w++) {
+                    uint64_t next = target[w] & edge[w];
+                    if (next != target[w]) { target[w] = next; changed = true; }
+                }
+            }
+        }
+    }
+
+    bool *proven = calloc((size_t)body->op_count, sizeof(bool));
+    if (!proven) die("out of memory");
+    for (int32_t bi = 0; bi < block_count; bi++) {
+        if (!reached[bi]) continue;
+        memcpy(out, in + (size_t)bi * words, (size_t)words * sizeof(uint64_t));
+        cold_bce_transfer(&bce, bi, out, proven);
+    }
+    int32_t removed = 0;
+    for (int32_t op = 0; op < body->op_count; op++) removed += proven[op] ? 1 : 0;
+    free(body->op_bounds_proven);
+    body->op_bounds_proven = removed > 0 ? proven : NULL;
+    if (removed == 0) free(proven);
+    __atomic_add_fetch(&cold_bce_checks_removed, removed, __ATOMIC_RELAXED);
+
+    free(in);
+    free(out);
+    free(edge);
+    free(reached);
+    free(stack);
+    free(succ);
+    free(bce.fact_kind);
+    free(bce.fact_x);
+    free(bce.fact_s);
+    free(bce.fact_next_x);
+    free(bce.fact_next_s);
+    free(bce.slot_head);
+    free(bce.slot_volatile);
+    free(bce.const_op);
+}
+
+/* Drops the flags once a backend has emitted the body. */
+static void cold_release_bounds_checks(BodyIR *body) {
+    free(body->op_bounds_proven);
+    body->op_bounds_proven = NULL;
+}
+
+/* ---- Global value numbering ----
+   Slots are mutable, so a value number names what a slot holds at one point
+   of the walk. Inside a block every write gives its slot a new number.
+   Across blocks only stable slots keep theirs: never address-taken, written
+   by at most one op, and read where that writer dominates. Between the last
+   run of such a writer and any op it dominates no writer of its operands
+   runs again, so an expression over stable values names one value in every
+   block below it in the dominator tree.
+   A pure op whose value a slot already holds becomes a copy of that slot;
+   operands that repeat a held value read the first slot holding it, which
+   leaves the copies to DSE. Loads through pointers, of heap elements or of
+   ref slots only match inside a block until an op that may write memory. */
+enum { COLD_GVN_NONE = 0, COLD_GVN_IMM = 1, COLD_GVN_A = 2, COLD_GVN_AB = 3 };
+
+typedef struct ColdGvnEntry {
+    int32_t kind, x, y, imm_b, imm_c, shape;
+    int32_t vn, leader, epoch, next;
+} ColdGvnEntry;
+
+/* Chained hash table; entries are removed in reverse insertion order. */
+typedef struct ColdGvnTable {
+    int32_t *head;
+    int32_t mask;
+    ColdGvnEntry *entry;
+    int32_t count;
+    int32_t cap;
+} ColdGvnTable;
+
+typedef struct ColdGvn {
+    BodyIR *body;
+    const bool *dom;
+    bool *escaped;
+    int32_t *writer_count;
+    int32_t *writer_op;       /* the writer when writer_count is 1 */
+    int32_t *op_block;
+    int32_t *vn_local;        /* valid where local_stamp matches stamp */
+    int32_t *local_stamp;
+    int32_t *vn_stable;       /* number of a stable slot below its writer */
+    int32_t stamp;
+    int32_t block;
+    int32_t *vn_leader;
+    bool *vn_global;
+    bool *vn_const;
+    int32_t vn_count;
+    int32_t vn_cap;
+    int32_t epoch;            /* bumped by every op that may write memory */
+    ColdGvnTable global;
+    ColdGvnTable local;
+} ColdGvn;
+
+/* Operand form of the ops value numbering understands. */
+static int32_t cold_gvn_form(int32_t kind) {
+    switch (kind) {
+        case BODY_OP_I32_CONST: case BODY_OP_I64_CONST:
+            return COLD_GVN_IMM;
+        case BODY_OP_I64_FROM_I32: case BODY_OP_I32_FROM_I64:
+        case BODY_OP_STR_LEN: case BODY_OP_TAG_LOAD: case BODY_OP_PAYLOAD_LOAD:
+        case BODY_OP_I32_REF_LOAD: case BODY_OP_PTR_LOAD_I32: case BODY_OP_PTR_LOAD_I64:
+        case BODY_OP_PTR_LOAD_U8: case BODY_OP_PTR_LOAD_U16:
+            return COLD_GVN_A;
+        case BODY_OP_I32_ADD: case BODY_OP_I32_SUB: case BODY_OP_I32_MUL:
+        case BODY_OP_I32_DIV: case BODY_OP_I32_MOD: case BODY_OP_I32_AND:
+        case BODY_OP_I32_OR: case BODY_OP_I32_XOR: case BODY_OP_I32_SHL:
+        case BODY_OP_I32_ASR: case BODY_OP_I32_CMP:
+        case BODY_OP_I64_ADD: case BODY_OP_I64_SUB: case BODY_OP_I64_MUL:
+        case BODY_OP_I64_DIV: case BODY_OP_I64_AND: case BODY_OP_I64_OR:
+        case BODY_OP_I64_XOR: case BODY_OP_I64_SHL: case BODY_OP_I64_ASR:
+        case BODY_OP_I64_CMP: case BODY_OP_PTR_ADD:
+        case BODY_OP_STR_INDEX: case BODY_OP_SEQ_I32_INDEX_DYNAMIC:
+        case BODY_OP_SEQ_STR_INDEX_DYNAMIC: case BODY_OP_SEQ_OPAQUE_INDEX_DYNAMIC:
+        case BODY_OP_SEQ_OPAQUE_INDEX_REF_DYNAMIC:
+            return COLD_GVN_AB;
+        default:
+            return COLD_GVN_NONE;
+    }
+}
+
+static bool cold_gvn_pointer_kind(int32_t kind) {
+    return kind == SLOT_PTR || kind == SLOT_OBJECT_REF || kind == SLOT_STR_REF ||
+           kind == SLOT_SEQ_I32_REF || kind == SLOT_SEQ_STR_REF ||
+           kind == SLOT_SEQ_OPAQUE_REF || kind == SLOT_OPAQUE_REF ||
+           kind == SLOT_I32_REF || kind == SLOT_I64_REF;
+}
+
+/* The op reads memory no slot write tracks. */
+static bool cold_gvn_reads_memory(BodyIR *body, int32_t op) {
+    switch (body->op_kind[op]) {
+        case BODY_OP_STR_LEN: case BODY_OP_TAG_LOAD: case BODY_OP_PAYLOAD_LOAD:
+            return cold_gvn_pointer_kind(body->slot_kind[body->op_a[op]]);
+        case BODY_OP_I32_REF_LOAD: case BODY_OP_PTR_LOAD_I32: case BODY_OP_PTR_LOAD_I64:
+        case BODY_OP_PTR_LOAD_U8: case BODY_OP_PTR_LOAD_U16:
+        case BODY_OP_STR_INDEX: case BODY_OP_SEQ_I32_INDEX_DYNAMIC:
+        case BODY_OP_SEQ_STR_INDEX_DYNAMIC: case BODY_OP_SEQ_OPAQUE_INDEX_DYNAMIC:
+        case BODY_OP_SEQ_OPAQUE_INDEX_REF_DYNAMIC:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/* Copy op that moves dst's kind, or 0. */
+static int32_t cold_gvn_copy_kind(BodyIR *body, int32_t slot) {
+    int32_t kind = body->slot_kind[slot];
+    if (kind == SLOT_I32) return BODY_OP_COPY_I32;
+    if (kind == SLOT_I64 || kind == SLOT_PTR) return BODY_OP_COPY_I64;
+    if ((kind == SLOT_OBJECT || kind == SLOT_VARIANT || kind == SLOT_STR) &&
+        body->slot_size[slot] > 0 && body->slot_size[slot] % 8 == 0)
+        return BODY_OP_COPY_COMPOSITE;
+    return 0;
+}
+
+/* Slots op may change: its dst, and the operands of an op that can write
+   through them. */
+static bool cold_gvn_op_writes(BodyIR *body, int32_t op, int32_t slot) {
+    int32_t kind = body->op_kind[op];
+    if (kind <= 0) return false;
+    if (body->op_dst[op] == slot) return true;
+    if (cold_bce_op_is_pure(kind)) return false;
+    return body->op_a[op] == slot || body->op_b[op] == slot ||
+           (cold_op_reads_c_slot(kind) && body->op_c[op] == slot);
+}
+
+/* Per slot, how many ops may change it and the last of them. */
+static void cold_count_slot_writers(BodyIR *body, int32_t *writer_count, int32_t *writer_op) {
+    for (int32_t op = 0; op < body->op_count; op++) {
+        int32_t kind = body->op_kind[op];
+        if (kind <= 0) continue;
+        int32_t slots[4] = {body->op_dst[op], -1, -1, -1};
+        if (!cold_bce_op_is_pure(kind)) {
+            slots[1] = body->op_a[op];
+            slots[2] = body->op_b[op];
+            if (cold_op_reads_c_slot(kind)) slots[3] = body->op_c[op];
+        }
+        for (int32_t i = 0; i < 4; i++) {
+            int32_t s = slots[i];
+            if (s < 0 || s >= body->slot_count) continue;
+            bool seen = false;
+            for (int32_t j = 0; j < i; j++) seen = seen || slots[j] == s;
+            if (seen) continue;
+            writer_count[s]++;
+            writer_op[s] = op;
+        }
+    }
+}
+
+static void cold_gvn_table_init(ColdGvnTable *t, int32_t want) {
+    int32_t size = 64;
+    while (size < want * 2) size *= 2;
+    t->mask = size - 1;
+    t->head = malloc((size_t)size * sizeof(int32_t));
+    t->cap = 64;
+    t->entry = malloc((size_t)t->cap * sizeof(ColdGvnEntry));
+    if (!t->head || !t->entry) die("out of memory");
+    for (int32_t i = 0; i < size; i++) t->head[i] = -1;
+    t->count = 0;
+}
+
+static uint32_t cold_gvn_hash(const ColdGvnEntry *e) {
+    uint32_t h = 2166136261u;
+    int32_t v[6] = {e->kind, e->x, e->y, e->imm_b, e->imm_c, e->shape};
+    for (int32_t i = 0; i < 6; i++) h = (h ^ (uint32_t)v[i]) * 16777619u;
+    return h;
+}
+
+static ColdGvnEntry *cold_gvn_table_find(ColdGvnTable *t, const ColdGvnEntry *key) {
+    for (int32_t i = t->head[cold_gvn_hash(key) & (uint32_t)t->mask]; i >= 0; i = t->entry[i].next) {
+        ColdGvnEntry *e = &t->entry[i];
+        if (e->kind == key->kind && e->x == key->x && e->y == key->y &&
+            e->imm_b == key->imm_b && e->imm_c == key->imm_c && e->shape == key->shape) return e;
+    }
+    return NULL;
+}
+
+static void cold_gvn_table_push(ColdGvnTable *t, const ColdGvnEntry *key) {
+    if (t->count >= t->cap) {
+        t->cap *= 2;
+        t->entry = realloc(t->entry, (size_t)t->cap * sizeof(ColdGvnEntry));
+        if (!t->entry) die("out of memory");
+    }
+    uint32_t bucket = cold_gvn_hash(key) & (uint32_t)t->mask;
+    t->entry[t->count] = *key;
+    t->entry[t->count].next = t->head[bucket];
+    t->head[bucket] = t->count++;
+}
+
+static void cold_gvn_table_pop_to(ColdGvnTable *t, int32_t count) {
+    while (t->count > count) {
+        ColdGvnEntry *e = &t->entry[--t->count];
+        t->head[cold_gvn_hash(e) & (uint32_t)t->mask] = e->next;
+    }
+}
+
+static int32_t cold_gvn_new_vn(ColdGvn *g, int32_t leader, bool global) {
+    if (g->vn_count >= g->vn_cap) {
+        g->vn_cap = g->vn_cap ? g->vn_cap * 2 : 256;
+        g->vn_leader = realloc(g->vn_leader, (size_t)g->vn_cap * sizeof(int32_t));
+        g->vn_global = realloc(g->vn_global, (size_t)g->vn_cap * sizeof(bool));
+        g->vn_const = realloc(g->vn_const, (size_t)g->vn_cap * sizeof(bool));
+        if (!g->vn_leader || !g->vn_global || !g->vn_const) die("out of memory");
+    }
+    int32_t vn = g->vn_count++;
+    g->vn_leader[vn] = leader;
+    g->vn_global[vn] = global;
+    g->vn_const[vn] = false;
+    return vn;
+}
+
+/* Value number of what slot holds before the next op of the block. */
+static int32_t cold_gvn_slot_vn(ColdGvn *g, int32_t slot) {
+    if (g->local_stamp[slot] == g->stamp) return g->vn_local[slot];
+    if (g->escaped[slot]) return cold_gvn_new_vn(g, -1, false);
+    int32_t vn = -1;
+    if (g->writer_count[slot] == 0) {
+        if (g->vn_stable[slot] < 0) g->vn_stable[slot] = cold_gvn_new_vn(g, slot, true);
+        vn = g->vn_stable[slot];
+    } else if (g->writer_count[slot] == 1 && g->vn_stable[slot] >= 0) {
+        int32_t wb = g->op_block[g->writer_op[slot]];
+        if (wb != g->block && g->dom[g->block * g->body->block_count + wb]) vn = g->vn_stable[slot];
+    }
+    if (vn < 0) vn = cold_gvn_new_vn(g, slot, false);
+    g->vn_local[slot] = vn;
+    g->local_stamp[slot] = g->stamp;
+    return vn;
+}
+
+static void cold_gvn_assign(ColdGvn *g, int32_t slot, int32_t vn) {
+    g->vn_local[slot] = vn;
+    g->local_stamp[slot] = g->stamp;
+    if (g->writer_count[slot] == 1 && !g->escaped[slot])
+        g->vn_stable[slot] = g->vn_global[vn] ? vn : cold_gvn_new_vn(g, slot, true);
+}
+
+/* Reads slot's value from the first slot holding it, when that differs. */
+static int32_t cold_gvn_leader_operand(ColdGvn *g, int32_t slot, int32_t *changed) {
+    BodyIR *body = g->body;
+    int32_t vn = cold_gvn_slot_vn(g, slot);
+    int32_t leader = g->vn_leader[vn];
+    if (leader < 0 || leader == slot || g->vn_const[vn] || g->escaped[leader]) return slot;
+    if (body->slot_kind[leader] != body->slot_kind[slot] ||
+        body->slot_size[leader] != body->slot_size[slot]) return slot;
+    if (cold_gvn_slot_vn(g, leader) != vn) return slot;
+    (*changed)++;
+    return leader;
+}
+
+static void cold_gvn_block(ColdGvn *g, int32_t block, int32_t *changed) {
+    BodyIR *body = g->body;
+    int32_t slot_count = body->slot_count;
+    g->stamp++;
+    g->block = block;
+    int32_t bs = body->block_op_start[block];
+    int32_t be = bs + body->block_op_count[block];
+    for (int32_t op = bs; op < be; op++) {
+        int32_t kind = body->op_kind[op];
+        if (kind <= 0) continue;
+        int32_t dst = body->op_dst[op];
+        bool has_dst = dst >= 0 && dst < slot_count;
+        int32_t form = cold_gvn_form(kind);
+        if (form != COLD_GVN_NONE && has_dst && !g->escaped[dst]) {
+            if (form >= COLD_GVN_A) {
+                int32_t a = body->op_a[op];
+                if (a < 0 || a >= slot_count) form = COLD_GVN_NONE;
+                else body->op_a[op] = cold_gvn_leader_operand(g, a, changed);
+            }
+            if (form == COLD_GVN_AB) {
+                int32_t b = body->op_b[op];
+                if (b < 0 || b >= slot_count) form = COLD_GVN_NONE;
+                else body->op_b[op] = cold_gvn_leader_operand(g, b, changed);
+            }
+        } else {
+            form = COLD_GVN_NONE;
+        }
+
+        if (form == COLD_GVN_NONE) {
+            int32_t a = body->op_a[op];
+            if ((kind == BODY_OP_COPY_I32 || kind == BODY_OP_COPY_I64 || kind == BODY_OP_COPY_COMPOSITE) &&
+                has_dst && !g->escaped[dst] && a >= 0 && a < slot_count && a != dst &&
+                body->slot_kind[a] == body->slot_kind[dst] && body->slot_size[a] == body->slot_size[dst]) {
+                cold_gvn_assign(g, dst, cold_gvn_slot_vn(g, a));
+                continue;
+            }
+            if (!cold_bce_op_is_pure(kind)) {
+                g->epoch++;
+                int32_t b = body->op_b[op], c = body->op_c[op];
+                if (a >= 0 && a < slot_count) g->local_stamp[a] = -1;
+                if (b >= 0 && b < slot_count) g->local_stamp[b] = -1;
+                if (cold_op_reads_c_slot(kind) && c >= 0 && c < slot_count) g->local_stamp[c] = -1;
+            }
+            /* a write this pass cannot name reads back as a fresh value */
+            if (has_dst) g->local_stamp[dst] = -1;
+            continue;
+        }
+
+        ColdGvnEntry key = {0};
+        key.kind = kind;
+        key.x = key.y = -1;
+        bool global = true;
+        if (form == COLD_GVN_IMM) {
+            key.imm_b = body->op_a[op];
+            key.imm_c = body->op_b[op];
+        } else {
+            key.x = cold_gvn_slot_vn(g, body->op_a[op]);
+            global = g->vn_global[key.x];
+            if (form == COLD_GVN_AB) {
+                key.y = cold_gvn_slot_vn(g, body->op_b[op]);
+                global = global && g->vn_global[key.y];
+            } else {
+                key.imm_b = body->op_b[op];
+            }
+            key.imm_c = body->op_c[op];
+        }
+        key.shape = body->slot_kind[dst] | (body->slot_size[dst] << 8);
+        bool memory = form != COLD_GVN_IMM && cold_gvn_reads_memory(body, op);
+        if (memory) global = false;
+
+        ColdGvnEntry *hit = cold_gvn_table_find(&g->local, &key);
+        if (hit && memory && hit->epoch != g->epoch) hit = NULL;
+        if (!hit && !memory) hit = cold_gvn_table_find(&g->global, &key);
+        if (hit && cold_gvn_slot_vn(g, hit->leader) == hit->vn) {
+            int32_t leader = hit->leader, vn = hit->vn;
+            if (form != COLD_GVN_IMM) {
+                int32_t copy = cold_gvn_copy_kind(body, dst);
+                if (leader == dst) {
+                    body->op_kind[op] = BODY_OP_NOP;
+                    (*changed)++;
+                    __atomic_add_fetch(&cold_gvn_values_reused, 1, __ATOMIC_RELAXED);
+                } else if (copy != 0 && body->slot_kind[leader] == body->slot_kind[dst] &&
+                           body->slot_size[leader] == body->slot_size[dst]) {
+                    body->op_kind[op] = copy;
+                    body->op_a[op] = leader;
+                    body->op_b[op] = 0;
+                    body->op_c[op] = 0;
+                    (*changed)++;
+                    __atomic_add_fetch(&cold_gvn_values_reused, 1, __ATOMIC_RELAXED);
+                }
+            }
+            cold_gvn_assign(g, dst, vn);
+            continue;
+        }
+
+        int32_t vn = cold_gvn_new_vn(g, dst, global);
+        g->vn_const[vn] = form == COLD_GVN_IMM;
+        key.vn = vn;
+        key.leader = dst;
+        key.epoch = g->epoch;
+        cold_gvn_table_push(&g->local, &key);
+        if (global && g->writer_count[dst] == 1) cold_gvn_table_push(&g->global, &key);
+        cold_gvn_assign(g, dst, vn);
+    }
+}
+
+/* Returns how many ops and operands it rewrote. */
+static int32_t cold_apply_gvn(BodyIR *body) {
+    if (!body || body->op_count <= 0 || body->block_count <= 0 || body->slot_count <= 0) return 0;
+    int32_t slot_count = body->slot_count;
+    int32_t block_count = body->block_count;
+    bool *dom = cold_build_block_dominators(body);
+    if (!dom) return 0;
+    ColdGvn g = {0};
+    g.body = body;
+    g.dom = dom;
+    g.escaped = calloc((size_t)slot_count, sizeof(bool));
+    g.writer_count = calloc((size_t)slot_count, sizeof(int32_t));
+    g.writer_op = malloc((size_t)slot_count * sizeof(int32_t));
+    g.vn_local = malloc((size_t)slot_count * sizeof(int32_t));
+    g.local_stamp = malloc((size_t)slot_count * sizeof(int32_t));
+    g.vn_stable = malloc((size_t)slot_count * sizeof(int32_t));
+    g.op_block = malloc((size_t)body->op_count * sizeof(int32_t));
+    int32_t *idom = malloc((size_t)block_count * sizeof(int32_t));
+    int32_t *depth = calloc((size_t)block_count, sizeof(int32_t));
+    int32_t *child_head = malloc((size_t)block_count * sizeof(int32_t));
+    int32_t *child_next = malloc((size_t)block_count * sizeof(int32_t));
+    int32_t *stack = malloc((size_t)block_count * 2 * sizeof(int32_t));
+    int32_t *mark = malloc((size_t)block_count * 2 * sizeof(int32_t));
+    bool *reached = calloc((size_t)block_count, sizeof(bool));
+    int32_t succ_cap = body->switch_count + 3;
+    int32_t *succ = malloc((size_t)succ_cap * sizeof(int32_t));
+    if (!g.escaped || !g.writer_count || !g.writer_op || !g.vn_local || !g.local_stamp ||
+        !g.vn_stable || !g.op_block || !idom || !depth || !child_head || !child_next ||
+        !stack || !mark || !reached || !succ) die("out of memory");
+
+    cold_mark_escaped_slots(body, g.escaped);
+    for (int32_t s = 0; s < slot_count; s++) {
+        g.writer_op[s] = g.vn_stable[s] = -1;
+        g.local_stamp[s] = -1;
+    }
+    for (int32_t op = 0; op < body->op_count; op++) g.op_block[op] = -1;
+    for (int32_t bi = 0; bi < block_count; bi++) {
+        int32_t bs = body->block_op_start[bi];
+        for (int32_t op = bs; op < bs + body->block_op_count[bi]; op++) g.op_block[op] = bi;
+    }
+    cold_count_slot_writers(body, g.writer_count, g.writer_op);
+    /* a writer outside every block never runs where the walk can see it */
+    for (int32_t s = 0; s < slot_count; s++)
+        if (g.writer_count[s] == 1 && g.op_block[g.writer_op[s]] < 0) g.escaped[s] = true;
+
+    /* blocks reachable from the entry, and the dominator tree over them */
+    int32_t sp = 0;
+    reached[0] = true;
+    stack[sp++] = 0;
+    while (sp > 0) {
+        int32_t n = cold_block_successors(body, stack[--sp], succ, succ_cap);
+        for (int32_t i = 0; i < n; i++) {
+            if (reached[succ[i]]) continue;
+            reached[succ[i]] = true;
+            stack[sp++] = succ[i];
+        }
+    }
+    for (int32_t bi = 0; bi < block_count; bi++) {
+        child_head[bi] = -1;
+        for (int32_t d = 0; d < block_count; d++)
+            if (reached[d] && dom[bi * block_count + d]) depth[bi]++;
+    }
+    for (int32_t bi = block_count - 1; bi > 0; bi--) {
+        idom[bi] = -1;
+        if (!reached[bi]) continue;
+        for (int32_t d = 0; d < block_count; d++) {
+            if (d == bi || !reached[d] || !dom[bi * block_count + d]) continue;
+            if (idom[bi] < 0 || depth[d] > depth[idom[bi]]) idom[bi] = d;
+        }
+        if (idom[bi] < 0) continue;
+        child_next[bi] = child_head[idom[bi]];
+        child_head[idom[bi]] = bi;
+    }
+
+    cold_gvn_table_init(&g.global, body->op_count);
+    cold_gvn_table_init(&g.local, body->op_count);
+    int32_t changed = 0;
+    /* preorder walk; a negative entry leaves the block and drops its entries */
+    sp = 0;
+    stack[sp] = 0;
+    mark[sp++] = 0;
+    while (sp > 0) {
+        int32_t bi = stack[--sp];
+        if (bi < 0) {
+            cold_gvn_table_pop_to(&g.global, mark[sp]);
+            continue;
+        }
+        stack[sp] = -1;
+        mark[sp++] = g.global.count;
+        cold_gvn_block(&g, bi, &changed);
+        cold_gvn_table_pop_to(&g.local, 0);
+        for (int32_t c = child_head[bi]; c >= 0; c = child_next[c]) {
+            stack[sp] = c;
+            mark[sp++] = 0;
+        }
+    }
+
+    free(g.global.head);
+    free(g.global.entry);
+    free(g.local.head);
+    free(g.local.entry);
+    free(g.vn_leader);
+    free(g.vn_global);
+    free(g.vn_const);
+    free(g.escaped);
+    free(g.writer_count);
+    free(g.writer_op);
+    free(g.vn_local);
+    free(g.local_stamp);
+    free(g.vn_stable);
+    free(g.op_block);
+    free(idom);
+    free(depth);
+    free(child_head);
+    free(child_next);
+    free(stack);
+    free(mark);
+    free(reached);
+    free(succ);
+    free(dom);
+    return changed;
+}
+
+/* ---- Induction-variable strength reduction ----
+   In a natural loop whose header has one preheader, an int32 slot i written
+   in the loop only by i = i + step (directly or through a copy of the sum)
+   and a multiply i * k by a loop-invariant k get a new slot j = i * k,
+   set at the end of the preheader and advanced by step * k right after the
+   increment. The multiply becomes a copy of j. int32 arithmetic wraps, so
+   the sum tracks the product exactly.
+   Backends may emit bodies on worker threads that share the body arena, so
+   the pass only uses op and slot capacity the body already has. */
+static void cold_insert_op(BodyIR *body, int32_t block, int32_t pos, int32_t kind,
+                           int32_t dst, int32_t a, int32_t b) {
+    size_t tail = (size_t)(body->op_count - pos) * sizeof(int32_t);
+    memmove(&body->op_kind[pos + 1], &body->op_kind[pos], tail);
+    memmove(&body->op_dst[pos + 1], &body->op_dst[pos], tail);
+    memmove(&body->op_a[pos + 1], &body->op_a[pos], tail);
+    memmove(&body->op_b[pos + 1], &body->op_b[pos], tail);
+    memmove(&body->op_c[pos + 1], &body->op_c[pos], tail);
+    body->op_kind[pos] = kind;
+    body->op_dst[pos] = dst;
+    body->op_a[pos] = a;
+    body->op_b[pos] = b;
+    body->op_c[pos] = 0;
+    body->op_count++;
+    for (int32_t bi = 0; bi < body->block_count; bi++)
+        if (bi != block && body->block_op_start[bi] >= pos) body->block_op_start[bi]++;
+    body->block_op_count[block]++;
+}
+
+/* Value of the int32 constant slot holds everywhere, if it has one. */
+static bool cold_iv_const(BodyIR *body, const bool *escaped, const int32_t *writer_count,
+                          const int32_t *writer_op, int32_t slot, int32_t *value) {
+    if (slot < 0 || slot >= body->slot_count || escaped[slot] || writer_count[slot] != 1) return false;
+    int32_t op = writer_op[slot];
+    if (body->op_kind[op] != BODY_OP_I32_CONST) return false;
+    *value = body->op_a[op];
+    return true;
+}
+
+/* Reduces the multiplies of one (i, k) pair; false when none is left. */
+static bool cold_reduce_iv_multiply(BodyIR *body) {
+    if (!body || body->op_count <= 0 || body->block_count <= 1 || body->slot_count <= 0) return false;
+    /* a rewrite adds up to 5 ops and 4 slots; without room candidates are only counted */
+    bool room = body->op_count + 5 <= body->op_cap && body->slot_count + 4 <= body->slot_cap;
+    int32_t slot_count = body->slot_count;
+    int32_t block_count = body->block_count;
+    bool *dom = cold_build_block_dominators(body);
+    if (!dom) return false;
+    bool *escaped = calloc((size_t)slot_count, sizeof(bool));
+    int32_t *writer_count = calloc((size_t)slot_count, sizeof(int32_t));
+    int32_t *writer_op = malloc((size_t)slot_count * sizeof(int32_t));
+    int32_t *loop_writers = malloc((size_t)slot_count * sizeof(int32_t));
+    int32_t *loop_writer = malloc((size_t)slot_count * sizeof(int32_t));
+    bool *in_loop = malloc((size_t)block_count * sizeof(bool));
+    int32_t *pred_count = calloc((size_t)block_count, sizeof(int32_t));
+    int32_t *pred_start = malloc((size_t)(block_count + 1) * sizeof(int32_t));
+    int32_t *succ_count = calloc((size_t)block_count, sizeof(int32_t));
+    int32_t *stack = malloc((size_t)block_count * sizeof(int32_t));
+    int32_t succ_cap = body->switch_count + 3;
+    int32_t *succ = malloc((size_t)succ_cap * sizeof(int32_t));
+    if (!escaped || !writer_count || !writer_op || !loop_writers || !loop_writer || !in_loop ||
+        !pred_count || !pred_start || !succ_count || !stack || !succ) die("out of memory");
+    cold_mark_escaped_slots(body, escaped);
+    cold_count_slot_writers(body, writer_count, writer_op);
+    int32_t edge_count = 0;
+    for (int32_t bi = 0; bi < block_count; bi++) {
+        succ_count[bi] = cold_block_successors(body, bi, succ, succ_cap);
+        for (int32_t i = 0; i < succ_count[bi]; i++) pred_count[succ[i]]++;
+        edge_count += succ_count[bi];
+    }
+    int32_t *preds = malloc((size_t)(edge_count > 0 ? edge_count : 1) * sizeof(int32_t));
+    if (!preds) die("out of memory");
+    pred_start[0] = 0;
+    for (int32_t bi = 0; bi < block_count; bi++) pred_start[bi + 1] = pred_start[bi] + pred_count[bi];
+    for (int32_t bi = 0; bi < block_count; bi++) pred_count[bi] = 0;
+    for (int32_t bi = 0; bi < block_count; bi++) {
+        int32_t n = cold_block_successors(body, bi, succ, succ_cap);
+        for (int32_t i = 0; i < n; i++) preds[pred_start[succ[i]] + pred_count[succ[i]]++] = bi;
+    }
+
+    bool reduced = false;
+    for (int32_t header = 0; header < block_count && !reduced; header++) {
+        /* the natural loop: blocks reaching a latch without passing the header */
+        for (int32_t bi = 0; bi < block_count; bi++) in_loop[bi] = false;
+        int32_t sp = 0;
+        for (int32_t p = pred_start[header]; p < pred_start[header + 1]; p++) {
+            int32_t latch = preds[p];
+            if (!dom[latch * block_count + header] || in_loop[latch]) continue;
+            in_loop[latch] = true;
+            stack[sp++] = latch;
+        }
+        if (sp == 0) continue;
+        in_loop[header] = true;
+        while (sp > 0) {
+            int32_t bi = stack[--sp];
+            if (bi == header) continue;
+            for (int32_t p = pred_start[bi]; p < pred_start[bi + 1]; p++) {
+                if (in_loop[preds[p]]) continue;
+                in_loop[preds[p]] = true;
+                stack[sp++] = preds[p];
+            }
+        }
+        int32_t pre = -1, outside = 0;
+        for (int32_t p = pred_start[header]; p < pred_start[header + 1]; p++) {
+            if (in_loop[preds[p]]) continue;
+            pre = preds[p];
+            outside++;
+        }
+        if (outside != 1 || succ_count[pre] != 1) continue;
+
+        for (int32_t s = 0; s < slot_count; s++) loop_writers[s] = 0;
+        for (int32_t bi = 0; bi < block_count; bi++) {
+            if (!in_loop[bi]) continue;
+            int32_t bs = body->block_op_start[bi];
+            for (int32_t op = bs; op < bs + body->block_op_count[bi]; op++) {
+                int32_t slots[4] = {body->op_dst[op], body->op_a[op], body->op_b[op], body->op_c[op]};
+                for (int32_t i = 0; i < 4; i++) {
+                    int32_t slot = slots[i];
+                    if (slot < 0 || slot >= slot_count || !cold_gvn_op_writes(body, op, slot)) continue;
+                    if (i == 3 && !cold_op_reads_c_slot(body->op_kind[op])) continue;
+                    bool seen = false;
+                    for (int32_t j = 0; j < i; j++) seen = seen || slots[j] == slot;
+                    if (seen) continue;
+                    loop_writers[slot]++;
+                    loop_writer[slot] = op;
+                }
+            }
+        }
+
+        for (int32_t bi = 0; bi < block_count && !reduced; bi++) {
+            if (!in_loop[bi]) continue;
+            int32_t bs = body->block_op_start[bi];
+            for (int32_t op = bs; op < bs + body->block_op_count[bi] && !reduced; op++) {
+                if (body->op_kind[op] != BODY_OP_I32_MUL) continue;
+                int32_t dst = body->op_dst[op];
+                for (int32_t side = 0; side < 2 && !reduced; side++) {
+                    int32_t iv = side ? body->op_b[op] : body->op_a[op];
+                    int32_t k = side ? body->op_a[op] : body->op_b[op];
+                    if (iv < 0 || iv >= slot_count || k < 0 || k >= slot_count) continue;
+                    if (iv == k || dst == iv || dst == k || escaped[iv] || escaped[k]) continue;
+                    if (body->slot_kind[iv] != SLOT_I32 || body->slot_kind[k] != SLOT_I32) continue;
+                    /* i's one write in the loop: i = i + step, or i = t with t = i + step */
+                    if (loop_writers[iv] != 1) continue;
+                    int32_t inc = loop_writer[iv], add = inc;
+                    if (body->op_kind[inc] == BODY_OP_COPY_I32) {
+                        int32_t t = body->op_a[inc];
+                        if (t < 0 || t >= slot_count || writer_count[t] != 1) continue;
+                        add = writer_op[t];
+                        int32_t ib = cold_block_index_for_op(body, inc);
+                        if (ib < 0 || add < body->block_op_start[ib] || add >= inc) continue;
+                    }
+                    if (body->op_kind[add] != BODY_OP_I32_ADD) continue;
+                    int32_t step_slot = body->op_a[add] == iv ? body->op_b[add] :
+                                        body->op_b[add] == iv ? body->op_a[add] : -1;
+                    int32_t step = 0, k_value = 0;
+                    if (step_slot == iv || !cold_iv_const(body, escaped, writer_count, writer_op, step_slot, &step)) continue;
+                    bool k_const = cold_iv_const(body, escaped, writer_count, writer_op, k, &k_value);
+                    if (!k_const && loop_writers[k] != 0) continue;
+                    if (!room) {
+                        __atomic_add_fetch(&cold_iv_muls_skipped_capacity, 1, __ATOMIC_RELAXED);
+                        break;
+                    }
+
+                    /* preheader: [kc = K]; j = i * k; [the per-step delta] */
+                    int32_t j = body_slot(body, SLOT_I32, 4);
+                    int32_t pos = body->block_op_start[pre] + body->block_op_count[pre];
+                    int32_t inserted = 0;
+                    int32_t k_slot = k;
+                    if (k_const) {
+                        k_slot = body_slot(body, SLOT_I32, 4);
+                        cold_insert_op(body, pre, pos + inserted++, BODY_OP_I32_CONST, k_slot, k_value, 0);
+                    }
+                    cold_insert_op(body, pre, pos + inserted++, BODY_OP_I32_MUL, j, iv, k_slot);
+                    int32_t delta = k_slot;
+                    if (k_const && step != 1) {
+                        delta = body_slot(body, SLOT_I32, 4);
+                        cold_insert_op(body, pre, pos + inserted++, BODY_OP_I32_CONST, delta,
+                                       (int32_t)((uint32_t)step * (uint32_t)k_value), 0);
+                    } else if (step != 1) {
+                        int32_t step_copy = body_slot(body, SLOT_I32, 4);
+                        delta = body_slot(body, SLOT_I32, 4);
+                        cold_insert_op(body, pre, pos + inserted++, BODY_OP_I32_CONST, step_copy, step, 0);
+                        cold_insert_op(body, pre, pos + inserted++, BODY_OP_I32_MUL, delta, step_copy, k_slot);
+                    }
+                    if (inc >= pos) inc += inserted;
+                    cold_insert_op(body, cold_block_index_for_op(body, inc), inc + 1,
+                                   BODY_OP_I32_ADD, j, j, delta);
+                    /* every i * k of the loop reads j */
+                    for (int32_t lb = 0; lb < block_count; lb++) {
+                        if (!in_loop[lb]) continue;
+                        int32_t ls = body->block_op_start[lb];
+                        for (int32_t m = ls; m < ls + body->block_op_count[lb]; m++) {
+                            if (body->op_kind[m] != BODY_OP_I32_MUL || body->op_dst[m] == iv ||
+                                body->op_dst[m] == k || body->op_dst[m] == j) continue;
+                            if (!((body->op_a[m] == iv && body->op_b[m] == k) ||
+                                  (body->op_a[m] == k && body->op_b[m] == iv))) continue;
+                            body->op_kind[m] = BODY_OP_COPY_I32;
+                            body->op_a[m] = j;
+                            body->op_b[m] = 0;
+                            body->op_c[m] = 0;
+                            __atomic_add_fetch(&cold_iv_muls_reduced, 1, __ATOMIC_RELAXED);
+                        }
+                    }
+                    reduced = true;
+                }
+            }
+        }
+    }
+
+    free(preds);
+    free(dom);
+    free(escaped);
+    free(writer_count);
+    free(writer_op);
+    free(loop_writers);
+    free(loop_writer);
+    free(in_loop);
+    free(pred_count);
+    free(pred_start);
+    free(succ_count);
+    free(stack);
+    free(succ);
+    return reduced;
+}
+
+static void codegen_func_emit(Code *code, BodyIR *body, Symbols *symbols,
+                              FunctionPatchList *function_patches);
+
+/* Traced entry point: one "codegen" span per function body. */
 static void codegen_func(Code *code, BodyIR *body, Symbols *symbols,
                          FunctionPatchList *function_patches) {
+    uint64_t trace_start = cold_trace_begin();
+    codegen_func_emit(code, body, symbols, function_patches);
+    cold_trace_end("codegen", body->debug_name, trace_start);
+}
+
+static void codegen_func_emit(Code *code, BodyIR *body, Symbols *symbols,
+                              FunctionPatchList *function_patches) {
     na_reset();
     cold_optimize_body(body, false);
+    cold_profile_layout_blocks(body);
+    cold_eliminate_bounds_checks(body);
     int32_t frame_size = align_i32(body->frame_size, 16);
     code_emit(code, a64_stp_pre(19, 20, SP, -16));
     code_emit(code, a64_stp_pre(FP, LR, SP, -16));
@@ -15410,6 +20136,7 @@ static void codegen_func(Code *code, BodyIR *body, Symbols *symbols,
                 /* Unsupported return kind: return 0 gracefully */
                 code_emit(code, a64_movz(R0, 0, 0));
                 emit_epilogue(code, frame_size);
+                cold_release_bounds_checks(body);
                 return;
             }
             emit_epilogue(code, frame_size);
@@ -15440,6 +20167,7 @@ static void codegen_func(Code *code, BodyIR *body, Symbols *symbols,
         }
     }
 
+    uint64_t patch_start = cold_trace_begin();
     for (int32_t i = 0; i < patches.count; i++) {
         Patch patch = patches.items[i];
         int32_t target = patch.target_block >= 0 && patch.target_block < body->block_count
@@ -15455,6 +20183,8 @@ static void codegen_func(Code *code, BodyIR *body, Symbols *symbols,
             code->words[patch.pos] = (ins & 0xFC000000u) | ((uint32_t)delta & 0x03FFFFFFu);
         }
     }
+    cold_trace_end_items("patch", body->debug_name, patch_start, patches.count);
+    cold_release_bounds_checks(body);
 }
 
 static void cold_diag_fn_name(Span name) {
@@ -15711,9 +20441,14 @@ static void codegen_program(Code *code, BodyIR **function_bodies,
     for (int32_t i = 0; i < function_count; i++) reachable_functions[i] = false;
     cold_mark_reachable_functions(symbols, function_bodies, function_count,
                                   entry_function, reachable_functions);
+    cold_profile_prepare(function_bodies, function_count, entry_function, reachable_functions);
 
     cold_egraph_rewrite_count = 0;
     cold_egraph_licm_hoisted = 0;
+    cold_bce_checks_removed = 0;
+    cold_gvn_values_reused = 0;
+    cold_iv_muls_reduced = 0;
+    cold_iv_muls_skipped_capacity = 0;
     cold_egraph_fixed_point_iterations = 0;
     FunctionPatchList function_patches = {0};
     function_patches.arena = code->arena;
@@ -15728,11 +20463,25 @@ static void codegen_program(Code *code, BodyIR **function_bodies,
     /* Entry trampoline: architecture-specific */
     int32_t entry_call_pos = 0;
     if (use_rv64) {
-        code_emit(code, rv_addi(RV_S0, RV_A0, 0));
-        code_emit(code, rv_addi(RV_S1, RV_A1, 0));
+        /* s0 = argc, s1 = argv for the whole run: from the initial stack
+           when this is the ELF entry point, from a0/a1 otherwise. */
+        if (use_linux) {
+            code_emit(code, rv_ld(RV_S0, RV_SP, 0));
+            code_emit(code, rv_addi(RV_S1, RV_SP, 8));
+        } else {
+            code_emit(code, rv_addi(RV_S0, RV_A0, 0));
+            code_emit(code, rv_addi(RV_S1, RV_A1, 0));
+        }
         entry_call_pos = code->count;
         code_emit(code, rv_jal(RV_RA, 0));
-        if (use_linux) {
+        if (use_linux && cold_profile.instrument) {
+            int32_t flush_call = code->count;
+            code_emit(code, rv_jal(RV_RA, 0));
+            rv_li(code->words, &code->count, RV_A7, 93); /* sys_exit */
+            code_emit(code, rv_ecall());
+            cold_profile_emit_flush_rv64(code);
+            code->words[flush_call] = rv_jal(RV_RA, (cold_profile.flush_pos - flush_call) * 4);
+        } else if (use_linux) {
             rv_li(code->words, &code->count, RV_A7, 93); /* sys_exit */
             code_emit(code, rv_ecall());
         } else {
@@ -15773,7 +20522,7 @@ static void codegen_program(Code *code, BodyIR **function_bodies,
     }
     /* Patch trampoline to jump to real entry body */
     if (use_rv64)
-        code->words[entry_call_pos] = rv_jal(RV_RA, entry_body_pos - entry_call_pos);
+        code->words[entry_call_pos] = rv_jal(RV_RA, (entry_body_pos - entry_call_pos) * 4);
     else
         code->words[entry_call_pos] = a64_bl(entry_body_pos - entry_call_pos);
     if (cold_diag_dump_per_fn || cold_diag_dump_slots) {
@@ -15818,32 +20567,11 @@ static void codegen_program(Code *code, BodyIR **function_bodies,
             dist_idx++;
         }
 
-        /* Per-worker arena cache: reuse mmap'd arenas across compilations.
-           Reset used=0 and keep pages; significantly reduces mmap/munmap churn. */
-        static Arena *worker_arena_cache[16] = {0};
-        static int32_t worker_arena_cache_count = 0;
-
+        /* Per-worker arenas are cached; the merge below copies everything
+           out of them, so each codegen run starts from a rewound arena. */
         for (int32_t w = 0; w < active_jobs; w++) {
-            Arena *w_arena = NULL;
-            /* Try to reuse a cached arena */
-            if (w < worker_arena_cache_count && worker_arena_cache[w]) {
-                w_arena = worker_arena_cache[w];
-                /* Reset arena state: keep pages, just rewind allocation cursor.
-                   Page list stays intact; next alloc will reuse existing pages. */
-                w_arena->used = 0;
-                w_arena->phase_count = 0;
-            }
-            if (!w_arena) {
-                w_arena = mmap(0, sizeof(Arena), PROT_READ | PROT_WRITE,
-                               MAP_PRIVATE | MAP_ANON, -1, 0);
-                if (w_arena == MAP_FAILED) die("worker arena mmap failed");
-                /* Cache this arena for future compilations */
-                if (w < 16) {
-                    worker_arena_cache[w] = w_arena;
-                    if (w >= worker_arena_cache_count)
-                        worker_arena_cache_count = w + 1;
-                }
-            }
+            Arena *w_arena = cold_worker_arena(cold_codegen_arena_cache, w);
+            arena_rewind(w_arena);
             Code *w_code = code_new(w_arena, 256);
             workers[w] = (CodegenWorker){
                 .deque = &deques[w],
@@ -15861,6 +20589,7 @@ static void codegen_program(Code *code, BodyIR **function_bodies,
                     (size_t)function_count * sizeof(int32_t)),
                 .local_function_end = arena_alloc(w_arena,
                     (size_t)function_count * sizeof(int32_t)),
+                .use_rv64 = use_rv64,
             };
             for (int32_t i = 0; i < function_count; i++) {
                 workers[w].local_function_pos[i] = -1;
@@ -15955,8 +20684,21 @@ static void codegen_program(Code *code, BodyIR **function_bodies,
         }
     }
 
+    uint64_t patch_start = cold_trace_begin();
     for (int32_t i = 0; i < function_patches.count; i++) {
         FunctionPatch patch = function_patches.items[i];
+        if (patch.kind == FUNCTION_PATCH_RODATA) {
+            cold_rodata_place(patch.pos, patch.target_function);
+            continue;
+        }
+        if (patch.kind == FUNCTION_PATCH_PROFILE) {
+            cold_profile_place(patch.pos, patch.target_function);
+            continue;
+        }
+        if (patch.kind == FUNCTION_PATCH_PROFILE_FLUSH) {
+            code->words[patch.pos] = rv_jal(RV_RA, (cold_profile.flush_pos - patch.pos) * 4);
+            continue;
+        }
         if (patch.target_function < 0 || patch.target_function >= function_count ||
             function_pos[patch.target_function] < 0) {
             if (patch.kind == FUNCTION_PATCH_ADDR) {
@@ -15985,15 +20727,21 @@ static void codegen_program(Code *code, BodyIR **function_bodies,
         }
         int32_t delta = function_pos[patch.target_function] - patch.pos;
         uint32_t ins = code->words[patch.pos];
-        if (patch.kind == FUNCTION_PATCH_ADDR) {
-            if (use_rv64) die("cold RISC-V function address patch unsupported");
+        if (patch.kind == FUNCTION_PATCH_ADDR && use_rv64) {
+            /* auipc rd, hi; addi rd, rd, lo */
+            int32_t delta_bytes = delta * 4;
+            int32_t upper = (delta_bytes + 0x800) & (int32_t)0xFFFFF000;
+            int32_t rd = (int32_t)((ins >> 7) & 0x1Fu);
+            code->words[patch.pos] = rv_auipc(rd, upper);
+            code->words[patch.pos + 1] = rv_addi(rd, rd, (int16_t)(delta_bytes - upper));
+        } else if (patch.kind == FUNCTION_PATCH_ADDR) {
             int64_t delta_bytes = (int64_t)delta * 4;
             if (delta_bytes < -(1 << 20) || delta_bytes >= (1 << 20))
                 die("cold function address ADR out of range");
             code->words[patch.pos] = a64_adr(ins & 0x1Fu, (int32_t)delta_bytes);
         } else if (patch.kind == FUNCTION_PATCH_CALL) {
             if (use_rv64) {
-                code->words[patch.pos] = rv_jal(RV_RA, delta);
+                code->words[patch.pos] = rv_jal(RV_RA, delta * 4);
             } else {
                 code->words[patch.pos] = (ins & 0xFC000000u) | ((uint32_t)delta & 0x03FFFFFFu);
             }
@@ -16007,11 +20755,104 @@ static void codegen_program(Code *code, BodyIR **function_bodies,
                     function_pos[patch.target_function], delta, code->words[patch.pos]);
         }
     }
+    cold_trace_end_items("patch", cold_cstr_span("function_patches"),
+                         patch_start, function_patches.count);
     if (!use_rv64)
         code->words[entry_call_pos] = (code->words[entry_call_pos] & 0xFC000000u) |
                                       ((uint32_t)(function_pos[entry_function] - entry_call_pos) & 0x03FFFFFFu);
 }
 
+/* x86_64 executable codegen: same reachability pruning as codegen_program,
+   a Linux _start stub (argc/argv from the initial stack into r12/r13, exit
+   with main's result), then one linear pass over the collected patches.
+   Returns the number of patches whose target has no body; the first such
+   function index is stored in *out_first_unresolved. */
+static __attribute__((noinline)) int32_t x64_codegen_program(X64Code *x, BodyIR **function_bodies,
+                                                             int32_t function_count, int32_t entry_function,
+                                                             Symbols *symbols, uint64_t code_vaddr,
+                                                             int32_t *out_first_unresolved) {
+    if (entry_function < 0 || entry_function >= function_count ||
+        !function_bodies[entry_function]) die("missing entry function body");
+
+    int32_t *function_pos = arena_alloc(symbols->arena, (size_t)function_count * sizeof(int32_t));
+    for (int32_t i = 0; i < function_count; i++) function_pos[i] = -1;
+    bool *reachable_functions = arena_alloc(symbols->arena, (size_t)function_count * sizeof(bool));
+    for (int32_t i = 0; i < function_count; i++) reachable_functions[i] = false;
+    cold_mark_reachable_functions(symbols, function_bodies, function_count,
+                                  entry_function, reachable_functions);
+    cold_profile_prepare(function_bodies, function_count, entry_function, reachable_functions);
+
+    FunctionPatchList function_patches = {0};
+    function_patches.arena = symbols->arena;
+
+    x64_mov_r64_mr64(x, 12, 4, 0);          /* r12 = argc = [rsp] */
+    x64_lea_r64_mr(x, 13, 4, 8);            /* r13 = argv = rsp + 8 */
+    int32_t entry_call_pos = x->len + 1;    /* after E8 opcode */
+    x64_call_rel32(x, 0);
+    x64_mov_r32_r32(x, 7, 0);               /* edi = main result */
+    int32_t flush_call_pos = -1;
+    if (cold_profile.instrument) {
+        flush_call_pos = x->len + 1;
+        x64_call_rel32(x, 0);
+    }
+    x64_mov_r32_imm32(x, 0, 60);            /* sys_exit */
+    x64_syscall(x);
+    x64_int3(x);
+    if (flush_call_pos >= 0) {
+        cold_profile_emit_flush_x64(x);
+        x64_patch_call_rel32(x, flush_call_pos, cold_profile.flush_pos);
+    }
+
+    function_pos[entry_function] = x->len;
+    cold_diag_dump_target_body(symbols, entry_function, function_bodies[entry_function]);
+    x64_codegen_func(x, function_bodies[entry_function], symbols, &function_patches);
+    x64_patch_call_rel32(x, entry_call_pos, function_pos[entry_function]);
+    for (int32_t i = 0; i < function_count; i++) {
+        if (i == entry_function || !reachable_functions[i]) continue;
+        BodyIR *body = function_bodies[i];
+        if (!cold_body_codegen_ready(body)) continue; /* external */
+        function_pos[i] = x->len;
+        x64_codegen_func(x, body, symbols, &function_patches);
+    }
+
+    int32_t unresolved = 0;
+    uint64_t patch_start = cold_trace_begin();
+    for (int32_t pi = 0; pi < function_patches.count; pi++) {
+        FunctionPatch patch = function_patches.items[pi];
+        if (patch.kind == FUNCTION_PATCH_RODATA) {
+            cold_rodata_place(patch.pos, patch.target_function);
+            continue;
+        }
+        if (patch.kind == FUNCTION_PATCH_PROFILE) {
+            cold_profile_place(patch.pos, patch.target_function);
+            continue;
+        }
+        if (patch.kind == FUNCTION_PATCH_PROFILE_FLUSH) {
+            x64_patch_call_rel32(x, patch.pos, cold_profile.flush_pos);
+            continue;
+        }
+        if (patch.target_function < 0 || patch.target_function >= function_count)
+            die("cold x86_64 function patch target out of range");
+        int32_t target_off = function_pos[patch.target_function];
+        if (target_off < 0) {
+            if (unresolved == 0 && out_first_unresolved)
+                *out_first_unresolved = patch.target_function;
+            unresolved++;
+        } else if (patch.kind == FUNCTION_PATCH_CALL) {
+            x64_patch_call_rel32(x, patch.pos, target_off);
+        } else if (patch.kind == FUNCTION_PATCH_ADDR) {
+            uint64_t addr = code_vaddr + (uint64_t)target_off;
+            for (int32_t b = 0; b < 8; b++)
+                x->buf[patch.pos + b] = (uint8_t)(addr >> (b * 8));
+        } else {
+            die("cold unknown function patch kind");
+        }
+    }
+    cold_trace_end_items("patch", cold_cstr_span("function_patches"),
+                         patch_start, function_patches.count);
+    return unresolved;
+}
+
 static void code_patch_bcond(Code *code, int32_t pos, int32_t target) {
     int32_t delta = target - pos;
     uint32_t ins = code->words[pos];
@@ -16361,6 +21202,8 @@ typedef struct ColdCompileStats {
     int32_t csg_lowering;
     int32_t csg_statement_count;
     int32_t code_words;
+    int32_t rodata_bytes;
+    int32_t rvc_saved_bytes;
     int32_t param_count;
     int32_t abi_register_params;
     int32_t abi_stack_params;
@@ -16390,6 +21233,13 @@ typedef struct ColdCompileStats {
     int32_t canonical_normalized_count;
     int32_t egraph_rewrite_count;
     int32_t egraph_licm_hoisted;
+    int32_t bce_checks_removed;
+    int32_t gvn_values_reused;
+    int32_t iv_muls_reduced;
+    int32_t iv_muls_skipped_capacity;
+    int32_t profile_instrumented_blocks;
+    int32_t profile_functions_matched;
+    int32_t profile_blocks_moved;
     int32_t egraph_dedup_count;
     int32_t egraph_fixed_point_iterations;
     int32_t total_function_count;
@@ -16407,6 +21257,8 @@ typedef struct ColdCompileStats {
     int32_t lowering_parallel_job_count;
     int32_t lowering_parallel_active_workers;
     int32_t lowering_parallel_schedule;
+    int32_t lowering_parallel_functions;
+    int32_t lowering_serial_fallbacks;
     int32_t ownership_compile_entry;
     int32_t ownership_runtime_witness;
     int32_t cross_block_analysis_ran;
@@ -16416,6 +21268,14 @@ typedef struct ColdCompileStats {
     char system_link_exec_scope[COLD_NAME_CAP];
 } ColdCompileStats;
 
+static void cold_copy_lowering_stats(ColdCompileStats *stats) {
+    stats->lowering_parallel_job_count = cold_jobs_from_env();
+    stats->lowering_parallel_active_workers = cold_lowering_active_workers;
+    stats->lowering_parallel_schedule = cold_lowering_active_workers > 1 ? 1 : 0;
+    stats->lowering_parallel_functions = cold_lowering_parallel_functions;
+    stats->lowering_serial_fallbacks = cold_lowering_serial_fallbacks;
+}
+
 static void cold_print_exec_phase_report(FILE *file, ColdCompileStats *stats) {
     unsigned long long parse_us = stats ? (unsigned long long)stats->parse_us : 0ULL;
     unsigned long long codegen_us = stats ? (unsigned long long)stats->codegen_us : 0ULL;
@@ -16446,6 +21306,19 @@ static void cold_print_resource_report(FILE *file) {
 #endif
     fprintf(file, "report_cpu_ms=%lld\n", cpu_ms);
     fprintf(file, "report_rss_bytes=%lld\n", rss_bytes);
+    cold_arena_stats_fold();
+    ColdArenaStats *arena_stats = &cold_arena_folded_stats;
+    fprintf(file, "arena_zero_fill_skipped_bytes=%llu\n",
+            (unsigned long long)arena_stats->zero_fill_skipped_bytes);
+    fprintf(file, "arena_grow_in_place_bytes=%llu\n",
+            (unsigned long long)arena_stats->grow_in_place_bytes);
+    fprintf(file, "arena_free_list_parked_bytes=%llu\n",
+            (unsigned long long)arena_stats->free_list_parked_bytes);
+    fprintf(file, "arena_free_list_reused_bytes=%llu\n",
+            (unsigned long long)arena_stats->free_list_reused_bytes);
+    fprintf(file, "arena_reuse_saved_bytes=%llu\n",
+            (unsigned long long)(arena_stats->grow_in_place_bytes +
+                                 arena_stats->free_list_reused_bytes));
 }
 
 static void cold_collect_body_stats(Symbols *symbols, BodyIR **function_bodies, int32_t function_count,
@@ -17061,7 +21934,7 @@ static bool cold_csg_v2_decode_primary_object(Span text,
 }
 
 static char *cold_span_to_cstr(Arena *arena, Span span) {
-    char *buf = arena_alloc(arena, (size_t)span.len + 1);
+    char *buf = arena_alloc_uninit(arena, (size_t)span.len + 1);
     if (span.len > 0) memcpy(buf, span.ptr, (size_t)span.len);
     buf[span.len] = '\0';
     return buf;
@@ -17268,13 +22141,13 @@ static bool cold_csg_v2_emit_primary_object(const char *out_path,
                               reloc_offsets, reloc_symbols, facts->reloc_count);
 }
 
-static bool cold_compile_canonical_csg_v2_primary_object(const char *out_path,
-                                                         const char *target,
-                                                         Span csg_text,
-                                                         Arena *arena,
-                                                         ColdCompileStats *stats,
-                                                         uint64_t start_us,
-                                                         uint64_t mmap_done_us) {
+static __attribute__((noinline)) bool cold_compile_canonical_csg_v2_primary_object(const char *out_path,
+                                                                                   const char *target,
+                                                                                   Span csg_text,
+                                                                                   Arena *arena,
+                                                                                   ColdCompileStats *stats,
+                                                                                   uint64_t start_us,
+                                                                                   uint64_t mmap_done_us) {
     if (csg_text.len <= 0 ||
         csg_text.len > (int32_t)CSG_V2_BUDGET_MAX_FACTS_BYTES) {
         return false;
@@ -17848,7 +22721,7 @@ typedef struct CsgV2ObjFacts {
     Arena *arena;
 } CsgV2ObjFacts;
 
-static bool cold_load_csg_v2_obj_facts(
+static __attribute__((noinline)) bool cold_load_csg_v2_obj_facts(
     const uint8_t *data, int32_t data_len,
     CsgV2ObjFacts *facts, Arena *arena)
 {
@@ -18033,7 +22906,7 @@ static bool cold_compile_csg_path_to_macho(const char *out_path,
                                            ColdCompileStats *stats,
                                            bool obj_mode,
                                            const char *provider_objects) {
-    uint64_t start_us = cold_now_us();
+    volatile uint64_t start_us = cold_now_us();
     if (stats) memset(stats, 0, sizeof(*stats));
     Arena *arena = mmap(0, sizeof(Arena), PROT_READ | PROT_WRITE,
                         MAP_PRIVATE | MAP_ANON, -1, 0);
@@ -18043,7 +22916,7 @@ static bool cold_compile_csg_path_to_macho(const char *out_path,
     if (csg_text.len <= 0) return false;
 
     if (cold_span_starts_with(csg_text, "CHENG_CSG_V2\n")) {
-        bool ok = false;
+        volatile bool ok = false;
         if (obj_mode) {
             ok = cold_compile_canonical_csg_v2_primary_object(out_path, target, csg_text,
                                                               arena, stats,
@@ -18199,7 +23072,7 @@ static bool cold_compile_csg_path_to_macho(const char *out_path,
                     local_count++;
             }
 
-            bool ok;
+            volatile bool ok;
             uint64_t obj_emit_start_us = cold_now_us();
             if (is_elf) {
                 ok = elf64_write_object(out_path, obj_facts.words, obj_facts.word_count,
@@ -18344,6 +23217,7 @@ static bool cold_compile_csg_path_to_macho(const char *out_path,
             int32_t *reloc_offsets = arena_alloc(arena, (size_t)reloc_cap * sizeof(int32_t));
             int32_t *reloc_symbols = arena_alloc(arena, (size_t)reloc_cap * sizeof(int32_t));
             int32_t reloc_count = 0;
+            uint64_t patch_start = cold_trace_begin();
             for (int32_t pi = 0; pi < function_patches.count; pi++) {
                 FunctionPatch patch = function_patches.items[pi];
                 if (patch.target_function < 0 || patch.target_function >= func_count)
@@ -18371,6 +23245,8 @@ static bool cold_compile_csg_path_to_macho(const char *out_path,
                     die("cold object unknown function patch kind");
                 }
             }
+            cold_trace_end_items("patch", cold_cstr_span("function_patches"),
+                                 patch_start, function_patches.count);
 
             /* Build symbol name/offset arrays */
             int32_t max_names = func_count + reloc_count + 1;
@@ -18561,7 +23437,7 @@ static bool cold_compile_csg_path_to_macho(const char *out_path,
                                 if (target_word >= 0) {
                                     int32_t delta = target_word - call_word;
                                     if (is_rv)
-                                        linked->words[call_word] = rv_jal(RV_RA, delta);
+                                        linked->words[call_word] = rv_jal(RV_RA, delta * 4);
                                     else
                                         linked->words[call_word] = (linked->words[call_word] & 0xFC000000u) |
                                                                    ((uint32_t)delta & 0x03FFFFFFu);
@@ -18599,7 +23475,7 @@ static bool cold_compile_csg_path_to_macho(const char *out_path,
                         if (word_pos < 0 || word_pos >= linked->count) continue;
                         int32_t delta = target_pos[ri] - word_pos;
                         if (is_rv)
-                            linked->words[word_pos] = rv_jal(RV_RA, delta);
+                            linked->words[word_pos] = rv_jal(RV_RA, delta * 4);
                         else
                             linked->words[word_pos] = (linked->words[word_pos] & 0xFC000000u) |
                                                       ((uint32_t)delta & 0x03FFFFFFu);
@@ -18671,18 +23547,37 @@ static bool cold_compile_csg_path_to_macho(const char *out_path,
             /* x86_64 uses byte-level codegen (X64Code) → pack to 32-bit words */
             X64Code x64;
             x64_init(&x64, 65536);
-            FunctionPatchList x64_patches = {0};
-            x64_patches.arena = arena;
-            for (int32_t i = 0; i < symbols->function_count; i++) {
-                if (!function_bodies[i]) continue;
-                BodyIR *body = function_bodies[i];
-                if ((uintptr_t)body < 4096 || body->has_fallback) continue;
-                x64_codegen_func(&x64, body, symbols, &x64_patches);
+            int32_t first_unresolved = -1;
+            cold_rodata_begin();
+            int32_t unresolved = x64_codegen_program(&x64, function_bodies, symbols->function_count,
+                                                     entry_function, symbols, ELF_EXEC_CODE_VADDR,
+                                                     &first_unresolved);
+            if (unresolved > 0) {
+                cold_rodata_end();
+                if (stats) {
+                    stats->unresolved_symbol_count = unresolved;
+                    Span nm = cold_fn_object_symbol_span(&symbols->functions[first_unresolved], false);
+                    int32_t n = nm.len < (int32_t)sizeof(stats->first_unresolved_symbol) - 1
+                        ? nm.len
+                        : (int32_t)sizeof(stats->first_unresolved_symbol) - 1;
+                    if (n > 0) memcpy(stats->first_unresolved_symbol, nm.ptr, (size_t)n);
+                    stats->first_unresolved_symbol[n] = '\0';
+                }
+                return false;
             }
+            int32_t text_bytes = (x64.len + 3) & ~3;
+            cold_rodata_apply_x64(x64.buf, ELF_EXEC_CODE_VADDR, elf_exec_rodata_vaddr(text_bytes));
+            cold_fixups_apply_x64(cold_profile.fixups, cold_profile.fixup_count, x64.buf, ELF_EXEC_CODE_VADDR,
+                                  elf_exec_data_vaddr(text_bytes, cold_rodata.len));
             Code *code = code_new(arena, (x64.len / 4) + 256);
             code->count = x64_pack_words(&x64, code->words, code->cap);
             uint16_t em = EM_X86_64;
-            if (!elf_write_exec(out_path, code->words, code->count, em)) return false;
+            bool written = elf_write_exec_segments(out_path, code->words, code->count,
+                                                   cold_rodata.bytes, cold_rodata.len,
+                                                   cold_profile.data, cold_profile.data_len, em);
+            if (stats) stats->rodata_bytes = cold_rodata.len;
+            cold_rodata_end();
+            if (!written) return false;
             if (stats) { stats->code_words = code->count; stats->csg_lowering = 1;
                 cold_collect_body_stats(symbols, function_bodies, symbols->function_count, stats); }
         } else {
@@ -18696,6 +23591,8 @@ static bool cold_compile_csg_path_to_macho(const char *out_path,
                 unresolved_pos = arena_alloc(arena, (size_t)cap * sizeof(int32_t));
                 unresolved_fn = arena_alloc(arena, (size_t)cap * sizeof(int32_t));
             }
+            /* ELF executables keep string literals out of the text pages */
+            if (target && strstr(target, "linux") != 0) cold_rodata_begin();
             codegen_program(code, function_bodies, symbols->function_count, entry_function, symbols, target,
                             unresolved_pos, unresolved_fn, &unresolved_count);
             {
@@ -18803,7 +23700,7 @@ static bool cold_compile_csg_path_to_macho(const char *out_path,
 	                                if (target_word >= 0) {
 	                                    int32_t delta = target_word - call_word;
 	                                    if (provider_is_rv)
-	                                        code->words[call_word] = rv_jal(RV_RA, delta);
+	                                        code->words[call_word] = rv_jal(RV_RA, delta * 4);
 	                                    else
 	                                        code->words[call_word] = (code->words[call_word] & 0xFC000000u) |
 	                                                                 ((uint32_t)delta & 0x03FFFFFFu);
@@ -18838,7 +23735,7 @@ static bool cold_compile_csg_path_to_macho(const char *out_path,
 	                        if (target_word >= 0) {
 	                            int32_t delta = target_word - patch_pos;
 	                            if (provider_is_rv)
-	                                code->words[patch_pos] = rv_jal(RV_RA, delta);
+	                                code->words[patch_pos] = rv_jal(RV_RA, delta * 4);
 	                            else
 	                                code->words[patch_pos] = (code->words[patch_pos] & 0xFC000000u) |
 	                                                         ((uint32_t)delta & 0x03FFFFFFu);
@@ -18874,7 +23771,29 @@ static bool cold_compile_csg_path_to_macho(const char *out_path,
                     if (strstr(target, "aarch64")) em = EM_AARCH64;
                     else if (strstr(target, "riscv64")) em = EM_RISCV;
                     else em = EM_X86_64;
-                    if (!elf_write_exec(out_path, code->words, code->count, em)) return false;
+                    uint64_t rodata_vaddr = elf_exec_rodata_vaddr(code->count * 4);
+                    if (is_rv) {
+                        cold_rodata_apply_rv64(code->words, ELF_EXEC_CODE_VADDR, rodata_vaddr);
+                        cold_fixups_apply_rv64(cold_profile.fixups, cold_profile.fixup_count, code->words,
+                                               ELF_EXEC_CODE_VADDR,
+                                               elf_exec_data_vaddr(code->count * 4, cold_rodata.len));
+                        /* inline literals (rodata off) and provider code are not
+                           decodable as one instruction stream; counters keep
+                           their data references unrelaxed */
+                        if (rv64_use_rvc && cold_rodata.enabled && exe_provider_count == 0 &&
+                            cold_profile.data_len == 0) {
+                            int32_t rvc_saved = rv64_compress_text(code, ELF_EXEC_CODE_VADDR, rodata_vaddr);
+                            if (stats) stats->rvc_saved_bytes = rvc_saved;
+                        }
+                    } else {
+                        cold_rodata_apply_a64(code->words, ELF_EXEC_CODE_VADDR, rodata_vaddr);
+                    }
+                    bool written = elf_write_exec_segments(out_path, code->words, code->count,
+                                                           cold_rodata.bytes, cold_rodata.len,
+                                                           cold_profile.data, cold_profile.data_len, em);
+                    if (stats) stats->rodata_bytes = cold_rodata.len;
+                    cold_rodata_end();
+                    if (!written) return false;
                 } else if (is_coff) {
                     uint16_t cm = 0;
                     if (strstr(target, "aarch64")) cm = IMAGE_FILE_MACHINE_ARM64;
@@ -18899,6 +23818,13 @@ static bool cold_compile_csg_path_to_macho(const char *out_path,
             stats->function_count = symbols->function_count;
             stats->egraph_rewrite_count = cold_egraph_rewrite_count;
             stats->egraph_licm_hoisted = cold_egraph_licm_hoisted;
+            stats->bce_checks_removed = cold_bce_checks_removed;
+            stats->gvn_values_reused = cold_gvn_values_reused;
+            stats->iv_muls_reduced = cold_iv_muls_reduced;
+            stats->iv_muls_skipped_capacity = cold_iv_muls_skipped_capacity;
+            stats->profile_instrumented_blocks = cold_profile.instrumented_blocks;
+            stats->profile_functions_matched = cold_profile.matched_functions;
+            stats->profile_blocks_moved = cold_profile.blocks_moved;
             stats->egraph_dedup_count = cold_egraph_dedup_count;
             stats->egraph_fixed_point_iterations = cold_egraph_fixed_point_iterations;
             stats->cross_block_analysis_ran   = cold_cross_block_analysis_ran;
@@ -19941,29 +24867,7 @@ bool cold_compile_source_path_to_macho(const char *out_path,
         parser.function_bodies = function_bodies;
         parser.function_body_cap = body_cap;
         parser.source_path = src_path;
-        while (parser.pos < mapped_source.len) {
-            parser_ws(&parser);
-            if (parser.pos >= mapped_source.len) break;
-            Span next = parser_peek(&parser);
-            if (span_eq(next, "type")) {
-                parse_type(&parser);
-            } else if (span_eq(next, "const")) {
-                parse_const(&parser);
-            } else if (span_eq(next, "fn")) {
-                int32_t symbol_index = -1;
-                BodyIR *body2 = parse_fn(&parser, &symbol_index);
-                if (!body2) continue;
-                if (symbol_index < 0 || symbol_index >= body_cap) continue;
-                function_bodies[(int32_t)symbol_index] = (BodyIR *)body2;
-                FnDef *fn = &symbols->functions[(int32_t)symbol_index];
-                if (first_function < 0) first_function = (int32_t)symbol_index;
-                if (span_eq(fn->name, "main")) {
-                    main_function = (int32_t)symbol_index;
-                }
-            } else {
-                parser_line(&parser);
-            }
-        }
+        cold_parse_module_decls(&parser, false, &first_function, &main_function);
         if (main_function < 0) {
             if (!allow_demo) {
                 munmap((void *)mapped_source.ptr, (size_t)mapped_source.len);
@@ -20028,10 +24932,18 @@ bool cold_compile_source_path_to_macho(const char *out_path,
             stats->function_count = symbols->function_count;
             stats->type_count = symbols->type_count + symbols->object_count;
             stats->egraph_rewrite_count = cold_egraph_rewrite_count;
+            stats->bce_checks_removed = cold_bce_checks_removed;
+            stats->gvn_values_reused = cold_gvn_values_reused;
+            stats->iv_muls_reduced = cold_iv_muls_reduced;
+            stats->iv_muls_skipped_capacity = cold_iv_muls_skipped_capacity;
+            stats->profile_instrumented_blocks = cold_profile.instrumented_blocks;
+            stats->profile_functions_matched = cold_profile.matched_functions;
+            stats->profile_blocks_moved = cold_profile.blocks_moved;
             stats->egraph_fixed_point_iterations = cold_egraph_fixed_point_iterations;
             stats->cross_block_analysis_ran   = cold_cross_block_analysis_ran;
             stats->cross_block_safe_slots     = cold_cross_block_safe_slots;
             stats->cross_block_unsafe_slots   = cold_cross_block_unsafe_slots;
+            cold_copy_lowering_stats(stats);
             cold_collect_body_stats(symbols, function_bodies, symbols->function_count, stats);
             stats->code_words = code->count;
             stats->arena_kb = arena->used / 1024;
@@ -20057,10 +24969,18 @@ bool cold_compile_source_path_to_macho(const char *out_path,
         stats->function_count = symbols->function_count;
         stats->type_count = symbols->type_count + symbols->object_count;
         stats->egraph_rewrite_count = cold_egraph_rewrite_count;
+        stats->bce_checks_removed = cold_bce_checks_removed;
+        stats->gvn_values_reused = cold_gvn_values_reused;
+        stats->iv_muls_reduced = cold_iv_muls_reduced;
+        stats->iv_muls_skipped_capacity = cold_iv_muls_skipped_capacity;
+        stats->profile_instrumented_blocks = cold_profile.instrumented_blocks;
+        stats->profile_functions_matched = cold_profile.matched_functions;
+        stats->profile_blocks_moved = cold_profile.blocks_moved;
         stats->egraph_fixed_point_iterations = cold_egraph_fixed_point_iterations;
         stats->cross_block_analysis_ran   = cold_cross_block_analysis_ran;
         stats->cross_block_safe_slots     = cold_cross_block_safe_slots;
         stats->cross_block_unsafe_slots   = cold_cross_block_unsafe_slots;
+        cold_copy_lowering_stats(stats);
         if (demo_body) {
             stats->op_count = demo_body->op_count;
             stats->block_count = demo_body->block_count;
@@ -20120,9 +25040,16 @@ static bool cold_write_system_link_exec_report(const char *path,
     fprintf(file, "direct_macho=%d\n", success ? 1 : 0);
     fprintf(file, "function_task_job_count=%d\n", cold_jobs_from_env());
     fprintf(file, "function_task_schedule=%s\n", cold_jobs_from_env() > 1 ? "ws" : "serial");
-    fprintf(file, "lowering_parallel_status=cold_not_available\n");
+    fprintf(file, "lowering_parallel_status=%s\n",
+            stats && stats->lowering_parallel_schedule ? "parallel" : "serial");
     fprintf(file, "lowering_parallel_job_count=%d\n",
             stats ? stats->lowering_parallel_job_count : 0);
+    fprintf(file, "lowering_parallel_active_workers=%d\n",
+            stats ? stats->lowering_parallel_active_workers : 0);
+    fprintf(file, "lowering_parallel_functions=%d\n",
+            stats ? stats->lowering_parallel_functions : 0);
+    fprintf(file, "lowering_serial_fallbacks=%d\n",
+            stats ? stats->lowering_serial_fallbacks : 0);
     int32_t link_object = stats ? stats->link_object : 0;
     int32_t provider_object_count = stats ? stats->provider_object_count : 0;
     int32_t provider_archive = stats ? stats->provider_archive : 0;
@@ -20150,6 +25077,8 @@ static bool cold_write_system_link_exec_report(const char *path,
         fprintf(file, "cold_after_source_bundle_frame_size=%d\n", stats->after_source_bundle_frame_size);
         fprintf(file, "cold_after_csg_frame_size=%d\n", stats->after_csg_frame_size);
         fprintf(file, "cold_codegen_words=%d\n", stats->code_words);
+        fprintf(file, "cold_rodata_bytes=%d\n", stats->rodata_bytes);
+        fprintf(file, "cold_rvc_saved_bytes=%d\n", stats->rvc_saved_bytes);
         fprintf(file, "cold_arena_kb=%zu\n", stats->arena_kb);
         fprintf(file, "facts_bytes=%llu\n", (unsigned long long)stats->facts_bytes);
         fprintf(file, "facts_mmap_us=%llu\n", (unsigned long long)stats->facts_mmap_us);
@@ -20174,6 +25103,13 @@ static bool cold_write_system_link_exec_report(const char *path,
         fprintf(file, "total_function_count=%d\n", stats->total_function_count);
         fprintf(file, "egraph_rewrite_count=%d\n", stats->egraph_rewrite_count);
         fprintf(file, "egraph_licm_hoisted=%d\n", stats->egraph_licm_hoisted);
+        fprintf(file, "bce_checks_removed=%d\n", stats->bce_checks_removed);
+        fprintf(file, "gvn_values_reused=%d\n", stats->gvn_values_reused);
+        fprintf(file, "iv_muls_reduced=%d\n", stats->iv_muls_reduced);
+        fprintf(file, "iv_muls_skipped_capacity=%d\n", stats->iv_muls_skipped_capacity);
+        fprintf(file, "profile_instrumented_blocks=%d\n", stats->profile_instrumented_blocks);
+        fprintf(file, "profile_functions_matched=%d\n", stats->profile_functions_matched);
+        fprintf(file, "profile_blocks_moved=%d\n", stats->profile_blocks_moved);
         fprintf(file, "egraph_dedup_count=%d\n", stats->egraph_dedup_count);
         fprintf(file, "egraph_fixed_point_iterations=%d\n", stats->egraph_fixed_point_iterations);
         fprintf(file, "ownership_compile_entry=%d\n", stats->ownership_compile_entry);
@@ -20367,8 +25303,8 @@ static bool cold_link_elf64_object_to_exec(const char *object_path,
                                   ((uint32_t)delta & 0x03FFFFFFu);
             } else if (machine == EM_RISCV &&
                        (type == R_RISCV_CALL || type == R_RISCV_CALL_PLT)) {
-                if (delta < -(1 << 20) || delta >= (1 << 20)) goto done;
-                words[word_pos] = rv_jal(RV_RA, delta);
+                if (delta < -(1 << 18) || delta >= (1 << 18)) goto done;
+                words[word_pos] = rv_jal(RV_RA, delta * 4);
             } else {
                 goto done;
             }
@@ -20401,6 +25337,88 @@ done:
 #define COLD_PROVIDER_ARCHIVE_VERSION 1u
 #define COLD_PROVIDER_ARCHIVE_HASH_OFFSET 28u
 #define COLD_PROVIDER_ARCHIVE_HEADER_SIZE 36u
+
+/* Open-addressed name index, built once per object or archive so symbol
+   lookups during provider linking cost O(1) instead of a symtab scan.
+   Slots hold value + 1 (0 = empty); callers compare keys themselves. */
+typedef struct ColdNameIndex {
+    uint32_t *hashes;
+    int32_t *values;
+    int32_t cap;
+    int32_t count;
+} ColdNameIndex;
+
+static uint32_t cold_name_hash(const char *ptr, int32_t len) {
+    uint32_t hash = 2166136261u;
+    for (int32_t i = 0; i < len; i++) {
+        hash ^= (uint8_t)ptr[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static bool cold_name_index_init(ColdNameIndex *index, int32_t count) {
+    memset(index, 0, sizeof(*index));
+    int32_t cap = 16;
+    while (cap < count * 2) {
+        if (cap > INT32_MAX / 2) return false;
+        cap *= 2;
+    }
+    index->hashes = (uint32_t *)calloc((size_t)cap, sizeof(uint32_t));
+    index->values = (int32_t *)calloc((size_t)cap, sizeof(int32_t));
+    if (!index->hashes || !index->values) {
+        free(index->hashes);
+        free(index->values);
+        memset(index, 0, sizeof(*index));
+        return false;
+    }
+    index->cap = cap;
+    return true;
+}
+
+static void cold_name_index_free(ColdNameIndex *index) {
+    if (!index) return;
+    free(index->hashes);
+    free(index->values);
+    memset(index, 0, sizeof(*index));
+}
+
+typedef Span (*ColdNameIndexKey)(void *ctx, int32_t value);
+
+static int32_t cold_name_index_find(ColdNameIndex *index, Span name,
+                                    ColdNameIndexKey key, void *ctx) {
+    if (!index || index->cap <= 0 || name.len <= 0) return -1;
+    uint32_t mask = (uint32_t)index->cap - 1u;
+    uint32_t hash = cold_name_hash((const char *)name.ptr, name.len);
+    for (uint32_t slot = hash & mask; index->values[slot] != 0; slot = (slot + 1u) & mask) {
+        if (index->hashes[slot] == hash &&
+            span_same(key(ctx, index->values[slot] - 1), name)) {
+            return index->values[slot] - 1;
+        }
+    }
+    return -1;
+}
+
+/* Insert name -> value.  An existing entry is kept and its value returned,
+   so the first definition wins; -1 means the name was inserted. */
+static int32_t cold_name_index_insert(ColdNameIndex *index, Span name, int32_t value,
+                                      ColdNameIndexKey key, void *ctx) {
+    if (!index || index->cap <= 0 || name.len <= 0) return -1;
+    uint32_t mask = (uint32_t)index->cap - 1u;
+    uint32_t hash = cold_name_hash((const char *)name.ptr, name.len);
+    uint32_t slot = hash & mask;
+    for (; index->values[slot] != 0; slot = (slot + 1u) & mask) {
+        if (index->hashes[slot] == hash &&
+            span_same(key(ctx, index->values[slot] - 1), name)) {
+            return index->values[slot] - 1;
+        }
+    }
+    index->hashes[slot] = hash;
+    index->values[slot] = value + 1;
+    index->count++;
+    return -1;
+}
+
 /* Mach-O relocatable object view (MH_OBJECT) */
 typedef struct ColdMachOObjectView {
 const uint8_t *data;
@@ -20415,6 +25433,7 @@ const char *strtab;
 uint64_t strtab_size;
 const struct { int32_t r_address; uint32_t r_symbolnum : 24; uint32_t r_pcrel : 1; uint32_t r_length : 2; uint32_t r_extern : 1; uint32_t r_type : 4; } *relas;
 int32_t reloc_count;
+ColdNameIndex defined;
 } ColdMachOObjectView;
 
 typedef struct ColdElfObjectView {
@@ -20430,6 +25449,7 @@ typedef struct ColdElfObjectView {
     uint64_t strtab_size;
     const Elf64_Rela *relas;
     int32_t reloc_count;
+    ColdNameIndex defined;   /* defined .text symbols by name */
 } ColdElfObjectView;
 
 static bool cold_read_elf64_relocatable_view(const uint8_t *data,
@@ -20437,11 +25457,15 @@ static bool cold_read_elf64_relocatable_view(const uint8_t *data,
                                              const char *target,
                                              ColdElfObjectView *out);
 static int32_t cold_elf_find_defined_symbol(ColdElfObjectView *obj, const char *name);
+static void cold_elf_index_defined_symbols(ColdElfObjectView *obj);
+static void cold_elf_view_release(ColdElfObjectView *obj);
 static bool cold_read_macho_relocatable_view(const uint8_t *data,
                                              int32_t len,
                                              const char *target,
                                              ColdMachOObjectView *out);
 static int32_t cold_macho_find_defined_symbol(ColdMachOObjectView *obj, const char *name);
+static void cold_macho_index_defined_symbols(ColdMachOObjectView *obj);
+static void cold_macho_view_release(ColdMachOObjectView *obj);
 static bool cold_cstr_eq_span(const char *text, Span span);
 
 static const char *cold_object_format_for_target_cstr(const char *target) {
@@ -20455,6 +25479,17 @@ static const char *cold_object_format_for_target_cstr(const char *target) {
     return "";
 }
 
+/* Member and export counts are bounded by the archive size instead of fixed
+   caps: each member has a 28-byte header and at least one export, and each
+   export name is at least one byte. */
+static bool cold_provider_archive_counts_fit(int64_t archive_len,
+                                             uint32_t member_count,
+                                             uint32_t export_count) {
+    if (member_count == 0 || export_count < member_count) return false;
+    if ((uint64_t)member_count * 28u > (uint64_t)archive_len) return false;
+    return (uint64_t)export_count <= (uint64_t)archive_len;
+}
+
 static uint64_t cold_provider_archive_hash_bytes(uint8_t *buf, size_t len) {
     if (len < COLD_PROVIDER_ARCHIVE_HEADER_SIZE) return 0;
     uint8_t saved[8];
@@ -20548,6 +25583,23 @@ static const char *cold_provider_object_read_error(Span object_span,
     return "unsupported provider archive target";
 }
 
+static Span cold_cstr_array_key(void *ctx, int32_t index) {
+    const char *text = ((const char **)ctx)[index];
+    Span span = {(const uint8_t *)text, (int32_t)strlen(text)};
+    return span;
+}
+
+static void cold_provider_object_views_free(ColdElfObjectView *views,
+                                            ColdMachOObjectView *macho_views,
+                                            int32_t count) {
+    for (int32_t i = 0; i < count; i++) {
+        if (views) cold_elf_view_release(&views[i]);
+        if (macho_views) cold_macho_view_release(&macho_views[i]);
+    }
+    free(views);
+    free(macho_views);
+}
+
 static bool cold_write_provider_archive(const char *out_path,
                                         const char *target,
                                         const char **member_objects,
@@ -20563,7 +25615,6 @@ static bool cold_write_provider_archive(const char *out_path,
     if (format[0] == '\0') return false;
     if (!member_objects || member_object_count <= 0 ||
         !export_symbols || export_symbol_count <= 0) return false;
-    if (member_object_count > 128 || export_symbol_count > 512) return false;
     const char *module = member_module && member_module[0] ? member_module : "";
     const char *source = member_source && member_source[0] ? member_source : "";
     bool is_macho = (strcmp(format, "macho") == 0);
@@ -20573,7 +25624,7 @@ static bool cold_write_provider_archive(const char *out_path,
     int32_t *member_export_counts = (int32_t *)calloc((size_t)member_object_count, sizeof(int32_t));
     int32_t *export_owner = (int32_t *)calloc((size_t)export_symbol_count, sizeof(int32_t));
     if (!objects || (!views && !macho_views) || !member_export_counts || !export_owner) {
-        free(objects); free(views); free(macho_views); free(member_export_counts); free(export_owner);
+        free(objects); cold_provider_object_views_free(views, macho_views, member_object_count); free(member_export_counts); free(export_owner);
         return false;
     }
     for (int32_t ei = 0; ei < export_symbol_count; ei++) export_owner[ei] = -1;
@@ -20588,16 +25639,17 @@ static bool cold_write_provider_archive(const char *out_path,
             if (!cold_read_elf64_relocatable_view(objects[oi].ptr, objects[oi].len, target, &views[oi])) { valid = false; break; }
         }
     }
+    ColdNameIndex export_names;
+    if (!cold_name_index_init(&export_names, export_symbol_count)) valid = false;
     for (int32_t ei = 0; valid && ei < export_symbol_count; ei++) {
         const char *name = export_symbols[ei];
         if (!name || name[0] == '\0') { valid = false; break; }
-        for (int32_t prev = 0; prev < ei; prev++) {
-            if (strcmp(export_symbols[prev], name) == 0) {
-                valid = false;
-                break;
-            }
+        Span name_span = {(const uint8_t *)name, (int32_t)strlen(name)};
+        if (cold_name_index_insert(&export_names, name_span, ei,
+                                   cold_cstr_array_key, (void *)export_symbols) >= 0) {
+            valid = false;
+            break;
         }
-        if (!valid) break;
         int32_t owner = -1;
         int32_t def_count = 0;
         for (int32_t oi = 0; oi < member_object_count; oi++) {
@@ -20616,6 +25668,7 @@ static bool cold_write_provider_archive(const char *out_path,
         export_owner[ei] = owner;
         member_export_counts[owner]++;
     }
+    cold_name_index_free(&export_names);
     for (int32_t oi = 0; valid && oi < member_object_count; oi++) {
         if (member_export_counts[oi] <= 0) valid = false;
     }
@@ -20623,7 +25676,7 @@ static bool cold_write_provider_archive(const char *out_path,
         for (int32_t oi = 0; oi < member_object_count; oi++) {
             if (objects[oi].len > 0) munmap((void *)objects[oi].ptr, (size_t)objects[oi].len);
         }
-        free(objects); free(views); free(macho_views); free(member_export_counts); free(export_owner);
+        free(objects); cold_provider_object_views_free(views, macho_views, member_object_count); free(member_export_counts); free(export_owner);
         return false;
     }
     uint32_t target_len = (uint32_t)strlen(target);
@@ -20648,7 +25701,7 @@ static bool cold_write_provider_archive(const char *out_path,
         for (int32_t oi = 0; oi < member_object_count; oi++) {
             if (objects[oi].len > 0) munmap((void *)objects[oi].ptr, (size_t)objects[oi].len);
         }
-        free(objects); free(views); free(macho_views); free(member_export_counts); free(export_owner);
+        free(objects); cold_provider_object_views_free(views, macho_views, member_object_count); free(member_export_counts); free(export_owner);
         return false;
     }
     uint8_t *buf = (uint8_t *)calloc(1, total);
@@ -20656,7 +25709,7 @@ static bool cold_write_provider_archive(const char *out_path,
         for (int32_t oi = 0; oi < member_object_count; oi++) {
             if (objects[oi].len > 0) munmap((void *)objects[oi].ptr, (size_t)objects[oi].len);
         }
-        free(objects); free(views); free(macho_views); free(member_export_counts); free(export_owner);
+        free(objects); cold_provider_object_views_free(views, macho_views, member_object_count); free(member_export_counts); free(export_owner);
         return false;
     }
     size_t pos = 0;
@@ -20703,7 +25756,7 @@ static bool cold_write_provider_archive(const char *out_path,
         for (int32_t oi = 0; oi < member_object_count; oi++) {
             if (objects[oi].len > 0) munmap((void *)objects[oi].ptr, (size_t)objects[oi].len);
         }
-        free(objects); free(views); free(macho_views); free(member_export_counts); free(export_owner);
+        free(objects); cold_provider_object_views_free(views, macho_views, member_object_count); free(member_export_counts); free(export_owner);
         return false;
     }
     uint64_t archive_hash = cold_provider_archive_hash_bytes(buf, total);
@@ -20714,7 +25767,7 @@ static bool cold_write_provider_archive(const char *out_path,
         for (int32_t oi = 0; oi < member_object_count; oi++) {
             if (objects[oi].len > 0) munmap((void *)objects[oi].ptr, (size_t)objects[oi].len);
         }
-        free(objects); free(views); free(macho_views); free(member_export_counts); free(export_owner);
+        free(objects); cold_provider_object_views_free(views, macho_views, member_object_count); free(member_export_counts); free(export_owner);
         return false;
     }
     int fd = open(out_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
@@ -20723,7 +25776,7 @@ static bool cold_write_provider_archive(const char *out_path,
         for (int32_t oi = 0; oi < member_object_count; oi++) {
             if (objects[oi].len > 0) munmap((void *)objects[oi].ptr, (size_t)objects[oi].len);
         }
-        free(objects); free(views); free(macho_views); free(member_export_counts); free(export_owner);
+        free(objects); cold_provider_object_views_free(views, macho_views, member_object_count); free(member_export_counts); free(export_owner);
         return false;
     }
     bool ok = cold_write_all_fd(fd, buf, total);
@@ -20732,7 +25785,7 @@ static bool cold_write_provider_archive(const char *out_path,
     for (int32_t oi = 0; oi < member_object_count; oi++) {
         if (objects[oi].len > 0) munmap((void *)objects[oi].ptr, (size_t)objects[oi].len);
     }
-    free(objects); free(views); free(macho_views); free(member_export_counts); free(export_owner);
+    free(objects); cold_provider_object_views_free(views, macho_views, member_object_count); free(member_export_counts); free(export_owner);
     if (!ok) return false;
     if (member_count_out) *member_count_out = (int32_t)member_count;
     if (hash_out) *hash_out = archive_hash;
@@ -20766,8 +25819,7 @@ static bool cold_verify_provider_archive(const char *path,
         COLD_ARCHIVE_VERIFY_FAIL("provider archive version mismatch");
     if (target_len == 0 || format_len == 0)
         COLD_ARCHIVE_VERIFY_FAIL("provider archive header invalid");
-    if (member_count == 0 || member_count > 128 ||
-        export_count == 0 || export_count > 512)
+    if (!cold_provider_archive_counts_fit(archive.len, member_count, export_count))
         COLD_ARCHIVE_VERIFY_FAIL("provider archive counts invalid");
     uint64_t pos = COLD_PROVIDER_ARCHIVE_HEADER_SIZE;
     if (!cold_file_range_ok(archive.len, pos, target_len))
@@ -20906,6 +25958,7 @@ static bool cold_read_macho_relocatable_view(const uint8_t *data,
     if (out->word_count <= 0 || out->text_size <= 0) return false;
     out->data = data;
     out->len = len;
+    cold_macho_index_defined_symbols(out);
 
     /* Parse relocations from section headers in LC_SEGMENT_64.
        Each section header is 80 bytes: reloff at offset 56, nreloc at offset 60. */
@@ -20956,40 +26009,35 @@ static const char *cold_macho_symbol_name(ColdMachOObjectView *obj, uint32_t sym
     return name;
 }
 
-static int32_t cold_macho_find_defined_symbol(ColdMachOObjectView *obj, const char *name) {
-    if (!obj || !name || name[0] == '\0') return -1;
-    char underscored[1024];
-    int32_t ulen = 0;
-    bool try_underscore = (name[0] != '_');
-    if (try_underscore && (ulen = (int32_t)strlen(name)) < 1022) {
-        underscored[0] = '_';
-        memcpy(underscored + 1, name, (size_t)ulen);
-        underscored[ulen + 1] = '\0';
+static bool cold_macho_symbol_defined(ColdMachOObjectView *obj, int32_t sym_index) {
+    return (obj->syms[sym_index].n_type & 0x0e) == 0x0e && obj->syms[sym_index].n_sect != 0;
+}
+
+static Span cold_macho_symbol_key(void *ctx, int32_t sym_index) {
+    const char *name = cold_macho_symbol_name((ColdMachOObjectView *)ctx, (uint32_t)sym_index);
+    Span span = {(const uint8_t *)name, name ? (int32_t)strlen(name) : 0};
+    return span;
+}
+
+static void cold_macho_index_defined_symbols(ColdMachOObjectView *obj) {
+    int32_t defined = 0;
+    for (int32_t i = 0; i < obj->sym_count; i++) {
+        if (cold_macho_symbol_defined(obj, i)) defined++;
     }
+    if (!cold_name_index_init(&obj->defined, defined)) return;
     for (int32_t i = 0; i < obj->sym_count; i++) {
-        const uint8_t n_type = obj->syms[i].n_type;
-        if ((n_type & 0x0e) != 0x0e) continue;
-        if (obj->syms[i].n_sect == 0) continue;
-        const char *sn = cold_macho_symbol_name(obj, (uint32_t)i);
-        if (!sn) continue;
-        if (strcmp(sn, name) == 0) return i;
-        if (try_underscore && strcmp(sn, underscored) == 0) return i;
+        if (!cold_macho_symbol_defined(obj, i)) continue;
+        Span name = cold_macho_symbol_key(obj, i);
+        cold_name_index_insert(&obj->defined, name, i, cold_macho_symbol_key, obj);
     }
-    return -1;
 }
 
-static bool cold_macho_defined_symbol_word(ColdMachOObjectView *obj,
-                                            const char *name,
-                                            int32_t *word_out) {
-    if (!obj || !name || name[0] == '\0') return false;
-    int32_t sym_idx = cold_macho_find_defined_symbol(obj, name);
-    if (sym_idx < 0) return false;
-    uint64_t value = obj->syms[sym_idx].n_value;
-    if ((value % 4) != 0 || value / 4 >= (uint64_t)obj->word_count) return false;
-    if (word_out) *word_out = (int32_t)(value / 4);
-    return true;
+static void cold_macho_view_release(ColdMachOObjectView *obj) {
+    if (obj) cold_name_index_free(&obj->defined);
 }
 
+/* C names match either verbatim or with the Mach-O leading underscore;
+   the lower symbol index wins, as in a single symtab scan. */
 static int32_t cold_macho_find_defined_symbol_span(ColdMachOObjectView *obj, Span name) {
     if (!obj || name.len <= 0) return -1;
     char underscored[1024];
@@ -20999,10 +26047,18 @@ static int32_t cold_macho_find_defined_symbol_span(ColdMachOObjectView *obj, Spa
         memcpy(underscored + 1, name.ptr, (size_t)name.len);
         underscored[name.len + 1] = '\0';
     }
+    if (obj->defined.cap > 0) {
+        int32_t found = cold_name_index_find(&obj->defined, name, cold_macho_symbol_key, obj);
+        if (try_underscore) {
+            Span alt = {(const uint8_t *)underscored, name.len + 1};
+            int32_t alt_found = cold_name_index_find(&obj->defined, alt,
+                                                     cold_macho_symbol_key, obj);
+            if (alt_found >= 0 && (found < 0 || alt_found < found)) found = alt_found;
+        }
+        return found;
+    }
     for (int32_t i = 0; i < obj->sym_count; i++) {
-        const uint8_t n_type = obj->syms[i].n_type;
-        if ((n_type & 0x0e) != 0x0e) continue;
-        if (obj->syms[i].n_sect == 0) continue;
+        if (!cold_macho_symbol_defined(obj, i)) continue;
         const char *sn = cold_macho_symbol_name(obj, (uint32_t)i);
         if (cold_cstr_eq_span(sn, name)) return i;
         if (try_underscore && sn && strcmp(sn, underscored) == 0) return i;
@@ -21010,6 +26066,24 @@ static int32_t cold_macho_find_defined_symbol_span(ColdMachOObjectView *obj, Spa
     return -1;
 }
 
+static int32_t cold_macho_find_defined_symbol(ColdMachOObjectView *obj, const char *name) {
+    if (!obj || !name || name[0] == '\0') return -1;
+    Span span = {(const uint8_t *)name, (int32_t)strlen(name)};
+    return cold_macho_find_defined_symbol_span(obj, span);
+}
+
+static bool cold_macho_defined_symbol_word(ColdMachOObjectView *obj,
+                                            const char *name,
+                                            int32_t *word_out) {
+    if (!obj || !name || name[0] == '\0') return false;
+    int32_t sym_idx = cold_macho_find_defined_symbol(obj, name);
+    if (sym_idx < 0) return false;
+    uint64_t value = obj->syms[sym_idx].n_value;
+    if ((value % 4) != 0 || value / 4 >= (uint64_t)obj->word_count) return false;
+    if (word_out) *word_out = (int32_t)(value / 4);
+    return true;
+}
+
 static bool cold_read_elf64_relocatable_view(const uint8_t *data,
                                              int32_t len,
                                              const char *target,
@@ -21090,6 +26164,7 @@ static bool cold_read_elf64_relocatable_view(const uint8_t *data,
     out->strtab_size = strtab->sh_size;
     out->relas = relas;
     out->reloc_count = reloc_count;
+    cold_elf_index_defined_symbols(out);
     return true;
 }
 
@@ -21100,15 +26175,28 @@ static const char *cold_elf_symbol_name(ColdElfObjectView *obj, uint32_t sym_ind
     return obj->strtab + off;
 }
 
-static int32_t cold_elf_find_defined_symbol(ColdElfObjectView *obj, const char *name) {
-    if (!obj || !name || name[0] == '\0') return -1;
+static Span cold_elf_symbol_key(void *ctx, int32_t sym_index) {
+    const char *name = cold_elf_symbol_name((ColdElfObjectView *)ctx, (uint32_t)sym_index);
+    Span span = {(const uint8_t *)name, name ? (int32_t)strlen(name) : 0};
+    return span;
+}
+
+/* Without an index (allocation failed) lookups fall back to the symtab scan. */
+static void cold_elf_index_defined_symbols(ColdElfObjectView *obj) {
+    int32_t defined = 0;
     for (int32_t i = 1; i < obj->sym_count; i++) {
-        const Elf64_Sym *sym = &obj->syms[i];
-        if (sym->st_shndx != (uint16_t)obj->text_idx) continue;
-        const char *sn = cold_elf_symbol_name(obj, (uint32_t)i);
-        if (sn && strcmp(sn, name) == 0) return i;
+        if (obj->syms[i].st_shndx == (uint16_t)obj->text_idx) defined++;
     }
-    return -1;
+    if (!cold_name_index_init(&obj->defined, defined)) return;
+    for (int32_t i = 1; i < obj->sym_count; i++) {
+        if (obj->syms[i].st_shndx != (uint16_t)obj->text_idx) continue;
+        Span name = cold_elf_symbol_key(obj, i);
+        cold_name_index_insert(&obj->defined, name, i, cold_elf_symbol_key, obj);
+    }
+}
+
+static void cold_elf_view_release(ColdElfObjectView *obj) {
+    if (obj) cold_name_index_free(&obj->defined);
 }
 
 static bool cold_cstr_eq_span(const char *text, Span span) {
@@ -21119,6 +26207,8 @@ static bool cold_cstr_eq_span(const char *text, Span span) {
 
 static int32_t cold_elf_find_defined_symbol_span(ColdElfObjectView *obj, Span name) {
     if (!obj || name.len <= 0) return -1;
+    if (obj->defined.cap > 0)
+        return cold_name_index_find(&obj->defined, name, cold_elf_symbol_key, obj);
     for (int32_t i = 1; i < obj->sym_count; i++) {
         const Elf64_Sym *sym = &obj->syms[i];
         if (sym->st_shndx != (uint16_t)obj->text_idx) continue;
@@ -21128,6 +26218,12 @@ static int32_t cold_elf_find_defined_symbol_span(ColdElfObjectView *obj, Span na
     return -1;
 }
 
+static int32_t cold_elf_find_defined_symbol(ColdElfObjectView *obj, const char *name) {
+    if (!obj || !name || name[0] == '\0') return -1;
+    Span span = {(const uint8_t *)name, (int32_t)strlen(name)};
+    return cold_elf_find_defined_symbol_span(obj, span);
+}
+
 static bool cold_elf_defined_symbol_word(ColdElfObjectView *obj,
                                          const char *name,
                                          int32_t *word_out) {
@@ -21159,8 +26255,26 @@ typedef struct ColdProviderArchiveView {
     int32_t member_count;
     int32_t export_count;
     uint64_t hash;
+    Span *export_names;        /* archive order */
+    int32_t *export_members;   /* owning member per export */
+    ColdNameIndex export_index;
 } ColdProviderArchiveView;
 
+static Span cold_provider_export_key(void *ctx, int32_t export_index) {
+    return ((Span *)ctx)[export_index];
+}
+
+static void cold_provider_archive_members_free(ColdProviderArchiveMember *members,
+                                               int32_t member_count) {
+    if (!members) return;
+    for (int32_t mi = 0; mi < member_count; mi++) {
+        free(members[mi].exports);
+        cold_elf_view_release(&members[mi].view);
+        cold_macho_view_release(&members[mi].macho_view);
+    }
+    free(members);
+}
+
 static bool cold_parse_provider_archive_view(Span archive_span,
                                              const char *target,
                                              int32_t member_count,
@@ -21181,8 +26295,8 @@ static bool cold_parse_provider_archive_view(Span archive_span,
     uint32_t target_len = cold_u32le(p + 12);
     uint32_t format_len = cold_u32le(p + 16);
     uint32_t export_count = cold_u32le(p + 24);
-    if (member_count <= 0 || member_count > 128 ||
-        export_count == 0 || export_count > 512) {
+    if (member_count <= 0 || export_count == 0 ||
+        !cold_provider_archive_counts_fit(archive_span.len, (uint32_t)member_count, export_count)) {
         cold_provider_error_set(error, error_cap, "provider archive parse counts invalid");
         return false;
     }
@@ -21216,8 +26330,13 @@ static bool cold_parse_provider_archive_view(Span archive_span,
                                             sizeof(ColdProviderArchiveMember));
     Span *seen_exports = (Span *)calloc(export_count > 0 ? (size_t)export_count : 1,
                                         sizeof(Span));
-    if (!members || !seen_exports) {
-        free(members); free(seen_exports);
+    int32_t *export_members = (int32_t *)calloc(export_count > 0 ? (size_t)export_count : 1,
+                                                sizeof(int32_t));
+    ColdNameIndex export_index;
+    bool index_ok = cold_name_index_init(&export_index, (int32_t)export_count);
+    if (!members || !seen_exports || !export_members || !index_ok) {
+        free(members); free(seen_exports); free(export_members);
+        cold_name_index_free(&export_index);
         cold_provider_error_set(error, error_cap, "provider archive parse allocation failed");
         return false;
     }
@@ -21330,20 +26449,20 @@ static bool cold_parse_provider_archive_view(Span archive_span,
                     goto fail;
                 }
             }
-            for (int32_t si = 0; si < seen_count; si++) {
-                if (span_same(seen_exports[si], export_name)) {
-                    cold_provider_error_set_span(reason_buf, sizeof(reason_buf),
-                                                 "duplicate provider export in archive",
-                                                 export_name);
-                    reason = reason_buf;
-                    goto fail;
-                }
-            }
             if (seen_count >= (int32_t)export_count) {
                 reason = "provider archive export count mismatch";
                 goto fail;
             }
-            seen_exports[seen_count++] = export_name;
+            seen_exports[seen_count] = export_name;
+            if (cold_name_index_insert(&export_index, export_name, seen_count,
+                                       cold_provider_export_key, seen_exports) >= 0) {
+                cold_provider_error_set_span(reason_buf, sizeof(reason_buf),
+                                             "duplicate provider export in archive",
+                                             export_name);
+                reason = reason_buf;
+                goto fail;
+            }
+            export_members[seen_count++] = mi;
         }
         pos += object_size;
     }
@@ -21355,46 +26474,41 @@ static bool cold_parse_provider_archive_view(Span archive_span,
         reason = "provider archive trailing data";
         goto fail;
     }
-    free(seen_exports);
     out->members = members;
     out->member_count = member_count;
     out->export_count = (int32_t)export_count;
     out->hash = archive_hash;
+    out->export_names = seen_exports;
+    out->export_members = export_members;
+    out->export_index = export_index;
     return true;
 
 fail:
-    if (members) {
-        for (int32_t mi = 0; mi < member_count; mi++) free(members[mi].exports);
-    }
-    free(members);
+    cold_provider_archive_members_free(members, member_count);
     free(seen_exports);
+    free(export_members);
+    cold_name_index_free(&export_index);
     cold_provider_error_set(error, error_cap, reason);
     return false;
 }
 
 static void cold_provider_archive_view_free(ColdProviderArchiveView *view) {
     if (!view || !view->members) return;
-    for (int32_t mi = 0; mi < view->member_count; mi++) {
-        free(view->members[mi].exports);
-    }
-    free(view->members);
+    cold_provider_archive_members_free(view->members, view->member_count);
+    free(view->export_names);
+    free(view->export_members);
+    cold_name_index_free(&view->export_index);
     memset(view, 0, sizeof(*view));
 }
 
+/* Parsing rejects duplicate exports, so a name maps to at most one member. */
 static int32_t cold_provider_archive_find_export(ColdProviderArchiveView *archive,
                                                  const char *symbol_name) {
     if (!archive || !symbol_name || symbol_name[0] == '\0') return -1;
-    int32_t found = -1;
-    for (int32_t mi = 0; mi < archive->member_count; mi++) {
-        ColdProviderArchiveMember *member = &archive->members[mi];
-        for (int32_t ei = 0; ei < member->export_count; ei++) {
-            if (cold_cstr_eq_span(symbol_name, member->exports[ei])) {
-                if (found >= 0) return -2;
-                found = mi;
-            }
-        }
-    }
-    return found;
+    Span name = {(const uint8_t *)symbol_name, (int32_t)strlen(symbol_name)};
+    int32_t ei = cold_name_index_find(&archive->export_index, name,
+                                      cold_provider_export_key, archive->export_names);
+    return ei >= 0 ? archive->export_members[ei] : -1;
 }
 
 static bool cold_provider_archive_find_selected_definition(ColdProviderArchiveView *archive,
@@ -21546,8 +26660,8 @@ static bool cold_apply_elf_call_reloc(uint32_t *words,
         return true;
     }
     if (machine == EM_RISCV && (type == R_RISCV_CALL || type == R_RISCV_CALL_PLT)) {
-        if (delta < -(1 << 20) || delta >= (1 << 20)) return false;
-        words[word_pos] = rv_jal(RV_RA, delta);
+        if (delta < -(1 << 18) || delta >= (1 << 18)) return false;
+        words[word_pos] = rv_jal(RV_RA, delta * 4);
         return true;
     }
     return false;
@@ -21772,6 +26886,7 @@ static bool cold_link_elf64_object_with_provider_archive(const char *object_path
     Span archive_span = source_open(archive_path);
     uint32_t *words = 0;
     ColdProviderArchiveView archive = {0};
+    ColdElfObjectView primary = {0};
     bool ok = false;
     if (primary_span.len <= 0) {
         cold_stats_provider_error(stats, "link object open failed");
@@ -21781,7 +26896,6 @@ static bool cold_link_elf64_object_with_provider_archive(const char *object_path
         cold_stats_provider_error(stats, "provider archive open/header failed");
         goto done;
     }
-    ColdElfObjectView primary;
     if (!cold_read_elf64_relocatable_view(primary_span.ptr, primary_span.len, target, &primary)) {
         cold_stats_provider_error(stats, "link object machine mismatch");
         goto done;
@@ -21899,6 +27013,7 @@ static bool cold_link_elf64_object_with_provider_archive(const char *object_path
 done:
     if (words) free(words);
     cold_provider_archive_view_free(&archive);
+    cold_elf_view_release(&primary);
     if (primary_span.len > 0) munmap((void *)primary_span.ptr, (size_t)primary_span.len);
     if (archive_span.len > 0) munmap((void *)archive_span.ptr, (size_t)archive_span.len);
     return ok;
@@ -21914,6 +27029,7 @@ static bool cold_link_macho_object_with_provider_archive(const char *object_path
     Span archive_span = source_open(archive_path);
     uint32_t *words = 0;
     ColdProviderArchiveView archive = {0};
+    ColdMachOObjectView primary = {0};
     bool ok = false;
     if (primary_span.len <= 0) {
         cold_stats_provider_error(stats, "link object open failed");
@@ -21923,7 +27039,6 @@ static bool cold_link_macho_object_with_provider_archive(const char *object_path
         cold_stats_provider_error(stats, "provider archive open/header failed");
         goto done;
     }
-    ColdMachOObjectView primary;
     if (!cold_read_macho_relocatable_view(primary_span.ptr, primary_span.len, target, &primary)) {
         cold_stats_provider_error(stats, "link object machine mismatch");
         goto done;
@@ -22050,6 +27165,7 @@ static bool cold_link_macho_object_with_provider_archive(const char *object_path
 done:
     if (words) free(words);
     cold_provider_archive_view_free(&archive);
+    cold_macho_view_release(&primary);
     if (primary_span.len > 0) munmap((void *)primary_span.ptr, (size_t)primary_span.len);
     if (archive_span.len > 0) munmap((void *)archive_span.ptr, (size_t)archive_span.len);
     return ok;
@@ -22073,6 +27189,7 @@ static bool cold_runtime_provider_linux_root_supported(const char *symbol) {
         "cheng_mm_free_count",
         "cheng_mm_live_count",
         "cheng_mm_diag_reset",
+        "cheng_mem_flush",
         "cheng_panic_cstring_and_exit",
         "driver_c_new_string",
         "driver_c_new_string_copy_n",
@@ -22104,6 +27221,9 @@ static bool cold_runtime_provider_linux_root_supported(const char *symbol) {
         "cheng_thread_spawn_i32",
         "cheng_thread_parallelism",
         "cheng_thread_yield",
+        "cheng_sleep_ms_bridge",
+        "cheng_futex_wait_i32",
+        "cheng_futex_wake_i32",
         "cheng_retain_atomic",
         "cheng_release_atomic",
     };
@@ -22131,6 +27251,7 @@ static bool cold_runtime_provider_program_support_root(const char *symbol) {
         "cheng_mm_free_count",
         "cheng_mm_live_count",
         "cheng_mm_diag_reset",
+        "cheng_mem_flush",
         "cheng_atomic_cas_i32",
         "cheng_atomic_load_i32",
         "cheng_atomic_store_i32",
@@ -22144,6 +27265,9 @@ static bool cold_runtime_provider_program_support_root(const char *symbol) {
         "cheng_thread_spawn_i32",
         "cheng_thread_parallelism",
         "cheng_thread_yield",
+        "cheng_sleep_ms_bridge",
+        "cheng_futex_wait_i32",
+        "cheng_futex_wake_i32",
         "cheng_panic_cstring_and_exit",
         "driver_c_new_string",
         "driver_c_new_string_copy_n",
@@ -22452,7 +27576,7 @@ static int32_t cold_collect_elf_undefined_reloc_symbols(const char *object_path,
     if (!object_path || !target || !symbols || symbol_cap <= 0 || !arena) return -1;
     Span object_span = source_open(object_path);
     if (object_span.len <= 0) return -1;
-    ColdElfObjectView object;
+    ColdElfObjectView object = {0};
     int32_t count = -1;
     if (!cold_read_elf64_relocatable_view(object_span.ptr, object_span.len, target, &object)) goto done;
     count = 0;
@@ -22476,6 +27600,7 @@ static int32_t cold_collect_elf_undefined_reloc_symbols(const char *object_path,
         symbols[count++] = copy;
     }
 done:
+    cold_elf_view_release(&object);
     munmap((void *)object_span.ptr, (size_t)object_span.len);
     return count;
 }
@@ -22514,34 +27639,47 @@ static bool cold_write_provider_archive_pack_report(const char *path,
 
 static int cold_cmd_provider_archive_pack(int argc, char **argv) {
     const char *target = cold_flag_value(argc, argv, "--target");
-    const char *object_paths[128];
-    const char *export_symbols[512];
-    int32_t object_count = cold_flag_values(argc, argv, "--object", object_paths, 128);
-    int32_t export_count = cold_flag_values(argc, argv, "--export", export_symbols, 512);
+    int32_t object_cap = cold_flag_count(argc, argv, "--object");
+    int32_t export_cap = cold_flag_count(argc, argv, "--export");
+    const char **object_paths = (const char **)calloc((size_t)(object_cap > 0 ? object_cap : 1),
+                                                      sizeof(const char *));
+    const char **export_symbols = (const char **)calloc((size_t)(export_cap > 0 ? export_cap : 1),
+                                                        sizeof(const char *));
+    if (!object_paths || !export_symbols) {
+        free(object_paths); free(export_symbols);
+        fprintf(stderr, "[cheng_cold] provider-archive-pack allocation failed\n");
+        return 2;
+    }
+    int32_t object_count = cold_flag_values(argc, argv, "--object", object_paths, object_cap);
+    int32_t export_count = cold_flag_values(argc, argv, "--export", export_symbols, export_cap);
     const char *object_path = object_count > 0 ? object_paths[0] : 0;
     const char *out_path = cold_flag_value(argc, argv, "--out");
     const char *export_symbol = export_count > 0 ? export_symbols[0] : 0;
     const char *module = cold_flag_value(argc, argv, "--module");
     const char *source = cold_flag_value(argc, argv, "--source");
     const char *report_path = cold_flag_value(argc, argv, "--report-out");
+    Span *objects = 0;
+    ColdElfObjectView *views = 0;
+    ColdMachOObjectView *macho_views = 0;
+    int rc = 2;
     if (!target || target[0] == '\0') target = "arm64-apple-darwin";
     if (object_count <= 0) {
         cold_write_provider_archive_pack_report(report_path, false, target, object_path, out_path,
                                                 export_symbol, 0, 0, 0, "missing --object");
         fprintf(stderr, "[cheng_cold] provider-archive-pack requires --object:<obj>\n");
-        return 2;
+        goto done;
     }
     if (!out_path || out_path[0] == '\0') {
         cold_write_provider_archive_pack_report(report_path, false, target, object_path, out_path,
                                                 export_symbol, 0, 0, 0, "missing --out");
         fprintf(stderr, "[cheng_cold] provider-archive-pack requires --out:<archive>\n");
-        return 2;
+        goto done;
     }
     if (export_count <= 0) {
         cold_write_provider_archive_pack_report(report_path, false, target, object_path, out_path,
                                                 export_symbol, 0, 0, 0, "missing --export");
         fprintf(stderr, "[cheng_cold] provider-archive-pack requires --export:<symbol>\n");
-        return 2;
+        goto done;
     }
     const char *format = cold_object_format_for_target_cstr(target);
     bool is_macho = (strcmp(format, "macho") == 0);
@@ -22550,55 +27688,53 @@ static int cold_cmd_provider_archive_pack(int argc, char **argv) {
         cold_write_provider_archive_pack_report(report_path, false, target, object_path, out_path,
                                                 export_symbol, 0, 0, 0, "unsupported provider archive target");
         fprintf(stderr, "[cheng_cold] unsupported provider archive target: %s\n", target);
-        return 2;
+        goto done;
     }
-    Span objects[128];
-    ColdElfObjectView views[128];
-    ColdMachOObjectView macho_views[128];
+    objects = (Span *)calloc((size_t)object_count, sizeof(Span));
+    views = (ColdElfObjectView *)calloc((size_t)object_count, sizeof(ColdElfObjectView));
+    macho_views = (ColdMachOObjectView *)calloc((size_t)object_count, sizeof(ColdMachOObjectView));
     char error_buf[COLD_NAME_CAP];
-    memset(objects, 0, sizeof(objects));
-    memset(views, 0, sizeof(views));
-    memset(macho_views, 0, sizeof(macho_views));
     error_buf[0] = '\0';
+    if (!objects || !views || !macho_views) {
+        fprintf(stderr, "[cheng_cold] provider-archive-pack allocation failed\n");
+        goto done;
+    }
     for (int32_t oi = 0; oi < object_count; oi++) {
         objects[oi] = source_open(object_paths[oi]);
         if (objects[oi].len <= 0) {
-            for (int32_t ci = 0; ci <= oi; ci++) {
-                if (objects[ci].len > 0) munmap((void *)objects[ci].ptr, (size_t)objects[ci].len);
-            }
             cold_write_provider_archive_pack_report(report_path, false, target, object_paths[oi], out_path,
                                                     export_symbol, 0, 0, 0, "object open failed");
             fprintf(stderr, "[cheng_cold] provider object open failed: %s\n", object_paths[oi]);
-            return 2;
+            goto done;
         }
         bool object_ok = is_macho
             ? cold_read_macho_relocatable_view(objects[oi].ptr, objects[oi].len, target, &macho_views[oi])
             : cold_read_elf64_relocatable_view(objects[oi].ptr, objects[oi].len, target, &views[oi]);
         if (!object_ok) {
             const char *err = cold_provider_object_read_error(objects[oi], target);
-            for (int32_t ci = 0; ci <= oi; ci++) {
-                if (objects[ci].len > 0) munmap((void *)objects[ci].ptr, (size_t)objects[ci].len);
-            }
             cold_write_provider_archive_pack_report(report_path, false, target, object_paths[oi], out_path,
                                                     export_symbol, 0, 0, 0, err);
             fprintf(stderr, "[cheng_cold] %s: %s\n", err, object_paths[oi]);
-            return 2;
+            goto done;
         }
     }
+    ColdNameIndex export_names;
+    if (!cold_name_index_init(&export_names, export_count)) {
+        fprintf(stderr, "[cheng_cold] provider-archive-pack allocation failed\n");
+        goto done;
+    }
     for (int32_t ei = 0; ei < export_count; ei++) {
         const char *name = export_symbols[ei];
-        for (int32_t prev = 0; prev < ei; prev++) {
-            if (strcmp(export_symbols[prev], name) == 0) {
-                for (int32_t oi = 0; oi < object_count; oi++) {
-                    if (objects[oi].len > 0) munmap((void *)objects[oi].ptr, (size_t)objects[oi].len);
-                }
-                cold_provider_error_set_name(error_buf, sizeof(error_buf),
-                                             "duplicate provider export", name);
-                cold_write_provider_archive_pack_report(report_path, false, target, object_path, out_path,
-                                                        name, 0, 0, 0, error_buf);
-                fprintf(stderr, "[cheng_cold] duplicate provider export: %s\n", name);
-                return 2;
-            }
+        Span name_span = {(const uint8_t *)name, (int32_t)strlen(name)};
+        if (cold_name_index_insert(&export_names, name_span, ei,
+                                   cold_cstr_array_key, (void *)export_symbols) >= 0) {
+            cold_name_index_free(&export_names);
+            cold_provider_error_set_name(error_buf, sizeof(error_buf),
+                                         "duplicate provider export", name);
+            cold_write_provider_archive_pack_report(report_path, false, target, object_path, out_path,
+                                                    name, 0, 0, 0, error_buf);
+            fprintf(stderr, "[cheng_cold] duplicate provider export: %s\n", name);
+            goto done;
         }
         int32_t def_count = 0;
         for (int32_t oi = 0; oi < object_count; oi++) {
@@ -22608,19 +27744,19 @@ static int cold_cmd_provider_archive_pack(int argc, char **argv) {
             if (found) def_count++;
         }
         if (def_count != 1) {
-            for (int32_t oi = 0; oi < object_count; oi++) {
-                if (objects[oi].len > 0) munmap((void *)objects[oi].ptr, (size_t)objects[oi].len);
-            }
+            cold_name_index_free(&export_names);
             const char *err = def_count == 0 ? "provider export not defined" : "provider export ambiguous";
             cold_provider_error_set_name(error_buf, sizeof(error_buf), err, name);
             cold_write_provider_archive_pack_report(report_path, false, target, object_path, out_path,
                                                     name, 0, 0, 0, error_buf);
             fprintf(stderr, "[cheng_cold] %s: %s\n", err, name);
-            return 2;
+            goto done;
         }
     }
+    cold_name_index_free(&export_names);
     for (int32_t oi = 0; oi < object_count; oi++) {
         if (objects[oi].len > 0) munmap((void *)objects[oi].ptr, (size_t)objects[oi].len);
+        objects[oi].len = 0;
     }
     int32_t member_count = 0;
     uint64_t archive_hash = 0;
@@ -22632,14 +27768,14 @@ static int cold_cmd_provider_archive_pack(int argc, char **argv) {
         cold_write_provider_archive_pack_report(report_path, false, target, object_path, out_path,
                                                 export_symbol, 0, 0, 0, "provider archive write failed");
         fprintf(stderr, "[cheng_cold] provider archive write failed: %s\n", out_path);
-        return 2;
+        goto done;
     }
     if (member_count != object_count) {
         cold_write_provider_archive_pack_report(report_path, false, target, object_path, out_path,
                                                 export_symbol, 0, 0, 0,
                                                 "provider archive member count mismatch");
         fprintf(stderr, "[cheng_cold] provider archive member count mismatch: %s\n", out_path);
-        return 2;
+        goto done;
     }
     if (!cold_verify_provider_archive(out_path, target, &member_count, &archive_hash,
                                       verify_error, sizeof(verify_error))) {
@@ -22647,7 +27783,7 @@ static int cold_cmd_provider_archive_pack(int argc, char **argv) {
         cold_write_provider_archive_pack_report(report_path, false, target, object_path, out_path,
                                                 export_symbol, 0, 0, 0, err);
         fprintf(stderr, "[cheng_cold] %s: %s\n", err, out_path);
-        return 2;
+        goto done;
     }
     cold_write_provider_archive_pack_report(report_path, true, target, object_path, out_path,
                                             export_symbol, member_count, export_count, archive_hash, "");
@@ -22656,7 +27792,17 @@ static int cold_cmd_provider_archive_pack(int argc, char **argv) {
     printf("provider_export_count=%d\n", export_count);
     printf("provider_archive_hash=%016llx\n", (unsigned long long)archive_hash);
     printf("output=%s\n", out_path);
-    return 0;
+    rc = 0;
+
+done:
+    for (int32_t oi = 0; objects && oi < object_count; oi++) {
+        if (objects[oi].len > 0) munmap((void *)objects[oi].ptr, (size_t)objects[oi].len);
+    }
+    free(objects);
+    cold_provider_object_views_free(views, macho_views, object_count > 0 ? object_count : 0);
+    free(object_paths);
+    free(export_symbols);
+    return rc;
 }
 
 /* ================================================================
@@ -22694,6 +27840,9 @@ static int cold_cmd_provider_archive_pack(int argc, char **argv) {
 #define WASM_OP_I32_GT_S 0x4A
 #define WASM_OP_I32_LE_S 0x4C
 #define WASM_OP_I32_GE_S 0x4E
+#define WASM_OP_I32_LT_U 0x49
+#define WASM_OP_I32_GT_U 0x4B
+#define WASM_OP_I32_GE_U 0x4F
 #define WASM_OP_I32_ADD  0x6A
 #define WASM_OP_I32_SUB  0x6B
 #define WASM_OP_I32_MUL  0x6C
@@ -22770,6 +27919,12 @@ static int cold_cmd_provider_archive_pack(int argc, char **argv) {
 
 /* Misc prefix (0xFC) for memory ops */
 #define WASM_OP_MISC_PREFIX 0xFC
+#define WASM_OP_SIMD_PREFIX 0xFD
+#define WASM_MISC_MEMORY_COPY 10
+#define WASM_MISC_MEMORY_FILL 11
+#define WASM_SIMD_V128_LOAD 0x00
+#define WASM_SIMD_I8X16_EQ 0x23
+#define WASM_SIMD_I8X16_ALL_TRUE 0x63
 #define WASM_OP_MEMORY_GROW 0x40
 #define WASM_OP_MEMORY_SIZE 0x3F
 
@@ -22956,6 +28111,56 @@ static void wasm_op_memory_size(WasmCode *c) {
     wasm_emit1(c, 0); /* memory index (always 0 for single linear memory) */
 }
 
+/* Target features beyond the MVP, on by default; --wasm-features:mvp (or a
+ * list such as --wasm-features:bulk) falls back to the scalar loops. */
+static bool wasm_feature_bulk_memory = true;
+static bool wasm_feature_simd128 = true;
+
+static bool wasm_parse_features(const char *spec) {
+    if (!spec || !spec[0]) return true;
+    bool bulk = false, simd = false;
+    const char *p = spec;
+    while (*p) {
+        const char *e = strchr(p, ',');
+        size_t n = e ? (size_t)(e - p) : strlen(p);
+        if ((n == 3 && memcmp(p, "all", 3) == 0)) { bulk = true; simd = true; }
+        else if (n == 4 && memcmp(p, "bulk", 4) == 0) bulk = true;
+        else if (n == 4 && memcmp(p, "simd", 4) == 0) simd = true;
+        else if (!(n == 3 && memcmp(p, "mvp", 3) == 0)) return false;
+        p += n;
+        if (*p == ',') p++;
+    }
+    wasm_feature_bulk_memory = bulk;
+    wasm_feature_simd128 = simd;
+    return true;
+}
+
+/* Bulk memory: memory.copy (dst src n) / memory.fill (dst byte n), memory 0. */
+static void wasm_op_memory_copy(WasmCode *c) {
+    wasm_emit1(c, WASM_OP_MISC_PREFIX);
+    wasm_emit_leb128_u(c, WASM_MISC_MEMORY_COPY);
+    wasm_emit1(c, 0);
+    wasm_emit1(c, 0);
+}
+
+static void wasm_op_memory_fill(WasmCode *c) {
+    wasm_emit1(c, WASM_OP_MISC_PREFIX);
+    wasm_emit_leb128_u(c, WASM_MISC_MEMORY_FILL);
+    wasm_emit1(c, 0);
+}
+
+/* SIMD128: 0xFD-prefixed opcodes with a LEB128 sub-opcode. */
+static void wasm_op_simd(WasmCode *c, uint32_t op) {
+    wasm_emit1(c, WASM_OP_SIMD_PREFIX);
+    wasm_emit_leb128_u(c, op);
+}
+
+static void wasm_op_v128_load(WasmCode *c, uint32_t offset) {
+    wasm_op_simd(c, WASM_SIMD_V128_LOAD);
+    wasm_emit_leb128_u(c, 0); /* align 1: string data is byte aligned */
+    wasm_emit_leb128_u(c, offset);
+}
+
 /* String literal data table collected during codegen */
 typedef struct WasmStrData {
     uint8_t *buf;
@@ -22999,39 +28204,318 @@ static int32_t wasm_strdata_add(WasmStrData *s, Span sp) {
     return off;
 }
 
-/* Emit WASM bytecode for bump allocator: allocate `bytes` from bump heap.
- * Bump pointer is stored at linear memory address 0 (4 bytes, i32).
- * Uses temporary local tmp_local during emission.
- * Result: ptr on stack. */
-static void wasm_emit_alloc(WasmCode *wasm, int32_t tmp_local, int32_t bytes) {
-    /* Load bump pointer from address 0 */
-    wasm_op_i32_const(wasm, 0);
-    wasm_emit1(wasm, WASM_OP_I32_LOAD);
-    wasm_emit_leb128_u(wasm, 2);
-    wasm_emit_leb128_u(wasm, 0);
-    /* tee to tmp_local */
-    wasm_op_local_tee(wasm, (uint32_t)tmp_local);
-    /* add bytes */
-    wasm_op_i32_const(wasm, bytes);
-    wasm_emit1(wasm, WASM_OP_I32_ADD);
-    /* store new bump */
-    wasm_op_i32_const(wasm, 0);
-    wasm_emit1(wasm, WASM_OP_I32_STORE);
-    wasm_emit_leb128_u(wasm, 2);
-    wasm_emit_leb128_u(wasm, 0);
-    /* Check if we need to grow memory (if new bump > current page count * 65536) */
-    /* For simplicity, just leave the ptr on stack (tmp_local has it) */
-    wasm_op_local_get(wasm, (uint32_t)tmp_local);
-}
-
-/* Emit a byte-copy loop for WASM: copy `count` bytes from `src` to `dst`.
+/* WASM heap: a size-class allocator emitted as two internal functions that
+ * follow every defined function in the module (cheng_heap_alloc(i32)->i32 and
+ * cheng_heap_free(i32)).  State lives below the string-literal data at 4096:
+ *   [16] chunk cursor   [20] chunk end   [24 + 4k] free list of class k
+ *   [WASM_HEAP_LARGE_HEAD] free list of page-granular large blocks
+ * Class k blocks are (16 << k) bytes carved from 64 KB chunks; memory.grow
+ * runs only when the current chunk is exhausted or for a large block.  Each
+ * block has an 8-byte header [class][next|pages]; callers get block + 8.
+ * Recycled blocks are zeroed so callers still see fresh-page semantics. */
+#define WASM_HEAP_CURSOR      16
+#define WASM_HEAP_END         20
+#define WASM_HEAP_HEADS       24
+#define WASM_HEAP_CLASSES     12      /* 16 B .. 32 KB */
+#define WASM_HEAP_MAX_CLASS   (16 << (WASM_HEAP_CLASSES - 1))
+#define WASM_HEAP_LARGE_HEAD  (WASM_HEAP_HEADS + 4 * WASM_HEAP_CLASSES)
+#define WASM_HEAP_STATE_END   (WASM_HEAP_LARGE_HEAD + 4)
+#define WASM_HEAP_LARGE_CLASS 255
+#define WASM_NUM_STR_ALLOC    64      /* header + sign + 20 digits, rounded */
+
+static int32_t wasm_heap_alloc_idx = -1;
+static int32_t wasm_heap_free_idx = -1;
+
+/* Byte count on stack -> heap pointer on stack. */
+static void wasm_emit_heap_alloc(WasmCode *wasm) {
+    if (wasm_heap_alloc_idx < 0) die("cold wasm heap allocator index unset");
+    wasm_op_call(wasm, (uint32_t)wasm_heap_alloc_idx);
+}
+
+static void wasm_emit_block_loop(WasmCode *c) {
+    wasm_emit1(c, WASM_OP_BLOCK);
+    wasm_emit1(c, WASM_BLOCK_TYPE_EMPTY);
+    wasm_emit1(c, WASM_OP_LOOP);
+    wasm_emit1(c, WASM_BLOCK_TYPE_EMPTY);
+}
+
+/* memory.grow with the page count on stack; traps on failure and leaves the
+   base address of the new pages in local `dst`. */
+static void wasm_emit_heap_grow(WasmCode *c, uint32_t dst) {
+    wasm_op_memory_grow(c);
+    wasm_op_local_tee(c, dst);
+    wasm_op_i32_const(c, -1);
+    wasm_emit1(c, WASM_OP_I32_EQ);
+    wasm_emit1(c, WASM_OP_IF);
+    wasm_emit1(c, WASM_BLOCK_TYPE_EMPTY);
+    wasm_emit1(c, WASM_OP_UNREACHABLE);
+    wasm_emit1(c, WASM_OP_END);
+    wasm_op_local_get(c, dst);
+    wasm_op_i32_const(c, 16);
+    wasm_emit1(c, WASM_OP_I32_SHL);
+    wasm_op_local_set(c, dst);
+}
+
+/* Zero a recycled block from just past its header up to byte `end` (a
+   local holding an offset from the block), so reuse reads like fresh pages.
+   The word loop may run up to 3 bytes past `end`; blocks are 16-byte or
+   page granular, so that stays inside the block. */
+static void wasm_emit_heap_zero_payload(WasmCode *c, uint32_t blk, uint32_t end, uint32_t tmp) {
+    if (wasm_feature_bulk_memory) {
+        wasm_op_local_get(c, blk);
+        wasm_op_i32_const(c, 8);
+        wasm_emit1(c, WASM_OP_I32_ADD);
+        wasm_op_i32_const(c, 0);
+        wasm_op_local_get(c, end);
+        wasm_op_i32_const(c, 8);
+        wasm_emit1(c, WASM_OP_I32_SUB);
+        wasm_op_memory_fill(c);
+        return;
+    }
+    wasm_op_i32_const(c, 8);
+    wasm_op_local_set(c, tmp);
+    wasm_emit_block_loop(c);
+    wasm_op_local_get(c, tmp);
+    wasm_op_local_get(c, end);
+    wasm_emit1(c, WASM_OP_I32_GE_U);
+    wasm_op_br_if(c, 1);
+    wasm_op_local_get(c, blk);
+    wasm_op_local_get(c, tmp);
+    wasm_emit1(c, WASM_OP_I32_ADD);
+    wasm_op_i32_const(c, 0);
+    wasm_op_i32_store(c, 2, 0);
+    wasm_op_local_get(c, tmp);
+    wasm_op_i32_const(c, 4);
+    wasm_emit1(c, WASM_OP_I32_ADD);
+    wasm_op_local_set(c, tmp);
+    wasm_op_br(c, 0);
+    wasm_emit1(c, WASM_OP_END);
+    wasm_emit1(c, WASM_OP_END);
+}
+
+/* Body of cheng_heap_alloc(size): locals 1=need 2=class_size|pages 3=class
+   4=block 5=scratch. */
+static void wasm_emit_heap_alloc_func(WasmCode *c) {
+    enum { SIZE = 0, NEED = 1, CSZ = 2, K = 3, BLK = 4, TMP = 5 };
+    wasm_emit_leb128_u(c, 1);              /* one local group */
+    wasm_emit_leb128_u(c, 5);
+    wasm_emit1(c, WASM_TYPE_I32);
+    wasm_op_local_get(c, SIZE);
+    wasm_op_i32_const(c, 8);
+    wasm_emit1(c, WASM_OP_I32_ADD);
+    wasm_op_local_set(c, NEED);
+
+    /* Large block: first fit on the large list, else grow whole pages. */
+    wasm_op_local_get(c, NEED);
+    wasm_op_i32_const(c, WASM_HEAP_MAX_CLASS);
+    wasm_emit1(c, WASM_OP_I32_GT_U);
+    wasm_emit1(c, WASM_OP_IF);
+    wasm_emit1(c, WASM_BLOCK_TYPE_EMPTY);
+    wasm_op_local_get(c, NEED);
+    wasm_op_i32_const(c, 65535);
+    wasm_emit1(c, WASM_OP_I32_ADD);
+    wasm_op_i32_const(c, 16);
+    wasm_emit1(c, WASM_OP_I32_SHR_U);
+    wasm_op_local_set(c, CSZ);
+    wasm_op_i32_const(c, WASM_HEAP_LARGE_HEAD);
+    wasm_op_local_tee(c, TMP);             /* TMP = address of the link */
+    wasm_op_i32_load(c, 2, 0);
+    wasm_op_local_set(c, BLK);
+    wasm_emit_block_loop(c);
+    wasm_op_local_get(c, BLK);
+    wasm_emit1(c, WASM_OP_I32_EQZ);
+    wasm_op_br_if(c, 1);
+    wasm_op_local_get(c, BLK);
+    wasm_op_i32_load(c, 2, 4);
+    wasm_op_local_get(c, CSZ);
+    wasm_emit1(c, WASM_OP_I32_GE_U);
+    wasm_emit1(c, WASM_OP_IF);
+    wasm_emit1(c, WASM_BLOCK_TYPE_EMPTY);
+    wasm_op_local_get(c, TMP);
+    wasm_op_local_get(c, BLK);
+    wasm_op_i32_load(c, 2, 8);
+    wasm_op_i32_store(c, 2, 0);
+    /* The first payload word still holds the free-list link. */
+    wasm_emit_heap_zero_payload(c, BLK, NEED, TMP);
+    wasm_op_local_get(c, BLK);
+    wasm_op_i32_const(c, 8);
+    wasm_emit1(c, WASM_OP_I32_ADD);
+    wasm_emit1(c, WASM_OP_RETURN);
+    wasm_emit1(c, WASM_OP_END);
+    wasm_op_local_get(c, BLK);
+    wasm_op_i32_const(c, 8);
+    wasm_emit1(c, WASM_OP_I32_ADD);
+    wasm_op_local_set(c, TMP);
+    wasm_op_local_get(c, BLK);
+    wasm_op_i32_load(c, 2, 8);
+    wasm_op_local_set(c, BLK);
+    wasm_op_br(c, 0);
+    wasm_emit1(c, WASM_OP_END);            /* loop */
+    wasm_emit1(c, WASM_OP_END);            /* block */
+    wasm_op_local_get(c, CSZ);
+    wasm_emit_heap_grow(c, BLK);
+    wasm_op_local_get(c, BLK);
+    wasm_op_i32_const(c, WASM_HEAP_LARGE_CLASS);
+    wasm_op_i32_store(c, 2, 0);
+    wasm_op_local_get(c, BLK);
+    wasm_op_local_get(c, CSZ);
+    wasm_op_i32_store(c, 2, 4);
+    wasm_op_local_get(c, BLK);
+    wasm_op_i32_const(c, 8);
+    wasm_emit1(c, WASM_OP_I32_ADD);
+    wasm_emit1(c, WASM_OP_RETURN);
+    wasm_emit1(c, WASM_OP_END);
+
+    /* Size class: smallest 16 << k >= need. */
+    wasm_op_i32_const(c, 16);
+    wasm_op_local_set(c, CSZ);
+    wasm_emit_block_loop(c);
+    wasm_op_local_get(c, CSZ);
+    wasm_op_local_get(c, NEED);
+    wasm_emit1(c, WASM_OP_I32_GE_U);
+    wasm_op_br_if(c, 1);
+    wasm_op_local_get(c, CSZ);
+    wasm_op_i32_const(c, 1);
+    wasm_emit1(c, WASM_OP_I32_SHL);
+    wasm_op_local_set(c, CSZ);
+    wasm_op_local_get(c, K);
+    wasm_op_i32_const(c, 1);
+    wasm_emit1(c, WASM_OP_I32_ADD);
+    wasm_op_local_set(c, K);
+    wasm_op_br(c, 0);
+    wasm_emit1(c, WASM_OP_END);
+    wasm_emit1(c, WASM_OP_END);
+
+    /* Pop the class free list; recycled blocks are zeroed past the header. */
+    wasm_op_local_get(c, K);
+    wasm_op_i32_const(c, 2);
+    wasm_emit1(c, WASM_OP_I32_SHL);
+    wasm_op_i32_load(c, 2, WASM_HEAP_HEADS);
+    wasm_op_local_tee(c, BLK);
+    wasm_emit1(c, WASM_OP_IF);
+    wasm_emit1(c, WASM_BLOCK_TYPE_EMPTY);
+    wasm_op_local_get(c, K);
+    wasm_op_i32_const(c, 2);
+    wasm_emit1(c, WASM_OP_I32_SHL);
+    wasm_op_local_get(c, BLK);
+    wasm_op_i32_load(c, 2, 4);
+    wasm_op_i32_store(c, 2, WASM_HEAP_HEADS);
+    wasm_emit_heap_zero_payload(c, BLK, CSZ, TMP);
+    wasm_emit1(c, WASM_OP_ELSE);
+    /* Bump from the current chunk; grow one fresh 64 KB chunk when it runs out. */
+    wasm_op_i32_const(c, WASM_HEAP_CURSOR);
+    wasm_op_i32_load(c, 2, 0);
+    wasm_op_local_tee(c, BLK);
+    wasm_op_local_get(c, CSZ);
+    wasm_emit1(c, WASM_OP_I32_ADD);
+    wasm_op_i32_const(c, WASM_HEAP_END);
+    wasm_op_i32_load(c, 2, 0);
+    wasm_emit1(c, WASM_OP_I32_GT_U);
+    wasm_emit1(c, WASM_OP_IF);
+    wasm_emit1(c, WASM_BLOCK_TYPE_EMPTY);
+    wasm_op_i32_const(c, 1);
+    wasm_emit_heap_grow(c, BLK);
+    wasm_op_i32_const(c, WASM_HEAP_END);
+    wasm_op_local_get(c, BLK);
+    wasm_op_i32_const(c, 65536);
+    wasm_emit1(c, WASM_OP_I32_ADD);
+    wasm_op_i32_store(c, 2, 0);
+    wasm_emit1(c, WASM_OP_END);
+    wasm_op_i32_const(c, WASM_HEAP_CURSOR);
+    wasm_op_local_get(c, BLK);
+    wasm_op_local_get(c, CSZ);
+    wasm_emit1(c, WASM_OP_I32_ADD);
+    wasm_op_i32_store(c, 2, 0);
+    wasm_emit1(c, WASM_OP_END);
+
+    wasm_op_local_get(c, BLK);
+    wasm_op_local_get(c, K);
+    wasm_op_i32_store(c, 2, 0);
+    wasm_op_local_get(c, BLK);
+    wasm_op_i32_const(c, 8);
+    wasm_emit1(c, WASM_OP_I32_ADD);
+    wasm_emit1(c, WASM_OP_END);
+}
+
+/* Body of cheng_heap_free(ptr): locals 1=block 2=class.  Heap blocks always
+   come from grown pages, so pointers into page 0 (null, string literals)
+   and headers that are not a heap class are ignored. */
+static void wasm_emit_heap_free_func(WasmCode *c) {
+    enum { PTR = 0, BLK = 1, K = 2 };
+    wasm_emit_leb128_u(c, 1);
+    wasm_emit_leb128_u(c, 2);
+    wasm_emit1(c, WASM_TYPE_I32);
+    wasm_op_local_get(c, PTR);
+    wasm_op_i32_const(c, 65536);
+    wasm_emit1(c, WASM_OP_I32_LT_U);
+    wasm_emit1(c, WASM_OP_IF);
+    wasm_emit1(c, WASM_BLOCK_TYPE_EMPTY);
+    wasm_emit1(c, WASM_OP_RETURN);
+    wasm_emit1(c, WASM_OP_END);
+    wasm_op_local_get(c, PTR);
+    wasm_op_i32_const(c, 8);
+    wasm_emit1(c, WASM_OP_I32_SUB);
+    wasm_op_local_tee(c, BLK);
+    wasm_op_i32_load(c, 2, 0);
+    wasm_op_local_tee(c, K);
+    wasm_op_i32_const(c, WASM_HEAP_LARGE_CLASS);
+    wasm_emit1(c, WASM_OP_I32_EQ);
+    wasm_emit1(c, WASM_OP_IF);
+    wasm_emit1(c, WASM_BLOCK_TYPE_EMPTY);
+    wasm_op_local_get(c, BLK);
+    wasm_op_i32_const(c, WASM_HEAP_LARGE_HEAD);
+    wasm_op_i32_load(c, 2, 0);
+    wasm_op_i32_store(c, 2, 8);
+    wasm_op_i32_const(c, WASM_HEAP_LARGE_HEAD);
+    wasm_op_local_get(c, BLK);
+    wasm_op_i32_store(c, 2, 0);
+    wasm_emit1(c, WASM_OP_RETURN);
+    wasm_emit1(c, WASM_OP_END);
+    wasm_op_local_get(c, K);
+    wasm_op_i32_const(c, WASM_HEAP_CLASSES);
+    wasm_emit1(c, WASM_OP_I32_GE_U);
+    wasm_emit1(c, WASM_OP_IF);
+    wasm_emit1(c, WASM_BLOCK_TYPE_EMPTY);
+    wasm_emit1(c, WASM_OP_RETURN);
+    wasm_emit1(c, WASM_OP_END);
+    wasm_op_local_get(c, BLK);
+    wasm_op_local_get(c, K);
+    wasm_op_i32_const(c, 2);
+    wasm_emit1(c, WASM_OP_I32_SHL);
+    wasm_op_i32_load(c, 2, WASM_HEAP_HEADS);
+    wasm_op_i32_store(c, 2, 4);
+    wasm_op_local_get(c, K);
+    wasm_op_i32_const(c, 2);
+    wasm_emit1(c, WASM_OP_I32_SHL);
+    wasm_op_local_get(c, BLK);
+    wasm_op_i32_store(c, 2, WASM_HEAP_HEADS);
+    wasm_emit1(c, WASM_OP_END);
+}
+
+/* Emit a byte copy for WASM: copy `count` bytes from `src` to `dst`.
  * Uses 3 scratch locals: [scr0]=count, [scr1]=src, [scr2]=dst, [scr3]=loop_i.
- * The loop counter is initially zeroed by this helper.
  * count, src, dst must be in the 4 scratch locals before calling.
- * After return, scratch locals are: scr0=count, scr1=src, scr2=dst, scr3=count. */
+ * After return, scratch locals are: scr0=count, scr1=src, scr2=dst, scr3=count.
+ * With bulk memory this is one memory.copy (memmove semantics, guarded so a
+ * non-positive count stays a no-op like the loop); otherwise a byte loop. */
 static void wasm_emit_memcpy_loop(WasmCode *wasm, int32_t scr_count,
                                    int32_t scr_src, int32_t scr_dst,
                                    int32_t scr_i) {
+    if (wasm_feature_bulk_memory) {
+        wasm_op_local_get(wasm, (uint32_t)scr_count);
+        wasm_op_i32_const(wasm, 0);
+        wasm_emit1(wasm, WASM_OP_I32_GT_S);
+        wasm_emit1(wasm, WASM_OP_IF);
+        wasm_emit1(wasm, WASM_BLOCK_TYPE_EMPTY);
+        wasm_op_local_get(wasm, (uint32_t)scr_dst);
+        wasm_op_local_get(wasm, (uint32_t)scr_src);
+        wasm_op_local_get(wasm, (uint32_t)scr_count);
+        wasm_op_memory_copy(wasm);
+        wasm_emit1(wasm, WASM_OP_END);
+        wasm_op_local_get(wasm, (uint32_t)scr_count);
+        wasm_op_local_set(wasm, (uint32_t)scr_i);
+        return;
+    }
     /* Set loop counter = 0 */
     wasm_op_i32_const(wasm, 0);
     wasm_op_local_set(wasm, (uint32_t)scr_i);
@@ -23581,6 +29065,43 @@ static void wasm_codegen_op(WasmCode *wasm, BodyIR *body, Symbols *symbols,
         /* Inner block with result i32 for break-with-value */
         wasm_emit1(wasm, WASM_OP_BLOCK);
         wasm_emit1(wasm, WASM_TYPE_I32);
+        if (wasm_feature_simd128) {
+            /* 16 bytes per step while i + 16 <= len; a lane mismatch breaks
+               to the inner block with 0, the tail falls to the byte loop. */
+            wasm_emit1(wasm, WASM_OP_BLOCK);
+            wasm_emit1(wasm, WASM_BLOCK_TYPE_EMPTY);
+            wasm_emit1(wasm, WASM_OP_LOOP);
+            wasm_emit1(wasm, WASM_BLOCK_TYPE_EMPTY);
+            wasm_op_local_get(wasm, (uint32_t)scr3);
+            wasm_op_i32_const(wasm, 16);
+            wasm_emit1(wasm, WASM_OP_I32_ADD);
+            wasm_op_local_get(wasm, (uint32_t)scr2);
+            wasm_emit1(wasm, WASM_OP_I32_GT_S);
+            wasm_op_br_if(wasm, 1);
+            wasm_op_local_get(wasm, (uint32_t)scr0);
+            wasm_op_local_get(wasm, (uint32_t)scr3);
+            wasm_emit1(wasm, WASM_OP_I32_ADD);
+            wasm_op_v128_load(wasm, 0);
+            wasm_op_local_get(wasm, (uint32_t)scr1);
+            wasm_op_local_get(wasm, (uint32_t)scr3);
+            wasm_emit1(wasm, WASM_OP_I32_ADD);
+            wasm_op_v128_load(wasm, 0);
+            wasm_op_simd(wasm, WASM_SIMD_I8X16_EQ);
+            wasm_op_simd(wasm, WASM_SIMD_I8X16_ALL_TRUE);
+            wasm_emit1(wasm, WASM_OP_I32_EQZ);
+            wasm_emit1(wasm, WASM_OP_IF);
+            wasm_emit1(wasm, WASM_BLOCK_TYPE_EMPTY);
+            wasm_op_i32_const(wasm, 0);
+            wasm_op_br(wasm, 3);  /* if(0) loop(1) block(2) inner block(3) */
+            wasm_emit1(wasm, WASM_OP_END);
+            wasm_op_local_get(wasm, (uint32_t)scr3);
+            wasm_op_i32_const(wasm, 16);
+            wasm_emit1(wasm, WASM_OP_I32_ADD);
+            wasm_op_local_set(wasm, (uint32_t)scr3);
+            wasm_op_br(wasm, 0);
+            wasm_emit1(wasm, WASM_OP_END);  /* end loop */
+            wasm_emit1(wasm, WASM_OP_END);  /* end block */
+        }
         wasm_emit1(wasm, WASM_OP_LOOP);
         wasm_emit1(wasm, WASM_BLOCK_TYPE_EMPTY);
         /* if i >= len: br 2 (skip if+loop) to inner block with 1 */
@@ -23689,21 +29210,17 @@ static void wasm_codegen_op(WasmCode *wasm, BodyIR *body, Symbols *symbols,
         /* max(0, slice_len) - slice_len is always >=0 here */
         wasm_emit1(wasm, WASM_OP_END);
         wasm_op_local_set(wasm, (uint32_t)SCR_SLEN); /* final result_len in SCR_SLEN */
-        /* Allocate via memory.grow: pages = (result_len + 8 + 65535) >> 16 */
+        /* Allocate result_len + 8 bytes from the wasm heap */
         wasm_op_local_get(wasm, (uint32_t)SCR_SLEN);
-        wasm_op_i32_const(wasm, 8 + 65535);
+        wasm_op_i32_const(wasm, 8);
         wasm_emit1(wasm, WASM_OP_I32_ADD);
-        wasm_op_i32_const(wasm, 16);
-        wasm_emit1(wasm, WASM_OP_I32_SHR_U);
-        wasm_op_memory_grow(wasm);
-        wasm_op_i32_const(wasm, 16);
-        wasm_emit1(wasm, WASM_OP_I32_SHL);
+        wasm_emit_heap_alloc(wasm);
         wasm_op_local_tee(wasm, (uint32_t)tmp_local); /* ptr in tmp_local */
         /* Write header: data_ptr = ptr + 8 at [ptr + 0] */
         wasm_op_local_get(wasm, (uint32_t)tmp_local);
+        wasm_op_local_get(wasm, (uint32_t)tmp_local);
         wasm_op_i32_const(wasm, 8);
         wasm_emit1(wasm, WASM_OP_I32_ADD);
-        wasm_op_local_get(wasm, (uint32_t)tmp_local);
         wasm_emit1(wasm, WASM_OP_I32_STORE);
         wasm_emit_leb128_u(wasm, 2); wasm_emit_leb128_u(wasm, 0);
         /* Write header: len = result_len at [ptr + 4] */
@@ -23761,21 +29278,17 @@ static void wasm_codegen_op(WasmCode *wasm, BodyIR *body, Symbols *symbols,
         wasm_op_local_get(wasm, (uint32_t)SCR_LEN_B);
         wasm_emit1(wasm, WASM_OP_I32_ADD);
         wasm_op_local_set(wasm, (uint32_t)SCR_TOTAL);
-        /* Allocate via memory.grow: pages = (total + 8 + 65535) >> 16 */
+        /* Allocate total + 8 bytes from the wasm heap */
         wasm_op_local_get(wasm, (uint32_t)SCR_TOTAL);
-        wasm_op_i32_const(wasm, 8 + 65535);
+        wasm_op_i32_const(wasm, 8);
         wasm_emit1(wasm, WASM_OP_I32_ADD);
-        wasm_op_i32_const(wasm, 16);
-        wasm_emit1(wasm, WASM_OP_I32_SHR_U);
-        wasm_op_memory_grow(wasm);
-        wasm_op_i32_const(wasm, 16);
-        wasm_emit1(wasm, WASM_OP_I32_SHL);
+        wasm_emit_heap_alloc(wasm);
         wasm_op_local_tee(wasm, (uint32_t)tmp_local);
         /* Write header: data_ptr = ptr + 8 at [ptr + 0] */
         wasm_op_local_get(wasm, (uint32_t)tmp_local);
+        wasm_op_local_get(wasm, (uint32_t)tmp_local);
         wasm_op_i32_const(wasm, 8);
         wasm_emit1(wasm, WASM_OP_I32_ADD);
-        wasm_op_local_get(wasm, (uint32_t)tmp_local);
         wasm_emit1(wasm, WASM_OP_I32_STORE);
         wasm_emit_leb128_u(wasm, 2); wasm_emit_leb128_u(wasm, 0);
         /* Write header: len = total at [ptr + 4] */
@@ -24033,18 +29546,20 @@ static void wasm_codegen_op(WasmCode *wasm, BodyIR *body, Symbols *symbols,
     }
     /* Heap alloc/free */
     case BODY_OP_HEAP_ALLOC:
-        /* Allocate memory using memory.grow */
-        wasm_op_i32_const(wasm, (int32_t)a);
-        if (c > 0) wasm_op_i32_const(wasm, (int32_t)a);
-        wasm_op_memory_grow(wasm);
-        /* memory.grow returns previous page count, new pages are zeroed */
-        wasm_op_i32_const(wasm, 16);
-        wasm_emit1(wasm, WASM_OP_I32_SHL);
+        /* a=size slot (I64 slots are i32 locals in wasm), dst=ptr; memory is zeroed */
+        la = wasm_local_for_slot(body, a);
+        wasm_op_local_get(wasm, (uint32_t)la);
+        wasm_emit_heap_alloc(wasm);
         ld = wasm_local_for_slot(body, dst);
         wasm_op_local_set(wasm, (uint32_t)ld);
         break;
     case BODY_OP_HEAP_FREE:
-        /* No-op in WASM (no explicit free in linear memory) */
+        /* a=ptr slot, b=size slot (size class is read from the block header) */
+        la = wasm_local_for_slot(body, a);
+        wasm_op_local_get(wasm, (uint32_t)la);
+        wasm_op_call(wasm, (uint32_t)wasm_heap_free_idx);
+        wasm_op_i32_const(wasm, 0);
+        wasm_op_local_set(wasm, (uint32_t)wasm_local_for_slot(body, dst));
         break;
     /* Bytes ops */
     case BODY_OP_BYTES_ALLOC: {
@@ -24130,17 +29645,13 @@ static void wasm_codegen_op(WasmCode *wasm, BodyIR *body, Symbols *symbols,
         /* initial_count = c, capacity = max(c, 4) */
         wasm_op_i32_const(wasm, c > 4 ? (int32_t)c : 4);
         wasm_op_local_set(wasm, (uint32_t)SCR_CAP);
-        /* Allocate: pages = (8 + capacity*4 + 65535) >> 16 */
+        /* Allocate 8 + capacity*4 bytes from the wasm heap */
         wasm_op_local_get(wasm, (uint32_t)SCR_CAP);
         wasm_op_i32_const(wasm, 4);
         wasm_emit1(wasm, WASM_OP_I32_MUL);
-        wasm_op_i32_const(wasm, 8 + 65535);
+        wasm_op_i32_const(wasm, 8);
         wasm_emit1(wasm, WASM_OP_I32_ADD);
-        wasm_op_i32_const(wasm, 16);
-        wasm_emit1(wasm, WASM_OP_I32_SHR_U);
-        wasm_op_memory_grow(wasm);
-        wasm_op_i32_const(wasm, 16);
-        wasm_emit1(wasm, WASM_OP_I32_SHL);
+        wasm_emit_heap_alloc(wasm);
         wasm_op_local_tee(wasm, (uint32_t)tmp_local); /* ptr in tmp_local */
         /* Write count = c */
         wasm_op_i32_const(wasm, c);
@@ -24165,8 +29676,8 @@ static void wasm_codegen_op(WasmCode *wasm, BodyIR *body, Symbols *symbols,
             wasm_op_local_set(wasm, (uint32_t)SCR_TMP); /* SCR_TMP = dst */
             wasm_op_local_get(wasm, (uint32_t)la);
             wasm_op_local_set(wasm, (uint32_t)SCR_CNT); /* SCR_CNT = src */
-            wasm_op_i32_const(wasm, c);
-            wasm_op_local_set(wasm, (uint32_t)SCR_CAP); /* SCR_CAP = count */
+            wasm_op_i32_const(wasm, c * 4);
+            wasm_op_local_set(wasm, (uint32_t)SCR_CAP); /* SCR_CAP = byte count */
             /* byte copy: c*4 bytes */
             wasm_emit_memcpy_loop(wasm, SCR_CAP, SCR_CNT, SCR_TMP, SCR_I);
         }
@@ -24187,17 +29698,13 @@ static void wasm_codegen_op(WasmCode *wasm, BodyIR *body, Symbols *symbols,
         /* capacity = max(c, 4) */
         wasm_op_i32_const(wasm, c > 4 ? (int32_t)c : 4);
         wasm_op_local_set(wasm, (uint32_t)SCR_CAP);
-        /* Allocate: pages = (8 + capacity*b + 65535) >> 16 */
+        /* Allocate 8 + capacity*b bytes from the wasm heap */
         wasm_op_local_get(wasm, (uint32_t)SCR_CAP);
         wasm_op_i32_const(wasm, b);
         wasm_emit1(wasm, WASM_OP_I32_MUL);
-        wasm_op_i32_const(wasm, 8 + 65535);
+        wasm_op_i32_const(wasm, 8);
         wasm_emit1(wasm, WASM_OP_I32_ADD);
-        wasm_op_i32_const(wasm, 16);
-        wasm_emit1(wasm, WASM_OP_I32_SHR_U);
-        wasm_op_memory_grow(wasm);
-        wasm_op_i32_const(wasm, 16);
-        wasm_emit1(wasm, WASM_OP_I32_SHL);
+        wasm_emit_heap_alloc(wasm);
         wasm_op_local_tee(wasm, (uint32_t)tmp_local);
         /* Write count = c */
         wasm_op_i32_const(wasm, c);
@@ -24659,11 +30166,9 @@ static void wasm_codegen_op(WasmCode *wasm, BodyIR *body, Symbols *symbols,
         int32_t SCR_POS_IS = scr_base_is + 1;
         int32_t SCR_LEN_IS = scr_base_is + 2;
         int32_t SCR_DIGIT_IS = scr_base_is + 3;
-        /* Allocate 1 page for string via memory.grow */
-        wasm_op_i32_const(wasm, 1);
-        wasm_op_memory_grow(wasm);
-        wasm_op_i32_const(wasm, 16);
-        wasm_emit1(wasm, WASM_OP_I32_SHL);
+        /* Allocate the digit buffer from the wasm heap */
+        wasm_op_i32_const(wasm, WASM_NUM_STR_ALLOC);
+        wasm_emit_heap_alloc(wasm);
         wasm_op_local_tee(wasm, (uint32_t)tmp_local);
         /* Load value */
         wasm_op_local_get(wasm, (uint32_t)la);
@@ -24799,11 +30304,9 @@ static void wasm_codegen_op(WasmCode *wasm, BodyIR *body, Symbols *symbols,
         int32_t SCR_POS_64 = scr_base_i64 + 1;
         int32_t SCR_LEN_64 = scr_base_i64 + 2;
         int32_t SCR_DIGIT_64 = scr_base_i64 + 3;
-        /* Allocate 1 page for string */
-        wasm_op_i32_const(wasm, 1);
-        wasm_op_memory_grow(wasm);
-        wasm_op_i32_const(wasm, 16);
-        wasm_emit1(wasm, WASM_OP_I32_SHL);
+        /* Allocate the digit buffer from the wasm heap */
+        wasm_op_i32_const(wasm, WASM_NUM_STR_ALLOC);
+        wasm_emit_heap_alloc(wasm);
         wasm_op_local_tee(wasm, (uint32_t)tmp_local);
         /* Check if value == 0 */
         wasm_op_local_get(wasm, (uint32_t)la);
@@ -25057,21 +30560,17 @@ static void wasm_codegen_op(WasmCode *wasm, BodyIR *body, Symbols *symbols,
         wasm_emit1(wasm, WASM_OP_END); /* end loop */
         wasm_emit1(wasm, WASM_OP_END); /* end block */
 
-        /* Phase 2: allocate (total + 8) bytes via memory.grow */
+        /* Phase 2: allocate (total + 8) bytes from the wasm heap */
         wasm_op_local_get(wasm, (uint32_t)SCR_TOT);
-        wasm_op_i32_const(wasm, 8 + 65535);
+        wasm_op_i32_const(wasm, 8);
         wasm_emit1(wasm, WASM_OP_I32_ADD);
-        wasm_op_i32_const(wasm, 16);
-        wasm_emit1(wasm, WASM_OP_I32_SHR_U);
-        wasm_op_memory_grow(wasm);
-        wasm_op_i32_const(wasm, 16);
-        wasm_emit1(wasm, WASM_OP_I32_SHL);
+        wasm_emit_heap_alloc(wasm);
         wasm_op_local_tee(wasm, (uint32_t)tmp_local);
         /* Write header: data_ptr = ptr + 8 at [ptr + 0] */
         wasm_op_local_get(wasm, (uint32_t)tmp_local);
+        wasm_op_local_get(wasm, (uint32_t)tmp_local);
         wasm_op_i32_const(wasm, 8);
         wasm_emit1(wasm, WASM_OP_I32_ADD);
-        wasm_op_local_get(wasm, (uint32_t)tmp_local);
         wasm_emit1(wasm, WASM_OP_I32_STORE);
         wasm_emit_leb128_u(wasm, 2); wasm_emit_leb128_u(wasm, 0);
         /* Write header: len = total at [ptr + 4] */
@@ -25247,10 +30746,8 @@ static void wasm_codegen_op(WasmCode *wasm, BodyIR *body, Symbols *symbols,
     case BODY_OP_CWD_STR: {
         /* Return "/" string. Allocate 2-byte string with just '/' */
         ld = wasm_local_for_slot(body, dst);
-        wasm_op_i32_const(wasm, 1);
-        wasm_op_memory_grow(wasm);
         wasm_op_i32_const(wasm, 16);
-        wasm_emit1(wasm, WASM_OP_I32_SHL);
+        wasm_emit_heap_alloc(wasm);
         wasm_op_local_tee(wasm, (uint32_t)tmp_local);
         /* ptr[8] = '/' */
         wasm_op_local_get(wasm, (uint32_t)tmp_local);
@@ -25854,9 +31351,22 @@ static int wasm_emit_block_recursive(WasmCode *wasm, BodyIR *body, Symbols *symb
 }
 
 /* Generate WASM bytecode for a single function body */
+static void wasm_codegen_func_emit(WasmCode *wasm, BodyIR *body, Symbols *symbols,
+                                   FunctionPatchList *patches, int32_t func_idx,
+                                   int32_t *func_to_wasm_idx);
+
+/* Traced entry point: one "codegen" span per function body. */
 static void wasm_codegen_func(WasmCode *wasm, BodyIR *body, Symbols *symbols,
                               FunctionPatchList *patches, int32_t func_idx,
                               int32_t *func_to_wasm_idx) {
+    uint64_t trace_start = cold_trace_begin();
+    wasm_codegen_func_emit(wasm, body, symbols, patches, func_idx, func_to_wasm_idx);
+    cold_trace_end("codegen", body->debug_name, trace_start);
+}
+
+static void wasm_codegen_func_emit(WasmCode *wasm, BodyIR *body, Symbols *symbols,
+                                   FunctionPatchList *patches, int32_t func_idx,
+                                   int32_t *func_to_wasm_idx) {
     /* Emit function body (without size header - will be wrapped in code section) */
     /* 1. Local declarations */
     int32_t i32_cnt = wasm_count_declared_locals(body, WASM_TYPE_I32);
@@ -26010,7 +31520,7 @@ static bool wasm_write_object(const char *out_path, WasmCode *func_bodies,
     WasmCode ts;
     wasm_init(&ts, 4096);
     /* For wasm: type count = all function signatures */
-    wasm_emit_leb128_u(&ts, (uint32_t)func_count);
+    wasm_emit_leb128_u(&ts, (uint32_t)(func_count + 2));
     for (int32_t i = 0; i < func_count; i++) {
         wasm_emit1(&ts, 0x60); /* functype */
         FnDef *fn = &symbols->functions[i];
@@ -26030,6 +31540,13 @@ static bool wasm_write_object(const char *out_path, WasmCode *func_bodies,
             wasm_emit_leb128_u(&ts, 0);
         }
     }
+    /* Heap allocator types: alloc (i32)->i32 = func_count, free (i32)->() = func_count+1 */
+    wasm_emit1(&ts, 0x60);
+    wasm_emit_leb128_u(&ts, 1); wasm_emit1(&ts, WASM_TYPE_I32);
+    wasm_emit_leb128_u(&ts, 1); wasm_emit1(&ts, WASM_TYPE_I32);
+    wasm_emit1(&ts, 0x60);
+    wasm_emit_leb128_u(&ts, 1); wasm_emit1(&ts, WASM_TYPE_I32);
+    wasm_emit_leb128_u(&ts, 0);
 
     /* ---- Build IMPORT section ---- */
     WasmCode ims;
@@ -26075,7 +31592,7 @@ static bool wasm_write_object(const char *out_path, WasmCode *func_bodies,
         if (symbols->functions[i].is_external) continue;
         func_body_count++;
     }
-    wasm_emit_leb128_u(&fns, (uint32_t)func_body_count);
+    wasm_emit_leb128_u(&fns, (uint32_t)(func_body_count + 2));
     int32_t wasm_fn_idx = import_count; /* defined functions start after imports */
     for (int32_t i = 0; i < func_count; i++) {
         if (symbols->functions[i].is_external) continue;
@@ -26083,6 +31600,10 @@ static bool wasm_write_object(const char *out_path, WasmCode *func_bodies,
         func_to_wasm_idx[i] = wasm_fn_idx;
         wasm_fn_idx++;
     }
+    if (wasm_fn_idx != wasm_heap_alloc_idx || wasm_fn_idx + 1 != wasm_heap_free_idx)
+        die("cold wasm heap allocator index mismatch");
+    wasm_emit_leb128_u(&fns, (uint32_t)func_count);
+    wasm_emit_leb128_u(&fns, (uint32_t)(func_count + 1));
 
     /* ---- Build EXPORT section ---- */
     WasmCode exs;
@@ -26092,7 +31613,16 @@ static bool wasm_write_object(const char *out_path, WasmCode *func_bodies,
     for (int32_t ni = 0; ni < name_count; ni++) {
         if (ni < emit_count && func_offsets[ni] >= 0) export_count++;
     }
-    wasm_emit_leb128_u(&exs, (uint32_t)export_count);
+    /* The heap functions are exported so hosts can allocate in the module heap. */
+    wasm_emit_leb128_u(&exs, (uint32_t)(export_count + 2));
+    for (int32_t hi = 0; hi < 2; hi++) {
+        const char *hname = hi == 0 ? "cheng_heap_alloc" : "cheng_heap_free";
+        int32_t hlen = (int32_t)strlen(hname);
+        wasm_emit_leb128_u(&exs, (uint32_t)hlen);
+        for (int32_t ei = 0; ei < hlen; ei++) wasm_emit1(&exs, (uint8_t)hname[ei]);
+        wasm_emit1(&exs, 0x00);
+        wasm_emit_leb128_u(&exs, (uint32_t)(hi == 0 ? wasm_heap_alloc_idx : wasm_heap_free_idx));
+    }
     for (int32_t ni = 0; ni < name_count; ni++) {
         if (func_offsets[ni] < 0) continue;
         /* Export name */
@@ -26129,7 +31659,7 @@ static bool wasm_write_object(const char *out_path, WasmCode *func_bodies,
        out-of-bounds reads on func_bodies->buf and keep section counts matching. */
     WasmCode cs;
     wasm_init(&cs, 65536);
-    wasm_emit_leb128_u(&cs, (uint32_t)func_body_count);
+    wasm_emit_leb128_u(&cs, (uint32_t)(func_body_count + 2));
     for (int32_t i = 0; i < func_count; i++) {
         if (symbols->functions[i].is_external) continue;
         int32_t body_off = symbol_offset[i];
@@ -26152,6 +31682,15 @@ static bool wasm_write_object(const char *out_path, WasmCode *func_bodies,
         for (int32_t bi = 0; bi < body_sz; bi++)
             wasm_emit1(&cs, func_bodies->buf[body_off + bi]);
     }
+    for (int32_t hi = 0; hi < 2; hi++) {
+        WasmCode hb;
+        wasm_init(&hb, 1024);
+        if (hi == 0) wasm_emit_heap_alloc_func(&hb);
+        else wasm_emit_heap_free_func(&hb);
+        wasm_emit_leb128_u(&cs, (uint32_t)hb.len);
+        for (int32_t bi = 0; bi < hb.len; bi++) wasm_emit1(&cs, hb.buf[bi]);
+        free(hb.buf);
+    }
 
     /* ---- Write magic + version + sections ---- */
     /* Magic: \0asm (0x00 0x61 0x73 0x6D) */
@@ -26188,10 +31727,10 @@ static bool wasm_write_object(const char *out_path, WasmCode *func_bodies,
     wasm_emit_leb128_u(&mod, (uint32_t)cs.len);
     for (int32_t i = 0; i < cs.len; i++) wasm_emit1(&mod, cs.buf[i]);
 
-    /* Data section: always init bump pointer; add string literal data if present.
-     * Linear memory[0..3] holds the bump allocator pointer. Modules that allocate
-     * will read [0]; zero-initialized memory gives address 0 which overlaps the
-     * pointer itself, so we pre-initialize [0] = 16. */
+    /* Data section: always init bump pointer and heap state; add string literal
+     * data if present.  Linear memory[0..3] holds the legacy bump pointer
+     * (pre-initialized to 16); [16..WASM_HEAP_STATE_END) is the heap allocator
+     * state, explicitly zeroed so an imported memory need not be fresh. */
     {
         int seg_count = 1;
         if (wasm_global_strdata && wasm_global_strdata->len > 0) seg_count++;
@@ -26199,13 +31738,14 @@ static bool wasm_write_object(const char *out_path, WasmCode *func_bodies,
         wasm_init(&ds, 128 + (wasm_global_strdata ? wasm_global_strdata->len : 0));
         wasm_emit_leb128_u(&ds, (uint32_t)seg_count);
 
-        /* Segment 1: bump pointer at address 0, initialized to 16 */
+        /* Segment 1: bump pointer at address 0 = 16, then zeroed heap state */
         wasm_emit1(&ds, 0x00); /* 0x00 flag = active segment, memory index 0 */
         wasm_emit1(&ds, 0x41); /* i32.const */
         wasm_emit_leb128_u(&ds, 0);
         wasm_emit1(&ds, 0x0B); /* end */
-        wasm_emit_leb128_u(&ds, 4); /* 4 bytes */
-        wasm_emit1(&ds, 16); wasm_emit1(&ds, 0); wasm_emit1(&ds, 0); wasm_emit1(&ds, 0);
+        wasm_emit_leb128_u(&ds, WASM_HEAP_STATE_END);
+        wasm_emit1(&ds, 16);
+        for (int32_t zi = 1; zi < WASM_HEAP_STATE_END; zi++) wasm_emit1(&ds, 0);
 
         /* Segment 2 (optional): string literal data */
         if (wasm_global_strdata && wasm_global_strdata->len > 0) {
@@ -26249,10 +31789,10 @@ bool cold_compile_source_to_object(const char *out_path,
                                    const char *target,
                                    const char *export_roots_csv,
                                    const char *symbol_visibility) {
-    bool is_elf  = target && strstr(target, "linux") != 0;
-    bool is_coff = target && strstr(target, "windows") != 0;
+    volatile bool is_elf  = target && strstr(target, "linux") != 0;
+    volatile bool is_coff = target && strstr(target, "windows") != 0;
     bool is_wasm = target && strcmp(target, "wasm32-unknown-unknown") == 0;
-    bool internal_visibility = symbol_visibility && strcmp(symbol_visibility, "internal") == 0;
+    volatile bool internal_visibility = symbol_visibility && strcmp(symbol_visibility, "internal") == 0;
     bool public_visibility = !symbol_visibility || symbol_visibility[0] == '\0' ||
                              strcmp(symbol_visibility, "public") == 0;
     bool reachable_only = getenv("CHENG_OBJECT_REACHABLE_ONLY") != 0;
@@ -26359,7 +31899,7 @@ bool cold_compile_source_to_object(const char *out_path,
                 continue;
             }
             int32_t symbol_index = -1;
-            BodyIR *body = 0;
+            BodyIR *volatile body = 0;
             int32_t fn_saved = parser.pos;
             ColdErrorRecoveryEnabled = true;
             if (setjmp(ColdErrorJumpBuf) == 0) {
@@ -26513,6 +32053,9 @@ bool cold_compile_source_to_object(const char *out_path,
             if (symbols->functions[i].is_external) { func_to_wasm_idx[i] = next_wasm_idx++; }
         for (int32_t i = 0; i < func_count; i++)
             if (!symbols->functions[i].is_external) { func_to_wasm_idx[i] = next_wasm_idx++; }
+        /* Heap allocator functions follow every defined function. */
+        wasm_heap_alloc_idx = next_wasm_idx++;
+        wasm_heap_free_idx = next_wasm_idx++;
     }
 
     /* Entry trampoline: save argc/argv in callee-saved registers */
@@ -26597,23 +32140,21 @@ bool cold_compile_source_to_object(const char *out_path,
     int32_t *reloc_offsets = arena_alloc(arena, (size_t)reloc_cap * sizeof(int32_t));
     int32_t *reloc_symbols = arena_alloc(arena, (size_t)reloc_cap * sizeof(int32_t));
     int32_t reloc_count = 0;
+    uint64_t patch_start = cold_trace_begin();
 
     if (use_x64) {
-        /* Resolve x86_64 patches in byte buffer before packing */
+        /* Resolve x86_64 patches in byte buffer before packing; externals
+           become relocations in the same pass */
         for (int32_t pi = 0; pi < function_patches.count; pi++) {
             FunctionPatch patch = function_patches.items[pi];
             if (patch.target_function < 0 || patch.target_function >= func_count) continue;
-            if (patch.kind == FUNCTION_PATCH_ADDR)
-                die("cold x86_64 object function address relocation unsupported");
             int32_t target_off = symbol_offset[patch.target_function];
-            if (target_off < 0) continue; /* external: leave as relocation */
-            x64_patch_call_rel32(&x64_buf, (int32_t)patch.pos, target_off);
-        }
-        /* Re-collect unresolved (external) patches as relocations */
-        for (int32_t pi = 0; pi < function_patches.count; pi++) {
-            FunctionPatch patch = function_patches.items[pi];
-            if (patch.target_function < 0 || patch.target_function >= func_count) continue;
-            if (symbol_offset[patch.target_function] >= 0) continue; /* already resolved */
+            if (target_off >= 0) {
+                if (patch.kind == FUNCTION_PATCH_ADDR)
+                    die("cold x86_64 object function address relocation unsupported");
+                x64_patch_call_rel32(&x64_buf, (int32_t)patch.pos, target_off);
+                continue;
+            }
             if (patch.kind == FUNCTION_PATCH_ADDR)
                 die("cold object external function address relocation unsupported");
             if (!symbols->functions[patch.target_function].is_external)
@@ -26671,6 +32212,8 @@ bool cold_compile_source_to_object(const char *out_path,
             }
         }
     }
+    cold_trace_end_items("patch", cold_cstr_span("function_patches"),
+                         patch_start, function_patches.count);
 
     if (use_entry_trampoline && main_function >= 0 && symbol_offset[main_function] >= 0) {
         int32_t target = symbol_offset[main_function];
@@ -26680,7 +32223,7 @@ bool cold_compile_source_to_object(const char *out_path,
             shared->count = x64_pack_words(&x64_buf, shared->words, shared->cap);
         } else {
             if (use_rv64)
-                shared->words[trampoline_bl_pos] = rv_jal(RV_RA, target - trampoline_bl_pos);
+                shared->words[trampoline_bl_pos] = rv_jal(RV_RA, (target - trampoline_bl_pos) * 4);
             else
                 shared->words[trampoline_bl_pos] = a64_bl(target - trampoline_bl_pos);
         }
@@ -27595,6 +33138,7 @@ static bool cold_emit_csg_v2_facts_from_source(const char *facts_path,
    for --provider-objects. Returns 0 if directory has no .o files. */
 static const char *cold_provider_archive_dir_to_objects(const char *dir_path) {
     static char buf[65536];
+    if (cold_serve_dep_fd >= 0) cold_serve_record_untracked(dir_path);
     DIR *dir = opendir(dir_path);
     if (!dir) return 0;
     struct dirent *entry;
@@ -27780,7 +33324,20 @@ static bool cold_macho_system_link_provider_objects(const char *primary_object,
     return true;
 }
 
+static int cold_system_link_exec_run(int argc, char **argv);
+
 static int cold_cmd_system_link_exec(int argc, char **argv) {
+    const char *trace_path = cold_flag_value(argc, argv, "--trace-out");
+    if (!trace_path || trace_path[0] == '\0') return cold_system_link_exec_run(argc, argv);
+    cold_trace_start(trace_path);
+    int rc = cold_system_link_exec_run(argc, argv);
+    if (!cold_trace_finish(trace_path) && rc == 0) rc = 1;
+    return rc;
+}
+
+static int cold_system_link_exec_run(int argc, char **argv) {
+    cold_rodata_end(); /* an aborted compile must not leave rodata mode on */
+    cold_worker_arenas_reset();
     const char *source_path = cold_flag_value(argc, argv, "--in");
     const char *csg_in_path = cold_flag_value(argc, argv, "--csg-in");
     const char *csg_out_path = cold_flag_value(argc, argv, "--csg-out");
@@ -27831,6 +33388,60 @@ static int cold_cmd_system_link_exec(int argc, char **argv) {
         if (strcmp(argv[di], "--diag:dump_slots") == 0) cold_diag_dump_slots = true;
         if (strcmp(argv[di], "--ownership-on") == 0) ownership_on = true;
     }
+    const char *wasm_features = cold_flag_value(argc, argv, "--wasm-features");
+    if (!wasm_parse_features(wasm_features)) {
+        fprintf(stderr, "[cheng_cold] unknown --wasm-features:%s (use mvp, bulk, simd, all or a comma list)\n",
+                wasm_features);
+        return 2;
+    }
+    const char *riscv_features = cold_flag_value(argc, argv, "--riscv-features");
+    if (!rv64_parse_features(riscv_features)) {
+        fprintf(stderr, "[cheng_cold] unknown --riscv-features:%s (use rv64gc, rv64g, zba, zbb, all or a comma list)\n",
+                riscv_features);
+        return 2;
+    }
+    /* --instrument[:<file>] counts block entries into <file> (default
+       <out>.profile); --profile-use:<file> lays out blocks from such a file. */
+    cold_profile.instrument = false;
+    free(cold_profile.use_bytes);
+    free(cold_profile.entries);
+    cold_profile.use_bytes = NULL;
+    cold_profile.entries = NULL;
+    cold_profile.entry_count = 0;
+    const char *instrument_path = 0;
+    for (int di = 2; di < argc; di++) {
+        if (strcmp(argv[di], "--instrument") == 0) instrument_path = "";
+        else if (strncmp(argv[di], "--instrument:", 13) == 0) instrument_path = argv[di] + 13;
+    }
+    const char *profile_use = cold_flag_value(argc, argv, "--profile-use");
+    if (instrument_path) {
+        if (profile_use) {
+            fprintf(stderr, "[cheng_cold] cannot combine --instrument and --profile-use\n");
+            return 2;
+        }
+        if (strcmp(emit, "exe") != 0 ||
+            (strcmp(target, "x86_64-unknown-linux-gnu") != 0 &&
+             strcmp(target, "riscv64-unknown-linux-gnu") != 0)) {
+            fprintf(stderr, "[cheng_cold] --instrument needs --emit:exe for x86_64-unknown-linux-gnu "
+                            "or riscv64-unknown-linux-gnu\n");
+            return 2;
+        }
+        int n = instrument_path[0]
+            ? snprintf(cold_profile.path, sizeof(cold_profile.path), "%s", instrument_path)
+            : snprintf(cold_profile.path, sizeof(cold_profile.path), "%s.profile", out_path ? out_path : "a.out");
+        if (n <= 0 || n >= (int)sizeof(cold_profile.path)) {
+            fprintf(stderr, "[cheng_cold] --instrument path too long\n");
+            return 2;
+        }
+        cold_profile.instrument = true;
+    }
+    if (profile_use) {
+        char profile_err[PATH_MAX + 64];
+        if (!cold_profile_load(profile_use, profile_err, sizeof(profile_err))) {
+            fprintf(stderr, "[cheng_cold] %s\n", profile_err);
+            return 2;
+        }
+    }
     if (cold_diag_dump_per_fn) fprintf(stderr, "[diag] dump_per_fn ENABLED\n");
     if (cold_diag_dump_slots) fprintf(stderr, "[diag] dump_slots ENABLED\n");
 
@@ -28093,7 +33704,7 @@ static int cold_cmd_system_link_exec(int argc, char **argv) {
     /* --emit:csg-v2 = emit internal BodyIR facts.
        --emit:csg-v2-primary = emit canonical primary-object facts. */
     if (strcmp(emit, "csg-v2") == 0 || strcmp(emit, "csg-v2-primary") == 0) {
-        bool primary_csg_v2_emit = strcmp(emit, "csg-v2-primary") == 0;
+        volatile bool primary_csg_v2_emit = strcmp(emit, "csg-v2-primary") == 0;
         /* CSG v2 fixed-point roundtrip: read facts, codegen (DSE), re-emit.
            This operates on CSG facts directly; no source compilation needed. */
         if (!primary_csg_v2_emit && csg_in_path && csg_in_path[0] != '\0' &&
@@ -28117,6 +33728,10 @@ static int cold_cmd_system_link_exec(int argc, char **argv) {
                                                  &rp_bodies, &rp_count,
                                                  rp_sym, rp_arena, target, &rp_timing);
             if (rp_ok) {
+                cold_bce_checks_removed = 0;
+                cold_gvn_values_reused = 0;
+                cold_iv_muls_reduced = 0;
+                cold_iv_muls_skipped_capacity = 0;
                 /* Apply dead-store elimination (the primary BodyIR mutation) */
                 for (int32_t i = 0; i < rp_count; i++) {
                     BodyIR *b = rp_bodies[i];
@@ -28130,6 +33745,10 @@ static int cold_cmd_system_link_exec(int argc, char **argv) {
                 rp_stats.elapsed_us = cold_now_us() - rp_start;
                 rp_stats.csg_lowering = 1;
                 rp_stats.facts_function_count = rp_timing.fn_count;
+                rp_stats.bce_checks_removed = cold_bce_checks_removed;
+                rp_stats.gvn_values_reused = cold_gvn_values_reused;
+                rp_stats.iv_muls_reduced = cold_iv_muls_reduced;
+                rp_stats.iv_muls_skipped_capacity = cold_iv_muls_skipped_capacity;
                 struct stat rp_st;
                 if (stat(out_path, &rp_st) == 0) rp_stats.facts_bytes = (uint64_t)rp_st.st_size;
                 cold_write_system_link_exec_report(report_path, true, source_path, csg_in_path,
@@ -28161,7 +33780,7 @@ static int cold_cmd_system_link_exec(int argc, char **argv) {
             return 2;
         }
         Symbols *symbols = symbols_new(arena);
-        BodyIR **function_bodies = NULL;
+        BodyIR **volatile function_bodies = NULL;
         int32_t body_cap = 0;
 
         Span mapped_source = source_open(source_path);
@@ -28209,11 +33828,11 @@ static int cold_cmd_system_link_exec(int argc, char **argv) {
         /* Compile transitive import bodies: recursively process each import file */
         {
             char visited_paths[64][PATH_MAX];
-            int32_t visited_count = 0;
+            volatile int32_t visited_count = 0;
             for (int32_t ii = 0; ii < import_source_count && ii < 64; ii++) {
                 snprintf(visited_paths[visited_count++], PATH_MAX, "%s", import_sources[ii].path);
             }
-            for (int32_t vi = 0; vi < visited_count && vi < 64; vi++) {
+            for (volatile int32_t vi = 0; vi < visited_count && vi < 64; vi++) {
                 Span src = source_open(visited_paths[vi]);
                 if (src.len <= 0) continue;
                 ColdErrorRecoveryEnabled = true;
@@ -28256,24 +33875,7 @@ static int cold_cmd_system_link_exec(int argc, char **argv) {
         parser.function_bodies = function_bodies;
         parser.function_body_cap = body_cap;
         parser.source_path = source_path;
-        while (parser.pos < mapped_source.len) {
-            parser_ws(&parser);
-            if (parser.pos >= mapped_source.len) break;
-            Span next = parser_peek(&parser);
-            if (span_eq(next, "type")) {
-                parse_type(&parser);
-            } else if (span_eq(next, "const")) {
-                parse_const(&parser);
-            } else if (span_eq(next, "fn")) {
-                int32_t symbol_index = -1;
-                BodyIR *body = parse_fn(&parser, &symbol_index);
-                if (symbol_index >= 0 && symbol_index < body_cap) {
-                    function_bodies[symbol_index] = body;
-                }
-            } else {
-                parser_line(&parser);
-            }
-        }
+        cold_parse_module_decls(&parser, true, 0, 0);
 
         /* Grow function_bodies if parse added more functions */
         if (symbols->function_cap > body_cap) {
@@ -28710,7 +34312,7 @@ link_providers_done:
         printf("output=%s\n", out_path);
         return 0;
     }
-    int compiled = 0;
+    volatile int compiled = 0;
     if (effective_csg_path && effective_csg_path[0]) {
         compiled = cold_compile_csg_path_to_macho(out_path, effective_csg_path, source_path,
                                                   workspace_root[0] ? workspace_root : 0,
@@ -29099,8 +34701,827 @@ static int32_t cold_materialize_direct_emit(Parser *parser, BodyIR *body, int32_
 }
 #endif /* COLD_BACKEND_ONLY */
 
-int main(int argc, char **argv) {
-    ColdArgv0 = argv;
+/* ================================================================
+ * Compile server
+ *
+ * `cheng_cold serve --socket:<path>` serves commands sent by
+ * `cheng_cold serve-client --socket:<path> <command> ...` from two caches.
+ *
+ * The result cache remembers finished commands.  A request carries the
+ * client cwd, argv and environment; the cache key is the hash of those plus
+ * the server binary.  A cached result is reused while every input the build
+ * recorded (source_open reads, the profile, manifest entries) still has the
+ * recorded content hash; the files named by --out / --*-out flags are then
+ * restored from the cached bytes.  A build that used an input it could not
+ * hash (such as a --provider-archive-dir listing) is not cached.
+ *
+ * A miss runs the ordinary command in a forked child of the server.  The
+ * body cache makes that child cheaper: it holds lowered function bodies
+ * (BodyIR) keyed by content (cold_fn_body_cache_key), so after an edit only
+ * the functions whose text, context or visible Symbols changed are lowered
+ * again.  The child inherits the cache through fork and reports every body
+ * it lowered without side effects on a pipe; the server adds them after a
+ * successful build and drops the whole cache when it is full.  A reused
+ * body is the bytes the same lowering produced, so a served build stays
+ * byte-identical to a one-shot build of the same command.
+ * ================================================================ */
+#define COLD_SERVE_CACHE_CAP 64
+#define COLD_SERVE_BODY_SLOTS (1 << 15)          /* open addressing, power of two */
+#define COLD_SERVE_BODY_BYTES ((size_t)256 << 20)
+#define COLD_SERVE_MAX_STRINGS 4096
+#define COLD_SERVE_MAX_STRING (1u << 20)
+
+extern char **environ;
+static int cold_main(int argc, char **argv);
+
+typedef struct ColdServeBuf {
+    uint8_t *data;
+    size_t len;
+    size_t cap;
+} ColdServeBuf;
+
+typedef struct ColdServeOutput {
+    char *path;
+    mode_t mode;
+    ColdServeBuf bytes;
+} ColdServeOutput;
+
+typedef struct ColdServeEntry {
+    uint64_t key;
+    uint64_t last_use;
+    int32_t rc;
+    ColdServeBuf deps;      /* "<hash|-> <path>\n" lines from the worker */
+    ColdServeBuf out_text;
+    ColdServeBuf err_text;
+    ColdServeOutput *outputs;
+    int32_t output_count;
+} ColdServeEntry;
+
+typedef struct ColdServeRequest {
+    char *cwd;
+    char **argv;
+    int32_t argc;
+    char **env;
+    int32_t envc;
+} ColdServeRequest;
+
+static void cold_serve_buf_append(ColdServeBuf *buf, const void *data, size_t len) {
+    if (buf->len + len > buf->cap) {
+        size_t cap = buf->cap ? buf->cap : 256;
+        while (cap < buf->len + len) cap *= 2;
+        uint8_t *grown = realloc(buf->data, cap);
+        if (!grown) die("serve buffer allocation failed");
+        buf->data = grown;
+        buf->cap = cap;
+    }
+    if (len > 0) memcpy(buf->data + buf->len, data, len);
+    buf->len += len;
+}
+
+static void cold_serve_buf_free(ColdServeBuf *buf) {
+    free(buf->data);
+    memset(buf, 0, sizeof(*buf));
+}
+
+static bool cold_serve_read_full(int fd, void *data, size_t len) {
+    uint8_t *p = data;
+    while (len > 0) {
+        ssize_t n = read(fd, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+static bool cold_serve_write_full(int fd, const void *data, size_t len) {
+    const uint8_t *p = data;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+static bool cold_serve_write_u32(int fd, uint32_t value) {
+    return cold_serve_write_full(fd, &value, sizeof(value));
+}
+
+static bool cold_serve_write_blob(int fd, const void *data, size_t len) {
+    return cold_serve_write_u32(fd, (uint32_t)len) && cold_serve_write_full(fd, data, len);
+}
+
+static bool cold_serve_read_u32(int fd, uint32_t *value) {
+    return cold_serve_read_full(fd, value, sizeof(*value));
+}
+
+static char *cold_serve_read_string(int fd, uint32_t *len_out) {
+    uint32_t len = 0;
+    if (!cold_serve_read_u32(fd, &len) || len > COLD_SERVE_MAX_STRING) return 0;
+    char *text = malloc((size_t)len + 1);
+    if (!text) return 0;
+    if (!cold_serve_read_full(fd, text, len)) {
+        free(text);
+        return 0;
+    }
+    text[len] = '\0';
+    if (len_out) *len_out = len;
+    return text;
+}
+
+static char **cold_serve_read_strings(int fd, int32_t *count_out) {
+    uint32_t count = 0;
+    if (!cold_serve_read_u32(fd, &count) || count > COLD_SERVE_MAX_STRINGS) return 0;
+    char **items = calloc((size_t)count + 1, sizeof(char *));
+    if (!items) return 0;
+    for (uint32_t i = 0; i < count; i++) {
+        items[i] = cold_serve_read_string(fd, 0);
+        if (!items[i]) {
+            for (uint32_t j = 0; j < i; j++) free(items[j]);
+            free(items);
+            return 0;
+        }
+    }
+    *count_out = (int32_t)count;
+    return items;
+}
+
+static bool cold_serve_write_strings(int fd, char **items, int32_t count) {
+    if (!cold_serve_write_u32(fd, (uint32_t)count)) return false;
+    for (int32_t i = 0; i < count; i++) {
+        if (!cold_serve_write_blob(fd, items[i], strlen(items[i]))) return false;
+    }
+    return true;
+}
+
+static void cold_serve_request_free(ColdServeRequest *request) {
+    free(request->cwd);
+    for (int32_t i = 0; i < request->argc; i++) free(request->argv[i]);
+    for (int32_t i = 0; i < request->envc; i++) free(request->env[i]);
+    free(request->argv);
+    free(request->env);
+    memset(request, 0, sizeof(*request));
+}
+
+static void cold_serve_entry_free(ColdServeEntry *entry) {
+    cold_serve_buf_free(&entry->deps);
+    cold_serve_buf_free(&entry->out_text);
+    cold_serve_buf_free(&entry->err_text);
+    for (int32_t i = 0; i < entry->output_count; i++) {
+        free(entry->outputs[i].path);
+        cold_serve_buf_free(&entry->outputs[i].bytes);
+    }
+    free(entry->outputs);
+    memset(entry, 0, sizeof(*entry));
+}
+
+static void cold_serve_resolve(char *out, size_t cap, const char *cwd, const char *path) {
+    if (path[0] == '/') snprintf(out, cap, "%s", path);
+    else cold_join_path(out, cap, cwd, path);
+}
+
+static uint64_t cold_serve_file_hash(const char *path, bool *present) {
+    Span data = source_map_file(path);
+    *present = data.len > 0;
+    if (data.len <= 0) return 0;
+    uint64_t hash = cold_fnv1a64_update_bytes(1469598103934665603ULL, data.ptr, (size_t)data.len);
+    munmap((void *)data.ptr, (size_t)data.len);
+    return hash;
+}
+
+/* Output paths of a command: every --out / --<name>-out flag, in either
+   the --flag:value or the --flag value spelling. */
+static int32_t cold_serve_output_paths(ColdServeRequest *request, const char **paths, int32_t cap) {
+    int32_t count = 0;
+    for (int32_t i = 1; i < request->argc && count < cap; i++) {
+        const char *arg = request->argv[i];
+        if (strncmp(arg, "--", 2) != 0) continue;
+        const char *sep = strpbrk(arg, ":=");
+        size_t name_len = sep ? (size_t)(sep - arg) : strlen(arg);
+        if (name_len < 5 || strncmp(arg + name_len - 3, "out", 3) != 0) continue;
+        if (name_len != 5 && arg[name_len - 4] != '-') continue;
+        const char *value = sep ? sep + 1 : (i + 1 < request->argc ? request->argv[i + 1] : 0);
+        if (value && value[0] != '\0') paths[count++] = value;
+    }
+    return count;
+}
+
+static bool cold_serve_entry_fresh(ColdServeEntry *entry, const char *cwd) {
+    const char *p = (const char *)entry->deps.data;
+    const char *end = p + entry->deps.len;
+    while (p < end) {
+        const char *nl = memchr(p, '\n', (size_t)(end - p));
+        if (!nl) return false;
+        const char *space = memchr(p, ' ', (size_t)(nl - p));
+        if (!space) return false;
+        char rel[PATH_MAX];
+        char full[PATH_MAX];
+        size_t rel_len = (size_t)(nl - space - 1);
+        if (rel_len >= sizeof(rel)) return false;
+        memcpy(rel, space + 1, rel_len);
+        rel[rel_len] = '\0';
+        cold_serve_resolve(full, sizeof(full), cwd, rel);
+        bool present = false;
+        uint64_t hash = cold_serve_file_hash(full, &present);
+        if (*p == '-') {
+            if (present) return false;
+        } else {
+            if (!present || strtoull(p, 0, 16) != hash) return false;
+        }
+        p = nl + 1;
+    }
+    return true;
+}
+
+/* False when the build reported an input it could not hash. */
+static bool cold_serve_entry_cacheable(ColdServeEntry *entry) {
+    const char *p = (const char *)entry->deps.data;
+    const char *end = p + entry->deps.len;
+    while (p < end) {
+        if (*p == '!') return false;
+        const char *nl = memchr(p, '\n', (size_t)(end - p));
+        if (!nl) return false;
+        p = nl + 1;
+    }
+    return true;
+}
+
+static void cold_serve_restore_outputs(ColdServeEntry *entry) {
+    for (int32_t i = 0; i < entry->output_count; i++) {
+        ColdServeOutput *output = &entry->outputs[i];
+        Span current = source_map_file(output->path);
+        bool same = current.len >= 0 && (size_t)current.len == output->bytes.len &&
+                    (output->bytes.len == 0 ||
+                     (current.len > 0 && memcmp(current.ptr, output->bytes.data, output->bytes.len) == 0));
+        if (current.len > 0) munmap((void *)current.ptr, (size_t)current.len);
+        if (same && access(output->path, F_OK) == 0) continue;
+        cold_write_file_bytes(output->path, output->bytes.data, output->bytes.len);
+        chmod(output->path, output->mode & 07777);
+    }
+}
+
+static void cold_serve_capture_outputs(ColdServeEntry *entry, ColdServeRequest *request) {
+    const char *paths[32];
+    int32_t count = cold_serve_output_paths(request, paths, 32);
+    entry->outputs = calloc((size_t)(count > 0 ? count : 1), sizeof(ColdServeOutput));
+    if (!entry->outputs) die("serve output allocation failed");
+    for (int32_t i = 0; i < count; i++) {
+        char full[PATH_MAX];
+        cold_serve_resolve(full, sizeof(full), request->cwd, paths[i]);
+        struct stat st;
+        if (stat(full, &st) != 0 || !S_ISREG(st.st_mode)) continue;
+        ColdServeOutput *output = &entry->outputs[entry->output_count++];
+        output->path = strdup(full);
+        output->mode = st.st_mode;
+        Span data = source_map_file(full);
+        if (data.len > 0) {
+            cold_serve_buf_append(&output->bytes, data.ptr, (size_t)data.len);
+            munmap((void *)data.ptr, (size_t)data.len);
+        }
+    }
+}
+
+/* ---- function body cache ----
+   Server side: an open-addressing table of serialized bodies, inherited by
+   every forked child.  Child side: cold_serve_body_lookup decodes a hit
+   into the lowering arena; cold_serve_body_offer writes a fresh body to
+   cold_serve_body_fd as a 'B' record (key, length, encoding), and the child
+   ends with one 'R' record carrying the number of bodies it reused. */
+typedef struct ColdServeBody {
+    uint64_t key;       /* 0 = empty slot */
+    uint8_t *data;
+    uint32_t len;
+} ColdServeBody;
+
+static ColdServeBody *cold_serve_bodies = 0;
+static int32_t cold_serve_body_count = 0;
+static size_t cold_serve_body_bytes = 0;
+static int cold_serve_body_fd = -1;
+static int32_t cold_serve_bodies_reused = 0;
+static pthread_mutex_t cold_serve_body_lock = PTHREAD_MUTEX_INITIALIZER;
+
+typedef struct ColdServeReader {
+    const uint8_t *pos;
+    const uint8_t *end;
+    bool ok;
+} ColdServeReader;
+
+static ColdServeBody *cold_serve_body_slot(uint64_t key) {
+    uint32_t mask = COLD_SERVE_BODY_SLOTS - 1;
+    uint32_t i = (uint32_t)(key ^ (key >> 32)) & mask;
+    while (cold_serve_bodies[i].key != 0 && cold_serve_bodies[i].key != key) i = (i + 1) & mask;
+    return &cold_serve_bodies[i];
+}
+
+static void cold_serve_body_clear(void) {
+    if (!cold_serve_bodies) return;
+    for (int32_t i = 0; i < COLD_SERVE_BODY_SLOTS; i++) free(cold_serve_bodies[i].data);
+    memset(cold_serve_bodies, 0, COLD_SERVE_BODY_SLOTS * sizeof(ColdServeBody));
+    cold_serve_body_count = 0;
+    cold_serve_body_bytes = 0;
+}
+
+static void cold_serve_put_i32(ColdServeBuf *buf, int32_t value) {
+    cold_serve_buf_append(buf, &value, sizeof(value));
+}
+
+static void cold_serve_put_array(ColdServeBuf *buf, const void *items, int32_t count, size_t elem) {
+    if (count > 0) cold_serve_buf_append(buf, items, (size_t)count * elem);
+}
+
+/* -1 keeps a null span apart from an empty one. */
+static void cold_serve_put_span(ColdServeBuf *buf, Span span) {
+    cold_serve_put_i32(buf, span.ptr ? span.len : -1);
+    if (span.len > 0) cold_serve_buf_append(buf, span.ptr, (size_t)span.len);
+}
+
+static void cold_serve_get_bytes(ColdServeReader *r, void *dst, size_t size) {
+    if (!r->ok || (size_t)(r->end - r->pos) < size) {
+        r->ok = false;
+        return;
+    }
+    memcpy(dst, r->pos, size);
+    r->pos += size;
+}
+
+static int32_t cold_serve_get_i32(ColdServeReader *r) {
+    int32_t value = 0;
+    cold_serve_get_bytes(r, &value, sizeof(value));
+    return value;
+}
+
+static void *cold_serve_get_array(ColdServeReader *r, Arena *arena, int32_t count,
+                                  int32_t cap, size_t elem) {
+    if (cap <= 0 || !r->ok) return 0;
+    void *items = arena_alloc_uninit(arena, (size_t)cap * elem);
+    cold_serve_get_bytes(r, items, (size_t)count * elem);
+    return items;
+}
+
+static Span cold_serve_get_span(ColdServeReader *r, Arena *arena) {
+    int32_t len = cold_serve_get_i32(r);
+    if (len < 0 || !r->ok || r->end - r->pos < len) {
+        if (len >= 0) r->ok = false;
+        return (Span){0};
+    }
+    Span span = cold_arena_span_copy(arena, (Span){r->pos, len});
+    r->pos += len;
+    return span;
+}
+
+/* Everything parse_fn_body_lower sets; the fields later passes add
+   (bounds proofs, profile data) are not cached.  Capacities are kept too:
+   cold_reduce_iv_multiply only rewrites a body with room to spare. */
+static void cold_serve_body_encode(ColdServeBuf *buf, const BodyIR *body, int32_t consumed) {
+    cold_serve_put_i32(buf, consumed);
+    const int32_t sizes[] = {body->op_count, body->op_cap, body->term_count, body->term_cap,
+                             body->block_count, body->block_cap, body->slot_count, body->slot_cap,
+                             body->switch_count, body->switch_cap, body->call_arg_count,
+                             body->call_arg_cap, body->string_literal_count,
+                             body->string_literal_cap};
+    for (int32_t i = 0; i < 14; i++) cold_serve_put_i32(buf, sizes[i]);
+    cold_serve_put_i32(buf, body->param_count);
+    cold_serve_put_i32(buf, body->frame_size);
+    cold_serve_put_i32(buf, body->return_kind);
+    cold_serve_put_i32(buf, body->return_size);
+    cold_serve_put_i32(buf, body->sret_slot);
+    cold_serve_put_i32(buf, body->has_fallback);
+    int32_t *const ops[] = {body->op_kind, body->op_dst, body->op_a, body->op_b, body->op_c};
+    for (int32_t i = 0; i < 5; i++) cold_serve_put_array(buf, ops[i], body->op_count, sizeof(int32_t));
+    int32_t *const terms[] = {body->term_kind, body->term_value, body->term_case_start,
+                              body->term_case_count, body->term_true_block, body->term_false_block};
+    for (int32_t i = 0; i < 6; i++) cold_serve_put_array(buf, terms[i], body->term_count, sizeof(int32_t));
+    int32_t *const blocks[] = {body->block_op_start, body->block_op_count, body->block_term};
+    for (int32_t i = 0; i < 3; i++) cold_serve_put_array(buf, blocks[i], body->block_count, sizeof(int32_t));
+    int32_t *const slots[] = {body->slot_kind, body->slot_offset, body->slot_size,
+                              body->slot_aux, body->slot_no_alias};
+    for (int32_t i = 0; i < 5; i++) cold_serve_put_array(buf, slots[i], body->slot_count, sizeof(int32_t));
+    int32_t *const switches[] = {body->switch_tag, body->switch_block, body->switch_term};
+    for (int32_t i = 0; i < 3; i++) cold_serve_put_array(buf, switches[i], body->switch_count, sizeof(int32_t));
+    cold_serve_put_array(buf, body->call_arg_slot, body->call_arg_count, sizeof(int32_t));
+    cold_serve_put_array(buf, body->call_arg_offset, body->call_arg_count, sizeof(int32_t));
+    cold_serve_put_array(buf, body->param_slot, body->param_count, sizeof(int32_t));
+    for (int32_t i = 0; i < body->slot_count; i++) cold_serve_put_span(buf, body->slot_type[i]);
+    for (int32_t i = 0; i < body->string_literal_count; i++) cold_serve_put_span(buf, body->string_literal[i]);
+    for (int32_t i = 0; i < body->param_count; i++) cold_serve_put_span(buf, body->param_name[i]);
+    cold_serve_put_span(buf, body->return_type);
+    cold_serve_put_span(buf, body->debug_name);
+}
+
+static BodyIR *cold_serve_body_decode(const uint8_t *data, uint32_t len, Arena *arena,
+                                      int32_t *consumed) {
+    ColdServeReader r = {data, data + len, true};
+    BodyIR *body = body_new(arena);
+    *consumed = cold_serve_get_i32(&r);
+    int32_t *const sizes[] = {&body->op_count, &body->op_cap, &body->term_count, &body->term_cap,
+                              &body->block_count, &body->block_cap, &body->slot_count,
+                              &body->slot_cap, &body->switch_count, &body->switch_cap,
+                              &body->call_arg_count, &body->call_arg_cap,
+                              &body->string_literal_count, &body->string_literal_cap};
+    for (int32_t i = 0; i < 14; i += 2) {
+        *sizes[i] = cold_serve_get_i32(&r);
+        *sizes[i + 1] = cold_serve_get_i32(&r);
+        if (*sizes[i] < 0 || *sizes[i] > *sizes[i + 1]) r.ok = false;
+    }
+    body->param_count = cold_serve_get_i32(&r);
+    body->frame_size = cold_serve_get_i32(&r);
+    body->return_kind = cold_serve_get_i32(&r);
+    body->return_size = cold_serve_get_i32(&r);
+    body->sret_slot = cold_serve_get_i32(&r);
+    body->has_fallback = cold_serve_get_i32(&r) != 0;
+    if (!r.ok || body->param_count < 0 || body->param_count > COLD_MAX_I32_PARAMS) return 0;
+    int32_t **ops[] = {&body->op_kind, &body->op_dst, &body->op_a, &body->op_b, &body->op_c};
+    for (int32_t i = 0; i < 5; i++)
+        *ops[i] = cold_serve_get_array(&r, arena, body->op_count, body->op_cap, sizeof(int32_t));
+    int32_t **terms[] = {&body->term_kind, &body->term_value, &body->term_case_start,
+                         &body->term_case_count, &body->term_true_block, &body->term_false_block};
+    for (int32_t i = 0; i < 6; i++)
+        *terms[i] = cold_serve_get_array(&r, arena, body->term_count, body->term_cap, sizeof(int32_t));
+    int32_t **blocks[] = {&body->block_op_start, &body->block_op_count, &body->block_term};
+    for (int32_t i = 0; i < 3; i++)
+        *blocks[i] = cold_serve_get_array(&r, arena, body->block_count, body->block_cap, sizeof(int32_t));
+    int32_t **slots[] = {&body->slot_kind, &body->slot_offset, &body->slot_size,
+                         &body->slot_aux, &body->slot_no_alias};
+    for (int32_t i = 0; i < 5; i++)
+        *slots[i] = cold_serve_get_array(&r, arena, body->slot_count, body->slot_cap, sizeof(int32_t));
+    int32_t **switches[] = {&body->switch_tag, &body->switch_block, &body->switch_term};
+    for (int32_t i = 0; i < 3; i++)
+        *switches[i] = cold_serve_get_array(&r, arena, body->switch_count, body->switch_cap, sizeof(int32_t));
+    body->call_arg_slot = cold_serve_get_array(&r, arena, body->call_arg_count, body->call_arg_cap,
+                                                sizeof(int32_t));
+    body->call_arg_offset = cold_serve_get_array(&r, arena, body->call_arg_count, body->call_arg_cap,
+                                                  sizeof(int32_t));
+    cold_serve_get_bytes(&r, body->param_slot, (size_t)body->param_count * sizeof(int32_t));
+    if (body->slot_cap > 0) body->slot_type = arena_alloc_uninit(arena, (size_t)body->slot_cap * sizeof(Span));
+    for (int32_t i = 0; i < body->slot_count; i++) body->slot_type[i] = cold_serve_get_span(&r, arena);
+    if (body->string_literal_cap > 0)
+        body->string_literal = arena_alloc_uninit(arena, (size_t)body->string_literal_cap * sizeof(Span));
+    for (int32_t i = 0; i < body->string_literal_count; i++)
+        body->string_literal[i] = cold_serve_get_span(&r, arena);
+    for (int32_t i = 0; i < body->param_count; i++) body->param_name[i] = cold_serve_get_span(&r, arena);
+    body->return_type = cold_serve_get_span(&r, arena);
+    body->debug_name = cold_serve_get_span(&r, arena);
+    return r.ok && r.pos == r.end ? body : 0;
+}
+
+static BodyIR *cold_serve_body_lookup(uint64_t key, Arena *arena, int32_t *consumed) {
+    if (!cold_serve_bodies) return 0;
+    ColdServeBody *slot = cold_serve_body_slot(key);
+    if (slot->key == 0) return 0;
+    BodyIR *body = cold_serve_body_decode(slot->data, slot->len, arena, consumed);
+    if (body) __atomic_fetch_add(&cold_serve_bodies_reused, 1, __ATOMIC_RELAXED);
+    return body;
+}
+
+static void cold_serve_body_offer(uint64_t key, const BodyIR *body, int32_t consumed) {
+    if (cold_serve_body_fd < 0) return;
+    if (body->op_bounds_proven || body->block_profile || body->profile_counters >= 0) return;
+    ColdServeBuf record = {0};
+    cold_serve_buf_append(&record, "B", 1);
+    cold_serve_buf_append(&record, &key, sizeof(key));
+    cold_serve_put_i32(&record, 0);
+    cold_serve_body_encode(&record, body, consumed);
+    uint32_t len = (uint32_t)(record.len - 1 - sizeof(key) - sizeof(int32_t));
+    memcpy(record.data + 1 + sizeof(key), &len, sizeof(len));
+    pthread_mutex_lock(&cold_serve_body_lock);
+    if (!cold_serve_write_full(cold_serve_body_fd, record.data, record.len)) cold_serve_body_fd = -1;
+    pthread_mutex_unlock(&cold_serve_body_lock);
+    cold_serve_buf_free(&record);
+}
+
+/* Child side, once the command returned. */
+static void cold_serve_body_report(void) {
+    if (cold_serve_body_fd < 0) return;
+    uint8_t record[1 + sizeof(int32_t)] = {'R'};
+    int32_t reused = __atomic_load_n(&cold_serve_bodies_reused, __ATOMIC_RELAXED);
+    memcpy(record + 1, &reused, sizeof(reused));
+    cold_serve_write_full(cold_serve_body_fd, record, sizeof(record));
+}
+
+/* Server side: read a child's records, adding its bodies to the cache when
+   keep is set.  Returns the number of bodies the child reused. */
+static int32_t cold_serve_body_absorb(ColdServeBuf *records, bool keep) {
+    int32_t reused = 0;
+    size_t pos = 0;
+    while (pos < records->len) {
+        uint8_t tag = records->data[pos++];
+        if (tag == 'R' && records->len - pos >= sizeof(int32_t)) {
+            memcpy(&reused, records->data + pos, sizeof(reused));
+            pos += sizeof(int32_t);
+            continue;
+        }
+        uint64_t key = 0;
+        uint32_t len = 0;
+        if (tag != 'B' || records->len - pos < sizeof(key) + sizeof(len)) break;
+        memcpy(&key, records->data + pos, sizeof(key));
+        memcpy(&len, records->data + pos + sizeof(key), sizeof(len));
+        pos += sizeof(key) + sizeof(len);
+        if (records->len - pos < len) break;
+        const uint8_t *data = records->data + pos;
+        pos += len;
+        if (!keep || key == 0) continue;
+        if (!cold_serve_bodies) {
+            cold_serve_bodies = calloc(COLD_SERVE_BODY_SLOTS, sizeof(ColdServeBody));
+            if (!cold_serve_bodies) return reused;
+        }
+        if (cold_serve_body_count >= COLD_SERVE_BODY_SLOTS / 4 * 3 ||
+            cold_serve_body_bytes + len > COLD_SERVE_BODY_BYTES) cold_serve_body_clear();
+        ColdServeBody *slot = cold_serve_body_slot(key);
+        if (slot->key != 0) continue;
+        slot->data = malloc(len ? len : 1);
+        if (!slot->data) continue;
+        memcpy(slot->data, data, len);
+        slot->key = key;
+        slot->len = len;
+        cold_serve_body_count++;
+        cold_serve_body_bytes += len;
+    }
+    return reused;
+}
+
+/* Run one command in a forked child, collecting stdout, stderr, the
+   dependency lines the child reports through cold_serve_dep_fd and the body
+   cache records it writes to cold_serve_body_fd. */
+static int32_t cold_serve_run_child(ColdServeRequest *request, const char *self_path,
+                                    uint64_t key, ColdServeEntry *entry, ColdServeBuf *bodies) {
+    int out_pipe[2], err_pipe[2], dep_pipe[2], body_pipe[2];
+    if (pipe(out_pipe) != 0 || pipe(err_pipe) != 0 || pipe(dep_pipe) != 0 ||
+        pipe(body_pipe) != 0) return 125;
+    fflush(stdout);
+    fflush(stderr);
+    pid_t pid = fork();
+    if (pid < 0) return 125;
+    if (pid == 0) {
+        close(out_pipe[0]);
+        close(err_pipe[0]);
+        close(dep_pipe[0]);
+        close(body_pipe[0]);
+        dup2(out_pipe[1], 1);
+        dup2(err_pipe[1], 2);
+        close(out_pipe[1]);
+        close(err_pipe[1]);
+        if (chdir(request->cwd) != 0) _exit(126);
+        environ = request->env;
+        cold_serve_dep_fd = dep_pipe[1];
+        cold_serve_body_fd = body_pipe[1];
+        cold_serve_body_context = key ? key : 1;
+        request->argv[0] = (char *)self_path;
+        int rc = cold_main(request->argc, request->argv);
+        cold_serve_body_report();
+        exit(rc);
+    }
+    close(out_pipe[1]);
+    close(err_pipe[1]);
+    close(dep_pipe[1]);
+    close(body_pipe[1]);
+    struct pollfd fds[4] = {
+        {out_pipe[0], POLLIN, 0}, {err_pipe[0], POLLIN, 0},
+        {dep_pipe[0], POLLIN, 0}, {body_pipe[0], POLLIN, 0},
+    };
+    ColdServeBuf *sinks[4] = {&entry->out_text, &entry->err_text, &entry->deps, bodies};
+    int32_t open_count = 4;
+    while (open_count > 0) {
+        if (poll(fds, 4, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        for (int32_t i = 0; i < 4; i++) {
+            if (fds[i].fd < 0 || !(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+            uint8_t chunk[65536];
+            ssize_t n = read(fds[i].fd, chunk, sizeof(chunk));
+            if (n > 0) {
+                cold_serve_buf_append(sinks[i], chunk, (size_t)n);
+            } else if (n == 0 || errno != EINTR) {
+                close(fds[i].fd);
+                fds[i].fd = -1;
+                open_count--;
+            }
+        }
+    }
+    for (int32_t i = 0; i < 4; i++) {
+        if (fds[i].fd >= 0) close(fds[i].fd);
+    }
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) return 125;
+    }
+    if (WIFEXITED(status)) return WEXITSTATUS(status);
+    if (WIFSIGNALED(status)) return 128 + WTERMSIG(status);
+    return 125;
+}
+
+static bool cold_serve_read_request(int fd, ColdServeRequest *request) {
+    memset(request, 0, sizeof(*request));
+    request->cwd = cold_serve_read_string(fd, 0);
+    if (!request->cwd) return false;
+    request->argv = cold_serve_read_strings(fd, &request->argc);
+    if (!request->argv || request->argc < 1) return false;
+    request->env = cold_serve_read_strings(fd, &request->envc);
+    return request->env != 0;
+}
+
+static uint64_t cold_serve_request_key(ColdServeRequest *request, uint64_t self_hash) {
+    uint64_t hash = cold_fnv1a64_update_cstr(self_hash, request->cwd);
+    for (int32_t i = 1; i < request->argc; i++) {
+        hash = cold_fnv1a64_update_bytes(hash, (const uint8_t *)"\0", 1);
+        hash = cold_fnv1a64_update_cstr(hash, request->argv[i]);
+    }
+    hash = cold_fnv1a64_update_bytes(hash, (const uint8_t *)"\1", 1);
+    for (int32_t i = 0; i < request->envc; i++) {
+        hash = cold_fnv1a64_update_bytes(hash, (const uint8_t *)"\0", 1);
+        hash = cold_fnv1a64_update_cstr(hash, request->env[i]);
+    }
+    return hash;
+}
+
+static int cold_serve_listen(const char *socket_path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "[cheng_cold] serve socket path too long: %s\n", socket_path);
+        return -1;
+    }
+    memcpy(addr.sun_path, socket_path, strlen(socket_path) + 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    unlink(socket_path);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(fd, 16) != 0) {
+        fprintf(stderr, "[cheng_cold] serve cannot listen on %s\n", socket_path);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int cold_serve_connect(const char *socket_path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(socket_path) >= sizeof(addr.sun_path)) return -1;
+    memcpy(addr.sun_path, socket_path, strlen(socket_path) + 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int cold_cmd_serve(int argc, char **argv, const char *self_path) {
+    const char *socket_path = cold_flag_value(argc, argv, "--socket");
+    if (!socket_path || socket_path[0] == '\0') {
+        fprintf(stderr, "[cheng_cold] missing --socket:<path>\n");
+        return 1;
+    }
+    char abs_self[PATH_MAX];
+    cold_absolute_path(self_path, abs_self, sizeof(abs_self));
+    bool self_present = false;
+    uint64_t self_hash = cold_serve_file_hash(abs_self, &self_present);
+    if (!self_present) {
+        fprintf(stderr, "[cheng_cold] serve cannot read self image: %s\n", abs_self);
+        return 1;
+    }
+    int listen_fd = cold_serve_listen(socket_path);
+    if (listen_fd < 0) return 1;
+    signal(SIGPIPE, SIG_IGN);
+    printf("serve_socket=%s\n", socket_path);
+    fflush(stdout);
+
+    ColdServeEntry cache[COLD_SERVE_CACHE_CAP];
+    memset(cache, 0, sizeof(cache));
+    uint64_t clock = 0;
+    int32_t hits = 0;
+    int32_t misses = 0;
+    bool stop = false;
+    while (!stop) {
+        int fd = accept(listen_fd, 0, 0);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        ColdServeRequest request;
+        if (!cold_serve_read_request(fd, &request)) {
+            cold_serve_request_free(&request);
+            close(fd);
+            continue;
+        }
+        clock++;
+        if (strcmp(request.argv[1 < request.argc ? 1 : 0], "serve-stop") == 0) {
+            stop = true;
+            cold_serve_write_u32(fd, 0);
+            cold_serve_write_u32(fd, 0);
+            cold_serve_write_blob(fd, "", 0);
+            cold_serve_write_blob(fd, "", 0);
+            cold_serve_request_free(&request);
+            close(fd);
+            break;
+        }
+        uint64_t key = cold_serve_request_key(&request, self_hash);
+        ColdServeEntry *entry = 0;
+        ColdServeEntry *victim = &cache[0];
+        for (int32_t i = 0; i < COLD_SERVE_CACHE_CAP; i++) {
+            if (cache[i].last_use != 0 && cache[i].key == key) entry = &cache[i];
+            if (cache[i].last_use < victim->last_use) victim = &cache[i];
+        }
+        bool hit = entry && cold_serve_entry_fresh(entry, request.cwd);
+        ColdServeEntry fresh = {0};
+        ColdServeEntry *result = &fresh;
+        int32_t bodies_reused = 0;
+        if (hit) {
+            cold_serve_restore_outputs(entry);
+            entry->last_use = clock;
+            result = entry;
+            hits++;
+        } else {
+            ColdServeBuf bodies = {0};
+            fresh.rc = cold_serve_run_child(&request, abs_self, key, &fresh, &bodies);
+            bodies_reused = cold_serve_body_absorb(&bodies, fresh.rc == 0);
+            cold_serve_buf_free(&bodies);
+            misses++;
+        }
+        cold_serve_write_u32(fd, (uint32_t)result->rc);
+        cold_serve_write_u32(fd, hit ? 1u : 0u);
+        cold_serve_write_blob(fd, result->out_text.data, result->out_text.len);
+        cold_serve_write_blob(fd, result->err_text.data, result->err_text.len);
+        close(fd);
+        printf("serve_request=%llu cache=%s rc=%d hits=%d misses=%d bodies_reused=%d bodies=%d\n",
+               (unsigned long long)clock, hit ? "hit" : "miss", result->rc, hits, misses,
+               bodies_reused, cold_serve_body_count);
+        fflush(stdout);
+        if (!hit) {
+            if (entry) cold_serve_entry_free(entry);
+            if (fresh.rc == 0 && cold_serve_entry_cacheable(&fresh)) {
+                ColdServeEntry *slot = entry ? entry : victim;
+                if (slot != entry) cold_serve_entry_free(slot);
+                fresh.key = key;
+                fresh.last_use = clock;
+                cold_serve_capture_outputs(&fresh, &request);
+                *slot = fresh;
+            } else {
+                cold_serve_entry_free(&fresh);
+            }
+        }
+        cold_serve_request_free(&request);
+    }
+    for (int32_t i = 0; i < COLD_SERVE_CACHE_CAP; i++) cold_serve_entry_free(&cache[i]);
+    cold_serve_body_clear();
+    close(listen_fd);
+    unlink(socket_path);
+    printf("serve_stopped=1\n");
+    return 0;
+}
+
+static int cold_cmd_serve_client(int argc, char **argv) {
+    const char *socket_path = argc > 2 && strncmp(argv[2], "--socket:", 9) == 0 ? argv[2] + 9 : 0;
+    if (!socket_path || socket_path[0] == '\0' || argc < 4) {
+        fprintf(stderr, "[cheng_cold] usage: serve-client --socket:<path> <command> [args...]\n");
+        return 1;
+    }
+    int fd = cold_serve_connect(socket_path);
+    if (fd < 0) {
+        fprintf(stderr, "[cheng_cold] cannot connect to serve socket: %s\n", socket_path);
+        return 1;
+    }
+    char cwd[PATH_MAX];
+    if (!getcwd(cwd, sizeof(cwd))) {
+        close(fd);
+        return 1;
+    }
+    int32_t envc = 0;
+    while (environ && environ[envc]) envc++;
+    bool sent = cold_serve_write_blob(fd, cwd, strlen(cwd)) &&
+                cold_serve_write_strings(fd, argv + 2, argc - 2) &&
+                cold_serve_write_strings(fd, environ, envc);
+    uint32_t rc = 1;
+    uint32_t hit = 0;
+    char *out_text = 0;
+    char *err_text = 0;
+    uint32_t out_len = 0;
+    uint32_t err_len = 0;
+    bool ok = sent && cold_serve_read_u32(fd, &rc) && cold_serve_read_u32(fd, &hit) &&
+              (out_text = cold_serve_read_string(fd, &out_len)) != 0 &&
+              (err_text = cold_serve_read_string(fd, &err_len)) != 0;
+    close(fd);
+    if (!ok) {
+        fprintf(stderr, "[cheng_cold] serve request failed: %s\n", socket_path);
+        free(out_text);
+        free(err_text);
+        return 1;
+    }
+    fwrite(out_text, 1, out_len, stdout);
+    fwrite(err_text, 1, err_len, stderr);
+    free(out_text);
+    free(err_text);
+    return (int)rc;
+}
+
+static int cold_main(int argc, char **argv) {
     if (argc >= 2 && (strcmp(argv[1], "help") == 0 ||
                       strcmp(argv[1], "--help") == 0 ||
                       strcmp(argv[1], "-h") == 0)) {
@@ -29160,6 +35581,7 @@ int main(int argc, char **argv) {
     const char *src_path = argc > 2 ? argv[2] : 0;
 
     ColdCompileStats stats = {0};
+    cold_worker_arenas_reset();
     bool ok = cold_compile_source_path_to_macho(out_path, src_path, true, &stats);
     int rc = ok ? 0 : 1;
     printf("cheng_cold: %s src=%s fns=%d types=%d ops=%d blocks=%d switches=%d code=%dw arena=%zuKB\n",
@@ -29176,3 +35598,14 @@ int main(int argc, char **argv) {
     return rc;
 #endif
 }
+
+int main(int argc, char **argv) {
+    ColdArgv0 = argv;
+    if (argc >= 2 && strcmp(argv[1], "serve") == 0) {
+        return cold_cmd_serve(argc, argv, argv[0]);
+    }
+    if (argc >= 2 && strcmp(argv[1], "serve-client") == 0) {
+        return cold_cmd_serve_client(argc, argv);
+    }
+    return cold_main(argc, argv);
+}
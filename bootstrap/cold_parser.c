@@ -14,6 +14,8 @@
 #include <string.h>
 #include <stdio.h>
 #include <sys/stat.h>
+#include <pthread.h>
+#include <setjmp.h>
 
 Parser parser_child(Parser *owner, Span source) {
     Parser child = {source, 0, owner->arena, owner->symbols,
@@ -471,7 +473,7 @@ int32_t parse_param_specs(Symbols *symbols, Span params, Span *names,
 }
 
 Span cold_arena_span_copy(Arena *arena, Span text) {
-    uint8_t *ptr = arena_alloc(arena, (size_t)(text.len + 1));
+    uint8_t *ptr = arena_alloc_uninit(arena, (size_t)(text.len + 1));
     if (text.len > 0) memcpy(ptr, text.ptr, (size_t)text.len);
     ptr[text.len] = 0;
     return (Span){ptr, text.len};
@@ -1240,6 +1242,7 @@ void cold_collect_import_module_types_from_path(Symbols *symbols, Span alias,
 }
 
 void symbols_refine_object_layouts(Symbols *symbols) {
+    symbols_guard_mutation(symbols);
     for (int32_t oi = 0; oi < symbols->object_count; oi++) {
         ObjectDef *object = &symbols->objects[oi];
         for (int32_t fi = 0; fi < object->field_count; fi++) {
@@ -2636,14 +2639,14 @@ static Span cold_specialized_type_for_template_slot(Arena *arena, FnDef *tmpl, F
 
 static int32_t *cold_clone_i32_array(Arena *arena, const int32_t *src, int32_t count) {
     if (!src || count <= 0) return 0;
-    int32_t *dst = arena_alloc(arena, (size_t)count * sizeof(int32_t));
+    int32_t *dst = arena_alloc_uninit(arena, (size_t)count * sizeof(int32_t));
     memcpy(dst, src, (size_t)count * sizeof(int32_t));
     return dst;
 }
 
 static Span *cold_clone_span_array(Arena *arena, const Span *src, int32_t count) {
     if (!src || count <= 0) return 0;
-    Span *dst = arena_alloc(arena, (size_t)count * sizeof(Span));
+    Span *dst = arena_alloc_uninit(arena, (size_t)count * sizeof(Span));
     memcpy(dst, src, (size_t)count * sizeof(Span));
     return dst;
 }
@@ -2736,9 +2739,13 @@ static BodyIR *cold_clone_specialized_body(Parser *parser, int32_t spec_index) {
 static void cold_materialize_specialized_body_if_needed(Parser *parser, int32_t fn_index) {
     if (!parser || !parser->function_bodies) return;
     if (fn_index < 0 || fn_index >= parser->symbols->function_count) return;
-    if (fn_index < parser->function_body_cap && parser->function_bodies[fn_index]) return;
     FnDef *fn = &parser->symbols->functions[fn_index];
     if (fn->template_index < 0) return;
+    /* A reused caller body would not materialize the specialization. */
+    cold_lower_effects++;
+    if (fn_index < parser->function_body_cap && parser->function_bodies[fn_index]) return;
+    /* The template body is only guaranteed to exist in source order. */
+    if (cold_lower_thread_arena) cold_lower_bail_if_active();
     BodyIR *body = cold_clone_specialized_body(parser, fn_index);
     if (body && fn_index < parser->function_body_cap) parser->function_bodies[fn_index] = body;
 }
@@ -5851,7 +5858,11 @@ void cold_store_object_field_slot(BodyIR *body, int32_t object_slot,
         die("object field store overflow");
     }
     if (body->slot_kind[value_slot] != field->kind) {
-        /* auto-update field kind (for synthetic/fake objects with dynamic fields) */
+        /* auto-update field kind (for synthetic/fake objects with dynamic fields);
+           this mutates Symbols, so a lowering worker hands the body back */
+        cold_lower_bail_if_active();
+        cold_object_field_retypes++;
+        cold_lower_effects++;
         field->kind = body->slot_kind[value_slot];
         field->size = cold_slot_size_for_kind(field->kind);
     }
@@ -10015,6 +10026,8 @@ int32_t parse_match(Parser *parser, BodyIR *body, Locals *locals,
         }
     } else {
         cold_match_eval_target(parser, body, locals, expr, &matched_slot);
+        /* unsupported target: never index slot arrays with -1, arena blocks are recycled */
+        if (matched_slot < 0) matched_slot = body_slot(body, SLOT_VARIANT, 4);
     }
 
     int32_t tag_slot = body_slot(body, SLOT_I32, 4);
@@ -11400,13 +11413,48 @@ int32_t parse_statement(Parser *parser, BodyIR *body, Locals *locals,
     return block;
 }
 
-BodyIR *parse_fn(Parser *parser, int32_t *symbol_index_out) {
+/* Function signature as parsed by parse_fn_header.  Parallel lowering keeps
+   one per deferred body so the body can be lowered later, on any thread. */
+typedef struct ColdFnHeader {
+    int32_t symbol_index;
+    Span fn_name;
+    Span generic_names[4];
+    int32_t generic_count;
+    int32_t arity;
+    Span param_names[COLD_MAX_I32_PARAMS];
+    Span param_types[COLD_MAX_I32_PARAMS];
+    int32_t param_kinds[COLD_MAX_I32_PARAMS];
+    int32_t param_sizes[COLD_MAX_I32_PARAMS];
+    Span ret;
+    bool malformed;
+} ColdFnHeader;
+
+static void cold_fn_set_param_defaults(Symbols *symbols, int32_t symbol_index,
+                                       const bool *has_default,
+                                       const int32_t *default_value,
+                                       int32_t arity) {
+    if (symbol_index < 0 || symbol_index >= symbols->function_count) return;
+    FnDef *fn = &symbols->functions[symbol_index];
+    for (int32_t di = 0; di < arity; di++) {
+        if (fn->param_has_default[di] == has_default[di] &&
+            fn->param_default_value[di] == default_value[di]) continue;
+        symbols_guard_mutation(symbols);
+        fn->param_has_default[di] = has_default[di];
+        fn->param_default_value[di] = default_value[di];
+    }
+}
+
+/* Parse `fn name[G](params): ret` and register the symbol.  Returns true when
+   a body follows, with the parser positioned just after its `=`. */
+static bool parse_fn_header(Parser *parser, ColdFnHeader *header) {
+    memset(header, 0, sizeof(*header));
+    header->symbol_index = -1;
     int32_t fn_start = parser->pos;
     Span import_name = cold_find_fn_c_symbol_attr(parser->source, fn_start, "@importc");
     Span export_name = cold_find_fn_c_symbol_attr(parser->source, fn_start, "@exportc");
     if (!parser_take(parser, "fn")) die("expected fn");
     Span fn_name = parser_token(parser);
-    Span fn_generic_names[4];
+    Span *fn_generic_names = header->generic_names;
     int32_t fn_generic_count = 0;
     if (span_eq(parser_peek(parser), "[")) {
         (void)parser_token(parser);
@@ -11420,16 +11468,19 @@ BodyIR *parse_fn(Parser *parser, int32_t *symbol_index_out) {
         }
         if (!parser_take(parser, "]")) die("expected ] after function generic params");
     }
+    header->fn_name = fn_name;
+    header->generic_count = fn_generic_count;
     if (!parser_take(parser, "(")) {
         /* Skip malformed function declaration */
         parser_line(parser);
-        return 0;
+        header->malformed = true;
+        return false;
     }
     int32_t arity = 0;
-    Span param_names[COLD_MAX_I32_PARAMS];
-    Span param_types[COLD_MAX_I32_PARAMS];
-    int32_t param_kinds[COLD_MAX_I32_PARAMS];
-    int32_t param_sizes[COLD_MAX_I32_PARAMS];
+    Span *param_names = header->param_names;
+    Span *param_types = header->param_types;
+    int32_t *param_kinds = header->param_kinds;
+    int32_t *param_sizes = header->param_sizes;
     bool param_has_default[COLD_MAX_I32_PARAMS] = {0};
     int32_t param_default_value[COLD_MAX_I32_PARAMS] = {0};
     while (!span_eq(parser_peek(parser), ")")) {
@@ -11485,39 +11536,14 @@ BodyIR *parse_fn(Parser *parser, int32_t *symbol_index_out) {
         if (span_eq(parser_peek(parser), ",")) (void)parser_token(parser);
     }
     parser_take(parser, ")");
+    header->arity = arity;
     Span ret = {0};
     if (span_eq(parser_peek(parser), ":")) {
         (void)parser_token(parser);
         ret = parser_scope_type(parser, parser_take_type_span(parser));
     }
-    if (!span_eq(parser_peek(parser), "=")) {
-        int32_t symbol_index;
-        if (parser->import_mode) {
-            /* Look up existing symbol without adding */
-            symbol_index = symbols_find_fn(parser->symbols, fn_name, arity, param_kinds, param_sizes, ret);
-        } else {
-            symbol_index = symbols_add_fn(parser->symbols, fn_name, arity,
-                                          param_kinds, param_sizes, ret);
-        }
-        /* Copy default param values to FnDef */
-        if (symbol_index >= 0 && symbol_index < parser->symbols->function_count) {
-            symbols_set_fn_generics(parser->symbols, symbol_index,
-                                    fn_generic_names, fn_generic_count);
-            symbols_set_fn_param_types(parser->symbols, symbol_index, param_types, arity);
-            for (int32_t di = 0; di < arity; di++) {
-                parser->symbols->functions[symbol_index].param_has_default[di] = param_has_default[di];
-                parser->symbols->functions[symbol_index].param_default_value[di] = param_default_value[di];
-            }
-        }
-        if (import_name.len > 0) symbols_set_fn_link_name(parser->symbols, symbol_index, import_name);
-        if (export_name.len > 0) symbols_set_fn_link_name(parser->symbols, symbol_index, export_name);
-        if (import_name.len > 0 && symbol_index >= 0 && symbol_index < parser->symbols->function_count)
-            parser->symbols->functions[symbol_index].is_external = true;
-        if (symbol_index_out) *symbol_index_out = symbol_index;
-        parser_line(parser);
-        return 0;
-    }
-    (void)parser_token(parser);
+    header->ret = ret;
+    bool has_body = span_eq(parser_peek(parser), "=");
     int32_t symbol_index;
     if (parser->import_mode) {
         /* Look up existing symbol without adding */
@@ -11531,17 +11557,104 @@ BodyIR *parse_fn(Parser *parser, int32_t *symbol_index_out) {
         symbols_set_fn_generics(parser->symbols, symbol_index,
                                 fn_generic_names, fn_generic_count);
         symbols_set_fn_param_types(parser->symbols, symbol_index, param_types, arity);
-        for (int32_t di = 0; di < arity; di++) {
-            parser->symbols->functions[symbol_index].param_has_default[di] = param_has_default[di];
-            parser->symbols->functions[symbol_index].param_default_value[di] = param_default_value[di];
-        }
+        cold_fn_set_param_defaults(parser->symbols, symbol_index,
+                                   param_has_default, param_default_value, arity);
     }
     if (import_name.len > 0) symbols_set_fn_link_name(parser->symbols, symbol_index, import_name);
     if (export_name.len > 0) symbols_set_fn_link_name(parser->symbols, symbol_index, export_name);
-    if (symbol_index_out) *symbol_index_out = symbol_index;
+    header->symbol_index = symbol_index;
+    if (!has_body) {
+        if (import_name.len > 0 && symbol_index >= 0 && symbol_index < parser->symbols->function_count &&
+            !parser->symbols->functions[symbol_index].is_external) {
+            symbols_guard_mutation(parser->symbols);
+            parser->symbols->functions[symbol_index].is_external = true;
+        }
+        parser_line(parser);
+        return false;
+    }
+    (void)parser_token(parser);
+    return true;
+}
+
+static BodyIR *parse_fn_body_lower(Parser *parser, const ColdFnHeader *header);
+static int32_t cold_lower_deferred_body_end(Span source, int32_t body_pos);
+
+/* Key of the body at parser->pos in the compile server's body cache, or 0
+   when it has no clear extent.  It covers everything a lowering without
+   side effects reads: the request, the error recovery mode, the parser
+   context, Symbols, the header, and the text from the header line through
+   the top-level line that ends the body. */
+static uint64_t cold_fn_body_cache_key(Parser *parser, const ColdFnHeader *header,
+                                       int32_t *end_out) {
+    Span source = parser->source;
+    int32_t start = cold_span_offset(source, header->fn_name);
+    int32_t end = start >= 0 ? cold_lower_deferred_body_end(source, parser->pos) : -1;
+    if (end < 0) return 0;
+    while (start > 0 && source.ptr[start - 1] != '\n') start--;
+    int32_t next_end = cold_line_end_from(source, end);
+    uint64_t h = cold_hash_i32(cold_serve_body_context, ColdErrorRecoveryEnabled);
+    h = cold_hash_i32(h, ColdImportBodyCompilationActive);
+    h = cold_hash_i32(h, parser->import_mode);
+    h = cold_hash_span(h, parser->import_alias);
+    h = cold_hash_i32(h, parser->import_source_count);
+    for (int32_t i = 0; i < parser->import_source_count; i++) {
+        h = cold_hash_span(h, parser->import_sources[i].alias);
+        h = cold_fnv1a64_update_cstr(h, parser->import_sources[i].path);
+    }
+    h = cold_fnv1a64_update_cstr(h, parser->source_path ? parser->source_path : "");
+    h = cold_fnv1a64_update_bytes(h, (const uint8_t *)"\0", 1);
+    uint64_t fingerprint = symbols_fingerprint(parser->symbols);
+    h = cold_fnv1a64_update_bytes(h, (const uint8_t *)&fingerprint, sizeof(fingerprint));
+    h = cold_hash_i32(h, header->symbol_index);
+    h = cold_hash_i32(h, header->generic_count);
+    h = cold_hash_spans(h, header->generic_names, header->generic_count);
+    h = cold_hash_i32(h, header->arity);
+    for (int32_t i = 0; i < header->arity; i++) {
+        h = cold_hash_span(h, header->param_names[i]);
+        h = cold_hash_span(h, header->param_types[i]);
+        h = cold_hash_i32(h, header->param_kinds[i]);
+        h = cold_hash_i32(h, header->param_sizes[i]);
+    }
+    h = cold_hash_span(h, header->ret);
+    h = cold_hash_i32(h, parser->pos - start);
+    h = cold_hash_span(h, span_sub(source, start, next_end));
+    *end_out = end;
+    return h ? h : 1;
+}
+
+/* Lower the body that follows a parse_fn_header into a fresh BodyIR,
+   recording one "parse" trace span per function.  In a compile server
+   child the body is first looked up by content key; a lowering that had no
+   side effects is offered back to the server for later builds. */
+static BodyIR *parse_fn_body(Parser *parser, const ColdFnHeader *header) {
+    uint64_t trace_start = cold_trace_begin();
+    int32_t body_pos = parser->pos;
+    int32_t end_pos = -1;
+    uint64_t key = cold_serve_body_context ? cold_fn_body_cache_key(parser, header, &end_pos) : 0;
+    int32_t consumed = 0;
+    BodyIR *body = key ? cold_serve_body_lookup(key, parser->arena, &consumed) : 0;
+    if (body) {
+        parser->pos = body_pos + consumed;
+    } else {
+        uint32_t effects = cold_lower_effects;
+        body = parse_fn_body_lower(parser, header);
+        if (key && body && cold_lower_effects == effects && parser->pos <= end_pos)
+            cold_serve_body_offer(key, body, parser->pos - body_pos);
+    }
+    cold_trace_end("parse", header->fn_name, trace_start);
+    return body;
+}
 
-    /* Skip body parsing for import_mode: saved 29ms but breaks cross-module calls.
-       Reverted — need call-graph analysis to skip only uncalled imports. */
+static BodyIR *parse_fn_body_lower(Parser *parser, const ColdFnHeader *header) {
+    Span fn_name = header->fn_name;
+    const Span *fn_generic_names = header->generic_names;
+    int32_t fn_generic_count = header->generic_count;
+    int32_t arity = header->arity;
+    const Span *param_names = header->param_names;
+    const Span *param_types = header->param_types;
+    const int32_t *param_kinds = header->param_kinds;
+    const int32_t *param_sizes = header->param_sizes;
+    Span ret = header->ret;
 
     BodyIR *body = body_new(parser->arena);
     body->return_kind = cold_return_kind_from_span(parser->symbols, ret);
@@ -11667,3 +11780,312 @@ BodyIR *parse_fn(Parser *parser, int32_t *symbol_index_out) {
     }
     return body;
 }
+
+BodyIR *parse_fn(Parser *parser, int32_t *symbol_index_out) {
+    ColdFnHeader header;
+    bool has_body = parse_fn_header(parser, &header);
+    if (header.malformed) return 0;
+    if (symbol_index_out) *symbol_index_out = header.symbol_index;
+    if (!has_body) return 0;
+    return parse_fn_body(parser, &header);
+}
+
+/* ================================================================
+ * Module declarations with parallel function-body lowering
+ *
+ * Types, consts and function headers are processed serially in source order.
+ * Bodies that can be lowered out of order are deferred into a batch; a batch
+ * is flushed before anything that could change Symbols (a type or const
+ * declaration, a header that would refine a signature, a body that must stay
+ * serial) and at the end of the module.  A flush freezes Symbols and the
+ * shared arenas, lowers the batch on BACKEND_JOBS workers with thread-local
+ * arenas, then commits the results in source order.  A worker that needs to
+ * mutate Symbols or hits die() bails; that body, and every body after the
+ * first one that mutated Symbols during the commit, is re-lowered serially,
+ * so the BodyIR matches the serial path exactly.
+ * ================================================================ */
+typedef struct ColdLowerJob {
+    ColdFnHeader header;
+    int32_t body_pos;   /* just after the `=` of the header */
+    int32_t end_pos;    /* start of the next top-level line */
+    BodyIR *body;       /* worker result; 0 when the worker bailed */
+} ColdLowerJob;
+
+typedef struct ColdLowerWorker {
+    Parser parser;
+    Arena *arena;
+    ColdLowerJob *jobs;
+    int32_t job_count;
+    int32_t *next_job;
+} ColdLowerWorker;
+
+typedef struct ColdModuleDecls {
+    Parser *parser;
+    bool store_empty;      /* store 0 for body-less declarations */
+    int32_t jobs;
+    ColdLowerJob *pending;
+    int32_t pending_count;
+    int32_t pending_cap;
+    int32_t first_function;
+    int32_t main_function;
+} ColdModuleDecls;
+
+static bool cold_lower_line_blank(Span line) {
+    Span trimmed = span_trim(line);
+    if (trimmed.len == 0) return true;
+    if (trimmed.ptr[0] == '#') return true;
+    return trimmed.len >= 2 && trimmed.ptr[0] == '/' && trimmed.ptr[1] == '/';
+}
+
+static bool cold_lower_line_has_block_text(Span line) {
+    if (cold_line_has_triple_quote(line)) return true;
+    for (int32_t i = 0; i + 1 < line.len; i++) {
+        if (line.ptr[i] == '/' && line.ptr[i + 1] == '*') return true;
+    }
+    return false;
+}
+
+static bool cold_lower_line_starts_decl(Span line) {
+    Span trimmed = span_trim(line);
+    static const char *const words[] = {"fn", "type", "const"};
+    for (int32_t i = 0; i < 3; i++) {
+        int32_t n = (int32_t)strlen(words[i]);
+        if (trimmed.len >= n && memcmp(trimmed.ptr, words[i], (size_t)n) == 0 &&
+            (trimmed.len == n || !cold_ident_char(trimmed.ptr[n]))) return true;
+    }
+    return false;
+}
+
+/* End of a body that starts at body_pos, or -1 when the body must be lowered
+   in place: it contains block comments or triple-quoted strings, its block
+   is not indented, it is followed by a top-level line that is not a plain
+   declaration, or it has nested declaration-like lines that the top-level
+   loop would pick up if the body ended early. */
+static int32_t cold_lower_deferred_body_end(Span source, int32_t body_pos) {
+    int32_t pos = body_pos;
+    int32_t line_end = cold_line_end_from(source, pos);
+    Span rest = span_sub(source, pos, line_end);
+    if (cold_lower_line_has_block_text(rest)) return -1;
+    bool inline_body = !cold_lower_line_blank(rest);
+    bool saw_line = false;
+    pos = line_end < source.len ? line_end + 1 : line_end;
+    while (pos < source.len) {
+        int32_t start = pos;
+        int32_t end = cold_line_end_from(source, pos);
+        pos = end < source.len ? end + 1 : end;
+        Span line = span_sub(source, start, end);
+        if (cold_lower_line_blank(line)) continue;
+        if (cold_lower_line_has_block_text(line)) return -1;
+        if (cold_line_top_level(line)) {
+            if (!inline_body && !saw_line) return -1;
+            uint8_t c = line.ptr[0];
+            if (!cold_ident_char(c) && c != '@') return -1;
+            return start;
+        }
+        if (cold_lower_line_starts_decl(line)) return -1;
+        saw_line = true;
+    }
+    return (inline_body || saw_line) ? source.len : -1;
+}
+
+static void cold_module_store_body(ColdModuleDecls *decls, int32_t symbol_index,
+                                   BodyIR *body) {
+    Parser *parser = decls->parser;
+    if (symbol_index < 0 || symbol_index >= parser->function_body_cap) return;
+    if (!body) {
+        if (decls->store_empty) parser->function_bodies[symbol_index] = 0;
+        return;
+    }
+    parser->function_bodies[symbol_index] = body;
+    if (decls->first_function < 0) decls->first_function = symbol_index;
+    if (span_eq(parser->symbols->functions[symbol_index].name, "main"))
+        decls->main_function = symbol_index;
+}
+
+/* Lower one deferred body on a worker.  Returns 0 when the worker bailed
+   out (see cold_lower_bail_if_active) or the body overran its end.  Nothing
+   that is live across sigsetjmp is written before the jump back. */
+static BodyIR *cold_lower_job_on_worker(ColdLowerWorker *w, ColdLowerJob *job) {
+    Parser parser = w->parser;
+    parser.arena = w->arena;
+    parser.pos = job->body_pos;
+    BodyIR *volatile body = 0;
+    sigjmp_buf bail;
+    cold_lower_bail = &bail;
+    if (sigsetjmp(bail, 1) == 0) {
+        body = parse_fn_body(&parser, &job->header);
+        if (parser.pos > job->end_pos) body = 0;
+    }
+    cold_lower_bail = 0;
+    return body;
+}
+
+static void *cold_lower_worker_run(void *arg) {
+    ColdLowerWorker *w = (ColdLowerWorker *)arg;
+    cold_lower_thread_arena = w->arena;
+    for (;;) {
+        int32_t i = __atomic_fetch_add(w->next_job, 1, __ATOMIC_RELAXED);
+        if (i >= w->job_count) break;
+        w->jobs[i].body = cold_lower_job_on_worker(w, &w->jobs[i]);
+    }
+    cold_lower_thread_arena = 0;
+    cold_arena_stats_fold();
+    return NULL;
+}
+
+static BodyIR *cold_lower_job_serial(ColdModuleDecls *decls, ColdLowerJob *job) {
+    Parser *parser = decls->parser;
+    int32_t saved = parser->pos;
+    parser->pos = job->body_pos;
+    BodyIR *body = parse_fn_body(parser, &job->header);
+    if (parser->pos > job->end_pos)
+        die("cold parallel lowering: function body runs past a top-level line (retry with BACKEND_JOBS=1)");
+    parser->pos = saved;
+    return body;
+}
+
+static void cold_module_flush(ColdModuleDecls *decls) {
+    int32_t count = decls->pending_count;
+    if (count == 0) return;
+    decls->pending_count = 0;
+    Parser *parser = decls->parser;
+    Symbols *symbols = parser->symbols;
+    ColdLowerJob *jobs = decls->pending;
+    int32_t workers = decls->jobs < count ? decls->jobs : count;
+    if (workers > 1) {
+        ColdLowerWorker ctx[16];
+        pthread_t threads[16];
+        int32_t next_job = 0;
+        bool parser_arena_frozen = parser->arena->frozen;
+        bool symbols_arena_frozen = symbols->arena->frozen;
+        if (cold_serve_body_context) (void)symbols_fingerprint(symbols);
+        symbols->frozen = true;
+        parser->arena->frozen = true;
+        symbols->arena->frozen = true;
+        for (int32_t w = 0; w < workers; w++) {
+            ctx[w] = (ColdLowerWorker){
+                .parser = *parser,
+                .arena = cold_worker_arena(cold_lower_arena_cache, w),
+                .jobs = jobs,
+                .job_count = count,
+                .next_job = &next_job,
+            };
+            if (pthread_create(&threads[w], NULL, cold_lower_worker_run, &ctx[w]) != 0)
+                die("lowering worker create failed");
+        }
+        for (int32_t w = 0; w < workers; w++) {
+            if (pthread_join(threads[w], NULL) != 0) die("lowering worker join failed");
+        }
+        symbols->frozen = false;
+        parser->arena->frozen = parser_arena_frozen;
+        symbols->arena->frozen = symbols_arena_frozen;
+        if (workers > cold_lowering_active_workers) cold_lowering_active_workers = workers;
+    } else {
+        for (int32_t i = 0; i < count; i++) jobs[i].body = 0;
+    }
+    bool dirty = false;
+    for (int32_t i = 0; i < count; i++) {
+        ColdLowerJob *job = &jobs[i];
+        BodyIR *body = job->body;
+        if (body && !dirty) {
+            body->arena = parser->arena;
+            cold_lowering_parallel_functions++;
+        } else {
+            uint32_t epoch = symbols->mutation_epoch;
+            body = cold_lower_job_serial(decls, job);
+            if (workers > 1) cold_lowering_serial_fallbacks++;
+            if (symbols->mutation_epoch != epoch) dirty = true;
+        }
+        cold_module_store_body(decls, job->header.symbol_index, body);
+    }
+}
+
+static void cold_module_defer(ColdModuleDecls *decls, const ColdFnHeader *header,
+                              int32_t body_pos, int32_t end_pos) {
+    if (decls->pending_count >= decls->pending_cap) {
+        int32_t next = decls->pending_cap ? decls->pending_cap * 2 : 64;
+        ColdLowerJob *fresh = arena_alloc(decls->parser->arena,
+                                          (size_t)next * sizeof(ColdLowerJob));
+        if (decls->pending_count > 0)
+            memcpy(fresh, decls->pending, (size_t)decls->pending_count * sizeof(ColdLowerJob));
+        decls->pending = fresh;
+        decls->pending_cap = next;
+    }
+    ColdLowerJob *job = &decls->pending[decls->pending_count++];
+    job->header = *header;
+    job->body_pos = body_pos;
+    job->end_pos = end_pos;
+    job->body = 0;
+}
+
+/* Header of the fn at parser->pos while a batch is pending: Symbols stay
+   frozen, and a header that would change them flushes the batch first. */
+static bool cold_module_fn_header(ColdModuleDecls *decls, ColdFnHeader *header) {
+    Parser *parser = decls->parser;
+    if (decls->pending_count == 0) return parse_fn_header(parser, header);
+    volatile int32_t saved = parser->pos;
+    sigjmp_buf bail;
+    sigjmp_buf *volatile outer = cold_lower_bail;
+    volatile bool has_body = false;
+    parser->symbols->frozen = true;
+    cold_lower_bail = &bail;
+    if (sigsetjmp(bail, 1) == 0) {
+        has_body = parse_fn_header(parser, header);
+        cold_lower_bail = outer;
+        parser->symbols->frozen = false;
+        return has_body;
+    }
+    cold_lower_bail = outer;
+    parser->symbols->frozen = false;
+    parser->pos = saved;
+    cold_module_flush(decls);
+    return parse_fn_header(parser, header);
+}
+
+void cold_parse_module_decls(Parser *parser, bool store_empty,
+                             int32_t *first_function, int32_t *main_function) {
+    ColdModuleDecls decls = {0};
+    decls.parser = parser;
+    decls.store_empty = store_empty;
+    decls.jobs = cold_jobs_from_env();
+    decls.first_function = -1;
+    decls.main_function = -1;
+    Span source = parser->source;
+    while (parser->pos < source.len) {
+        parser_ws(parser);
+        if (parser->pos >= source.len) break;
+        Span next = parser_peek(parser);
+        if (span_eq(next, "type")) {
+            cold_module_flush(&decls);
+            parse_type(parser);
+        } else if (span_eq(next, "const")) {
+            cold_module_flush(&decls);
+            parse_const(parser);
+        } else if (span_eq(next, "fn")) {
+            ColdFnHeader header;
+            bool has_body = cold_module_fn_header(&decls, &header);
+            if (header.malformed) continue;
+            if (!has_body) {
+                if (decls.pending_count > 0 && store_empty) cold_module_flush(&decls);
+                cold_module_store_body(&decls, header.symbol_index, 0);
+                continue;
+            }
+            int32_t end_pos = decls.jobs > 1
+                ? cold_lower_deferred_body_end(source, parser->pos)
+                : -1;
+            if (end_pos >= 0) {
+                cold_module_defer(&decls, &header, parser->pos, end_pos);
+                parser->pos = end_pos;
+                continue;
+            }
+            cold_module_flush(&decls);
+            BodyIR *body = parse_fn_body(parser, &header);
+            cold_module_store_body(&decls, header.symbol_index, body);
+        } else {
+            parser_line(parser);
+        }
+    }
+    cold_module_flush(&decls);
+    if (first_function) *first_function = decls.first_function;
+    if (main_function) *main_function = decls.main_function;
+}
@@ -69,6 +69,8 @@ void symbols_refine_object_layouts(Symbols *symbols);
 void parse_type(Parser *parser);
 void parse_const(Parser *parser);
 BodyIR *parse_fn(Parser *parser, int32_t *symbol_index_out);
+void cold_parse_module_decls(Parser *parser, bool store_empty,
+                             int32_t *first_function, int32_t *main_function);
 
 int32_t parse_expr(Parser *parser, BodyIR *body, Locals *locals, int32_t *kind);
 int32_t parse_term(Parser *parser, BodyIR *body, Locals *locals, int32_t *kind);
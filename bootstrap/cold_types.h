@@ -56,6 +56,8 @@ struct ColdImportSource;
  * Arena
  * ================================================================ */
 #define ARENA_PAGE 65536
+#define ARENA_MIN_CLASS 6          /* 64-byte blocks */
+#define ARENA_SIZE_CLASSES 32
 
 typedef struct ArenaPage {
     struct ArenaPage *next;
@@ -74,6 +76,10 @@ typedef struct Arena {
     uint64_t phase_start_us[8];
     const char *phase_name[8];
     int32_t phase_page_count[8];   /* pages at phase start */
+    bool frozen;                   /* shared by parallel lowering workers */
+    /* Outgrown arrays parked by arena_grow, by power-of-two size class.
+       Every block in free_list[c] is at least (1 << c) bytes. */
+    void *free_list[ARENA_SIZE_CLASSES];
 } Arena;
 
 /* ================================================================
@@ -556,6 +562,8 @@ typedef struct Symbols {
     int32_t global_count;
     int32_t global_cap;
     Arena *arena;
+    bool frozen;  /* set while function bodies are lowered in parallel */
+    uint32_t mutation_epoch;
 } Symbols;
 
 typedef struct Local {
@@ -671,6 +679,7 @@ typedef struct ColdCompileStats {
     int32_t csg_lowering;
     int32_t csg_statement_count;
     int32_t code_words;
+    int32_t rodata_bytes;
     int32_t param_count;
     int32_t abi_register_params;
     int32_t abi_stack_params;
@@ -699,7 +708,7 @@ typedef struct ColdCompileStats {
 
 /* ================================================================
  * ================================================================ */
-extern BodyIR *cold_current_parsing_body;
+extern _Thread_local BodyIR *cold_current_parsing_body;
 /* ColdArgv0 is a char ** global set in main() for self-binary materialize */
 extern char **ColdArgv0;
 
@@ -708,6 +717,8 @@ extern char **ColdArgv0;
 
 /* Arena */
 void *arena_alloc(Arena *a, size_t size);
+void *arena_alloc_uninit(Arena *a, size_t size);
+void *arena_grow(Arena *a, void *old, size_t old_size, size_t keep_size, size_t new_size);
 
 /* Die / error */
 void die(const char *msg);
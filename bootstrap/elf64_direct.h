@@ -4,7 +4,8 @@
  * or x86_64 linux targets.  Symbols + relocations for external linkage.
  *
  * Reader: elf64_read_object() extracts .text + symbol table from a .o file.
- * Writer: elf64_write_object() / elf_write_exec() produce .o / executable.
+ * Writer: elf64_write_object() / elf_write_exec_segments() produce .o /
+ * executable; elf_write_exec() is the text-only form.
  */
 
 #include <stdio.h>
@@ -45,6 +46,22 @@
 #define STT_FUNC         2
 #define ELF64_ST_INFO(b,t) (((b) << 4) + ((t) & 0x0F))
 
+/* Program header types and flags */
+#define PT_LOAD          1
+#define PT_GNU_STACK     0x6474e551
+#define PF_X             0x1
+#define PF_W             0x2
+#define PF_R             0x4
+
+/* elf_write_exec layout: code follows the ELF header and room for every
+   program header the writer can emit, so its address does not depend on
+   which segments are present.  rodata and data each start on a fresh page. */
+#define ELF_EXEC_BASE_VADDR  0x400000
+#define ELF_EXEC_PAGE        0x1000
+#define ELF_EXEC_MAX_PHDRS   4
+#define ELF_EXEC_CODE_OFFSET (64 + 56 * ELF_EXEC_MAX_PHDRS)
+#define ELF_EXEC_CODE_VADDR  (ELF_EXEC_BASE_VADDR + ELF_EXEC_CODE_OFFSET)
+
 /* ARM64 relocations */
 #define R_AARCH64_CALL26     283
 #define R_AARCH64_ADR_PREL_PG_HI21  275
@@ -328,21 +345,74 @@ static bool elf64_write_object(const char *path,
     return true;
 }
 
-/* Minimal ELF64 static executable writer. Maps headers + code in one PT_LOAD.
-   Code starts at 0x400000 + code_off. No dynamic linking. */
-static bool elf_write_exec(const char *path, const uint32_t *code,
-                            int32_t code_words, uint16_t machine) {
-    int32_t code_sz = code_words * 4;
-    int32_t hdr_sz = 64;
-    int32_t phdr_sz = 56; /* one PT_LOAD */
-    int32_t phdr_off = hdr_sz;
-    int32_t code_off = hdr_sz + phdr_sz;
-    uint64_t entry = 0x400000 + code_off;
-    int32_t total_sz = code_off + code_sz;
+static uint64_t elf_exec_page_align(uint64_t v) {
+    return (v + ELF_EXEC_PAGE - 1) & ~(uint64_t)(ELF_EXEC_PAGE - 1);
+}
 
-    uint8_t *buf = (uint8_t *)calloc(1, total_sz);
+/* Virtual address of the rodata segment that follows code_bytes of text. */
+static uint64_t elf_exec_rodata_vaddr(int32_t code_bytes) {
+    return ELF_EXEC_BASE_VADDR +
+           elf_exec_page_align((uint64_t)ELF_EXEC_CODE_OFFSET + (uint64_t)code_bytes);
+}
+
+/* Virtual address of the data segment behind the text and rodata. */
+static uint64_t elf_exec_data_vaddr(int32_t code_bytes, int32_t rodata_size) {
+    uint64_t text_end = (uint64_t)ELF_EXEC_CODE_OFFSET + (uint64_t)code_bytes;
+    uint64_t end = rodata_size > 0 ? elf_exec_page_align(text_end) + (uint64_t)rodata_size : text_end;
+    return ELF_EXEC_BASE_VADDR + elf_exec_page_align(end);
+}
+
+static void elf_exec_phdr(uint8_t *ph, uint32_t type, uint32_t flags,
+                          uint64_t offset, uint64_t vaddr,
+                          uint64_t filesz, uint64_t memsz, uint64_t align) {
+    uint64_t f[7] = {offset, vaddr, vaddr, filesz, memsz, align, 0};
+    memcpy(ph, &type, 4);
+    memcpy(ph + 4, &flags, 4);
+    memcpy(ph + 8, f, 48);
+}
+
+/* ELF64 static executable writer with W^X segments.  Headers and code are
+   one R+X PT_LOAD at 0x400000; rodata (R) and data (RW, the PGO counters)
+   follow, each page-aligned in both file and memory so no page is both
+   writable and executable.  PT_GNU_STACK marks the stack non-executable.
+   Empty rodata or data segments are omitted.  No dynamic linking. */
+static bool elf_write_exec_segments(const char *path,
+                                    const uint32_t *code, int32_t code_words,
+                                    const uint8_t *rodata, int32_t rodata_size,
+                                    const uint8_t *data, int32_t data_size,
+                                    uint16_t machine) {
+    uint64_t code_off = ELF_EXEC_CODE_OFFSET;
+    uint64_t text_end = code_off + (uint64_t)code_words * 4;
+    uint64_t rodata_off = elf_exec_page_align(text_end);
+    uint64_t rodata_end = rodata_off + (uint64_t)(rodata_size > 0 ? rodata_size : 0);
+    uint64_t data_off = elf_exec_page_align(rodata_size > 0 ? rodata_end : text_end);
+    bool has_data = data_size > 0;
+    uint64_t total_sz = has_data ? data_off + (uint64_t)data_size
+                      : rodata_size > 0 ? rodata_end : text_end;
+
+    uint8_t *buf = (uint8_t *)calloc(1, (size_t)total_sz);
     if (!buf) return false;
     uint32_t *w = (uint32_t *)buf;
+    uint64_t entry = ELF_EXEC_BASE_VADDR + code_off;
+
+    /* Program headers */
+    int32_t phnum = 0;
+    uint8_t *ph = buf + 64;
+    elf_exec_phdr(ph + 56 * phnum++, PT_LOAD, PF_R | PF_X, 0, ELF_EXEC_BASE_VADDR,
+                  text_end, text_end, ELF_EXEC_PAGE);
+    if (rodata_size > 0) {
+        elf_exec_phdr(ph + 56 * phnum++, PT_LOAD, PF_R, rodata_off,
+                      ELF_EXEC_BASE_VADDR + rodata_off,
+                      (uint64_t)rodata_size, (uint64_t)rodata_size, ELF_EXEC_PAGE);
+        memcpy(buf + rodata_off, rodata, (size_t)rodata_size);
+    }
+    if (has_data) {
+        elf_exec_phdr(ph + 56 * phnum++, PT_LOAD, PF_R | PF_W, data_off,
+                      ELF_EXEC_BASE_VADDR + data_off,
+                      (uint64_t)data_size, (uint64_t)data_size, ELF_EXEC_PAGE);
+        memcpy(buf + data_off, data, (size_t)data_size);
+    }
+    elf_exec_phdr(ph + 56 * phnum++, PT_GNU_STACK, PF_R | PF_W, 0, 0, 0, 0, 16);
 
     /* ELF Header */
     w[0] = ELF64_MAGIC;
@@ -352,50 +422,36 @@ static bool elf_write_exec(const char *path, const uint32_t *code,
     w[5] = 1;                        /* e_version */
     w[6] = (uint32_t)entry;          /* e_entry */
     w[7] = (uint32_t)(entry >> 32);
-    w[8] = (uint32_t)phdr_off;       /* e_phoff */
+    w[8] = 64;                       /* e_phoff */
     w[9] = 0;
     w[10] = 0;                       /* e_shoff */
     w[11] = 0;
     w[12] = 0;                       /* e_flags (4 bytes at 0x30) */
     /* e_ehsize (2) + e_phentsize (2) */
     buf[0x34] = 64; buf[0x35] = 0;
-    buf[0x36] = (uint8_t)phdr_sz; buf[0x37] = (uint8_t)(phdr_sz >> 8);
+    buf[0x36] = 56; buf[0x37] = 0;
     /* e_phnum (2) + e_shentsize (2) */
-    buf[0x38] = 1; buf[0x39] = 0;
+    buf[0x38] = (uint8_t)phnum; buf[0x39] = 0;
     buf[0x3A] = 0; buf[0x3B] = 0;
     /* e_shnum (2) + e_shstrndx (2) */
     buf[0x3C] = 0; buf[0x3D] = 0;
     buf[0x3E] = 0; buf[0x3F] = 0;
 
-    /* Program Header: PT_LOAD covering headers + code.
-       p_offset and p_vaddr must be congruent modulo p_align. */
-    {
-        uint32_t *ph = (uint32_t *)(buf + phdr_off);
-        ph[0] = 1;                    /* p_type = PT_LOAD */
-        ph[1] = 5;                    /* p_flags = PF_R | PF_X */
-        ph[2] = 0;                    /* p_offset (low) */
-        ph[3] = 0;                    /* p_offset (high) */
-        ph[4] = (uint32_t)0x400000;   /* p_vaddr (low) */
-        ph[5] = 0;                    /* p_vaddr (high) */
-        ph[6] = (uint32_t)0x400000;   /* p_paddr (low) */
-        ph[7] = 0;                    /* p_paddr (high) */
-        ph[8] = (uint32_t)total_sz;   /* p_filesz (low) */
-        ph[9] = 0;                    /* p_filesz (high) */
-        ph[10] = (uint32_t)total_sz;  /* p_memsz (low) */
-        ph[11] = 0;                   /* p_memsz (high) */
-        ph[12] = 0x1000;              /* p_align (low) */
-        ph[13] = 0;                   /* p_align (high) */
-    }
-
     /* Copy code words */
-    memcpy(buf + code_off, code, code_sz);
+    memcpy(buf + code_off, code, (size_t)code_words * 4);
 
     int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0755);
     if (fd < 0) { free(buf); return false; }
-    write(fd, buf, total_sz);
+    bool ok = write(fd, buf, (size_t)total_sz) == (ssize_t)total_sz;
     close(fd);
     free(buf);
-    return true;
+    return ok;
+}
+
+/* Text-only executable: one R+X PT_LOAD plus PT_GNU_STACK. */
+static bool elf_write_exec(const char *path, const uint32_t *code,
+                            int32_t code_words, uint16_t machine) {
+    return elf_write_exec_segments(path, code, code_words, 0, 0, 0, 0, machine);
 }
 
 /* Minimal ELF64 .o reader for provider archive linking.
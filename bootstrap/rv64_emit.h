@@ -1,6 +1,7 @@
-/* rv64_emit.h -- RISC-V 64-bit (RV64G) instruction encoder for cold compiler.
+/* rv64_emit.h -- RISC-V 64-bit (RV64GC + Zba/Zbb) instruction encoder for cold compiler.
  *
- * Fixed 32-bit instruction encoding.  Uses standard RISC-V instruction formats.
+ * Codegen emits fixed 32-bit encodings; the C extension forms at the end of
+ * this file are applied afterwards by rv_compress() on finished code.
  *
  * Register encoding: x0=zero, x1=ra, x2=sp, x3=gp, x4=tp, x5-x7=t0-t2,
  *   x8=s0/fp, x9=s1, x10-x17=a0-a7, x18-x27=s2-s11, x28-x31=t3-t6
@@ -43,29 +44,29 @@
      ((uint32_t)(op) & 0x7F))
 
 /* B-type: imm[12|10:5] | rs2 | rs1 | funct3 | imm[4:1|11] | opcode */
-#define RV_B(rs1, rs2, imm, f3, op)                       \
-    ((((uint32_t)(imm) & 0x800) << 20) |  /* imm[11] */    \
-     (((uint32_t)(imm) & 0x7E0) << 20) |  /* imm[10:5] */  \
-     (((uint32_t)(rs2) & 0x1F) << 20) |                    \
-     (((uint32_t)(rs1) & 0x1F) << 15) |                    \
-     (((uint32_t)(f3) & 0x07) << 12) |                     \
-     (((uint32_t)(imm) & 0x1E) << 7)  |  /* imm[4:1] */    \
-     (((uint32_t)(imm) & 0x1) << 7)   |  /* imm[11] bit 0? */  \
+#define RV_B(rs1, rs2, imm, f3, op)                        \
+    (((((uint32_t)(imm) >> 12) & 0x1) << 31) |              \
+     ((((uint32_t)(imm) >> 5) & 0x3F) << 25) |              \
+     (((uint32_t)(rs2) & 0x1F) << 20) |                     \
+     (((uint32_t)(rs1) & 0x1F) << 15) |                     \
+     (((uint32_t)(f3) & 0x07) << 12) |                      \
+     ((((uint32_t)(imm) >> 1) & 0xF) << 8) |                \
+     ((((uint32_t)(imm) >> 11) & 0x1) << 7) |               \
      ((uint32_t)(op) & 0x7F))
 
 /* U-type: imm[31:12] | rd | opcode */
 #define RV_U(rd, imm, op) \
-    ((((uint32_t)(imm) & 0xFFFFF000u) >> 12) | \
-     (((uint32_t)(rd) & 0x1F) << 7) |          \
+    (((uint32_t)(imm) & 0xFFFFF000u) | \
+     (((uint32_t)(rd) & 0x1F) << 7) |  \
      ((uint32_t)(op) & 0x7F))
 
 /* J-type: imm[20|10:1|11|19:12] | rd | opcode */
-#define RV_J(rd, imm, op)                             \
-    ((((uint32_t)(imm) & 0x100000u) >> 20) |          \
-     (((uint32_t)(imm) & 0x7FE)   << 20)  |           \
-     (((uint32_t)(imm) & 0x800)   << 9)   |           \
-     (((uint32_t)(imm) & 0xFF000u) >> 12)  |          \
-     (((uint32_t)(rd) & 0x1F) << 7)  |                \
+#define RV_J(rd, imm, op)                                  \
+    (((((uint32_t)(imm) >> 20) & 0x1) << 31) |              \
+     ((((uint32_t)(imm) >> 1) & 0x3FF) << 21) |             \
+     ((((uint32_t)(imm) >> 11) & 0x1) << 20) |              \
+     ((uint32_t)(imm) & 0xFF000u) |                         \
+     (((uint32_t)(rd) & 0x1F) << 7) |                       \
      ((uint32_t)(op) & 0x7F))
 
 /* Opcodes */
@@ -149,7 +150,7 @@ static uint32_t rv_mulw(int rd, int rs1, int rs2) {
 }
 /* DIVW rd, rs1, rs2 (signed 32-bit) */
 static uint32_t rv_divw(int rd, int rs1, int rs2) {
-    return RV_R(rd, rs1, rs2, F3_SR, 0x01, RV_OP32);
+    return RV_R(rd, rs1, rs2, F3_XOR, 0x01, RV_OP32);
 }
 /* SLLI rd, rs1, shamt (shift left logical immediate) */
 static uint32_t rv_slli(int rd, int rs1, int shamt) {
@@ -193,7 +194,7 @@ static uint32_t rv_lw(int rd, int rs1, int16_t imm) {
 }
 /* LWU rd, imm12(rs1) -- 32-bit unsigned load */
 static uint32_t rv_lwu(int rd, int rs1, int16_t imm) {
-    return RV_I(rd, rs1, (uint32_t)(imm & 0xFFF), F3_HALF + 2, RV_LOAD);
+    return RV_I(rd, rs1, (uint32_t)(imm & 0xFFF), 6, RV_LOAD);
 }
 /* SD rs2, imm12(rs1) -- 64-bit store */
 static uint32_t rv_sd(int rs2, int rs1, int16_t imm) {
@@ -236,41 +237,49 @@ static uint32_t rv_auipc(int rd, int32_t imm) {
     return RV_U(rd, (uint32_t)(imm & 0xFFFFF000u), RV_AUIPC);
 }
 
-/* Combined LI macro: LUI + ADDI for loading 32-bit immediates */
+/* Combined LI macro: LUI + ADDIW for loading 32-bit immediates */
 static void rv_li(uint32_t *code, int *pos, int rd, int32_t imm) {
     if (imm >= -2048 && imm <= 2047) {
         code[(*pos)++] = rv_addi(rd, RV_ZERO, (int16_t)imm);
     } else {
-        int32_t upper = (imm + 0x800) & 0xFFFFF000;
+        int32_t upper = (int32_t)(((uint32_t)imm + 0x800u) & 0xFFFFF000u);
         code[(*pos)++] = rv_lui(rd, upper);
-        int16_t lower = (int16_t)(imm - upper);
+        int16_t lower = (int16_t)(int32_t)((uint32_t)imm - (uint32_t)upper);
         if (lower != 0)
             code[(*pos)++] = rv_addiw(rd, rd, lower);
     }
 }
 
-/* Load 64-bit immediate (multi-instruction sequence) */
+/* Load 64-bit immediate: the sign-extended low 12 bits are peeled off and
+   the rest is built recursively, then shifted into place. */
 static void rv_li64(uint32_t *code, int *pos, int rd, uint64_t imm) {
-    int32_t lo = (int32_t)(imm & 0xFFFFFFFFu);
-    int32_t hi = (int32_t)((imm >> 32) & 0xFFFFFFFFu);
-    rv_li(code, pos, rd, lo);
-    if (hi != 0) {
-        /* Use SLLI + ADDI + SLLI + ADDI to construct upper 32 bits */
-        code[(*pos)++] = rv_slli(rd, rd, 32);
+    int64_t v = (int64_t)imm;
+    if (v >= INT32_MIN && v <= INT32_MAX) {
+        rv_li(code, pos, rd, (int32_t)v);
+        return;
     }
+    int64_t lo = (int64_t)((imm & 0xFFFu) ^ 0x800u) - 0x800;
+    uint64_t hi = (imm - (uint64_t)lo);
+    int shift = 0;
+    while (shift < 63 && ((hi >> shift) & 1u) == 0) shift++;
+    int64_t rest = (int64_t)hi >> shift;
+    rv_li64(code, pos, rd, (uint64_t)rest);
+    code[(*pos)++] = rv_slli(rd, rd, shift);
+    if (lo != 0)
+        code[(*pos)++] = rv_addi(rd, rd, (int16_t)lo);
 }
 
 /* REMW rd, rs1, rs2 (signed 32-bit remainder) */
 static uint32_t rv_remw(int rd, int rs1, int rs2) {
-    return RV_R(rd, rs1, rs2, F3_SR, 0x07, RV_OP32);
+    return RV_R(rd, rs1, rs2, F3_OR, 0x01, RV_OP32);
 }
 /* DIV rd, rs1, rs2 (signed 64-bit) */
 static uint32_t rv_div(int rd, int rs1, int rs2) {
-    return RV_R(rd, rs1, rs2, F3_SR, 0x01, RV_OP);
+    return RV_R(rd, rs1, rs2, F3_XOR, 0x01, RV_OP);
 }
 /* REM rd, rs1, rs2 (signed 64-bit remainder) */
 static uint32_t rv_rem(int rd, int rs1, int rs2) {
-    return RV_R(rd, rs1, rs2, F3_SR, 0x07, RV_OP);
+    return RV_R(rd, rs1, rs2, F3_OR, 0x01, RV_OP);
 }
 /* SRLI rd, rs1, shamt (shift right logical immediate) */
 static uint32_t rv_srli(int rd, int rs1, int shamt) {
@@ -360,10 +369,9 @@ static uint32_t rv_sb(int rs2, int rs1, int16_t imm) {
 static uint32_t rv_sh(int rs2, int rs1, int16_t imm) {
     return RV_S(rs2, rs1, (uint32_t)(imm & 0xFFF), 1, RV_STORE);
 }
-/* MULW rd, rs1, rs2 (exists in original) */
 /* DIVUW rd, rs1, rs2 (unsigned 32-bit) */
 static uint32_t rv_divuw(int rd, int rs1, int rs2) {
-    return RV_R(rd, rs1, rs2, F3_SR, 0x05, RV_OP32);
+    return RV_R(rd, rs1, rs2, F3_SR, 0x01, RV_OP32);
 }
 /* LR.W rd, (rs1) -- load reserved 32-bit */
 static uint32_t rv_lr_w(int rd, int rs1) {
@@ -403,23 +411,27 @@ static uint32_t rv_fdiv_s(int rd, int rs1, int rs2) {
 }
 /* FSGNJN.S rd, rs1, rs2 (negate) */
 static uint32_t rv_fsgnjn_s(int rd, int rs1, int rs2) {
-    return 0x20000053u | (((uint32_t)rd & 0x1F) << 7) | (((uint32_t)rs1 & 0x1F) << 15) | (((uint32_t)rs2 & 0x1F) << 20) | (0x01u << 25);
+    return 0x20001053u | (((uint32_t)rd & 0x1F) << 7) | (((uint32_t)rs1 & 0x1F) << 15) | (((uint32_t)rs2 & 0x1F) << 20);
 }
 /* FEQ.S rd, rs1, rs2 */
 static uint32_t rv_feq_s(int rd, int rs1, int rs2) {
-    return 0xA0000053u | (((uint32_t)rd & 0x1F) << 7) | (((uint32_t)rs1 & 0x1F) << 15) | (((uint32_t)rs2 & 0x1F) << 20) | (0x02u << 25);
+    return 0xA0002053u | (((uint32_t)rd & 0x1F) << 7) | (((uint32_t)rs1 & 0x1F) << 15) | (((uint32_t)rs2 & 0x1F) << 20);
 }
 /* FLT.S rd, rs1, rs2 */
 static uint32_t rv_flt_s(int rd, int rs1, int rs2) {
-    return 0xA0000053u | (((uint32_t)rd & 0x1F) << 7) | (((uint32_t)rs1 & 0x1F) << 15) | (((uint32_t)rs2 & 0x1F) << 20) | (0x01u << 25);
+    return 0xA0001053u | (((uint32_t)rd & 0x1F) << 7) | (((uint32_t)rs1 & 0x1F) << 15) | (((uint32_t)rs2 & 0x1F) << 20);
+}
+/* FLE.S rd, rs1, rs2 */
+static uint32_t rv_fle_s(int rd, int rs1, int rs2) {
+    return 0xA0000053u | (((uint32_t)rd & 0x1F) << 7) | (((uint32_t)rs1 & 0x1F) << 15) | (((uint32_t)rs2 & 0x1F) << 20);
 }
 /* FCVT.S.W rd, rs1 (int32→float32) */
 static uint32_t rv_fcvt_s_w(int rd, int rs1) {
-    return 0xD2000053u | (((uint32_t)rd & 0x1F) << 7) | (((uint32_t)rs1 & 0x1F) << 15);
+    return 0xD0000053u | (((uint32_t)rd & 0x1F) << 7) | (((uint32_t)rs1 & 0x1F) << 15);
 }
-/* FCVT.W.S rd, rs1 (float32→int32, truncate) */
+/* FCVT.W.S rd, rs1, rtz (float32→int32, truncate) */
 static uint32_t rv_fcvt_w_s(int rd, int rs1) {
-    return 0xC2000053u | (((uint32_t)rd & 0x1F) << 7) | (((uint32_t)rs1 & 0x1F) << 15) | (0x03u << 20);
+    return 0xC0001053u | (((uint32_t)rd & 0x1F) << 7) | (((uint32_t)rs1 & 0x1F) << 15);
 }
 /* FLW rd, imm12(rs1) -- load float */
 static uint32_t rv_flw(int rd, int rs1, int16_t imm) {
@@ -447,23 +459,27 @@ static uint32_t rv_fdiv_d(int rd, int rs1, int rs2) {
 }
 /* FSGNJN.D rd, rs1, rs2 (negate) */
 static uint32_t rv_fsgnjn_d(int rd, int rs1, int rs2) {
-    return 0x22000053u | (((uint32_t)rd & 0x1F) << 7) | (((uint32_t)rs1 & 0x1F) << 15) | (((uint32_t)rs2 & 0x1F) << 20) | (0x01u << 25);
+    return 0x22001053u | (((uint32_t)rd & 0x1F) << 7) | (((uint32_t)rs1 & 0x1F) << 15) | (((uint32_t)rs2 & 0x1F) << 20);
 }
 /* FEQ.D rd, rs1, rs2 */
 static uint32_t rv_feq_d(int rd, int rs1, int rs2) {
-    return 0xA2000053u | (((uint32_t)rd & 0x1F) << 7) | (((uint32_t)rs1 & 0x1F) << 15) | (((uint32_t)rs2 & 0x1F) << 20) | (0x02u << 25);
+    return 0xA2002053u | (((uint32_t)rd & 0x1F) << 7) | (((uint32_t)rs1 & 0x1F) << 15) | (((uint32_t)rs2 & 0x1F) << 20);
 }
 /* FLT.D rd, rs1, rs2 */
 static uint32_t rv_flt_d(int rd, int rs1, int rs2) {
-    return 0xA2000053u | (((uint32_t)rd & 0x1F) << 7) | (((uint32_t)rs1 & 0x1F) << 15) | (((uint32_t)rs2 & 0x1F) << 20) | (0x01u << 25);
+    return 0xA2001053u | (((uint32_t)rd & 0x1F) << 7) | (((uint32_t)rs1 & 0x1F) << 15) | (((uint32_t)rs2 & 0x1F) << 20);
+}
+/* FLE.D rd, rs1, rs2 */
+static uint32_t rv_fle_d(int rd, int rs1, int rs2) {
+    return 0xA2000053u | (((uint32_t)rd & 0x1F) << 7) | (((uint32_t)rs1 & 0x1F) << 15) | (((uint32_t)rs2 & 0x1F) << 20);
 }
 /* FCVT.D.W rd, rs1 (int32→float64) */
 static uint32_t rv_fcvt_d_w(int rd, int rs1) {
-    return 0xD2200053u | (((uint32_t)rd & 0x1F) << 7) | (((uint32_t)rs1 & 0x1F) << 15);
+    return 0xD2000053u | (((uint32_t)rd & 0x1F) << 7) | (((uint32_t)rs1 & 0x1F) << 15);
 }
-/* FCVT.W.D rd, rs1 (float64→int32, truncate) */
+/* FCVT.W.D rd, rs1, rtz (float64→int32, truncate) */
 static uint32_t rv_fcvt_w_d(int rd, int rs1) {
-    return 0xC2200053u | (((uint32_t)rd & 0x1F) << 7) | (((uint32_t)rs1 & 0x1F) << 15) | (0x03u << 20);
+    return 0xC2001053u | (((uint32_t)rd & 0x1F) << 7) | (((uint32_t)rs1 & 0x1F) << 15);
 }
 /* FLD rd, imm12(rs1) -- load double */
 static uint32_t rv_fld(int rd, int rs1, int16_t imm) {
@@ -475,17 +491,322 @@ static uint32_t rv_fsd(int rs2, int rs1, int16_t imm) {
 }
 /* FMV.W.X rd, rs1 (move int32 to float reg) */
 static uint32_t rv_fmv_w_x(int rd, int rs1) {
-    return 0xF2000053u | (((uint32_t)rd & 0x1F) << 7) | (((uint32_t)rs1 & 0x1F) << 15);
+    return 0xF0000053u | (((uint32_t)rd & 0x1F) << 7) | (((uint32_t)rs1 & 0x1F) << 15);
 }
 /* FMV.X.W rd, rs1 (move float reg to int32) */
 static uint32_t rv_fmv_x_w(int rd, int rs1) {
-    return 0xE2000053u | (((uint32_t)rd & 0x1F) << 7) | (((uint32_t)rs1 & 0x1F) << 15);
+    return 0xE0000053u | (((uint32_t)rd & 0x1F) << 7) | (((uint32_t)rs1 & 0x1F) << 15);
 }
 /* FMV.D.X rd, rs1 (move int64 to float reg) */
 static uint32_t rv_fmv_d_x(int rd, int rs1) {
-    return 0xF2200053u | (((uint32_t)rd & 0x1F) << 7) | (((uint32_t)rs1 & 0x1F) << 15);
+    return 0xF2000053u | (((uint32_t)rd & 0x1F) << 7) | (((uint32_t)rs1 & 0x1F) << 15);
 }
 /* FMV.X.D rd, rs1 (move float reg to int64) */
 static uint32_t rv_fmv_x_d(int rd, int rs1) {
-    return 0xE2200053u | (((uint32_t)rd & 0x1F) << 7) | (((uint32_t)rs1 & 0x1F) << 15);
+    return 0xE2000053u | (((uint32_t)rd & 0x1F) << 7) | (((uint32_t)rs1 & 0x1F) << 15);
+}
+/* DIVU rd, rs1, rs2 (unsigned 64-bit) */
+static uint32_t rv_divu(int rd, int rs1, int rs2) {
+    return RV_R(rd, rs1, rs2, F3_SR, 0x01, RV_OP);
+}
+/* REMU rd, rs1, rs2 (unsigned 64-bit remainder) */
+static uint32_t rv_remu(int rd, int rs1, int rs2) {
+    return RV_R(rd, rs1, rs2, F3_AND, 0x01, RV_OP);
+}
+
+/* ---- Zba: address generation ---- */
+
+/* SH1ADD / SH2ADD / SH3ADD rd, rs1, rs2: rd = rs2 + (rs1 << n) */
+static uint32_t rv_sh1add(int rd, int rs1, int rs2) {
+    return RV_R(rd, rs1, rs2, F3_SLT, 0x10, RV_OP);
+}
+static uint32_t rv_sh2add(int rd, int rs1, int rs2) {
+    return RV_R(rd, rs1, rs2, F3_XOR, 0x10, RV_OP);
+}
+static uint32_t rv_sh3add(int rd, int rs1, int rs2) {
+    return RV_R(rd, rs1, rs2, F3_OR, 0x10, RV_OP);
+}
+
+/* ---- Zbb: basic bit manipulation ---- */
+
+/* ORN rd, rs1, rs2: rd = rs1 | ~rs2 */
+static uint32_t rv_orn(int rd, int rs1, int rs2) {
+    return RV_R(rd, rs1, rs2, F3_OR, 0x20, RV_OP);
+}
+/* CTZ rd, rs1 (64-bit count trailing zeros) */
+static uint32_t rv_ctz(int rd, int rs1)   { return RV_I(rd, rs1, 0x601, F3_SLL, RV_OP_IMM); }
+/* ORC.B rd, rs1: each byte becomes 0xFF if non-zero, else 0x00 */
+static uint32_t rv_orc_b(int rd, int rs1) { return RV_I(rd, rs1, 0x287, F3_SR, RV_OP_IMM); }
+
+/* ---- C extension: 16-bit compressed encodings ----
+ *
+ * Constructors take full register numbers; rd'/rs1'/rs2' forms need x8-x15
+ * (s0, s1, a0-a5).  Immediates are byte offsets and must satisfy the scaling
+ * and range of the form: callers check with rv_c_fits_* or go through
+ * rv_compress(), which only returns a compressed form when it is exact.
+ */
+
+#define RV_C_REG(r) ((uint32_t)((r) - 8) & 0x7)
+
+static bool rv_c_reg_ok(int r) { return r >= 8 && r <= 15; }
+
+/* C.ADDI4SPN rd', sp, nzuimm (multiple of 4, 4..1020) */
+static uint16_t rv_c_addi4spn(int rd, int imm) {
+    uint32_t u = (uint32_t)imm;
+    return (uint16_t)((((u >> 4) & 0x3) << 11) | (((u >> 6) & 0xF) << 7) |
+                      (((u >> 2) & 0x1) << 6) | (((u >> 3) & 0x1) << 5) |
+                      (RV_C_REG(rd) << 2) | 0x0);
+}
+/* C.LW / C.SW rd', uimm(rs1') (multiple of 4, 0..124) */
+static uint16_t rv_c_lw(int rd, int rs1, int imm) {
+    uint32_t u = (uint32_t)imm;
+    return (uint16_t)((0x2u << 13) | (((u >> 3) & 0x7) << 10) | (RV_C_REG(rs1) << 7) |
+                      (((u >> 2) & 0x1) << 6) | (((u >> 6) & 0x1) << 5) | (RV_C_REG(rd) << 2));
+}
+static uint16_t rv_c_sw(int rs2, int rs1, int imm) {
+    return (uint16_t)(rv_c_lw(rs2, rs1, imm) | (0x4u << 13));
+}
+/* C.LD / C.SD rd', uimm(rs1') (multiple of 8, 0..248) */
+static uint16_t rv_c_ld(int rd, int rs1, int imm) {
+    uint32_t u = (uint32_t)imm;
+    return (uint16_t)((0x3u << 13) | (((u >> 3) & 0x7) << 10) | (RV_C_REG(rs1) << 7) |
+                      (((u >> 6) & 0x3) << 5) | (RV_C_REG(rd) << 2));
+}
+static uint16_t rv_c_sd(int rs2, int rs1, int imm) {
+    return (uint16_t)(rv_c_ld(rs2, rs1, imm) | (0x4u << 13));
+}
+/* CI format: funct3 | imm[5] | rd | imm[4:0] | op */
+static uint16_t rv_c_ci(int f3, int rd, int imm, int op) {
+    uint32_t u = (uint32_t)imm;
+    return (uint16_t)(((uint32_t)f3 << 13) | (((u >> 5) & 0x1) << 12) |
+                      (((uint32_t)rd & 0x1F) << 7) | ((u & 0x1F) << 2) | (uint32_t)op);
+}
+/* C.NOP, C.ADDI rd, nzimm6, C.ADDIW rd, imm6, C.LI rd, imm6 */
+static uint16_t rv_c_nop(void) { return 0x0001; }
+static uint16_t rv_c_addi(int rd, int imm)  { return rv_c_ci(0, rd, imm, 1); }
+static uint16_t rv_c_addiw(int rd, int imm) { return rv_c_ci(1, rd, imm, 1); }
+static uint16_t rv_c_li(int rd, int imm)    { return rv_c_ci(2, rd, imm, 1); }
+/* C.LUI rd, nzimm (bits 17:12 of the lui immediate, sign-extended) */
+static uint16_t rv_c_lui(int rd, int imm20) { return rv_c_ci(3, rd, imm20, 1); }
+/* C.ADDI16SP sp, nzimm (multiple of 16, -512..496) */
+static uint16_t rv_c_addi16sp(int imm) {
+    uint32_t u = (uint32_t)imm;
+    return (uint16_t)((0x3u << 13) | (((u >> 9) & 0x1) << 12) | (RV_SP << 7) |
+                      (((u >> 4) & 0x1) << 6) | (((u >> 6) & 0x1) << 5) |
+                      (((u >> 7) & 0x3) << 3) | (((u >> 5) & 0x1) << 2) | 0x1);
+}
+/* C.SRLI / C.SRAI / C.ANDI rd', imm */
+static uint16_t rv_c_srli(int rd, int shamt) {
+    return (uint16_t)(rv_c_ci(4, rd, shamt, 1) & ~(0x1Fu << 7)) | (uint16_t)(RV_C_REG(rd) << 7);
+}
+static uint16_t rv_c_srai(int rd, int shamt) {
+    return (uint16_t)(rv_c_srli(rd, shamt) | (0x1u << 10));
+}
+static uint16_t rv_c_andi(int rd, int imm) {
+    return (uint16_t)(((rv_c_ci(4, rd, imm, 1) & ~(0x1Fu << 7)) | (RV_C_REG(rd) << 7)) | (0x2u << 10));
+}
+/* CA format: C.SUB/XOR/OR/AND, C.SUBW/ADDW rd', rd', rs2' */
+static uint16_t rv_c_ca(int wide, int f2, int rd, int rs2) {
+    return (uint16_t)((0x4u << 13) | ((uint32_t)wide << 12) | (0x3u << 10) |
+                      (RV_C_REG(rd) << 7) | ((uint32_t)f2 << 5) | (RV_C_REG(rs2) << 2) | 0x1);
+}
+static uint16_t rv_c_sub(int rd, int rs2)  { return rv_c_ca(0, 0, rd, rs2); }
+static uint16_t rv_c_xor(int rd, int rs2)  { return rv_c_ca(0, 1, rd, rs2); }
+static uint16_t rv_c_or(int rd, int rs2)   { return rv_c_ca(0, 2, rd, rs2); }
+static uint16_t rv_c_and(int rd, int rs2)  { return rv_c_ca(0, 3, rd, rs2); }
+static uint16_t rv_c_subw(int rd, int rs2) { return rv_c_ca(1, 0, rd, rs2); }
+static uint16_t rv_c_addw(int rd, int rs2) { return rv_c_ca(1, 1, rd, rs2); }
+/* C.J offset (even, -2048..2046) */
+static uint16_t rv_c_j(int32_t off) {
+    uint32_t u = (uint32_t)off;
+    return (uint16_t)((0x5u << 13) | (((u >> 11) & 0x1) << 12) | (((u >> 4) & 0x1) << 11) |
+                      (((u >> 8) & 0x3) << 9) | (((u >> 10) & 0x1) << 8) |
+                      (((u >> 6) & 0x1) << 7) | (((u >> 7) & 0x1) << 6) |
+                      (((u >> 1) & 0x7) << 3) | (((u >> 5) & 0x1) << 2) | 0x1);
+}
+/* C.BEQZ / C.BNEZ rs1', offset (even, -256..254) */
+static uint16_t rv_c_beqz(int rs1, int32_t off) {
+    uint32_t u = (uint32_t)off;
+    return (uint16_t)((0x6u << 13) | (((u >> 8) & 0x1) << 12) | (((u >> 3) & 0x3) << 10) |
+                      (RV_C_REG(rs1) << 7) | (((u >> 6) & 0x3) << 5) |
+                      (((u >> 1) & 0x3) << 3) | (((u >> 5) & 0x1) << 2) | 0x1);
+}
+static uint16_t rv_c_bnez(int rs1, int32_t off) {
+    return (uint16_t)(rv_c_beqz(rs1, off) | (0x1u << 13));
+}
+/* C.SLLI rd, shamt */
+static uint16_t rv_c_slli(int rd, int shamt) { return rv_c_ci(0, rd, shamt, 2); }
+/* C.LWSP rd, uimm(sp) (multiple of 4, 0..252); C.LDSP (multiple of 8, 0..504) */
+static uint16_t rv_c_lwsp(int rd, int imm) {
+    uint32_t u = (uint32_t)imm;
+    return (uint16_t)((0x2u << 13) | (((u >> 5) & 0x1) << 12) | (((uint32_t)rd & 0x1F) << 7) |
+                      (((u >> 2) & 0x7) << 4) | (((u >> 6) & 0x3) << 2) | 0x2);
+}
+static uint16_t rv_c_ldsp(int rd, int imm) {
+    uint32_t u = (uint32_t)imm;
+    return (uint16_t)((0x3u << 13) | (((u >> 5) & 0x1) << 12) | (((uint32_t)rd & 0x1F) << 7) |
+                      (((u >> 3) & 0x3) << 5) | (((u >> 6) & 0x7) << 2) | 0x2);
+}
+/* C.SWSP rs2, uimm(sp) (multiple of 4, 0..252); C.SDSP (multiple of 8, 0..504) */
+static uint16_t rv_c_swsp(int rs2, int imm) {
+    uint32_t u = (uint32_t)imm;
+    return (uint16_t)((0x6u << 13) | (((u >> 2) & 0xF) << 9) | (((u >> 6) & 0x3) << 7) |
+                      (((uint32_t)rs2 & 0x1F) << 2) | 0x2);
+}
+static uint16_t rv_c_sdsp(int rs2, int imm) {
+    uint32_t u = (uint32_t)imm;
+    return (uint16_t)((0x7u << 13) | (((u >> 3) & 0x7) << 10) | (((u >> 6) & 0x7) << 7) |
+                      (((uint32_t)rs2 & 0x1F) << 2) | 0x2);
+}
+/* CR format: C.JR, C.MV, C.EBREAK, C.JALR, C.ADD */
+static uint16_t rv_c_cr(int f4, int rd, int rs2) {
+    return (uint16_t)(((uint32_t)f4 << 12) | (((uint32_t)rd & 0x1F) << 7) |
+                      (((uint32_t)rs2 & 0x1F) << 2) | 0x2);
+}
+static uint16_t rv_c_jr(int rs1)           { return rv_c_cr(0x8, rs1, 0); }
+static uint16_t rv_c_mv(int rd, int rs2)   { return rv_c_cr(0x8, rd, rs2); }
+static uint16_t rv_c_ebreak(void)          { return rv_c_cr(0x9, 0, 0); }
+static uint16_t rv_c_jalr(int rs1)         { return rv_c_cr(0x9, rs1, 0); }
+static uint16_t rv_c_add(int rd, int rs2)  { return rv_c_cr(0x9, rd, rs2); }
+
+/* ---- Instruction decoding for compression ---- */
+
+static int32_t rv_imm_i(uint32_t ins) { return (int32_t)ins >> 20; }
+static int32_t rv_imm_s(uint32_t ins) {
+    return ((int32_t)(ins & 0xFE000000u) >> 20) | (int32_t)((ins >> 7) & 0x1F);
+}
+static int32_t rv_imm_b(uint32_t ins) {
+    int32_t imm = (int32_t)(((ins >> 31) & 0x1) << 12) | (int32_t)(((ins >> 7) & 0x1) << 11) |
+                  (int32_t)(((ins >> 25) & 0x3F) << 5) | (int32_t)(((ins >> 8) & 0xF) << 1);
+    return (imm << 19) >> 19;
+}
+static int32_t rv_imm_j(uint32_t ins) {
+    int32_t imm = (int32_t)(((ins >> 31) & 0x1) << 20) | (int32_t)(ins & 0xFF000u) |
+                  (int32_t)(((ins >> 20) & 0x1) << 11) | (int32_t)(((ins >> 21) & 0x3FF) << 1);
+    return (imm << 11) >> 11;
+}
+
+static bool rv_is_branch(uint32_t ins) { return (ins & 0x7F) == RV_BRANCH; }
+static bool rv_is_jal(uint32_t ins)    { return (ins & 0x7F) == RV_JAL; }
+static bool rv_is_auipc(uint32_t ins)  { return (ins & 0x7F) == RV_AUIPC; }
+
+/* Re-targets a B-type or JAL word to a new byte offset. */
+static uint32_t rv_with_offset(uint32_t ins, int32_t off) {
+    if (rv_is_jal(ins)) return RV_J((ins >> 7) & 0x1F, (uint32_t)off, RV_JAL);
+    return RV_B((ins >> 15) & 0x1F, (ins >> 20) & 0x1F, (uint32_t)off, (ins >> 12) & 0x7, RV_BRANCH);
+}
+
+/* Compressed form of a PC-relative jal zero / beq, bne against zero at a
+   byte offset, or 0 when none exists. */
+static uint16_t rv_compress_jump(uint32_t ins, int32_t off) {
+    if (rv_is_jal(ins)) {
+        if (((ins >> 7) & 0x1F) != RV_ZERO || off < -2048 || off > 2046) return 0;
+        return rv_c_j(off);
+    }
+    if (!rv_is_branch(ins) || off < -256 || off > 254) return 0;
+    int f3 = (int)((ins >> 12) & 0x7);
+    int rs1 = (int)((ins >> 15) & 0x1F), rs2 = (int)((ins >> 20) & 0x1F);
+    if (rs2 != RV_ZERO || !rv_c_reg_ok(rs1)) return 0;
+    if (f3 == F3_BEQ) return rv_c_beqz(rs1, off);
+    if (f3 == F3_BNE) return rv_c_bnez(rs1, off);
+    return 0;
+}
+
+/* Exact 16-bit equivalent of a position-independent RV64GC instruction, or 0
+   when it has none.  PC-relative instructions go through rv_compress_jump. */
+static uint16_t rv_compress(uint32_t ins) {
+    uint32_t op = ins & 0x7F;
+    int rd = (int)((ins >> 7) & 0x1F), f3 = (int)((ins >> 12) & 0x7);
+    int rs1 = (int)((ins >> 15) & 0x1F), rs2 = (int)((ins >> 20) & 0x1F);
+    uint32_t f7 = ins >> 25;
+    int32_t imm = rv_imm_i(ins);
+    bool c_rd = rv_c_reg_ok(rd), c_rs1 = rv_c_reg_ok(rs1), c_rs2 = rv_c_reg_ok(rs2);
+    switch (op) {
+    case RV_OP_IMM:
+        if (f3 == F3_ADD) {
+            if (rd == RV_ZERO) return 0;
+            if (rs1 == RV_ZERO && imm >= -32 && imm <= 31) return rv_c_li(rd, imm);
+            if (imm == 0 && rs1 != RV_ZERO) return rv_c_mv(rd, rs1);
+            if (rd == rs1 && rd == RV_SP && (imm & 0xF) == 0 && imm >= -512 && imm <= 496)
+                return rv_c_addi16sp(imm);
+            if (rd == rs1 && imm >= -32 && imm <= 31) return rv_c_addi(rd, imm);
+            if (rs1 == RV_SP && c_rd && (imm & 0x3) == 0 && imm > 0 && imm <= 1020)
+                return rv_c_addi4spn(rd, imm);
+            return 0;
+        }
+        if (f3 == F3_SLL && (imm >> 6) == 0 && rd == rs1 && rd != RV_ZERO && imm != 0)
+            return rv_c_slli(rd, imm);
+        if (f3 == F3_SR && rd == rs1 && c_rd && (imm & 0x3F) != 0) {
+            if ((imm >> 6) == 0) return rv_c_srli(rd, imm & 0x3F);
+            if ((imm >> 6) == 0x10) return rv_c_srai(rd, imm & 0x3F);
+            return 0;
+        }
+        if (f3 == F3_AND && rd == rs1 && c_rd && imm >= -32 && imm <= 31) return rv_c_andi(rd, imm);
+        return 0;
+    case RV_OP_IMM32:
+        if (f3 == F3_ADD && rd == rs1 && rd != RV_ZERO && imm >= -32 && imm <= 31)
+            return rv_c_addiw(rd, imm);
+        return 0;
+    case RV_LUI: {
+        int32_t hi = (int32_t)ins >> 12;
+        if (rd == RV_ZERO || rd == RV_SP || hi == 0 || hi < -32 || hi > 31) return 0;
+        return rv_c_lui(rd, hi);
+    }
+    case RV_OP:
+        if (f7 == 0 && f3 == F3_ADD && rd != RV_ZERO && rs2 != RV_ZERO) {
+            if (rs1 == RV_ZERO) return rv_c_mv(rd, rs2);
+            if (rd == rs1) return rv_c_add(rd, rs2);
+            if (rd == rs2) return rv_c_add(rd, rs1);
+            return 0;
+        }
+        if (!c_rd || !c_rs2 || rd != rs1) {
+            /* and/or/xor commute: rd == rs2 works with the operands swapped */
+            if (f7 == 0 && c_rd && c_rs1 && rd == rs2 &&
+                (f3 == F3_AND || f3 == F3_OR || f3 == F3_XOR)) {
+                rs2 = rs1;
+            } else {
+                return 0;
+            }
+        }
+        if (f7 == 0x20 && f3 == F3_ADD) return rv_c_sub(rd, rs2);
+        if (f7 == 0 && f3 == F3_XOR) return rv_c_xor(rd, rs2);
+        if (f7 == 0 && f3 == F3_OR) return rv_c_or(rd, rs2);
+        if (f7 == 0 && f3 == F3_AND) return rv_c_and(rd, rs2);
+        return 0;
+    case RV_OP32:
+        if (f3 != F3_ADD || !c_rd) return 0;
+        if (f7 == 0 && rd == rs1 && c_rs2) return rv_c_addw(rd, rs2);
+        if (f7 == 0 && rd == rs2 && c_rs1) return rv_c_addw(rd, rs1);
+        if (f7 == 0x20 && rd == rs1 && c_rs2) return rv_c_subw(rd, rs2);
+        return 0;
+    case RV_LOAD:
+        if (rd == RV_ZERO) return 0;
+        if (f3 == F3_WORD) {
+            if (rs1 == RV_SP && (imm & 0x3) == 0 && imm >= 0 && imm <= 252) return rv_c_lwsp(rd, imm);
+            if (c_rd && c_rs1 && (imm & 0x3) == 0 && imm >= 0 && imm <= 124) return rv_c_lw(rd, rs1, imm);
+        } else if (f3 == F3_DWORD) {
+            if (rs1 == RV_SP && (imm & 0x7) == 0 && imm >= 0 && imm <= 504) return rv_c_ldsp(rd, imm);
+            if (c_rd && c_rs1 && (imm & 0x7) == 0 && imm >= 0 && imm <= 248) return rv_c_ld(rd, rs1, imm);
+        }
+        return 0;
+    case RV_STORE: {
+        int32_t simm = rv_imm_s(ins);
+        if (f3 == F3_WORD) {
+            if (rs1 == RV_SP && (simm & 0x3) == 0 && simm >= 0 && simm <= 252) return rv_c_swsp(rs2, simm);
+            if (c_rs2 && c_rs1 && (simm & 0x3) == 0 && simm >= 0 && simm <= 124) return rv_c_sw(rs2, rs1, simm);
+        } else if (f3 == F3_DWORD) {
+            if (rs1 == RV_SP && (simm & 0x7) == 0 && simm >= 0 && simm <= 504) return rv_c_sdsp(rs2, simm);
+            if (c_rs2 && c_rs1 && (simm & 0x7) == 0 && simm >= 0 && simm <= 248) return rv_c_sd(rs2, rs1, simm);
+        }
+        return 0;
+    }
+    case RV_JALR:
+        if (f3 != 0 || imm != 0 || rs1 == RV_ZERO) return 0;
+        if (rd == RV_ZERO) return rv_c_jr(rs1);
+        if (rd == RV_RA) return rv_c_jalr(rs1);
+        return 0;
+    default:
+        if (ins == 0x00100073u) return rv_c_ebreak();
+        return 0;
+    }
 }
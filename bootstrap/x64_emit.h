@@ -31,6 +31,10 @@
 enum { CC_O=0, CC_NO, CC_B, CC_AE, CC_E, CC_NE, CC_BE, CC_A,
        CC_S, CC_NS, CC_P, CC_NP, CC_L, CC_GE, CC_LE, CC_G };
 
+/* General-purpose register numbers */
+enum { X64_RAX = 0, X64_RCX, X64_RDX, X64_RBX, X64_RSP, X64_RBP, X64_RSI, X64_RDI,
+       X64_R8, X64_R9, X64_R10, X64_R11, X64_R12, X64_R13, X64_R14, X64_R15 };
+
 /* ---- Byte buffer for x86_64 code ---- */
 typedef struct {
     uint8_t *buf;
@@ -64,6 +68,7 @@ static void x64_emit8(X64Code *c, uint64_t v) {
 
 /* mov $imm32, %r32 */
 static void x64_mov_r32_imm32(X64Code *c, int reg, int32_t imm) {
+    if (reg >= 8) x64_emit1(c, REX_B);
     x64_emit1(c, 0xB8 + (reg & 7));
     x64_emit4(c, (uint32_t)imm);
 }
@@ -77,10 +82,9 @@ static void x64_mov_r64_imm64(X64Code *c, int reg, uint64_t imm) {
 
 /* mov %r32, [base + disp32] */
 static void x64_mov_mr32_r32(X64Code *c, int base, int32_t disp, int reg) {
-    if (reg >= 8) { x64_emit1(c, REX_R); }
-    if (base >= 8) { x64_emit1(c, REX_B); }
+    if (reg >= 8 || base >= 8) x64_emit1(c, (reg >= 8 ? REX_R : 0) | (base >= 8 ? REX_B : 0));
     x64_emit1(c, 0x89);
-    if (base == 4) { /* RSP needs SIB */
+    if ((base & 7) == 4) { /* RSP/R12 need SIB */
         x64_emit1(c, MODRM(2, reg & 7, 4));
         x64_emit1(c, SIB(0, 4, 4));
     } else {
@@ -114,8 +118,7 @@ static void x64_mov_mr64_r64_store(X64Code *c, int base, int32_t disp, int reg)
 
 /* mov [base + disp32], %r32 (load 32-bit) */
 static void x64_mov_r32_mr32(X64Code *c, int reg, int base, int32_t disp) {
-    if (reg >= 8) { x64_emit1(c, REX_R); }
-    if (base >= 8) { x64_emit1(c, REX_B); }
+    if (reg >= 8 || base >= 8) x64_emit1(c, (reg >= 8 ? REX_R : 0) | (base >= 8 ? REX_B : 0));
     x64_emit1(c, 0x8B);
     if ((base & 7) == 4) {
         x64_emit1(c, MODRM(2, reg & 7, 4));
@@ -141,18 +144,11 @@ static void x64_mov_r64_mr64(X64Code *c, int reg, int base, int32_t disp) {
 
 /* add %r32, %r32 */
 static void x64_add_r32_r32(X64Code *c, int dst, int src) {
-    if (dst >= 8 || src >= 8) x64_emit1(c, (dst >= 8 ? REX_R : 0) | (src >= 8 ? REX_B : 0));
+    if (dst >= 8 || src >= 8) x64_emit1(c, (src >= 8 ? REX_R : 0) | (dst >= 8 ? REX_B : 0));
     x64_emit1(c, 0x01);
     x64_emit1(c, MODRM(3, src & 7, dst & 7));
 }
 
-/* sub %r32, %r32 */
-static void x64_sub_r32_r32(X64Code *c, int dst, int src) {
-    if (dst >= 8 || src >= 8) x64_emit1(c, (dst >= 8 ? REX_R : 0) | (src >= 8 ? REX_B : 0));
-    x64_emit1(c, 0x29);
-    x64_emit1(c, MODRM(3, src & 7, dst & 7));
-}
-
 /* imul %r32, %r32 */
 static void x64_imul_r32_r32(X64Code *c, int dst, int src) {
     if (dst >= 8 || src >= 8) x64_emit1(c, (dst >= 8 ? REX_R : 0) | (src >= 8 ? REX_B : 0));
@@ -261,32 +257,26 @@ static void x64_add_rsp_imm8(X64Code *c, int8_t imm) {
 
 /* mov %r32, %r32 */
 static void x64_mov_r32_r32(X64Code *c, int dst, int src) {
-    if (dst >= 8 || src >= 8) x64_emit1(c, (dst >= 8 ? REX_R : 0) | (src >= 8 ? REX_B : 0));
+    if (dst >= 8 || src >= 8) x64_emit1(c, (src >= 8 ? REX_R : 0) | (dst >= 8 ? REX_B : 0));
     x64_emit1(c, 0x89);
     x64_emit1(c, MODRM(3, src & 7, dst & 7));
 }
 
-/* sub %r64, %r64 */
-static void x64_sub_r64_r64(X64Code *c, int dst, int src) {
-    x64_emit1(c, REX_W | (dst >= 8 ? REX_R : 0) | (src >= 8 ? REX_B : 0));
-    x64_emit1(c, 0x29);
-    x64_emit1(c, MODRM(3, src & 7, dst & 7));
-}
 /* add %r64, %r64 */
 static void x64_add_r64_r64(X64Code *c, int dst, int src) {
-    x64_emit1(c, REX_W | (dst >= 8 ? REX_R : 0) | (src >= 8 ? REX_B : 0));
+    x64_emit1(c, REX_W | (src >= 8 ? REX_R : 0) | (dst >= 8 ? REX_B : 0));
     x64_emit1(c, 0x01);
     x64_emit1(c, MODRM(3, src & 7, dst & 7));
 }
 /* xor %r32, %r32 */
 static void x64_xor_r32_r32(X64Code *c, int dst, int src) {
-    if (dst >= 8 || src >= 8) x64_emit1(c, (dst >= 8 ? REX_R : 0) | (src >= 8 ? REX_B : 0));
+    if (dst >= 8 || src >= 8) x64_emit1(c, (src >= 8 ? REX_R : 0) | (dst >= 8 ? REX_B : 0));
     x64_emit1(c, 0x31);
     x64_emit1(c, MODRM(3, src & 7, dst & 7));
 }
 /* xor %r64, %r64 */
 static void x64_xor_r64_r64(X64Code *c, int dst, int src) {
-    x64_emit1(c, REX_W | (dst >= 8 ? REX_R : 0) | (src >= 8 ? REX_B : 0));
+    x64_emit1(c, REX_W | (src >= 8 ? REX_R : 0) | (dst >= 8 ? REX_B : 0));
     x64_emit1(c, 0x31);
     x64_emit1(c, MODRM(3, src & 7, dst & 7));
 }
@@ -302,12 +292,6 @@ static void x64_not_r32(X64Code *c, int reg) {
     x64_emit1(c, 0xF7);
     x64_emit1(c, MODRM(3, 2, reg & 7));
 }
-/* cmp %r64, %r64 */
-static void x64_cmp_r64_r64(X64Code *c, int a, int b) {
-    x64_emit1(c, REX_W | (a >= 8 ? REX_R : 0) | (b >= 8 ? REX_B : 0));
-    x64_emit1(c, 0x39);
-    x64_emit1(c, MODRM(3, a & 7, b & 7));
-}
 /* cmp $imm32, %r64 */
 static void x64_cmp_r64_imm8(X64Code *c, int reg, int8_t imm) {
     x64_emit1(c, REX_W | (reg >= 8 ? REX_B : 0));
@@ -355,24 +339,12 @@ static void x64_movzb_r8_r32(X64Code *c, int dst, int src) {
     x64_emit1(c, 0xB6);
     x64_emit1(c, MODRM(3, dst & 7, src & 7));
 }
-/* shl %cl, %r32 */
-static void x64_shl_r32_cl(X64Code *c, int reg) {
-    if (reg >= 8) x64_emit1(c, REX_B);
-    x64_emit1(c, 0xD3);
-    x64_emit1(c, MODRM(3, 4, reg & 7));
-}
 /* shr %cl, %r32 */
 static void x64_shr_r32_cl(X64Code *c, int reg) {
     if (reg >= 8) x64_emit1(c, REX_B);
     x64_emit1(c, 0xD3);
     x64_emit1(c, MODRM(3, 5, reg & 7));
 }
-/* sar %cl, %r32 */
-static void x64_sar_r32_cl(X64Code *c, int reg) {
-    if (reg >= 8) x64_emit1(c, REX_B);
-    x64_emit1(c, 0xD3);
-    x64_emit1(c, MODRM(3, 7, reg & 7));
-}
 /* test %r32, %r32 */
 static void x64_test_r32_r32(X64Code *c, int a, int b) {
     if (a >= 8 || b >= 8) x64_emit1(c, (a >= 8 ? REX_R : 0) | (b >= 8 ? REX_B : 0));
@@ -401,42 +373,18 @@ static void x64_imul_r64_r64(X64Code *c, int dst, int src) {
     x64_emit1(c, 0x0F); x64_emit1(c, 0xAF);
     x64_emit1(c, MODRM(3, dst & 7, src & 7));
 }
-/* and %r64, %r64 */
-static void x64_and_r64_r64(X64Code *c, int dst, int src) {
-    x64_emit1(c, REX_W | (dst >= 8 ? REX_R : 0) | (src >= 8 ? REX_B : 0));
-    x64_emit1(c, 0x21);
-    x64_emit1(c, MODRM(3, src & 7, dst & 7));
-}
-/* or %r64, %r64 */
-static void x64_or_r64_r64(X64Code *c, int dst, int src) {
-    x64_emit1(c, REX_W | (dst >= 8 ? REX_R : 0) | (src >= 8 ? REX_B : 0));
-    x64_emit1(c, 0x09);
-    x64_emit1(c, MODRM(3, src & 7, dst & 7));
-}
 /* xor %r64, %r64 (use REX.W 0x31 form) */
 static void x64_xor_r64_r64_alt(X64Code *c, int dst, int src) {
-    x64_emit1(c, REX_W | (dst >= 8 ? REX_R : 0) | (src >= 8 ? REX_B : 0));
+    x64_emit1(c, REX_W | (src >= 8 ? REX_R : 0) | (dst >= 8 ? REX_B : 0));
     x64_emit1(c, 0x31);
     x64_emit1(c, MODRM(3, src & 7, dst & 7));
 }
-/* shl %cl, %r64 */
-static void x64_shl_r64_cl(X64Code *c, int reg) {
-    x64_emit1(c, REX_W | (reg >= 8 ? REX_B : 0));
-    x64_emit1(c, 0xD3);
-    x64_emit1(c, MODRM(3, 4, reg & 7));
-}
 /* shr %cl, %r64 */
 static void x64_shr_r64_cl(X64Code *c, int reg) {
     x64_emit1(c, REX_W | (reg >= 8 ? REX_B : 0));
     x64_emit1(c, 0xD3);
     x64_emit1(c, MODRM(3, 5, reg & 7));
 }
-/* sar %cl, %r64 */
-static void x64_sar_r64_cl(X64Code *c, int reg) {
-    x64_emit1(c, REX_W | (reg >= 8 ? REX_B : 0));
-    x64_emit1(c, 0xD3);
-    x64_emit1(c, MODRM(3, 7, reg & 7));
-}
 /* movsxd %r32, %r64 (sign-extend 32→64) */
 static void x64_movsxd_r64_r32(X64Code *c, int dst, int src) {
     x64_emit1(c, REX_W | (dst >= 8 ? REX_R : 0) | (src >= 8 ? REX_B : 0));
@@ -456,18 +404,6 @@ static void x64_lock_cmpxchg_r32_mr(X64Code *c, int base_reg, int reg) {
     x64_emit1(c, 0xB1);
     x64_emit1(c, MODRM(0, reg & 7, base_reg & 7));
 }
-/* mov (load) 64-bit from [base] */
-static void x64_mov_r64_mr64_base(X64Code *c, int reg, int base_reg) {
-    x64_emit1(c, REX_W | (reg >= 8 ? REX_R : 0) | (base_reg >= 8 ? REX_B : 0));
-    x64_emit1(c, 0x8B);
-    x64_emit1(c, MODRM(0, reg & 7, base_reg & 7));
-}
-/* mov (store) 64-bit to [base] */
-static void x64_mov_mr64_base_r64(X64Code *c, int base_reg, int reg) {
-    x64_emit1(c, REX_W | (reg >= 8 ? REX_R : 0) | (base_reg >= 8 ? REX_B : 0));
-    x64_emit1(c, 0x89);
-    x64_emit1(c, MODRM(0, reg & 7, base_reg & 7));
-}
 /* mov (load) 32-bit from [base] */
 static void x64_mov_r32_mr32_base(X64Code *c, int reg, int base_reg) {
     if (reg >= 8 || base_reg >= 8) x64_emit1(c, (reg >= 8 ? REX_R : 0) | (base_reg >= 8 ? REX_B : 0));
@@ -541,19 +477,6 @@ static void x64_movzb_r32_mr8(X64Code *c, int reg, int base_reg) {
     x64_emit1(c, 0x0F); x64_emit1(c, 0xB6);
     x64_emit1(c, MODRM(0, reg & 7, base_reg & 7));
 }
-/* movzw [base], %r32 (load zero-extend 16-bit) */
-static void x64_movzw_r32_mr16(X64Code *c, int reg, int base_reg) {
-    if (reg >= 8 || base_reg >= 8) x64_emit1(c, (reg >= 8 ? REX_R : 0) | (base_reg >= 8 ? REX_B : 0));
-    x64_emit1(c, 0x0F); x64_emit1(c, 0xB7);
-    x64_emit1(c, MODRM(0, reg & 7, base_reg & 7));
-}
-/* movw [base], %r16 (store 16-bit) */
-static void x64_mov_mr16_r16(X64Code *c, int base_reg, int reg) {
-    x64_emit1(c, 0x66); /* operand size override */
-    if (base_reg >= 8 || reg >= 8) x64_emit1(c, (base_reg >= 8 ? REX_B : 0) | (reg >= 8 ? REX_R : 0));
-    x64_emit1(c, 0x89);
-    x64_emit1(c, MODRM(0, reg & 7, base_reg & 7));
-}
 /* push imm32 */
 static void x64_push_imm32(X64Code *c, int32_t imm) { x64_emit1(c, 0x68); x64_emit4(c, (uint32_t)imm); }
 /* int3 */
@@ -795,6 +718,180 @@ static void x64_xorps_alt(X64Code *c, int dst, int src) {
     x64_emit1(c, MODRM(3, dst & 7, src & 7));
 }
 
+/* ---- Generic integer forms (any GPR, optional REX.W, shortest disp) ---- */
+/* ALU group selector: the /ext of 0x81/0x83 and the row of the 0x00-0x3B opcodes */
+enum { X64_ALU_ADD = 0, X64_ALU_OR = 1, X64_ALU_AND = 4, X64_ALU_SUB = 5,
+       X64_ALU_XOR = 6, X64_ALU_CMP = 7 };
+/* shift group selector: the /ext of 0xC1/0xD1/0xD3 */
+enum { X64_SHIFT_SHL = 4, X64_SHIFT_SHR = 5, X64_SHIFT_SAR = 7 };
+
+/* REX prefix only when it carries a bit (force for byte access to spl..dil) */
+static void x64_rex(X64Code *c, bool wide, int reg, int rm, bool force) {
+    uint8_t rex = 0x40 | (wide ? 8 : 0) | (reg >= 8 ? 4 : 0) | (rm >= 8 ? 1 : 0);
+    if (rex != 0x40 || force) x64_emit1(c, rex);
+}
+/* ModRM/SIB/disp for [base + disp]: no disp, disp8 or disp32 */
+static void x64_modrm_mem(X64Code *c, int reg, int base, int32_t disp) {
+    int mod = (disp == 0 && (base & 7) != 5) ? 0 : (disp >= -128 && disp <= 127 ? 1 : 2);
+    x64_emit1(c, MODRM(mod, reg & 7, base & 7));
+    if ((base & 7) == 4) x64_emit1(c, SIB(0, 4, 4));
+    if (mod == 1) x64_emit1(c, (uint8_t)disp);
+    else if (mod == 2) x64_emit4(c, (uint32_t)disp);
+}
+/* op %src, %dst (cmp sets flags for dst - src) */
+static void x64_alu_rr(X64Code *c, int ext, int dst, int src, bool wide) {
+    x64_rex(c, wide, src, dst, false);
+    x64_emit1(c, (uint8_t)(ext * 8 + 1));
+    x64_emit1(c, MODRM(3, src & 7, dst & 7));
+}
+/* op [base + disp], %reg (cmp sets flags for reg - mem) */
+static void x64_alu_rm(X64Code *c, int ext, int reg, int base, int32_t disp, bool wide) {
+    x64_rex(c, wide, reg, base, false);
+    x64_emit1(c, (uint8_t)(ext * 8 + 3));
+    x64_modrm_mem(c, reg, base, disp);
+}
+/* op %reg, [base + disp] (cmp sets flags for mem - reg) */
+static void x64_alu_mr(X64Code *c, int ext, int base, int32_t disp, int reg, bool wide) {
+    x64_rex(c, wide, reg, base, false);
+    x64_emit1(c, (uint8_t)(ext * 8 + 1));
+    x64_modrm_mem(c, reg, base, disp);
+}
+/* op $imm, %reg (imm8 form when it fits, short eax form otherwise) */
+static void x64_alu_ri(X64Code *c, int ext, int reg, int32_t imm, bool wide) {
+    x64_rex(c, wide, 0, reg, false);
+    if (imm >= -128 && imm <= 127) {
+        x64_emit1(c, 0x83);
+        x64_emit1(c, MODRM(3, ext, reg & 7));
+        x64_emit1(c, (uint8_t)imm);
+    } else if (reg == 0) {
+        x64_emit1(c, (uint8_t)(ext * 8 + 5));
+        x64_emit4(c, (uint32_t)imm);
+    } else {
+        x64_emit1(c, 0x81);
+        x64_emit1(c, MODRM(3, ext, reg & 7));
+        x64_emit4(c, (uint32_t)imm);
+    }
+}
+/* op $imm, [base + disp] */
+static void x64_alu_mi(X64Code *c, int ext, int base, int32_t disp, int32_t imm, bool wide) {
+    bool short_imm = imm >= -128 && imm <= 127;
+    x64_rex(c, wide, 0, base, false);
+    x64_emit1(c, short_imm ? 0x83 : 0x81);
+    x64_modrm_mem(c, ext, base, disp);
+    if (short_imm) x64_emit1(c, (uint8_t)imm);
+    else x64_emit4(c, (uint32_t)imm);
+}
+/* test %b, %a */
+static void x64_test_rr(X64Code *c, int a, int b, bool wide) {
+    x64_rex(c, wide, b, a, false);
+    x64_emit1(c, 0x85);
+    x64_emit1(c, MODRM(3, b & 7, a & 7));
+}
+/* mov %src, %dst */
+static void x64_mov_rr(X64Code *c, int dst, int src, bool wide) {
+    x64_rex(c, wide, src, dst, false);
+    x64_emit1(c, 0x89);
+    x64_emit1(c, MODRM(3, src & 7, dst & 7));
+}
+/* mov [base + disp], %reg (load) */
+static void x64_mov_rm(X64Code *c, int reg, int base, int32_t disp, bool wide) {
+    x64_rex(c, wide, reg, base, false);
+    x64_emit1(c, 0x8B);
+    x64_modrm_mem(c, reg, base, disp);
+}
+/* mov %reg, [base + disp] (store) */
+static void x64_mov_mr(X64Code *c, int base, int32_t disp, int reg, bool wide) {
+    x64_rex(c, wide, reg, base, false);
+    x64_emit1(c, 0x89);
+    x64_modrm_mem(c, reg, base, disp);
+}
+/* mov $imm32, [base + disp] (sign-extended for 64-bit) */
+static void x64_mov_mi(X64Code *c, int base, int32_t disp, int32_t imm, bool wide) {
+    x64_rex(c, wide, 0, base, false);
+    x64_emit1(c, 0xC7);
+    x64_modrm_mem(c, 0, base, disp);
+    x64_emit4(c, (uint32_t)imm);
+}
+/* mov $imm, %reg: zero-extending imm32, sign-extending imm32 or movabs */
+static void x64_mov_ri(X64Code *c, int reg, int64_t imm, bool wide) {
+    if (!wide || (imm >= 0 && imm <= 0xFFFFFFFFLL)) {
+        x64_rex(c, false, 0, reg, false);
+        x64_emit1(c, 0xB8 + (reg & 7));
+        x64_emit4(c, (uint32_t)imm);
+    } else if (imm >= INT32_MIN && imm <= INT32_MAX) {
+        x64_rex(c, true, 0, reg, false);
+        x64_emit1(c, 0xC7);
+        x64_emit1(c, MODRM(3, 0, reg & 7));
+        x64_emit4(c, (uint32_t)imm);
+    } else {
+        x64_rex(c, true, 0, reg, false);
+        x64_emit1(c, 0xB8 + (reg & 7));
+        x64_emit8(c, (uint64_t)imm);
+    }
+}
+/* imul %src, %dst */
+static void x64_imul_rr(X64Code *c, int dst, int src, bool wide) {
+    x64_rex(c, wide, dst, src, false);
+    x64_emit1(c, 0x0F); x64_emit1(c, 0xAF);
+    x64_emit1(c, MODRM(3, dst & 7, src & 7));
+}
+/* imul [base + disp], %dst */
+static void x64_imul_rm(X64Code *c, int dst, int base, int32_t disp, bool wide) {
+    x64_rex(c, wide, dst, base, false);
+    x64_emit1(c, 0x0F); x64_emit1(c, 0xAF);
+    x64_modrm_mem(c, dst, base, disp);
+}
+/* imul $imm, %src, %dst */
+static void x64_imul_rri(X64Code *c, int dst, int src, int32_t imm, bool wide) {
+    bool short_imm = imm >= -128 && imm <= 127;
+    x64_rex(c, wide, dst, src, false);
+    x64_emit1(c, short_imm ? 0x6B : 0x69);
+    x64_emit1(c, MODRM(3, dst & 7, src & 7));
+    if (short_imm) x64_emit1(c, (uint8_t)imm);
+    else x64_emit4(c, (uint32_t)imm);
+}
+/* imul $imm, [base + disp], %dst */
+static void x64_imul_rmi(X64Code *c, int dst, int base, int32_t disp, int32_t imm, bool wide) {
+    bool short_imm = imm >= -128 && imm <= 127;
+    x64_rex(c, wide, dst, base, false);
+    x64_emit1(c, short_imm ? 0x6B : 0x69);
+    x64_modrm_mem(c, dst, base, disp);
+    if (short_imm) x64_emit1(c, (uint8_t)imm);
+    else x64_emit4(c, (uint32_t)imm);
+}
+/* shl/shr/sar $imm, %reg */
+static void x64_shift_ri(X64Code *c, int ext, int reg, int imm, bool wide) {
+    x64_rex(c, wide, 0, reg, false);
+    x64_emit1(c, imm == 1 ? 0xD1 : 0xC1);
+    x64_emit1(c, MODRM(3, ext, reg & 7));
+    if (imm != 1) x64_emit1(c, (uint8_t)imm);
+}
+/* shl/shr/sar %cl, %reg */
+static void x64_shift_rcl(X64Code *c, int ext, int reg, bool wide) {
+    x64_rex(c, wide, 0, reg, false);
+    x64_emit1(c, 0xD3);
+    x64_emit1(c, MODRM(3, ext, reg & 7));
+}
+/* movsxd [base + disp], %dst */
+static void x64_movsxd_rm(X64Code *c, int dst, int base, int32_t disp) {
+    x64_rex(c, true, dst, base, false);
+    x64_emit1(c, 0x63);
+    x64_modrm_mem(c, dst, base, disp);
+}
+/* movzb/movzw [base + disp], %dst */
+static void x64_movzx_rm(X64Code *c, int dst, int base, int32_t disp, int bytes) {
+    x64_rex(c, false, dst, base, false);
+    x64_emit1(c, 0x0F); x64_emit1(c, bytes == 1 ? 0xB6 : 0xB7);
+    x64_modrm_mem(c, dst, base, disp);
+}
+/* movb/movw %reg, [base + disp] */
+static void x64_mov_mr_narrow(X64Code *c, int base, int32_t disp, int reg, int bytes) {
+    if (bytes == 2) x64_emit1(c, 0x66);
+    x64_rex(c, false, reg, base, bytes == 1 && reg >= 4 && reg < 8);
+    x64_emit1(c, bytes == 1 ? 0x88 : 0x89);
+    x64_modrm_mem(c, reg, base, disp);
+}
+
 /* ---- Relocation patching ---- */
 static void x64_patch_call_rel32(X64Code *c, int32_t pos, int32_t target) {
     /* pos points to the byte AFTER the E8 opcode */
@@ -15,6 +15,7 @@
 #include <pthread.h>
 #include <sched.h>
 #include <stdint.h>
+#include <stddef.h>
 #define W __attribute__((weak))
 W void* cheng_host_fopen(const char* p, const char* m) { return fopen(p,m); }
 W int cheng_host_fclose(void* fp) { return fclose((FILE*)fp); }
@@ -66,7 +67,6 @@ W int cheng_host_posix_openpt_runtime(int fl) { return posix_openpt(fl); }
 W int cheng_host_grantpt_runtime(int fd) { return grantpt(fd); }
 W int cheng_host_unlockpt_runtime(int fd) { return unlockpt(fd); }
 W char* cheng_host_ptsname_runtime(int fd) { return ptsname(fd); }
-W int cheng_native_system_cpu_logical_cores_value_bridge(void) { return 4; }
 W int cheng_native_errno_code_bridge(void) { return errno; }
 W int cheng_native_af_inet_bridge(void) { return 2; }
 W int cheng_native_af_inet6_bridge(void) { return 30; }
@@ -188,22 +188,412 @@ W int cheng_thread_spawn_i32(void* fn, int arg) {
     }
     return 1;
 }
-W int cheng_thread_parallelism(void) {
-    long n = sysconf(_SC_NPROCESSORS_ONLN);
-    return n > 0 && n <= 2147483647L ? (int)n : 1;
-}
 W void cheng_thread_yield(void) {
     sched_yield();
 }
+W void cheng_sleep_ms_bridge(int ms) {
+    if (ms > 0) usleep((useconds_t)ms * 1000u);
+}
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+W int cheng_futex_wait_i32(void* p, int expect, int timeout_ms) {
+    struct timespec ts = { timeout_ms / 1000, (long)(timeout_ms % 1000) * 1000000L };
+    long rc = syscall(SYS_futex, p, FUTEX_WAIT_PRIVATE, expect, timeout_ms > 0 ? &ts : 0, 0, 0);
+    return rc == 0 || errno == EAGAIN || errno == EINTR;
+}
+W int cheng_futex_wake_i32(void* p, int count) {
+    long rc = syscall(SYS_futex, p, FUTEX_WAKE_PRIVATE, count, 0, 0, 0);
+    return rc < 0 ? 0 : (int)rc;
+}
+#elif defined(__APPLE__)
+extern int __ulock_wait(uint32_t op, void* addr, uint64_t value, uint32_t timeout_us);
+extern int __ulock_wake(uint32_t op, void* addr, uint64_t wake_value);
+W int cheng_futex_wait_i32(void* p, int expect, int timeout_ms) {
+    int rc = __ulock_wait(1, p, (uint32_t)expect, timeout_ms > 0 ? (uint32_t)timeout_ms * 1000u : 0);
+    return rc >= 0 || *(volatile int*)p != expect;
+}
+W int cheng_futex_wake_i32(void* p, int count) {
+    __ulock_wake(count > 1 ? 0x101 : 1, p, 0);
+    return 1;
+}
+#endif
+/* CPU budget: CPUs this process may run on, capped by the tightest cgroup v2
+   cpu.max quota between its cgroup and the hierarchy root. root prefixes the
+   /proc and /sys paths so fixture trees can stand in for the host; with a
+   root the affinity mask comes from proc/self/status Cpus_allowed_list. */
+#if defined(__linux__)
+static int cheng_host_read_small(const char* root, const char* path, char* buf, size_t cap) {
+    char full[4096];
+    if (snprintf(full, sizeof(full), "%s%s", root, path) >= (int)sizeof(full)) return 0;
+    int fd = open(full, O_RDONLY);
+    if (fd < 0) return 0;
+    ssize_t n = read(fd, buf, cap - 1);
+    close(fd);
+    if (n <= 0) return 0;
+    buf[n] = 0;
+    return 1;
+}
+/* Counts the CPUs in a sysfs cpulist such as "0-3,8,10-11". */
+W int cheng_host_cpulist_count(const char* list) {
+    int count = 0;
+    const char* p = list;
+    while (*p && *p != '\n') {
+        if (*p < '0' || *p > '9') { p++; continue; }
+        long lo = strtol(p, (char**)&p, 10);
+        long hi = lo;
+        if (*p == '-') hi = strtol(p + 1, (char**)&p, 10);
+        if (hi >= lo) count += (int)(hi - lo + 1);
+    }
+    return count;
+}
+static int cheng_host_affinity_cpus(const char* root) {
+    if (!root[0]) {
+        unsigned long mask[64];
+        memset(mask, 0, sizeof(mask));
+        long n = syscall(SYS_sched_getaffinity, 0, sizeof(mask), mask);
+        if (n <= 0) return 0;
+        int count = 0;
+        for (size_t i = 0; i < (size_t)n / sizeof(mask[0]); i++)
+            count += __builtin_popcountl(mask[i]);
+        return count;
+    }
+    char buf[8192];
+    if (!cheng_host_read_small(root, "/proc/self/status", buf, sizeof(buf))) return 0;
+    const char* line = strstr(buf, "Cpus_allowed_list:");
+    if (!line) return 0;
+    return cheng_host_cpulist_count(line + strlen("Cpus_allowed_list:"));
+}
+/* Whole CPUs granted by cpu.max quotas on this process's cgroup path,
+   rounded up; 0 when no level sets a quota. */
+W int cheng_host_cgroup_cpu_limit(const char* root) {
+    char buf[4096];
+    if (!root) root = "";
+    if (!cheng_host_read_small(root, "/proc/self/cgroup", buf, sizeof(buf))) return 0;
+    const char* line = buf;
+    while (line && strncmp(line, "0::", 3) != 0) {
+        line = strchr(line, '\n');
+        if (line) line++;
+    }
+    if (!line) return 0;
+    line += 3;
+    char path[2048];
+    size_t len = strcspn(line, "\n");
+    if (len >= sizeof(path) - 32) return 0;
+    memcpy(path, "/sys/fs/cgroup", 14);
+    memcpy(path + 14, line, len);
+    len += 14;
+    while (len > 14 && path[len - 1] == '/') len--;
+    path[len] = 0;
+    int best = 0;
+    for (;;) {
+        char file[2100];
+        char text[128];
+        snprintf(file, sizeof(file), "%s/cpu.max", path);
+        if (cheng_host_read_small(root, file, text, sizeof(text)) && strncmp(text, "max", 3) != 0) {
+            char* end = 0;
+            long long quota = strtoll(text, &end, 10);
+            long long period = end ? strtoll(end, 0, 10) : 0;
+            if (quota > 0 && period > 0) {
+                long long cpus = (quota + period - 1) / period;
+                if (cpus > 1 << 20) cpus = 1 << 20;
+                if (best == 0 || cpus < best) best = (int)cpus;
+            }
+        }
+        if (len <= 14) break;
+        while (len > 14 && path[len - 1] != '/') len--;
+        if (len > 14) len--;
+        path[len] = 0;
+    }
+    return best;
+}
+W int cheng_host_cpu_budget(const char* root) {
+    if (!root) root = "";
+    int n = cheng_host_affinity_cpus(root);
+    if (n <= 0 && !root[0]) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        n = online > 0 && online <= 2147483647L ? (int)online : 1;
+    }
+    int limit = cheng_host_cgroup_cpu_limit(root);
+    if (limit > 0 && (n <= 0 || limit < n)) n = limit;
+    return n > 0 ? n : 1;
+}
+W int cheng_thread_pin_cpu(int cpu) {
+    unsigned long mask[64];
+    if (cpu < 0 || (size_t)cpu >= sizeof(mask) * 8) return 0;
+    memset(mask, 0, sizeof(mask));
+    mask[cpu / (8 * sizeof(mask[0]))] |= 1UL << (cpu % (8 * sizeof(mask[0])));
+    return syscall(SYS_sched_setaffinity, 0, sizeof(mask), mask) == 0;
+}
+#else
+W int cheng_host_cpulist_count(const char* list) { (void)list; return 0; }
+W int cheng_host_cgroup_cpu_limit(const char* root) { (void)root; return 0; }
+W int cheng_host_cpu_budget(const char* root) {
+    (void)root;
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 && n <= 2147483647L ? (int)n : 1;
+}
+W int cheng_thread_pin_cpu(int cpu) { (void)cpu; return 0; }
+#endif
+W int cheng_native_system_cpu_logical_cores_value_bridge(void) { return cheng_host_cpu_budget(""); }
+W int cheng_thread_parallelism(void) { return cheng_host_cpu_budget(""); }
 W int OSAtomicCompareAndSwap32Barrier(int oldValue, int newValue, volatile int* value) {
     return __sync_bool_compare_and_swap(value, oldValue, newValue);
 }
 W int OSAtomicAdd32Barrier(int amount, volatile int* value) {
     return __sync_add_and_fetch(value, amount);
 }
-W void cheng_mm_diag_reset(void) {}
-W void cheng_mem_retain(void* p) {}
-W void cheng_mem_release(void* p) {}
+/* Reference-counted heap (cheng_malloc family) with biased counting.
+   Each block is biased to the thread that allocated it: that thread keeps
+   its references in `biased` with plain loads and stores, and every other
+   thread uses the atomic `shared` word (count << 2 | merged | queued).
+   When the owner's count reaches zero the counts merge and the block
+   becomes an ordinary atomic block. A non-owner whose release drives
+   `shared` negative queues the block on the owner, which merges it at its
+   next runtime call.
+   Non-owner releases are also deferred: they go to a small per-thread
+   buffer, where a later retain of the same block cancels them, and are
+   applied a batch at a time (one atomic per distinct block). So workers
+   that retain and release a shared, read-mostly context do not write its
+   cache line at all. Freeing a block never touches other blocks, so
+   destruction never cascades. */
+#define CHENG_RC_MERGED 1
+#define CHENG_RC_QUEUED 2
+#define CHENG_RC_ONE 4
+#define CHENG_RC_DEFER_MAX 64
+#define CHENG_RC_TAG 0x43484e4752433031ull
+#define CHENG_RC_COUNT(field) __atomic_store_n(&(field), (field) + 1, __ATOMIC_RELAXED)
+typedef struct ChengRcThread ChengRcThread;
+typedef struct ChengRcHeader {
+    ChengRcThread* owner;
+    struct ChengRcHeader* next;
+    void* raw;
+    int64_t shared;
+    int32_t biased;
+    int32_t size;
+    uint64_t tag;
+} ChengRcHeader;
+struct ChengRcThread {
+    ChengRcHeader* queue;
+    ChengRcThread* all_next;
+    int32_t deferred_len;
+    void* deferred[CHENG_RC_DEFER_MAX];
+    int64_t allocs, frees, retains, releases;
+};
+#define CHENG_RC_CLOSED ((ChengRcHeader*)1)
+static __thread ChengRcThread* cheng_rc_self;
+static ChengRcThread* cheng_rc_threads;
+static pthread_key_t cheng_rc_key;
+static pthread_once_t cheng_rc_key_once = PTHREAD_ONCE_INIT;
+static void cheng_rc_thread_exit(void* arg);
+static void cheng_rc_key_init(void) { pthread_key_create(&cheng_rc_key, cheng_rc_thread_exit); }
+static ChengRcThread* cheng_rc_thread(void) {
+    ChengRcThread* self = cheng_rc_self;
+    if (self) return self;
+    self = (ChengRcThread*)calloc(1, sizeof(ChengRcThread));
+    if (!self) abort();
+    /* Thread records are never freed: blocks keep pointing at their owner
+       after it exits, and the record then only marks the queue closed. */
+    ChengRcThread* head = __atomic_load_n(&cheng_rc_threads, __ATOMIC_RELAXED);
+    do self->all_next = head;
+    while (!__atomic_compare_exchange_n(&cheng_rc_threads, &head, self, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    pthread_once(&cheng_rc_key_once, cheng_rc_key_init);
+    pthread_setspecific(cheng_rc_key, self);
+    cheng_rc_self = self;
+    return self;
+}
+static ChengRcHeader* cheng_rc_header(void* p) {
+    /* Payloads never start in the first header-size bytes of a page, so
+       reading the header of a foreign pointer stays inside its page. */
+    if (!p || ((uintptr_t)p & 4095) < sizeof(ChengRcHeader)) return 0;
+    ChengRcHeader* h = (ChengRcHeader*)p - 1;
+    return h->tag == (CHENG_RC_TAG ^ (uintptr_t)p) ? h : 0;
+}
+static void cheng_rc_destroy(ChengRcHeader* h) {
+    h->tag = 0;
+    free(h->raw);
+    CHENG_RC_COUNT(cheng_rc_thread()->frees);
+}
+static int cheng_rc_owned(ChengRcHeader* h, ChengRcThread* self) {
+    return h->owner == self && !(__atomic_load_n(&h->shared, __ATOMIC_RELAXED) & CHENG_RC_MERGED);
+}
+/* Folds the owner's count into shared and takes the block off the queue.
+   Runs on the owner, or on anyone once the owner has exited. */
+static void cheng_rc_merge(ChengRcHeader* h) {
+    int32_t b = __atomic_load_n(&h->biased, __ATOMIC_RELAXED);
+    __atomic_store_n(&h->biased, 0, __ATOMIC_RELAXED);
+    int64_t old = __atomic_load_n(&h->shared, __ATOMIC_RELAXED);
+    int64_t next;
+    do {
+        int64_t add = (old & CHENG_RC_MERGED) ? 0 : (int64_t)b * CHENG_RC_ONE;
+        next = ((old & ~(int64_t)3) + add) | CHENG_RC_MERGED;
+    } while (!__atomic_compare_exchange_n(&h->shared, &old, next, 1, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+    if ((next >> 2) == 0) cheng_rc_destroy(h);
+}
+static void cheng_rc_drain(ChengRcThread* self, ChengRcHeader* stop) {
+    ChengRcHeader* h = __atomic_exchange_n(&self->queue, stop, __ATOMIC_ACQ_REL);
+    while (h && h != CHENG_RC_CLOSED) {
+        ChengRcHeader* next = h->next;
+        cheng_rc_merge(h);
+        h = next;
+    }
+}
+static void cheng_rc_enqueue(ChengRcHeader* h) {
+    ChengRcThread* owner = h->owner;
+    ChengRcHeader* head = __atomic_load_n(&owner->queue, __ATOMIC_ACQUIRE);
+    do {
+        if (head == CHENG_RC_CLOSED) {
+            cheng_rc_merge(h);
+            return;
+        }
+        h->next = head;
+    } while (!__atomic_compare_exchange_n(&owner->queue, &head, h, 1, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE));
+}
+/* Drops k shared references. */
+static void cheng_rc_release_shared(ChengRcHeader* h, int32_t k) {
+    int64_t old = __atomic_load_n(&h->shared, __ATOMIC_RELAXED);
+    int64_t next;
+    do {
+        next = old - (int64_t)k * CHENG_RC_ONE;
+        if (!(next & (CHENG_RC_MERGED | CHENG_RC_QUEUED)) && (next >> 2) < 0) next |= CHENG_RC_QUEUED;
+    } while (!__atomic_compare_exchange_n(&h->shared, &old, next, 1, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+    if ((next & CHENG_RC_MERGED) && !(next & CHENG_RC_QUEUED) && (next >> 2) == 0)
+        cheng_rc_destroy(h);
+    else if ((next & CHENG_RC_QUEUED) && !(old & CHENG_RC_QUEUED))
+        cheng_rc_enqueue(h);
+}
+static int cheng_rc_ptr_cmp(const void* a, const void* b) {
+    uintptr_t x = (uintptr_t)*(void* const*)a, y = (uintptr_t)*(void* const*)b;
+    return x < y ? -1 : x > y;
+}
+static void cheng_rc_flush(ChengRcThread* self) {
+    int32_t n = self->deferred_len;
+    self->deferred_len = 0;
+    qsort(self->deferred, (size_t)n, sizeof(void*), cheng_rc_ptr_cmp);
+    for (int32_t i = 0; i < n;) {
+        int32_t j = i + 1;
+        while (j < n && self->deferred[j] == self->deferred[i]) j++;
+        cheng_rc_release_shared((ChengRcHeader*)self->deferred[i] - 1, j - i);
+        i = j;
+    }
+}
+static void cheng_rc_thread_exit(void* arg) {
+    ChengRcThread* self = (ChengRcThread*)arg;
+    cheng_rc_self = self;
+    cheng_rc_flush(self);
+    cheng_rc_drain(self, CHENG_RC_CLOSED);
+    cheng_rc_self = 0;
+}
+W void* cheng_malloc(int size) {
+    ChengRcThread* self = cheng_rc_thread();
+    if (__atomic_load_n(&self->queue, __ATOMIC_RELAXED)) cheng_rc_drain(self, 0);
+    if (size <= 0) size = 1;
+    size_t hdr = sizeof(ChengRcHeader);
+    char* raw = (char*)calloc(1, hdr * 2 + (size_t)size);
+    if (!raw) return 0;
+    char* payload = raw + hdr;
+    if (((uintptr_t)payload & 4095) < hdr) payload += hdr;
+    ChengRcHeader* h = (ChengRcHeader*)payload - 1;
+    h->owner = self;
+    h->raw = raw;
+    h->biased = 1;
+    h->size = size;
+    h->tag = CHENG_RC_TAG ^ (uintptr_t)payload;
+    CHENG_RC_COUNT(self->allocs);
+    return payload;
+}
+W void cheng_free(void* p) {
+    ChengRcHeader* h = cheng_rc_header(p);
+    if (h) cheng_rc_destroy(h);
+}
+W void cheng_mem_retain(void* p) {
+    ChengRcHeader* h = cheng_rc_header(p);
+    if (!h) return;
+    ChengRcThread* self = cheng_rc_thread();
+    CHENG_RC_COUNT(self->retains);
+    if (cheng_rc_owned(h, self)) {
+        __atomic_store_n(&h->biased, h->biased + 1, __ATOMIC_RELAXED);
+        return;
+    }
+    for (int32_t i = self->deferred_len - 1; i >= 0; i--) {
+        if (self->deferred[i] == p) {
+            self->deferred[i] = self->deferred[--self->deferred_len];
+            return;
+        }
+    }
+    __atomic_fetch_add(&h->shared, CHENG_RC_ONE, __ATOMIC_RELAXED);
+}
+W void cheng_mem_release(void* p) {
+    ChengRcHeader* h = cheng_rc_header(p);
+    if (!h) return;
+    ChengRcThread* self = cheng_rc_thread();
+    CHENG_RC_COUNT(self->releases);
+    if (cheng_rc_owned(h, self)) {
+        int32_t b = h->biased - 1;
+        __atomic_store_n(&h->biased, b, __ATOMIC_RELAXED);
+        if (b == 0) {
+            int64_t old = __atomic_fetch_or(&h->shared, CHENG_RC_MERGED, __ATOMIC_ACQ_REL);
+            if (!(old & CHENG_RC_QUEUED) && (old >> 2) == 0) cheng_rc_destroy(h);
+        }
+        if (__atomic_load_n(&self->queue, __ATOMIC_RELAXED)) cheng_rc_drain(self, 0);
+        return;
+    }
+    if (self->deferred_len == CHENG_RC_DEFER_MAX) cheng_rc_flush(self);
+    self->deferred[self->deferred_len++] = p;
+}
+W int cheng_mem_refcount(void* p) {
+    ChengRcHeader* h = cheng_rc_header(p);
+    if (!h) return 0;
+    ChengRcThread* self = cheng_rc_thread();
+    int32_t pending = 0;
+    for (int32_t i = 0; i < self->deferred_len; i++)
+        if (self->deferred[i] == p) pending++;
+    int64_t shared = __atomic_load_n(&h->shared, __ATOMIC_ACQUIRE);
+    int64_t n = (shared >> 2) - pending;
+    if (!(shared & CHENG_RC_MERGED)) n += __atomic_load_n(&h->biased, __ATOMIC_RELAXED);
+    return (int)n;
+}
+W void* cheng_realloc(void* p, int size) {
+    if (!p) return cheng_malloc(size);
+    ChengRcHeader* h = cheng_rc_header(p);
+    if (!h) return 0;
+    void* fresh = cheng_malloc(size);
+    if (!fresh) return 0;
+    memcpy(fresh, p, (size_t)(h->size < size ? h->size : size));
+    cheng_mem_release(p);
+    return fresh;
+}
+W void cheng_mem_retain_atomic(void* p) { cheng_mem_retain(p); }
+W void cheng_mem_release_atomic(void* p) { cheng_mem_release(p); }
+W int cheng_mem_refcount_atomic(void* p) { return cheng_mem_refcount(p); }
+/* Applies this thread's deferred releases now. */
+W void cheng_mem_flush(void) {
+    ChengRcThread* self = cheng_rc_thread();
+    cheng_rc_flush(self);
+    cheng_rc_drain(self, 0);
+}
+static int64_t cheng_rc_stat(size_t field) {
+    int64_t sum = 0;
+    for (ChengRcThread* t = __atomic_load_n(&cheng_rc_threads, __ATOMIC_ACQUIRE); t; t = t->all_next)
+        sum += __atomic_load_n((int64_t*)((char*)t + field), __ATOMIC_RELAXED);
+    return sum;
+}
+W int64_t cheng_mm_retain_count(void) { return cheng_rc_stat(offsetof(ChengRcThread, retains)); }
+W int64_t cheng_mm_release_count(void) { return cheng_rc_stat(offsetof(ChengRcThread, releases)); }
+W int64_t cheng_mm_alloc_count(void) { return cheng_rc_stat(offsetof(ChengRcThread, allocs)); }
+W int64_t cheng_mm_free_count(void) { return cheng_rc_stat(offsetof(ChengRcThread, frees)); }
+W int64_t cheng_mm_live_count(void) {
+    cheng_mem_flush();
+    return cheng_mm_alloc_count() - cheng_mm_free_count();
+}
+W void cheng_mm_diag_reset(void) {
+    for (ChengRcThread* t = __atomic_load_n(&cheng_rc_threads, __ATOMIC_ACQUIRE); t; t = t->all_next) {
+        __atomic_store_n(&t->allocs, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&t->frees, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&t->retains, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&t->releases, 0, __ATOMIC_RELAXED);
+    }
+}
 W int paramCount(void) { return 0; }
 W const char* paramStr(int i) { return ""; }
 W void* load_ptr(void** p) { return p ? *p : 0; }
@@ -218,7 +608,43 @@ W int cheng_os_dir_exists_bridge(const char* p) { struct stat st; return stat(p,
 W long cheng_os_file_size_bridge(const char* p) { struct stat st; return stat(p,&st)==0 ? st.st_size : 0; }
 W int driver_c_create_dir_all_bridge(const char* p) { return mkdir(p,0755); }
 W int driver_c_write_text_file_bridge(const char* p, const char* c) { FILE* f=fopen(p,"w"); if(!f)return 0; fputs(c,f); fclose(f); return 1; }
-W char* cheng_read_file_bridge(const char* p) { static char buf[65536]; FILE* f=fopen(p,"r"); if(!f)return 0; size_t n=fread(buf,1,sizeof(buf)-1,f); fclose(f); buf[n]=0; return buf; }
+/* Whole file in a malloc'd buffer the caller frees, NUL-terminated and sized
+   from fstat; grows if the file is longer than reported. */
+W char* cheng_read_file_owned_bridge(const char* p, long* outLen) {
+    if (outLen) *outLen = 0;
+    int fd = open(p, O_RDONLY);
+    if (fd < 0) return 0;
+    struct stat st;
+    size_t cap = fstat(fd, &st) == 0 && st.st_size > 0 ? (size_t)st.st_size + 1 : 4096;
+    size_t n = 0;
+    char* buf = malloc(cap);
+    while (buf) {
+        if (n + 1 >= cap) {
+            char* grown = realloc(buf, cap * 2);
+            if (!grown) { free(buf); buf = 0; break; }
+            buf = grown;
+            cap *= 2;
+        }
+        ssize_t got = read(fd, buf + n, cap - n - 1);
+        if (got < 0 && errno == EINTR) continue;
+        if (got < 0) { free(buf); buf = 0; break; }
+        if (got == 0) break;
+        n += (size_t)got;
+    }
+    close(fd);
+    if (!buf) return 0;
+    buf[n] = 0;
+    if (outLen) *outLen = (long)n;
+    return buf;
+}
+/* Borrowed contract, as before: the result stays valid until this thread's
+   next call, which frees it. Callers such as path.cheng never free it. */
+W char* cheng_read_file_bridge(const char* p) {
+    static __thread char* last;
+    free(last);
+    last = cheng_read_file_owned_bridge(p, 0);
+    return last;
+}
 /* Additional symbols needed by std/atomic and cold-compiled primary */
 W void echo(const char* s) { puts(s); }
 W void* c_malloc(size_t sz) { return malloc(sz); }
@@ -267,6 +267,8 @@ assert "result_fixed32_roundtrip" 0 "$ACT"
 
 ACT=$(compile_run src/tests/cold_sha256_fixed_probe.cheng /tmp/ct_sha256_fixed)
 assert "sha256_fixed_abc" 0 "$ACT"
+ACT=$(compile_run src/tests/cold_sha2_kat_probe.cheng /tmp/ct_sha2_kat)
+assert "sha2_known_answer" 0 "$ACT"
 
 rm -f /tmp/ct_deep_import
 quiet $COLD system-link-exec --in:src/tests/cold_import_deep_main.cheng \
@@ -596,6 +598,29 @@ else
     ACT=0
 fi
 assert "bd_bootstrap_bridge_stage_binaries" 1 "$ACT"
+# A second run with unchanged compiler and inputs skips every stage step
+cp /tmp/ct_bb/cheng.stage3 /tmp/ct_bb/stage3.before 2>/dev/null
+timeout 300 $COLD bootstrap-bridge --out-dir:/tmp/ct_bb --jobs:2 >/tmp/ct_bb/stdout2 2>/tmp/ct_bb/stderr2
+if [ "$?" -eq 0 ] &&
+   grep -q '^bootstrap_bridge_cached_steps=8$' /tmp/ct_bb/stdout2 &&
+   grep -q '^fixed_point=stage2_stage3_contract_match$' /tmp/ct_bb/stdout2 &&
+   cmp -s /tmp/ct_bb/cheng.stage3 /tmp/ct_bb/stage3.before; then
+    ACT=1
+else
+    ACT=0
+fi
+assert "bd_bootstrap_bridge_stage_cache_hit" 1 "$ACT"
+# A damaged stage binary is rebuilt; identical output keeps later steps cached
+printf 'x' >> /tmp/ct_bb/cheng.stage1
+timeout 300 $COLD bootstrap-bridge --out-dir:/tmp/ct_bb >/tmp/ct_bb/stdout3 2>/tmp/ct_bb/stderr3
+if [ "$?" -eq 0 ] &&
+   grep -q '^bootstrap_bridge_cached_steps=7$' /tmp/ct_bb/stdout3 &&
+   cmp -s /tmp/ct_bb/cheng.stage3 /tmp/ct_bb/stage3.before; then
+    ACT=1
+else
+    ACT=0
+fi
+assert "bd_bootstrap_bridge_stage_cache_invalidate" 1 "$ACT"
 rm -rf /tmp/ct_bb
 
 # --- Report consistency: same build twice produces identical reports (except timestamps) ---
@@ -766,6 +791,66 @@ else
 fi
 assert "provider_archive_multi_link" 1 "$ACT"
 
+# --- provider archive stress: members/exports beyond the old 128/512 caps ---
+rm -rf /tmp/ct_providers/stress
+mkdir -p /tmp/ct_providers/stress
+ct_stress_members=160
+ct_stress_exports=20
+ct_stress_pack_args=()
+ct_stress_obj_ok=1
+for m in $(seq 0 $((ct_stress_members - 1))); do
+    for e in $(seq 0 $((ct_stress_exports - 1))); do
+        printf '@exportc("ct_stress_%d_%d")\nfn StressProvider%d_%d(): int32 = return %d\n\n' \
+            "$m" "$e" "$m" "$e" "$((e + 1))"
+        ct_stress_pack_args+=("--export:ct_stress_${m}_${e}")
+    done > /tmp/ct_providers/stress/p$m.cheng
+    quiet $COLD system-link-exec --in:/tmp/ct_providers/stress/p$m.cheng \
+        --emit:obj --target:riscv64-unknown-linux-gnu \
+        --out:/tmp/ct_providers/stress/p$m.o || ct_stress_obj_ok=0
+    ct_stress_pack_args+=("--object:/tmp/ct_providers/stress/p$m.o")
+done
+{
+    for m in $(seq 0 $((ct_stress_members - 1))); do
+        for e in $(seq 0 $((ct_stress_exports - 1))); do
+            printf '@importc("ct_stress_%d_%d")\nfn stress%d_%d(): int32\n' "$m" "$e" "$m" "$e"
+        done
+    done
+    printf 'fn main(): int32 =\n    var total = 0\n'
+    for m in $(seq 0 $((ct_stress_members - 1))); do
+        for e in $(seq 0 $((ct_stress_exports - 1))); do
+            printf '    total = total + stress%d_%d()\n' "$m" "$e"
+        done
+    done
+    printf '    return total\n'
+} > /tmp/ct_providers/stress/primary.cheng
+quiet $COLD system-link-exec --in:/tmp/ct_providers/stress/primary.cheng \
+    --emit:obj --target:riscv64-unknown-linux-gnu \
+    --out:/tmp/ct_providers/stress/primary.o || ct_stress_obj_ok=0
+quiet $COLD provider-archive-pack \
+    --target:riscv64-unknown-linux-gnu \
+    "${ct_stress_pack_args[@]}" \
+    --module:ct_stress \
+    --out:/tmp/ct_providers/stress/stress.chenga \
+    --report-out:/tmp/ct_providers/stress/pack.report.txt
+quiet $COLD system-link-exec \
+    --link-object:/tmp/ct_providers/stress/primary.o \
+    --provider-archive:/tmp/ct_providers/stress/stress.chenga \
+    --emit:exe --target:riscv64-unknown-linux-gnu \
+    --out:/tmp/ct_providers/stress/linked \
+    --report-out:/tmp/ct_providers/stress/link.report.txt
+if [ "$ct_stress_obj_ok" = "1" ] &&
+   grep -q '^provider_export_count=3200$' /tmp/ct_providers/stress/pack.report.txt 2>/dev/null &&
+   grep -q '^provider_archive_member_count=160$' /tmp/ct_providers/stress/link.report.txt 2>/dev/null &&
+   grep -q '^provider_resolved_symbol_count=3200$' /tmp/ct_providers/stress/link.report.txt 2>/dev/null &&
+   grep -q '^unresolved_symbol_count=0$' /tmp/ct_providers/stress/link.report.txt 2>/dev/null &&
+   [ -s /tmp/ct_providers/stress/linked ]; then
+    ACT=1
+else
+    ACT=0
+fi
+assert "provider_archive_stress_3200_exports" 1 "$ACT"
+rm -rf /tmp/ct_providers/stress
+
 cat > /tmp/ct_providers/alias_provider.cheng << 'PROVEOF'
 @exportc("ct_alias_provider_bridge")
 fn AliasProviderLocalName(): int32 = return 17
@@ -1139,6 +1224,172 @@ else
 fi
 assert "runtime_provider_autolink_cpu_cores" 1 "$ACT"
 
+rm -f /tmp/ct_cpu_budget /tmp/ct_cpu_budget.c
+cat > /tmp/ct_cpu_budget.c <<'EOF'
+#include <stdio.h>
+int cheng_host_cpu_budget(const char* root);
+int cheng_host_cgroup_cpu_limit(const char* root);
+int cheng_host_cpulist_count(const char* list);
+int cheng_program_argv_entry(int argc, char** argv) {
+    static const struct { const char* root; int budget; int limit; } cases[] = {
+        { "testdata/cpu_topology/smt2_numa2", 3, 3 },
+        { "testdata/cpu_topology/affinity_quota", 2, 2 },
+        { "testdata/cpu_topology/affinity_only", 4, 0 },
+    };
+    (void)argc;
+    (void)argv;
+    for (int i = 0; i < 3; i++) {
+        if (cheng_host_cpu_budget(cases[i].root) != cases[i].budget) return 10 + i;
+        if (cheng_host_cgroup_cpu_limit(cases[i].root) != cases[i].limit) return 20 + i;
+    }
+    if (cheng_host_cpulist_count("0-3,8,10-11\n") != 7) return 30;
+    if (cheng_host_cpu_budget("") < 1) return 31;
+    printf("cpu_budget_ok\n");
+    return 0;
+}
+EOF
+if cc -std=gnu11 -o /tmp/ct_cpu_budget /tmp/ct_cpu_budget.c \
+    src/core/runtime/host_runtime_stubs.c -lpthread >/dev/null 2>&1 &&
+   /tmp/ct_cpu_budget 2>/dev/null | grep -q '^cpu_budget_ok$'; then
+    ACT=1
+else
+    ACT=0
+fi
+assert "host_cpu_budget_fixtures" 1 "$ACT"
+
+rm -f /tmp/ct_read_file /tmp/ct_read_file.c /tmp/ct_read_file.dat
+cat > /tmp/ct_read_file.c <<'EOF'
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+char* cheng_read_file_bridge(const char* p);
+char* cheng_read_file_owned_bridge(const char* p, long* outLen);
+int cheng_program_argv_entry(int argc, char** argv) {
+    FILE* f = fopen("/tmp/ct_read_file.dat", "wb");
+    if (!f) return 1;
+    for (int i = 0; i < 200000; i++) fputc('a' + i % 26, f);
+    fputc(0, f);
+    fputs("after-nul", f);
+    fclose(f);
+    long n = -1;
+    char* a = cheng_read_file_owned_bridge("/tmp/ct_read_file.dat", &n);
+    if (!a || n != 200010) return 2;
+    if (a[199999] != 'a' + 199999 % 26 || memcmp(a + 200001, "after-nul", 9) != 0 || a[n] != 0) return 3;
+    char* b = cheng_read_file_bridge("/tmp/ct_read_file.dat");
+    if (!b || b == a || strlen(b) != 200000) return 4;
+    free(a);
+    char* c = cheng_read_file_bridge("/tmp/ct_read_file.dat");
+    if (!c || strlen(c) != 200000 || cheng_read_file_bridge("/tmp/ct_read_file.missing") != 0) return 6;
+    if (cheng_read_file_owned_bridge("/tmp/ct_read_file.missing", &n) != 0 || n != 0) return 5;
+    printf("read_file_ok\n");
+    return 0;
+}
+EOF
+if cc -std=gnu11 -o /tmp/ct_read_file /tmp/ct_read_file.c \
+    src/core/runtime/host_runtime_stubs.c -lpthread >/dev/null 2>&1 &&
+   /tmp/ct_read_file 2>/dev/null | grep -q '^read_file_ok$'; then
+    ACT=1
+else
+    ACT=0
+fi
+assert "host_read_file_owned_bridge" 1 "$ACT"
+
+rm -f /tmp/ct_host_rc /tmp/ct_host_rc.c
+cat > /tmp/ct_host_rc.c <<'EOF'
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+void* cheng_malloc(int size);
+void* cheng_realloc(void* p, int size);
+void cheng_mem_retain(void* p);
+void cheng_mem_release(void* p);
+int cheng_mem_refcount(void* p);
+void cheng_mem_flush(void);
+int64_t cheng_mm_live_count(void);
+static void* slots[4096];
+static int produced;
+static void* shared_ctx;
+static void* orphan;
+static void* producer(void* arg) {
+    (void)arg;
+    for (int i = 0; i < 4096; i++) {
+        int* p = (int*)cheng_malloc(16);
+        p[0] = i;
+        cheng_mem_retain(p);
+        __atomic_store_n(&slots[i], p, __ATOMIC_RELEASE);
+        cheng_mem_release(p);
+    }
+    __atomic_store_n(&produced, 1, __ATOMIC_RELEASE);
+    return 0;
+}
+static void* consumer(void* arg) {
+    long sum = 0;
+    for (int i = (int)(intptr_t)arg; i < 4096; i += 2) {
+        void* p;
+        while (!(p = __atomic_load_n(&slots[i], __ATOMIC_ACQUIRE))) sched_yield();
+        cheng_mem_retain(p);
+        sum += ((int*)p)[0];
+        cheng_mem_release(p);
+        cheng_mem_release(p);
+    }
+    return (void*)sum;
+}
+static void* sharer(void* arg) {
+    (void)arg;
+    for (int i = 0; i < 100000; i++) {
+        cheng_mem_retain(shared_ctx);
+        cheng_mem_release(shared_ctx);
+    }
+    return 0;
+}
+static void* orphan_maker(void* arg) {
+    (void)arg;
+    orphan = cheng_malloc(8);
+    return 0;
+}
+int cheng_program_argv_entry(int argc, const char** argv) {
+    (void)argc;
+    (void)argv;
+    void* a = cheng_malloc(10);
+    cheng_mem_retain(a);
+    void* b = cheng_realloc(a, 100);
+    if (cheng_mem_refcount(a) != 1 || cheng_mem_refcount(b) != 1) return 1;
+    cheng_mem_release(a);
+    cheng_mem_release(b);
+    cheng_mem_retain((void*)"not a heap block");
+    pthread_t t[4];
+    pthread_create(&t[0], 0, producer, 0);
+    pthread_create(&t[1], 0, consumer, (void*)0);
+    pthread_create(&t[2], 0, consumer, (void*)1);
+    long sum = 0;
+    for (int i = 0; i < 3; i++) {
+        void* r = 0;
+        pthread_join(t[i], &r);
+        if (i > 0) sum += (long)r;
+    }
+    if (sum != 4096L * 4095 / 2) return 2;
+    shared_ctx = cheng_malloc(64);
+    for (int i = 0; i < 4; i++) pthread_create(&t[i], 0, sharer, 0);
+    for (int i = 0; i < 4; i++) pthread_join(t[i], 0);
+    if (cheng_mem_refcount(shared_ctx) != 1) return 3;
+    cheng_mem_release(shared_ctx);
+    pthread_create(&t[0], 0, orphan_maker, 0);
+    pthread_join(t[0], 0);
+    cheng_mem_release(orphan);
+    if (cheng_mm_live_count() != 0) return 4;
+    printf("host_rc_ok\n");
+    return 0;
+}
+EOF
+if cc -std=gnu11 -o /tmp/ct_host_rc /tmp/ct_host_rc.c \
+    src/core/runtime/host_runtime_stubs.c -lpthread >/dev/null 2>&1 &&
+   /tmp/ct_host_rc 2>/dev/null | grep -q '^host_rc_ok$'; then
+    ACT=1
+else
+    ACT=0
+fi
+assert "host_biased_rc_handoff" 1 "$ACT"
+
 rm -f /tmp/ct_runtime/thread_join_pool \
     /tmp/ct_runtime/thread_join_pool.report.txt
 quiet $COLD system-link-exec \
@@ -2915,6 +3166,179 @@ fi
 assert "cold_parallel_determinism_sha" 1 "$ACT"
 rm -f /tmp/ct_pdet_1.o /tmp/ct_pdet_4.o /tmp/ct_pdet_1.report /tmp/ct_pdet_4.report
 
+# --- parallel lowering determinism: BACKEND_JOBS=1 vs 4 byte-identical exe ---
+rm -f /tmp/ct_pldet_1 /tmp/ct_pldet_4 /tmp/ct_pldet_1.report /tmp/ct_pldet_4.report
+BACKEND_JOBS=1 $COLD system-link-exec --root:"$PWD" \
+    --in:examples/backend_fullchain_smoke.cheng --target:arm64-apple-darwin \
+    --out:/tmp/ct_pldet_1 --emit:exe \
+    --report-out:/tmp/ct_pldet_1.report >/dev/null 2>&1
+rc1=$?
+BACKEND_JOBS=4 $COLD system-link-exec --root:"$PWD" \
+    --in:examples/backend_fullchain_smoke.cheng --target:arm64-apple-darwin \
+    --out:/tmp/ct_pldet_4 --emit:exe \
+    --report-out:/tmp/ct_pldet_4.report >/dev/null 2>&1
+rc4=$?
+if [ "$rc1" -eq 0 ] && [ "$rc4" -eq 0 ] &&
+   grep -q '^lowering_parallel_status=serial$' /tmp/ct_pldet_1.report &&
+   grep -q '^lowering_parallel_functions=0$' /tmp/ct_pldet_1.report &&
+   grep -q '^lowering_parallel_status=parallel$' /tmp/ct_pldet_4.report &&
+   ! grep -q '^lowering_parallel_functions=0$' /tmp/ct_pldet_4.report; then
+    ACT=1
+else
+    ACT=0
+fi
+assert "cold_parallel_lowering_report" 1 "$ACT"
+if [ -s /tmp/ct_pldet_1 ] && cmp -s /tmp/ct_pldet_1 /tmp/ct_pldet_4; then
+    ACT=1
+else
+    ACT=0
+fi
+assert "cold_parallel_lowering_determinism" 1 "$ACT"
+rm -f /tmp/ct_pldet_1 /tmp/ct_pldet_4 /tmp/ct_pldet_1.report /tmp/ct_pldet_4.report
+for pl_src in src/tests/cold_subset_coverage.cheng \
+              src/tests/browser_wasm_probe_seq_arg_min.cheng \
+              src/tests/backend_matrix_stack_args_9plus.cheng \
+              src/tests/cold_bootstrap_kernel_frontend_scan.cheng; do
+    pl_tag=$(basename "$pl_src" .cheng)
+    ACT=1
+    for pl_jobs in 1 3 8; do
+        rm -f "/tmp/ct_pldet_$pl_jobs" "/tmp/ct_pldet_$pl_jobs.report"
+        BACKEND_JOBS=$pl_jobs $COLD system-link-exec --root:"$PWD" \
+            --in:"$pl_src" --target:arm64-apple-darwin \
+            --out:"/tmp/ct_pldet_$pl_jobs" --emit:exe \
+            --report-out:"/tmp/ct_pldet_$pl_jobs.report" >/dev/null 2>&1 || ACT=0
+    done
+    if [ "$ACT" -eq 1 ] && [ -s /tmp/ct_pldet_1 ] &&
+       cmp -s /tmp/ct_pldet_1 /tmp/ct_pldet_3 && cmp -s /tmp/ct_pldet_1 /tmp/ct_pldet_8 &&
+       ! grep -q '^lowering_parallel_functions=0$' /tmp/ct_pldet_8.report; then
+        ACT=1
+    else
+        ACT=0
+    fi
+    assert "cold_parallel_lowering_determinism_$pl_tag" 1 "$ACT"
+done
+rm -f /tmp/ct_pldet_1 /tmp/ct_pldet_3 /tmp/ct_pldet_8 \
+      /tmp/ct_pldet_1.report /tmp/ct_pldet_3.report /tmp/ct_pldet_8.report
+
+# --- arena reuse: outgrown BodyIR arrays are recycled and reported ---
+rm -f /tmp/ct_arena_big.cheng /tmp/ct_arena_big /tmp/ct_arena_big.report
+{
+    echo "fn big(n: int32): int32 ="
+    echo "    var acc: int32 = n"
+    for ai in $(seq 1 300); do
+        echo "    let v$ai: int32 = acc + $ai"
+        echo "    acc = v$ai * 3 - n"
+    done
+    echo "    return acc"
+    echo ""
+    echo "fn main(): int32 = return big(1) - big(1)"
+} > /tmp/ct_arena_big.cheng
+quiet $COLD system-link-exec --in:/tmp/ct_arena_big.cheng \
+    --target:arm64-apple-darwin --emit:exe --out:/tmp/ct_arena_big \
+    --report-out:/tmp/ct_arena_big.report
+arena_reused=$(sed -n 's/^arena_free_list_reused_bytes=//p' /tmp/ct_arena_big.report 2>/dev/null)
+if [ -s /tmp/ct_arena_big ] &&
+   grep -q '^arena_zero_fill_skipped_bytes=[1-9]' /tmp/ct_arena_big.report &&
+   grep -q '^arena_reuse_saved_bytes=' /tmp/ct_arena_big.report &&
+   [ "${arena_reused:-0}" -gt 0 ]; then
+    ACT=1
+else
+    ACT=0
+fi
+assert "cold_arena_reuse_report" 1 "$ACT"
+rm -f /tmp/ct_arena_big.cheng /tmp/ct_arena_big /tmp/ct_arena_big.report
+
+# --- compile server: served builds are byte-identical to one-shot builds ---
+rm -rf /tmp/ct_srv
+mkdir -p /tmp/ct_srv
+cp examples/backend_fullchain_smoke.cheng /tmp/ct_srv/in.cheng
+$COLD serve --socket:/tmp/ct_srv/sock >/tmp/ct_srv/serve.log 2>&1 &
+srv_pid=$!
+for srv_i in $(seq 1 50); do
+    [ -S /tmp/ct_srv/sock ] && break
+    sleep 0.1
+done
+srv_build() {
+    $COLD serve-client --socket:/tmp/ct_srv/sock system-link-exec \
+        --in:/tmp/ct_srv/in.cheng --target:arm64-apple-darwin --emit:exe \
+        --out:/tmp/ct_srv/served >/dev/null 2>&1
+}
+one_build() {
+    $COLD system-link-exec --in:/tmp/ct_srv/in.cheng --target:arm64-apple-darwin \
+        --emit:exe --out:/tmp/ct_srv/oneshot >/dev/null 2>&1
+}
+srv_build; srv_rc1=$?
+one_build
+cmp -s /tmp/ct_srv/served /tmp/ct_srv/oneshot; srv_same1=$?
+rm -f /tmp/ct_srv/served
+srv_build; srv_rc2=$?
+cmp -s /tmp/ct_srv/served /tmp/ct_srv/oneshot; srv_same2=$?
+sed -i.bak 's/8128/8129/' /tmp/ct_srv/in.cheng
+srv_build; srv_rc3=$?
+one_build
+cmp -s /tmp/ct_srv/served /tmp/ct_srv/oneshot; srv_same3=$?
+# A directory listing has no content hash, so that build is never cached.
+mkdir -p /tmp/ct_srv/providers
+for srv_i in 4 5; do
+    $COLD serve-client --socket:/tmp/ct_srv/sock system-link-exec \
+        --in:/tmp/ct_srv/in.cheng --target:arm64-apple-darwin --emit:exe \
+        --provider-archive-dir:/tmp/ct_srv/providers \
+        --out:/tmp/ct_srv/served_dir >/dev/null 2>&1
+done
+$COLD serve-client --socket:/tmp/ct_srv/sock serve-stop >/dev/null 2>&1
+wait "$srv_pid" 2>/dev/null
+if [ "$srv_rc1" -eq 0 ] && [ "$srv_rc2" -eq 0 ] && [ "$srv_rc3" -eq 0 ] &&
+   [ "$srv_same1" -eq 0 ] && [ "$srv_same2" -eq 0 ] && [ "$srv_same3" -eq 0 ] &&
+   [ -s /tmp/ct_srv/oneshot ]; then
+    ACT=1
+else
+    ACT=0
+fi
+assert "cold_serve_matches_oneshot" 1 "$ACT"
+if grep -q '^serve_request=2 cache=hit rc=0' /tmp/ct_srv/serve.log &&
+   grep -q '^serve_request=3 cache=miss rc=0' /tmp/ct_srv/serve.log &&
+   grep -q '^serve_request=5 cache=miss rc=0' /tmp/ct_srv/serve.log &&
+   grep -q '^serve_stopped=1$' /tmp/ct_srv/serve.log; then
+    ACT=1
+else
+    ACT=0
+fi
+assert "cold_serve_content_hash_cache" 1 "$ACT"
+# The edited build reuses the bodies of the functions it did not touch.
+if grep -q '^serve_request=1 cache=miss rc=0 .* bodies_reused=0 ' /tmp/ct_srv/serve.log &&
+   grep -q '^serve_request=3 cache=miss rc=0 .* bodies_reused=[1-9]' /tmp/ct_srv/serve.log; then
+    ACT=1
+else
+    ACT=0
+fi
+assert "cold_serve_body_reuse" 1 "$ACT"
+rm -rf /tmp/ct_srv
+
+# --- per-function Chrome trace: --trace-out spans with worker thread ids ---
+rm -f /tmp/ct_trace /tmp/ct_trace_plain /tmp/ct_trace.json
+BACKEND_JOBS=4 $COLD system-link-exec --root:"$PWD" \
+    --in:examples/backend_fullchain_smoke.cheng --target:arm64-apple-darwin \
+    --out:/tmp/ct_trace --emit:exe --trace-out:/tmp/ct_trace.json >/dev/null 2>&1
+trace_rc=$?
+BACKEND_JOBS=4 $COLD system-link-exec --root:"$PWD" \
+    --in:examples/backend_fullchain_smoke.cheng --target:arm64-apple-darwin \
+    --out:/tmp/ct_trace_plain --emit:exe >/dev/null 2>&1
+if [ "$trace_rc" -eq 0 ] && [ -s /tmp/ct_trace.json ] &&
+   grep -q '^{"displayTimeUnit":"ms","traceEvents":\[' /tmp/ct_trace.json &&
+   grep -q '"name":"sumTo","cat":"parse","ph":"X"' /tmp/ct_trace.json &&
+   grep -q '"name":"sumTo","cat":"optimize","ph":"X"' /tmp/ct_trace.json &&
+   grep -q '"name":"sumTo","cat":"codegen","ph":"X"' /tmp/ct_trace.json &&
+   grep -q '"name":"function_patches","cat":"patch","ph":"X"' /tmp/ct_trace.json &&
+   grep -q '"name":"thread_name","ph":"M","pid":1,"tid":1' /tmp/ct_trace.json &&
+   tail -n 1 /tmp/ct_trace.json | grep -q '^\]}$' &&
+   cmp -s /tmp/ct_trace /tmp/ct_trace_plain; then
+    ACT=1
+else
+    ACT=0
+fi
+assert "cold_trace_out_function_spans" 1 "$ACT"
+rm -f /tmp/ct_trace /tmp/ct_trace_plain /tmp/ct_trace.json
+
 # --- cold compiler --version test ---
 COLD_VERSION=$($COLD --version 2>/dev/null)
 if [ -n "$COLD_VERSION" ] && echo "$COLD_VERSION" | grep -q .; then
@@ -3323,6 +3747,606 @@ fi
 assert "x64_linux_probe_tmp_real_target_smoke" 1 "$ACT"
 rm -f /tmp/ct_x64_probe.o /tmp/ct_x64_probe.report
 
+# --- x86_64 executable: only functions reachable from main are laid out ---
+rm -f /tmp/ct_x64_prune.cheng /tmp/ct_x64_prune.csg /tmp/ct_x64_prune
+cat > /tmp/ct_x64_prune.cheng <<'EOF'
+fn deadCode(x: int32): int32 =
+    return x + 1592594996
+
+fn liveCode(x: int32): int32 =
+    return x + 1450744508
+
+fn main(): int32 =
+    return liveCode(1) - 1450744508
+EOF
+ACT=0
+if $COLD system-link-exec --root:"$PWD" --in:/tmp/ct_x64_prune.cheng \
+    --target:x86_64-unknown-linux-gnu --emit:csg-v2 --out:/tmp/ct_x64_prune.csg >/dev/null 2>&1 &&
+   $COLD system-link-exec --root:"$PWD" --csg-in:/tmp/ct_x64_prune.csg \
+    --target:x86_64-unknown-linux-gnu --emit:exe --out:/tmp/ct_x64_prune >/dev/null 2>&1 &&
+   file /tmp/ct_x64_prune 2>/dev/null | grep -q 'ELF 64-bit.*x86-64'; then
+    x64_prune_hex=$(od -An -tx1 /tmp/ct_x64_prune | tr -d ' \n')
+    if echo "$x64_prune_hex" | grep -q 'bc9a7856' &&
+       ! echo "$x64_prune_hex" | grep -q '3412ed5e'; then
+        ACT=1
+        if [ "$(uname -s)-$(uname -m)" = "Linux-x86_64" ]; then
+            x64_prune_rc=0
+            /tmp/ct_x64_prune >/dev/null 2>&1 || x64_prune_rc=$?
+            [ "$x64_prune_rc" = "1" ] || ACT=0
+        fi
+    fi
+fi
+assert "x64_exe_reachability_pruning" 1 "$ACT"
+rm -f /tmp/ct_x64_prune.cheng /tmp/ct_x64_prune.csg /tmp/ct_x64_prune
+
+# --- x86_64 executable: register-allocated scalars, SysV calls, loops, match ---
+rm -f /tmp/ct_x64_ra.cheng /tmp/ct_x64_ra.csg /tmp/ct_x64_ra
+cat > /tmp/ct_x64_ra.cheng <<'EOF'
+type Shape = Dot | Line | Box
+
+fn sumTo(n: int32): int32 =
+    var total = 0
+    var i = 1
+    while i <= n:
+        total = total + i
+        i = i + 1
+    return total
+
+fn fib(n: int32): int32 =
+    if n < 2:
+        return n
+    return fib(n - 1) + fib(n - 2)
+
+fn mix(a: int32, b: int32, c: int32, d: int32, e: int32, f: int32): int32 =
+    return a * 100 + b * 10 - c / 2 + d % 3 - e + f
+
+fn wide(a: int64, b: int64): int64 =
+    return a * b - (a >> 3) + (b << 2)
+
+fn classify(k: int32): int32 =
+    var c: Shape = Shape.Dot
+    if k == 1:
+        c = Shape.Line
+    if k == 7:
+        c = Shape.Box
+    match c:
+        Dot => return 1
+        Line => return 5
+        Box => return 9
+
+fn main(): int32 =
+    var shapes = 0
+    var k = 0
+    while k < 9:
+        shapes = shapes + classify(k)
+        k = k + 1
+    let w: int32 = int32(wide(1000, 3000) - 3000000)
+    return sumTo(10) + fib(10) + mix(1, 2, 9, 5, 4, 3) + shapes + w - 300
+EOF
+ACT=0
+if $COLD system-link-exec --root:"$PWD" --in:/tmp/ct_x64_ra.cheng \
+    --target:x86_64-unknown-linux-gnu --emit:csg-v2 --out:/tmp/ct_x64_ra.csg >/dev/null 2>&1 &&
+   $COLD system-link-exec --root:"$PWD" --csg-in:/tmp/ct_x64_ra.csg \
+    --target:x86_64-unknown-linux-gnu --emit:exe --out:/tmp/ct_x64_ra >/dev/null 2>&1 &&
+   file /tmp/ct_x64_ra 2>/dev/null | grep -q 'ELF 64-bit.*x86-64'; then
+    ACT=1
+    if [ "$(uname -s)-$(uname -m)" = "Linux-x86_64" ]; then
+        x64_ra_rc=0
+        /tmp/ct_x64_ra >/dev/null 2>&1 || x64_ra_rc=$?
+        [ "$x64_ra_rc" = "47" ] || ACT=0
+    fi
+fi
+assert "x64_exe_register_allocation" 1 "$ACT"
+rm -f /tmp/ct_x64_ra.csg /tmp/ct_x64_ra
+
+# --- riscv64 executable: shared register allocator, RVC post-link pass ---
+# Same program as above; runs under qemu-riscv64 when it is installed.
+rm -f /tmp/ct_rv64_ra.csg /tmp/ct_rv64_ra /tmp/ct_rv64_ra.report /tmp/ct_rv64_ra_g
+ACT=0
+if $COLD system-link-exec --root:"$PWD" --in:/tmp/ct_x64_ra.cheng \
+    --target:riscv64-unknown-linux-gnu --emit:csg-v2 --out:/tmp/ct_rv64_ra.csg >/dev/null 2>&1 &&
+   $COLD system-link-exec --root:"$PWD" --csg-in:/tmp/ct_rv64_ra.csg \
+    --target:riscv64-unknown-linux-gnu --emit:exe --out:/tmp/ct_rv64_ra \
+    --report-out:/tmp/ct_rv64_ra.report >/dev/null 2>&1 &&
+   $COLD system-link-exec --root:"$PWD" --csg-in:/tmp/ct_rv64_ra.csg \
+    --target:riscv64-unknown-linux-gnu --emit:exe --riscv-features:rv64g \
+    --out:/tmp/ct_rv64_ra_g >/dev/null 2>&1 &&
+   file /tmp/ct_rv64_ra 2>/dev/null | grep -q 'ELF 64-bit.*RISC-V'; then
+    rv64_rvc_saved=$(sed -n 's/^cold_rvc_saved_bytes=//p' /tmp/ct_rv64_ra.report)
+    rv64_size=$(wc -c < /tmp/ct_rv64_ra)
+    rv64_g_size=$(wc -c < /tmp/ct_rv64_ra_g)
+    if [ "${rv64_rvc_saved:-0}" -gt 0 ] && [ "$rv64_size" -lt "$rv64_g_size" ]; then
+        ACT=1
+        if command -v qemu-riscv64 >/dev/null 2>&1; then
+            rv64_ra_rc=0
+            qemu-riscv64 /tmp/ct_rv64_ra >/dev/null 2>&1 || rv64_ra_rc=$?
+            [ "$rv64_ra_rc" = "47" ] || ACT=0
+        fi
+    fi
+fi
+assert "rv64_exe_register_allocation_rvc" 1 "$ACT"
+rm -f /tmp/ct_rv64_ra.csg /tmp/ct_rv64_ra /tmp/ct_rv64_ra.report /tmp/ct_rv64_ra_g
+rm -f /tmp/ct_x64_ra.cheng
+
+# --- bounds-check elimination: indices dominated by i < len drop their traps ---
+# ct_bce_keep hands the seq to a var parameter inside the loop, so its check stays.
+rm -f /tmp/ct_bce.cheng /tmp/ct_bce_keep.cheng /tmp/ct_bce*.csg /tmp/ct_bce /tmp/ct_bce_keep /tmp/ct_bce*.report
+cat > /tmp/ct_bce.cheng <<'EOF'
+fn sumBytes(s: str): int32 =
+    var total = 0
+    for i in 0 ..< s.len:
+        total = total + s[i]
+    return total
+
+fn sumSeq(xs: int32[]): int32 =
+    var total = 0
+    var i = 0
+    while i < xs.len:
+        total = total + xs[i]
+        i = i + 1
+    return total
+
+fn main(): int32 =
+    var xs: int32[]
+    xs = []
+    add(xs, 3)
+    add(xs, 4)
+    return sumBytes("ab") - 195 + sumSeq(xs)
+EOF
+cat > /tmp/ct_bce_keep.cheng <<'EOF'
+fn bump(xs: var int32[]) =
+    add(xs, 9)
+
+fn main(): int32 =
+    var xs: int32[]
+    xs = []
+    add(xs, 3)
+    var t = 0
+    var i = 0
+    while i < xs.len:
+        t = t + xs[i]
+        if i == 0:
+            bump(xs)
+        i = i + 1
+    return t
+EOF
+ACT=0
+bce_built=1
+for bce in ct_bce ct_bce_keep; do
+    $COLD system-link-exec --root:"$PWD" --in:/tmp/$bce.cheng \
+        --target:riscv64-unknown-linux-gnu --emit:csg-v2 --out:/tmp/$bce.csg >/dev/null 2>&1 &&
+    $COLD system-link-exec --root:"$PWD" --csg-in:/tmp/$bce.csg \
+        --target:riscv64-unknown-linux-gnu --emit:exe --out:/tmp/$bce \
+        --report-out:/tmp/$bce.report >/dev/null 2>&1 || bce_built=0
+done
+if [ "$bce_built" = "1" ]; then
+    bce_removed=$(sed -n 's/^bce_checks_removed=//p' /tmp/ct_bce.report)
+    bce_kept=$(sed -n 's/^bce_checks_removed=//p' /tmp/ct_bce_keep.report)
+    if [ "${bce_removed:-0}" -ge 2 ] && [ "${bce_kept:-1}" = "0" ]; then
+        ACT=1
+        if command -v qemu-riscv64 >/dev/null 2>&1; then
+            bce_rc=0
+            qemu-riscv64 /tmp/ct_bce >/dev/null 2>&1 || bce_rc=$?
+            [ "$bce_rc" = "7" ] || ACT=0
+            bce_rc=0
+            qemu-riscv64 /tmp/ct_bce_keep >/dev/null 2>&1 || bce_rc=$?
+            [ "$bce_rc" = "12" ] || ACT=0
+        fi
+    fi
+fi
+assert "bounds_check_elimination" 1 "$ACT"
+rm -f /tmp/ct_bce.cheng /tmp/ct_bce_keep.cheng /tmp/ct_bce*.csg /tmp/ct_bce /tmp/ct_bce_keep /tmp/ct_bce*.report
+
+# --- value numbering + induction multiplies: repeated i * 3 folds into one value,
+# and i * k becomes an accumulator. kk changes inside the loop, so its multiply stays.
+rm -f /tmp/ct_gvn.cheng /tmp/ct_gvn*.csg /tmp/ct_gvn /tmp/ct_gvn_rv /tmp/ct_gvn*.report
+cat > /tmp/ct_gvn.cheng <<'EOF'
+fn varying(n: int32, k: int32): int32 =
+    var s = 0
+    var i = 0
+    var kk = k
+    while i < n:
+        s = s + i * kk
+        if i == 2:
+            kk = kk + 1
+        i = i + 1
+    return s
+
+fn strided(n: int32): int32 =
+    var s = 0
+    for i in 0 ..< n:
+        s = s + i * 3 + i * 3
+    var j = 1
+    while j < 20:
+        s = s + j * 5
+        j = j + 3
+    return s
+
+fn main(): int32 =
+    return varying(5, 2) + strided(4) - 200
+EOF
+ACT=0
+quiet $COLD system-link-exec --root:"$PWD" --in:/tmp/ct_gvn.cheng \
+    --target:arm64-apple-darwin --emit:exe --out:/tmp/ct_gvn \
+    --report-out:/tmp/ct_gvn.report
+gvn_reused=$(sed -n 's/^gvn_values_reused=//p' /tmp/ct_gvn.report 2>/dev/null)
+gvn_iv=$(sed -n 's/^iv_muls_reduced=//p' /tmp/ct_gvn.report 2>/dev/null)
+if [ "${gvn_reused:-0}" -ge 1 ] && [ "${gvn_iv:-0}" -ge 2 ]; then
+    ACT=1
+    # a CSG roundtrip runs the same optimizer and reports the same counters
+    quiet $COLD system-link-exec --root:"$PWD" --in:/tmp/ct_gvn.cheng \
+        --target:riscv64-unknown-linux-gnu --emit:csg-v2 --out:/tmp/ct_gvn.csg
+    quiet $COLD system-link-exec --root:"$PWD" --csg-in:/tmp/ct_gvn.csg \
+        --target:riscv64-unknown-linux-gnu --emit:csg-v2 --out:/tmp/ct_gvn_opt.csg \
+        --report-out:/tmp/ct_gvn_rt.report
+    rt_reused=$(sed -n 's/^gvn_values_reused=//p' /tmp/ct_gvn_rt.report 2>/dev/null)
+    rt_iv=$(sed -n 's/^iv_muls_reduced=//p' /tmp/ct_gvn_rt.report 2>/dev/null)
+    rt_skipped=$(sed -n 's/^iv_muls_skipped_capacity=//p' /tmp/ct_gvn_rt.report 2>/dev/null)
+    [ "${rt_reused:-0}" -ge 1 ] && [ "${rt_iv:-0}" -ge 2 ] && [ "$rt_skipped" = "0" ] || ACT=0
+    # the rewritten IR runs on riscv64
+    if [ "$ACT" = "1" ] && command -v qemu-riscv64 >/dev/null 2>&1; then
+        gvn_rc=0
+        $COLD system-link-exec --root:"$PWD" --csg-in:/tmp/ct_gvn_opt.csg \
+            --target:riscv64-unknown-linux-gnu --emit:exe --out:/tmp/ct_gvn_rv >/dev/null 2>&1 || gvn_rc=-1
+        [ "$gvn_rc" = "0" ] && { qemu-riscv64 /tmp/ct_gvn_rv >/dev/null 2>&1 || gvn_rc=$?; }
+        [ "$gvn_rc" = "213" ] || ACT=0
+    fi
+fi
+assert "gvn_iv_strength_reduction" 1 "$ACT"
+rm -f /tmp/ct_gvn.cheng /tmp/ct_gvn*.csg /tmp/ct_gvn /tmp/ct_gvn_rv /tmp/ct_gvn*.report
+
+# --- profile-guided layout: an instrumented build writes block counts at exit,
+# and --profile-use: of that file moves the cold blocks out of the hot loop.
+rm -f /tmp/ct_pgo.cheng /tmp/ct_pgo*.csg /tmp/ct_pgo_* /tmp/ct_pgo*.report /tmp/ct_pgo*.profile
+cat > /tmp/ct_pgo.cheng <<'EOF'
+fn classify(n: int32): int32 =
+    if n % 97 == 0:
+        return 3
+    if n % 2 == 0:
+        return 1
+    return 2
+
+fn main(): int32 =
+    var total = 0
+    var i = 0
+    while i < 1000:
+        let k = classify(i)
+        if k == 3:
+            total = total + 5
+        else:
+            total = total + k
+        i = i + 1
+    return total % 256
+EOF
+ACT=0
+pgo_targets=""
+command -v qemu-riscv64 >/dev/null 2>&1 && pgo_targets="riscv64-unknown-linux-gnu"
+[ "$(uname -sm)" = "Linux x86_64" ] && pgo_targets="$pgo_targets x86_64-unknown-linux-gnu"
+pgo_ok=1
+for pgo_t in ${pgo_targets:-riscv64-unknown-linux-gnu}; do
+    pgo_b=/tmp/ct_pgo_${pgo_t%%-*}
+    pgo_rc=0
+    $COLD system-link-exec --root:"$PWD" --in:/tmp/ct_pgo.cheng \
+        --target:$pgo_t --emit:csg-v2 --out:$pgo_b.csg >/dev/null 2>&1 &&
+    $COLD system-link-exec --root:"$PWD" --csg-in:$pgo_b.csg --target:$pgo_t \
+        --emit:exe --out:$pgo_b.instr --instrument --report-out:$pgo_b.instr.report >/dev/null 2>&1 || pgo_ok=0
+    pgo_blocks=$(sed -n 's/^profile_instrumented_blocks=//p' $pgo_b.instr.report 2>/dev/null)
+    [ "${pgo_blocks:-0}" -ge 4 ] || pgo_ok=0
+    [ -z "$pgo_targets" ] && continue
+    if [ "$pgo_t" = "riscv64-unknown-linux-gnu" ]; then
+        qemu-riscv64 $pgo_b.instr >/dev/null 2>&1 || pgo_rc=$?
+    else
+        $pgo_b.instr >/dev/null 2>&1 || pgo_rc=$?
+    fi
+    [ "$pgo_rc" = "3" ] && [ "$(head -c 8 $pgo_b.instr.profile 2>/dev/null)" = "CHPROF01" ] || pgo_ok=0
+    $COLD system-link-exec --root:"$PWD" --csg-in:$pgo_b.csg --target:$pgo_t \
+        --emit:exe --out:$pgo_b.use --profile-use:$pgo_b.instr.profile \
+        --report-out:$pgo_b.use.report >/dev/null 2>&1 || pgo_ok=0
+    pgo_matched=$(sed -n 's/^profile_functions_matched=//p' $pgo_b.use.report 2>/dev/null)
+    pgo_moved=$(sed -n 's/^profile_blocks_moved=//p' $pgo_b.use.report 2>/dev/null)
+    [ "${pgo_matched:-0}" = "2" ] && [ "${pgo_moved:-0}" -ge 1 ] || pgo_ok=0
+    pgo_rc=0
+    if [ "$pgo_t" = "riscv64-unknown-linux-gnu" ]; then
+        qemu-riscv64 $pgo_b.use >/dev/null 2>&1 || pgo_rc=$?
+    else
+        $pgo_b.use >/dev/null 2>&1 || pgo_rc=$?
+    fi
+    [ "$pgo_rc" = "3" ] || pgo_ok=0
+done
+# instrumenting a Mach-O image, or both modes at once, is a usage error
+pgo_rc=0
+$COLD system-link-exec --root:"$PWD" --in:/tmp/ct_pgo.cheng --target:arm64-apple-darwin \
+    --emit:exe --out:/tmp/ct_pgo_macho --instrument >/dev/null 2>&1 || pgo_rc=$?
+[ "$pgo_rc" = "2" ] || pgo_ok=0
+ACT=$pgo_ok
+assert "profile_guided_layout" 1 "$ACT"
+rm -f /tmp/ct_pgo.cheng /tmp/ct_pgo*.csg /tmp/ct_pgo_* /tmp/ct_pgo*.report /tmp/ct_pgo*.profile
+
+
+# --- RISC-V encoder: every constructor in rv64_emit.h against reference encodings ---
+# Reference words come from llvm-mc -triple=riscv64 -mattr=+m,+f,+d,+c,+zba,+zbb
+# -show-encoding; the li/li64 sequences are checked by executing them.
+rm -f /tmp/ct_rv64_enc.c /tmp/ct_rv64_enc
+cat > /tmp/ct_rv64_enc.c <<'EOF_RV'
+#include <stdio.h>
+#include "bootstrap/rv64_emit.h"
+
+typedef struct { const char *text; uint32_t want; uint32_t got; } RvEncCase;
+
+/* Runs the lui/addi/addiw/slli subset that rv_li/rv_li64 emit. */
+static int64_t run_li(const uint32_t *code, int n) {
+    int64_t x[32] = {0};
+    for (int i = 0; i < n; i++) {
+        uint32_t ins = code[i];
+        int rd = (int)((ins >> 7) & 0x1F), rs1 = (int)((ins >> 15) & 0x1F);
+        int64_t imm = rv_imm_i(ins);
+        switch (ins & 0x7F) {
+        case RV_LUI: x[rd] = (int64_t)(int32_t)(ins & 0xFFFFF000u); break;
+        case RV_OP_IMM:
+            if (((ins >> 12) & 7) == F3_SLL) x[rd] = (int64_t)((uint64_t)x[rs1] << (imm & 0x3F));
+            else x[rd] = x[rs1] + imm;
+            break;
+        case RV_OP_IMM32: x[rd] = (int64_t)(int32_t)(uint32_t)(x[rs1] + imm); break;
+        default: return 0x5A5A5A5A;
+        }
+        x[0] = 0;
+    }
+    return x[RV_A0];
+}
+
+int main(void) {
+    const RvEncCase cases[] = {
+        { "addi a0, sp, -16", 0xFF010513u, rv_addi(RV_A0, RV_SP, -16) },
+        { "addiw t1, a1, 2047", 0x7FF5831Bu, rv_addiw(RV_T1, RV_A1, 2047) },
+        { "add a0, a1, a2", 0x00C58533u, rv_add(RV_A0, RV_A1, RV_A2) },
+        { "addw t0, t1, t2", 0x007302BBu, rv_addw(RV_T0, RV_T1, RV_T2) },
+        { "sub a0, a1, a2", 0x40C58533u, rv_sub(RV_A0, RV_A1, RV_A2) },
+        { "subw a3, a4, a5", 0x40F706BBu, rv_subw(RV_A3, RV_A4, RV_A5) },
+        { "mul a0, a1, a2", 0x02C58533u, rv_mul(RV_A0, RV_A1, RV_A2) },
+        { "mulw a0, a1, a2", 0x02C5853Bu, rv_mulw(RV_A0, RV_A1, RV_A2) },
+        { "div a0, a1, a2", 0x02C5C533u, rv_div(RV_A0, RV_A1, RV_A2) },
+        { "divw a0, a1, a2", 0x02C5C53Bu, rv_divw(RV_A0, RV_A1, RV_A2) },
+        { "divu a0, a1, a2", 0x02C5D533u, rv_divu(RV_A0, RV_A1, RV_A2) },
+        { "divuw a0, a1, a2", 0x02C5D53Bu, rv_divuw(RV_A0, RV_A1, RV_A2) },
+        { "rem a0, a1, a2", 0x02C5E533u, rv_rem(RV_A0, RV_A1, RV_A2) },
+        { "remw a0, a1, a2", 0x02C5E53Bu, rv_remw(RV_A0, RV_A1, RV_A2) },
+        { "remu a0, a1, a2", 0x02C5F533u, rv_remu(RV_A0, RV_A1, RV_A2) },
+        { "slli a0, a1, 63", 0x03F59513u, rv_slli(RV_A0, RV_A1, 63) },
+        { "srli a0, a1, 33", 0x0215D513u, rv_srli(RV_A0, RV_A1, 33) },
+        { "srai a0, a1, 40", 0x4285D513u, rv_srai(RV_A0, RV_A1, 40) },
+        { "slliw a0, a1, 31", 0x01F5951Bu, rv_slliw(RV_A0, RV_A1, 31) },
+        { "srliw a0, a1, 7", 0x0075D51Bu, rv_srliw(RV_A0, RV_A1, 7) },
+        { "sraiw a0, a1, 9", 0x4095D51Bu, rv_sraiw(RV_A0, RV_A1, 9) },
+        { "sll a0, a1, a2", 0x00C59533u, rv_sll(RV_A0, RV_A1, RV_A2) },
+        { "srl a0, a1, a2", 0x00C5D533u, rv_srl(RV_A0, RV_A1, RV_A2) },
+        { "sra a0, a1, a2", 0x40C5D533u, rv_sra(RV_A0, RV_A1, RV_A2) },
+        { "sllw a0, a1, a2", 0x00C5953Bu, rv_sllw(RV_A0, RV_A1, RV_A2) },
+        { "srlw a0, a1, a2", 0x00C5D53Bu, rv_srlw(RV_A0, RV_A1, RV_A2) },
+        { "sraw a0, a1, a2", 0x40C5D53Bu, rv_sraw(RV_A0, RV_A1, RV_A2) },
+        { "and a0, a1, a2", 0x00C5F533u, rv_and(RV_A0, RV_A1, RV_A2) },
+        { "or a0, a1, a2", 0x00C5E533u, rv_or(RV_A0, RV_A1, RV_A2) },
+        { "xor a0, a1, a2", 0x00C5C533u, rv_xor(RV_A0, RV_A1, RV_A2) },
+        { "andi a0, a1, -1", 0xFFF5F513u, rv_andi(RV_A0, RV_A1, -1) },
+        { "ori a0, a1, 255", 0x0FF5E513u, rv_ori(RV_A0, RV_A1, 255) },
+        { "xori a0, a1, -2048", 0x8005C513u, rv_xori(RV_A0, RV_A1, -2048) },
+        { "slt a0, a1, a2", 0x00C5A533u, rv_slt(RV_A0, RV_A1, RV_A2) },
+        { "sltu a0, a1, a2", 0x00C5B533u, rv_sltu(RV_A0, RV_A1, RV_A2) },
+        { "slti a0, a1, -5", 0xFFB5A513u, rv_slti(RV_A0, RV_A1, -5) },
+        { "sltiu a0, a1, 1", 0x0015B513u, rv_sltiu(RV_A0, RV_A1, 1) },
+        { "ld a0, 2040(sp)", 0x7F813503u, rv_ld(RV_A0, RV_SP, 2040) },
+        { "lw t0, -4(a1)", 0xFFC5A283u, rv_lw(RV_T0, RV_A1, -4) },
+        { "lwu t0, 12(a1)", 0x00C5E283u, rv_lwu(RV_T0, RV_A1, 12) },
+        { "lbu t0, 3(a1)", 0x0035C283u, rv_lbu(RV_T0, RV_A1, 3) },
+        { "lhu t0, 6(a1)", 0x0065D283u, rv_lhu(RV_T0, RV_A1, 6) },
+        { "sd ra, 8(sp)", 0x00113423u, rv_sd(RV_RA, RV_SP, 8) },
+        { "sw a2, -20(s0)", 0xFEC42623u, rv_sw(RV_A2, RV_S0, -20) },
+        { "sh a2, 2(s0)", 0x00C41123u, rv_sh(RV_A2, RV_S0, 2) },
+        { "sb a2, 1(s0)", 0x00C400A3u, rv_sb(RV_A2, RV_S0, 1) },
+        { "beq a0, a1, 4094", 0x7EB50FE3u, rv_beq(RV_A0, RV_A1, 4094) },
+        { "bne a0, zero, -4096", 0x80051063u, rv_bne(RV_A0, RV_ZERO, -4096) },
+        { "blt t0, t1, 2050", 0x0062C1E3u, rv_blt(RV_T0, RV_T1, 2050) },
+        { "bge t0, t1, -2", 0xFE62DFE3u, rv_bge(RV_T0, RV_T1, -2) },
+        { "bltu t0, t1, 100", 0x0662E263u, rv_bltu(RV_T0, RV_T1, 100) },
+        { "bgeu t0, t1, -100", 0xF862FEE3u, rv_bgeu(RV_T0, RV_T1, -100) },
+        { "jal ra, 1048574", 0x7FFFF0EFu, rv_jal(RV_RA, 1048574) },
+        { "jal zero, -1048576", 0x8000006Fu, rv_jal(RV_ZERO, -1048576) },
+        { "jal ra, 2048", 0x001000EFu, rv_jal(RV_RA, 2048) },
+        { "jalr zero, 0(ra)", 0x00008067u, rv_jalr(RV_ZERO, RV_RA, 0) },
+        { "lui a0, 74565", 0x12345537u, rv_lui(RV_A0, 0x12345000) },
+        { "auipc t1, 1048575", 0xFFFFF317u, rv_auipc(RV_T1, (int32_t)0xFFFFF000u) },
+        { "fadd.s ft1, ft2, ft3, rne", 0x003100D3u, rv_fadd_s(1, 2, 3) },
+        { "fsgnjn.s ft1, ft2, ft3", 0x203110D3u, rv_fsgnjn_s(1, 2, 3) },
+        { "fsgnjn.d ft1, ft2, ft3", 0x223110D3u, rv_fsgnjn_d(1, 2, 3) },
+        { "feq.s a0, ft2, ft3", 0xA0312553u, rv_feq_s(RV_A0, 2, 3) },
+        { "flt.s a0, ft2, ft3", 0xA0311553u, rv_flt_s(RV_A0, 2, 3) },
+        { "feq.d a0, ft2, ft3", 0xA2312553u, rv_feq_d(RV_A0, 2, 3) },
+        { "flt.d a0, ft2, ft3", 0xA2311553u, rv_flt_d(RV_A0, 2, 3) },
+        { "fcvt.s.w ft1, a0, rne", 0xD00500D3u, rv_fcvt_s_w(1, RV_A0) },
+        { "fcvt.w.s a0, ft1, rtz", 0xC0009553u, rv_fcvt_w_s(RV_A0, 1) },
+        { "fcvt.d.w ft1, a0", 0xD20500D3u, rv_fcvt_d_w(1, RV_A0) },
+        { "fcvt.w.d a0, ft1, rtz", 0xC2009553u, rv_fcvt_w_d(RV_A0, 1) },
+        { "fmv.w.x ft1, a0", 0xF00500D3u, rv_fmv_w_x(1, RV_A0) },
+        { "fmv.x.w a0, ft1", 0xE0008553u, rv_fmv_x_w(RV_A0, 1) },
+        { "fmv.d.x ft1, a0", 0xF20500D3u, rv_fmv_d_x(1, RV_A0) },
+        { "fmv.x.d a0, ft1", 0xE2008553u, rv_fmv_x_d(RV_A0, 1) },
+        { "sh1add a0, a1, a2", 0x20C5A533u, rv_sh1add(RV_A0, RV_A1, RV_A2) },
+        { "sh2add a0, a1, a2", 0x20C5C533u, rv_sh2add(RV_A0, RV_A1, RV_A2) },
+        { "sh3add a0, a1, a2", 0x20C5E533u, rv_sh3add(RV_A0, RV_A1, RV_A2) },
+        { "orn a0, a1, a2", 0x40C5E533u, rv_orn(RV_A0, RV_A1, RV_A2) },
+        { "ctz a0, a1", 0x60159513u, rv_ctz(RV_A0, RV_A1) },
+        { "orc.b a0, a1", 0x2875D513u, rv_orc_b(RV_A0, RV_A1) },
+        { "c.addi4spn a0, sp, 1020", 0x1FE8u, rv_c_addi4spn(RV_A0, 1020) },
+        { "c.lw a0, 124(s1)", 0x5CE8u, rv_c_lw(RV_A0, RV_S1, 124) },
+        { "c.sw a5, 64(a4)", 0xC33Cu, rv_c_sw(RV_A5, RV_A4, 64) },
+        { "c.ld a0, 248(s1)", 0x7CE8u, rv_c_ld(RV_A0, RV_S1, 248) },
+        { "c.sd a5, 8(a4)", 0xE71Cu, rv_c_sd(RV_A5, RV_A4, 8) },
+        { "c.nop", 0x0001u, rv_c_nop() },
+        { "c.addi t0, -32", 0x1281u, rv_c_addi(RV_T0, -32) },
+        { "c.addiw t0, 31", 0x22FDu, rv_c_addiw(RV_T0, 31) },
+        { "c.li a0, -1", 0x557Du, rv_c_li(RV_A0, -1) },
+        { "c.lui a0, 31", 0x657Du, rv_c_lui(RV_A0, 31) },
+        { "c.lui t1, 1048575", 0x737Du, rv_c_lui(RV_T1, -1) },
+        { "c.addi16sp sp, -512", 0x7101u, rv_c_addi16sp(-512) },
+        { "c.addi16sp sp, 496", 0x617Du, rv_c_addi16sp(496) },
+        { "c.srli a0, 63", 0x917Du, rv_c_srli(RV_A0, 63) },
+        { "c.srai a1, 1", 0x8585u, rv_c_srai(RV_A1, 1) },
+        { "c.andi a2, -7", 0x9A65u, rv_c_andi(RV_A2, -7) },
+        { "c.sub a0, a1", 0x8D0Du, rv_c_sub(RV_A0, RV_A1) },
+        { "c.xor a0, a1", 0x8D2Du, rv_c_xor(RV_A0, RV_A1) },
+        { "c.or a0, a1", 0x8D4Du, rv_c_or(RV_A0, RV_A1) },
+        { "c.and a0, a1", 0x8D6Du, rv_c_and(RV_A0, RV_A1) },
+        { "c.subw a0, a1", 0x9D0Du, rv_c_subw(RV_A0, RV_A1) },
+        { "c.addw a0, a1", 0x9D2Du, rv_c_addw(RV_A0, RV_A1) },
+        { "c.j -2048", 0xB001u, rv_c_j(-2048) },
+        { "c.j 2046", 0xAFFDu, rv_c_j(2046) },
+        { "c.j 1370", 0xABA9u, rv_c_j(1370) },
+        { "c.beqz a0, -256", 0xD101u, rv_c_beqz(RV_A0, -256) },
+        { "c.bnez s1, 254", 0xECFDu, rv_c_bnez(RV_S1, 254) },
+        { "c.bnez s1, 90", 0xECA9u, rv_c_bnez(RV_S1, 90) },
+        { "c.slli t3, 17", 0x0E46u, rv_c_slli(RV_T3, 17) },
+        { "c.lwsp ra, 252(sp)", 0x50FEu, rv_c_lwsp(RV_RA, 252) },
+        { "c.ldsp ra, 504(sp)", 0x70FEu, rv_c_ldsp(RV_RA, 504) },
+        { "c.swsp t6, 252(sp)", 0xDFFEu, rv_c_swsp(RV_T6, 252) },
+        { "c.sdsp s0, 504(sp)", 0xFFA2u, rv_c_sdsp(RV_S0, 504) },
+        { "c.sdsp s0, 72(sp)", 0xE4A2u, rv_c_sdsp(RV_S0, 72) },
+        { "c.jr ra", 0x8082u, rv_c_jr(RV_RA) },
+        { "c.mv a0, t2", 0x851Eu, rv_c_mv(RV_A0, RV_T2) },
+        { "c.ebreak", 0x9002u, rv_c_ebreak() },
+        { "c.jalr t0", 0x9282u, rv_c_jalr(RV_T0) },
+        { "c.add a0, s5", 0x9556u, rv_c_add(RV_A0, RV_S5) },
+        { "addi a0, zero, 5 (rvc)", 0x4515u, rv_compress(rv_addi(RV_A0, RV_ZERO, 5)) },
+        { "addi a0, a1, 0 (rvc)", 0x852Eu, rv_compress(rv_addi(RV_A0, RV_A1, 0)) },
+        { "addi sp, sp, -64 (rvc)", 0x7139u, rv_compress(rv_addi(RV_SP, RV_SP, -64)) },
+        { "addi t0, t0, 7 (rvc)", 0x029Du, rv_compress(rv_addi(RV_T0, RV_T0, 7)) },
+        { "addi a2, sp, 40 (rvc)", 0x1030u, rv_compress(rv_addi(RV_A2, RV_SP, 40)) },
+        { "addi t0, t1, 7 (rvc)", 0x0000u, rv_compress(rv_addi(RV_T0, RV_T1, 7)) },
+        { "addiw a0, a0, -3 (rvc)", 0x3575u, rv_compress(rv_addiw(RV_A0, RV_A0, -3)) },
+        { "slli t2, t2, 3 (rvc)", 0x038Eu, rv_compress(rv_slli(RV_T2, RV_T2, 3)) },
+        { "srli a1, a1, 32 (rvc)", 0x9181u, rv_compress(rv_srli(RV_A1, RV_A1, 32)) },
+        { "srai a1, a1, 2 (rvc)", 0x8589u, rv_compress(rv_srai(RV_A1, RV_A1, 2)) },
+        { "srai t1, t1, 2 (rvc)", 0x0000u, rv_compress(rv_srai(RV_T1, RV_T1, 2)) },
+        { "andi a3, a3, 15 (rvc)", 0x8ABDu, rv_compress(rv_andi(RV_A3, RV_A3, 15)) },
+        { "lui a0, 31 (rvc)", 0x657Du, rv_compress(rv_lui(RV_A0, 0x1F000)) },
+        { "lui a0, 64 (rvc)", 0x0000u, rv_compress(rv_lui(RV_A0, 0x40000)) },
+        { "add t0, t0, a1 (rvc)", 0x92AEu, rv_compress(rv_add(RV_T0, RV_T0, RV_A1)) },
+        { "add t0, a1, t0 (rvc)", 0x92AEu, rv_compress(rv_add(RV_T0, RV_A1, RV_T0)) },
+        { "add t0, zero, a1 (rvc)", 0x82AEu, rv_compress(rv_add(RV_T0, RV_ZERO, RV_A1)) },
+        { "add t0, a2, a1 (rvc)", 0x0000u, rv_compress(rv_add(RV_T0, RV_A2, RV_A1)) },
+        { "sub a0, a0, a1 (rvc)", 0x8D0Du, rv_compress(rv_sub(RV_A0, RV_A0, RV_A1)) },
+        { "sub a0, a1, a0 (rvc)", 0x0000u, rv_compress(rv_sub(RV_A0, RV_A1, RV_A0)) },
+        { "xor a0, a0, a1 (rvc)", 0x8D2Du, rv_compress(rv_xor(RV_A0, RV_A0, RV_A1)) },
+        { "or a0, a1, a0 (rvc)", 0x8D4Du, rv_compress(rv_or(RV_A0, RV_A1, RV_A0)) },
+        { "and s1, s1, a5 (rvc)", 0x8CFDu, rv_compress(rv_and(RV_S1, RV_S1, RV_A5)) },
+        { "addw a0, a0, a1 (rvc)", 0x9D2Du, rv_compress(rv_addw(RV_A0, RV_A0, RV_A1)) },
+        { "subw a0, a0, a1 (rvc)", 0x9D0Du, rv_compress(rv_subw(RV_A0, RV_A0, RV_A1)) },
+        { "ld ra, 8(sp) (rvc)", 0x60A2u, rv_compress(rv_ld(RV_RA, RV_SP, 8)) },
+        { "ld a0, 16(a1) (rvc)", 0x6988u, rv_compress(rv_ld(RV_A0, RV_A1, 16)) },
+        { "ld a0, 16(t1) (rvc)", 0x0000u, rv_compress(rv_ld(RV_A0, RV_T1, 16)) },
+        { "lw t0, 12(sp) (rvc)", 0x42B2u, rv_compress(rv_lw(RV_T0, RV_SP, 12)) },
+        { "lw a0, 4(a1) (rvc)", 0x41C8u, rv_compress(rv_lw(RV_A0, RV_A1, 4)) },
+        { "sd s0, 0(sp) (rvc)", 0xE022u, rv_compress(rv_sd(RV_S0, RV_SP, 0)) },
+        { "sd a0, 24(a1) (rvc)", 0xED88u, rv_compress(rv_sd(RV_A0, RV_A1, 24)) },
+        { "sw t3, 20(sp) (rvc)", 0xCA72u, rv_compress(rv_sw(RV_T3, RV_SP, 20)) },
+        { "sw a0, 20(a1) (rvc)", 0xC9C8u, rv_compress(rv_sw(RV_A0, RV_A1, 20)) },
+        { "sd a0, 1000(sp) (rvc)", 0x0000u, rv_compress(rv_sd(RV_A0, RV_SP, 1000)) },
+        { "jalr zero, 0(ra) (rvc)", 0x8082u, rv_compress(rv_jalr(RV_ZERO, RV_RA, 0)) },
+        { "jalr ra, 0(t1) (rvc)", 0x9302u, rv_compress(rv_jalr(RV_RA, RV_T1, 0)) },
+        { "jalr ra, 4(t1) (rvc)", 0x0000u, rv_compress(rv_jalr(RV_RA, RV_T1, 4)) },
+        { "ebreak (rvc)", 0x9002u, rv_compress(rv_ebreak()) },
+        { "mul a0, a0, a1 (rvc)", 0x0000u, rv_compress(rv_mul(RV_A0, RV_A0, RV_A1)) },
+        { "lbu a0, 0(a1) (rvc)", 0x0000u, rv_compress(rv_lbu(RV_A0, RV_A1, 0)) },
+        { "c.j 1370 (relaxed)", 0xABA9u, rv_compress_jump(rv_jal(RV_ZERO, 0), 1370) },
+        { "jal zero, 4096 (out of range)", 0x0000u, rv_compress_jump(rv_jal(RV_ZERO, 0), 4096) },
+        { "jal ra, 16 (links)", 0x0000u, rv_compress_jump(rv_jal(RV_RA, 0), 16) },
+        { "c.bnez s1, 90 (relaxed)", 0xECA9u, rv_compress_jump(rv_bne(RV_S1, RV_ZERO, 0), 90) },
+        { "beq t0, zero, 8 (not rvc reg)", 0x0000u, rv_compress_jump(rv_beq(RV_T0, RV_ZERO, 0), 8) },
+    };
+    int bad = 0;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        if (cases[i].got != cases[i].want) {
+            printf("%s: got %08X want %08X\n", cases[i].text, cases[i].got, cases[i].want);
+            bad++;
+        }
+    }
+    static const int64_t li_values[] = {
+        0, 1, -1, 2047, -2048, 2048, 0x7FFFF800, 0x7FFFFFFF, INT32_MIN, 0x12345678,
+        0x100000000LL, 0x123456789ABCDEF0LL, INT64_MIN, INT64_MAX, -0x80000001LL,
+        0x7FFFFFFF80000000LL, 0x0000000080000000LL, (int64_t)0xFFFFFFFF00000FFFULL,
+    };
+    for (size_t i = 0; i < sizeof(li_values) / sizeof(li_values[0]); i++) {
+        uint32_t code[16];
+        int n = 0;
+        rv_li64(code, &n, RV_A0, (uint64_t)li_values[i]);
+        if (n > 8 || run_li(code, n) != li_values[i]) {
+            printf("li64 %llx: %d words, wrong value\n", (unsigned long long)li_values[i], n);
+            bad++;
+        }
+    }
+    return bad == 0 ? 0 : 1;
+}
+EOF_RV
+ACT=0
+if cc -std=c11 -Wall -Werror -Wno-unused-function -I. -o /tmp/ct_rv64_enc /tmp/ct_rv64_enc.c >/dev/null 2>&1 &&
+   /tmp/ct_rv64_enc; then
+    ACT=1
+fi
+assert "rv64_encoder_reference_encodings" 1 "$ACT"
+rm -f /tmp/ct_rv64_enc.c /tmp/ct_rv64_enc
+
+# --- ELF executables: W^X segments, string literals interned into rodata ---
+rm -f /tmp/ct_elf_wx.cheng /tmp/ct_elf_wx.csg /tmp/ct_elf_wx /tmp/ct_elf_wx.report
+cat > /tmp/ct_elf_wx.cheng <<'EOF'
+fn greet(): str =
+    return "cold rodata literal"
+
+fn main(): int32 =
+    let a = greet()
+    let b = "cold rodata literal"
+    return a.len + b.len
+EOF
+for elf_wx_target in x86_64-unknown-linux-gnu aarch64-unknown-linux-gnu riscv64-unknown-linux-gnu; do
+    ACT=0
+    if $COLD system-link-exec --root:"$PWD" --in:/tmp/ct_elf_wx.cheng \
+        --target:$elf_wx_target --emit:csg-v2 --out:/tmp/ct_elf_wx.csg >/dev/null 2>&1 &&
+       $COLD system-link-exec --root:"$PWD" --csg-in:/tmp/ct_elf_wx.csg \
+        --target:$elf_wx_target --emit:exe --out:/tmp/ct_elf_wx \
+        --report-out:/tmp/ct_elf_wx.report >/dev/null 2>&1 &&
+       grep -q '^cold_rodata_bytes=20$' /tmp/ct_elf_wx.report 2>/dev/null; then
+        # literal deduplicated and placed at the first page after the text segment
+        elf_wx_hex=$(od -An -tx1 -j4096 -N20 /tmp/ct_elf_wx | tr -d ' \n')
+        [ "$elf_wx_hex" = "636f6c6420726f64617461206c69746572616c00" ] && ACT=1
+        if [ "$ACT" = "1" ] && command -v readelf >/dev/null 2>&1; then
+            readelf -lW /tmp/ct_elf_wx 2>/dev/null | grep -q 'GNU_STACK.* RW ' || ACT=0
+            readelf -lW /tmp/ct_elf_wx 2>/dev/null | grep -q '^ *LOAD.* R E ' || ACT=0
+            readelf -lW /tmp/ct_elf_wx 2>/dev/null | grep -q '^ *LOAD.* RWE ' && ACT=0
+        fi
+        if [ "$ACT" = "1" ] && [ "$elf_wx_target" = "x86_64-unknown-linux-gnu" ] &&
+           [ "$(uname -s)-$(uname -m)" = "Linux-x86_64" ]; then
+            elf_wx_rc=0
+            /tmp/ct_elf_wx >/dev/null 2>&1 || elf_wx_rc=$?
+            [ "$elf_wx_rc" = "38" ] || ACT=0
+        fi
+    fi
+    assert "elf_exe_wx_segments_${elf_wx_target%%-*}" 1 "$ACT"
+done
+# codegen's own constants (the "." opened by PathCurrentDir) share the pool
+cat > /tmp/ct_elf_wx.cheng <<'EOF'
+fn main(): int32 =
+    let d = PathCurrentDir()
+    return d.len
+EOF
+ACT=0
+if $COLD system-link-exec --root:"$PWD" --in:/tmp/ct_elf_wx.cheng \
+    --target:aarch64-unknown-linux-gnu --emit:csg-v2 --out:/tmp/ct_elf_wx.csg >/dev/null 2>&1 &&
+   $COLD system-link-exec --root:"$PWD" --csg-in:/tmp/ct_elf_wx.csg \
+    --target:aarch64-unknown-linux-gnu --emit:exe --out:/tmp/ct_elf_wx \
+    --report-out:/tmp/ct_elf_wx.report >/dev/null 2>&1 &&
+   grep -q '^cold_rodata_bytes=2$' /tmp/ct_elf_wx.report 2>/dev/null; then
+    [ "$(od -An -tx1 -j4096 -N2 /tmp/ct_elf_wx | tr -d ' \n')" = "2e00" ] && ACT=1
+fi
+assert "elf_exe_codegen_constants_in_rodata" 1 "$ACT"
+rm -f /tmp/ct_elf_wx.cheng /tmp/ct_elf_wx.csg /tmp/ct_elf_wx /tmp/ct_elf_wx.report
+
 ACT=$(compile_obj_smoke "tls_client_hello_parse" "src/tests/tls_client_hello_parse_smoke.cheng")
 assert "tls_client_hello_parse_cold_compile_smoke" 1 "$ACT"
 
@@ -4333,9 +5357,9 @@ for pc_run in a b; do
         --report-out:"/tmp/ct_pc/link_${pc_run}.report.txt"
 done
 # Compare stripped reports
-grep -vE '^(build_timestamp=|report_written_at=|cold_provider_archive_pack_elapsed_ms=|cold_system_link_exec_elapsed_ms=|output=|entry_dispatch_executable=|source=|csg_input=|cold_compile_elapsed_ms=|exec_phase_|report_cpu_ms=|report_rss_bytes=|provider_archive_hash=)' \
+grep -vE '^(build_timestamp=|report_written_at=|cold_provider_archive_pack_elapsed_ms=|cold_system_link_exec_elapsed_ms=|output=|entry_dispatch_executable=|source=|csg_input=|cold_compile_elapsed_ms=|exec_phase_|report_cpu_ms=|report_rss_bytes=|arena_|provider_archive_hash=)' \
     /tmp/ct_pc/link_a.report.txt > /tmp/ct_pc/link_a_stripped.txt
-grep -vE '^(build_timestamp=|report_written_at=|cold_provider_archive_pack_elapsed_ms=|cold_system_link_exec_elapsed_ms=|output=|entry_dispatch_executable=|source=|csg_input=|cold_compile_elapsed_ms=|exec_phase_|report_cpu_ms=|report_rss_bytes=|provider_archive_hash=)' \
+grep -vE '^(build_timestamp=|report_written_at=|cold_provider_archive_pack_elapsed_ms=|cold_system_link_exec_elapsed_ms=|output=|entry_dispatch_executable=|source=|csg_input=|cold_compile_elapsed_ms=|exec_phase_|report_cpu_ms=|report_rss_bytes=|arena_|provider_archive_hash=)' \
     /tmp/ct_pc/link_b.report.txt > /tmp/ct_pc/link_b_stripped.txt
 if cmp -s /tmp/ct_pc/link_a_stripped.txt /tmp/ct_pc/link_b_stripped.txt; then
     ACT=1; else ACT=0
@@ -4584,6 +5608,8 @@ ACT=$(compile_obj_smoke "std_algorithm" "src/std/algorithm.cheng")
 assert "std_algorithm_cold_compile_smoke" 1 "$ACT"
 ACT=$(compile_obj_smoke "std_json" "src/std/json.cheng")
 assert "std_json_cold_compile_smoke" 1 "$ACT"
+ACT=$(compile_obj_smoke "json_tape" "src/tests/json_tape_smoke.cheng")
+assert "json_tape_cold_compile_smoke" 1 "$ACT"
 ACT=$(compile_obj_smoke "std_tables" "src/std/tables.cheng")
 assert "std_tables_cold_compile_smoke" 1 "$ACT"
 ACT=$(compile_obj_smoke "std_strings" "src/std/strings.cheng")
@@ -4596,6 +5622,8 @@ ACT=$(compile_obj_smoke "std_rawmem_support" "src/std/rawmem_support.cheng")
 assert "std_rawmem_support_cold_compile_smoke" 1 "$ACT"
 ACT=$(compile_obj_smoke "std_streams" "src/std/streams.cheng")
 assert "std_streams_cold_compile_smoke" 1 "$ACT"
+ACT=$(compile_obj_smoke "streams_buffered" "src/tests/streams_buffered_smoke.cheng")
+assert "streams_buffered_cold_compile_smoke" 1 "$ACT"
 ACT=$(compile_obj_smoke "std_stringlist" "src/std/stringlist.cheng")
 assert "std_stringlist_cold_compile_smoke" 1 "$ACT"
 ACT=$(compile_obj_smoke "std_monotimes" "src/std/monotimes.cheng")
@@ -4604,8 +5632,12 @@ ACT=$(compile_obj_smoke "std_parseutils" "src/std/parseutils.cheng")
 assert "std_parseutils_cold_compile_smoke" 1 "$ACT"
 ACT=$(compile_obj_smoke "std_hashsets" "src/std/hashsets.cheng")
 assert "std_hashsets_cold_compile_smoke" 1 "$ACT"
+ACT=$(compile_obj_smoke "hashmap_delete" "src/tests/hashmap_delete_smoke.cheng")
+assert "hashmap_delete_cold_compile_smoke" 1 "$ACT"
 ACT=$(compile_obj_smoke "std_buffer" "src/std/buffer.cheng")
 assert "std_buffer_cold_compile_smoke" 1 "$ACT"
+ACT=$(compile_obj_smoke "buffer_slab" "src/tests/buffer_slab_smoke.cheng")
+assert "buffer_slab_cold_compile_smoke" 1 "$ACT"
 ACT=$(compile_obj_smoke "std_cmdline" "src/std/cmdline.cheng")
 assert "std_cmdline_cold_compile_smoke" 1 "$ACT"
 ACT=$(compile_obj_smoke "std_crash_trace_internal" "src/std/crash_trace_internal.cheng")
@@ -4616,6 +5648,16 @@ ACT=$(compile_obj_smoke "std_async_rt" "src/std/async_rt.cheng")
 assert "std_async_rt_cold_compile_smoke" 1 "$ACT"
 ACT=$(compile_obj_smoke "std_async_rt_legacy" "src/std/async_rt_legacy.cheng")
 assert "std_async_rt_legacy_cold_compile_smoke" 1 "$ACT"
+ACT=$(compile_obj_smoke "async_rt_sched" "src/tests/async_rt_sched_smoke.cheng")
+assert "async_rt_sched_cold_compile_smoke" 1 "$ACT"
+ACT=$(compile_obj_smoke "std_chan" "src/std/chan.cheng")
+assert "std_chan_cold_compile_smoke" 1 "$ACT"
+ACT=$(compile_obj_smoke "std_os_topology" "src/std/os_topology.cheng")
+assert "std_os_topology_cold_compile_smoke" 1 "$ACT"
+ACT=$(compile_obj_smoke "os_topology_fixture" "src/tests/os_topology_fixture_smoke.cheng")
+assert "os_topology_fixture_cold_compile_smoke" 1 "$ACT"
+ACT=$(compile_obj_smoke "chan_mpmc" "src/tests/chan_mpmc_smoke.cheng")
+assert "chan_mpmc_cold_compile_smoke" 1 "$ACT"
 ACT=$(compile_obj_smoke "std_crypto_aes" "src/std/crypto/aes.cheng")
 assert "std_crypto_aes_cold_compile_smoke" 1 "$ACT"
 ACT=$(compile_obj_smoke "std_crypto_aesgcm" "src/std/crypto/aesgcm.cheng")
@@ -29,11 +29,12 @@ wasm_compile() {
     local name="$1"
     local src="$2"
     local out="$WORK/$name.wasm"
+    shift 2
     if "$COLD" system-link-exec \
         --in:"$src" \
         --emit:exe \
         --target:wasm32-unknown-unknown \
-        --out:"$out" >/dev/null 2>&1; then
+        --out:"$out" "$@" >/dev/null 2>&1; then
         if [ -s "$out" ] && file "$out" 2>/dev/null | grep -q "WebAssembly"; then
             ok "${name}_wasm_compile"
         else
@@ -86,6 +87,14 @@ wasm_compile memory_ops src/tests/wasm_memory_ops_smoke.cheng
 # 11. Extended control flow
 wasm_compile control_flow_ext src/tests/wasm_control_flow_ext_smoke.cheng
 
+# 12. Heap string churn (size-class allocator instead of page-per-string)
+wasm_compile heap_churn src/tests/wasm_heap_string_churn_smoke.cheng
+wasm_compile heap_churn_mvp src/tests/wasm_heap_string_churn_smoke.cheng --wasm-features:mvp
+
+# 13. String equality / copies with bulk-memory + SIMD128, and the MVP fallback
+wasm_compile str_eq_simd src/tests/wasm_str_eq_simd_smoke.cheng --wasm-features:all
+wasm_compile str_eq_mvp src/tests/wasm_str_eq_simd_smoke.cheng --wasm-features:mvp
+
 # ============================================================
 # Phase 2: WASM binary size check
 # ============================================================
@@ -346,6 +355,69 @@ try {
             fi
         fi
     done
+
+    # Heap allocator: bounded growth, free-list reuse, zeroed recycled blocks
+    # (memory.fill with bulk memory, the word loop under mvp)
+    for heap_mod in heap_churn heap_churn_mvp; do
+    if [ -s "$WORK/$heap_mod.wasm" ]; then
+        heap_out=$(node -e "
+const fs = require('fs');
+try {
+    const memory = new WebAssembly.Memory({initial: 1, maximum: 512});
+    const mod = new WebAssembly.Module(fs.readFileSync('$WORK/$heap_mod.wasm'));
+    const ex = new WebAssembly.Instance(mod, {env: {memory: memory}}).exports;
+    const fail = [];
+    if (ex.main() !== 0) fail.push('main');
+    const u8 = () => new Uint8Array(memory.buffer);
+    const a = ex.cheng_heap_alloc(24), b = ex.cheng_heap_alloc(24);
+    if (a === b || a % 8 !== 0) fail.push('distinct');
+    u8().fill(0xAA, a, a + 24);
+    ex.cheng_heap_free(a);
+    const c = ex.cheng_heap_alloc(20);
+    if (c !== a) fail.push('reuse');
+    if (u8().slice(c, c + 24).some(x => x)) fail.push('zeroed');
+    for (let i = 0; i < 100000; i++) ex.cheng_heap_free(ex.cheng_heap_alloc(40 + (i % 200)));
+    const big = ex.cheng_heap_alloc(200000);
+    u8().fill(0xAA, big, big + 200000);
+    ex.cheng_heap_free(big);
+    if (ex.cheng_heap_alloc(150000) !== big) fail.push('large_reuse');
+    if (u8().slice(big, big + 150000).some(x => x)) fail.push('large_zeroed');
+    const pages = memory.buffer.byteLength / 65536;
+    if (pages > 16) fail.push('pages=' + pages);
+    console.log(fail.length ? fail.join(',') : 'ok');
+} catch (e) {
+    console.log('NODE_ERROR: ' + e.message);
+}
+" 2>&1)
+        if [ "$heap_out" = "ok" ]; then
+            ok "${heap_mod}_allocator"
+        else
+            bad "${heap_mod}_allocator ($heap_out)"
+        fi
+    fi
+    done
+
+    # Feature switch: bulk/simd opcodes only when enabled, both modes validate
+    if [ -s "$WORK/str_eq_simd.wasm" ] && [ -s "$WORK/str_eq_mvp.wasm" ]; then
+        feat_out=$(node -e "
+const fs = require('fs');
+const has = (b, seq) => b.some((_, i) => seq.every((x, j) => b[i + j] === x));
+const simd = fs.readFileSync('$WORK/str_eq_simd.wasm');
+const mvp = fs.readFileSync('$WORK/str_eq_mvp.wasm');
+const fail = [];
+if (!WebAssembly.validate(simd)) fail.push('simd_invalid');
+if (!WebAssembly.validate(mvp)) fail.push('mvp_invalid');
+if (!has(simd, [0xFC, 0x0A, 0x00, 0x00])) fail.push('no_memory_copy');
+if (!has(simd, [0xFD, 0x23])) fail.push('no_i8x16_eq');
+if (has(mvp, [0xFC, 0x0A, 0x00, 0x00]) || has(mvp, [0xFD, 0x23])) fail.push('mvp_has_ext');
+console.log(fail.length ? fail.join(',') : 'ok');
+" 2>&1)
+        if [ "$feat_out" = "ok" ]; then
+            ok "wasm_features_switch"
+        else
+            bad "wasm_features_switch ($feat_out)"
+        fi
+    fi
 else
     echo "  (Node.js not available, skipping execution tests)"
 fi